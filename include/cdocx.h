@@ -45,30 +45,39 @@ inline constexpr char kVersion[] = "0.8.0";
 #include "cdocx/bookmark.h"
 #include "cdocx/bookmark_inserter.h"
 #include "cdocx/bookmark_replacer.h"
+#include "cdocx/cancellation.h"
 #include "cdocx/caption_generator.h"
 #include "cdocx/comment.h"
+#include "cdocx/compression.h"
 #include "cdocx/control_char.h"
 #include "cdocx/convert_util.h"
 #include "cdocx/document.h"
 #include "cdocx/document_builder.h"
+#include "cdocx/document_compare.h"
 #include "cdocx/document_search.h"
+#include "cdocx/encryption.h"
 #include "cdocx/enums.h"
 #include "cdocx/file_format_util.h"
 #include "cdocx/footnote.h"
 #include "cdocx/format.h"
 #include "cdocx/formfield.h"
+#include "cdocx/html_writer.h"
 #include "cdocx/inserter.h"
 #include "cdocx/iterator.h"
 #include "cdocx/mail_merge.h"
 #include "cdocx/node.h"
+#include "cdocx/pagination.h"
 #include "cdocx/paragraph.h"
 #include "cdocx/paragraph_builder.h"
 #include "cdocx/properties.h"
 #include "cdocx/range.h"
+#include "cdocx/record_source.h"
 #include "cdocx/section.h"
+#include "cdocx/statistics.h"
 #include "cdocx/style.h"
 #include "cdocx/table.h"
 #include "cdocx/table_builder.h"
+#include "cdocx/table_of_contents.h"
 #include "cdocx/template.h"
 #include "cdocx/template_engine.h"
 #include "cdocx/watermark.h"
@@ -38,6 +38,7 @@
 
 #include <pugixml.hpp>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace cdocx {
@@ -115,10 +116,39 @@ class Run : public Inline {
         return text_;
     }
 
-    // Text content
-    void set_text(const std::string& text) { text_ = text; }
-    void append_text(const std::string& text) { text_ += text; }
-    void prepend_text(const std::string& text) { text_ = text + text_; }
+    // Text content (views are copied into the existing buffer, rvalues moved)
+    void set_text(std::string_view text) {
+        text_.assign(text);
+        notify_content_changed();
+    }
+    void set_text(std::string&& text) {
+        text_ = std::move(text);
+        notify_content_changed();
+    }
+    void set_text(const char* text) {
+        text_.assign(text);
+        notify_content_changed();
+    }
+    void append_text(std::string_view text) {
+        text_.append(text);
+        notify_content_changed();
+    }
+    void prepend_text(std::string_view text) {
+        text_.insert(0, text);
+        notify_content_changed();
+    }
+
+    // Tracked change (w:ins / w:del wrapper), v0.8.0+
+    RevisionType get_revision_type() const { return revision_type_; }
+    int get_revision_id() const { return revision_id_; }
+    const std::string& get_revision_author() const { return revision_author_; }
+    const std::string& get_revision_date() const { return revision_date_; }
+    bool is_revision() const { return revision_type_ != RevisionType::None; }
+    void set_revision(RevisionType type,
+                      int id,
+                      const std::string& author,
+                      const std::string& date = "");
+    void clear_revision();
 
     // Convenience formatting (override Inline methods for chainability)
     Run& set_bold(bool value) {
@@ -229,10 +259,15 @@ class Run : public Inline {
     void preserve_child(pugi::xml_node child);
     void serialize_preserved_children(pugi::xml_node run_xml) const;
     bool has_preserved_children() const;
+    pugi::xml_node get_preserved_children() const;  // Parent of the preserved elements
 
   private:
     std::string text_;
     pugi::xml_document preserved_children_;
+    RevisionType revision_type_ = RevisionType::None;
+    int revision_id_ = 0;
+    std::string revision_author_;
+    std::string revision_date_;
 };
 
 
@@ -246,7 +281,10 @@ class SpecialChar : public Inline {
     explicit SpecialChar(char16_t char_code);
 
     char16_t get_char() const { return char_code_; }
-    void set_char(char16_t ch) { char_code_ = ch; }
+    void set_char(char16_t ch) {
+        char_code_ = ch;
+        notify_content_changed();
+    }
 
     // Static factory methods for common special chars
     static std::shared_ptr<SpecialChar> paragraph_break();
@@ -254,6 +292,7 @@ class SpecialChar : public Inline {
     static std::shared_ptr<SpecialChar> page_break();
     static std::shared_ptr<SpecialChar> column_break();
     static std::shared_ptr<SpecialChar> tab();
+    static std::shared_ptr<SpecialChar> field_end();  // Ends a field spanning paragraphs
 
     // Node overrides
     NodeType node_type() const override { return NodeType::SpecialChar; }
@@ -323,7 +362,10 @@ class Field : public Inline {
     void set_field_code(const std::string& code) { field_code_ = code; }
 
     std::string get_result() const { return result_; }
-    void set_result(const std::string& result) { result_ = result; }
+    void set_result(const std::string& result) {
+        result_ = result;
+        notify_content_changed();
+    }
 
     bool is_locked() const { return is_locked_; }
     void set_locked(bool locked) { is_locked_ = locked; }
@@ -331,6 +373,11 @@ class Field : public Inline {
     bool is_dirty() const { return is_dirty_; }
     void set_dirty(bool dirty) { is_dirty_ = dirty; }
 
+    // Result continues in the following paragraphs up to a SpecialChar::field_end()
+    // (e.g. a table of contents); only the begin, code and separator belong to this node
+    bool spans_paragraphs() const { return spans_paragraphs_; }
+    void set_spans_paragraphs(bool value) { spans_paragraphs_ = value; }
+
     // Field switches (e.g., \"\\* MERGEFORMAT\", \"\\@ \"yyyy-MM-dd\"")
     void add_switch(const std::string& switch_text);
     void clear_switches();
@@ -359,6 +406,7 @@ class Field : public Inline {
     std::vector<std::string> switches_;
     bool is_locked_ = false;
     bool is_dirty_ = true;
+    bool spans_paragraphs_ = false;
 };
 
 
@@ -14,6 +14,7 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace cdocx {
@@ -104,7 +105,7 @@ class Bookmark {
     std::string get_name() const;
     void set_name(const std::string& name);
     std::string get_text() const;
-    bool set_text(const std::string& text);
+    bool set_text(std::string_view text);
     bool is_valid() const;
     bool remove();
     bool remove_with_content();
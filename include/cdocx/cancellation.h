@@ -0,0 +1,108 @@
+/**
+ * @file cancellation.h
+ * @brief Cooperative cancellation and deadlines for long-running operations
+ * @details A CancellationToken is a cheap, copyable handle to shared state:
+ *          every copy observes cancel() and the deadline set through any other
+ *          copy, so a token can be handed to a worker and cancelled from the
+ *          caller's thread.
+ *
+ *          Loading (LoadConfig::cancellation_token), saving
+ *          (Document::save(path, token)), TemplateEngine::apply() and
+ *          MailMerge poll the token at entry, element and section granularity
+ *          and stop at the next check. Aborted operations leave the document
+ *          in a consistent state and never leave a partial output file.
+ *
+ * @par Usage Example:
+ * @code
+ * LoadConfig config;
+ * config.cancellation_token.set_timeout(std::chrono::seconds(5));
+ *
+ * Document doc;
+ * auto result = doc.open_with_config("upload.docx", config);
+ * if (!result.is_usable()) {
+ *     // result.errors holds a LoadErrorType::Timeout entry
+ * }
+ * @endcode
+ *
+ * @since 0.8.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace cdocx {
+
+/**
+ * @enum CancellationReason
+ * @brief Why a token reports cancellation
+ */
+enum class CancellationReason : std::uint8_t {
+    None,             ///< Not cancelled
+    Cancelled,        ///< cancel() was called
+    DeadlineExceeded  ///< The deadline has passed
+};
+
+/**
+ * @class CancellationToken
+ * @brief Shared cancellation flag with an optional deadline
+ * @since 0.8.0
+ */
+class CancellationToken {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() : state_(std::make_shared<State>()) {}
+
+    /// Request cancellation; thread-safe, may be called from any thread
+    void cancel() { state_->cancelled.store(true, std::memory_order_release); }
+
+    /// Cancel automatically once @p deadline has passed
+    CancellationToken& set_deadline(Clock::time_point deadline) {
+        state_->deadline.store(deadline.time_since_epoch().count(), std::memory_order_release);
+        return *this;
+    }
+
+    /// Cancel automatically @p timeout from now
+    CancellationToken& set_timeout(Clock::duration timeout) {
+        return set_deadline(Clock::now() + timeout);
+    }
+
+    /// True if a deadline has been set
+    bool has_deadline() const {
+        return state_->deadline.load(std::memory_order_acquire) != kNoDeadline;
+    }
+
+    Clock::time_point get_deadline() const {
+        return Clock::time_point(Clock::duration(state_->deadline.load(std::memory_order_acquire)));
+    }
+
+    /// True once cancel() was called or the deadline has passed
+    bool is_cancelled() const { return get_reason() != CancellationReason::None; }
+
+    CancellationReason get_reason() const {
+        if (state_->cancelled.load(std::memory_order_acquire)) {
+            return CancellationReason::Cancelled;
+        }
+        const Clock::rep deadline = state_->deadline.load(std::memory_order_acquire);
+        if (deadline != kNoDeadline && Clock::now().time_since_epoch().count() >= deadline) {
+            return CancellationReason::DeadlineExceeded;
+        }
+        return CancellationReason::None;
+    }
+
+  private:
+    static constexpr Clock::rep kNoDeadline = Clock::duration::max().count();
+
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::atomic<Clock::rep> deadline{kNoDeadline};
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+}  // namespace cdocx
@@ -74,25 +74,49 @@ class Comment : public CompositeNode {
     Comment(Document* doc, std::string author, const std::string& text);
 
     int get_id() const { return id_; }
-    void set_id(int id) { id_ = id; }
+    /// Also re-keys the comment in its document and renumbers its range anchors
+    void set_id(int id);
 
     std::string get_author() const { return author_; }
-    void set_author(const std::string& author) { author_ = author; }
+    void set_author(const std::string& author) {
+        author_ = author;
+        modified_ = true;
+    }
 
     std::string get_initial() const { return initial_; }
-    void set_initial(const std::string& initial) { initial_ = initial; }
+    void set_initial(const std::string& initial) {
+        initial_ = initial;
+        modified_ = true;
+    }
 
     std::string get_text() const override;
     void set_text(const std::string& text);
 
     std::chrono::system_clock::time_point get_date_time() const { return date_time_; }
-    void set_date_time(std::chrono::system_clock::time_point dt) { date_time_ = dt; }
+    void set_date_time(std::chrono::system_clock::time_point dt) {
+        date_time_ = dt;
+        modified_ = true;
+    }
 
     bool is_done() const { return done_; }
-    void set_done(bool done) { done_ = done; }
+    void set_done(bool done) {
+        done_ = done;
+        modified_ = true;
+    }
 
     int get_parent_comment_id() const { return parent_comment_id_; }
-    void set_parent_comment_id(int id) { parent_comment_id_ = id; }
+    void set_parent_comment_id(int id) {
+        parent_comment_id_ = id;
+        modified_ = true;
+    }
+
+    /**
+     * @brief True if the comment must be re-serialized on the next save
+     * @details Set by this class's setters. Edits made through child nodes,
+     *          formatting included, are detected on sync.
+     */
+    bool is_modified() const { return modified_; }
+    void set_modified(bool modified) { modified_ = modified; }
 
     NodeType node_type() const override { return NodeType::Comment; }
     void accept(DocumentVisitor* visitor) override;
@@ -108,24 +132,28 @@ class Comment : public CompositeNode {
     std::chrono::system_clock::time_point date_time_;
     bool done_ = false;
     int parent_comment_id_ = -1;
+    bool modified_ = true;
 };
 
 // ============================================================================
 // CommentCollection - Typed access to document comments
 // ============================================================================
 
+/**
+ * @brief View over the comments of a document
+ * @details Reads the document's comment list in place rather than copying it,
+ *          so adding or removing comments invalidates its iterators.
+ */
 class CommentCollection {
   private:
     friend class Document;
 
     Document* doc_;
-    mutable std::vector<std::shared_ptr<Comment>> comments_;
-    mutable bool collected_ = false;
 
-    void collect_comments() const;
+    std::vector<std::shared_ptr<Comment>>& comments() const;
 
   public:
-    CommentCollection() : doc_(nullptr), collected_(true) {}
+    CommentCollection() : doc_(nullptr) {}
     explicit CommentCollection(Document* doc);
 
     size_t count() const;
@@ -0,0 +1,73 @@
+/**
+ * @file compression.h
+ * @brief Selectable deflate backends for package I/O
+ * @details Every part of a .docx package is deflate-compressed, so on large
+ *          packages load and save time is dominated by the codec. The bundled
+ *          ZIP library is always available; libdeflate and zlib-ng are used
+ *          when they were found at configure time (CDOCX_WITH_LIBDEFLATE,
+ *          CDOCX_WITH_ZLIB_NG).
+ *
+ *          With a non-bundled backend the package is read from a memory
+ *          mapping and every entry is inflated straight into its final buffer,
+ *          and saving writes the archive directly. Packages the direct reader
+ *          does not handle (encrypted or multi-disk archives) and saves of
+ *          4 GB and more fall back to the bundled library.
+ *
+ *          LoadConfig defaults to the fastest backend that was compiled in
+ *          (get_default_compression_backend()): zlib-ng, then libdeflate,
+ *          then the bundled library.
+ *
+ *          With zlib-ng, parts of 2 MB and more are split into 1 MB blocks
+ *          that are deflated and checksummed on all cores (pigz style), each
+ *          block primed with the 32 KB before it, and joined into a single
+ *          deflate stream. LoadConfig::max_threads caps the thread count.
+ *
+ *          Throughput of the last load and save is reported through
+ *          LoadStatistics and SaveStatistics.
+ *
+ * @par Usage Example:
+ * @code
+ * LoadConfig config;
+ * if (is_compression_backend_available(CompressionBackend::Libdeflate)) {
+ *     config.compression_backend = CompressionBackend::Libdeflate;
+ * }
+ *
+ * Document doc;
+ * doc.open_with_config("large.docx", config);
+ * std::cout << doc.get_last_load_statistics().get_inflate_mb_per_s() << " MB/s\n";
+ * @endcode
+ *
+ * @since 0.8.0
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace cdocx {
+
+/**
+ * @enum CompressionBackend
+ * @brief Deflate implementation used to read and write packages
+ */
+enum class CompressionBackend : std::uint8_t {
+    Bundled,     ///< Deflate of the bundled ZIP library (always available)
+    Libdeflate,  ///< libdeflate; whole-buffer codec, fastest for in-memory parts
+    ZlibNg       ///< zlib-ng native API
+};
+
+/// True if @p backend was compiled in; unavailable backends fall back to Bundled
+bool is_compression_backend_available(CompressionBackend backend);
+
+/// Fastest backend compiled in (zlib-ng, libdeflate, bundled); the LoadConfig default
+CompressionBackend get_default_compression_backend();
+
+/// Display name of @p backend ("bundled", "libdeflate", "zlib-ng")
+const char* get_compression_backend_name(CompressionBackend backend);
+
+/// Throughput in MB/s of @p bytes processed in @p ms milliseconds (0 if nothing was timed)
+inline double compute_mb_per_s(std::uint64_t bytes, double ms) {
+    return ms > 0.0 ? static_cast<double>(bytes) / (ms * 1000.0) : 0.0;
+}
+
+}  // namespace cdocx
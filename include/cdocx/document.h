@@ -40,22 +40,30 @@
 
 #pragma once
 
+#include <cdocx/cancellation.h>
+#include <cdocx/compression.h>
 #include <cdocx/enums.h>
 #include <cdocx/format.h>
 #include <cdocx/node.h>
 #include <cdocx/numbering.h>
+#include <cdocx/pagination.h>
 #include <cdocx/properties.h>
+#include <cdocx/statistics.h>
+#include <cdocx/table_of_contents.h>
 #include <zip.h>
 
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <iosfwd>
 #include <map>
 #include <memory>
 #include <pugixml.hpp>
 #include <set>
 #include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace cdocx {
@@ -79,6 +87,10 @@ class ParagraphCollection;
 class TableCollection;
 class StyleCollection;
 class Watermark;
+class CompareOptions;
+class HtmlSaveOptions;
+class ZipArchiveReader;
+class ZipArchiveWriter;
 
 // ============================================================================
 // Document Package Tree Types (Physical structure)
@@ -199,6 +211,19 @@ struct LoadConfig {
     size_t max_errors = 100;
     std::function<void(int percent, const std::string& current_file)> progress_callback;
 
+    // Abort limits, checked per entry, per inflated chunk and per load phase. Exceeding a
+    // size limit fails the load even with skip_corrupted_files, since a save would drop the part.
+    CancellationToken cancellation_token;
+    uint64_t max_entry_size = 0;       ///< Uncompressed bytes per entry (0 = no limit)
+    uint64_t max_total_size = 0;       ///< Uncompressed bytes for the package (0 = no limit)
+    double max_compression_ratio = 0;  ///< Uncompressed/compressed size per entry (0 = no limit)
+
+    /// Codec for reading this package and for later saves (see compression.h)
+    CompressionBackend compression_backend = get_default_compression_backend();
+
+    /// Password of an encrypted package; kept to encrypt later saves (see encryption.h)
+    std::string password;
+
     static LoadConfig optimized_for_speed() {
         LoadConfig cfg;
         cfg.enable_parallel_loading = true;
@@ -207,6 +232,11 @@ struct LoadConfig {
     }
 };
 
+struct SaveConfig {
+    /// Drop media that no part references before writing (see Document::collect_unused_media())
+    bool remove_unused_media = false;
+};
+
 enum class LoadErrorType : std::uint8_t {
     None,
     ZipOpenFailed,
@@ -217,6 +247,11 @@ enum class LoadErrorType : std::uint8_t {
     MemoryAllocation,
     IoError,
     Timeout,
+    Cancelled,
+    LimitExceeded,
+    PasswordRequired,       ///< The package is encrypted and LoadConfig::password is empty
+    InvalidPassword,        ///< LoadConfig::password does not open the package
+    UnsupportedEncryption,  ///< Standard encryption, or a build without OpenSSL
     Unknown
 };
 
@@ -271,9 +306,42 @@ struct LoadStatistics {
     size_t media_files = 0;
     size_t binary_files = 0;
 
+    // Codec throughput; inflate_ms is summed over all loader threads
+    CompressionBackend compression_backend = CompressionBackend::Bundled;
+    uint64_t compressed_bytes = 0;
+    uint64_t uncompressed_bytes = 0;
+    double inflate_ms = 0.0;
+
+    double get_elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    }
+    double get_inflate_mb_per_s() const { return compute_mb_per_s(uncompressed_bytes, inflate_ms); }
+};
+
+struct SaveStatistics {
+    std::chrono::high_resolution_clock::time_point start_time;
+    std::chrono::high_resolution_clock::time_point end_time;
+    size_t entries = 0;
+
+    CompressionBackend compression_backend = CompressionBackend::Bundled;
+    uint64_t uncompressed_bytes = 0;
+    uint64_t package_bytes = 0;   ///< Size of the written package
+    double deflate_ms = 0.0;      ///< Compressing and writing the entries
+    size_t parallel_entries = 0;  ///< Large entries deflated as concurrent blocks
+    size_t removed_media = 0;     ///< Media dropped by SaveConfig::remove_unused_media
+    uint64_t removed_media_bytes = 0;
+
     double get_elapsed_ms() const {
         return std::chrono::duration<double, std::milli>(end_time - start_time).count();
     }
+    double get_deflate_mb_per_s() const { return compute_mb_per_s(uncompressed_bytes, deflate_ms); }
+};
+
+/// What Document::collect_unused_media() removed from the package
+struct MediaCleanupResult {
+    size_t removed_files = 0;
+    uint64_t removed_bytes = 0;
+    size_t removed_relationships = 0;  ///< Image relationships no part used
 };
 
 // ============================================================================
@@ -306,6 +374,10 @@ class Document : public CompositeNode {
     void close();
     void save();
     void save(const std::string& filepath);
+    /// Saves in @p format (Auto picks it from the extension); false if the
+    /// save failed or there is no writer for the format
+    bool save(const std::string& filepath, SaveFormat format);
+    bool save(const std::string& filepath, const CancellationToken& token);
     bool is_open() const { return is_open_; }
 
     // Document creation
@@ -370,7 +442,7 @@ class Document : public CompositeNode {
     pugi::xml_document& create_xml_part(const std::string& part_path);
     void remove_xml_part(const std::string& part_path);
     void mark_modified(const std::string& part_path);
-    void mark_xml_paragraph_dirty(pugi::xml_node para) { dirty_xml_paragraphs_.insert(para); }
+    void mark_xml_paragraph_dirty(pugi::xml_node para);
 
     // Convenience XML accessors
     pugi::xml_document* get_document_xml();
@@ -403,10 +475,23 @@ class Document : public CompositeNode {
     bool replace_media(const std::string& image_name, const std::string& new_image_path);
     bool has_media(const std::string& image_name) const;
     std::vector<std::string> list_media() const;
+    /// Names of the media files, viewing the media index; valid until media is added or removed
+    std::vector<std::string_view> get_media_names() const;
+    /// Name of a media file with exactly this content, or an empty string
+    std::string find_media_by_content(const std::vector<uint8_t>& data) const;
     bool export_media(const std::string& image_name, const std::string& output_path) const;
     std::vector<uint8_t> get_media_data(const std::string& image_name) const;
     std::string add_media_with_rel(const std::string& image_path,
                                    const std::string* image_name = nullptr);
+    /**
+     * @brief Removes media that no part of the package references
+     * @details Image relationships whose id is not used in their source part
+     *          (a:blip r:embed, v:imagedata r:id, ...) are dropped first, then
+     *          every file under word/media/ that no remaining relationship
+     *          targets. Media shared by several parts stays while any of them
+     *          uses it. Unlike delete_media(), never removes an image in use.
+     */
+    MediaCleanupResult collect_unused_media();
 
     // Thumbnail management (opt-in, for file preview in Windows Explorer)
     bool add_thumbnail(const std::string& image_path);
@@ -424,6 +509,8 @@ class Document : public CompositeNode {
     std::shared_ptr<Comment> get_comment(int id) const;
     CommentCollection get_comments() const;
     bool remove_comment(int id);
+    /// Removes the comments @p predicate returns true for, in one pass; returns the count
+    int remove_comments_if(const std::function<bool(const Comment&)>& predicate);
     void clear_comments();
     int get_next_comment_id();
 
@@ -449,6 +536,23 @@ class Document : public CompositeNode {
     DocumentProperties& get_builtin_document_properties() { return builtin_properties_; }
     DocumentProperties& get_custom_document_properties() { return custom_properties_; }
 
+    // Document statistics, written to docProps/app.xml on sync (see statistics.h)
+    const DocumentStatistics& update_statistics();
+    const DocumentStatistics& get_statistics() const { return statistics_; }
+    void set_update_statistics_on_sync(bool enabled) { update_statistics_on_sync_ = enabled; }
+    bool get_update_statistics_on_sync() const { return update_statistics_on_sync_; }
+
+    // Table of contents: fills the TOC fields from the headings and returns how many
+    // were updated; the headings found stay in get_toc_entries() (see table_of_contents.h)
+    int update_table_of_contents();
+    const std::vector<TocEntry>& get_toc_entries() const { return toc_entries_; }
+
+    // Approximate pagination: lays out the body and returns the page count; page
+    // numbers are 1-based estimates, 0 before the first update (see pagination.h)
+    int update_pagination();
+    int get_page_count() const;
+    int get_page_number(const Node& node) const;
+
     // Default tab stop (in points)
     double get_default_tab_stop() const;
     void set_default_tab_stop(double points);
@@ -456,6 +560,17 @@ class Document : public CompositeNode {
     // Watermark
     Watermark watermark();
 
+    // HTML export (streamed, see html_writer.h)
+    bool save_html(const std::string& filepath);
+    bool save_html(const std::string& filepath, const HtmlSaveOptions& options);
+    bool save_html(std::ostream& out);
+    bool save_html(std::ostream& out, const HtmlSaveOptions& options);
+
+    // Document comparison: writes the differences to @p revised as tracked changes
+    // (w:ins / w:del) into this document; returns the number of changed blocks
+    int compare(Document& revised);
+    int compare(Document& revised, const CompareOptions& options);
+
     // Document protection
     void protect(ProtectionType type, const std::string& password = "");
     void unprotect();
@@ -463,6 +578,22 @@ class Document : public CompositeNode {
 
     // Statistics
     LoadResult get_last_load_result() const { return last_load_result_; }
+    LoadStatistics get_last_load_statistics() const { return last_load_stats_; }
+    SaveStatistics get_last_save_statistics() const { return last_save_stats_; }
+
+    // Options applied by every later save
+    void set_save_config(const SaveConfig& config) { save_config_ = config; }
+    const SaveConfig& get_save_config() const { return save_config_; }
+
+    // Codec used by the next save; initialized from LoadConfig::compression_backend
+    void set_compression_backend(CompressionBackend backend) {
+        load_config_.compression_backend = backend;
+    }
+    CompressionBackend get_compression_backend() const { return load_config_.compression_backend; }
+
+    // Password the next save is encrypted with; empty saves a plain package (see encryption.h)
+    void set_encryption_password(const std::string& password) { load_config_.password = password; }
+    bool is_encrypted() const { return !load_config_.password.empty(); }
 
     // Internal: Get physical tree (for advanced users)
     DocxTree& get_physical_tree() { return tree_; }
@@ -488,11 +619,20 @@ class Document : public CompositeNode {
     std::string filepath_;
     bool is_open_ = false;
     LoadConfig load_config_;
+    SaveConfig save_config_;
     DocxTree tree_;
 
     // Caches
     std::map<std::string, std::shared_ptr<DocxTreeNode>> xml_parts_cache_;
-    std::map<std::string, std::shared_ptr<DocxTreeNode>> media_files_cache_;
+
+    // Files under word/media/ by name, kept by load and the media functions
+    struct MediaEntry {
+        std::shared_ptr<DocxTreeNode> node;
+        size_t size = 0;
+        mutable std::uint64_t hash = 0;  ///< FNV-1a of the content, 0 until first needed
+    };
+    std::map<std::string, MediaEntry, std::less<>> media_index_;
+
     std::map<std::string, std::vector<Relationship>> relationships_;
     std::set<std::string> modified_parts_;
     std::vector<ContentType> content_types_;
@@ -500,9 +640,14 @@ class Document : public CompositeNode {
     // ZIP handling
     zip_t* zip_handle_ = nullptr;
     bool zip_dirty_ = false;
+    // Opened instead of zip_handle_ when a non-bundled compression backend is selected
+    std::unique_ptr<ZipArchiveReader> archive_reader_;
+    // Decrypted package that zip_handle_ reads from while an encrypted file is loaded
+    std::vector<uint8_t> decrypted_package_;
 
     // Statistics
     LoadStatistics last_load_stats_;
+    SaveStatistics last_save_stats_;
     LoadResult last_load_result_;
 
     // DOM state (Document contains Sections as children)
@@ -526,6 +671,29 @@ class Document : public CompositeNode {
     // Properties
     DocumentProperties builtin_properties_;
     DocumentProperties custom_properties_;
+    /// property element of each custom property in docProps/custom.xml, by name
+    std::unordered_map<std::string, pugi::xml_node> custom_property_nodes_;
+
+    // Statistics of each counted paragraph and the content version it was counted at
+    struct CountedParagraph {
+        std::uint64_t version = 0;
+        DocumentStatistics counts;
+    };
+    using StatisticsCache = std::unordered_map<const Paragraph*, CountedParagraph>;
+    StatisticsCache statistics_cache_;
+    DocumentStatistics statistics_;
+    bool update_statistics_on_sync_ = true;
+
+    // Headings listed by the last update_table_of_contents()
+    std::vector<TocEntry> toc_entries_;
+
+    // Layout of the last update_pagination(), kept to resume from the first change
+    struct PaginationState;
+    std::unique_ptr<PaginationState> pagination_;
+
+    // Body text offset of each paragraph, built by Range::from_offsets() and dropped on edits
+    struct TextOffsetIndex;
+    std::unique_ptr<TextOffsetIndex> text_index_;
 
     // Header/Footer counters
     int next_header_number_ = 1;
@@ -533,7 +701,10 @@ class Document : public CompositeNode {
     int next_bookmark_id_ = 1;
     int next_comment_id_ = 0;
 
+    friend class Comment;
     friend class CommentCollection;
+    friend class Footnote;
+    friend class Range;
     friend class FootnoteCollection;
     friend class EndnoteCollection;
 
@@ -541,6 +712,9 @@ class Document : public CompositeNode {
     mutable std::vector<std::shared_ptr<Comment>> comments_cache_;
     mutable bool comments_dirty_ = true;
 
+    // CommentRangeStart/End nodes of each comment id, indexed when the comments are loaded
+    std::unordered_map<int, std::vector<std::weak_ptr<Node>>> comment_anchors_;
+
     // Footnotes/Endnotes cache
     mutable std::vector<std::shared_ptr<Footnote>> footnotes_cache_;
     mutable std::vector<std::shared_ptr<Footnote>> endnotes_cache_;
@@ -549,18 +723,48 @@ class Document : public CompositeNode {
     int next_footnote_id_ = 1;
     int next_endnote_id_ = 1;
 
+    // Serialized element of a comment/note and its content signature at the last sync
+    struct SyncedXmlItem {
+        pugi::xml_node node;
+        std::uint64_t signature = 0;
+    };
+
+    // Per-part bookkeeping for comments, footnotes and endnotes: O(1) id
+    // lookup, one-time part registration and incremental serialization
+    template <typename T>
+    struct AnnotationIndex {
+        std::unordered_map<int, std::shared_ptr<T>> by_id;
+        std::unordered_map<const T*, SyncedXmlItem> synced;
+        pugi::xml_document* part = nullptr;  ///< Part the synced elements belong to
+        bool registered = false;             ///< Content type and relationship added
+
+        void clear() {
+            by_id.clear();
+            synced.clear();
+            part = nullptr;
+            registered = false;
+        }
+    };
+
+    AnnotationIndex<Comment> comments_index_;
+    AnnotationIndex<Footnote> footnotes_index_;
+    AnnotationIndex<Footnote> endnotes_index_;
+
     // Section properties
     SectionProperties default_section_properties_;
 
 
     // Internal methods
     bool open_zip(const std::string& path);
+    bool open_encrypted_zip(const std::string& path, LoadError& error);
     void close_zip();
     bool ensure_zip_handle();
     std::vector<uint8_t> read_zip_entry(const std::string& entry_name);
     bool load_tree_from_zip();
     LoadResult load_tree_with_result();
-    bool load_tree_parallel(LoadStatistics& stats);
+    bool load_tree_parallel(LoadStatistics& stats, LoadResult& result, bool& aborted);
+    void abort_load(LoadResult& result);
+    bool check_load_cancelled(LoadResult& result);
     void build_caches_from_tree();
     void report_progress(int percent, const std::string& current_file) const;
 
@@ -585,14 +789,20 @@ class Document : public CompositeNode {
     void add_content_type_default(const std::string& extension, const std::string& content_type);
 
     // Save operations
-    bool save_to_zip(const std::string& output_path);
-    bool save_tree_to_zip(::zip_t* zip);
+    bool save_impl(const std::string& filepath, const CancellationToken* token);
+    bool save_to_zip(const std::string& output_path, const CancellationToken* token = nullptr);
+    bool save_to_buffer(std::vector<uint8_t>& package, const CancellationToken* token);
+    bool save_encrypted(const std::string& output_path, const CancellationToken* token);
+    bool save_tree_to_zip(::zip_t* zip, const CancellationToken* token = nullptr);
+    bool save_tree_to_archive(ZipArchiveWriter& writer, const CancellationToken* token);
     bool write_tree_node(::zip_t* zip, const std::shared_ptr<DocxTreeNode>& node);
 
     // Media helpers
     std::string get_mime_type(const std::string& filename) const;
     std::string get_extension_from_mime(const std::string& mime_type) const;
     std::string generate_unique_image_name(const std::string& base_name) const;
+    void index_media(const std::string& name, const std::shared_ptr<DocxTreeNode>& node);
+    MediaCleanupResult sweep_unused_media();
 
     // Create empty document
     bool create_empty_document();
@@ -609,6 +819,10 @@ class Document : public CompositeNode {
     void sync_styles_from_physical();
     void sync_comments_to_physical();
     void sync_comments_from_physical();
+    void index_comment_anchors();
+    void remove_comment_anchors(int id);
+    void rename_comment(const Comment& comment, int old_id);
+    void rename_note(const Footnote& note, int old_id);
     void sync_footnotes_to_physical();
     void sync_footnotes_from_physical();
     void sync_endnotes_to_physical();
@@ -617,6 +831,10 @@ class Document : public CompositeNode {
     void sync_builtin_properties_from_physical();
     void sync_custom_properties_to_physical();
     void sync_custom_properties_from_physical();
+    void write_custom_property(pugi::xml_node root, const std::string& name, CustomProperty& prop);
+    void count_statistics(const CompositeNode& node,
+                          StatisticsCache& counted,
+                          DocumentStatistics& total);
     std::shared_ptr<Body> parse_body_from_xml(pugi::xml_node body_node);
     std::shared_ptr<Paragraph> parse_paragraph_from_xml(pugi::xml_node para_node);
     std::shared_ptr<Table> parse_table_from_xml(pugi::xml_node table_node);
@@ -17,6 +17,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace cdocx {
 
@@ -120,6 +121,7 @@ class DocumentBuilder {
     std::shared_ptr<FormField> insert_form_field_impl(const std::shared_ptr<FormField>& field);
     void ensure_paragraph();
     void apply_formatting(pugi::xml_node run) const;
+    void write_run(std::string_view text);
     pugi::xml_node get_body();
 
   public:
@@ -136,9 +138,9 @@ class DocumentBuilder {
     bool move_to_merge_field(const std::string& field_name);
     DocumentBuilder& move_to_cell(size_t table_index, size_t row_index, size_t cell_index);
 
-    // Text Insertion
-    DocumentBuilder& write(const std::string& text);
-    DocumentBuilder& writeln(const std::string& text);
+    // Text Insertion ('\t', '\n', '\v', '\f' become tabs and breaks, '\r' a new paragraph)
+    DocumentBuilder& write(std::string_view text);
+    DocumentBuilder& writeln(std::string_view text);
     DocumentBuilder& writeln();
 
     // Paragraph Operations
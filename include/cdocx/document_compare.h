@@ -0,0 +1,165 @@
+/**
+ * @file document_compare.h
+ * @brief Document comparison for CDocx
+ * @details Compares two documents block by block. Every paragraph and table is
+ *          reduced to a 64-bit fingerprint (text plus normalized formatting,
+ *          table cell hashes), the fingerprint sequences are aligned with a
+ *          Myers diff, and only the blocks that differ are diffed at word/run
+ *          level. The result is reported as a change list or written into the
+ *          original document as tracked changes (w:ins / w:del).
+ *
+ * @par Usage Example:
+ * @code
+ * Document original("original.docx");
+ * Document revised("modified.docx");
+ * original.open();
+ * revised.open();
+ *
+ * CompareOptions options;
+ * options.set_granularity(Granularity::WordLevel).set_author("Legal");
+ *
+ * // Structured change list
+ * auto changes = DocumentComparer::compare(original, revised, options);
+ *
+ * // Redline: tracked changes written into the original document
+ * original.compare(revised, options);
+ * original.save();
+ * @endcode
+ *
+ * @since 0.8.0
+ */
+
+#pragma once
+
+#include <cdocx/enums.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace cdocx {
+
+class Document;
+
+// ============================================================================
+// Compare Options
+// ============================================================================
+
+/**
+ * @enum Granularity
+ * @brief Level at which changed paragraphs are diffed
+ */
+enum class Granularity : std::uint8_t {
+    BlockLevel,  ///< Changed paragraphs are reported as a whole
+    WordLevel,   ///< Words, whitespace runs and punctuation
+    CharLevel    ///< Single characters (UTF-8 code points)
+};
+
+/**
+ * @class CompareOptions
+ * @brief Options controlling DocumentComparer
+ */
+class CompareOptions {
+  public:
+    CompareOptions& set_granularity(Granularity granularity) {
+        granularity_ = granularity;
+        return *this;
+    }
+    Granularity get_granularity() const { return granularity_; }
+
+    /// Ignore run/paragraph formatting; only text differences are reported
+    CompareOptions& set_ignore_formatting(bool value) {
+        ignore_formatting_ = value;
+        return *this;
+    }
+    bool get_ignore_formatting() const { return ignore_formatting_; }
+
+    /// Author recorded on generated w:ins / w:del elements
+    CompareOptions& set_author(const std::string& author) {
+        author_ = author;
+        return *this;
+    }
+    const std::string& get_author() const { return author_; }
+
+    /// Revision date (0 = current time)
+    CompareOptions& set_date(std::time_t date) {
+        date_ = date;
+        return *this;
+    }
+    std::time_t get_date() const { return date_; }
+
+  private:
+    Granularity granularity_ = Granularity::WordLevel;
+    bool ignore_formatting_ = false;
+    std::string author_ = "CDocx";
+    std::time_t date_ = 0;
+};
+
+// ============================================================================
+// Change List
+// ============================================================================
+
+/**
+ * @enum ChangeType
+ * @brief Kind of difference between the original and revised document
+ */
+enum class ChangeType : std::uint8_t {
+    Inserted,  ///< Present only in the revised document
+    Deleted,   ///< Present only in the original document
+    Modified   ///< Present in both, content or formatting differs
+};
+
+/**
+ * @struct InlineChange
+ * @brief Word/character level change inside a modified paragraph
+ */
+struct InlineChange {
+    ChangeType type = ChangeType::Inserted;  ///< Inserted or Deleted
+    std::size_t offset = 0;  ///< Byte offset in original text (deletions) or revised text
+    std::string text;
+};
+
+/**
+ * @struct BlockChange
+ * @brief Change of one body-level paragraph or table
+ */
+struct BlockChange {
+    ChangeType type = ChangeType::Modified;
+    NodeType block_type = NodeType::Paragraph;  ///< Paragraph or Table
+    int original_index = -1;  ///< Block index in the original body (-1 for insertions)
+    int revised_index = -1;   ///< Block index in the revised body (-1 for deletions)
+    std::string original_text;
+    std::string revised_text;
+    bool formatting_changed = false;  ///< Text is equal, formatting differs
+    std::vector<InlineChange> inline_changes;
+};
+
+// ============================================================================
+// DocumentComparer
+// ============================================================================
+
+/**
+ * @class DocumentComparer
+ * @brief Static utility class for comparing two documents
+ * @since 0.8.0
+ */
+class DocumentComparer {
+  public:
+    /// Compute the change list; neither document is modified
+    static std::vector<BlockChange> compare(Document& original,
+                                            Document& revised,
+                                            const CompareOptions& options = CompareOptions());
+
+    /**
+     * @brief Write the differences into @p original as tracked changes
+     * @return Change list of the applied revisions
+     */
+    static std::vector<BlockChange> apply_redline(
+        Document& original,
+        Document& revised,
+        const CompareOptions& options = CompareOptions());
+};
+
+}  // namespace cdocx
@@ -0,0 +1,52 @@
+/**
+ * @file encryption.h
+ * @brief Password-protected (encrypted) packages
+ * @details Word encrypts a password-protected document with ECMA-376 Agile
+ *          encryption and stores it in an OLE compound file instead of a ZIP
+ *          archive. Set LoadConfig::password to open such a file; the package
+ *          is decrypted into memory and loaded as usual, and later saves are
+ *          encrypted with the same password. Document::set_encryption_password()
+ *          encrypts (or, with an empty password, decrypts) the next save.
+ *
+ *          Saves use Word's defaults: AES-256-CBC, SHA-512 with 100000 spins
+ *          for the password, and an HMAC over the encrypted package that is
+ *          verified when opening. The package is processed in 4096-byte
+ *          segments on all cores (LoadConfig::max_threads caps the count);
+ *          AES and SHA come from OpenSSL, which uses AES-NI/VAES and the SHA
+ *          extensions where the CPU has them. Encryption needs a build with
+ *          OpenSSL (CDOCX_WITH_OPENSSL); without it encrypted files fail to
+ *          open with LoadErrorType::UnsupportedEncryption and saves with a
+ *          password fail.
+ *
+ *          Opening fails with LoadErrorType::PasswordRequired when no password
+ *          was given and with InvalidPassword when it does not match. Files
+ *          using the older Standard encryption are reported as
+ *          UnsupportedEncryption.
+ *
+ * @par Usage Example:
+ * @code
+ * LoadConfig config;
+ * config.password = "secret";
+ *
+ * Document doc;
+ * LoadResult result = doc.open_with_config("protected.docx", config);
+ * if (!result.is_usable()) {
+ *     return;
+ * }
+ * doc.save("copy.docx");  // Encrypted with "secret"
+ *
+ * doc.set_encryption_password("");
+ * doc.save("plain.docx");
+ * @endcode
+ *
+ * @since 0.8.0
+ */
+
+#pragma once
+
+namespace cdocx {
+
+/// True if cdocx was built with OpenSSL and can open and save encrypted packages
+bool is_encryption_available();
+
+}  // namespace cdocx
@@ -251,6 +251,16 @@ enum class FootnoteType : std::uint8_t {
     Endnote = 1
 };
 
+// ============================================================================
+// Revision Types
+// ============================================================================
+
+enum class RevisionType : std::uint8_t {
+    None,       ///< Not a tracked change
+    Insertion,  ///< Run wrapped in w:ins
+    Deletion    ///< Run wrapped in w:del (text stored as w:delText)
+};
+
 // ============================================================================
 // Field Types
 // ============================================================================
@@ -26,20 +26,36 @@ class Footnote : public CompositeNode {
     Footnote(Document* doc, FootnoteType type);
 
     int get_id() const { return id_; }
-    void set_id(int id) { id_ = id; }
+    /// Also re-keys the note in its document's footnote or endnote index
+    void set_id(int id);
 
     FootnoteType get_footnote_type() const { return type_; }
-    void set_footnote_type(FootnoteType type) { type_ = type; }
+    void set_footnote_type(FootnoteType type) {
+        type_ = type;
+        modified_ = true;
+    }
 
     bool is_auto() const { return is_auto_; }
-    void set_auto(bool value) { is_auto_ = value; }
+    void set_auto(bool value) {
+        is_auto_ = value;
+        modified_ = true;
+    }
 
     std::string get_reference_mark() const { return reference_mark_; }
     void set_reference_mark(const std::string& mark) {
         reference_mark_ = mark;
         is_auto_ = mark.empty();
+        modified_ = true;
     }
 
+    /**
+     * @brief True if the note must be re-serialized on the next save
+     * @details Set by this class's setters. Edits made through child nodes,
+     *          formatting included, are detected on sync.
+     */
+    bool is_modified() const { return modified_; }
+    void set_modified(bool modified) { modified_ = modified; }
+
     std::string get_text() const override;
     void set_text(const std::string& text);
 
@@ -58,6 +74,7 @@ class Footnote : public CompositeNode {
     FootnoteType type_ = FootnoteType::Footnote;
     bool is_auto_ = true;
     std::string reference_mark_;
+    bool modified_ = true;
 };
 
 // ============================================================================
@@ -18,6 +18,8 @@
 
 namespace cdocx {
 
+struct TextProperties;
+
 /**
  * @class TextFormatContext
  * @brief Helper class for applying text formatting to XML run elements
@@ -88,6 +90,22 @@ class TextFormatContext {
      */
     static bool apply_underline(pugi::xml_node run, bool underline);
 
+    /**
+     * @brief Apply a complete set of run properties in one pass
+     * @details Replaces the w:rPr of @p run with one holding every property
+     *          set in @p props, written in the element order of the schema
+     *          (rFonts, b, i, strike, dstrike, color, spacing, w, position,
+     *          sz, szCs, highlight, u, vertAlign). Unlike the apply_* calls
+     *          above, no existing child is looked up, so this is the fast path
+     *          for newly built runs. A w:rStyle reference already on the run
+     *          is kept; a run left without properties gets no w:rPr at all.
+     * @param[in] run The w:r XML element
+     * @param[in] props Run properties to write
+     * @return true if successful, false if run is invalid
+     * @since 0.8.0
+     */
+    static bool apply(pugi::xml_node run, const TextProperties& props);
+
   private:
     /**
      * @brief Get or create the w:rPr (run properties) element
@@ -34,7 +34,10 @@ class FormField : public Node {
     void set_form_field_type(FormFieldType type) { type_ = type; }
 
     std::string get_result() const { return result_; }
-    void set_result(const std::string& result) { result_ = result; }
+    void set_result(const std::string& result) {
+        result_ = result;
+        notify_content_changed();
+    }
 
     bool get_enabled() const { return enabled_; }
     void set_enabled(bool enabled) { enabled_ = enabled; }
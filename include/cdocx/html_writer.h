@@ -0,0 +1,124 @@
+/**
+ * @file html_writer.h
+ * @brief Streaming HTML export for CDocx
+ * @details Writes the document body to an std::ostream in a single traversal.
+ *          Each distinct paragraph/run formatting combination becomes one CSS
+ *          class that is emitted once, styles from styles.xml become "s-<id>"
+ *          classes, lists map to ul/ol/li and tables to table/tr/td (with
+ *          colspan/rowspan). Images are streamed from the package either as
+ *          data URIs or as files in an image folder.
+ *
+ *          Output is buffered per top-level block only, so memory is bounded
+ *          by the largest single table.
+ *
+ * @par Usage Example:
+ * @code
+ * HtmlSaveOptions options;
+ * options.set_css_style_sheet_type(CssStyleSheetType::Embedded);
+ * options.set_image_folder("images/");
+ * options.set_export_images_as_base64(false);
+ *
+ * doc.save_html("output.html", options);
+ * @endcode
+ *
+ * @since 0.8.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace cdocx {
+
+class Document;
+
+// ============================================================================
+// HtmlSaveOptions
+// ============================================================================
+
+/**
+ * @enum CssStyleSheetType
+ * @brief Where CSS class rules are written
+ */
+enum class CssStyleSheetType : std::uint8_t {
+    Embedded,  ///< <style> elements in the HTML stream, each rule emitted at first use
+    External,  ///< Separate stylesheet file linked from <head>
+    Inline     ///< style="" attributes, no classes (e.g. for e-mail bodies)
+};
+
+/**
+ * @class HtmlSaveOptions
+ * @brief Options controlling HtmlWriter
+ */
+class HtmlSaveOptions {
+  public:
+    HtmlSaveOptions& set_css_style_sheet_type(CssStyleSheetType type) {
+        css_style_sheet_type_ = type;
+        return *this;
+    }
+    CssStyleSheetType get_css_style_sheet_type() const { return css_style_sheet_type_; }
+
+    /// Stylesheet path for CssStyleSheetType::External (default: "styles.css")
+    HtmlSaveOptions& set_css_style_sheet_file_name(const std::string& path) {
+        css_style_sheet_file_name_ = path;
+        return *this;
+    }
+    const std::string& get_css_style_sheet_file_name() const { return css_style_sheet_file_name_; }
+
+    /// Embed images as data URIs instead of writing them to the image folder
+    HtmlSaveOptions& set_export_images_as_base64(bool value) {
+        export_images_as_base64_ = value;
+        return *this;
+    }
+    bool get_export_images_as_base64() const { return export_images_as_base64_; }
+
+    /// Directory images are written to when not exported as base64
+    HtmlSaveOptions& set_image_folder(const std::string& folder) {
+        image_folder_ = folder;
+        return *this;
+    }
+    const std::string& get_image_folder() const { return image_folder_; }
+
+    /// URL prefix used in img src (default: the image folder)
+    HtmlSaveOptions& set_image_folder_alias(const std::string& alias) {
+        image_folder_alias_ = alias;
+        return *this;
+    }
+    const std::string& get_image_folder_alias() const { return image_folder_alias_; }
+
+    /// Write <!DOCTYPE>, <html>, <head> and <body>; false emits body content only
+    HtmlSaveOptions& set_export_full_document(bool value) {
+        export_full_document_ = value;
+        return *this;
+    }
+    bool get_export_full_document() const { return export_full_document_; }
+
+  private:
+    CssStyleSheetType css_style_sheet_type_ = CssStyleSheetType::Embedded;
+    std::string css_style_sheet_file_name_ = "styles.css";
+    bool export_images_as_base64_ = true;
+    std::string image_folder_ = "images";
+    std::string image_folder_alias_;
+    bool export_full_document_ = true;
+};
+
+// ============================================================================
+// HtmlWriter
+// ============================================================================
+
+/**
+ * @class HtmlWriter
+ * @brief Static utility class for exporting a document to HTML
+ * @since 0.8.0
+ */
+class HtmlWriter {
+  public:
+    /// Stream the document body to @p out; returns false on I/O failure
+    static bool write(Document& doc,
+                      std::ostream& out,
+                      const HtmlSaveOptions& options = HtmlSaveOptions());
+};
+
+}  // namespace cdocx
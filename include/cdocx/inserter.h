@@ -44,6 +44,10 @@
 #include <cdocx/base.h>
 #include <cdocx/fwd.h>
 
+#include <cdocx/numbering.h>
+
+#include <map>
+
 #include <pugixml.hpp>
 
 namespace cdocx {
@@ -64,6 +68,8 @@ namespace cdocx {
  *
  * @par Notes:
  * - Source document content is cloned, source document is not modified
+ * - List definitions are merged into the target; identical abstract
+ *   definitions are shared and w:numId references are remapped
  * - Styles may need manual synchronization
  * - Media files like images need separate handling
  *
@@ -74,6 +80,21 @@ class DocumentInserter {
   private:
     Document* target_doc_;  ///< Target document for insertion
 
+    /// Source numId -> target numId for the insertion in progress
+    std::map<NumberingId, NumberingId> numbering_map_;
+
+    /**
+     * @brief Merge the source document's list definitions into the target
+     * @param[in] source Source document
+     */
+    void import_numbering(Document* source);
+
+    /**
+     * @brief Rewrite w:numId references below @p node using numbering_map_
+     * @param[in] node Node cloned into the target document
+     */
+    void remap_numbering(pugi::xml_node node) const;
+
     /**
      * @brief Clone a paragraph from source to target
      * @param[in] source_para Source paragraph node
@@ -4,15 +4,34 @@
  * @details Aligns with Aspose.Words C++ MailMerge API.
  *          Replaces MERGEFIELD fields with data source values.
  *
+ *          execute_to_single_document() merges many records into one output
+ *          package ("print file"): the template body is compiled once and each
+ *          record is streamed into the output document.xml as its own section.
+ *
+ * @par Usage Example:
+ * @code
+ * Document templ("letter.docx");
+ * templ.open();
+ *
+ * MailMerge merge(&templ);
+ * merge.execute_to_single_document("letters.docx",
+ *                                  [&](std::map<std::string, std::string>& record) {
+ *                                      return read_next_customer(record);
+ *                                  });
+ * @endcode
+ *
  * @since 0.8.0
  */
 
 #pragma once
 
 #include <cdocx/base.h>
+#include <cdocx/cancellation.h>
 #include <cdocx/document.h>
+#include <cdocx/record_source.h>
 #include <cdocx/section.h>
 
+#include <functional>
 #include <map>
 #include <string>
 #include <utility>
@@ -41,6 +60,13 @@ inline MailMergeCleanupOptions operator&(MailMergeCleanupOptions lhs, MailMergeC
                                                 static_cast<std::uint8_t>(rhs));
 }
 
+/**
+ * @brief Supplies data records to MailMerge::execute_to_single_document()
+ * @details Fills @p record (cleared before each call) and returns true, or
+ *          returns false when no records are left.
+ */
+using MailMergeRecordProvider = std::function<bool(std::map<std::string, std::string>& record)>;
+
 // ============================================================================
 // MailMerge
 // ============================================================================
@@ -61,6 +87,35 @@ class MailMerge {
      */
     void execute(const std::vector<std::pair<std::string, std::string>>& data);
 
+    /**
+     * @brief Merge every record into one document, one section per record.
+     * @details The template document is left unchanged. Its styles, numbering,
+     *          headers/footers and media are written to @p output_path once and
+     *          shared by all records; the body is rendered per record straight
+     *          into the output document.xml, so memory does not grow with the
+     *          number of records.
+     * @param output_path Path of the generated .docx package.
+     * @param next_record Record provider, called until it returns false.
+     * @return Number of records written, or -1 if the output could not be created.
+     */
+    int execute_to_single_document(const std::string& output_path,
+                                   const MailMergeRecordProvider& next_record);
+
+    /**
+     * @brief Merge every record of @p source into one document.
+     * @details Field names are resolved to source columns once (again only if
+     *          the source adds columns); values are read as string views, so
+     *          no per-record strings or maps are built.
+     * @return Number of records written, or -1 if the output could not be created.
+     */
+    int execute_to_single_document(const std::string& output_path, RecordSource& source);
+
+    /**
+     * @brief Merge a list of records into one document, one section per record.
+     */
+    int execute_to_single_document(const std::string& output_path,
+                                   const std::vector<std::map<std::string, std::string>>& records);
+
     /**
      * @brief Get all MERGEFIELD names available in the document.
      * @return Vector of unique field names (without MERGEFIELD prefix).
@@ -76,11 +131,33 @@ class MailMerge {
     MailMergeCleanupOptions get_cleanup_options() const { return cleanup_options_; }
     void set_cleanup_options(MailMergeCleanupOptions options) { cleanup_options_ = options; }
 
+    /// Section break separating records in execute_to_single_document()
+    /// (one of the SectionBreak* values; default: SectionBreakNextPage)
+    BreakType get_record_break_type() const { return record_break_type_; }
+    void set_record_break_type(BreakType type) { record_break_type_ = type; }
+
+    /// Token polled per paragraph by execute() and per record and part by
+    /// execute_to_single_document(), which removes its partial output and
+    /// returns -1 when cancelled
+    const CancellationToken& get_cancellation_token() const { return cancellation_token_; }
+    void set_cancellation_token(const CancellationToken& token) { cancellation_token_ = token; }
+
+    /// True if the last execute call stopped early because of the token
+    bool was_cancelled() const { return cancelled_; }
+
   private:
     Document* doc_ = nullptr;
     MailMergeCleanupOptions cleanup_options_ = MailMergeCleanupOptions::RemoveUnusedFields;
+    BreakType record_break_type_ = BreakType::SectionBreakNextPage;
+    CancellationToken cancellation_token_;
+    bool cancelled_ = false;
+
+    bool has_cleanup_option(MailMergeCleanupOptions option) const {
+        return static_cast<std::uint8_t>(cleanup_options_ & option) != 0;
+    }
 
-    void execute_impl(const std::map<std::string, std::string>& data);
+    template <typename Data>
+    void execute_impl(const Data& data);
     std::vector<std::string> collect_field_names() const;
     void apply_cleanup();
 };
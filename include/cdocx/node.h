@@ -114,6 +114,10 @@ class Node : public std::enable_shared_from_this<Node> {
 
     // Get the next sibling or parent's next sibling
     std::shared_ptr<Node> get_next_logical() const;
+
+  protected:
+    // Tell the enclosing composites that this node's text changed
+    void notify_content_changed();
 };
 
 // ============================================================================
@@ -205,6 +209,12 @@ class CompositeNode : public Node {
     virtual VisitorAction accept_end(DocumentVisitor* /*visitor*/) {
         return VisitorAction::Continue;
     }
+
+  protected:
+    friend class Node;
+
+    // A child was added or removed, or a descendant's text changed; passed up by default
+    virtual void on_content_changed() { notify_content_changed(); }
 };
 
 // ============================================================================
@@ -42,7 +42,9 @@
 
 #include <array>
 #include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
 
 namespace cdocx {
 
@@ -223,6 +225,9 @@ struct NumberingDefinition {
     // Level overrides
     std::map<NumberingLevel, LevelDefinition> level_overrides;
 
+    // Start value overrides (w:startOverride); restart the list at these levels
+    std::map<NumberingLevel, size_t> start_overrides;
+
     NumberingDefinition() = default;
     explicit NumberingDefinition(AbstractNumberingId abstract_id) : abstract_id(abstract_id) {}
 };
@@ -237,6 +242,13 @@ struct NumberingDefinition {
  * @details Handles creation, storage, and serialization of numbering
  *          definitions to the word/numbering.xml part.
  *
+ *          Abstract definitions are interned: adding a definition that is
+ *          structurally identical to an existing one (same levels, formats,
+ *          indents and fonts) reuses it, and only a new w:num instance is
+ *          created. Instances that share an abstract definition restart at
+ *          level 1 through a w:startOverride, so every list still numbers
+ *          independently.
+ *
  * @since 0.5.0
  */
 class NumberingManager {
@@ -254,6 +266,15 @@ class NumberingManager {
     // Track whether definitions were modified after loading
     bool modified_ = false;
 
+    // Interning: structural key -> abstract ID, and the key of every abstract
+    std::unordered_map<std::string, AbstractNumberingId> abstract_index_;
+    std::map<AbstractNumberingId, std::string> abstract_keys_;
+
+    // Definitions not yet written to numbering.xml
+    std::set<AbstractNumberingId> unsaved_abstract_ids_;
+    std::set<NumberingId> unsaved_num_ids_;
+    NumberingId first_unsaved_num_id_ = 1;  ///< Instances below this exist in the XML
+
   public:
     /**
      * @brief Default constructor
@@ -278,7 +299,7 @@ class NumberingManager {
     /**
      * @brief Add abstract numbering definition
      * @param def The abstract definition
-     * @return ID of the created definition
+     * @return ID of the created definition, or of an identical existing one
      */
     AbstractNumberingId add_abstract_definition(const AbstractNumberingDefinition& def);
 
@@ -361,6 +382,24 @@ class NumberingManager {
      */
     void save_to_xml(pugi::xml_node numbering_root);
 
+    /**
+     * @brief Write only the definitions added or changed since the last load/save
+     * @details New w:abstractNum elements are inserted before the first w:num,
+     *          new w:num elements are appended and changed ones replaced in
+     *          place. Everything else in @p numbering_root is left untouched.
+     * @param numbering_root Root node of word/numbering.xml
+     */
+    void save_changes_to_xml(pugi::xml_node numbering_root);
+
+    /**
+     * @brief Copy the definitions of another document into this one
+     * @details Abstract definitions are interned like add_abstract_definition();
+     *          every source instance becomes a new instance here.
+     * @param source Numbering of the source document
+     * @return Map from source NumberingId to the NumberingId in this manager
+     */
+    std::map<NumberingId, NumberingId> import_definitions(const NumberingManager& source);
+
     /**
      * @brief Check if any definitions exist
      * @return true if has definitions
@@ -383,6 +422,19 @@ class NumberingManager {
      * @brief Get or create numbering.xml
      */
     pugi::xml_document* get_numbering_xml();
+
+    /**
+     * @brief Find or add the abstract definition with structural key @p key
+     * @param[out] reused Set to true if an existing definition was returned
+     */
+    AbstractNumberingId intern_abstract_definition(const AbstractNumberingDefinition& def,
+                                                   const std::string& key,
+                                                   bool* reused);
+
+    /**
+     * @brief Add a list instance for @p def, interning the abstract definition
+     */
+    NumberingId add_list_definition(const AbstractNumberingDefinition& def);
 };
 
 // ============================================================================
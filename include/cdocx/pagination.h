@@ -0,0 +1,47 @@
+/**
+ * @file pagination.h
+ * @brief Approximate page layout of the document body
+ * @details Document::update_pagination() breaks the body into lines and pages
+ *          the way Word would, closely enough to number pages: each section is
+ *          laid out on its PageSetup (page size, margins and columns are taken
+ *          from SectionProperties), paragraphs with their indents, spacing,
+ *          line spacing and keep/page-break options (direct formatting first,
+ *          then the paragraph style, then the document defaults), and tables
+ *          row by row. Text is measured with the advance widths of the run's
+ *          font, read from the TrueType/OpenType files installed on the system
+ *          or in a directory passed to add_font_directory(); when a font is not
+ *          installed its widths are estimated. Headers, footers, floating
+ *          objects and hyphenation are not taken into account.
+ *
+ *          Every section starts on a new page and is laid out on its own
+ *          thread. The lines of each paragraph are kept with its content, so
+ *          paginating again after an edit only measures the changed paragraphs
+ *          and resumes from the first page they affect.
+ *
+ *          After an update the PAGE, NUMPAGES and SECTIONPAGES fields of the
+ *          body show the estimated numbers and the Pages property of app.xml
+ *          the page count. Once a document has been paginated,
+ *          Document::update_table_of_contents() writes page numbers into the
+ *          entries as well.
+ *
+ * @par Usage Example:
+ * @code
+ * int pages = doc.update_pagination();
+ * for (const auto& para : body->get_paragraphs()) {
+ *     std::cout << doc.get_page_number(*para) << ": " << para->get_text() << '\n';
+ * }
+ * @endcode
+ *
+ * @since 0.8.0
+ */
+
+#pragma once
+
+#include <string>
+
+namespace cdocx {
+
+/// Adds a directory searched for fonts, before the system font directories
+void add_font_directory(const std::string& path);
+
+}  // namespace cdocx
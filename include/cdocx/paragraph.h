@@ -20,6 +20,7 @@
 #include <memory>
 #include <pugixml.hpp>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace cdocx {
@@ -65,7 +66,9 @@ class Paragraph : public CompositeNode {
 
     // Run operations
     std::shared_ptr<Run> append_run(const std::string& text = "");
+    std::shared_ptr<Run> append_run(std::string&& text);
     std::shared_ptr<Run> insert_run(int index, const std::string& text = "");
+    std::shared_ptr<Run> insert_run(int index, std::string&& text);
     std::shared_ptr<Run> get_first_run() const;
     std::shared_ptr<Run> get_last_run() const;
     RunCollection get_runs() const;
@@ -114,10 +117,11 @@ class Paragraph : public CompositeNode {
 
     // Quick text setting (clears existing content)
     void set_text(const std::string& text);
+    void set_text(std::string&& text);
 
     // Append/prepend text (creates new run if needed)
-    void append_text(const std::string& text);
-    void prepend_text(const std::string& text);
+    void append_text(std::string_view text);
+    void prepend_text(std::string_view text);
 
     // Legacy API support (backward compatibility with iterator style)
     void set_parent(pugi::xml_node node);
@@ -181,7 +185,17 @@ class Paragraph : public CompositeNode {
     pugi::xml_node get_preserved_p_pr() const;
     bool has_preserved_p_pr() const;
 
+    /// Changes whenever a child is added or removed or a descendant's text changes;
+    /// unique across paragraphs, so caches can key on it without comparing text
+    std::uint64_t get_content_version() const { return content_version_; }
+
+  protected:
+    void on_content_changed() override { content_version_ = next_content_version(); }
+
   private:
+    static std::uint64_t next_content_version();
+
+    std::uint64_t content_version_ = next_content_version();
     ParagraphFormat format_;
     ListFormat list_format_;
 
@@ -12,8 +12,11 @@
 
 #include <cdocx/fwd.h>
 
+#include <pugixml.hpp>
+
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace cdocx {
 
@@ -150,17 +153,39 @@ class ParagraphBuilder {
      */
     std::shared_ptr<Paragraph> build();
 
+    /**
+     * @brief Build the paragraph directly as XML
+     * @details Appends a w:p holding the runs to @p parent (a w:body, w:tc,
+     *          w:hdr, ...) without creating Paragraph or Run objects; the
+     *          w:rPr of each run is written in one pass by
+     *          TextFormatContext::apply().
+     * @param parent Element to append the paragraph to
+     * @return The new w:p element, or an empty node if @p parent is invalid
+     */
+    pugi::xml_node build(pugi::xml_node parent) const;
+
   private:
-    std::shared_ptr<Paragraph> para_;
-    bool bold_ = false;
-    bool italic_ = false;
-    bool underline_ = false;
-    std::string font_name_;
-    int font_size_ = 0;
-    std::string color_;
+    /// Formatting the builder applies to a run
+    struct RunFormat {
+        bool bold = false;
+        bool italic = false;
+        bool underline = false;
+        std::string font_name;
+        int font_size = 0;  ///< Points, 0 = not set
+        std::string color;
+    };
+
+    /// A run added to the builder, kept until build()
+    struct RunSpec {
+        std::string text;
+        RunFormat format;
+    };
+
+    std::vector<RunSpec> runs_;
+    RunFormat format_;  ///< Formatting of subsequent runs
     std::string alignment_;
 
-    void apply_current_formatting(Run& run);
+    static void apply_format(Run& run, const RunFormat& format);
 };
 
 }  // namespace cdocx
@@ -16,10 +16,13 @@
 
 #include <cstdint>
 #include <ctime>
+#include <limits>
 #include <map>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace cdocx {
@@ -634,10 +637,39 @@ struct SectionProperties {
 // Document Properties
 // ============================================================================
 
+/**
+ * @struct CustomProperty
+ * @brief A typed custom document property
+ * @details The value keeps its type in docProps/custom.xml (vt:lpwstr, vt:i4,
+ *          vt:r8, vt:bool, vt:filetime or vt:i8). The property id (pid) is assigned
+ *          when the property is added and does not change between saves.
+ */
+struct CustomProperty {
+    /// Point in time, stored as vt:filetime
+    struct FileTime {
+        std::time_t time = 0;
+
+        bool operator==(const FileTime& other) const { return time == other.time; }
+        bool operator!=(const FileTime& other) const { return time != other.time; }
+    };
+
+    /// int is stored as vt:i4, int64_t as vt:i8
+    using Value = std::variant<std::string, int, double, bool, FileTime, std::int64_t>;
+
+    Value value;
+    int pid = 0;        ///< 2 and up; 0 and 1 are reserved by the format
+    bool dirty = true;  ///< Changed since docProps/custom.xml was last written
+
+    /// The value as text: numbers in decimal, "true"/"false", times in W3CDTF
+    std::string to_string() const;
+};
+
 /**
  * @class DocumentProperties
  * @brief Document properties (builtin and custom)
  * @details Manages document metadata properties like title, author, etc.
+ *          Custom properties are tracked per entry, so a save rewrites only
+ *          the ones that were set or removed since the previous one.
  */
 class DocumentProperties {
   public:
@@ -660,7 +692,7 @@ class DocumentProperties {
     std::time_t modified = 0;
     std::time_t last_printed = 0;
 
-    // Statistics (read-only from file)
+    // Statistics (Document::update_statistics() refreshes them on sync)
     int total_pages = 0;
     int total_words = 0;
     int total_chars = 0;
@@ -668,32 +700,87 @@ class DocumentProperties {
     int total_lines = 0;
     int total_paragraphs = 0;
 
-    // Custom properties storage (string only for simplicity)
-    std::map<std::string, std::string> custom_properties;
-
     // Methods
     DocumentProperties() = default;
 
-    // Custom property access
-    void set_custom(const std::string& name, const std::string& value) {
-        custom_properties[name] = value;
+    // Custom property access; setting an equal value leaves the property unchanged.
+    // Returns false, leaving the property as it was, for a nan or infinite double
+    // or an unsigned value above INT64_MAX.
+    bool set_custom(const std::string& name, const std::string& value) {
+        return set_custom_value(name, value);
+    }
+    bool set_custom(const std::string& name, const char* value) {
+        return set_custom_value(name, std::string(value));
+    }
+    bool set_custom(const std::string& name, double value) {
+        return set_custom_value(name, value);
+    }
+    bool set_custom(const std::string& name, bool value) { return set_custom_value(name, value); }
+    bool set_custom(const std::string& name, CustomProperty::FileTime value) {
+        return set_custom_value(name, value);
+    }
+
+    /// Any integer type (size_t, long, int64_t, ...): vt:i4 if it fits in an int, else vt:i8
+    template <typename T,
+              std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    bool set_custom(const std::string& name, T value) {
+        if constexpr (std::is_unsigned_v<T>) {
+            if (static_cast<std::uint64_t>(value) >
+                static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+                return false;
+            }
+        }
+        const auto number = static_cast<std::int64_t>(value);
+        if (number >= std::numeric_limits<int>::min() &&
+            number <= std::numeric_limits<int>::max()) {
+            return set_custom_value(name, static_cast<int>(number));
+        }
+        return set_custom_value(name, number);
     }
 
     bool has_custom(const std::string& name) const {
-        return custom_properties.find(name) != custom_properties.end();
+        return custom_properties_.find(name) != custom_properties_.end();
     }
 
+    /// Value of a custom property as text, or "" if there is none
     std::string get_custom(const std::string& name) const {
-        auto it = custom_properties.find(name);
-        if (it != custom_properties.end()) {
-            return it->second;
+        const CustomProperty* prop = get_custom_property(name);
+        return prop ? prop->to_string() : "";
+    }
+
+    /// Typed custom property, or nullptr if there is none
+    const CustomProperty* get_custom_property(const std::string& name) const {
+        auto it = custom_properties_.find(name);
+        return it != custom_properties_.end() ? &it->second : nullptr;
+    }
+
+    const std::map<std::string, CustomProperty>& get_custom_properties() const {
+        return custom_properties_;
+    }
+
+    /// Copy of every custom property as text; the map is no longer a public member
+    [[deprecated("Use get_custom_properties() or get_custom()")]]
+    std::map<std::string, std::string> custom_properties() const {
+        std::map<std::string, std::string> values;
+        for (const auto& entry : custom_properties_) {
+            values.emplace_hint(values.end(), entry.first, entry.second.to_string());
         }
-        return "";
+        return values;
     }
 
-    void remove_custom(const std::string& name) { custom_properties.erase(name); }
+    void remove_custom(const std::string& name);
+
+    void clear_custom();
+
+  private:
+    friend class Document;
+
+    bool set_custom_value(const std::string& name, CustomProperty::Value value);
 
-    void clear_custom() { custom_properties.clear(); }
+    std::map<std::string, CustomProperty> custom_properties_;
+    std::vector<std::string> dirty_custom_;    ///< Set since the last write, in order
+    std::vector<std::string> removed_custom_;  ///< Removed since the last write
+    int next_custom_pid_ = 2;
 };
 
 }  // namespace cdocx
@@ -2,7 +2,9 @@
  * @file range.h
  * @brief Document range operations for CDocx
  * @details Provides the Range class for text extraction and replacement
- *          within a specific portion of the document.
+ *          within a specific portion of the document. A range runs from an
+ *          offset in its first paragraph to an offset in its last one, so it
+ *          can start and end inside a run.
  *
  * @since 0.3.0
  */
@@ -11,12 +13,17 @@
 
 #include <cdocx/base.h>
 
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <string_view>
 
 namespace cdocx {
 
 class Document;
 class DocumentSearch;
+struct ParagraphProperties;
+struct TextProperties;
 
 // ============================================================================
 // Range
@@ -35,16 +42,79 @@ class Range {
     Document* doc_ = nullptr;
     pugi::xml_node start_para_;
     pugi::xml_node end_para_;
-    size_t start_offset_ = 0;
-    size_t end_offset_ = 0;
+    size_t start_offset_ = 0;                ///< Byte offset in the text of start_para_
+    size_t end_offset_ = std::string::npos;  ///< Byte offset in end_para_; npos for its end
+
+    int replace_matches(std::string_view old_text, std::string_view new_text, size_t max_hits);
 
   public:
     Range();
     Range(Document* doc, pugi::xml_node start, pugi::xml_node end);
 
+    /**
+     * @brief Range of the body text from character @p begin up to character @p end
+     * @details Offsets count the characters (Unicode code points, not UTF-8
+     *          bytes) of the run text of the body paragraphs, as returned by
+     *          Document::get_range().get_text(), so a range never ends inside
+     *          a character. They resolve to a paragraph in O(log n) through an
+     *          index of paragraph offsets that is kept until the body is next
+     *          edited. @p end is clamped to the text length.
+     * @return The range, or an invalid one when @p begin is after @p end or
+     *         the body has no paragraphs
+     */
+    static Range from_offsets(Document& doc, size_t begin, size_t end);
+
+    /// Text from the start offset to the end offset
     std::string get_text() const;
+
+    /**
+     * @brief Replaces the first occurrence of @p old_text
+     * @details Matches may span runs but not the range ends. Only the text
+     *          of the runs a match touches changes: the replacement takes the formatting of the
+     *          run the match starts in and all other runs keep theirs.
+     */
     bool replace(const std::string& old_text, const std::string& new_text);
+
+    /// Replaces every occurrence like replace(); returns the number replaced
     int replace_all(const std::string& old_text, const std::string& new_text);
+
+    /**
+     * @name Bulk Editing
+     * @brief Edit every paragraph of the range in one walk over the XML
+     * @details The edits go straight to word/document.xml without a DOM sync
+     *          per paragraph; the edited paragraphs are read back into the DOM
+     *          on the next save. Runs inside hyperlinks, revisions and content
+     *          controls are included, and the first and last paragraphs are
+     *          edited whole. Each returns the number of runs or paragraphs
+     *          changed, or 0 for an invalid range.
+     * @{
+     */
+
+    /// Applies @p props on top of the direct formatting of every run
+    int apply_text_properties(const TextProperties& props);
+
+    /// Applies @p props on top of the direct formatting of every paragraph
+    int apply_paragraph_properties(const ParagraphProperties& props);
+
+    /**
+     * @brief Removes the direct run and paragraph formatting
+     * @details Styles, list numbering, section breaks and tracked formatting
+     *          changes are kept. Returns the number of paragraphs changed.
+     */
+    int clear_direct_formatting();
+
+    /// Calls @p fn with the w:r element of every run; returns the number of runs
+    int for_each_run(const std::function<void(pugi::xml_node run)>& fn);
+
+    /** @} */
+
+    /**
+     * @brief Deletes the text between the range ends
+     * @details Paragraphs the range covers whole lose all their runs; in the
+     *          first and last paragraph only the text inside the range is cut
+     *          from the runs, which keep their formatting. The paragraphs
+     *          themselves stay, and the range over them is left empty.
+     */
     bool delete_content();
     bool is_valid() const;
     void collapse(bool to_start = true);
@@ -0,0 +1,172 @@
+/**
+ * @file record_source.h
+ * @brief Zero-copy data record sources for MailMerge and TemplateEngine
+ * @details A RecordSource walks a data set one record at a time and exposes
+ *          field values as std::string_view. Consumers resolve their field
+ *          names to column indices once (find_column()) and then read values
+ *          by index, so no per-record maps or strings are built.
+ *
+ *          CsvRecordSource and JsonLinesRecordSource memory-map their input
+ *          file; values point straight into the mapping. Only values that
+ *          contain escapes (doubled CSV quotes, JSON backslash escapes) are
+ *          decoded into a buffer that is reused for every record.
+ *
+ *          Views returned by get_field() stay valid until the next call to
+ *          next().
+ *
+ * @par Usage Example:
+ * @code
+ * CsvRecordSource customers("customers.csv");
+ * if (!customers.is_open()) {
+ *     return;
+ * }
+ *
+ * MailMerge merge(&templ);
+ * merge.execute_to_single_document("letters.docx", customers);
+ * @endcode
+ *
+ * @since 0.8.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cdocx {
+
+class MappedFile;
+
+// ============================================================================
+// RecordSource
+// ============================================================================
+
+/**
+ * @class RecordSource
+ * @brief Forward-only sequence of data records with indexed fields
+ * @since 0.8.0
+ */
+class RecordSource {
+  public:
+    virtual ~RecordSource() = default;
+
+    /// Advance to the next record; false at the end of the data
+    virtual bool next() = 0;
+
+    /**
+     * @brief Column names, in column index order
+     * @details Sources with a fixed header never change this list. Schema-less
+     *          sources (JSON Lines) append columns as new keys appear, so
+     *          consumers re-resolve indices when the size changes.
+     */
+    virtual const std::vector<std::string>& get_columns() const = 0;
+
+    /// Value of @p column in the current record (empty if absent or out of range)
+    virtual std::string_view get_field(std::size_t column) const = 0;
+
+    /// Case-insensitive column lookup; returns -1 if there is no such column
+    int find_column(std::string_view name) const;
+
+  protected:
+    /// Field whose unescaped value lives in a decode buffer, not in the input
+    struct DecodedField {
+        std::size_t column;
+        std::size_t offset;
+        std::size_t length;
+    };
+};
+
+// ============================================================================
+// CsvRecordSource
+// ============================================================================
+
+/**
+ * @class CsvRecordSource
+ * @brief RFC 4180 CSV reader; the first row holds the column names
+ * @details Quoted fields may contain delimiters, line breaks and doubled
+ *          quotes. CRLF and LF line endings and a UTF-8 BOM are accepted;
+ *          blank lines are skipped.
+ * @since 0.8.0
+ */
+class CsvRecordSource : public RecordSource {
+  public:
+    explicit CsvRecordSource(const std::string& path, char delimiter = ',');
+    ~CsvRecordSource() override;
+
+    CsvRecordSource(const CsvRecordSource&) = delete;
+    CsvRecordSource& operator=(const CsvRecordSource&) = delete;
+
+    /// True if the file was mapped and a header row was read
+    bool is_open() const { return open_; }
+
+    bool next() override;
+    const std::vector<std::string>& get_columns() const override { return columns_; }
+    std::string_view get_field(std::size_t column) const override;
+
+  private:
+    std::unique_ptr<MappedFile> file_;
+    std::string_view data_;
+    std::size_t pos_ = 0;
+    char delimiter_;
+    bool open_ = false;
+
+    std::vector<std::string> columns_;
+    std::vector<std::string_view> fields_;
+    std::string decoded_;  ///< Unescaped quoted fields of the current record
+    std::vector<DecodedField> decoded_fields_;
+
+    bool parse_row();
+};
+
+// ============================================================================
+// JsonLinesRecordSource
+// ============================================================================
+
+/**
+ * @class JsonLinesRecordSource
+ * @brief JSON Lines reader; one flat JSON object per line
+ * @details Object keys become columns in order of first appearance. String
+ *          values are unescaped, numbers and booleans are returned as written,
+ *          null counts as absent and nested objects/arrays are returned as
+ *          their raw JSON text. Lines that are not valid objects are skipped
+ *          and counted.
+ * @since 0.8.0
+ */
+class JsonLinesRecordSource : public RecordSource {
+  public:
+    explicit JsonLinesRecordSource(const std::string& path);
+    ~JsonLinesRecordSource() override;
+
+    JsonLinesRecordSource(const JsonLinesRecordSource&) = delete;
+    JsonLinesRecordSource& operator=(const JsonLinesRecordSource&) = delete;
+
+    /// True if the file was mapped
+    bool is_open() const { return open_; }
+
+    /// Number of lines skipped because they were not valid JSON objects
+    std::size_t get_skipped_count() const { return skipped_; }
+
+    bool next() override;
+    const std::vector<std::string>& get_columns() const override { return columns_; }
+    std::string_view get_field(std::size_t column) const override;
+
+  private:
+    std::unique_ptr<MappedFile> file_;
+    std::string_view data_;
+    std::size_t pos_ = 0;
+    bool open_ = false;
+    std::size_t skipped_ = 0;
+
+    std::vector<std::string> columns_;
+    std::vector<std::string_view> fields_;
+    std::string decoded_;  ///< Unescaped strings of the current record
+    std::vector<DecodedField> decoded_fields_;
+
+    bool parse_line(std::string_view line);
+    std::size_t column_for_key(std::string_view key, std::size_t hint);
+};
+
+}  // namespace cdocx
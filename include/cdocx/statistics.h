@@ -0,0 +1,58 @@
+/**
+ * @file statistics.h
+ * @brief Word, character, paragraph and line counts
+ * @details Document::update_statistics() counts the paragraphs of all section
+ *          bodies, including table cells, and writes the totals to the
+ *          built-in properties; sync_to_physical_tree() does this before it
+ *          writes docProps/app.xml. Counts are cached per paragraph, so after
+ *          the first update only paragraphs whose text changed are counted
+ *          again.
+ *
+ *          Counting follows Word: every East Asian character (Han ideographs,
+ *          kana) is a word of its own, other words are runs of characters
+ *          between spaces. Characters exclude spaces and breaks, empty
+ *          paragraphs are not counted, and without layout a paragraph has one
+ *          line plus one per manual line break.
+ *
+ * @par Usage Example:
+ * @code
+ * Document doc("report.docx");
+ * doc.open();
+ * const DocumentStatistics& stats = doc.update_statistics();
+ * std::cout << stats.words << " words, " << stats.characters << " characters\n";
+ * @endcode
+ *
+ * @since 0.8.0
+ */
+
+#pragma once
+
+#include <string_view>
+
+namespace cdocx {
+
+/**
+ * @struct DocumentStatistics
+ * @brief Counts shown in Word's statistics dialog
+ */
+struct DocumentStatistics {
+    int words = 0;
+    int characters = 0;              ///< Excluding spaces
+    int characters_with_spaces = 0;  ///< Including spaces and tabs
+    int paragraphs = 0;              ///< Non-empty paragraphs
+    int lines = 0;
+
+    DocumentStatistics& operator+=(const DocumentStatistics& other) {
+        words += other.words;
+        characters += other.characters;
+        characters_with_spaces += other.characters_with_spaces;
+        paragraphs += other.paragraphs;
+        lines += other.lines;
+        return *this;
+    }
+};
+
+/// Counts the UTF-8 @p text of one paragraph in a single pass
+DocumentStatistics count_text_statistics(std::string_view text);
+
+}  // namespace cdocx
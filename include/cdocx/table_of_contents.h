@@ -0,0 +1,56 @@
+/**
+ * @file table_of_contents.h
+ * @brief Table of contents entries generated from the document headings
+ * @details Document::update_table_of_contents() fills every TOC field of the
+ *          body with one paragraph per heading, the way Word does when the
+ *          field is updated, so the result is visible without opening the file
+ *          in Word first. Headings are collected in a single pass over the body
+ *          paragraphs, including table cells: a paragraph is a heading when its
+ *          own outline level or that of its style (resolved once per style
+ *          through the basedOn chain) is within the field's \\o range, 1-9 when
+ *          the field has no \\o switch.
+ *
+ *          Each entry uses the built-in TOC1-TOC9 style (added when missing),
+ *          starts with the heading's list label ("2.1.") for numbered headings
+ *          and, with the \\h switch, links to a _Toc bookmark placed around the
+ *          heading. The page number follows after a tab when a pagination
+ *          estimate is available (see pagination.h); otherwise entries carry
+ *          no page number and Word fills them in on its next field update.
+ *
+ *          Updating again after edits only touches the TOC block and headings
+ *          without a _Toc bookmark: existing bookmarks are reused and entry
+ *          paragraphs that did not change are kept as they are.
+ *
+ * @par Usage Example:
+ * @code
+ * DocumentBuilder builder(&doc);
+ * builder.insert_table_of_contents("\\o \"1-3\"");
+ * // ... write the headings ...
+ * doc.update_table_of_contents();
+ * for (const TocEntry& entry : doc.get_toc_entries()) {
+ *     std::cout << entry.label << entry.text << '\n';
+ * }
+ * @endcode
+ *
+ * @since 0.8.0
+ */
+
+#pragma once
+
+#include <string>
+
+namespace cdocx {
+
+/**
+ * @struct TocEntry
+ * @brief One heading as listed in a table of contents
+ */
+struct TocEntry {
+    int level = 1;         ///< Outline level, 1-9
+    std::string label;     ///< List label of a numbered heading, empty otherwise
+    std::string text;      ///< Heading text with tabs and breaks as spaces
+    std::string bookmark;  ///< _Toc bookmark around the heading
+    int page = 0;          ///< Estimated page number, 0 when no estimate is available
+};
+
+}  // namespace cdocx
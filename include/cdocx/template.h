@@ -45,6 +45,7 @@
 
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace cdocx {
@@ -247,6 +248,20 @@ class Template {
      */
     void set(const std::string& key, const char* value);
 
+    /**
+     * @brief Set a text placeholder value, taking ownership of the string
+     * @param[in] key Placeholder key
+     * @param[in] value Replacement value (moved from)
+     */
+    void set(const std::string& key, std::string&& value);
+
+    /**
+     * @brief Set a text placeholder value from a view
+     * @param[in] key Placeholder key
+     * @param[in] value Replacement value (copied into any existing entry's buffer)
+     */
+    void set(const std::string& key, std::string_view value);
+
     /**
      * @brief Set an image placeholder
      * @param[in] key Placeholder key
@@ -54,13 +54,17 @@
 
 #include <cdocx/advanced.h>
 #include <cdocx/base.h>
+#include <cdocx/cancellation.h>
 #include <cdocx/fwd.h>
+#include <cdocx/record_source.h>
 
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
+#include <vector>
 
 namespace cdocx {
 
@@ -177,12 +181,17 @@ class TemplateFormat {
     TemplateFormat& strikethrough(bool value = true);
     TemplateFormat& size(int half_points);
     TemplateFormat& font(const std::string& name);
+    TemplateFormat& font(std::string&& name);
     TemplateFormat& font_ascii(const std::string& name);
+    TemplateFormat& font_ascii(std::string&& name);
     TemplateFormat& font_far_east(const std::string& name);
+    TemplateFormat& font_far_east(std::string&& name);
     TemplateFormat& color(const std::string& hex);
+    TemplateFormat& color(std::string&& hex);
 
     // Paragraph formatting
     TemplateFormat& alignment(const std::string& align);
+    TemplateFormat& alignment(std::string&& align);
     TemplateFormat& line_spacing(int twips);
     TemplateFormat& space_before(int twips);
     TemplateFormat& space_after(int twips);
@@ -262,6 +271,9 @@ class TemplateValue {
      */
     static TemplateValue text(const std::string& content);
 
+    /** @brief Create a text value, taking ownership of @p content */
+    static TemplateValue text(std::string&& content);
+
     /**
      * @brief Create a text value with format
      * @param content Text content
@@ -270,6 +282,9 @@ class TemplateValue {
      */
     static TemplateValue text(const std::string& content, const TemplateFormat& format);
 
+    /** @brief Create a text value with format, taking ownership of @p content */
+    static TemplateValue text(std::string&& content, const TemplateFormat& format);
+
     /**
      * @brief Create an image value
      * @param path Path to image file
@@ -353,6 +368,11 @@ class TemplateValue {
 
     explicit TemplateValue(TextData data);
     explicit TemplateValue(ImageData data);
+
+    friend class TemplateEngine;
+
+    /// Become plain text, reusing the current text buffer when there is one
+    void assign_text(std::string_view content);
 };
 
 // ============================================================================
@@ -400,12 +420,13 @@ class TemplateEngine {
      * @brief Execution statistics
      */
     struct Result {
-        int success = 0;  ///< Number of successful replacements
-        int failed = 0;   ///< Number of failed replacements
-        int skipped = 0;  ///< Number of skipped (empty value) entries
+        int success = 0;         ///< Number of successful replacements
+        int failed = 0;          ///< Number of failed replacements
+        int skipped = 0;         ///< Number of skipped (empty value) entries
+        bool cancelled = false;  ///< Stopped early by the cancellation token
 
         int total() const { return success + failed + skipped; }
-        bool all_succeeded() const { return failed == 0 && skipped == 0; }
+        bool all_succeeded() const { return !cancelled && failed == 0 && skipped == 0; }
     };
 
     // ===================================================================
@@ -430,6 +451,9 @@ class TemplateEngine {
         /** @brief Assign a plain string (auto-wrapped as Text) */
         Setter& operator=(const std::string& text);
 
+        /** @brief Assign a temporary string (moved, auto-wrapped as Text) */
+        Setter& operator=(std::string&& text);
+
         /** @brief Assign a C-string (auto-wrapped as Text) */
         Setter& operator=(const char* text);
 
@@ -490,6 +514,22 @@ class TemplateEngine {
      */
     TemplateEngine& set(const std::string& key, const std::string& text);
 
+    /**
+     * @brief Set a text value, taking ownership of the string
+     * @param key Template key
+     * @param text Plain text (moved into the queued TemplateValue)
+     * @return Reference to this for chaining
+     */
+    TemplateEngine& set(const std::string& key, std::string&& text);
+
+    /**
+     * @brief Set a text value from a view
+     * @param key Template key
+     * @param text Plain text (copied once into the queued TemplateValue)
+     * @return Reference to this for chaining
+     */
+    TemplateEngine& set(const std::string& key, std::string_view text);
+
     /**
      * @brief Set a text value (C-string convenience overload)
      * @param key Template key
@@ -516,6 +556,17 @@ class TemplateEngine {
      */
     TemplateEngine& set_batch(const std::map<std::string, std::string>& data);
 
+    /**
+     * @brief Set text values from the current record of a RecordSource
+     * @param source Source positioned on a record (after next() returned true)
+     * @return Reference to this for chaining
+     * @details Every column becomes a key; absent values are queued as empty
+     *          text and therefore counted as skipped by apply(). The columns
+     *          are bound to their queue entries once per column list, so later
+     *          records only copy each field into the buffer it already has.
+     */
+    TemplateEngine& set_batch(const RecordSource& source);
+
     // ===================================================================
     // Global Configuration
     // ===================================================================
@@ -538,6 +589,14 @@ class TemplateEngine {
     /** @brief Set placeholder delimiters (default: {{ }}) */
     TemplateEngine& with_delimiters(const std::string& prefix, const std::string& suffix);
 
+    /**
+     * @brief Set the token polled by subsequent apply() calls
+     * @details Checked before every key. On cancellation the remaining keys
+     *          are counted as skipped, Result::cancelled is set and the DOM
+     *          and physical tree are left in sync.
+     */
+    TemplateEngine& with_cancellation(const CancellationToken& token);
+
     // ===================================================================
     // Execution
     // ===================================================================
@@ -594,10 +653,15 @@ class TemplateEngine {
     TemplateFormat default_format_;
     std::string delimiter_prefix_ = "{{";
     std::string delimiter_suffix_ = "}}";
+    CancellationToken cancellation_token_;
 
     Result last_result_;
     int image_counter_ = 1;
 
+    // RecordSource binding: queue entry of each column of bound_columns_
+    std::vector<std::string> bound_columns_;
+    std::vector<TemplateValue*> bound_values_;
+
     // Internal execution
     Result apply_bookmark(const std::string& key, const TemplateValue& value);
     Result apply_bookmark(Bookmark& bookmark, const TemplateValue& value);
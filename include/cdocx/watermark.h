@@ -11,6 +11,7 @@
 
 #include <cdocx/document.h>
 
+#include <memory>
 #include <string>
 
 namespace cdocx {
@@ -49,6 +50,8 @@ struct ImageWatermarkOptions {
 // Watermark Class
 // ============================================================================
 
+class HeaderFooter;
+
 class Watermark {
   public:
     explicit Watermark(Document* doc);
@@ -65,16 +68,28 @@ class Watermark {
     /// Set image watermark from file with custom options
     void set_image(const std::string& image_path, const ImageWatermarkOptions& options);
 
-    /// Remove all watermarks from the document
+    /**
+     * @brief Set a text watermark in the headers of every section
+     * @details The shape is built once and copied into the default, first and
+     *          even headers of each section. A header part shared with the
+     *          previous section (linked to previous) is stamped only once, and
+     *          a section without a header of its own shows the previous one.
+     *          Any existing watermark is removed first.
+     * @return Number of header parts that received the watermark
+     */
+    int apply_to_all_sections(const std::string& text,
+                              const TextWatermarkOptions& options = TextWatermarkOptions());
+
+    /// Remove all watermarks from the headers of every section
     void remove();
 
-    /// Check if document has a watermark
+    /// Check if any header of the document has a watermark
     bool has_watermark() const;
 
   private:
     Document* document_;
 
-    void ensure_header_for_watermark();
+    std::shared_ptr<HeaderFooter> ensure_header_for_watermark();
     void insert_text_watermark_into_header(const std::string& text,
                                            const TextWatermarkOptions& options);
     void insert_image_watermark_into_header(const std::string& image_path,
@@ -0,0 +1,744 @@
+/**
+ * @file agile_encryption.cpp
+ * @brief ECMA-376 Agile encryption of whole packages
+ * @internal Not part of the public API.
+ */
+
+#include "agile_encryption.h"
+
+#include <cdocx/encryption.h>
+
+#include "compound_file.h"
+
+#ifdef CDOCX_HAVE_OPENSSL
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <pugixml.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#endif
+
+namespace cdocx {
+
+#ifdef CDOCX_HAVE_OPENSSL
+
+namespace {
+
+// ============================================================================
+// Agile Encryption Constants
+// ============================================================================
+
+constexpr size_t kSegmentSize = 4096;
+constexpr size_t kSizePrefix = 8;
+constexpr size_t kSaltSize = 16;
+constexpr int kSpinCount = 100000;
+// Upper bound for spin counts read from a file; Word never writes more than 100000
+constexpr int kMaxSpinCount = 10000000;
+// Segments a worker claims at a time (256 KB)
+constexpr size_t kSegmentsPerClaim = 64;
+
+constexpr uint16_t kAgileVersion = 4;
+constexpr uint32_t kAgileFlags = 0x40;
+
+constexpr size_t kBlockKeySize = 8;
+constexpr uint8_t kVerifierInputBlock[kBlockKeySize] = {
+    0xfe, 0xa7, 0xd2, 0x76, 0x3b, 0x4b, 0x9e, 0x79};
+constexpr uint8_t kVerifierValueBlock[kBlockKeySize] = {
+    0xd7, 0xaa, 0x0f, 0x6d, 0x30, 0x61, 0x34, 0x4e};
+constexpr uint8_t kKeyValueBlock[kBlockKeySize] = {0x14, 0x6e, 0x0b, 0xe7, 0xab, 0xac, 0xd0, 0xd6};
+constexpr uint8_t kHmacKeyBlock[kBlockKeySize] = {0x5f, 0xb2, 0xad, 0x01, 0x0c, 0xb9, 0xe1, 0xf6};
+constexpr uint8_t kHmacValueBlock[kBlockKeySize] = {0xa0, 0x67, 0x7f, 0x02, 0xb2, 0x2c, 0x84, 0x33};
+
+constexpr char kEncryptionNamespace[] = "http://schemas.microsoft.com/office/2006/encryption";
+constexpr char kPasswordKeyEncryptor[] =
+    "http://schemas.microsoft.com/office/2006/keyEncryptor/password";
+constexpr char kCertificateKeyEncryptor[] =
+    "http://schemas.microsoft.com/office/2006/keyEncryptor/certificate";
+
+using Bytes = std::vector<uint8_t>;
+
+/// Cipher and hash of keyData (the package) or of the password key encryptor
+struct CipherParams {
+    Bytes salt;
+    size_t block_size = 16;
+    size_t key_bytes = 32;
+    size_t hash_size = 64;
+    const EVP_CIPHER* cipher = EVP_aes_256_cbc();
+    const EVP_MD* digest = EVP_sha512();
+};
+
+struct EncryptionDescriptor {
+    CipherParams key_data;
+    CipherParams password;
+    int spin_count = kSpinCount;
+    Bytes encrypted_hmac_key;
+    Bytes encrypted_hmac_value;
+    Bytes encrypted_verifier_input;
+    Bytes encrypted_verifier_value;
+    Bytes encrypted_key_value;
+};
+
+void write_u16(Bytes& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void write_u32(Bytes& out, uint32_t value) {
+    write_u16(out, static_cast<uint16_t>(value));
+    write_u16(out, static_cast<uint16_t>(value >> 16));
+}
+
+uint32_t read_u32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+size_t resolve_threads(size_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return std::max<size_t>(threads, 1);
+}
+
+// ============================================================================
+// Encodings
+// ============================================================================
+
+std::string base64_encode(const Bytes& data) {
+    std::string out(4 * ((data.size() + 2) / 3), '\0');
+    const int written = EVP_EncodeBlock(
+        reinterpret_cast<unsigned char*>(out.data()), data.data(), static_cast<int>(data.size()));
+    out.resize(static_cast<size_t>(std::max(written, 0)));
+    return out;
+}
+
+bool base64_decode(const char* text, Bytes& out) {
+    const size_t length = std::strlen(text);
+    if (length == 0 || length % 4 != 0) {
+        return false;
+    }
+    out.resize(length / 4 * 3);
+    const int written = EVP_DecodeBlock(
+        out.data(), reinterpret_cast<const unsigned char*>(text), static_cast<int>(length));
+    if (written < 0) {
+        return false;
+    }
+    // EVP_DecodeBlock keeps the zero bytes that stand for '=' padding
+    const size_t padding = (text[length - 1] == '=') + (text[length - 2] == '=');
+    out.resize(static_cast<size_t>(written) - padding);
+    return true;
+}
+
+/// UTF-16LE bytes of the UTF-8 @p text, which is how passwords are hashed
+Bytes utf16le(const std::string& text) {
+    Bytes out;
+    out.reserve(text.size() * 2);
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const auto lead = static_cast<unsigned char>(text[pos++]);
+        uint32_t cp = lead;
+        size_t length = 0;
+        if (lead >= 0xF0) {
+            cp = lead & 0x07;
+            length = 3;
+        } else if (lead >= 0xE0) {
+            cp = lead & 0x0F;
+            length = 2;
+        } else if (lead >= 0xC0) {
+            cp = lead & 0x1F;
+            length = 1;
+        }
+        for (size_t i = 0; i < length && pos < text.size(); ++i) {
+            cp = (cp << 6) | (static_cast<unsigned char>(text[pos++]) & 0x3F);
+        }
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            write_u16(out, static_cast<uint16_t>(0xD800 + (cp >> 10)));
+            write_u16(out, static_cast<uint16_t>(0xDC00 + (cp & 0x3FF)));
+        } else {
+            write_u16(out, static_cast<uint16_t>(cp));
+        }
+    }
+    return out;
+}
+
+// ============================================================================
+// Primitives
+// ============================================================================
+
+struct DigestContextDeleter {
+    void operator()(EVP_MD_CTX* ctx) const { EVP_MD_CTX_free(ctx); }
+};
+struct CipherContextDeleter {
+    void operator()(EVP_CIPHER_CTX* ctx) const { EVP_CIPHER_CTX_free(ctx); }
+};
+using DigestContext = std::unique_ptr<EVP_MD_CTX, DigestContextDeleter>;
+using CipherContext = std::unique_ptr<EVP_CIPHER_CTX, CipherContextDeleter>;
+
+/// H(a + b)
+Bytes digest(EVP_MD_CTX* ctx,
+             const EVP_MD* md,
+             const uint8_t* a,
+             size_t a_size,
+             const uint8_t* b,
+             size_t b_size) {
+    Bytes out(static_cast<size_t>(EVP_MD_size(md)));
+    if (EVP_DigestInit_ex(ctx, md, nullptr) != 1 || EVP_DigestUpdate(ctx, a, a_size) != 1 ||
+        EVP_DigestUpdate(ctx, b, b_size) != 1 ||
+        EVP_DigestFinal_ex(ctx, out.data(), nullptr) != 1) {
+        out.clear();
+    }
+    return out;
+}
+
+Bytes digest(const EVP_MD* md, const Bytes& a, const uint8_t* b, size_t b_size) {
+    DigestContext ctx(EVP_MD_CTX_new());
+    return ctx ? digest(ctx.get(), md, a.data(), a.size(), b, b_size) : Bytes();
+}
+
+/// H(salt + password), then H(iterator + H) @p spin_count times
+Bytes hash_password(const CipherParams& params, const std::string& password, int spin_count) {
+    DigestContext ctx(EVP_MD_CTX_new());
+    if (!ctx) {
+        return {};
+    }
+    const Bytes password_bytes = utf16le(password);
+    Bytes hash = digest(ctx.get(),
+                        params.digest,
+                        params.salt.data(),
+                        params.salt.size(),
+                        password_bytes.data(),
+                        password_bytes.size());
+    if (hash.empty()) {
+        return hash;
+    }
+
+    // The iterator and the previous hash share one buffer that is hashed in place
+    Bytes buffer(4 + hash.size());
+    std::memcpy(buffer.data() + 4, hash.data(), hash.size());
+    for (int i = 0; i < spin_count; ++i) {
+        const auto iterator = static_cast<uint32_t>(i);
+        buffer[0] = static_cast<uint8_t>(iterator);
+        buffer[1] = static_cast<uint8_t>(iterator >> 8);
+        buffer[2] = static_cast<uint8_t>(iterator >> 16);
+        buffer[3] = static_cast<uint8_t>(iterator >> 24);
+        if (EVP_DigestInit_ex(ctx.get(), params.digest, nullptr) != 1 ||
+            EVP_DigestUpdate(ctx.get(), buffer.data(), buffer.size()) != 1 ||
+            EVP_DigestFinal_ex(ctx.get(), buffer.data() + 4, nullptr) != 1) {
+            return {};
+        }
+    }
+    return Bytes(buffer.begin() + 4, buffer.end());
+}
+
+/// Key for one of the password key encryptor's values; padded with 0x36 like Word
+Bytes derive_key(const CipherParams& params, const Bytes& password_hash, const uint8_t* block) {
+    Bytes key = digest(params.digest, password_hash, block, kBlockKeySize);
+    if (!key.empty()) {
+        key.resize(params.key_bytes, 0x36);
+    }
+    return key;
+}
+
+/// The salt itself, or H(salt + @p block) when a block key is given, sized to one block
+Bytes make_iv(const CipherParams& params, const uint8_t* block, size_t block_size) {
+    Bytes iv = block ? digest(params.digest, params.salt, block, block_size) : params.salt;
+    iv.resize(params.block_size, 0x36);
+    return iv;
+}
+
+bool crypt(EVP_CIPHER_CTX* ctx,
+           const EVP_CIPHER* cipher,
+           const uint8_t* key,
+           const uint8_t* iv,
+           const uint8_t* in,
+           size_t size,
+           uint8_t* out,
+           bool encrypt) {
+    int written = 0;
+    return EVP_CipherInit_ex(ctx, cipher, nullptr, key, iv, encrypt ? 1 : 0) == 1 &&
+           EVP_CIPHER_CTX_set_padding(ctx, 0) == 1 &&
+           EVP_CipherUpdate(ctx, out, &written, in, static_cast<int>(size)) == 1 &&
+           static_cast<size_t>(written) == size;
+}
+
+/// En- or decrypts @p in, zero-padded to whole blocks; empty on failure
+Bytes crypt_value(const CipherParams& params,
+                  const Bytes& key,
+                  const Bytes& iv,
+                  const Bytes& in,
+                  bool encrypt) {
+    CipherContext ctx(EVP_CIPHER_CTX_new());
+    Bytes data = in;
+    data.resize((data.size() + params.block_size - 1) / params.block_size * params.block_size, 0);
+    if (!ctx || key.size() != params.key_bytes || data.empty() ||
+        !crypt(ctx.get(), params.cipher, key.data(), iv.data(), data.data(), data.size(),
+               data.data(), encrypt)) {
+        return {};
+    }
+    return data;
+}
+
+/**
+ * En- or decrypts the package body: segment i uses IV H(salt + i). Workers
+ * claim runs of segments, each with its own cipher and digest context.
+ */
+bool crypt_segments(const CipherParams& params,
+                    const Bytes& key,
+                    const uint8_t* in,
+                    size_t size,
+                    uint8_t* out,
+                    bool encrypt,
+                    size_t threads) {
+    const size_t segment_count = (size + kSegmentSize - 1) / kSegmentSize;
+    const size_t claim_count = (segment_count + kSegmentsPerClaim - 1) / kSegmentsPerClaim;
+    const size_t thread_count =
+        std::min(resolve_threads(threads), std::max<size_t>(claim_count, 1));
+
+    std::atomic<size_t> next_claim{0};
+    std::atomic<bool> failed{false};
+    auto crypt_claims = [&]() {
+        CipherContext cipher_ctx(EVP_CIPHER_CTX_new());
+        DigestContext digest_ctx(EVP_MD_CTX_new());
+        if (!cipher_ctx || !digest_ctx) {
+            failed = true;
+            return;
+        }
+        uint8_t index[4];
+        for (size_t claim = next_claim++; claim < claim_count && !failed; claim = next_claim++) {
+            const size_t last = std::min((claim + 1) * kSegmentsPerClaim, segment_count);
+            for (size_t i = claim * kSegmentsPerClaim; i < last; ++i) {
+                const auto segment = static_cast<uint32_t>(i);
+                index[0] = static_cast<uint8_t>(segment);
+                index[1] = static_cast<uint8_t>(segment >> 8);
+                index[2] = static_cast<uint8_t>(segment >> 16);
+                index[3] = static_cast<uint8_t>(segment >> 24);
+                const Bytes iv = digest(digest_ctx.get(), params.digest, params.salt.data(),
+                                        params.salt.size(), index, sizeof(index));
+                const size_t offset = i * kSegmentSize;
+                const size_t length = std::min(kSegmentSize, size - offset);
+                if (iv.size() < params.block_size ||
+                    !crypt(cipher_ctx.get(), params.cipher, key.data(), iv.data(), in + offset,
+                           length, out + offset, encrypt)) {
+                    failed = true;
+                    return;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count - 1);
+    for (size_t t = 1; t < thread_count; ++t) {
+        workers.emplace_back(crypt_claims);
+    }
+    crypt_claims();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return !failed;
+}
+
+Bytes hmac(const EVP_MD* md, const Bytes& key, const Bytes& data) {
+    Bytes out(static_cast<size_t>(EVP_MD_size(md)));
+    unsigned int length = 0;
+    if (!HMAC(md, key.data(), static_cast<int>(key.size()), data.data(), data.size(), out.data(),
+              &length)) {
+        return {};
+    }
+    out.resize(length);
+    return out;
+}
+
+// ============================================================================
+// EncryptionInfo Descriptor
+// ============================================================================
+
+const EVP_MD* find_digest(const char* name) {
+    if (std::strcmp(name, "SHA512") == 0) {
+        return EVP_sha512();
+    }
+    if (std::strcmp(name, "SHA384") == 0) {
+        return EVP_sha384();
+    }
+    if (std::strcmp(name, "SHA256") == 0) {
+        return EVP_sha256();
+    }
+    if (std::strcmp(name, "SHA1") == 0) {
+        return EVP_sha1();
+    }
+    return nullptr;
+}
+
+const EVP_CIPHER* find_cipher(const char* algorithm, const char* chaining, int key_bits) {
+    if (std::strcmp(algorithm, "AES") != 0 || std::strcmp(chaining, "ChainingModeCBC") != 0) {
+        return nullptr;
+    }
+    switch (key_bits) {
+        case 128:
+            return EVP_aes_128_cbc();
+        case 192:
+            return EVP_aes_192_cbc();
+        case 256:
+            return EVP_aes_256_cbc();
+        default:
+            return nullptr;
+    }
+}
+
+EncryptionStatus read_cipher_params(pugi::xml_node node, CipherParams& params) {
+    params.cipher = find_cipher(node.attribute("cipherAlgorithm").value(),
+                                node.attribute("cipherChaining").value(),
+                                node.attribute("keyBits").as_int());
+    params.digest = find_digest(node.attribute("hashAlgorithm").value());
+    if (!params.cipher || !params.digest) {
+        return EncryptionStatus::Unsupported;
+    }
+    params.block_size = node.attribute("blockSize").as_uint();
+    params.key_bytes = static_cast<size_t>(EVP_CIPHER_key_length(params.cipher));
+    params.hash_size = node.attribute("hashSize").as_uint();
+    if (!base64_decode(node.attribute("saltValue").value(), params.salt) ||
+        params.block_size != static_cast<size_t>(EVP_CIPHER_block_size(params.cipher)) ||
+        params.hash_size != static_cast<size_t>(EVP_MD_size(params.digest))) {
+        return EncryptionStatus::Corrupt;
+    }
+    return EncryptionStatus::Ok;
+}
+
+EncryptionStatus parse_descriptor(const uint8_t* xml, size_t size, EncryptionDescriptor& out) {
+    pugi::xml_document doc;
+    if (!doc.load_buffer(xml, size)) {
+        return EncryptionStatus::Corrupt;
+    }
+    const pugi::xml_node root = doc.document_element();
+    const pugi::xml_node key_data = root.child("keyData");
+    if (!key_data) {
+        return EncryptionStatus::Corrupt;
+    }
+    EncryptionStatus status = read_cipher_params(key_data, out.key_data);
+    if (status != EncryptionStatus::Ok) {
+        return status;
+    }
+
+    const pugi::xml_node integrity = root.child("dataIntegrity");
+    if (integrity &&
+        (!base64_decode(integrity.attribute("encryptedHmacKey").value(), out.encrypted_hmac_key) ||
+         !base64_decode(integrity.attribute("encryptedHmacValue").value(),
+                        out.encrypted_hmac_value))) {
+        return EncryptionStatus::Corrupt;
+    }
+
+    // Certificate key encryptors need a private key; only the password is supported
+    const pugi::xml_node encryptor = root.child("keyEncryptors")
+                                         .find_child_by_attribute("keyEncryptor", "uri",
+                                                                  kPasswordKeyEncryptor);
+    const pugi::xml_node encrypted_key = encryptor.first_child();
+    if (!encrypted_key) {
+        return EncryptionStatus::Unsupported;
+    }
+    status = read_cipher_params(encrypted_key, out.password);
+    if (status != EncryptionStatus::Ok) {
+        return status;
+    }
+    out.spin_count = encrypted_key.attribute("spinCount").as_int(-1);
+    if (out.spin_count < 0 || out.spin_count > kMaxSpinCount ||
+        !base64_decode(encrypted_key.attribute("encryptedVerifierHashInput").value(),
+                       out.encrypted_verifier_input) ||
+        !base64_decode(encrypted_key.attribute("encryptedVerifierHashValue").value(),
+                       out.encrypted_verifier_value) ||
+        !base64_decode(encrypted_key.attribute("encryptedKeyValue").value(),
+                       out.encrypted_key_value)) {
+        return EncryptionStatus::Corrupt;
+    }
+    return EncryptionStatus::Ok;
+}
+
+std::string cipher_attributes(const CipherParams& params) {
+    return "saltSize=\"" + std::to_string(params.salt.size()) + "\" blockSize=\"" +
+           std::to_string(params.block_size) + "\" keyBits=\"" +
+           std::to_string(params.key_bytes * 8) + "\" hashSize=\"" +
+           std::to_string(params.hash_size) +
+           "\" cipherAlgorithm=\"AES\" cipherChaining=\"ChainingModeCBC\" "
+           "hashAlgorithm=\"SHA512\" saltValue=\"" +
+           base64_encode(params.salt) + "\"";
+}
+
+/// The EncryptionInfo stream: version 4.4, flags, then the descriptor as Word writes it
+Bytes build_encryption_info(const EncryptionDescriptor& descriptor) {
+    const std::string xml =
+        std::string("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\r\n") +
+        "<encryption xmlns=\"" + kEncryptionNamespace + "\" xmlns:p=\"" + kPasswordKeyEncryptor +
+        "\" xmlns:c=\"" + kCertificateKeyEncryptor + "\"><keyData " +
+        cipher_attributes(descriptor.key_data) + "/><dataIntegrity encryptedHmacKey=\"" +
+        base64_encode(descriptor.encrypted_hmac_key) + "\" encryptedHmacValue=\"" +
+        base64_encode(descriptor.encrypted_hmac_value) +
+        "\"/><keyEncryptors><keyEncryptor uri=\"" + kPasswordKeyEncryptor +
+        "\"><p:encryptedKey spinCount=\"" + std::to_string(descriptor.spin_count) + "\" " +
+        cipher_attributes(descriptor.password) + " encryptedVerifierHashInput=\"" +
+        base64_encode(descriptor.encrypted_verifier_input) +
+        "\" encryptedVerifierHashValue=\"" + base64_encode(descriptor.encrypted_verifier_value) +
+        "\" encryptedKeyValue=\"" + base64_encode(descriptor.encrypted_key_value) +
+        "\"/></keyEncryptor></keyEncryptors></encryption>";
+
+    Bytes info;
+    write_u16(info, kAgileVersion);
+    write_u16(info, kAgileVersion);
+    write_u32(info, kAgileFlags);
+    info.insert(info.end(), xml.begin(), xml.end());
+    return info;
+}
+
+// ============================================================================
+// Data Spaces (MS-OFFCRYPTO 2.2)
+// ============================================================================
+
+/// UNICODE-LP-P4: byte length, UTF-16LE text, padded to four bytes
+void write_length_prefixed(Bytes& out, const char* text) {
+    const size_t length = std::strlen(text);
+    write_u32(out, static_cast<uint32_t>(length * 2));
+    for (size_t i = 0; i < length; ++i) {
+        write_u16(out, static_cast<uint8_t>(text[i]));
+    }
+    while (out.size() % 4 != 0) {
+        out.push_back(0);
+    }
+}
+
+void write_versions(Bytes& out) {
+    for (int i = 0; i < 3; ++i) {  // Reader, updater and writer version 1.0
+        write_u16(out, 1);
+        write_u16(out, 0);
+    }
+}
+
+struct DataSpaces {
+    Bytes version;
+    Bytes map;
+    Bytes definition;
+    Bytes transform;
+};
+
+DataSpaces build_data_spaces() {
+    DataSpaces spaces;
+    write_length_prefixed(spaces.version, "Microsoft.Container.DataSpaces");
+    write_versions(spaces.version);
+
+    Bytes entry;
+    write_u32(entry, 1);  // One reference component: the EncryptedPackage stream
+    write_u32(entry, 0);
+    write_length_prefixed(entry, "EncryptedPackage");
+    write_length_prefixed(entry, "StrongEncryptionDataSpace");
+    write_u32(spaces.map, 8);
+    write_u32(spaces.map, 1);
+    write_u32(spaces.map, static_cast<uint32_t>(entry.size() + 4));
+    spaces.map.insert(spaces.map.end(), entry.begin(), entry.end());
+
+    write_u32(spaces.definition, 8);
+    write_u32(spaces.definition, 1);
+    write_length_prefixed(spaces.definition, "StrongEncryptionTransform");
+
+    Bytes header;
+    write_u32(header, 1);  // Transform type
+    write_length_prefixed(header, "{FF9A3F03-56EF-4613-BDD5-5A41C1D07246}");
+    write_u32(spaces.transform, static_cast<uint32_t>(header.size() + 4));
+    spaces.transform.insert(spaces.transform.end(), header.begin(), header.end());
+    write_length_prefixed(spaces.transform, "Microsoft.Container.EncryptionTransform");
+    write_versions(spaces.transform);
+    write_u32(spaces.transform, 0);  // Empty encryption name
+    write_u32(spaces.transform, 0);  // Block size
+    write_u32(spaces.transform, 0);  // Cipher mode
+    write_u32(spaces.transform, 4);  // Reserved
+    return spaces;
+}
+
+}  // namespace
+
+bool is_encryption_available() {
+    return true;
+}
+
+EncryptionStatus decrypt_package(const CompoundFileReader& file,
+                                 const std::string& password,
+                                 size_t threads,
+                                 std::vector<uint8_t>& package) {
+    Bytes info;
+    Bytes stream;
+    if (!file.read_stream("EncryptionInfo", info) || info.size() < 8 ||
+        !file.read_stream("EncryptedPackage", stream) || stream.size() < kSizePrefix) {
+        return EncryptionStatus::Corrupt;
+    }
+    // Standard (x.2) and extensible (x.3) encryption predate Agile and are not supported
+    if (info[0] != kAgileVersion || info[1] != 0 || info[2] != kAgileVersion || info[3] != 0) {
+        return EncryptionStatus::Unsupported;
+    }
+    EncryptionDescriptor descriptor;
+    const EncryptionStatus status = parse_descriptor(info.data() + 8, info.size() - 8, descriptor);
+    if (status != EncryptionStatus::Ok) {
+        return status;
+    }
+
+    const CipherParams& params = descriptor.password;
+    const Bytes password_hash = hash_password(params, password, descriptor.spin_count);
+    const Bytes iv = make_iv(params, nullptr, 0);
+    Bytes verifier_input =
+        crypt_value(params, derive_key(params, password_hash, kVerifierInputBlock), iv,
+                    descriptor.encrypted_verifier_input, false);
+    const Bytes verifier_value =
+        crypt_value(params, derive_key(params, password_hash, kVerifierValueBlock), iv,
+                    descriptor.encrypted_verifier_value, false);
+    if (verifier_input.size() < params.salt.size() || verifier_value.size() < params.hash_size) {
+        return EncryptionStatus::Corrupt;
+    }
+    verifier_input.resize(params.salt.size());
+    const Bytes expected = digest(params.digest, verifier_input, nullptr, 0);
+    if (expected.size() != params.hash_size ||
+        CRYPTO_memcmp(expected.data(), verifier_value.data(), params.hash_size) != 0) {
+        return EncryptionStatus::InvalidPassword;
+    }
+
+    const CipherParams& key_data = descriptor.key_data;
+    Bytes key = crypt_value(params, derive_key(params, password_hash, kKeyValueBlock), iv,
+                            descriptor.encrypted_key_value, false);
+    if (key.size() < key_data.key_bytes) {
+        return EncryptionStatus::Corrupt;
+    }
+    key.resize(key_data.key_bytes);
+
+    // The HMAC covers the whole EncryptedPackage stream, size prefix included
+    if (!descriptor.encrypted_hmac_key.empty()) {
+        Bytes hmac_key = crypt_value(key_data, key, make_iv(key_data, kHmacKeyBlock, kBlockKeySize),
+                                     descriptor.encrypted_hmac_key, false);
+        const Bytes hmac_value =
+            crypt_value(key_data, key, make_iv(key_data, kHmacValueBlock, kBlockKeySize),
+                        descriptor.encrypted_hmac_value, false);
+        if (hmac_key.size() < key_data.hash_size || hmac_value.size() < key_data.hash_size) {
+            return EncryptionStatus::Corrupt;
+        }
+        hmac_key.resize(key_data.hash_size);
+        const Bytes actual = hmac(key_data.digest, hmac_key, stream);
+        if (actual.size() != key_data.hash_size ||
+            CRYPTO_memcmp(actual.data(), hmac_value.data(), key_data.hash_size) != 0) {
+            return EncryptionStatus::Corrupt;
+        }
+    }
+
+    const uint64_t size =
+        static_cast<uint64_t>(read_u32(stream.data())) |
+        (static_cast<uint64_t>(read_u32(stream.data() + 4)) << 32);
+    const size_t body = stream.size() - kSizePrefix;
+    const size_t crypt_size = body - body % key_data.block_size;
+    if (size > crypt_size) {
+        return EncryptionStatus::Corrupt;
+    }
+    package.resize(crypt_size);
+    if (!crypt_segments(key_data, key, stream.data() + kSizePrefix, crypt_size, package.data(),
+                        false, threads)) {
+        return EncryptionStatus::Corrupt;
+    }
+    package.resize(static_cast<size_t>(size));
+    return EncryptionStatus::Ok;
+}
+
+EncryptionStatus encrypt_package(const uint8_t* package,
+                                 size_t size,
+                                 const std::string& password,
+                                 size_t threads,
+                                 const std::string& path) {
+    EncryptionDescriptor descriptor;
+    CipherParams& key_data = descriptor.key_data;
+    CipherParams& params = descriptor.password;
+    key_data.salt.resize(kSaltSize);
+    params.salt.resize(kSaltSize);
+    Bytes key(key_data.key_bytes);
+    Bytes verifier_input(kSaltSize);
+    Bytes hmac_key(key_data.hash_size);
+    if (RAND_bytes(key_data.salt.data(), static_cast<int>(key_data.salt.size())) != 1 ||
+        RAND_bytes(params.salt.data(), static_cast<int>(params.salt.size())) != 1 ||
+        RAND_bytes(key.data(), static_cast<int>(key.size())) != 1 ||
+        RAND_bytes(verifier_input.data(), static_cast<int>(verifier_input.size())) != 1 ||
+        RAND_bytes(hmac_key.data(), static_cast<int>(hmac_key.size())) != 1) {
+        return EncryptionStatus::Unavailable;
+    }
+
+    const Bytes password_hash = hash_password(params, password, descriptor.spin_count);
+    const Bytes iv = make_iv(params, nullptr, 0);
+    descriptor.encrypted_verifier_input =
+        crypt_value(params, derive_key(params, password_hash, kVerifierInputBlock), iv,
+                    verifier_input, true);
+    descriptor.encrypted_verifier_value =
+        crypt_value(params, derive_key(params, password_hash, kVerifierValueBlock), iv,
+                    digest(params.digest, verifier_input, nullptr, 0), true);
+    descriptor.encrypted_key_value =
+        crypt_value(params, derive_key(params, password_hash, kKeyValueBlock), iv, key, true);
+
+    // The last segment is zero-padded to a whole block and encrypted in place
+    const size_t crypt_size = (size + key_data.block_size - 1) / key_data.block_size *
+                              key_data.block_size;
+    Bytes stream(kSizePrefix + crypt_size, 0);
+    for (size_t i = 0; i < kSizePrefix; ++i) {
+        stream[i] = static_cast<uint8_t>(static_cast<uint64_t>(size) >> (8 * i));
+    }
+    if (size > 0) {
+        std::memcpy(stream.data() + kSizePrefix, package, size);
+    }
+    if (!crypt_segments(key_data, key, stream.data() + kSizePrefix, crypt_size,
+                        stream.data() + kSizePrefix, true, threads)) {
+        return EncryptionStatus::Corrupt;
+    }
+
+    descriptor.encrypted_hmac_key =
+        crypt_value(key_data, key, make_iv(key_data, kHmacKeyBlock, kBlockKeySize), hmac_key, true);
+    descriptor.encrypted_hmac_value =
+        crypt_value(key_data, key, make_iv(key_data, kHmacValueBlock, kBlockKeySize),
+                    hmac(key_data.digest, hmac_key, stream), true);
+    if (descriptor.encrypted_verifier_input.empty() ||
+        descriptor.encrypted_verifier_value.empty() || descriptor.encrypted_key_value.empty() ||
+        descriptor.encrypted_hmac_key.empty() || descriptor.encrypted_hmac_value.empty()) {
+        return EncryptionStatus::Corrupt;
+    }
+
+    const Bytes info = build_encryption_info(descriptor);
+    const DataSpaces spaces = build_data_spaces();
+    const std::vector<CompoundFileStream> streams = {
+        {"EncryptionInfo", info.data(), info.size()},
+        {"EncryptedPackage", stream.data(), stream.size()},
+        {"\x06" "DataSpaces/Version", spaces.version.data(), spaces.version.size()},
+        {"\x06" "DataSpaces/DataSpaceMap", spaces.map.data(), spaces.map.size()},
+        {"\x06" "DataSpaces/DataSpaceInfo/StrongEncryptionDataSpace", spaces.definition.data(),
+         spaces.definition.size()},
+        {"\x06" "DataSpaces/TransformInfo/StrongEncryptionTransform/\x06" "Primary",
+         spaces.transform.data(), spaces.transform.size()},
+    };
+    return write_compound_file(path, streams) ? EncryptionStatus::Ok : EncryptionStatus::IoError;
+}
+
+#else  // CDOCX_HAVE_OPENSSL
+
+bool is_encryption_available() {
+    return false;
+}
+
+EncryptionStatus decrypt_package(const CompoundFileReader& /*file*/,
+                                 const std::string& /*password*/,
+                                 size_t /*threads*/,
+                                 std::vector<uint8_t>& /*package*/) {
+    return EncryptionStatus::Unavailable;
+}
+
+EncryptionStatus encrypt_package(const uint8_t* /*package*/,
+                                 size_t /*size*/,
+                                 const std::string& /*password*/,
+                                 size_t /*threads*/,
+                                 const std::string& /*path*/) {
+    return EncryptionStatus::Unavailable;
+}
+
+#endif  // CDOCX_HAVE_OPENSSL
+
+}  // namespace cdocx
@@ -0,0 +1,55 @@
+/**
+ * @file agile_encryption.h
+ * @brief Internal ECMA-376 Agile encryption of whole packages (MS-OFFCRYPTO)
+ * @internal Not part of the public API.
+ * @details An encrypted package is a compound file with two root streams:
+ *          EncryptionInfo (version 4.4 followed by an XML descriptor of the
+ *          key derivation) and EncryptedPackage (the 8-byte package size
+ *          followed by 4096-byte segments, each AES-CBC encrypted with its own
+ *          IV). Segments are independent, so they are processed on several
+ *          threads, each with its own cipher context. AES and SHA come from
+ *          OpenSSL's EVP interface, which uses AES-NI/VAES and the SHA
+ *          extensions where the CPU has them.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cdocx {
+
+class CompoundFileReader;
+
+enum class EncryptionStatus : std::uint8_t {
+    Ok,
+    Unavailable,      ///< Built without OpenSSL
+    Unsupported,      ///< Standard/extensible encryption or an unknown cipher or hash
+    InvalidPassword,  ///< The password verifier did not match
+    Corrupt,          ///< Missing streams, malformed descriptor or failed integrity check
+    IoError
+};
+
+/**
+ * @brief Decrypts the package stored in @p file into @p package
+ * @param threads Worker threads for the segments (0 = one per core)
+ */
+EncryptionStatus decrypt_package(const CompoundFileReader& file,
+                                 const std::string& password,
+                                 size_t threads,
+                                 std::vector<uint8_t>& package);
+
+/**
+ * @brief Encrypts @p package with @p password and writes it as a compound file
+ * @details Uses what Word writes by default: AES-256-CBC keys, SHA-512 and
+ *          100000 spins for the password, and an HMAC over the encrypted stream.
+ */
+EncryptionStatus encrypt_package(const uint8_t* package,
+                                 size_t size,
+                                 const std::string& password,
+                                 size_t threads,
+                                 const std::string& path);
+
+}  // namespace cdocx
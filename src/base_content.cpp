@@ -51,49 +51,6 @@ static HighlightColor highlight_to_color(TextProperties::Highlight highlight) {
     return HighlightColor::None;
 }
 
-struct UnderlineStyleMapping {
-    TextProperties::UnderlineStyle style{};
-    const char* xml_value{};
-};
-
-static const UnderlineStyleMapping kUnderlineStyleMappings[] = {
-    {TextProperties::UnderlineStyle::Words, "words"},
-    {TextProperties::UnderlineStyle::Single, "single"},
-    {TextProperties::UnderlineStyle::Double, "double"},
-    {TextProperties::UnderlineStyle::Thick, "thick"},
-    {TextProperties::UnderlineStyle::Dotted, "dotted"},
-    {TextProperties::UnderlineStyle::DottedHeavy, "dottedHeavy"},
-    {TextProperties::UnderlineStyle::Dash, "dash"},
-    {TextProperties::UnderlineStyle::DashedHeavy, "dashedHeavy"},
-    {TextProperties::UnderlineStyle::DashLong, "dashLong"},
-    {TextProperties::UnderlineStyle::DashLongHeavy, "dashLongHeavy"},
-    {TextProperties::UnderlineStyle::DotDash, "dotDash"},
-    {TextProperties::UnderlineStyle::DashDotHeavy, "dashDotHeavy"},
-    {TextProperties::UnderlineStyle::DotDotDash, "dotDotDash"},
-    {TextProperties::UnderlineStyle::DashDotDotHeavy, "dashDotDotHeavy"},
-    {TextProperties::UnderlineStyle::Wave, "wave"},
-    {TextProperties::UnderlineStyle::WavyDouble, "wavyDouble"},
-    {TextProperties::UnderlineStyle::WavyHeavy, "wavyHeavy"},
-};
-
-const char* underline_style_to_string(TextProperties::UnderlineStyle style) {
-    for (const auto& m : kUnderlineStyleMappings) {
-        if (m.style == style) {
-            return m.xml_value;
-        }
-    }
-    return "single";
-}
-
-TextProperties::UnderlineStyle string_to_underline_style(const char* str) {
-    for (const auto& m : kUnderlineStyleMappings) {
-        if (std::strcmp(m.xml_value, str) == 0) {
-            return m.style;
-        }
-    }
-    return TextProperties::UnderlineStyle::Single;
-}
-
 struct UnderlineStyleToTypeMapping {
     TextProperties::UnderlineStyle style{};
     UnderlineType type{};
@@ -212,7 +169,11 @@ Run::Run(const Run& other)
     : Inline(other),
       parent_xml_(other.parent_xml_),
       current_xml_(other.current_xml_),
-      text_(other.text_) {
+      text_(other.text_),
+      revision_type_(other.revision_type_),
+      revision_id_(other.revision_id_),
+      revision_author_(other.revision_author_),
+      revision_date_(other.revision_date_) {
     for (auto child = other.preserved_children_.first_child(); child;
          child = child.next_sibling()) {
         preserved_children_.append_copy(child);
@@ -225,6 +186,10 @@ Run& Run::operator=(const Run& other) {
         text_ = other.text_;
         parent_xml_ = other.parent_xml_;
         current_xml_ = other.current_xml_;
+        revision_type_ = other.revision_type_;
+        revision_id_ = other.revision_id_;
+        revision_author_ = other.revision_author_;
+        revision_date_ = other.revision_date_;
         preserved_children_.reset();
         for (auto child = other.preserved_children_.first_child(); child;
              child = child.next_sibling()) {
@@ -302,9 +267,27 @@ std::shared_ptr<Node> Run::clone(bool /*deep*/) const {
             cloned->preserved_children_.append_copy(child);
         }
     }
+    cloned->revision_type_ = revision_type_;
+    cloned->revision_id_ = revision_id_;
+    cloned->revision_author_ = revision_author_;
+    cloned->revision_date_ = revision_date_;
     return cloned;
 }
 
+void Run::set_revision(RevisionType type,
+                       int id,
+                       const std::string& author,
+                       const std::string& date) {
+    revision_type_ = type;
+    revision_id_ = id;
+    revision_author_ = author;
+    revision_date_ = date;
+}
+
+void Run::clear_revision() {
+    set_revision(RevisionType::None, 0, "", "");
+}
+
 void Run::preserve_child(pugi::xml_node child) {
     if (child) {
         preserved_children_.append_copy(child);
@@ -321,6 +304,10 @@ bool Run::has_preserved_children() const {
     return preserved_children_.first_child() != nullptr;
 }
 
+pugi::xml_node Run::get_preserved_children() const {
+    return preserved_children_;
+}
+
 // ============================================================================
 // Run Legacy Implementation (XML-based)
 // ============================================================================
@@ -818,6 +805,11 @@ SpecialChar::SpecialChar(char16_t char_code) : char_code_(char_code) {
 }
 
 std::string SpecialChar::get_text() const {
+    // A field end only marks where a field result stops; it has no text of its own
+    if (char_code_ == 0x0015) {
+        return {};
+    }
+
     // Convert char16_t to UTF-8 string
     std::string result;
     if (char_code_ <= 0x7F) {
@@ -863,6 +855,10 @@ std::shared_ptr<SpecialChar> SpecialChar::tab() {
     return std::make_shared<SpecialChar>(0x0009);  // Tab
 }
 
+std::shared_ptr<SpecialChar> SpecialChar::field_end() {
+    return std::make_shared<SpecialChar>(0x0015);  // NAK
+}
+
 // ============================================================================
 // Field Implementation
 // ============================================================================
@@ -932,6 +928,7 @@ std::shared_ptr<Node> Field::clone(bool /*deep*/) const {
     cloned->switches_ = switches_;
     cloned->is_locked_ = is_locked_;
     cloned->is_dirty_ = is_dirty_;
+    cloned->spans_paragraphs_ = spans_paragraphs_;
     return cloned;
 }
 
@@ -15,6 +15,7 @@
 #include <utility>
 #include <vector>
 
+#include "run_text.h"
 #include "sync_common.h"
 
 namespace cdocx {
@@ -109,7 +110,7 @@ std::string Bookmark::get_text() const {
     return result;
 }
 
-bool Bookmark::set_text(const std::string& text) {
+bool Bookmark::set_text(std::string_view text) {
     if (!is_valid()) {
         return false;
     }
@@ -126,8 +127,7 @@ bool Bookmark::set_text(const std::string& text) {
 
     // Create new run with text
     pugi::xml_node new_run = current.append_child("w:r");
-    const pugi::xml_node t = new_run.append_child("w:t");
-    t.text().set(text.c_str());
+    append_run_text(new_run, text);
 
     return true;
 }
@@ -485,8 +485,7 @@ bool Bookmark::set_text_formatted(const std::string& text, const BookmarkFormat&
     }
 
     // Add text content
-    const pugi::xml_node t = new_run.append_child("w:t");
-    t.text().set(text.c_str());
+    append_run_text(new_run, text);
 
     return true;
 }
@@ -95,7 +95,17 @@ std::string Comment::get_text() const {
     return result;
 }
 
+void Comment::set_id(int id) {
+    const int old_id = id_;
+    id_ = id;
+    modified_ = true;
+    if (document_ && id != old_id) {
+        document_->rename_comment(*this, old_id);
+    }
+}
+
 void Comment::set_text(const std::string& text) {
+    modified_ = true;
     // Clear existing paragraphs
     remove_all_children();
 
@@ -144,6 +154,7 @@ std::shared_ptr<Node> Comment::clone(bool deep) const {
 }
 
 std::shared_ptr<Paragraph> Comment::append_paragraph(const std::string& text) {
+    modified_ = true;
     auto para = std::make_shared<Paragraph>();
     if (!text.empty()) {
         para->append_run(text);
@@ -159,38 +170,22 @@ std::shared_ptr<Paragraph> Comment::append_paragraph(const std::string& text) {
 CommentCollection::CommentCollection(Document* doc) : doc_(doc) {
 }
 
-void CommentCollection::collect_comments() const {
-    if (collected_) {
-        return;
-    }
-    comments_.clear();
-    if (doc_) {
-        comments_ = doc_->comments_cache_;
-    }
-    collected_ = true;
+std::vector<std::shared_ptr<Comment>>& CommentCollection::comments() const {
+    static std::vector<std::shared_ptr<Comment>> no_comments;
+    return doc_ ? doc_->comments_cache_ : no_comments;
 }
 
 size_t CommentCollection::count() const {
-    collect_comments();
-    return comments_.size();
+    return comments().size();
 }
 
 std::shared_ptr<Comment> CommentCollection::get(size_t index) const {
-    collect_comments();
-    if (index < comments_.size()) {
-        return comments_[index];
-    }
-    return nullptr;
+    const auto& comments = this->comments();
+    return index < comments.size() ? comments[index] : nullptr;
 }
 
 std::shared_ptr<Comment> CommentCollection::get_by_id(int id) const {
-    collect_comments();
-    for (const auto& c : comments_) {
-        if (c->get_id() == id) {
-            return c;
-        }
-    }
-    return nullptr;
+    return doc_ ? doc_->get_comment(id) : nullptr;
 }
 
 bool CommentCollection::contains(int id) const {
@@ -199,64 +194,38 @@ bool CommentCollection::contains(int id) const {
 
 std::shared_ptr<Comment> CommentCollection::add(const std::string& author,
                                                 const std::string& text) {
-    if (!doc_) {
-        return nullptr;
-    }
-    auto comment = doc_->add_comment(author, text);
-    if (comment) {
-        collected_ = false;
-        collect_comments();
-    }
-    return comment;
+    return doc_ ? doc_->add_comment(author, text) : nullptr;
 }
 
 bool CommentCollection::remove_at(size_t index) {
-    collect_comments();
-    if (index >= comments_.size()) {
-        return false;
-    }
-    const int id = comments_[index]->get_id();
-    const bool result = doc_->remove_comment(id);
-    if (result) {
-        collected_ = false;
-    }
-    return result;
+    auto comment = get(index);
+    return comment && doc_->remove_comment(comment->get_id());
 }
 
 bool CommentCollection::remove(int id) {
-    const bool result = doc_->remove_comment(id);
-    if (result) {
-        collected_ = false;
-    }
-    return result;
+    return doc_ && doc_->remove_comment(id);
 }
 
 void CommentCollection::clear() {
     if (doc_) {
         doc_->clear_comments();
     }
-    comments_.clear();
-    collected_ = true;
 }
 
 std::vector<std::shared_ptr<Comment>>::iterator CommentCollection::begin() {
-    collect_comments();
-    return comments_.begin();
+    return comments().begin();
 }
 
 std::vector<std::shared_ptr<Comment>>::iterator CommentCollection::end() {
-    collect_comments();
-    return comments_.end();
+    return comments().end();
 }
 
 std::vector<std::shared_ptr<Comment>>::const_iterator CommentCollection::begin() const {
-    collect_comments();
-    return comments_.begin();
+    return comments().cbegin();
 }
 
 std::vector<std::shared_ptr<Comment>>::const_iterator CommentCollection::end() const {
-    collect_comments();
-    return comments_.end();
+    return comments().cend();
 }
 
 }  // namespace cdocx
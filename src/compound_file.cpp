@@ -0,0 +1,600 @@
+/**
+ * @file compound_file.cpp
+ * @brief OLE compound file (MS-CFB) reader and writer
+ * @internal Not part of the public API.
+ */
+
+#include "compound_file.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+namespace cdocx {
+
+namespace {
+
+// ============================================================================
+// Compound File Format Constants
+// ============================================================================
+
+constexpr char kSignature[] = "\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1";
+constexpr size_t kSignatureSize = 8;
+
+constexpr size_t kHeaderSize = 512;
+constexpr size_t kHeaderDifatEntries = 109;
+constexpr size_t kDirectoryEntrySize = 128;
+constexpr size_t kMaxNameLength = 31;
+
+constexpr uint32_t kFreeSector = 0xFFFFFFFF;
+constexpr uint32_t kEndOfChain = 0xFFFFFFFE;
+constexpr uint32_t kFatSector = 0xFFFFFFFD;
+constexpr uint32_t kDifatSector = 0xFFFFFFFC;
+constexpr uint32_t kMaxRegularSector = 0xFFFFFFFA;
+constexpr uint32_t kNoStream = 0xFFFFFFFF;
+
+constexpr uint8_t kTypeStorage = 1;
+constexpr uint8_t kTypeStream = 2;
+constexpr uint8_t kTypeRoot = 5;
+constexpr uint8_t kColorRed = 0;
+constexpr uint8_t kColorBlack = 1;
+
+// Version 3 layout, used for writing
+constexpr size_t kSectorSize = 512;
+constexpr size_t kMiniSectorSize = 64;
+constexpr uint32_t kMiniStreamCutoff = 4096;
+constexpr size_t kEntriesPerSector = kSectorSize / 4;
+
+uint16_t read_u16(const char* p) {
+    const auto* b = reinterpret_cast<const uint8_t*>(p);
+    return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+uint32_t read_u32(const char* p) {
+    return static_cast<uint32_t>(read_u16(p)) | (static_cast<uint32_t>(read_u16(p + 2)) << 16);
+}
+
+uint64_t read_u64(const char* p) {
+    return static_cast<uint64_t>(read_u32(p)) | (static_cast<uint64_t>(read_u32(p + 4)) << 32);
+}
+
+void write_u16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void write_u32(std::vector<uint8_t>& out, uint32_t value) {
+    write_u16(out, static_cast<uint16_t>(value));
+    write_u16(out, static_cast<uint16_t>(value >> 16));
+}
+
+void write_u64(std::vector<uint8_t>& out, uint64_t value) {
+    write_u32(out, static_cast<uint32_t>(value));
+    write_u32(out, static_cast<uint32_t>(value >> 32));
+}
+
+size_t div_ceil(size_t value, size_t divisor) {
+    return (value + divisor - 1) / divisor;
+}
+
+/// Directory order of sibling names: shorter names first, then case-insensitive
+bool name_less(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size();
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        const int ca = std::toupper(static_cast<unsigned char>(a[i]));
+        const int cb = std::toupper(static_cast<unsigned char>(b[i]));
+        if (ca != cb) {
+            return ca < cb;
+        }
+    }
+    return false;
+}
+
+bool name_equal(const std::string& a, const std::string& b) {
+    return !name_less(a, b) && !name_less(b, a);
+}
+
+// ============================================================================
+// Writer Directory
+// ============================================================================
+
+struct WriteEntry {
+    std::string name;
+    uint8_t type = kTypeStream;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    uint32_t start = kEndOfChain;
+    uint32_t left = kNoStream;
+    uint32_t right = kNoStream;
+    uint32_t child = kNoStream;
+    uint8_t color = kColorBlack;
+    std::vector<uint32_t> children;
+};
+
+/**
+ * Links the sorted siblings [lo, hi) into a balanced binary tree. All levels
+ * but the last are full, so colouring only the last level red (when it is
+ * incomplete) yields a valid red-black tree.
+ */
+uint32_t link_siblings(std::vector<WriteEntry>& entries,
+                       const std::vector<uint32_t>& sorted,
+                       size_t lo,
+                       size_t hi,
+                       size_t depth,
+                       size_t black_levels) {
+    if (lo >= hi) {
+        return kNoStream;
+    }
+    const size_t mid = lo + (hi - lo) / 2;
+    WriteEntry& entry = entries[sorted[mid]];
+    entry.color = depth >= black_levels ? kColorRed : kColorBlack;
+    entry.left = link_siblings(entries, sorted, lo, mid, depth + 1, black_levels);
+    entry.right = link_siblings(entries, sorted, mid + 1, hi, depth + 1, black_levels);
+    return sorted[mid];
+}
+
+void link_directory(std::vector<WriteEntry>& entries) {
+    for (auto& parent : entries) {
+        std::vector<uint32_t> sorted = parent.children;
+        if (sorted.empty()) {
+            continue;
+        }
+        std::sort(sorted.begin(), sorted.end(), [&entries](uint32_t a, uint32_t b) {
+            return name_less(entries[a].name, entries[b].name);
+        });
+        size_t black_levels = 0;
+        while ((size_t{2} << black_levels) - 1 <= sorted.size()) {
+            ++black_levels;
+        }
+        parent.child = link_siblings(entries, sorted, 0, sorted.size(), 0, black_levels);
+    }
+}
+
+/// Index of the child of @p parent named @p name, created as a storage if missing
+uint32_t find_or_add_storage(std::vector<WriteEntry>& entries,
+                             uint32_t parent,
+                             const std::string& name) {
+    for (const uint32_t child : entries[parent].children) {
+        if (name_equal(entries[child].name, name)) {
+            return child;
+        }
+    }
+    WriteEntry storage;
+    storage.name = name;
+    storage.type = kTypeStorage;
+    entries.push_back(std::move(storage));
+    const auto index = static_cast<uint32_t>(entries.size() - 1);
+    entries[parent].children.push_back(index);
+    return index;
+}
+
+void append_directory_entry(std::vector<uint8_t>& out, const WriteEntry* entry) {
+    const size_t begin = out.size();
+    out.resize(begin + kDirectoryEntrySize, 0);
+    uint8_t* p = out.data() + begin;
+    if (!entry) {
+        std::memset(p + 68, 0xFF, 12);  // Unused: no siblings, no child
+        return;
+    }
+    for (size_t i = 0; i < entry->name.size(); ++i) {
+        p[i * 2] = static_cast<uint8_t>(entry->name[i]);
+    }
+    std::vector<uint8_t> fields;
+    write_u16(fields, static_cast<uint16_t>((entry->name.size() + 1) * 2));
+    fields.push_back(entry->type);
+    fields.push_back(entry->color);
+    write_u32(fields, entry->left);
+    write_u32(fields, entry->right);
+    write_u32(fields, entry->child);
+    std::memcpy(p + 64, fields.data(), fields.size());
+
+    fields.clear();
+    write_u32(fields, entry->start);
+    write_u64(fields, entry->size);
+    std::memcpy(p + 116, fields.data(), fields.size());
+}
+
+void write_bytes(std::ofstream& out, const void* data, size_t size) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+void write_padding(std::ofstream& out, size_t size, size_t alignment) {
+    static const char kZeros[kSectorSize] = {};
+    const size_t padding = (alignment - size % alignment) % alignment;
+    out.write(kZeros, static_cast<std::streamsize>(padding));
+}
+
+void write_sector_table(std::ofstream& out, const std::vector<uint32_t>& table) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(table.size() * 4);
+    for (const uint32_t value : table) {
+        write_u32(bytes, value);
+    }
+    write_bytes(out, bytes.data(), bytes.size());
+}
+
+}  // namespace
+
+// ============================================================================
+// CompoundFileReader
+// ============================================================================
+
+bool is_compound_file(std::string_view data) {
+    return data.size() >= kSignatureSize &&
+           std::memcmp(data.data(), kSignature, kSignatureSize) == 0;
+}
+
+size_t CompoundFileReader::sector_count() const {
+    return data_.size() > sector_size_ ? (data_.size() - 1) / sector_size_ : 0;
+}
+
+bool CompoundFileReader::read_chain(uint32_t start,
+                                    uint64_t size,
+                                    std::vector<uint8_t>& out) const {
+    out.clear();
+    uint32_t sector = start;
+    // A chain cannot be longer than the file has sectors; this also stops loops
+    for (size_t steps = 0; sector != kEndOfChain && out.size() < size; ++steps) {
+        if (sector > kMaxRegularSector || sector >= fat_.size() || steps > sector_count()) {
+            return false;
+        }
+        const size_t offset = (static_cast<size_t>(sector) + 1) * sector_size_;
+        if (offset >= data_.size()) {
+            return false;
+        }
+        const size_t available = std::min(sector_size_, data_.size() - offset);
+        const size_t wanted = static_cast<size_t>(std::min<uint64_t>(available, size - out.size()));
+        out.insert(out.end(), data_.data() + offset, data_.data() + offset + wanted);
+        sector = fat_[sector];
+    }
+    return size == UINT64_MAX || out.size() == size;
+}
+
+bool CompoundFileReader::read_mini_chain(uint32_t start,
+                                         uint64_t size,
+                                         std::vector<uint8_t>& out) const {
+    out.clear();
+    uint32_t sector = start;
+    for (size_t steps = 0; sector != kEndOfChain && out.size() < size; ++steps) {
+        const size_t offset = static_cast<size_t>(sector) * kMiniSectorSize;
+        if (sector >= mini_fat_.size() || steps > mini_fat_.size() ||
+            offset >= mini_stream_.size()) {
+            return false;
+        }
+        const size_t available = std::min(kMiniSectorSize, mini_stream_.size() - offset);
+        const size_t wanted = static_cast<size_t>(std::min<uint64_t>(available, size - out.size()));
+        const auto first = mini_stream_.begin() + static_cast<std::ptrdiff_t>(offset);
+        out.insert(out.end(), first, first + static_cast<std::ptrdiff_t>(wanted));
+        sector = mini_fat_[sector];
+    }
+    return out.size() == size;
+}
+
+bool CompoundFileReader::open(std::string_view data) {
+    data_ = data;
+    fat_.clear();
+    mini_fat_.clear();
+    entries_.clear();
+    mini_stream_.clear();
+    if (data.size() < kHeaderSize || !is_compound_file(data)) {
+        return false;
+    }
+
+    const char* header = data.data();
+    const uint16_t major_version = read_u16(header + 26);
+    const uint16_t sector_shift = read_u16(header + 30);
+    if (!((major_version == 3 && sector_shift == 9) ||
+          (major_version == 4 && sector_shift == 12))) {
+        return false;
+    }
+    sector_size_ = size_t{1} << sector_shift;
+    mini_cutoff_ = read_u32(header + 56);
+
+    // Sector numbers of the FAT: 109 in the header, the rest in the DIFAT chain
+    const uint32_t fat_sectors = read_u32(header + 44);
+    std::vector<uint32_t> fat_locations;
+    for (size_t i = 0; i < kHeaderDifatEntries && fat_locations.size() < fat_sectors; ++i) {
+        fat_locations.push_back(read_u32(header + 76 + i * 4));
+    }
+    uint32_t difat = read_u32(header + 68);
+    const size_t per_difat = sector_size_ / 4 - 1;
+    for (size_t steps = 0; fat_locations.size() < fat_sectors && difat <= kMaxRegularSector;
+         ++steps) {
+        const size_t offset = (static_cast<size_t>(difat) + 1) * sector_size_;
+        if (steps > sector_count() || offset + sector_size_ > data.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < per_difat && fat_locations.size() < fat_sectors; ++i) {
+            fat_locations.push_back(read_u32(data.data() + offset + i * 4));
+        }
+        difat = read_u32(data.data() + offset + per_difat * 4);
+    }
+
+    fat_.reserve(fat_locations.size() * (sector_size_ / 4));
+    for (const uint32_t location : fat_locations) {
+        const size_t offset = (static_cast<size_t>(location) + 1) * sector_size_;
+        if (location > kMaxRegularSector || offset + sector_size_ > data.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < sector_size_ / 4; ++i) {
+            fat_.push_back(read_u32(data.data() + offset + i * 4));
+        }
+    }
+
+    std::vector<uint8_t> directory;
+    if (!read_chain(read_u32(header + 48), UINT64_MAX, directory) || directory.empty()) {
+        return false;
+    }
+    for (size_t pos = 0; pos + kDirectoryEntrySize <= directory.size();
+         pos += kDirectoryEntrySize) {
+        const char* p = reinterpret_cast<const char*>(directory.data() + pos);
+        Entry entry;
+        const size_t name_chars = std::min<size_t>(read_u16(p + 64) / 2, kMaxNameLength + 1);
+        for (size_t i = 0; i + 1 < name_chars; ++i) {
+            const uint16_t c = read_u16(p + i * 2);
+            entry.name += c < 0x80 ? static_cast<char>(c) : '?';
+        }
+        entry.type = static_cast<uint8_t>(p[66]);
+        entry.left = read_u32(p + 68);
+        entry.right = read_u32(p + 72);
+        entry.child = read_u32(p + 76);
+        entry.start = read_u32(p + 116);
+        entry.size = read_u64(p + 120);
+        if (major_version == 3) {
+            entry.size &= 0xFFFFFFFF;  // The high half is undefined in version 3
+        }
+        entries_.push_back(std::move(entry));
+    }
+    if (entries_.front().type != kTypeRoot) {
+        return false;
+    }
+
+    std::vector<uint8_t> mini_fat_bytes;
+    if (read_u32(header + 64) > 0) {
+        if (!read_chain(read_u32(header + 60), UINT64_MAX, mini_fat_bytes)) {
+            return false;
+        }
+        for (size_t pos = 0; pos + 4 <= mini_fat_bytes.size(); pos += 4) {
+            const char* p = reinterpret_cast<const char*>(mini_fat_bytes.data() + pos);
+            mini_fat_.push_back(read_u32(p));
+        }
+    }
+    const Entry& root = entries_.front();
+    if (root.size > 0 && !read_chain(root.start, root.size, mini_stream_)) {
+        return false;
+    }
+    return true;
+}
+
+int CompoundFileReader::find_root_child(const std::string& name) const {
+    std::vector<uint32_t> pending;
+    if (!entries_.empty()) {
+        pending.push_back(entries_.front().child);
+    }
+    // Every entry is visited at most once even if the sibling links form a cycle
+    std::vector<bool> visited(entries_.size(), false);
+    while (!pending.empty()) {
+        const uint32_t index = pending.back();
+        pending.pop_back();
+        if (index >= entries_.size() || visited[index]) {
+            continue;
+        }
+        visited[index] = true;
+        const Entry& entry = entries_[index];
+        if (name_equal(entry.name, name)) {
+            return static_cast<int>(index);
+        }
+        pending.push_back(entry.left);
+        pending.push_back(entry.right);
+    }
+    return -1;
+}
+
+bool CompoundFileReader::has_stream(const std::string& name) const {
+    const int index = find_root_child(name);
+    return index >= 0 && entries_[static_cast<size_t>(index)].type == kTypeStream;
+}
+
+bool CompoundFileReader::read_stream(const std::string& name, std::vector<uint8_t>& out) const {
+    const int index = find_root_child(name);
+    if (index < 0 || entries_[static_cast<size_t>(index)].type != kTypeStream) {
+        return false;
+    }
+    const Entry& entry = entries_[static_cast<size_t>(index)];
+    if (entry.size == 0) {
+        out.clear();
+        return true;
+    }
+    if (entry.size < mini_cutoff_) {
+        return read_mini_chain(entry.start, entry.size, out);
+    }
+    return read_chain(entry.start, entry.size, out);
+}
+
+// ============================================================================
+// Compound File Writer
+// ============================================================================
+
+bool write_compound_file(const std::string& path, const std::vector<CompoundFileStream>& streams) {
+    std::vector<WriteEntry> entries(1);
+    entries[0].name = "Root Entry";
+    entries[0].type = kTypeRoot;
+
+    for (const auto& stream : streams) {
+        uint32_t parent = 0;
+        size_t begin = 0;
+        size_t slash = stream.path.find('/');
+        while (slash != std::string::npos) {
+            parent = find_or_add_storage(entries, parent, stream.path.substr(begin, slash - begin));
+            begin = slash + 1;
+            slash = stream.path.find('/', begin);
+        }
+        WriteEntry entry;
+        entry.name = stream.path.substr(begin);
+        entry.data = stream.data;
+        entry.size = stream.size;
+        if (entry.name.empty() || entry.name.size() > kMaxNameLength) {
+            return false;
+        }
+        entries.push_back(std::move(entry));
+        entries[parent].children.push_back(static_cast<uint32_t>(entries.size() - 1));
+    }
+    link_directory(entries);
+
+    // Streams below the cutoff live in 64-byte mini sectors inside the mini stream
+    size_t mini_sectors = 0;
+    size_t stream_sectors = 0;
+    for (auto& entry : entries) {
+        if (entry.type != kTypeStream || entry.size == 0) {
+            continue;
+        }
+        if (entry.size < kMiniStreamCutoff) {
+            entry.start = static_cast<uint32_t>(mini_sectors);
+            mini_sectors += div_ceil(entry.size, kMiniSectorSize);
+        } else {
+            stream_sectors += div_ceil(entry.size, kSectorSize);
+        }
+    }
+    const size_t directory_sectors = div_ceil(entries.size() * kDirectoryEntrySize, kSectorSize);
+    const size_t mini_fat_sectors = div_ceil(mini_sectors * 4, kSectorSize);
+    const size_t mini_stream_sectors = div_ceil(mini_sectors * kMiniSectorSize, kSectorSize);
+    const size_t data_sectors =
+        directory_sectors + mini_fat_sectors + mini_stream_sectors + stream_sectors;
+
+    // The FAT also covers its own sectors and those of the DIFAT
+    size_t fat_sectors = 0;
+    size_t difat_sectors = 0;
+    for (;;) {
+        const size_t total = data_sectors + fat_sectors + difat_sectors;
+        const size_t needed_fat = div_ceil(total, kEntriesPerSector);
+        const size_t needed_difat = needed_fat > kHeaderDifatEntries
+                                        ? div_ceil(needed_fat - kHeaderDifatEntries,
+                                                   kEntriesPerSector - 1)
+                                        : 0;
+        if (needed_fat == fat_sectors && needed_difat == difat_sectors) {
+            break;
+        }
+        fat_sectors = needed_fat;
+        difat_sectors = needed_difat;
+    }
+    if (data_sectors + fat_sectors + difat_sectors >= kMaxRegularSector) {
+        return false;
+    }
+
+    std::vector<uint32_t> fat(fat_sectors * kEntriesPerSector, kFreeSector);
+    uint32_t next = 0;
+    auto allocate_chain = [&fat, &next](size_t count) {
+        const uint32_t start = count > 0 ? next : kEndOfChain;
+        for (size_t i = 0; i < count; ++i, ++next) {
+            fat[next] = i + 1 < count ? next + 1 : kEndOfChain;
+        }
+        return start;
+    };
+    const uint32_t directory_start = allocate_chain(directory_sectors);
+    const uint32_t mini_fat_start = allocate_chain(mini_fat_sectors);
+    entries[0].start = allocate_chain(mini_stream_sectors);
+    entries[0].size = mini_sectors * kMiniSectorSize;
+    for (auto& entry : entries) {
+        if (entry.type == kTypeStream && entry.size >= kMiniStreamCutoff) {
+            entry.start = allocate_chain(div_ceil(entry.size, kSectorSize));
+        }
+    }
+    std::vector<uint32_t> fat_locations;
+    for (size_t i = 0; i < fat_sectors; ++i, ++next) {
+        fat[next] = kFatSector;
+        fat_locations.push_back(next);
+    }
+    const uint32_t difat_start = difat_sectors > 0 ? next : kEndOfChain;
+    for (size_t i = 0; i < difat_sectors; ++i, ++next) {
+        fat[next] = kDifatSector;
+    }
+
+    std::vector<uint32_t> mini_fat(mini_fat_sectors * kEntriesPerSector, kFreeSector);
+    for (const auto& entry : entries) {
+        if (entry.type == kTypeStream && entry.size > 0 && entry.size < kMiniStreamCutoff) {
+            const size_t count = div_ceil(entry.size, kMiniSectorSize);
+            for (size_t i = 0; i < count; ++i) {
+                mini_fat[entry.start + i] =
+                    i + 1 < count ? static_cast<uint32_t>(entry.start + i + 1) : kEndOfChain;
+            }
+        }
+    }
+
+    std::vector<uint8_t> header;
+    header.reserve(kHeaderSize);
+    header.insert(header.end(), kSignature, kSignature + kSignatureSize);
+    header.resize(24, 0);  // CLSID
+    write_u16(header, 0x003E);
+    write_u16(header, 3);
+    write_u16(header, 0xFFFE);
+    write_u16(header, 9);
+    write_u16(header, 6);
+    header.resize(40, 0);
+    write_u32(header, 0);  // Directory sectors (always 0 in version 3)
+    write_u32(header, static_cast<uint32_t>(fat_sectors));
+    write_u32(header, directory_start);
+    write_u32(header, 0);
+    write_u32(header, kMiniStreamCutoff);
+    write_u32(header, mini_fat_start);
+    write_u32(header, static_cast<uint32_t>(mini_fat_sectors));
+    write_u32(header, difat_start);
+    write_u32(header, static_cast<uint32_t>(difat_sectors));
+    for (size_t i = 0; i < kHeaderDifatEntries; ++i) {
+        write_u32(header, i < fat_locations.size() ? fat_locations[i] : kFreeSector);
+    }
+
+    std::vector<uint8_t> directory;
+    directory.reserve(directory_sectors * kSectorSize);
+    for (const auto& entry : entries) {
+        append_directory_entry(directory, &entry);
+    }
+    while (directory.size() < directory_sectors * kSectorSize) {
+        append_directory_entry(directory, nullptr);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    write_bytes(out, header.data(), header.size());
+    write_bytes(out, directory.data(), directory.size());
+    write_sector_table(out, mini_fat);
+
+    size_t mini_stream_size = 0;
+    for (const auto& entry : entries) {
+        if (entry.type == kTypeStream && entry.size > 0 && entry.size < kMiniStreamCutoff) {
+            write_bytes(out, entry.data, entry.size);
+            write_padding(out, entry.size, kMiniSectorSize);
+            mini_stream_size += div_ceil(entry.size, kMiniSectorSize) * kMiniSectorSize;
+        }
+    }
+    write_padding(out, mini_stream_size, kSectorSize);
+
+    for (const auto& entry : entries) {
+        if (entry.type == kTypeStream && entry.size >= kMiniStreamCutoff) {
+            write_bytes(out, entry.data, entry.size);
+            write_padding(out, entry.size, kSectorSize);
+        }
+    }
+    write_sector_table(out, fat);
+
+    std::vector<uint32_t> difat(difat_sectors * kEntriesPerSector, kFreeSector);
+    for (size_t i = kHeaderDifatEntries; i < fat_locations.size(); ++i) {
+        const size_t slot = i - kHeaderDifatEntries;
+        difat[slot / (kEntriesPerSector - 1) * kEntriesPerSector + slot % (kEntriesPerSector - 1)] =
+            fat_locations[i];
+    }
+    for (size_t i = 0; i < difat_sectors; ++i) {
+        difat[i * kEntriesPerSector + kEntriesPerSector - 1] =
+            i + 1 < difat_sectors ? static_cast<uint32_t>(difat_start + i + 1) : kEndOfChain;
+    }
+    write_sector_table(out, difat);
+
+    out.close();
+    return !out.fail();
+}
+
+}  // namespace cdocx
@@ -0,0 +1,71 @@
+/**
+ * @file compound_file.h
+ * @brief Internal reader and writer for OLE compound files (MS-CFB)
+ * @internal Not part of the public API.
+ * @details Password-protected packages are stored in a compound file next to
+ *          their encryption parameters. The reader works on a caller-owned
+ *          buffer (usually a MappedFile) and only resolves streams of the root
+ *          storage; the writer produces a version 3 file (512-byte sectors)
+ *          with nested storages, as Word does.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cdocx {
+
+/// True if @p data starts with the compound file signature
+bool is_compound_file(std::string_view data);
+
+class CompoundFileReader {
+  public:
+    /// Parses the header, allocation tables and directory of @p data, which must outlive the reader
+    bool open(std::string_view data);
+
+    /// True if the root storage holds a stream named @p name
+    bool has_stream(const std::string& name) const;
+
+    /// Copies stream @p name of the root storage into @p out; false if missing or damaged
+    bool read_stream(const std::string& name, std::vector<uint8_t>& out) const;
+
+  private:
+    struct Entry {
+        std::string name;
+        uint8_t type = 0;  ///< 1 = storage, 2 = stream, 5 = root
+        uint32_t left = 0;
+        uint32_t right = 0;
+        uint32_t child = 0;
+        uint32_t start = 0;
+        uint64_t size = 0;
+    };
+
+    std::string_view data_;
+    size_t sector_size_ = 512;
+    uint32_t mini_cutoff_ = 4096;
+    std::vector<uint32_t> fat_;
+    std::vector<uint32_t> mini_fat_;
+    std::vector<Entry> entries_;
+    std::vector<uint8_t> mini_stream_;
+
+    size_t sector_count() const;
+    bool read_chain(uint32_t start, uint64_t size, std::vector<uint8_t>& out) const;
+    bool read_mini_chain(uint32_t start, uint64_t size, std::vector<uint8_t>& out) const;
+    int find_root_child(const std::string& name) const;
+};
+
+/// One stream of a compound file to write; '/' in @p path separates storage names
+struct CompoundFileStream {
+    std::string path;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+/// Writes @p streams as a version 3 compound file at @p path
+bool write_compound_file(const std::string& path, const std::vector<CompoundFileStream>& streams);
+
+}  // namespace cdocx
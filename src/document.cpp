@@ -16,7 +16,9 @@
 #include <cdocx/comment.h>
 #include <cdocx/convert_util.h>
 #include <cdocx/document.h>
+#include <cdocx/file_format_util.h>
 #include <cdocx/footnote.h>
+#include <cdocx/html_writer.h>
 #include <cdocx/paragraph.h>
 #include <cdocx/section.h>
 #include <cdocx/style.h>
@@ -29,6 +31,10 @@
 #include <utility>
 #include <vector>
 
+#include "page_layout.h"
+#include "text_offset_index.h"
+#include "zip_archive.h"
+
 namespace cdocx {
 
 namespace {
@@ -414,15 +420,19 @@ Document::Document(Document&& other) noexcept
       filepath_(std::move(other.filepath_)),
       is_open_(other.is_open_),
       load_config_(std::move(other.load_config_)),
+      save_config_(other.save_config_),
       tree_(std::move(other.tree_)),
       xml_parts_cache_(std::move(other.xml_parts_cache_)),
-      media_files_cache_(std::move(other.media_files_cache_)),
+      media_index_(std::move(other.media_index_)),
       relationships_(std::move(other.relationships_)),
       modified_parts_(std::move(other.modified_parts_)),
       content_types_(std::move(other.content_types_)),
       zip_handle_(other.zip_handle_),
       zip_dirty_(other.zip_dirty_),
+      archive_reader_(std::move(other.archive_reader_)),
+      decrypted_package_(std::move(other.decrypted_package_)),
       last_load_stats_(other.last_load_stats_),
+      last_save_stats_(other.last_save_stats_),
       last_load_result_(std::move(other.last_load_result_)),
       sections_cache_(std::move(other.sections_cache_)),
       sections_dirty_(other.sections_dirty_),
@@ -430,6 +440,13 @@ Document::Document(Document&& other) noexcept
       styles_(std::move(other.styles_)),
       builtin_properties_(std::move(other.builtin_properties_)),
       custom_properties_(std::move(other.custom_properties_)),
+      custom_property_nodes_(std::move(other.custom_property_nodes_)),
+      statistics_cache_(std::move(other.statistics_cache_)),
+      statistics_(other.statistics_),
+      update_statistics_on_sync_(other.update_statistics_on_sync_),
+      toc_entries_(std::move(other.toc_entries_)),
+      pagination_(std::move(other.pagination_)),
+      text_index_(std::move(other.text_index_)),
       next_header_number_(other.next_header_number_),
       next_footer_number_(other.next_footer_number_),
       next_bookmark_id_(other.next_bookmark_id_),
@@ -447,15 +464,19 @@ Document& Document::operator=(Document&& other) noexcept {
         filepath_ = std::move(other.filepath_);
         is_open_ = other.is_open_;
         load_config_ = std::move(other.load_config_);
+        save_config_ = other.save_config_;
         tree_ = std::move(other.tree_);
 
         xml_parts_cache_ = std::move(other.xml_parts_cache_);
-        media_files_cache_ = std::move(other.media_files_cache_);
+        media_index_ = std::move(other.media_index_);
         relationships_ = std::move(other.relationships_);
         modified_parts_ = std::move(other.modified_parts_);
         content_types_ = std::move(other.content_types_);
 
+        archive_reader_ = std::move(other.archive_reader_);
+        decrypted_package_ = std::move(other.decrypted_package_);
         last_load_stats_ = other.last_load_stats_;
+        last_save_stats_ = other.last_save_stats_;
         last_load_result_ = std::move(other.last_load_result_);
         sections_cache_ = std::move(other.sections_cache_);
         sections_dirty_ = other.sections_dirty_;
@@ -463,6 +484,13 @@ Document& Document::operator=(Document&& other) noexcept {
         styles_ = std::move(other.styles_);
         builtin_properties_ = std::move(other.builtin_properties_);
         custom_properties_ = std::move(other.custom_properties_);
+        custom_property_nodes_ = std::move(other.custom_property_nodes_);
+        statistics_cache_ = std::move(other.statistics_cache_);
+        statistics_ = other.statistics_;
+        update_statistics_on_sync_ = other.update_statistics_on_sync_;
+        toc_entries_ = std::move(other.toc_entries_);
+        pagination_ = std::move(other.pagination_);
+        text_index_ = std::move(other.text_index_);
         next_header_number_ = other.next_header_number_;
         next_footer_number_ = other.next_footer_number_;
         next_bookmark_id_ = other.next_bookmark_id_;
@@ -556,17 +584,22 @@ LoadResult Document::open_with_config(const std::string& filepath, const LoadCon
     filepath_ = filepath;
     load_config_ = config;
 
-    // Open the ZIP archive
-    if (!open_zip(filepath)) {
+    // Open the ZIP archive, or decrypt a password-protected package into memory
+    LoadError open_error(LoadErrorType::ZipOpenFailed, filepath, "Failed to open ZIP file");
+    if (!open_zip(filepath) && !open_encrypted_zip(filepath, open_error)) {
         LoadResult result;
         result.success = false;
-        result.errors.emplace_back(
-            LoadErrorType::ZipOpenFailed, filepath, "Failed to open ZIP file");
+        result.errors.push_back(std::move(open_error));
         result.integrity = DocumentIntegrity::Corrupted;
         last_load_result_ = result;
         return result;
     }
 
+    // The password is only kept for packages that were encrypted
+    if (decrypted_package_.empty()) {
+        load_config_.password.clear();
+    }
+
     // Load document tree with full result
     auto result = load_tree_with_result();
 
@@ -574,7 +607,8 @@ LoadResult Document::open_with_config(const std::string& filepath, const LoadCon
     // is not locked on Windows (which prevents deletion/rename).
     close_zip();
 
-    if (!result.is_usable() && !config.allow_partial_load) {
+    if (!result.is_usable() &&
+        (!config.allow_partial_load || config.cancellation_token.is_cancelled())) {
         close();
         return result;
     }
@@ -588,12 +622,21 @@ LoadResult Document::open_with_config(const std::string& filepath, const LoadCon
     // Load content types
     load_content_types();
 
+    if (check_load_cancelled(result)) {
+        close();
+        return result;
+    }
+
     is_open_ = result.is_usable();
     sections_dirty_ = true;
 
     // Sync DOM from physical tree
     if (is_open_) {
         sync_from_physical_tree();
+        if (check_load_cancelled(result)) {
+            close();
+            return result;
+        }
         sync_styles_from_physical();
         load_numbering();
     }
@@ -608,11 +651,22 @@ void Document::close() {
     // Clear all internal structures
     tree_.clear();
     xml_parts_cache_.clear();
-    media_files_cache_.clear();
+    media_index_.clear();
     relationships_.clear();
     modified_parts_.clear();
     content_types_.clear();
     sections_cache_.clear();
+    text_index_.reset();
+    if (numbering_manager_) {
+        numbering_manager_->clear();
+    }
+    comments_cache_.clear();
+    footnotes_cache_.clear();
+    endnotes_cache_.clear();
+    comments_index_.clear();
+    comment_anchors_.clear();
+    footnotes_index_.clear();
+    endnotes_index_.clear();
     if (styles_) {
         styles_->clear();
     }
@@ -630,10 +684,22 @@ void Document::save() {
 }
 
 void Document::save(const std::string& filepath) {
+    save_impl(filepath, nullptr);
+}
+
+bool Document::save(const std::string& filepath, const CancellationToken& token) {
+    return save_impl(filepath, &token);
+}
+
+bool Document::save_impl(const std::string& filepath, const CancellationToken* token) {
     if (!is_open()) {
-        return;
+        return false;
     }
 
+    // Checked between the save phases; the phases themselves keep the
+    // DOM and the physical tree consistent, so aborting between them is safe
+    auto cancelled = [token]() { return token && token->is_cancelled(); };
+
     // Sync DOM to physical tree
     sync_to_physical_tree();
 
@@ -642,19 +708,35 @@ void Document::save(const std::string& filepath) {
 
     // Save numbering definitions (create/update numbering.xml)
     save_numbering();
+    if (cancelled()) {
+        return false;
+    }
 
     // Update all modified relationship files
     for (const auto& rels_pair : relationships_) {
         update_relationships_xml(rels_pair.first);
     }
 
+    // Every part is final now, so the media they reference are known
+    MediaCleanupResult media_cleanup;
+    if (save_config_.remove_unused_media) {
+        media_cleanup = sweep_unused_media();
+    }
+
     // Update content types XML
     update_content_types_xml();
+    if (cancelled()) {
+        return false;
+    }
 
-    // Save to ZIP file
-    if (!save_to_zip(filepath)) {
-        return;
+    // Save to ZIP file, encrypted if the document has a password
+    const bool saved = load_config_.password.empty() ? save_to_zip(filepath, token)
+                                                     : save_encrypted(filepath, token);
+    if (!saved) {
+        return false;
     }
+    last_save_stats_.removed_media = media_cleanup.removed_files;
+    last_save_stats_.removed_media_bytes = media_cleanup.removed_bytes;
 
     // Clear modification flags after successful save
     tree_.iterate_all([](const std::shared_ptr<DocxTreeNode>& node) {
@@ -664,6 +746,29 @@ void Document::save(const std::string& filepath) {
     modified_parts_.clear();
 
     zip_dirty_ = true;
+    return true;
+}
+
+bool Document::save(const std::string& filepath, SaveFormat format) {
+    if (format == SaveFormat::Auto) {
+        const auto dot = filepath.find_last_of('.');
+        format = dot == std::string::npos
+                     ? SaveFormat::Docx
+                     : FileFormatUtil::extension_to_save_format(filepath.substr(dot));
+    }
+
+    switch (format) {
+        case SaveFormat::Html:
+            return save_html(filepath, HtmlSaveOptions());
+        case SaveFormat::Docx:
+        case SaveFormat::Docm:
+        case SaveFormat::Dotx:
+        case SaveFormat::Dotm:
+            return save_impl(filepath, nullptr);
+        default:
+            // No writer for this format
+            return false;
+    }
 }
 
 void Document::protect(ProtectionType type, const std::string& password) {
@@ -1076,6 +1181,7 @@ pugi::xml_document& Document::create_xml_part(const std::string& part_path) {
     }
     node->is_new = true;
     node->is_modified = true;
+    node->is_deleted = false;
     modified_parts_.insert(part_path);
     xml_parts_cache_[part_path] = node;
     return *node->xml_doc;
@@ -1092,12 +1198,20 @@ void Document::remove_xml_part(const std::string& part_path) {
 
 void Document::mark_modified(const std::string& part_path) {
     modified_parts_.insert(part_path);
+    if (part_path == "word/document.xml") {
+        text_index_.reset();
+    }
     auto node = tree_.find_node(part_path);
     if (node) {
         node->is_modified = true;
     }
 }
 
+void Document::mark_xml_paragraph_dirty(pugi::xml_node para) {
+    dirty_xml_paragraphs_.insert(para);
+    text_index_.reset();
+}
+
 // ============================================================================
 // Convenience Part Accessors
 // ============================================================================
@@ -1222,46 +1336,69 @@ int Document::generate_unique_bookmark_id() {
 // Comment Management
 // ============================================================================
 
+namespace {
+
+// Create an annotation part and register its content type and document
+// relationship; each step is skipped if it is already in place
+pugi::xml_node ensure_annotation_part(Document* doc,
+                                      const char* part_path,
+                                      const char* root_name,
+                                      const char* content_type,
+                                      const char* rel_type,
+                                      const char* target) {
+    pugi::xml_document* part_xml = doc->get_xml_part(part_path);
+    if (!part_xml) {
+        part_xml = &doc->create_xml_part(part_path);
+    }
+    auto root = part_xml->child(root_name);
+    if (!root) {
+        root = part_xml->append_child(root_name);
+        root.append_attribute("xmlns:w").set_value(
+            "http://schemas.openxmlformats.org/wordprocessingml/2006/main");
+    }
+
+    doc->add_content_type_override(std::string("/") + part_path, content_type);
+
+    const std::string rels_path = "word/_rels/document.xml.rels";
+    if (doc->find_relationship_id(rels_path, target).empty()) {
+        doc->add_relationship(rels_path, rel_type, target);
+    }
+    return root;
+}
+
+}  // namespace
+
 std::shared_ptr<Comment> Document::add_comment(const std::string& author, const std::string& text) {
     auto comment = std::make_shared<Comment>(this, author, text);
     comment->set_id(get_next_comment_id());
     comments_cache_.push_back(comment);
+    comments_index_.by_id[comment->get_id()] = comment;
     comments_dirty_ = false;
 
-    // Ensure comments.xml exists
-    pugi::xml_document* comments_xml = get_xml_part("word/comments.xml");
-    if (!comments_xml) {
-        comments_xml = &create_xml_part("word/comments.xml");
-        auto root = comments_xml->append_child("w:comments");
-        root.append_attribute("xmlns:w").set_value(
-            "http://schemas.openxmlformats.org/wordprocessingml/2006/main");
-        root.append_attribute("xmlns:w14")
-            .set_value("http://schemas.microsoft.com/office/word/2010/wordml");
-        root.append_attribute("xmlns:w15")
-            .set_value("http://schemas.microsoft.com/office/word/2012/wordml");
+    if (!comments_index_.registered) {
+        auto root = ensure_annotation_part(
+            this,
+            "word/comments.xml",
+            "w:comments",
+            "application/vnd.openxmlformats-officedocument.wordprocessingml.comments+xml",
+            "http://schemas.openxmlformats.org/officeDocument/2006/relationships/comments",
+            "comments.xml");
+        if (!root.attribute("xmlns:w14")) {
+            root.append_attribute("xmlns:w14")
+                .set_value("http://schemas.microsoft.com/office/word/2010/wordml");
+            root.append_attribute("xmlns:w15")
+                .set_value("http://schemas.microsoft.com/office/word/2012/wordml");
+        }
+        comments_index_.registered = true;
     }
 
-    // Add content type override if needed
-    add_content_type_override(
-        "/word/comments.xml",
-        "application/vnd.openxmlformats-officedocument.wordprocessingml.comments+xml");
-
-    // Add relationship if needed
-    add_relationship("word/_rels/document.xml.rels",
-                     "http://schemas.openxmlformats.org/officeDocument/2006/relationships/comments",
-                     "comments.xml");
-
     mark_modified("word/comments.xml");
     return comment;
 }
 
 std::shared_ptr<Comment> Document::get_comment(int id) const {
-    for (const auto& comment : comments_cache_) {
-        if (comment->get_id() == id) {
-            return comment;
-        }
-    }
-    return nullptr;
+    auto it = comments_index_.by_id.find(id);
+    return it != comments_index_.by_id.end() ? it->second : nullptr;
 }
 
 CommentCollection Document::get_comments() const {
@@ -1269,20 +1406,199 @@ CommentCollection Document::get_comments() const {
     return CommentCollection(const_cast<Document*>(this));
 }
 
+namespace {
+
+// Drop an item from a comment/note cache and index, removing its serialized
+// element right away so the next sync has nothing to reconcile
+template <typename T, typename Index>
+bool remove_annotation(std::vector<std::shared_ptr<T>>& cache, Index& index, int id) {
+    auto found = index.by_id.find(id);
+    if (found == index.by_id.end()) {
+        return false;
+    }
+    const T* item = found->second.get();
+    index.by_id.erase(found);
+
+    auto synced = index.synced.find(item);
+    if (synced != index.synced.end()) {
+        synced->second.node.parent().remove_child(synced->second.node);
+        index.synced.erase(synced);
+    }
+    cache.erase(std::find_if(cache.begin(),
+                             cache.end(),
+                             [item](const std::shared_ptr<T>& c) { return c.get() == item; }));
+    return true;
+}
+
+// Move @p item from @p old_id to its current id; false if the index does not
+// hold it under @p old_id (not added to the document yet, or a clone)
+template <typename T, typename Index>
+bool rekey_annotation(Index& index, const T& item, int old_id) {
+    auto found = index.by_id.find(old_id);
+    if (found == index.by_id.end() || found->second.get() != &item) {
+        return false;
+    }
+    std::shared_ptr<T> owned = std::move(found->second);
+    index.by_id.erase(found);
+    index.by_id[item.get_id()] = std::move(owned);
+    return true;
+}
+
+/// Removes the anchors of comment @p id from the w:p element @p para
+void remove_xml_comment_anchors(pugi::xml_node para, int id) {
+    for (pugi::xml_node child = para.first_child(); child;) {
+        const pugi::xml_node next = child.next_sibling();
+        const char* name = child.name();
+        if ((std::strcmp(name, "w:commentRangeStart") == 0 ||
+             std::strcmp(name, "w:commentRangeEnd") == 0) &&
+            child.attribute("w:id").as_int() == id) {
+            para.remove_child(child);
+        } else if (std::strcmp(name, "w:r") == 0) {
+            const pugi::xml_node ref = child.child("w:commentReference");
+            if (ref && ref.attribute("w:id").as_int() == id) {
+                para.remove_child(child);
+            }
+        }
+        child = next;
+    }
+}
+
+/// Renumbers the anchors of comment @p old_id in the w:p element @p para
+void rename_xml_comment_anchors(pugi::xml_node para, int old_id, int new_id) {
+    for (pugi::xml_node child : para.children()) {
+        pugi::xml_node anchor = child;
+        if (std::strcmp(child.name(), "w:r") == 0) {
+            anchor = child.child("w:commentReference");
+        } else if (std::strcmp(child.name(), "w:commentRangeStart") != 0 &&
+                   std::strcmp(child.name(), "w:commentRangeEnd") != 0) {
+            continue;
+        }
+        if (anchor && anchor.attribute("w:id").as_int() == old_id) {
+            anchor.attribute("w:id").set_value(new_id);
+        }
+    }
+}
+
+template <typename T, typename Index>
+void clear_annotations(std::vector<std::shared_ptr<T>>& cache, Index& index) {
+    for (auto& entry : index.synced) {
+        entry.second.node.parent().remove_child(entry.second.node);
+    }
+    index.synced.clear();
+    index.by_id.clear();
+    cache.clear();
+}
+
+}  // namespace
+
+void Document::index_comment_anchors() {
+    comment_anchors_.clear();
+    std::function<void(const CompositeNode&)> visit = [&](const CompositeNode& parent) {
+        for (const auto& child : parent.get_children()) {
+            if (auto* start = dynamic_cast<CommentRangeStart*>(child.get())) {
+                comment_anchors_[start->get_id()].push_back(child);
+            } else if (auto* end = dynamic_cast<CommentRangeEnd*>(child.get())) {
+                comment_anchors_[end->get_id()].push_back(child);
+            } else if (child->is_composite()) {
+                visit(static_cast<const CompositeNode&>(*child));
+            }
+        }
+    };
+    visit(*this);
+}
+
+void Document::remove_comment_anchors(int id) {
+    auto found = comment_anchors_.find(id);
+    if (found == comment_anchors_.end()) {
+        return;
+    }
+    for (const auto& weak : found->second) {
+        auto anchor = weak.lock();
+        if (!anchor || !anchor->get_parent()) {
+            continue;
+        }
+        // A paragraph still bound to its XML may be re-read from it on save
+        if (auto* para = dynamic_cast<Paragraph*>(anchor->get_parent())) {
+            remove_xml_comment_anchors(para->get_current(), id);
+        }
+        anchor->remove();
+    }
+    comment_anchors_.erase(found);
+}
+
+void Document::rename_comment(const Comment& comment, int old_id) {
+    if (!rekey_annotation(comments_index_, comment, old_id)) {
+        return;
+    }
+    mark_modified("word/comments.xml");
+
+    // The anchors follow the comment; anchors of a missing id are dropped on save
+    auto found = comment_anchors_.find(old_id);
+    if (found == comment_anchors_.end()) {
+        return;
+    }
+    const int new_id = comment.get_id();
+    std::vector<std::weak_ptr<Node>> anchors = std::move(found->second);
+    comment_anchors_.erase(found);
+    for (const auto& weak : anchors) {
+        auto anchor = weak.lock();
+        if (!anchor) {
+            continue;
+        }
+        if (auto* start = dynamic_cast<CommentRangeStart*>(anchor.get())) {
+            start->set_id(new_id);
+        } else if (auto* end = dynamic_cast<CommentRangeEnd*>(anchor.get())) {
+            end->set_id(new_id);
+        }
+        if (auto* para = dynamic_cast<Paragraph*>(anchor->get_parent())) {
+            rename_xml_comment_anchors(para->get_current(), old_id, new_id);
+        }
+    }
+    auto& renamed = comment_anchors_[new_id];
+    renamed.insert(renamed.end(), anchors.begin(), anchors.end());
+}
+
 bool Document::remove_comment(int id) {
-    auto it = std::remove_if(comments_cache_.begin(),
-                             comments_cache_.end(),
-                             [id](const std::shared_ptr<Comment>& c) { return c->get_id() == id; });
-    if (it != comments_cache_.end()) {
-        comments_cache_.erase(it, comments_cache_.end());
+    if (remove_annotation(comments_cache_, comments_index_, id)) {
+        remove_comment_anchors(id);
         mark_modified("word/comments.xml");
         return true;
     }
     return false;
 }
 
+int Document::remove_comments_if(const std::function<bool(const Comment&)>& predicate) {
+    if (!predicate) {
+        return 0;
+    }
+    const auto removed_begin = std::stable_partition(
+        comments_cache_.begin(), comments_cache_.end(),
+        [&](const std::shared_ptr<Comment>& comment) { return !predicate(*comment); });
+    const auto removed = static_cast<int>(comments_cache_.end() - removed_begin);
+
+    for (auto it = removed_begin; it != comments_cache_.end(); ++it) {
+        const Comment* comment = it->get();
+        auto synced = comments_index_.synced.find(comment);
+        if (synced != comments_index_.synced.end()) {
+            synced->second.node.parent().remove_child(synced->second.node);
+            comments_index_.synced.erase(synced);
+        }
+        comments_index_.by_id.erase(comment->get_id());
+        remove_comment_anchors(comment->get_id());
+    }
+    comments_cache_.erase(removed_begin, comments_cache_.end());
+
+    if (removed > 0) {
+        mark_modified("word/comments.xml");
+    }
+    return removed;
+}
+
 void Document::clear_comments() {
-    comments_cache_.clear();
+    for (const auto& comment : comments_cache_) {
+        remove_comment_anchors(comment->get_id());
+    }
+    clear_annotations(comments_cache_, comments_index_);
     mark_modified("word/comments.xml");
 }
 
@@ -1305,28 +1621,24 @@ std::shared_ptr<Footnote> Document::add_footnote(const std::string& text,
         footnote->set_text(text);
     }
     footnotes_cache_.push_back(footnote);
+    footnotes_index_.by_id[footnote->get_id()] = footnote;
     footnotes_dirty_ = false;
 
-    // Ensure footnotes.xml exists
-    pugi::xml_document* footnotes_xml = get_xml_part("word/footnotes.xml");
-    if (!footnotes_xml) {
-        footnotes_xml = &create_xml_part("word/footnotes.xml");
-        auto root = footnotes_xml->append_child("w:footnotes");
-        root.append_attribute("xmlns:w").set_value(
-            "http://schemas.openxmlformats.org/wordprocessingml/2006/main");
-        root.append_attribute("xmlns:r").set_value(
-            "http://schemas.openxmlformats.org/officeDocument/2006/relationships");
+    if (!footnotes_index_.registered) {
+        auto root = ensure_annotation_part(
+            this,
+            "word/footnotes.xml",
+            "w:footnotes",
+            "application/vnd.openxmlformats-officedocument.wordprocessingml.footnotes+xml",
+            "http://schemas.openxmlformats.org/officeDocument/2006/relationships/footnotes",
+            "footnotes.xml");
+        if (!root.attribute("xmlns:r")) {
+            root.append_attribute("xmlns:r").set_value(
+                "http://schemas.openxmlformats.org/officeDocument/2006/relationships");
+        }
+        footnotes_index_.registered = true;
     }
 
-    add_content_type_override(
-        "/word/footnotes.xml",
-        "application/vnd.openxmlformats-officedocument.wordprocessingml.footnotes+xml");
-
-    add_relationship(
-        "word/_rels/document.xml.rels",
-        "http://schemas.openxmlformats.org/officeDocument/2006/relationships/footnotes",
-        "footnotes.xml");
-
     mark_modified("word/footnotes.xml");
     return footnote;
 }
@@ -1342,27 +1654,24 @@ std::shared_ptr<Footnote> Document::add_endnote(const std::string& text,
         endnote->set_text(text);
     }
     endnotes_cache_.push_back(endnote);
+    endnotes_index_.by_id[endnote->get_id()] = endnote;
     endnotes_dirty_ = false;
 
-    // Ensure endnotes.xml exists
-    pugi::xml_document* endnotes_xml = get_xml_part("word/endnotes.xml");
-    if (!endnotes_xml) {
-        endnotes_xml = &create_xml_part("word/endnotes.xml");
-        auto root = endnotes_xml->append_child("w:endnotes");
-        root.append_attribute("xmlns:w").set_value(
-            "http://schemas.openxmlformats.org/wordprocessingml/2006/main");
-        root.append_attribute("xmlns:r").set_value(
-            "http://schemas.openxmlformats.org/officeDocument/2006/relationships");
+    if (!endnotes_index_.registered) {
+        auto root = ensure_annotation_part(
+            this,
+            "word/endnotes.xml",
+            "w:endnotes",
+            "application/vnd.openxmlformats-officedocument.wordprocessingml.endnotes+xml",
+            "http://schemas.openxmlformats.org/officeDocument/2006/relationships/endnotes",
+            "endnotes.xml");
+        if (!root.attribute("xmlns:r")) {
+            root.append_attribute("xmlns:r").set_value(
+                "http://schemas.openxmlformats.org/officeDocument/2006/relationships");
+        }
+        endnotes_index_.registered = true;
     }
 
-    add_content_type_override(
-        "/word/endnotes.xml",
-        "application/vnd.openxmlformats-officedocument.wordprocessingml.endnotes+xml");
-
-    add_relationship("word/_rels/document.xml.rels",
-                     "http://schemas.openxmlformats.org/officeDocument/2006/relationships/endnotes",
-                     "endnotes.xml");
-
     mark_modified("word/endnotes.xml");
     return endnote;
 }
@@ -1378,12 +1687,7 @@ EndnoteCollection Document::endnotes() const {
 }
 
 bool Document::remove_footnote(int id) {
-    auto it = std::remove_if(
-        footnotes_cache_.begin(), footnotes_cache_.end(), [id](const std::shared_ptr<Footnote>& f) {
-            return f->get_id() == id;
-        });
-    if (it != footnotes_cache_.end()) {
-        footnotes_cache_.erase(it, footnotes_cache_.end());
+    if (remove_annotation(footnotes_cache_, footnotes_index_, id)) {
         mark_modified("word/footnotes.xml");
         return true;
     }
@@ -1391,12 +1695,7 @@ bool Document::remove_footnote(int id) {
 }
 
 bool Document::remove_endnote(int id) {
-    auto it = std::remove_if(
-        endnotes_cache_.begin(), endnotes_cache_.end(), [id](const std::shared_ptr<Footnote>& f) {
-            return f->get_id() == id;
-        });
-    if (it != endnotes_cache_.end()) {
-        endnotes_cache_.erase(it, endnotes_cache_.end());
+    if (remove_annotation(endnotes_cache_, endnotes_index_, id)) {
         mark_modified("word/endnotes.xml");
         return true;
     }
@@ -1404,15 +1703,23 @@ bool Document::remove_endnote(int id) {
 }
 
 void Document::clear_footnotes() {
-    footnotes_cache_.clear();
+    clear_annotations(footnotes_cache_, footnotes_index_);
     mark_modified("word/footnotes.xml");
 }
 
 void Document::clear_endnotes() {
-    endnotes_cache_.clear();
+    clear_annotations(endnotes_cache_, endnotes_index_);
     mark_modified("word/endnotes.xml");
 }
 
+void Document::rename_note(const Footnote& note, int old_id) {
+    if (rekey_annotation(footnotes_index_, note, old_id)) {
+        mark_modified("word/footnotes.xml");
+    } else if (rekey_annotation(endnotes_index_, note, old_id)) {
+        mark_modified("word/endnotes.xml");
+    }
+}
+
 int Document::get_next_footnote_id() {
     return next_footnote_id_++;
 }
@@ -1492,6 +1799,14 @@ void Document::save_numbering() {
     if (has_xml_part("word/numbering.xml")) {
         doc = get_numbering_xml();
         if (doc) {
+            // Append only what was added since loading/the last save; the
+            // existing definitions keep their original XML
+            auto root = doc->child("w:numbering");
+            if (root) {
+                numbering_manager_->save_changes_to_xml(root);
+                mark_modified("word/numbering.xml");
+                return;
+            }
             doc->reset();
         }
     } else {
@@ -4,6 +4,7 @@
  * @since 0.3.0
  */
 
+#include <cdocx/control_char.h>
 #include <cdocx/document.h>
 #include <cdocx/document_builder.h>
 #include <cdocx/footnote.h>
@@ -16,6 +17,7 @@
 #include <map>
 #include <vector>
 
+#include "run_text.h"
 #include "sync_common.h"
 
 namespace cdocx {
@@ -558,22 +560,46 @@ DocumentBuilder& DocumentBuilder::move_to_header_footer(HeaderFooterType type) {
 }
 
 // Text Insertion
-DocumentBuilder& DocumentBuilder::write(const std::string& text) {
+DocumentBuilder& DocumentBuilder::write(std::string_view text) {
+    // ControlChar::paragraph_break() ('\r' or "\r\n") starts a new paragraph;
+    // the other control characters become tabs and breaks inside the run
+    if (find_control_byte(text) == text.size()) {
+        write_run(text);
+        return *this;
+    }
+
+    size_t start = 0;
+    size_t end = text.find(ControlChar::kParagraphBreakChar);
+    while (true) {
+        if (end > start && start < text.size()) {
+            write_run(text.substr(start, end - start));
+        }
+        if (end == std::string_view::npos) {
+            break;
+        }
+        insert_break(BreakType::ParagraphBreak);
+        start = end + 1;
+        if (start < text.size() && text[start] == ControlChar::kLineFeedChar) {
+            ++start;
+        }
+        end = text.find(ControlChar::kParagraphBreakChar, start);
+    }
+    return *this;
+}
+
+void DocumentBuilder::write_run(std::string_view text) {
     ensure_paragraph();
 
     pugi::xml_node run = current_paragraph_.append_child("w:r");
     apply_formatting(run);
-
-    const pugi::xml_node t = run.append_child("w:t");
-    t.text().set(text.c_str());
+    append_run_text(run, text);
 
     if (doc_) {
         doc_->mark_xml_paragraph_dirty(current_paragraph_);
     }
-    return *this;
 }
 
-DocumentBuilder& DocumentBuilder::writeln(const std::string& text) {
+DocumentBuilder& DocumentBuilder::writeln(std::string_view text) {
     write(text);
     insert_break(BreakType::ParagraphBreak);
     return *this;
@@ -753,6 +779,24 @@ static void append_field_sequence(pugi::xml_node para,
     run_end.append_child("w:fldChar").append_attribute("w:fldCharType").set_value("end");
 }
 
+// Paragraph holding the end of the field that begins in the @p index-th body
+// paragraph and spans paragraphs; that paragraph itself when there is none
+static pugi::xml_node find_field_end_paragraph(pugi::xml_node body, size_t index) {
+    pugi::xml_node start = body.child("w:p");
+    for (size_t i = 0; start && i < index; ++i) {
+        start = start.next_sibling("w:p");
+    }
+    for (auto para = start.next_sibling("w:p"); para; para = para.next_sibling("w:p")) {
+        for (auto run = para.child("w:r"); run; run = run.next_sibling("w:r")) {
+            const char* type = run.child("w:fldChar").attribute("w:fldCharType").value();
+            if (std::strcmp(type, "end") == 0) {
+                return para;
+            }
+        }
+    }
+    return start;
+}
+
 }  // anonymous namespace
 
 std::shared_ptr<Field> DocumentBuilder::insert_field(FieldType field_type, bool /*update_field*/) {
@@ -842,18 +886,34 @@ std::shared_ptr<Field> DocumentBuilder::insert_table_of_contents(const std::stri
 
     auto field = std::make_shared<Field>(doc_, FieldType::Unknown);
     field->set_field_code("TOC");
-    field->set_result("\nClick here to update table of contents.\n");
     if (!switches.empty()) {
         field->add_switch(switches);
     }
 
     const std::string full_code = field->get_full_field_code();
     const std::string instr = " " + full_code + " \\h";
-    append_field_sequence(current_paragraph_, instr, field->get_result());
+    append_field_sequence(current_paragraph_, instr, "");
+    if (!doc_) {
+        return field;
+    }
+    doc_->mark_xml_paragraph_dirty(current_paragraph_);
 
-    if (doc_) {
-        doc_->mark_xml_paragraph_dirty(current_paragraph_);
+    // Fill in the entries for the headings written so far. The update rewrites
+    // the body XML, so the cursor moves on to the paragraph with the field end.
+    const pugi::xml_node body = get_body();
+    if (current_paragraph_.parent() != body || std::strcmp(body.name(), "w:body") != 0) {
+        return field;
     }
+    size_t index = 0;
+    for (auto para = body.child("w:p"); para && para != current_paragraph_;
+         para = para.next_sibling("w:p")) {
+        ++index;
+    }
+    doc_->update_table_of_contents();
+
+    current_paragraph_ = find_field_end_paragraph(get_body(), index);
+    current_node_ = current_paragraph_;
+    field->set_spans_paragraphs(true);
     return field;
 }
 
@@ -0,0 +1,1188 @@
+/**
+ * @file document_compare.cpp
+ * @brief Document comparison implementation for CDocx
+ * @details Blocks (w:p / w:tbl) are fingerprinted with 64-bit FNV-1a over their
+ *          text and normalized formatting (rsid attributes ignored), the two
+ *          fingerprint sequences are aligned with a Myers diff, and only the
+ *          paragraphs in changed hunks are tokenized and diffed again. Redline
+ *          output is written directly into the original document.xml and the
+ *          DOM is rebuilt from it afterwards.
+ * @since 0.8.0
+ */
+
+#include <cdocx/document.h>
+#include <cdocx/document_compare.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sync_common.h"
+
+namespace cdocx {
+
+namespace {
+
+constexpr std::uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+constexpr std::uint64_t kFnvPrime = 1099511628211ULL;
+
+constexpr const char* kDocumentRels = "word/_rels/document.xml.rels";
+constexpr const char* kHyperlinkRelType =
+    "http://schemas.openxmlformats.org/officeDocument/2006/relationships/hyperlink";
+
+// A paragraph whose shared text is below this fraction of the longer text is
+// treated as deleted + inserted instead of modified
+constexpr std::size_t kMinSimilarityDivisor = 3;
+
+// Paragraph-level markers that may precede or follow the runs of a paragraph
+// without preventing run-by-run rewriting
+const char* const kMarkerElements[] = {
+    "w:bookmarkStart",
+    "w:bookmarkEnd",
+    "w:commentRangeStart",
+    "w:commentRangeEnd",
+    "w:permStart",
+    "w:permEnd",
+};
+
+// ============================================================================
+// Hashing
+// ============================================================================
+
+inline void fnv_mix(std::uint64_t& hash, const char* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= kFnvPrime;
+    }
+}
+
+inline void fnv_mix(std::uint64_t& hash, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xFFU;
+        hash *= kFnvPrime;
+    }
+}
+
+// Revision-save ids differ between otherwise identical content
+bool is_volatile_attribute(const char* name) {
+    return std::strncmp(name, "w:rsid", 6) == 0;
+}
+
+void hash_subtree(std::uint64_t& hash, pugi::xml_node node) {
+    fnv_mix(hash, node.name(), std::strlen(node.name()));
+    for (auto attr = node.first_attribute(); attr; attr = attr.next_attribute()) {
+        if (!is_volatile_attribute(attr.name())) {
+            fnv_mix(hash, attr.name(), std::strlen(attr.name()));
+            fnv_mix(hash, "=", 1);
+            fnv_mix(hash, attr.value(), std::strlen(attr.value()));
+        }
+    }
+    for (auto child = node.first_child(); child; child = child.next_sibling()) {
+        if (child.type() == pugi::node_pcdata || child.type() == pugi::node_cdata) {
+            fnv_mix(hash, child.value(), std::strlen(child.value()));
+        } else if (child.type() == pugi::node_element) {
+            fnv_mix(hash, "<", 1);
+            hash_subtree(hash, child);
+            fnv_mix(hash, ">", 1);
+        }
+    }
+}
+
+std::uint64_t hash_properties(pugi::xml_node props) {
+    if (!props) {
+        return 0;
+    }
+    std::uint64_t hash = kFnvOffsetBasis;
+    hash_subtree(hash, props);
+    return hash;
+}
+
+// Paragraph properties without the paragraph mark (w:rPr), section break and
+// earlier property revisions; those do not change what the paragraph shows
+bool is_excluded_p_pr_child(const char* name) {
+    return std::strcmp(name, "w:rPr") == 0 || std::strcmp(name, "w:sectPr") == 0 ||
+           std::strcmp(name, "w:pPrChange") == 0;
+}
+
+std::uint64_t hash_paragraph_properties(pugi::xml_node para) {
+    auto p_pr = para.child("w:pPr");
+    if (!p_pr) {
+        return 0;
+    }
+    std::uint64_t hash = kFnvOffsetBasis;
+    for (auto child = p_pr.first_child(); child; child = child.next_sibling()) {
+        if (child.type() == pugi::node_element && !is_excluded_p_pr_child(child.name())) {
+            hash_subtree(hash, child);
+        }
+    }
+    return hash;
+}
+
+bool is_marker_element(const char* name) {
+    for (const char* marker : kMarkerElements) {
+        if (std::strcmp(name, marker) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// Paragraph content
+// ============================================================================
+
+struct Segment {
+    pugi::xml_node run;  ///< Source w:r
+    std::uint64_t format = 0;  ///< Normalized w:rPr hash
+    std::string text;
+};
+
+struct ParagraphInfo {
+    std::vector<Segment> segments;
+    std::uint64_t objects = kFnvOffsetBasis;  ///< Hash of non-text run content
+    bool simple = true;  ///< Only plain text runs: safe to rewrite run by run
+};
+
+void collect_run(pugi::xml_node run, ParagraphInfo& info) {
+    Segment segment;
+    segment.run = run;
+    segment.format = hash_properties(run.child("w:rPr"));
+
+    for (auto child = run.first_child(); child; child = child.next_sibling()) {
+        if (child.type() != pugi::node_element) {
+            continue;
+        }
+        const char* name = child.name();
+        if (std::strcmp(name, "w:rPr") == 0) {
+            continue;
+        }
+        if (std::strcmp(name, "w:t") == 0) {
+            segment.text += child.text().get();
+        } else if (std::strcmp(name, "w:tab") == 0) {
+            segment.text += '\t';
+        } else if ((std::strcmp(name, "w:br") == 0 && !child.attribute("w:type")) ||
+                   std::strcmp(name, "w:cr") == 0) {
+            segment.text += '\n';
+        } else {
+            // Drawings, fields, page breaks, ...: part of the fingerprint, not of the text
+            info.simple = false;
+            fnv_mix(info.objects, hash_properties(child));
+        }
+    }
+    info.segments.push_back(std::move(segment));
+}
+
+// Runs nested in hyperlinks, smart tags, content controls or earlier insertions
+void collect_nested_runs(pugi::xml_node parent, ParagraphInfo& info) {
+    for (auto child = parent.first_child(); child; child = child.next_sibling()) {
+        if (child.type() != pugi::node_element) {
+            continue;
+        }
+        const char* name = child.name();
+        if (std::strcmp(name, "w:r") == 0) {
+            collect_run(child, info);
+        } else if (std::strcmp(name, "w:del") != 0 && std::strcmp(name, "w:rPr") != 0 &&
+                   std::strcmp(name, "w:sdtPr") != 0) {
+            collect_nested_runs(child, info);
+        }
+    }
+}
+
+ParagraphInfo collect_paragraph(pugi::xml_node para) {
+    ParagraphInfo info;
+    bool seen_run = false;
+    bool marker_after_run = false;
+
+    for (auto child = para.first_child(); child; child = child.next_sibling()) {
+        if (child.type() != pugi::node_element) {
+            continue;
+        }
+        const char* name = child.name();
+        if (std::strcmp(name, "w:pPr") == 0 || std::strcmp(name, "w:proofErr") == 0) {
+            continue;
+        }
+        if (std::strcmp(name, "w:r") == 0) {
+            // A marker between two runs would be moved by rewriting
+            if (marker_after_run) {
+                info.simple = false;
+            }
+            collect_run(child, info);
+            seen_run = true;
+        } else if (is_marker_element(name)) {
+            marker_after_run = seen_run;
+        } else if (std::strcmp(name, "w:del") == 0) {
+            // Already deleted content is not part of the current text
+            info.simple = false;
+        } else {
+            info.simple = false;
+            collect_nested_runs(child, info);
+        }
+    }
+    return info;
+}
+
+std::string paragraph_text(const ParagraphInfo& info) {
+    std::string text;
+    for (const auto& segment : info.segments) {
+        text += segment.text;
+    }
+    return text;
+}
+
+// ============================================================================
+// Fingerprints
+// ============================================================================
+
+std::uint64_t fingerprint_paragraph(pugi::xml_node para, bool ignore_formatting) {
+    const ParagraphInfo info = collect_paragraph(para);
+
+    std::uint64_t hash = kFnvOffsetBasis;
+    fnv_mix(hash, "P", 1);
+    if (!ignore_formatting) {
+        fnv_mix(hash, hash_paragraph_properties(para));
+    }
+
+    // Formatting is mixed in only where it changes, so a run split into two
+    // identically formatted runs keeps the same fingerprint
+    std::uint64_t previous_format = 0;
+    for (const auto& segment : info.segments) {
+        if (segment.text.empty()) {
+            continue;
+        }
+        if (!ignore_formatting && segment.format != previous_format) {
+            fnv_mix(hash, "\x1F", 1);
+            fnv_mix(hash, segment.format);
+            previous_format = segment.format;
+        }
+        fnv_mix(hash, segment.text.data(), segment.text.size());
+    }
+    fnv_mix(hash, info.objects);
+    return hash;
+}
+
+std::uint64_t fingerprint_table(pugi::xml_node table, bool ignore_formatting) {
+    std::uint64_t hash = kFnvOffsetBasis;
+    fnv_mix(hash, "T", 1);
+    if (!ignore_formatting) {
+        fnv_mix(hash, hash_properties(table.child("w:tblPr")));
+    }
+    for (auto row = table.child("w:tr"); row; row = row.next_sibling("w:tr")) {
+        fnv_mix(hash, "R", 1);
+        for (auto cell = row.child("w:tc"); cell; cell = cell.next_sibling("w:tc")) {
+            fnv_mix(hash, "C", 1);
+            for (auto block = cell.first_child(); block; block = block.next_sibling()) {
+                if (is_para_node(block.name())) {
+                    fnv_mix(hash, fingerprint_paragraph(block, ignore_formatting));
+                } else if (is_table_node(block.name())) {
+                    fnv_mix(hash, fingerprint_table(block, ignore_formatting));
+                }
+            }
+        }
+    }
+    return hash;
+}
+
+struct Block {
+    pugi::xml_node node;
+    std::uint64_t fingerprint = 0;
+    bool is_table = false;
+};
+
+std::vector<Block> collect_blocks(pugi::xml_node container, bool ignore_formatting) {
+    std::vector<Block> blocks;
+    for (auto child = container.first_child(); child; child = child.next_sibling()) {
+        const char* name = child.name();
+        if (is_para_node(name)) {
+            blocks.push_back({child, fingerprint_paragraph(child, ignore_formatting), false});
+        } else if (is_table_node(name)) {
+            blocks.push_back({child, fingerprint_table(child, ignore_formatting), true});
+        }
+    }
+    return blocks;
+}
+
+std::string block_text(pugi::xml_node block) {
+    if (is_para_node(block.name())) {
+        return paragraph_text(collect_paragraph(block));
+    }
+
+    std::string text;
+    for (auto row = block.child("w:tr"); row; row = row.next_sibling("w:tr")) {
+        if (!text.empty()) {
+            text += '\n';
+        }
+        bool first_cell = true;
+        for (auto cell = row.child("w:tc"); cell; cell = cell.next_sibling("w:tc")) {
+            if (!first_cell) {
+                text += '\t';
+            }
+            first_cell = false;
+            bool first_block = true;
+            for (auto child = cell.first_child(); child; child = child.next_sibling()) {
+                if (is_para_node(child.name()) || is_table_node(child.name())) {
+                    if (!first_block) {
+                        text += ' ';
+                    }
+                    first_block = false;
+                    text += block_text(child);
+                }
+            }
+        }
+    }
+    return text;
+}
+
+// ============================================================================
+// Myers diff
+// ============================================================================
+
+enum class EditKind : std::uint8_t { Equal, Delete, Insert };
+
+struct Edit {
+    EditKind kind;
+    int a;  ///< Index in the original sequence (-1 for insertions)
+    int b;  ///< Index in the revised sequence (-1 for deletions)
+};
+
+// Greedy O((N+M)D) shortest edit script. Only the diagonals reached at each
+// step are kept for backtracking, so memory is O(D^2) rather than O((N+M)D).
+void myers_diff(const std::uint64_t* a,
+                int n,
+                const std::uint64_t* b,
+                int m,
+                int a_base,
+                int b_base,
+                std::vector<Edit>& edits) {
+    if (n == 0 || m == 0) {
+        for (int i = 0; i < n; ++i) {
+            edits.push_back({EditKind::Delete, a_base + i, -1});
+        }
+        for (int j = 0; j < m; ++j) {
+            edits.push_back({EditKind::Insert, -1, b_base + j});
+        }
+        return;
+    }
+
+    const int max = n + m;
+    const int offset = max + 1;
+    std::vector<int> v(static_cast<std::size_t>(2 * max + 3), 0);
+    std::vector<std::vector<int>> trace;
+    int steps = 0;
+
+    for (int d = 0; d <= max; ++d) {
+        bool done = false;
+        for (int k = -d; k <= d; k += 2) {
+            const bool down = k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]);
+            int x = down ? v[offset + k + 1] : v[offset + k - 1] + 1;
+            int y = x - k;
+            while (x < n && y < m && a[x] == b[y]) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m) {
+                done = true;
+                break;
+            }
+        }
+        trace.emplace_back(v.begin() + offset - d, v.begin() + offset + d + 1);
+        if (done) {
+            steps = d;
+            break;
+        }
+    }
+
+    std::vector<Edit> reversed;
+    int x = n;
+    int y = m;
+    for (int d = steps; d > 0; --d) {
+        const auto& previous = trace[static_cast<std::size_t>(d - 1)];
+        auto value_at = [&previous, d](int k) {
+            return previous[static_cast<std::size_t>(k + d - 1)];
+        };
+
+        const int k = x - y;
+        const bool down = k == -d || (k != d && value_at(k - 1) < value_at(k + 1));
+        const int prev_k = down ? k + 1 : k - 1;
+        const int prev_x = value_at(prev_k);
+        const int prev_y = prev_x - prev_k;
+
+        while (x > prev_x && y > prev_y) {
+            --x;
+            --y;
+            reversed.push_back({EditKind::Equal, a_base + x, b_base + y});
+        }
+        if (down) {
+            reversed.push_back({EditKind::Insert, -1, b_base + prev_y});
+        } else {
+            reversed.push_back({EditKind::Delete, a_base + prev_x, -1});
+        }
+        x = prev_x;
+        y = prev_y;
+    }
+    while (x > 0 && y > 0) {
+        --x;
+        --y;
+        reversed.push_back({EditKind::Equal, a_base + x, b_base + y});
+    }
+
+    edits.insert(edits.end(), reversed.rbegin(), reversed.rend());
+}
+
+std::vector<Edit> diff_sequences(const std::vector<std::uint64_t>& a,
+                                 const std::vector<std::uint64_t>& b) {
+    const int n = static_cast<int>(a.size());
+    const int m = static_cast<int>(b.size());
+
+    // Common prefix and suffix are cheap and usually cover most of the document
+    int prefix = 0;
+    while (prefix < n && prefix < m && a[prefix] == b[prefix]) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < n - prefix && suffix < m - prefix &&
+           a[n - 1 - suffix] == b[m - 1 - suffix]) {
+        ++suffix;
+    }
+
+    std::vector<Edit> edits;
+    edits.reserve(static_cast<std::size_t>(std::max(n, m)));
+    for (int i = 0; i < prefix; ++i) {
+        edits.push_back({EditKind::Equal, i, i});
+    }
+    myers_diff(a.data() + prefix,
+               n - prefix - suffix,
+               b.data() + prefix,
+               m - prefix - suffix,
+               prefix,
+               prefix,
+               edits);
+    for (int i = suffix; i > 0; --i) {
+        edits.push_back({EditKind::Equal, n - i, m - i});
+    }
+    return edits;
+}
+
+// ============================================================================
+// Tokenizer
+// ============================================================================
+
+struct Token {
+    int segment = 0;
+    std::size_t offset = 0;    ///< Offset within the segment text
+    std::size_t length = 0;
+    std::size_t position = 0;  ///< Offset within the paragraph text
+    std::uint64_t hash = 0;
+};
+
+std::size_t utf8_sequence_length(unsigned char lead) {
+    if (lead >= 0xF0) {
+        return 4;
+    }
+    if (lead >= 0xE0) {
+        return 3;
+    }
+    if (lead >= 0xC0) {
+        return 2;
+    }
+    return 1;
+}
+
+bool is_ascii_word_char(unsigned char c) {
+    return c < 0x80 && (std::isalnum(c) != 0 || c == '_');
+}
+
+std::vector<Token> tokenize(const ParagraphInfo& info,
+                            Granularity granularity,
+                            bool ignore_formatting) {
+    std::vector<Token> tokens;
+    std::size_t position = 0;
+
+    for (std::size_t s = 0; s < info.segments.size(); ++s) {
+        const std::string& text = info.segments[s].text;
+        std::size_t i = 0;
+        while (i < text.size()) {
+            const auto c = static_cast<unsigned char>(text[i]);
+            std::size_t length = 0;
+            if (granularity == Granularity::BlockLevel) {
+                length = text.size() - i;
+            } else if (granularity == Granularity::WordLevel && is_ascii_word_char(c)) {
+                while (i + length < text.size() &&
+                       is_ascii_word_char(static_cast<unsigned char>(text[i + length]))) {
+                    ++length;
+                }
+            } else if (granularity == Granularity::WordLevel && c == ' ') {
+                while (i + length < text.size() && text[i + length] == ' ') {
+                    ++length;
+                }
+            } else {
+                // Punctuation, control characters and non-ASCII code points (CJK)
+                length = std::min(utf8_sequence_length(c), text.size() - i);
+            }
+
+            Token token;
+            token.segment = static_cast<int>(s);
+            token.offset = i;
+            token.length = length;
+            token.position = position;
+            token.hash = kFnvOffsetBasis;
+            fnv_mix(token.hash, text.data() + i, length);
+            if (!ignore_formatting) {
+                fnv_mix(token.hash, info.segments[s].format);
+            }
+            tokens.push_back(token);
+
+            i += length;
+            position += length;
+        }
+    }
+    return tokens;
+}
+
+// ============================================================================
+// Comparer
+// ============================================================================
+
+class Comparer {
+  public:
+    Comparer(Document& original, Document& revised, const CompareOptions& options, bool redline)
+        : original_(original), revised_(revised), options_(options), redline_(redline) {
+        const std::time_t date = options.get_date() != 0 ? options.get_date() : std::time(nullptr);
+        date_ = time_to_w3cdtf(date);
+    }
+
+    std::vector<BlockChange> run() {
+        std::vector<BlockChange> changes;
+
+        original_.sync_to_physical_tree();
+        revised_.sync_to_physical_tree();
+        auto* original_xml = original_.get_document_xml();
+        auto* revised_xml = revised_.get_document_xml();
+        if (!original_xml || !revised_xml) {
+            return changes;
+        }
+
+        auto original_body = original_xml->child("w:document").child("w:body");
+        auto revised_body = revised_xml->child("w:document").child("w:body");
+        if (!original_body || !revised_body) {
+            return changes;
+        }
+
+        if (redline_) {
+            next_revision_id_ = find_max_revision_id(original_body) + 1;
+        }
+
+        compare_container(original_body, revised_body, &changes);
+
+        if (redline_ && !changes.empty()) {
+            original_.mark_modified("word/document.xml");
+            original_.sync_from_physical_tree();
+        }
+        return changes;
+    }
+
+  private:
+    static int find_max_revision_id(pugi::xml_node node) {
+        int max_id = 0;
+        for (auto child = node.first_child(); child; child = child.next_sibling()) {
+            if (child.type() != pugi::node_element) {
+                continue;
+            }
+            const char* name = child.name();
+            if (std::strcmp(name, "w:ins") == 0 || std::strcmp(name, "w:del") == 0 ||
+                std::strcmp(name, "w:pPrChange") == 0) {
+                max_id = std::max(max_id, child.attribute("w:id").as_int());
+            }
+            max_id = std::max(max_id, find_max_revision_id(child));
+        }
+        return max_id;
+    }
+
+    // Diff the blocks of two containers (w:body or w:tc). Top-level changes are
+    // recorded when @p changes is given; returns the number of changed blocks.
+    int compare_container(pugi::xml_node original,
+                          pugi::xml_node revised,
+                          std::vector<BlockChange>* changes) {
+        const bool ignore_formatting = options_.get_ignore_formatting();
+        const auto a = collect_blocks(original, ignore_formatting);
+        const auto b = collect_blocks(revised, ignore_formatting);
+
+        std::vector<std::uint64_t> fa;
+        std::vector<std::uint64_t> fb;
+        fa.reserve(a.size());
+        fb.reserve(b.size());
+        for (const auto& block : a) {
+            fa.push_back(block.fingerprint);
+        }
+        for (const auto& block : b) {
+            fb.push_back(block.fingerprint);
+        }
+
+        const auto edits = diff_sequences(fa, fb);
+
+        int changed = 0;
+        anchor_ = pugi::xml_node();
+        container_ = original;
+        first_block_ = a.empty() ? pugi::xml_node() : a.front().node;
+
+        std::size_t i = 0;
+        while (i < edits.size()) {
+            if (edits[i].kind == EditKind::Equal) {
+                anchor_ = a[static_cast<std::size_t>(edits[i].a)].node;
+                ++i;
+                continue;
+            }
+
+            // Collect one hunk of deletions and insertions
+            std::vector<int> deleted;
+            std::vector<int> inserted;
+            for (; i < edits.size() && edits[i].kind != EditKind::Equal; ++i) {
+                if (edits[i].kind == EditKind::Delete) {
+                    deleted.push_back(edits[i].a);
+                } else {
+                    inserted.push_back(edits[i].b);
+                }
+            }
+
+            // Pair deletions with insertions in order; pairs that are similar
+            // enough become modifications, the rest stay deletions/insertions
+            std::size_t p = 0;
+            std::size_t q = 0;
+            while (p < deleted.size() || q < inserted.size()) {
+                if (p < deleted.size() && q < inserted.size()) {
+                    const auto& from = a[static_cast<std::size_t>(deleted[p])];
+                    const auto& to = b[static_cast<std::size_t>(inserted[q])];
+                    if (from.is_table == to.is_table &&
+                        modify_block(from, to, deleted[p], inserted[q], changes)) {
+                        ++p;
+                        ++q;
+                        ++changed;
+                        continue;
+                    }
+                }
+                if (p < deleted.size()) {
+                    delete_block(a[static_cast<std::size_t>(deleted[p])], deleted[p], changes);
+                    ++p;
+                } else {
+                    insert_block(b[static_cast<std::size_t>(inserted[q])], inserted[q], changes);
+                    ++q;
+                }
+                ++changed;
+            }
+        }
+        return changed;
+    }
+
+    void delete_block(const Block& block, int index, std::vector<BlockChange>* changes) {
+        if (changes) {
+            BlockChange change;
+            change.type = ChangeType::Deleted;
+            change.block_type = block.is_table ? NodeType::Table : NodeType::Paragraph;
+            change.original_index = index;
+            change.original_text = block_text(block.node);
+            changes->push_back(std::move(change));
+        }
+        if (redline_) {
+            mark_block(block.node, ChangeType::Deleted);
+        }
+        anchor_ = block.node;
+    }
+
+    void insert_block(const Block& block, int index, std::vector<BlockChange>* changes) {
+        if (changes) {
+            BlockChange change;
+            change.type = ChangeType::Inserted;
+            change.block_type = block.is_table ? NodeType::Table : NodeType::Paragraph;
+            change.revised_index = index;
+            change.revised_text = block_text(block.node);
+            changes->push_back(std::move(change));
+        }
+        if (redline_) {
+            anchor_ = insert_copy(block.node);
+        }
+    }
+
+    bool modify_block(const Block& from,
+                      const Block& to,
+                      int original_index,
+                      int revised_index,
+                      std::vector<BlockChange>* changes) {
+        BlockChange change;
+        change.type = ChangeType::Modified;
+        change.original_index = original_index;
+        change.revised_index = revised_index;
+
+        if (from.is_table) {
+            change.block_type = NodeType::Table;
+            if (!modify_table(from.node, to.node)) {
+                return false;
+            }
+            anchor_ = from.node;
+            change.original_text = block_text(from.node);
+            change.revised_text = block_text(to.node);
+        } else if (!modify_paragraph(from.node, to.node, change)) {
+            return false;
+        }
+
+        if (changes) {
+            changes->push_back(std::move(change));
+        }
+        return true;
+    }
+
+    // Tables with the same row/cell layout are compared cell by cell
+    bool modify_table(pugi::xml_node from, pugi::xml_node to) {
+        std::vector<std::pair<pugi::xml_node, pugi::xml_node>> cells;
+        auto row_b = to.child("w:tr");
+        for (auto row_a = from.child("w:tr"); row_a; row_a = row_a.next_sibling("w:tr")) {
+            if (!row_b) {
+                return false;
+            }
+            auto cell_b = row_b.child("w:tc");
+            for (auto cell_a = row_a.child("w:tc"); cell_a; cell_a = cell_a.next_sibling("w:tc")) {
+                if (!cell_b) {
+                    return false;
+                }
+                cells.emplace_back(cell_a, cell_b);
+                cell_b = cell_b.next_sibling("w:tc");
+            }
+            if (cell_b) {
+                return false;
+            }
+            row_b = row_b.next_sibling("w:tr");
+        }
+        if (row_b) {
+            return false;
+        }
+
+        if (redline_) {
+            // Cell containers reuse the anchor state; restore it for the body
+            const auto saved_anchor = anchor_;
+            const auto saved_container = container_;
+            const auto saved_first = first_block_;
+            for (const auto& cell : cells) {
+                compare_container(cell.first, cell.second, nullptr);
+            }
+            anchor_ = saved_anchor;
+            container_ = saved_container;
+            first_block_ = saved_first;
+        }
+        return true;
+    }
+
+    bool modify_paragraph(pugi::xml_node from, pugi::xml_node to, BlockChange& change) {
+        change.block_type = NodeType::Paragraph;
+        const ParagraphInfo info_a = collect_paragraph(from);
+        const ParagraphInfo info_b = collect_paragraph(to);
+        change.original_text = paragraph_text(info_a);
+        change.revised_text = paragraph_text(info_b);
+
+        const bool ignore_formatting = options_.get_ignore_formatting();
+        const auto tokens_a = tokenize(info_a, options_.get_granularity(), ignore_formatting);
+        const auto tokens_b = tokenize(info_b, options_.get_granularity(), ignore_formatting);
+
+        std::vector<std::uint64_t> ha;
+        std::vector<std::uint64_t> hb;
+        ha.reserve(tokens_a.size());
+        hb.reserve(tokens_b.size());
+        for (const auto& token : tokens_a) {
+            ha.push_back(token.hash);
+        }
+        for (const auto& token : tokens_b) {
+            hb.push_back(token.hash);
+        }
+        const auto edits = diff_sequences(ha, hb);
+
+        // Similarity gate on shared text
+        const bool same_text = change.original_text == change.revised_text;
+        if (!same_text) {
+            std::size_t shared = 0;
+            for (const auto& edit : edits) {
+                if (edit.kind == EditKind::Equal) {
+                    shared += tokens_a[static_cast<std::size_t>(edit.a)].length;
+                }
+            }
+            const std::size_t longest =
+                std::max(change.original_text.size(), change.revised_text.size());
+            if (shared * kMinSimilarityDivisor < longest) {
+                return false;
+            }
+        }
+        change.formatting_changed = same_text;
+
+        // Inline change list: consecutive edits of one kind form one change
+        for (const auto& edit : edits) {
+            if (edit.kind == EditKind::Equal) {
+                continue;
+            }
+            const bool deletion = edit.kind == EditKind::Delete;
+            const auto& token = deletion ? tokens_a[static_cast<std::size_t>(edit.a)]
+                                         : tokens_b[static_cast<std::size_t>(edit.b)];
+            const auto& source = deletion ? info_a : info_b;
+            const std::string piece = source.segments[static_cast<std::size_t>(token.segment)]
+                                          .text.substr(token.offset, token.length);
+            const ChangeType type = deletion ? ChangeType::Deleted : ChangeType::Inserted;
+
+            auto& inline_changes = change.inline_changes;
+            if (!inline_changes.empty() && inline_changes.back().type == type &&
+                inline_changes.back().offset + inline_changes.back().text.size() ==
+                    token.position) {
+                inline_changes.back().text += piece;
+            } else {
+                inline_changes.push_back({type, token.position, piece});
+            }
+        }
+
+        anchor_ = from;
+        if (redline_) {
+            if (info_a.simple && info_b.simple) {
+                if (!ignore_formatting &&
+                    hash_paragraph_properties(from) != hash_paragraph_properties(to)) {
+                    replace_paragraph_properties(from, to);
+                }
+                rewrite_runs(from, info_a, info_b, tokens_a, tokens_b, edits);
+            } else {
+                // Runs with drawings/fields cannot be split safely: replace the paragraph
+                mark_block(from, ChangeType::Deleted);
+                anchor_ = insert_copy(to);
+            }
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    // Redline writers
+    // ------------------------------------------------------------------------
+
+    void set_revision_attributes(pugi::xml_node node) {
+        node.append_attribute("w:id").set_value(next_revision_id_++);
+        node.append_attribute("w:author").set_value(options_.get_author().c_str());
+        node.append_attribute("w:date").set_value(date_.c_str());
+    }
+
+    static const char* revision_element(ChangeType type) {
+        return type == ChangeType::Deleted ? "w:del" : "w:ins";
+    }
+
+    void mark_run(pugi::xml_node run, ChangeType type) {
+        auto wrapper = run.parent().insert_child_before(revision_element(type), run);
+        set_revision_attributes(wrapper);
+        wrapper.append_move(run);
+
+        if (type == ChangeType::Deleted) {
+            for (auto child = run.first_child(); child; child = child.next_sibling()) {
+                if (std::strcmp(child.name(), "w:t") == 0) {
+                    child.set_name("w:delText");
+                } else if (std::strcmp(child.name(), "w:instrText") == 0) {
+                    child.set_name("w:delInstrText");
+                }
+            }
+        }
+    }
+
+    void mark_paragraph(pugi::xml_node para, ChangeType type) {
+        std::vector<pugi::xml_node> runs;
+        for (auto run = para.child("w:r"); run; run = run.next_sibling("w:r")) {
+            runs.push_back(run);
+        }
+        for (const auto& run : runs) {
+            mark_run(run, type);
+        }
+
+        // Paragraph mark revision: w:pPr/w:rPr/w:ins|w:del (first in w:rPr)
+        auto p_pr = para.child("w:pPr");
+        if (!p_pr) {
+            p_pr = para.prepend_child("w:pPr");
+        }
+        auto r_pr = p_pr.child("w:rPr");
+        if (!r_pr) {
+            auto before = p_pr.child("w:sectPr");
+            if (!before) {
+                before = p_pr.child("w:pPrChange");
+            }
+            r_pr = before ? p_pr.insert_child_before("w:rPr", before) : p_pr.append_child("w:rPr");
+        }
+        set_revision_attributes(r_pr.prepend_child(revision_element(type)));
+    }
+
+    void mark_block(pugi::xml_node block, ChangeType type) {
+        if (is_para_node(block.name())) {
+            mark_paragraph(block, type);
+            return;
+        }
+        for (auto row = block.child("w:tr"); row; row = row.next_sibling("w:tr")) {
+            for (auto cell = row.child("w:tc"); cell; cell = cell.next_sibling("w:tc")) {
+                for (auto child = cell.first_child(); child; child = child.next_sibling()) {
+                    if (is_para_node(child.name()) || is_table_node(child.name())) {
+                        mark_block(child, type);
+                    }
+                }
+            }
+        }
+    }
+
+    // Copy a revised block into the original after the current anchor
+    pugi::xml_node insert_copy(pugi::xml_node block) {
+        pugi::xml_node copy;
+        if (anchor_) {
+            copy = container_.insert_copy_after(block, anchor_);
+        } else if (first_block_) {
+            copy = container_.insert_copy_before(block, first_block_);
+        } else if (auto sect_pr = container_.child("w:sectPr")) {
+            copy = container_.insert_copy_before(block, sect_pr);
+        } else {
+            copy = container_.append_copy(block);
+        }
+
+        // Section breaks are not compared; keep the original's section layout
+        strip_section_breaks(copy);
+        remap_relationships(copy);
+        mark_block(copy, ChangeType::Inserted);
+        return copy;
+    }
+
+    static void strip_section_breaks(pugi::xml_node block) {
+        if (auto p_pr = block.child("w:pPr")) {
+            p_pr.remove_child("w:sectPr");
+        }
+    }
+
+    // Images and hyperlinks copied from the revised document need relationships
+    // (and media) in the original package
+    void remap_relationships(pugi::xml_node node) {
+        for (auto attr = node.first_attribute(); attr; attr = attr.next_attribute()) {
+            const char* name = attr.name();
+            if (std::strcmp(name, "r:embed") == 0 || std::strcmp(name, "r:id") == 0) {
+                const std::string mapped =
+                    map_relationship(attr.value(), std::strcmp(node.name(), "w:hyperlink") == 0);
+                if (!mapped.empty()) {
+                    attr.set_value(mapped.c_str());
+                }
+            }
+        }
+        for (auto child = node.first_child(); child; child = child.next_sibling()) {
+            if (child.type() == pugi::node_element) {
+                remap_relationships(child);
+            }
+        }
+    }
+
+    std::string map_relationship(const std::string& rel_id, bool hyperlink) {
+        auto it = relationship_map_.find(rel_id);
+        if (it != relationship_map_.end()) {
+            return it->second;
+        }
+
+        std::string mapped;
+        const std::string target = revised_.get_relationship_target(kDocumentRels, rel_id);
+        if (target.empty()) {
+            return mapped;
+        }
+
+        if (hyperlink) {
+            mapped = original_.find_relationship_id(kDocumentRels, target);
+            if (mapped.empty()) {
+                mapped = original_.add_relationship(kDocumentRels, kHyperlinkRelType, target,
+                                                    "External");
+            }
+        } else if (target.compare(0, 6, "media/") == 0) {
+            const std::string name = target.substr(6);
+            const auto data = revised_.get_media_data(name);
+            if (!data.empty()) {
+                if (original_.has_media(name) && original_.get_media_data(name) == data) {
+                    mapped = original_.find_relationship_id(kDocumentRels, target);
+                }
+                if (mapped.empty()) {
+                    std::string unique_name = name;
+                    for (int n = 1; original_.has_media(unique_name); ++n) {
+                        unique_name = "compare" + std::to_string(n) + "_" + name;
+                    }
+                    mapped = original_.add_media_from_memory_with_rel(unique_name, data);
+                }
+            }
+        }
+
+        relationship_map_[rel_id] = mapped;
+        return mapped;
+    }
+
+    // New w:pPr from the revised paragraph; the old properties go to w:pPrChange
+    void replace_paragraph_properties(pugi::xml_node from, pugi::xml_node to) {
+        auto old_p_pr = from.child("w:pPr");
+        auto new_p_pr =
+            old_p_pr ? from.insert_child_before("w:pPr", old_p_pr) : from.prepend_child("w:pPr");
+
+        for (auto child = to.child("w:pPr").first_child(); child; child = child.next_sibling()) {
+            if (child.type() == pugi::node_element && !is_excluded_p_pr_child(child.name())) {
+                new_p_pr.append_copy(child);
+            }
+        }
+        if (old_p_pr.child("w:rPr")) {
+            new_p_pr.append_copy(old_p_pr.child("w:rPr"));
+        }
+        if (old_p_pr.child("w:sectPr")) {
+            new_p_pr.append_copy(old_p_pr.child("w:sectPr"));
+        }
+
+        auto change = new_p_pr.append_child("w:pPrChange");
+        set_revision_attributes(change);
+        auto previous = change.append_child("w:pPr");
+        for (auto child = old_p_pr.first_child(); child; child = child.next_sibling()) {
+            if (child.type() == pugi::node_element && !is_excluded_p_pr_child(child.name())) {
+                previous.append_copy(child);
+            }
+        }
+
+        if (old_p_pr) {
+            from.remove_child(old_p_pr);
+        }
+    }
+
+    static void append_run_text(pugi::xml_node run, const std::string& text, bool deleted) {
+        std::size_t start = 0;
+        while (start < text.size()) {
+            const std::size_t stop = text.find_first_of("\t\n", start);
+            const std::size_t end = stop == std::string::npos ? text.size() : stop;
+            if (end > start) {
+                const std::string chunk = text.substr(start, end - start);
+                auto t = run.append_child(deleted ? "w:delText" : "w:t");
+                if (std::isspace(static_cast<unsigned char>(chunk.front())) ||
+                    std::isspace(static_cast<unsigned char>(chunk.back()))) {
+                    t.append_attribute("xml:space").set_value("preserve");
+                }
+                t.text().set(chunk.c_str());
+            }
+            if (stop == std::string::npos) {
+                break;
+            }
+            run.append_child(text[stop] == '\t' ? "w:tab" : "w:br");
+            start = stop + 1;
+        }
+    }
+
+    void emit_run(pugi::xml_node para,
+                  pugi::xml_node before,
+                  pugi::xml_node r_pr,
+                  const std::string& text,
+                  EditKind kind) {
+        if (text.empty()) {
+            return;
+        }
+        pugi::xml_node parent = para;
+        if (kind != EditKind::Equal) {
+            const ChangeType type =
+                kind == EditKind::Delete ? ChangeType::Deleted : ChangeType::Inserted;
+            parent = before ? para.insert_child_before(revision_element(type), before)
+                            : para.append_child(revision_element(type));
+            set_revision_attributes(parent);
+        }
+        pugi::xml_node run;
+        if (parent != para) {
+            run = parent.append_child("w:r");
+        } else {
+            run = before ? para.insert_child_before("w:r", before) : para.append_child("w:r");
+        }
+        if (r_pr) {
+            run.append_copy(r_pr);
+        }
+        append_run_text(run, text, kind == EditKind::Delete);
+    }
+
+    // Replace the runs of a simple paragraph with equal, deleted and inserted
+    // runs; consecutive tokens of one kind from one source run are merged
+    void rewrite_runs(pugi::xml_node para,
+                      const ParagraphInfo& info_a,
+                      const ParagraphInfo& info_b,
+                      const std::vector<Token>& tokens_a,
+                      const std::vector<Token>& tokens_b,
+                      const std::vector<Edit>& edits) {
+        // New runs go where the first original run was (or at the end)
+        const pugi::xml_node before =
+            info_a.segments.empty() ? pugi::xml_node() : info_a.segments.front().run;
+
+        EditKind group_kind = EditKind::Equal;
+        int group_segment = -1;
+        const ParagraphInfo* group_source = nullptr;
+        std::string group_text;
+
+        auto flush = [&]() {
+            if (group_source && group_segment >= 0) {
+                const auto& segment =
+                    group_source->segments[static_cast<std::size_t>(group_segment)];
+                emit_run(para, before, segment.run.child("w:rPr"), group_text, group_kind);
+            }
+            group_text.clear();
+            group_segment = -1;
+            group_source = nullptr;
+        };
+
+        for (const auto& edit : edits) {
+            // Equal and inserted text take the revised run formatting
+            const bool from_original = edit.kind == EditKind::Delete;
+            const auto& token = from_original ? tokens_a[static_cast<std::size_t>(edit.a)]
+                                              : tokens_b[static_cast<std::size_t>(edit.b)];
+            const ParagraphInfo* source = from_original ? &info_a : &info_b;
+            if (edit.kind != group_kind || token.segment != group_segment ||
+                source != group_source) {
+                flush();
+                group_kind = edit.kind;
+                group_segment = token.segment;
+                group_source = source;
+            }
+            group_text.append(
+                source->segments[static_cast<std::size_t>(token.segment)].text, token.offset,
+                token.length);
+        }
+        flush();
+
+        for (const auto& segment : info_a.segments) {
+            para.remove_child(segment.run);
+        }
+    }
+
+    Document& original_;
+    Document& revised_;
+    const CompareOptions& options_;
+    bool redline_ = false;
+    std::string date_;
+    int next_revision_id_ = 1;
+
+    // Insertion point state of the container being compared
+    pugi::xml_node container_;
+    pugi::xml_node anchor_;
+    pugi::xml_node first_block_;
+
+    std::map<std::string, std::string> relationship_map_;
+};
+
+}  // anonymous namespace
+
+// ============================================================================
+// DocumentComparer Implementation
+// ============================================================================
+
+std::vector<BlockChange> DocumentComparer::compare(Document& original,
+                                                   Document& revised,
+                                                   const CompareOptions& options) {
+    return Comparer(original, revised, options, false).run();
+}
+
+std::vector<BlockChange> DocumentComparer::apply_redline(Document& original,
+                                                         Document& revised,
+                                                         const CompareOptions& options) {
+    return Comparer(original, revised, options, true).run();
+}
+
+int Document::compare(Document& revised) {
+    return compare(revised, CompareOptions());
+}
+
+int Document::compare(Document& revised, const CompareOptions& options) {
+    return static_cast<int>(DocumentComparer::apply_redline(*this, revised, options).size());
+}
+
+}  // namespace cdocx
@@ -0,0 +1,95 @@
+/**
+ * @file document_encryption.cpp
+ * @brief Opening and saving encrypted packages for Document class
+ */
+
+#include <cdocx/document.h>
+
+#include <filesystem>
+#include <vector>
+
+#include "agile_encryption.h"
+#include "compound_file.h"
+#include "mapped_file.h"
+
+namespace cdocx {
+
+bool Document::open_encrypted_zip(const std::string& path, LoadError& error) {
+    MappedFile file(path);
+    CompoundFileReader reader;
+    if (!file.is_open() || !reader.open(file.data()) || !reader.has_stream("EncryptedPackage")) {
+        return false;
+    }
+    if (load_config_.password.empty()) {
+        error = LoadError(LoadErrorType::PasswordRequired, path, "Document is password-protected");
+        return false;
+    }
+
+    const EncryptionStatus status = decrypt_package(
+        reader, load_config_.password, load_config_.max_threads, decrypted_package_);
+    switch (status) {
+        case EncryptionStatus::Ok:
+            break;
+        case EncryptionStatus::InvalidPassword:
+            error = LoadError(LoadErrorType::InvalidPassword, path, "Invalid password");
+            break;
+        case EncryptionStatus::Unavailable:
+        case EncryptionStatus::Unsupported:
+            error = LoadError(
+                LoadErrorType::UnsupportedEncryption, path, "Unsupported encryption method");
+            break;
+        default:
+            error = LoadError(LoadErrorType::CorruptedFile, path, "Failed to decrypt package");
+            break;
+    }
+
+    // The bundled library reads the decrypted package in place until close_zip()
+    if (status == EncryptionStatus::Ok) {
+        zip_handle_ = zip_stream_open(reinterpret_cast<const char*>(decrypted_package_.data()),
+                                      decrypted_package_.size(),
+                                      0,
+                                      'r');
+        if (zip_handle_) {
+            return true;
+        }
+        error = LoadError(LoadErrorType::ZipOpenFailed, path, "Failed to open decrypted package");
+    }
+    decrypted_package_.clear();
+    decrypted_package_.shrink_to_fit();
+    return false;
+}
+
+bool Document::save_encrypted(const std::string& output_path, const CancellationToken* token) {
+    // The plain package is built in memory so it never reaches the disk
+    std::vector<uint8_t> package;
+    if (!save_to_buffer(package, token) || (token && token->is_cancelled())) {
+        return false;
+    }
+
+    const std::string write_path = token ? output_path + ".part" : output_path;
+    EncryptionStatus status = encrypt_package(package.data(),
+                                              package.size(),
+                                              load_config_.password,
+                                              load_config_.max_threads,
+                                              write_path);
+    std::error_code ec;
+
+    if (status == EncryptionStatus::Ok && token) {
+        std::filesystem::rename(write_path, output_path, ec);
+        if (ec) {
+            status = EncryptionStatus::IoError;
+        }
+    }
+    if (status != EncryptionStatus::Ok) {
+        if (token) {
+            std::filesystem::remove(write_path, ec);
+        }
+        return false;
+    }
+
+    const auto package_bytes = std::filesystem::file_size(output_path, ec);
+    last_save_stats_.package_bytes = ec ? 0 : static_cast<uint64_t>(package_bytes);
+    return true;
+}
+
+}  // namespace cdocx
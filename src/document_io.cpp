@@ -9,11 +9,16 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
 #include <thread>
 #include <vector>
 
+#include "zip_archive.h"
+
 extern "C" {
 #include <zip.h>
 }
@@ -29,25 +34,227 @@ bool string_ends_with(const std::string& str, const std::string& suffix) {
     return std::equal(suffix.rbegin(), suffix.rend(), str.rbegin());
 }
 
+// ============================================================================
+// Bounded Entry Inflation
+// ============================================================================
+
+// Output allowed before LoadConfig::max_compression_ratio applies, so small
+// but highly repetitive parts (empty headers, settings) are never rejected
+constexpr uint64_t kRatioGraceBytes = 1024 * 1024;
+
+constexpr const char* kLimitExceededMessage = "Uncompressed size exceeds the configured limit";
+
+// Deflate levels for saving; level 6 of the non-bundled backends compresses
+// XML parts about as well as level 9 of the bundled one, several times faster
+constexpr int kBundledDeflateLevel = 9;
+constexpr int kArchiveDeflateLevel = 6;
+
+using CodecClock = std::chrono::steady_clock;
+
+double elapsed_ms(CodecClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(CodecClock::now() - start).count();
+}
+
+// Inflate throughput, shared by the loader threads
+struct InflateMeter {
+    std::atomic<uint64_t> compressed_bytes{0};
+    std::atomic<uint64_t> uncompressed_bytes{0};
+    std::atomic<uint64_t> nanoseconds{0};
+
+    void add(uint64_t compressed, uint64_t uncompressed, CodecClock::time_point start) {
+        compressed_bytes += compressed;
+        uncompressed_bytes += uncompressed;
+        nanoseconds += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(CodecClock::now() - start)
+                .count());
+    }
+
+    void store(LoadStatistics& stats) const {
+        stats.compressed_bytes = compressed_bytes.load();
+        stats.uncompressed_bytes = uncompressed_bytes.load();
+        stats.inflate_ms = static_cast<double>(nanoseconds.load()) / 1e6;
+    }
+};
+
+void record_deflate(SaveStatistics& stats, size_t size, CodecClock::time_point start) {
+    stats.entries++;
+    stats.uncompressed_bytes += size;
+    stats.deflate_ms += elapsed_ms(start);
+}
+
+enum class EntryReadStatus : std::uint8_t {
+    Ok,
+    ReadFailed,
+    LimitExceeded,
+    Cancelled
+};
+
+struct InflateSink {
+    std::vector<uint8_t>* data;
+    uint64_t entry_limit;  // 0 = no limit
+    const LoadConfig* config;
+    std::atomic<uint64_t>* inflated_total;
+    EntryReadStatus status;
+};
+
+// zip_entry_extract() callback; returning less than @p size aborts inflation
+size_t append_inflated(void* arg, uint64_t offset, const void* chunk, size_t size) {
+    auto* sink = static_cast<InflateSink*>(arg);
+    if (sink->config->cancellation_token.is_cancelled()) {
+        sink->status = EntryReadStatus::Cancelled;
+        return 0;
+    }
+    if (sink->entry_limit > 0 && offset + size > sink->entry_limit) {
+        sink->status = EntryReadStatus::LimitExceeded;
+        return 0;
+    }
+    const uint64_t total = sink->inflated_total->fetch_add(size) + size;
+    if (sink->config->max_total_size > 0 && total > sink->config->max_total_size) {
+        sink->status = EntryReadStatus::LimitExceeded;
+        return 0;
+    }
+
+    const auto* bytes = static_cast<const uint8_t*>(chunk);
+    sink->data->insert(sink->data->end(), bytes, bytes + size);
+    return size;
+}
+
+// Uncompressed bytes allowed for an entry of @p compressed_size (0 = no limit)
+uint64_t entry_size_limit(const LoadConfig& config, uint64_t compressed_size) {
+    uint64_t limit = config.max_entry_size;
+    if (config.max_compression_ratio > 0) {
+        const double ratio_bytes =
+            static_cast<double>(compressed_size) * config.max_compression_ratio;
+        const uint64_t ratio_limit =
+            std::max(kRatioGraceBytes, static_cast<uint64_t>(std::min(ratio_bytes, 1e18)));
+        limit = limit == 0 ? ratio_limit : std::min(limit, ratio_limit);
+    }
+    return limit;
+}
+
+// Reads the entry currently open on @p zip into @p data. The size limits are
+// enforced while inflating, since the sizes declared in the archive can lie.
+EntryReadStatus read_entry_limited(zip_t* zip,
+                                   const LoadConfig& config,
+                                   std::atomic<uint64_t>& inflated_total,
+                                   InflateMeter& meter,
+                                   std::vector<uint8_t>& data) {
+    const uint64_t compressed_size = zip_entry_comp_size(zip);
+    const uint64_t limit = entry_size_limit(config, compressed_size);
+
+    const uint64_t declared_size = zip_entry_uncomp_size(zip);
+    if (limit > 0 && declared_size > limit) {
+        return EntryReadStatus::LimitExceeded;
+    }
+
+    data.clear();
+    if (limit > 0) {
+        data.reserve(static_cast<size_t>(declared_size));
+    }
+
+    const auto start = CodecClock::now();
+    InflateSink sink{&data, limit, &config, &inflated_total, EntryReadStatus::Ok};
+    if (zip_entry_extract(zip, append_inflated, &sink) < 0 &&
+        sink.status == EntryReadStatus::Ok) {
+        return EntryReadStatus::ReadFailed;
+    }
+    meter.add(compressed_size, data.size(), start);
+    return sink.status;
+}
+
+// Reads entry @p index of a directly read archive into @p data. The entry is
+// inflated into a buffer of exactly its declared size and fails on longer
+// data, so the limits can be checked against the declared size up front.
+EntryReadStatus read_archive_entry_limited(const ZipArchiveReader& reader,
+                                           size_t index,
+                                           DeflateCodec& codec,
+                                           const LoadConfig& config,
+                                           std::atomic<uint64_t>& inflated_total,
+                                           InflateMeter& meter,
+                                           std::vector<uint8_t>& data) {
+    const ZipEntryInfo& info = reader.entry(index);
+    const uint64_t limit = entry_size_limit(config, info.compressed_size);
+    if (limit > 0 && info.uncompressed_size > limit) {
+        return EntryReadStatus::LimitExceeded;
+    }
+    const uint64_t size = info.uncompressed_size;
+    if (config.max_total_size > 0 &&
+        inflated_total.fetch_add(size) + size > config.max_total_size) {
+        return EntryReadStatus::LimitExceeded;
+    }
+    if (config.cancellation_token.is_cancelled()) {
+        return EntryReadStatus::Cancelled;
+    }
+
+    const auto start = CodecClock::now();
+    if (reader.read(index, codec, data) != ZipEntryStatus::Ok) {
+        return EntryReadStatus::ReadFailed;
+    }
+    meter.add(info.compressed_size, data.size(), start);
+    return EntryReadStatus::Ok;
+}
+
+bool max_errors_reached(const LoadConfig& config, const LoadResult& result) {
+    return config.max_errors > 0 && result.errors.size() >= config.max_errors;
+}
+
+// Bytes deflated between two cancellation checks while saving
+constexpr size_t kSaveChunkSize = 1024 * 1024;
+
+// Streams @p size bytes into the open entry; false if @p token was cancelled
+bool write_entry_chunked(zip_t* zip,
+                         const uint8_t* data,
+                         size_t size,
+                         const CancellationToken* token) {
+    if (!token) {
+        zip_entry_write(zip, data, size);
+        return true;
+    }
+    for (size_t offset = 0; offset < size; offset += kSaveChunkSize) {
+        if (token->is_cancelled()) {
+            return false;
+        }
+        zip_entry_write(zip, data + offset, std::min(kSaveChunkSize, size - offset));
+    }
+    return true;
+}
+
 }  // namespace
 
 // Internal ZIP Operations
 // ============================================================================
 
 bool Document::open_zip(const std::string& path) {
+    // Archives the direct reader cannot parse fall back to the bundled library
+    const CompressionBackend backend = load_config_.compression_backend;
+    if (backend != CompressionBackend::Bundled && is_compression_backend_available(backend)) {
+        auto reader = std::make_unique<ZipArchiveReader>();
+        if (reader->open(path)) {
+            archive_reader_ = std::move(reader);
+            return true;
+        }
+    }
+
     zip_handle_ = zip_open(path.c_str(), 0, 'r');
     return zip_handle_ != nullptr;
 }
 
 void Document::close_zip() {
     if (zip_handle_) {
-        zip_close(zip_handle_);
+        if (decrypted_package_.empty()) {
+            zip_close(zip_handle_);
+        } else {
+            zip_stream_close(zip_handle_);
+        }
         zip_handle_ = nullptr;
     }
+    archive_reader_.reset();
+    decrypted_package_.clear();
+    decrypted_package_.shrink_to_fit();
 }
 
 bool Document::ensure_zip_handle() {
-    if (!zip_handle_ || zip_dirty_) {
+    if ((!zip_handle_ && !archive_reader_) || zip_dirty_) {
         close_zip();
         if (!filepath_.empty()) {
             return open_zip(filepath_);
@@ -59,6 +266,16 @@ bool Document::ensure_zip_handle() {
 
 std::vector<uint8_t> Document::read_zip_entry(const std::string& entry_name) {
     std::vector<uint8_t> data;
+    if (archive_reader_) {
+        const int index = archive_reader_->find(entry_name);
+        auto codec = make_deflate_codec(load_config_.compression_backend);
+        if (index < 0 || !codec ||
+            archive_reader_->read(static_cast<size_t>(index), *codec, data) !=
+                ZipEntryStatus::Ok) {
+            data.clear();
+        }
+        return data;
+    }
     if (!zip_handle_) {
         return data;
     }
@@ -158,9 +375,13 @@ bool Document::load_tree_from_zip() {
 
 LoadResult Document::load_tree_with_result() {
     LoadResult result;
+    last_load_stats_ = LoadStatistics();
     last_load_stats_.start_time = std::chrono::high_resolution_clock::now();
+    if (archive_reader_) {
+        last_load_stats_.compression_backend = load_config_.compression_backend;
+    }
 
-    if (!zip_handle_) {
+    if (!zip_handle_ && !archive_reader_) {
         result.success = false;
         result.errors.emplace_back(LoadErrorType::ZipOpenFailed, filepath_, "ZIP handle is null");
         result.integrity = DocumentIntegrity::Corrupted;
@@ -168,7 +389,8 @@ LoadResult Document::load_tree_with_result() {
         return result;
     }
 
-    const int n = zip_entries_total(zip_handle_);
+    const int n = archive_reader_ ? static_cast<int>(archive_reader_->size())
+                                  : zip_entries_total(zip_handle_);
     if (n < 0) {
         result.success = false;
         result.errors.emplace_back(
@@ -183,13 +405,25 @@ LoadResult Document::load_tree_with_result() {
 
     tree_.clear();
 
+    if (check_load_cancelled(result)) {
+        return result;
+    }
+
     // Use parallel loading when enabled and threshold is met
     const bool use_parallel = load_config_.enable_parallel_loading &&
                               static_cast<size_t>(n) >= load_config_.parallel_threshold &&
                               std::thread::hardware_concurrency() > 1;
 
     if (use_parallel) {
-        const bool parallel_ok = load_tree_parallel(last_load_stats_);
+        bool aborted = false;
+        const bool parallel_ok = load_tree_parallel(last_load_stats_, result, aborted);
+        if (check_load_cancelled(result)) {
+            return result;
+        }
+        if (aborted) {
+            abort_load(result);
+            return result;
+        }
         if (parallel_ok) {
             last_load_stats_.end_time = std::chrono::high_resolution_clock::now();
             result.success = last_load_stats_.xml_files > 0;
@@ -209,44 +443,100 @@ LoadResult Document::load_tree_with_result() {
         }
         // Fall back to sequential on failure
         tree_.clear();
+        result.errors.clear();
+        result.skipped_files.clear();
     }
 
-    for (int i = 0; i < n; i++) {
-        if (zip_entry_openbyindex(zip_handle_, i) != 0) {
-            result.errors.emplace_back(
-                LoadErrorType::ZipEntryReadFailed, "", "Failed to open entry " + std::to_string(i));
-            continue;
+    // Records a damaged entry; false once loading has to stop
+    auto record_error = [this, &result](LoadErrorType type,
+                                        const std::string& entry_name,
+                                        const char* message,
+                                        bool skipped) {
+        result.errors.emplace_back(type, entry_name, message);
+        if (skipped) {
+            result.skipped_files.push_back(entry_name);
         }
+        return load_config_.skip_corrupted_files && !max_errors_reached(load_config_, result);
+    };
 
-        const char* name = zip_entry_name(zip_handle_);
-        if (!name) {
-            zip_entry_close(zip_handle_);
-            continue;
+    std::atomic<uint64_t> inflated_total{0};
+    InflateMeter meter;
+    bool aborted = false;
+    std::vector<uint8_t> data;
+    const std::unique_ptr<DeflateCodec> codec =
+        archive_reader_ ? make_deflate_codec(load_config_.compression_backend) : nullptr;
+
+    for (int i = 0; i < n && !aborted; i++) {
+        if (check_load_cancelled(result)) {
+            return result;
         }
 
-        const std::string entry_name(name);
+        std::string entry_name;
+        EntryReadStatus status = EntryReadStatus::Ok;
 
-        if (zip_entry_isdir(zip_handle_)) {
-            zip_entry_close(zip_handle_);
-            continue;
-        }
+        if (archive_reader_) {
+            const ZipEntryInfo& info = archive_reader_->entry(static_cast<size_t>(i));
+            if (info.is_directory) {
+                continue;
+            }
+            entry_name = info.name;
+            status = read_archive_entry_limited(*archive_reader_,
+                                                static_cast<size_t>(i),
+                                                *codec,
+                                                load_config_,
+                                                inflated_total,
+                                                meter,
+                                                data);
+        } else {
+            if (zip_entry_openbyindex(zip_handle_, i) != 0) {
+                aborted = !record_error(LoadErrorType::ZipEntryReadFailed,
+                                        "",
+                                        ("Failed to open entry " + std::to_string(i)).c_str(),
+                                        false);
+                continue;
+            }
 
-        // Read entry data
-        void* buf = nullptr;
-        size_t bufsize = 0;
+            const char* name = zip_entry_name(zip_handle_);
+            if (!name) {
+                zip_entry_close(zip_handle_);
+                continue;
+            }
 
-        if (zip_entry_read(zip_handle_, &buf, &bufsize) < 0) {
-            result.errors.emplace_back(
-                LoadErrorType::ZipEntryReadFailed, entry_name, "Failed to read entry");
+            entry_name = name;
+
+            if (zip_entry_isdir(zip_handle_)) {
+                zip_entry_close(zip_handle_);
+                continue;
+            }
+
+            // Read entry data
+            status = read_entry_limited(zip_handle_, load_config_, inflated_total, meter, data);
             zip_entry_close(zip_handle_);
-            continue;
         }
 
-        std::vector<uint8_t> data(static_cast<uint8_t*>(buf), static_cast<uint8_t*>(buf) + bufsize);
-        free(buf);
+        if (status == EntryReadStatus::Cancelled) {
+            check_load_cancelled(result);
+            return result;
+        }
+        if (status == EntryReadStatus::LimitExceeded) {
+            // A part left out would silently vanish on the next save, so a limit fails the load
+            record_error(LoadErrorType::LimitExceeded, entry_name, kLimitExceededMessage, false);
+            aborted = true;
+            continue;
+        }
+        if (status != EntryReadStatus::Ok) {
+            aborted = !record_error(
+                LoadErrorType::ZipEntryReadFailed, entry_name, "Failed to read entry", true);
+            continue;
+        }
 
         // Add to tree
         auto node = tree_.add_zip_entry(entry_name, data);
+        if (!node) {
+            aborted = !record_error(
+                LoadErrorType::XmlParseFailed, entry_name, "Failed to parse XML", false);
+            continue;
+        }
 
         // Parse XML files
         if (string_ends_with(entry_name, ".xml") || string_ends_with(entry_name, ".rels")) {
@@ -261,8 +551,8 @@ LoadResult Document::load_tree_with_result() {
             if (parse_result) {
                 last_load_stats_.xml_files++;
             } else {
-                result.errors.emplace_back(
-                    LoadErrorType::XmlParseFailed, entry_name, "Failed to parse XML");
+                aborted = !record_error(
+                    LoadErrorType::XmlParseFailed, entry_name, "Failed to parse XML", false);
                 node->type = DocxNodeType::BinaryFile;
                 node->xml_doc.reset();
             }
@@ -281,8 +571,13 @@ LoadResult Document::load_tree_with_result() {
             const int percent = ((i + 1) * 100 / n);
             load_config_.progress_callback(percent, entry_name);
         }
+    }
 
-        zip_entry_close(zip_handle_);
+    meter.store(last_load_stats_);
+
+    if (aborted) {
+        abort_load(result);
+        return result;
     }
 
     last_load_stats_.end_time = std::chrono::high_resolution_clock::now();
@@ -304,12 +599,13 @@ LoadResult Document::load_tree_with_result() {
     return result;
 }
 
-bool Document::load_tree_parallel(LoadStatistics& stats) {
-    if (!zip_handle_) {
+bool Document::load_tree_parallel(LoadStatistics& stats, LoadResult& result, bool& aborted) {
+    if (!zip_handle_ && !archive_reader_) {
         return false;
     }
 
-    const int total_entries = zip_entries_total(zip_handle_);
+    const int total_entries = archive_reader_ ? static_cast<int>(archive_reader_->size())
+                                              : zip_entries_total(zip_handle_);
     if (total_entries < 0) {
         return false;
     }
@@ -325,6 +621,11 @@ bool Document::load_tree_parallel(LoadStatistics& stats) {
 
     // Phase 1: Collect metadata sequentially (zip handles are not thread-safe)
     for (int i = 0; i < total_entries; ++i) {
+        if (archive_reader_) {
+            const ZipEntryInfo& info = archive_reader_->entry(static_cast<size_t>(i));
+            entries.push_back({i, info.name, info.is_directory});
+            continue;
+        }
         if (zip_entry_openbyindex(zip_handle_, i) != 0) {
             continue;
         }
@@ -362,6 +663,35 @@ bool Document::load_tree_parallel(LoadStatistics& stats) {
     std::atomic<size_t> xml_count{0};
     std::atomic<size_t> media_count{0};
     std::atomic<size_t> binary_count{0};
+    std::atomic<uint64_t> inflated_total{0};
+    InflateMeter meter;
+
+    // Set by any worker once loading has to stop; polled by all of them
+    std::atomic<bool> stop{false};
+    const CancellationToken& token = load_config_.cancellation_token;
+
+    // Errors are collected per worker and merged after the join
+    struct WorkerLog {
+        std::vector<LoadError> errors;
+        std::vector<std::string> skipped_files;
+    };
+    std::vector<WorkerLog> logs(num_threads);
+
+    auto record_error = [&](WorkerLog& log,
+                            LoadErrorType type,
+                            const std::string& entry_name,
+                            const char* message,
+                            bool skipped) {
+        log.errors.emplace_back(type, entry_name, message);
+        if (skipped) {
+            log.skipped_files.push_back(entry_name);
+        }
+        const size_t errors = ++error_count;
+        if (!load_config_.skip_corrupted_files ||
+            (load_config_.max_errors > 0 && errors >= load_config_.max_errors)) {
+            stop = true;
+        }
+    };
 
     const size_t batch_size = (files_to_load.size() + num_threads - 1) / num_threads;
     std::vector<std::thread> threads;
@@ -373,39 +703,89 @@ bool Document::load_tree_parallel(LoadStatistics& stats) {
             break;
         }
 
-        threads.emplace_back([&, start, end]() {
-            // Each thread opens its own zip handle for thread safety
-            zip_t* local_zip = zip_open(filepath_.c_str(), 0, 'r');
-            if (!local_zip) {
+        threads.emplace_back([&, t, start, end]() {
+            WorkerLog& log = logs[t];
+
+            // Each thread opens its own zip handle for thread safety. A directly
+            // read archive is immutable and shared; only codec state is per thread.
+            zip_t* local_zip = nullptr;
+            std::unique_ptr<DeflateCodec> codec;
+            if (archive_reader_) {
+                codec = make_deflate_codec(load_config_.compression_backend);
+            } else if (!decrypted_package_.empty()) {
+                const auto* package = reinterpret_cast<const char*>(decrypted_package_.data());
+                local_zip = zip_stream_open(package, decrypted_package_.size(), 0, 'r');
+            } else {
+                local_zip = zip_open(filepath_.c_str(), 0, 'r');
+            }
+            if (!local_zip && !codec) {
+                log.errors.emplace_back(
+                    LoadErrorType::ZipOpenFailed, filepath_, "Failed to open ZIP file");
                 error_count += (end - start);
                 return;
             }
 
+            std::vector<uint8_t> buffer;
             for (size_t i = start; i < end; ++i) {
+                if (stop.load(std::memory_order_relaxed) || token.is_cancelled()) {
+                    break;
+                }
+
                 const auto& entry = files_to_load[i];
 
-                if (zip_entry_openbyindex(local_zip, entry.index) != 0) {
-                    ++error_count;
-                    continue;
+                EntryReadStatus status = EntryReadStatus::Ok;
+                if (codec) {
+                    status = read_archive_entry_limited(*archive_reader_,
+                                                        static_cast<size_t>(entry.index),
+                                                        *codec,
+                                                        load_config_,
+                                                        inflated_total,
+                                                        meter,
+                                                        buffer);
+                } else {
+                    if (zip_entry_openbyindex(local_zip, entry.index) != 0) {
+                        record_error(log,
+                                     LoadErrorType::ZipEntryReadFailed,
+                                     entry.name,
+                                     "Failed to open entry",
+                                     true);
+                        continue;
+                    }
+
+                    status = read_entry_limited(
+                        local_zip, load_config_, inflated_total, meter, buffer);
+                    zip_entry_close(local_zip);
                 }
 
-                void* data = nullptr;
-                size_t size = 0;
-                if (zip_entry_read(local_zip, &data, &size) < 0 || !data) {
-                    zip_entry_close(local_zip);
-                    ++error_count;
+                if (status == EntryReadStatus::Cancelled) {
+                    break;
+                }
+                if (status == EntryReadStatus::LimitExceeded) {
+                    record_error(log,
+                                 LoadErrorType::LimitExceeded,
+                                 entry.name,
+                                 kLimitExceededMessage,
+                                 false);
+                    stop = true;
+                    continue;
+                }
+                if (status != EntryReadStatus::Ok) {
+                    record_error(log,
+                                 LoadErrorType::ZipEntryReadFailed,
+                                 entry.name,
+                                 "Failed to read entry",
+                                 true);
                     continue;
                 }
-
-                std::vector<uint8_t> buffer(size);
-                std::memcpy(buffer.data(), data, size);
-                free(data);
-                zip_entry_close(local_zip);
 
                 // DocxTree::add_zip_entry is internally synchronized
                 auto node = tree_.add_zip_entry(entry.name, buffer);
                 if (!node) {
-                    ++error_count;
+                    record_error(log,
+                                 LoadErrorType::XmlParseFailed,
+                                 entry.name,
+                                 "Failed to parse XML",
+                                 false);
                     continue;
                 }
 
@@ -427,7 +807,11 @@ bool Document::load_tree_parallel(LoadStatistics& stats) {
                 }
             }
 
-            zip_close(local_zip);
+            if (local_zip && decrypted_package_.empty()) {
+                zip_close(local_zip);
+            } else if (local_zip) {
+                zip_stream_close(local_zip);
+            }
         });
     }
 
@@ -437,23 +821,57 @@ bool Document::load_tree_parallel(LoadStatistics& stats) {
         }
     }
 
+    for (auto& log : logs) {
+        std::move(log.errors.begin(), log.errors.end(), std::back_inserter(result.errors));
+        std::move(log.skipped_files.begin(),
+                  log.skipped_files.end(),
+                  std::back_inserter(result.skipped_files));
+    }
+
     stats.processed_entries = processed.load();
     stats.xml_files = xml_count.load();
     stats.media_files = media_count.load();
     stats.binary_files = binary_count.load();
+    meter.store(stats);
 
+    aborted = stop.load();
     return error_count.load() < files_to_load.size();
 }
 
+void Document::abort_load(LoadResult& result) {
+    last_load_stats_.end_time = std::chrono::high_resolution_clock::now();
+    result.success = false;
+    result.integrity = DocumentIntegrity::Corrupted;
+    result.loaded_files = last_load_stats_.processed_entries;
+    result.load_time_ms = last_load_stats_.get_elapsed_ms();
+    last_load_result_ = result;
+}
+
+bool Document::check_load_cancelled(LoadResult& result) {
+    const CancellationReason reason = load_config_.cancellation_token.get_reason();
+    if (reason == CancellationReason::None) {
+        return false;
+    }
+
+    if (reason == CancellationReason::DeadlineExceeded) {
+        result.errors.emplace_back(LoadErrorType::Timeout, filepath_, "Load deadline exceeded");
+    } else {
+        result.errors.emplace_back(LoadErrorType::Cancelled, filepath_, "Load cancelled");
+    }
+    abort_load(result);
+    return true;
+}
+
 void Document::build_caches_from_tree() {
     xml_parts_cache_.clear();
-    media_files_cache_.clear();
+    media_index_.clear();
 
     tree_.iterate_files([this](const std::shared_ptr<DocxTreeNode>& node) {
         if (node->type == DocxNodeType::XmlFile) {
             xml_parts_cache_[node->full_path] = node;
-        } else if (node->type == DocxNodeType::MediaFile) {
-            media_files_cache_[node->full_path] = node;
+        } else if (node->type == DocxNodeType::MediaFile &&
+                   node->full_path.compare(0, 11, "word/media/") == 0) {
+            index_media(node->full_path.substr(11), node);
         }
     });
 }
@@ -461,7 +879,7 @@ void Document::build_caches_from_tree() {
 // Save Operations
 // ============================================================================
 
-bool Document::save_to_zip(const std::string& output_path) {
+bool Document::save_to_zip(const std::string& output_path, const CancellationToken* token) {
     // On Windows, opening a file for writing while it is already open
     // for reading fails. Close our read handle first if we are about
     // to overwrite the same file.
@@ -469,25 +887,129 @@ bool Document::save_to_zip(const std::string& output_path) {
         close_zip();
     }
 
-    zip_t* zip = zip_open(output_path.c_str(), 9, 'w');
-    if (!zip) {
-        // Windows may need a brief moment to fully release the file handle
-        // after close_zip(). Retry once after a short delay.
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        zip = zip_open(output_path.c_str(), 9, 'w');
+    // A cancellable save writes next to the target and renames on success,
+    // so an abort never leaves a truncated package behind
+    const std::string write_path = token ? output_path + ".part" : output_path;
+
+    last_save_stats_ = SaveStatistics();
+    last_save_stats_.start_time = std::chrono::high_resolution_clock::now();
+
+    // A failed direct write (e.g. a package past the 4 GB ZIP32 limit) is
+    // retried with the bundled library, which writes ZIP64
+    bool success = false;
+    bool written = false;
+    if (auto codec = make_deflate_codec(load_config_.compression_backend)) {
+        ZipArchiveWriter writer(*codec, kArchiveDeflateLevel);
+        writer.set_threads(load_config_.max_threads > 0 ? load_config_.max_threads
+                                                        : std::thread::hardware_concurrency());
+        bool opened = writer.open(write_path);
+        if (!opened) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            opened = writer.open(write_path);
+        }
+        success = opened && save_tree_to_archive(writer, token);
+        success = writer.close() && success;
+        written = success || (token && token->is_cancelled());
+        if (written) {
+            last_save_stats_.compression_backend = codec->backend();
+            last_save_stats_.parallel_entries = writer.get_parallel_entry_count();
+        } else {
+            last_save_stats_ = SaveStatistics();
+            last_save_stats_.start_time = std::chrono::high_resolution_clock::now();
+        }
+    }
+
+    if (!written) {
+        zip_t* zip = zip_open(write_path.c_str(), kBundledDeflateLevel, 'w');
         if (!zip) {
-            std::cerr << "[cdocx debug] zip_open failed for: " << output_path << std::endl;
-            return false;
+            // Windows may need a brief moment to fully release the file handle
+            // after close_zip(). Retry once after a short delay.
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            zip = zip_open(write_path.c_str(), kBundledDeflateLevel, 'w');
+            if (!zip) {
+                std::cerr << "[cdocx debug] zip_open failed for: " << write_path << std::endl;
+                return false;
+            }
         }
+
+        success = save_tree_to_zip(zip, token);
+
+        zip_close(zip);
     }
 
-    const bool success = save_tree_to_zip(zip);
+    std::error_code ec;
+    last_save_stats_.end_time = std::chrono::high_resolution_clock::now();
+    if (success) {
+        const auto package_bytes = std::filesystem::file_size(write_path, ec);
+        last_save_stats_.package_bytes = ec ? 0 : static_cast<uint64_t>(package_bytes);
+    }
+
+    if (!token) {
+        return success;
+    }
 
-    zip_close(zip);
-    return success;
+    if (success) {
+        std::filesystem::rename(write_path, output_path, ec);
+        if (!ec) {
+            return true;
+        }
+    }
+    std::filesystem::remove(write_path, ec);
+    return false;
 }
 
-bool Document::save_tree_to_zip(zip_t* zip) {
+bool Document::save_to_buffer(std::vector<uint8_t>& package, const CancellationToken* token) {
+    last_save_stats_ = SaveStatistics();
+    last_save_stats_.start_time = std::chrono::high_resolution_clock::now();
+
+    bool success = false;
+    bool written = false;
+    if (auto codec = make_deflate_codec(load_config_.compression_backend)) {
+        ZipArchiveWriter writer(*codec, kArchiveDeflateLevel);
+        writer.set_threads(load_config_.max_threads > 0 ? load_config_.max_threads
+                                                        : std::thread::hardware_concurrency());
+        success = writer.open(package) && save_tree_to_archive(writer, token);
+        success = writer.close() && success;
+        written = success || (token && token->is_cancelled());
+        if (written) {
+            last_save_stats_.compression_backend = codec->backend();
+            last_save_stats_.parallel_entries = writer.get_parallel_entry_count();
+        } else {
+            last_save_stats_ = SaveStatistics();
+            last_save_stats_.start_time = std::chrono::high_resolution_clock::now();
+        }
+    }
+
+    // Same ZIP64 fallback as save_to_zip(), using the bundled library's stream mode
+    if (!written) {
+        zip_t* zip = zip_stream_open(nullptr, 0, kBundledDeflateLevel, 'w');
+        if (!zip) {
+            return false;
+        }
+        success = save_tree_to_zip(zip, token);
+        if (success) {
+            void* data = nullptr;
+            size_t size = 0;
+            success = zip_stream_copy(zip, &data, &size) >= 0 && data;
+            if (success) {
+                const auto* bytes = static_cast<const uint8_t*>(data);
+                package.assign(bytes, bytes + size);
+            }
+            std::free(data);
+        }
+        zip_stream_close(zip);
+    }
+
+    last_save_stats_.end_time = std::chrono::high_resolution_clock::now();
+    if (!success) {
+        package.clear();
+        return false;
+    }
+    last_save_stats_.package_bytes = package.size();
+    return true;
+}
+
+bool Document::save_tree_to_zip(zip_t* zip, const CancellationToken* token) {
     if (!zip) {
         return false;
     }
@@ -500,9 +1022,14 @@ bool Document::save_tree_to_zip(zip_t* zip) {
         }
     });
 
-    // Second pass: write files
-    tree_.iterate_files([this, zip](const std::shared_ptr<DocxTreeNode>& node) {
-        if (node->is_deleted) {
+    // Second pass: write files (checked for cancellation per part and chunk)
+    bool cancelled = false;
+    tree_.iterate_files([this, zip, token, &cancelled](const std::shared_ptr<DocxTreeNode>& node) {
+        if (node->is_deleted || cancelled) {
+            return;
+        }
+        if (token && token->is_cancelled()) {
+            cancelled = true;
             return;
         }
 
@@ -511,16 +1038,55 @@ bool Document::save_tree_to_zip(zip_t* zip) {
         if (node->type == DocxNodeType::XmlFile && node->xml_doc) {
             // Serialize XML
             std::vector<uint8_t> data = node->serialize_xml_to_binary();
-            zip_entry_write(zip, data.data(), data.size());
+            const auto start = CodecClock::now();
+            cancelled = !write_entry_chunked(zip, data.data(), data.size(), token);
+            record_deflate(last_save_stats_, data.size(), start);
         } else {
             // Write binary data
-            zip_entry_write(zip, node->binary_data.data(), node->binary_data.size());
+            const auto start = CodecClock::now();
+            cancelled = !write_entry_chunked(
+                zip, node->binary_data.data(), node->binary_data.size(), token);
+            record_deflate(last_save_stats_, node->binary_data.size(), start);
         }
 
         zip_entry_close(zip);
     });
 
-    return true;
+    return !cancelled;
+}
+
+bool Document::save_tree_to_archive(ZipArchiveWriter& writer, const CancellationToken* token) {
+    bool ok = true;
+    tree_.iterate_all([&writer, &ok](const std::shared_ptr<DocxTreeNode>& node) {
+        if (ok && node->is_directory() && !node->name.empty()) {
+            ok = writer.add_directory(node->full_path + "/");
+        }
+    });
+
+    // Checked per part, and per block while a large part is deflated in parallel
+    bool cancelled = false;
+    tree_.iterate_files([&](const std::shared_ptr<DocxTreeNode>& node) {
+        if (!ok || cancelled || node->is_deleted) {
+            return;
+        }
+        if (token && token->is_cancelled()) {
+            cancelled = true;
+            return;
+        }
+
+        std::vector<uint8_t> serialized;
+        const std::vector<uint8_t>* data = &node->binary_data;
+        if (node->type == DocxNodeType::XmlFile && node->xml_doc) {
+            serialized = node->serialize_xml_to_binary();
+            data = &serialized;
+        }
+
+        const auto start = CodecClock::now();
+        ok = writer.add_entry(node->full_path, data->data(), data->size(), token);
+        record_deflate(last_save_stats_, data->size(), start);
+    });
+
+    return ok && !cancelled;
 }
 
 bool Document::write_tree_node(zip_t* /*zip*/, const std::shared_ptr<DocxTreeNode>& /*node*/) {
@@ -6,15 +6,84 @@
 
 #include <cdocx/document.h>
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <map>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
 
 #include "sync_common.h"
 
 namespace cdocx {
 
+namespace {
+
+/// Last segment of a relationship type ("image", "header", ...)
+std::string_view relationship_kind(std::string_view type) {
+    return type.substr(type.rfind('/') + 1);
+}
+
+/// Relationships part of a part: word/header1.xml -> word/_rels/header1.xml.rels
+std::string relationships_part(const std::string& source) {
+    const size_t name = source.rfind('/') + 1;
+    return source.substr(0, name) + "_rels/" + source.substr(name) + ".rels";
+}
+
+/// Package path of a relationship target, relative to the directory of @p source
+std::string resolve_target(const std::string& source, std::string_view target) {
+    if (!target.empty() && target.front() == '/') {
+        return std::string(target.substr(1));
+    }
+    std::string path = source.substr(0, source.rfind('/') + 1);
+    size_t begin = 0;
+    while (begin <= target.size()) {
+        const size_t end = std::min(target.find('/', begin), target.size());
+        const std::string_view segment = target.substr(begin, end - begin);
+        if (segment == "..") {
+            if (!path.empty()) {
+                path.pop_back();
+                const size_t slash = path.rfind('/');
+                path.erase(slash == std::string::npos ? 0 : slash + 1);
+            }
+        } else if (!segment.empty() && segment != ".") {
+            path.append(segment);
+            if (end < target.size()) {
+                path += '/';
+            }
+        }
+        begin = end + 1;
+    }
+    return path;
+}
+
+/// FNV-1a of a media file's content
+std::uint64_t content_hash(const std::vector<uint8_t>& data) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const uint8_t byte : data) {
+        hash = (hash ^ byte) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// Relationship ids used by @p node and its descendants (r:embed, r:id, o:relid, ...)
+void collect_relationship_uses(pugi::xml_node node, std::unordered_set<std::string>& ids) {
+    for (auto attr = node.first_attribute(); attr; attr = attr.next_attribute()) {
+        if (std::strncmp(attr.name(), "r:", 2) == 0 || std::strcmp(attr.name(), "o:relid") == 0) {
+            ids.insert(attr.value());
+        }
+    }
+    for (auto child = node.first_child(); child; child = child.next_sibling()) {
+        if (child.type() == pugi::node_element) {
+            collect_relationship_uses(child, ids);
+        }
+    }
+}
+
+}  // namespace
+
 // ============================================================================
 // Media Management
 // ============================================================================
@@ -36,11 +105,10 @@ bool Document::add_media(const std::string& image_path, const std::string* image
     }
 
     // Generate unique name if already exists
-    std::string media_path = "word/media/" + filename;
-    if (tree_.find_node(media_path)) {
+    if (has_media(filename)) {
         filename = generate_unique_image_name(filename);
-        media_path = "word/media/" + filename;
     }
+    const std::string media_path = "word/media/" + filename;
 
     // Read image file
     std::ifstream file(image_path, std::ios::binary);
@@ -66,7 +134,8 @@ bool Document::add_media(const std::string& image_path, const std::string* image
     node->content_type = get_mime_type(filename);
     node->is_new = true;
     node->is_modified = true;
-    media_files_cache_[media_path] = node;
+    node->is_deleted = false;
+    index_media(filename, node);
 
     // Register content type
     add_content_type_override("/" + media_path, get_mime_type(filename));
@@ -95,7 +164,8 @@ bool Document::add_media_from_memory(const std::string& name,
     node->content_type = content_type.empty() ? get_mime_type(name) : content_type;
     node->is_new = true;
     node->is_modified = true;
-    media_files_cache_[media_path] = node;
+    node->is_deleted = false;
+    index_media(name, node);
 
     add_content_type_override("/" + media_path, node->content_type);
 
@@ -120,13 +190,13 @@ bool Document::delete_media(const std::string& image_name) {
         return false;
     }
 
-    const std::string media_path = "word/media/" + image_name;
-    auto node = tree_.find_node(media_path);
-    if (!node) {
+    auto entry = media_index_.find(image_name);
+    if (entry == media_index_.end()) {
         return false;
     }
 
-    node->is_deleted = true;
+    entry->second.node->is_deleted = true;
+    media_index_.erase(entry);
 
     // Remove relationship if exists
     const std::string target = "media/" + image_name;
@@ -135,8 +205,6 @@ bool Document::delete_media(const std::string& image_name) {
         remove_relationship("word/_rels/document.xml.rels", rel_id);
     }
 
-    media_files_cache_.erase(media_path);
-
     return true;
 }
 
@@ -148,9 +216,8 @@ bool Document::replace_media(const std::string& image_name, const std::string& n
         return false;
     }
 
-    const std::string media_path = "word/media/" + image_name;
-    auto node = tree_.find_node(media_path);
-    if (!node) {
+    auto entry = media_index_.find(image_name);
+    if (entry == media_index_.end()) {
         return false;
     }
 
@@ -168,43 +235,71 @@ bool Document::replace_media(const std::string& image_name, const std::string& n
         return false;
     }
 
-    node->binary_data = std::move(data);
-    node->is_modified = true;
+    auto& node = *entry->second.node;
+    node.binary_data = std::move(data);
+    node.is_modified = true;
+    entry->second.size = node.binary_data.size();
+    entry->second.hash = 0;
 
     return true;
 }
 
-
 bool Document::has_media(const std::string& image_name) const {
-    if (!is_open()) {
-        return false;
-    }
-    const std::string media_path = "word/media/" + image_name;
-    auto node = tree_.find_node(media_path);
-    return node && !node->is_deleted;
+    return is_open() && media_index_.find(image_name) != media_index_.end();
 }
 
 std::vector<std::string> Document::list_media() const {
     std::vector<std::string> result;
-    tree_.iterate_files([&result](const std::shared_ptr<DocxTreeNode>& node) {
-        if (node->type == DocxNodeType::MediaFile && !node->is_deleted) {
-            const std::string name = node->full_path;
-            if (name.substr(0, 11) == "word/media/") {
-                result.push_back(name.substr(11));
-            }
-        }
-    });
+    result.reserve(media_index_.size());
+    for (const auto& entry : media_index_) {
+        result.push_back(entry.first);
+    }
     return result;
 }
 
+std::vector<std::string_view> Document::get_media_names() const {
+    std::vector<std::string_view> result;
+    result.reserve(media_index_.size());
+    for (const auto& entry : media_index_) {
+        result.emplace_back(entry.first);
+    }
+    return result;
+}
+
+std::string Document::find_media_by_content(const std::vector<uint8_t>& data) const {
+    std::uint64_t hash = 0;
+    for (const auto& entry : media_index_) {
+        const MediaEntry& media = entry.second;
+        if (media.size != data.size()) {
+            continue;
+        }
+        if (hash == 0) {
+            hash = content_hash(data);
+        }
+        if (media.hash == 0) {
+            media.hash = content_hash(media.node->binary_data);
+        }
+        if (media.hash == hash && media.node->binary_data == data) {
+            return entry.first;
+        }
+    }
+    return "";
+}
+
+void Document::index_media(const std::string& name, const std::shared_ptr<DocxTreeNode>& node) {
+    MediaEntry& entry = media_index_[name];
+    entry.node = node;
+    entry.size = node->binary_data.size();
+    entry.hash = 0;
+}
+
 bool Document::export_media(const std::string& image_name, const std::string& output_path) const {
     if (!is_open()) {
         return false;
     }
 
-    const std::string media_path = "word/media/" + image_name;
-    auto node = tree_.find_node(media_path);
-    if (!node || node->is_deleted) {
+    auto entry = media_index_.find(image_name);
+    if (entry == media_index_.end()) {
         return false;
     }
 
@@ -213,7 +308,8 @@ bool Document::export_media(const std::string& image_name, const std::string& ou
         return false;
     }
 
-    file.write(reinterpret_cast<const char*>(node->binary_data.data()), node->binary_data.size());
+    const auto& data = entry->second.node->binary_data;
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
 
     return file.good();
 }
@@ -224,10 +320,9 @@ std::vector<uint8_t> Document::get_media_data(const std::string& image_name) con
         return result;
     }
 
-    const std::string media_path = "word/media/" + image_name;
-    auto node = tree_.find_node(media_path);
-    if (node && !node->is_deleted) {
-        result = node->binary_data;
+    auto entry = media_index_.find(image_name);
+    if (entry != media_index_.end()) {
+        result = entry->second.node->binary_data;
     }
     return result;
 }
@@ -248,6 +343,109 @@ std::string Document::add_media_with_rel(const std::string& image_path,
         "media/" + name);
 }
 
+MediaCleanupResult Document::collect_unused_media() {
+    if (!is_open()) {
+        return {};
+    }
+
+    // Bring the parts and relationship files up to date with the DOM first
+    sync_to_physical_tree();
+    for (const auto& rels_pair : relationships_) {
+        update_relationships_xml(rels_pair.first);
+    }
+    return sweep_unused_media();
+}
+
+MediaCleanupResult Document::sweep_unused_media() {
+    MediaCleanupResult result;
+
+    // Walk the parts reachable from the package relationships. Images, headers
+    // and footers are used only where their id appears in the source part;
+    // other targets (styles, numbering, charts, ...) whenever the source is
+    // reached. A part that is not parsed XML keeps all of its targets.
+    std::unordered_set<std::string> reached = {""};
+    std::unordered_set<std::string> used_ids;
+    std::vector<std::string> pending = {""};
+    while (!pending.empty()) {
+        const std::string source = std::move(pending.back());
+        pending.pop_back();
+        const std::string rels_path = relationships_part(source);
+        const auto rels_node = tree_.find_node(rels_path);
+        if (!rels_node || rels_node->is_deleted || !rels_node->xml_doc) {
+            continue;
+        }
+
+        const auto source_node = source.empty() ? nullptr : tree_.find_node(source);
+        const bool checked = source_node && source_node->xml_doc;
+        used_ids.clear();
+        if (checked) {
+            collect_relationship_uses(*source_node->xml_doc, used_ids);
+        }
+
+        auto managed = relationships_.find(rels_path);
+        bool changed = false;
+        auto root = rels_node->xml_doc->child("Relationships");
+        for (auto rel = root.child("Relationship"); rel;) {
+            const auto next = rel.next_sibling("Relationship");
+            if (std::strcmp(rel.attribute("TargetMode").value(), "External") == 0) {
+                rel = next;
+                continue;
+            }
+            const std::string_view kind = relationship_kind(rel.attribute("Type").value());
+            const std::string id = rel.attribute("Id").value();
+            const bool used = !checked || used_ids.count(id) != 0 ||
+                              (kind != "image" && kind != "header" && kind != "footer");
+            if (used) {
+                std::string target = resolve_target(source, rel.attribute("Target").value());
+                if (reached.insert(target).second) {
+                    pending.push_back(std::move(target));
+                }
+            } else if (kind == "image") {
+                if (managed != relationships_.end()) {
+                    auto& rels = managed->second;
+                    rels.erase(std::remove_if(rels.begin(),
+                                              rels.end(),
+                                              [&id](const Relationship& r) { return r.id == id; }),
+                               rels.end());
+                }
+                root.remove_child(rel);
+                changed = true;
+                ++result.removed_relationships;
+            }
+            rel = next;
+        }
+        if (changed) {
+            mark_modified(rels_path);
+        }
+    }
+
+    std::unordered_set<std::string> removed_parts;
+    for (auto it = media_index_.begin(); it != media_index_.end();) {
+        const std::string& path = it->second.node->full_path;
+        if (reached.count(path) != 0) {
+            ++it;
+            continue;
+        }
+        it->second.node->is_deleted = true;
+        ++result.removed_files;
+        result.removed_bytes += it->second.size;
+        removed_parts.insert("/" + path);
+        it = media_index_.erase(it);
+    }
+
+    if (!removed_parts.empty()) {
+        content_types_.erase(std::remove_if(content_types_.begin(),
+                                            content_types_.end(),
+                                            [&removed_parts](const ContentType& ct) {
+                                                return !ct.is_default &&
+                                                       removed_parts.count(ct.part_name) != 0;
+                                            }),
+                             content_types_.end());
+        modified_parts_.insert("[Content_Types].xml");
+    }
+    return result;
+}
+
 // ============================================================================
 // Thumbnail Management
 // ============================================================================
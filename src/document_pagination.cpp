@@ -0,0 +1,925 @@
+/**
+ * @file document_pagination.cpp
+ * @brief Approximate line breaking and page placement for Document class
+ */
+
+#include <cdocx/body.h>
+#include <cdocx/convert_util.h>
+#include <cdocx/document.h>
+#include <cdocx/pagination.h>
+#include <cdocx/paragraph.h>
+#include <cdocx/section.h>
+#include <cdocx/style.h>
+#include <cdocx/table.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include "font_metrics.h"
+#include "page_layout.h"
+#include "sync_common.h"
+
+namespace cdocx {
+
+namespace {
+
+constexpr double kDefaultFontSize = 10;  // Word's size when no style sets one
+constexpr double kCellPadding = 10.8;    // Default left and right cell margins together
+constexpr double kMinLineWidth = 12;
+constexpr double kEmuPerPoint = 12700;
+
+// ============================================================================
+// Formatting inherited from styles and document defaults
+// ============================================================================
+
+/// Paragraph and character formatting in effect before a run's own formatting
+struct BaseFormat {
+    double left_indent = 0;
+    double right_indent = 0;
+    double first_line_indent = 0;
+    double space_before = 0;
+    double space_after = 0;
+    LineSpacingRule line_rule = LineSpacingRule::Auto;
+    double line_spacing = 1.0;
+    bool keep_with_next = false;
+    bool keep_together = false;
+    bool page_break_before = false;
+    std::string font_name = "Times New Roman";
+    std::string far_east_font;
+    double font_size = kDefaultFontSize;
+    bool bold = false;
+    bool italic = false;
+};
+
+/// Overrides @p base with the values of @p format that differ from ParagraphFormat's defaults
+void apply_paragraph_format(const ParagraphFormat& format, BaseFormat& base) {
+    const ParagraphFormat unset;
+    if (format.left_indent != unset.left_indent) {
+        base.left_indent = format.left_indent;
+    }
+    if (format.right_indent != unset.right_indent) {
+        base.right_indent = format.right_indent;
+    }
+    if (format.first_line_indent != unset.first_line_indent) {
+        base.first_line_indent = format.first_line_indent;
+    }
+    if (format.space_before != unset.space_before) {
+        base.space_before = format.space_before;
+    }
+    if (format.space_after != unset.space_after) {
+        base.space_after = format.space_after;
+    }
+    if (format.line_spacing_rule != unset.line_spacing_rule ||
+        format.line_spacing != unset.line_spacing) {
+        base.line_rule = format.line_spacing_rule;
+        base.line_spacing = format.line_spacing;
+    }
+    base.keep_with_next = base.keep_with_next || format.keep_with_next;
+    base.keep_together = base.keep_together || format.keep_together;
+    base.page_break_before = base.page_break_before || format.page_break_before;
+}
+
+/// Overrides @p base with the properties @p font sets (parsed fonts leave the rest empty)
+void apply_font(const Font& font, BaseFormat& base) {
+    if (!font.name.empty()) {
+        base.font_name = font.name;
+    }
+    if (!font.name_far_east.empty()) {
+        base.far_east_font = font.name_far_east;
+    }
+    if (font.size > 0) {
+        base.font_size = font.size;
+    }
+    base.bold = base.bold || font.bold;
+    base.italic = base.italic || font.italic;
+}
+
+/// A Font with nothing set, for the paragraph mark
+Font unset_font() {
+    Font font;
+    font.name.clear();
+    font.name_far_east.clear();
+    font.size = 0;
+    return font;
+}
+
+BaseFormat read_document_defaults(pugi::xml_document* styles) {
+    BaseFormat base;
+    if (!styles) {
+        return base;
+    }
+    auto defaults = styles->child("w:styles").child("w:docDefaults");
+    if (auto r_pr = defaults.child("w:rPrDefault").child("w:rPr")) {
+        Font font;
+        parse_font_from_xml(r_pr, font);
+        if (font.name.empty()) {
+            // Theme fonts, as in the default Office theme
+            const char* theme = r_pr.child("w:rFonts").attribute("w:asciiTheme").value();
+            if (std::strncmp(theme, "minor", 5) == 0) {
+                font.name = "Calibri";
+            } else if (std::strncmp(theme, "major", 5) == 0) {
+                font.name = "Calibri Light";
+            }
+        }
+        apply_font(font, base);
+    }
+    if (auto p_pr = defaults.child("w:pPrDefault").child("w:pPr")) {
+        ParagraphFormat format;
+        parse_paragraph_format_children_from_xml(p_pr, format);
+        apply_paragraph_format(format, base);
+    }
+    return base;
+}
+
+std::string default_paragraph_style(const StyleCollection& styles) {
+    for (const auto& style : styles) {
+        if (style->get_type() == StyleType::Paragraph && style->get_is_default()) {
+            return style->get_style_id();
+        }
+    }
+    return "Normal";
+}
+
+/// Paragraph styles resolved through their basedOn chain, once each
+class StyleFormats {
+  public:
+    StyleFormats(const StyleCollection& styles, const BaseFormat& defaults, std::string normal)
+        : styles_(styles), defaults_(defaults), normal_(std::move(normal)) {}
+
+    const BaseFormat& get(const std::string& style_id) {
+        return resolve(style_id.empty() ? normal_ : style_id, 0);
+    }
+
+  private:
+    const BaseFormat& resolve(const std::string& style_id, int depth) {
+        auto it = formats_.find(style_id);
+        if (it != formats_.end()) {
+            return it->second;
+        }
+        auto style = styles_.get_by_style_id(style_id);
+        if (!style) {
+            style = styles_.get_by_name(style_id);
+        }
+        // The depth limit ends basedOn cycles
+        BaseFormat format = defaults_;
+        if (style) {
+            const std::string base = style->get_base_style_name();
+            if (!base.empty() && base != style_id && depth < 16) {
+                format = resolve(base, depth + 1);
+            }
+            apply_paragraph_format(style->get_paragraph_format(), format);
+            apply_font(style->get_font(), format);
+        }
+        return formats_.emplace(style_id, std::move(format)).first->second;
+    }
+
+    const StyleCollection& styles_;
+    const BaseFormat& defaults_;
+    std::string normal_;
+    std::unordered_map<std::string, BaseFormat> formats_;
+};
+
+/// Metrics looked up in the process-wide cache once per thread and font
+class FontSet {
+  public:
+    const FontMetrics& get(const std::string& name, bool bold, bool italic) {
+        std::string key = name;
+        key += bold ? "\nb" : "\n";
+        key += italic ? 'i' : ' ';
+        auto& metrics = fonts_[key];
+        if (!metrics) {
+            metrics = name.empty() ? FontMetrics::fallback()
+                                   : FontCache::instance().get(name, bold, italic);
+        }
+        return *metrics;
+    }
+
+  private:
+    std::unordered_map<std::string, std::shared_ptr<const FontMetrics>> fonts_;
+};
+
+/// Measuring data of a run's font
+struct RunFont {
+    const FontMetrics* latin = nullptr;
+    const FontMetrics* east_asian = nullptr;
+    double size = kDefaultFontSize;
+    double width_scale = 1;  ///< Character scaling, smaller for super- and subscript
+    double spacing = 0;
+    bool all_caps = false;
+};
+
+RunFont resolve_font(const Font& font, const BaseFormat& base, FontSet& fonts) {
+    BaseFormat format = base;
+    apply_font(font, format);
+    RunFont run_font;
+    run_font.latin = &fonts.get(format.font_name, format.bold, format.italic);
+    run_font.east_asian = &fonts.get(format.far_east_font, format.bold, format.italic);
+    run_font.size = format.font_size;
+    run_font.width_scale = font.scale > 0 ? font.scale / 100.0 : 1.0;
+    if (font.script_type != ScriptType::Normal) {
+        run_font.width_scale *= 2.0 / 3.0;
+    }
+    run_font.spacing = font.spacing;
+    run_font.all_caps = font.all_caps;
+    return run_font;
+}
+
+// ============================================================================
+// Line breaking
+// ============================================================================
+
+/// Characters a line may not start with (closing CJK punctuation)
+bool is_no_break_before(std::uint32_t cp) {
+    switch (cp) {
+        case 0x3001:  // 、
+        case 0x3002:  // 。
+        case 0x300D:  // 」
+        case 0x300F:  // 』
+        case 0xFF01:  // ！
+        case 0xFF09:  // ）
+        case 0xFF0C:  // ，
+        case 0xFF0E:  // ．
+        case 0xFF1A:  // ：
+        case 0xFF1B:  // ；
+        case 0xFF1F:  // ？
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// Greedy line breaking at spaces, after hyphens and tabs, and between CJK characters
+class LineBreaker {
+  public:
+    LineBreaker(const BaseFormat& format, double width, double tab_stop, double mark_height)
+        : format_(format), width_(width), tab_stop_(tab_stop), mark_height_(mark_height) {}
+
+    void glyph(std::uint32_t cp, double advance, double height) {
+        if (cp == ' ' || cp == 0x3000) {
+            // Spaces may hang past the margin
+            x_ += advance;
+            pending_ = std::max(pending_, height);
+            mark_break();
+            return;
+        }
+        if (is_east_asian_wide(cp) && !is_no_break_before(cp)) {
+            mark_break();
+        }
+        place(advance, height);
+        if (cp == '-') {
+            mark_break();
+        }
+    }
+
+    /// An inline object, such as a picture
+    void box(double width, double height) {
+        mark_break();
+        place(width, height);
+        mark_break();
+    }
+
+    void tab(double height) {
+        // Default tab stops count from the left indent
+        const double indent = first_ ? format_.first_line_indent : 0;
+        if (tab_stop_ > 0) {
+            x_ = (std::floor((x_ + indent) / tab_stop_) + 1) * tab_stop_ - indent;
+        }
+        pending_ = std::max(pending_, height);
+        mark_break();
+    }
+
+    void line_break(LayoutLine::Break kind) {
+        emit(std::max(committed_, pending_), kind);
+        x_ = 0;
+        pending_ = 0;
+    }
+
+    std::vector<LayoutLine> finish() {
+        emit(std::max(committed_, pending_), LayoutLine::Break::None);
+        return std::move(lines_);
+    }
+
+  private:
+    double available() const {
+        const double indent = format_.left_indent + format_.right_indent +
+                              (first_ ? format_.first_line_indent : 0);
+        return std::max(width_ - indent, kMinLineWidth);
+    }
+
+    void mark_break() {
+        break_x_ = x_;
+        committed_ = std::max(committed_, pending_);
+        pending_ = 0;
+        has_break_ = true;
+    }
+
+    void place(double advance, double height) {
+        if (x_ + advance > available() && x_ > 0) {
+            if (has_break_ && break_x_ > 0) {
+                // The text after the last break opportunity moves to the next line
+                const double carried = x_ - break_x_;
+                emit(committed_, LayoutLine::Break::None);
+                x_ = carried;
+            } else {
+                emit(std::max(committed_, pending_), LayoutLine::Break::None);
+                x_ = 0;
+                pending_ = 0;
+            }
+        }
+        x_ += advance;
+        pending_ = std::max(pending_, height);
+    }
+
+    void emit(double natural, LayoutLine::Break kind) {
+        if (natural <= 0) {
+            natural = mark_height_;
+        }
+        double height = natural * format_.line_spacing;
+        if (format_.line_rule == LineSpacingRule::Exact) {
+            height = format_.line_spacing;
+        } else if (format_.line_rule == LineSpacingRule::AtLeast) {
+            height = std::max(format_.line_spacing, natural);
+        }
+        lines_.push_back({height, kind});
+        first_ = false;
+        has_break_ = false;
+        committed_ = 0;
+    }
+
+    const BaseFormat& format_;
+    double width_;
+    double tab_stop_;
+    double mark_height_;
+    std::vector<LayoutLine> lines_;
+    double x_ = 0;
+    double break_x_ = 0;
+    double committed_ = 0;  ///< Height of the line up to the last break opportunity
+    double pending_ = 0;    ///< Height of what follows it
+    bool has_break_ = false;
+    bool first_ = true;
+};
+
+/// Measures paragraphs, reusing the lines of those whose key did not change
+class ParagraphMeasurer {
+  public:
+    ParagraphMeasurer(StyleFormats& styles,
+                      FontSet& fonts,
+                      double tab_stop,
+                      std::unordered_map<const Paragraph*, MeasuredParagraph>& previous)
+        : styles_(styles), fonts_(fonts), tab_stop_(tab_stop), previous_(previous) {}
+
+    const BlockLayout& measure(const Paragraph& para, double width) {
+        BaseFormat format = styles_.get(para.get_paragraph_format().style_name);
+        apply_paragraph_format(para.get_paragraph_format(), format);
+
+        const std::uint64_t key = layout_key(para, format, width);
+        MeasuredParagraph& entry = current_[&para];
+        auto it = previous_.find(&para);
+        if (it != previous_.end() && it->second.key == key) {
+            entry = std::move(it->second);
+        } else {
+            entry.key = key;
+            entry.layout = break_lines(para, format, width);
+        }
+        return entry.layout;
+    }
+
+    /// The paragraphs measured by this measurer; the others drop out of the cache
+    std::unordered_map<const Paragraph*, MeasuredParagraph>& measured() { return current_; }
+
+  private:
+    static std::uint64_t layout_key(const Paragraph& para, const BaseFormat& format, double width) {
+        SignatureHash key;
+        key.add(content_signature(para));
+        key.add(width);
+        key.add(format.left_indent);
+        key.add(format.right_indent);
+        key.add(format.first_line_indent);
+        key.add(format.space_before);
+        key.add(format.space_after);
+        key.add(format.line_rule);
+        key.add(format.line_spacing);
+        key.add(format.keep_with_next);
+        key.add(format.keep_together);
+        key.add(format.page_break_before);
+        key.add(format.font_name);
+        key.add(format.far_east_font);
+        key.add(format.font_size);
+        for (const auto& child : para.get_children()) {
+            if (const auto* item = dynamic_cast<const Inline*>(child.get())) {
+                const Font& font = item->get_font();
+                key.add(font.name);
+                key.add(font.name_far_east);
+                key.add(font.size);
+                key.add(font.bold);
+                key.add(font.italic);
+                key.add(font.all_caps);
+                key.add(font.scale);
+                key.add(font.spacing);
+                key.add(font.script_type);
+            }
+        }
+        return key.value();
+    }
+
+    BlockLayout break_lines(const Paragraph& para, const BaseFormat& format, double width) {
+        const RunFont mark = resolve_font(unset_font(), format, fonts_);
+        LineBreaker lines(format, width, tab_stop_, mark.latin->line_height() * mark.size);
+
+        for (const auto& child : para.get_children()) {
+            switch (child->node_type()) {
+                case NodeType::Run: {
+                    const auto& run = static_cast<const Run&>(*child);
+                    const RunFont font = resolve_font(run.get_font(), format, fonts_);
+                    add_text(run.get_text(), font, lines);
+                    add_objects(run.get_preserved_children(), font, lines);
+                    break;
+                }
+                case NodeType::FieldStart:
+                case NodeType::Hyperlink: {
+                    const auto& field = static_cast<const Field&>(*child);
+                    add_text(field.get_text(), resolve_font(field.get_font(), format, fonts_),
+                             lines);
+                    break;
+                }
+                case NodeType::SpecialChar: {
+                    const auto& special = static_cast<const SpecialChar&>(*child);
+                    const char c = static_cast<char>(special.get_char());
+                    if (c == '\t' || c == '\v' || c == '\f' || c == '\x0e') {
+                        add_text(std::string(1, c),
+                                 resolve_font(special.get_font(), format, fonts_), lines);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        BlockLayout block;
+        block.node = &para;
+        block.space_before = format.space_before;
+        block.space_after = format.space_after;
+        block.keep_with_next = format.keep_with_next;
+        block.keep_together = format.keep_together;
+        block.page_break_before = format.page_break_before;
+        block.lines = lines.finish();
+        return block;
+    }
+
+    static void add_text(std::string_view text, const RunFont& font, LineBreaker& lines) {
+        const double height = font.latin->line_height() * font.size;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            const auto byte = static_cast<unsigned char>(text[pos]);
+            std::uint32_t cp = byte < 0x80 ? text[pos++] : next_code_point(text, pos);
+            if (cp < 0x20) {
+                switch (cp) {
+                    case '\t':
+                        lines.tab(height);
+                        break;
+                    case '\r':
+                        if (pos < text.size() && text[pos] == '\n') {
+                            ++pos;  // "\r\n" is one break
+                        }
+                        lines.line_break(LayoutLine::Break::None);
+                        break;
+                    case '\n':
+                    case '\v':
+                        lines.line_break(LayoutLine::Break::None);
+                        break;
+                    case '\f':
+                        lines.line_break(LayoutLine::Break::Page);
+                        break;
+                    case '\x0e':
+                        lines.line_break(LayoutLine::Break::Column);
+                        break;
+                    default:
+                        break;
+                }
+                continue;
+            }
+            if (font.all_caps && cp >= 'a' && cp <= 'z') {
+                cp -= 'a' - 'A';
+            }
+            const bool wide = is_east_asian_wide(cp);
+            const FontMetrics& metrics = wide ? *font.east_asian : *font.latin;
+            lines.glyph(cp,
+                        metrics.advance(cp) * font.size * font.width_scale + font.spacing,
+                        wide ? metrics.line_height() * font.size : height);
+        }
+    }
+
+    /// Inline pictures and the breaks of runs without text, kept as raw XML
+    static void add_objects(pugi::xml_node preserved, const RunFont& font, LineBreaker& lines) {
+        for (auto child = preserved.first_child(); child; child = child.next_sibling()) {
+            const char* name = child.name();
+            if (std::strcmp(name, "w:drawing") == 0) {
+                // Floating (wp:anchor) drawings do not take space in the line
+                auto extent = child.child("wp:inline").child("wp:extent");
+                if (extent) {
+                    lines.box(extent.attribute("cx").as_double() / kEmuPerPoint,
+                              extent.attribute("cy").as_double() / kEmuPerPoint);
+                }
+            } else if (std::strcmp(name, "w:br") == 0) {
+                const char* type = child.attribute("w:type").value();
+                add_text(std::strcmp(type, "page") == 0     ? "\f"
+                         : std::strcmp(type, "column") == 0 ? "\x0e"
+                                                            : "\n",
+                         font, lines);
+            } else if (std::strcmp(name, "w:tab") == 0) {
+                add_text("\t", font, lines);
+            } else if (std::strcmp(name, "w:cr") == 0) {
+                add_text("\n", font, lines);
+            }
+        }
+    }
+
+    StyleFormats& styles_;
+    FontSet& fonts_;
+    double tab_stop_;
+    std::unordered_map<const Paragraph*, MeasuredParagraph>& previous_;
+    std::unordered_map<const Paragraph*, MeasuredParagraph> current_;
+};
+
+// ============================================================================
+// Blocks and pages
+// ============================================================================
+
+BlockLayout measure_table(const Table& table, ParagraphMeasurer& measurer, double width);
+
+/// Height of the paragraphs and tables in a table cell
+double content_height(const CompositeNode& container, ParagraphMeasurer& measurer, double width) {
+    double height = 0;
+    for (const auto& child : container.get_children()) {
+        if (child->node_type() == NodeType::Paragraph) {
+            const BlockLayout& para =
+                measurer.measure(static_cast<const Paragraph&>(*child), width);
+            height += para.space_before + para.space_after;
+            for (const auto& line : para.lines) {
+                height += line.height;
+            }
+        } else if (child->node_type() == NodeType::Table) {
+            for (const auto& row : measure_table(static_cast<const Table&>(*child), measurer,
+                                                 width)
+                                       .lines) {
+                height += row.height;
+            }
+        }
+    }
+    return height;
+}
+
+/// A table as one block whose lines are its rows; rows are not split across pages
+BlockLayout measure_table(const Table& table, ParagraphMeasurer& measurer, double width) {
+    BlockLayout block;
+    block.node = &table;
+    for (const auto& row : table.get_children()) {
+        if (row->node_type() != NodeType::Row) {
+            continue;
+        }
+        const auto& cells = static_cast<const CompositeNode&>(*row).get_children();
+        const double even_width = width / static_cast<double>(std::max<size_t>(cells.size(), 1));
+        double height = 0;
+        for (const auto& node : cells) {
+            if (node->node_type() != NodeType::Cell) {
+                continue;
+            }
+            const auto& cell = static_cast<const Cell&>(*node);
+            const double cell_width = cell.get_cell_format().width > 0
+                                          ? cell.get_cell_format().width
+                                          : even_width;
+            height = std::max(height, content_height(cell, measurer,
+                                                     std::max(cell_width - kCellPadding,
+                                                              kMinLineWidth)));
+        }
+        block.lines.push_back({height, LayoutLine::Break::None});
+    }
+    return block;
+}
+
+/// Places blocks into the frames (columns) of a section's pages
+class FlowPlacer {
+  public:
+    FlowPlacer(double frame_height, int columns)
+        : frame_height_(frame_height), columns_(columns) {}
+
+    /// Places @p block at @p pos and returns the page of its first line
+    int place(const BlockLayout& block, const BlockLayout* next, FlowPosition& pos) const {
+        if (block.page_break_before && (pos.y > 0 || pos.frame % columns_ != 0)) {
+            next_page(pos);
+        }
+        double total = 0;
+        for (const auto& line : block.lines) {
+            total += line.height;
+        }
+        double before = pos.y > 0 ? block.space_before : 0;
+        if (pos.y > 0 && !block.lines.empty()) {
+            // Move the block to the next frame when what has to stay together does not fit
+            double needed = block.keep_together ? total : block.lines.front().height;
+            if (block.keep_with_next && next && !next->lines.empty()) {
+                needed = total + block.space_after + next->space_before +
+                         next->lines.front().height;
+            }
+            if (pos.y + before + needed > frame_height_ && needed <= frame_height_) {
+                next_frame(pos);
+                before = 0;
+            }
+        }
+        pos.y += before;
+
+        int first_frame = -1;
+        for (const auto& line : block.lines) {
+            if (pos.y > 0 && pos.y + line.height > frame_height_) {
+                next_frame(pos);
+            }
+            if (first_frame < 0) {
+                first_frame = pos.frame;
+            }
+            pos.y += line.height;
+            if (line.break_after == LayoutLine::Break::Page) {
+                next_page(pos);
+            } else if (line.break_after == LayoutLine::Break::Column) {
+                next_frame(pos);
+            }
+        }
+        // Space after may run past the bottom margin; the next line moves on anyway
+        pos.y += block.space_after;
+        return (first_frame < 0 ? pos.frame : first_frame) / columns_;
+    }
+
+    int page_of(const FlowPosition& pos) const { return pos.frame / columns_; }
+
+  private:
+    static void next_frame(FlowPosition& pos) {
+        ++pos.frame;
+        pos.y = 0;
+    }
+
+    void next_page(FlowPosition& pos) const {
+        pos.frame = (pos.frame / columns_ + 1) * columns_;
+        pos.y = 0;
+    }
+
+    double frame_height_;
+    int columns_;
+};
+
+struct SectionJob {
+    std::shared_ptr<Body> body;
+    SectionLayout layout;
+};
+
+void set_geometry(const SectionProperties& properties, SectionLayout& layout) {
+    const auto& size = properties.page_size;
+    const auto& margins = properties.page_margins;
+    const int columns = std::max(properties.columns.count, 1);
+    const double width = ConvertUtil::twips_to_point(size.width - margins.left - margins.right);
+    const double gaps = ConvertUtil::twips_to_point(properties.columns.space) * (columns - 1);
+    const double height = ConvertUtil::twips_to_point(size.height - std::abs(margins.top) -
+                                                      std::abs(margins.bottom));
+    const double frame_width = std::max((width - gaps) / columns, kMinLineWidth);
+    const double frame_height = std::max(height, kMinLineWidth);
+    if (frame_width != layout.frame_width || frame_height != layout.frame_height ||
+        columns != layout.columns) {
+        // Page setup changed: place everything again
+        layout.blocks.clear();
+        layout.before.clear();
+        layout.first_page.clear();
+    }
+    layout.frame_width = frame_width;
+    layout.frame_height = frame_height;
+    layout.columns = columns;
+}
+
+void layout_section(const Body& body, ParagraphMeasurer& measurer, SectionLayout& layout) {
+    std::vector<BlockLayout> blocks;
+    blocks.reserve(body.get_child_count());
+    for (const auto& child : body.get_children()) {
+        if (child->node_type() == NodeType::Paragraph) {
+            blocks.push_back(
+                measurer.measure(static_cast<const Paragraph&>(*child), layout.frame_width));
+        } else if (child->node_type() == NodeType::Table) {
+            blocks.push_back(measure_table(static_cast<const Table&>(*child), measurer,
+                                           layout.frame_width));
+        }
+    }
+    layout.measured = std::move(measurer.measured());
+
+    // Resume in front of the first block whose lines changed; a block kept with
+    // the next one depends on that block's first line and is placed again too
+    size_t resume = 0;
+    while (resume < blocks.size() && resume < layout.blocks.size() &&
+           blocks[resume] == layout.blocks[resume]) {
+        ++resume;
+    }
+    if (resume == blocks.size() && blocks.size() == layout.blocks.size() &&
+        layout.before.size() == blocks.size() + 1) {
+        return;
+    }
+    while (resume > 0 && blocks[resume - 1].keep_with_next) {
+        --resume;
+    }
+    FlowPosition pos;
+    if (resume < layout.before.size()) {
+        pos = layout.before[resume];
+    } else {
+        resume = 0;
+    }
+    layout.before.resize(resume);
+    layout.first_page.resize(resume);
+
+    const FlowPlacer placer(layout.frame_height, layout.columns);
+    for (size_t i = resume; i < blocks.size(); ++i) {
+        layout.before.push_back(pos);
+        const BlockLayout* next = i + 1 < blocks.size() ? &blocks[i + 1] : nullptr;
+        layout.first_page.push_back(placer.place(blocks[i], next, pos));
+    }
+    layout.before.push_back(pos);
+    layout.page_count = placer.page_of(pos) + 1;
+    layout.blocks = std::move(blocks);
+}
+
+// ============================================================================
+// Page number fields
+// ============================================================================
+
+/// First word of the field instruction, upper-cased ("PAGE", "NUMPAGES", ...)
+std::string field_name(const Field& field) {
+    const std::string code = trim_whitespace(field.get_field_code());
+    if (code.empty()) {
+        // A field created from its type alone has no instruction text
+        return field.get_type() == FieldType::Page       ? "PAGE"
+               : field.get_type() == FieldType::NumPages ? "NUMPAGES"
+                                                         : "";
+    }
+    std::string name = code.substr(0, code.find_first_of(" \t"));
+    for (char& c : name) {
+        if (c >= 'a' && c <= 'z') {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+    }
+    return name;
+}
+
+/// Sets the results of the page fields under @p node; @p page 0 leaves PAGE alone
+void set_page_fields(const CompositeNode& node, int page, int section_pages, int total) {
+    for (const auto& child : node.get_children()) {
+        if (child->node_type() == NodeType::FieldStart) {
+            auto& field = static_cast<Field&>(*child);
+            const std::string name = field_name(field);
+            int value = 0;
+            if (name == "PAGE") {
+                value = page;
+            } else if (name == "NUMPAGES") {
+                value = total;
+            } else if (name == "SECTIONPAGES") {
+                value = section_pages;
+            }
+            if (value > 0 && field.get_result() != std::to_string(value)) {
+                field.set_result(std::to_string(value));
+            }
+        } else if (child->is_composite()) {
+            set_page_fields(static_cast<const CompositeNode&>(*child), page, section_pages,
+                            total);
+        }
+    }
+}
+
+}  // namespace
+
+int Document::update_pagination() {
+    // Paragraphs DocumentBuilder wrote to the XML reach the DOM on sync
+    const bool builder_edits = !dirty_xml_paragraphs_.empty();
+    if (builder_edits) {
+        sync_sections_to_physical();
+    }
+    if (!pagination_) {
+        pagination_ = std::make_unique<PaginationState>();
+    }
+
+    // Pair each section with its previous layout; the workers only read the DOM
+    std::unordered_map<const Section*, SectionLayout> previous;
+    for (auto& layout : pagination_->sections) {
+        const Section* section = layout.section;
+        previous.emplace(section, std::move(layout));
+    }
+    std::vector<SectionJob> jobs;
+    const auto sections = get_sections();
+    for (const auto& section : sections) {
+        SectionJob job;
+        job.body = section->get_body();
+        auto it = previous.find(section.get());
+        if (it != previous.end()) {
+            job.layout = std::move(it->second);
+        }
+        job.layout.section = section.get();
+        set_geometry(section->get_properties(), job.layout);
+        jobs.push_back(std::move(job));
+    }
+
+    const BaseFormat defaults = read_document_defaults(get_styles());
+    const StyleCollection& style_collection = styles();
+    const std::string normal = default_paragraph_style(style_collection);
+    const double tab_stop = get_default_tab_stop();
+
+    // Sections start on new pages, so each one is laid out on its own
+    std::atomic<size_t> next_job{0};
+    const auto worker = [&]() {
+        StyleFormats formats(style_collection, defaults, normal);
+        FontSet fonts;
+        for (size_t i = next_job++; i < jobs.size(); i = next_job++) {
+            SectionJob& job = jobs[i];
+            ParagraphMeasurer measurer(formats, fonts, tab_stop, job.layout.measured);
+            if (job.body) {
+                layout_section(*job.body, measurer, job.layout);
+            } else {
+                job.layout.measured.clear();
+                job.layout.blocks.clear();
+                job.layout.before.clear();
+                job.layout.first_page.clear();
+                job.layout.page_count = 1;
+            }
+        }
+    };
+    size_t threads = load_config_.max_threads > 0 ? load_config_.max_threads
+                                                  : std::thread::hardware_concurrency();
+    threads = std::min(std::max<size_t>(threads, 1), jobs.size());
+    if (threads <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(threads);
+        for (size_t t = 0; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+
+    // Page numbers continue from section to section
+    PaginationState& state = *pagination_;
+    state.sections.clear();
+    state.block_pages.clear();
+    int first_page = 1;
+    for (auto& job : jobs) {
+        const SectionLayout& layout = job.layout;
+        for (size_t i = 0; i < layout.blocks.size(); ++i) {
+            state.block_pages[layout.blocks[i].node] = first_page + layout.first_page[i];
+        }
+        first_page += layout.page_count;
+    }
+    state.page_count = first_page - 1;
+    builtin_properties_.total_pages = state.page_count;
+
+    for (size_t s = 0; s < jobs.size(); ++s) {
+        const int section_pages = jobs[s].layout.page_count;
+        if (jobs[s].body) {
+            for (const auto& child : jobs[s].body->get_children()) {
+                if (child->is_composite()) {
+                    auto it = state.block_pages.find(child.get());
+                    set_page_fields(static_cast<const CompositeNode&>(*child),
+                                    it != state.block_pages.end() ? it->second : 0,
+                                    section_pages, state.page_count);
+                }
+            }
+        }
+        // Headers and footers repeat on every page; only the counts are fixed
+        for (const auto& part : sections[s]->get_all_headers()) {
+            set_page_fields(*part, 0, section_pages, state.page_count);
+        }
+        for (const auto& part : sections[s]->get_all_footers()) {
+            set_page_fields(*part, 0, section_pages, state.page_count);
+        }
+        state.sections.push_back(std::move(jobs[s].layout));
+    }
+
+    // Keep the XML in step so DocumentBuilder can go on writing
+    if (builder_edits) {
+        sync_sections_to_physical();
+    }
+    return state.page_count;
+}
+
+int Document::get_page_count() const {
+    return pagination_ ? pagination_->page_count : 0;
+}
+
+int Document::get_page_number(const Node& node) const {
+    if (!pagination_) {
+        return 0;
+    }
+    // Nodes inside a paragraph or table are on the page where their block starts
+    const Node* block = &node;
+    while (block->get_parent() && block->get_parent()->node_type() != NodeType::Body) {
+        block = block->get_parent();
+    }
+    auto it = pagination_->block_pages.find(block);
+    return it != pagination_->block_pages.end() ? it->second : 0;
+}
+
+}  // namespace cdocx
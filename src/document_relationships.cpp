@@ -7,6 +7,7 @@
 #include <cdocx/document.h>
 
 #include <algorithm>
+#include <cstdlib>
 #include <vector>
 
 namespace cdocx {
@@ -99,11 +100,11 @@ std::string Document::add_relationship(const std::string& rels_path,
                                        const std::string& type,
                                        const std::string& target,
                                        const std::string& target_mode) {
-    // Find next available rId
-    int max_id = 0;
+    // Find next available rId; ids that are not "rId<n>" are ignored
+    long max_id = 0;
     for (const auto& rel : relationships_[rels_path]) {
-        if (rel.id.substr(0, 3) == "rId") {
-            const int id = std::stoi(rel.id.substr(3));
+        if (rel.id.compare(0, 3, "rId") == 0) {
+            const long id = std::strtol(rel.id.c_str() + 3, nullptr, 10);
             max_id = std::max(max_id, id);
         }
     }
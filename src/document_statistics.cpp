@@ -0,0 +1,130 @@
+/**
+ * @file document_statistics.cpp
+ * @brief Word, character, paragraph and line counting for Document class
+ */
+
+#include <cdocx/body.h>
+#include <cdocx/control_char.h>
+#include <cdocx/document.h>
+#include <cdocx/paragraph.h>
+#include <cdocx/section.h>
+#include <cdocx/statistics.h>
+
+#include <cstdint>
+
+#include "sync_common.h"
+
+namespace cdocx {
+
+namespace {
+
+bool is_space(std::uint32_t cp) {
+    return cp == ' ' || cp == '\t' || cp == 0x00A0 || cp == 0x1680 ||
+           (cp >= 0x2000 && cp <= 0x200A) || cp == 0x202F || cp == 0x205F || cp == 0x3000;
+}
+
+/// Han ideographs and kana; Word counts each of them as a word
+bool is_east_asian_word(std::uint32_t cp) {
+    return (cp >= 0x3040 && cp <= 0x30FF) ||  // Hiragana, Katakana
+           (cp >= 0x31F0 && cp <= 0x31FF) ||  // Katakana phonetic extensions
+           (cp >= 0x3400 && cp <= 0x4DBF) ||  // CJK extension A
+           (cp >= 0x4E00 && cp <= 0x9FFF) ||  // CJK unified ideographs
+           (cp >= 0xF900 && cp <= 0xFAFF) ||  // CJK compatibility ideographs
+           (cp >= 0xFF66 && cp <= 0xFF9D) ||  // Halfwidth katakana
+           (cp >= 0x20000 && cp <= 0x3FFFF);  // CJK extensions B and later
+}
+
+}  // namespace
+
+DocumentStatistics count_text_statistics(std::string_view text) {
+    DocumentStatistics stats;
+    int line_breaks = 0;
+    bool in_word = false;
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        // ASCII needs no decoding; it is most of the text in most documents
+        const auto byte = static_cast<unsigned char>(text[pos]);
+        const std::uint32_t cp = byte < 0x80 ? text[pos++] : next_code_point(text, pos);
+
+        if (is_space(cp)) {
+            ++stats.characters_with_spaces;
+            in_word = false;
+        } else if (cp < 0x20) {
+            if (cp == ControlChar::kLineBreakChar || cp == ControlChar::kLineFeedChar ||
+                cp == ControlChar::kParagraphBreakChar) {
+                ++line_breaks;
+            }
+            in_word = false;
+        } else if (is_east_asian_word(cp)) {
+            ++stats.words;
+            ++stats.characters;
+            ++stats.characters_with_spaces;
+            in_word = false;
+        } else {
+            if (!in_word) {
+                ++stats.words;
+                in_word = true;
+            }
+            ++stats.characters;
+            ++stats.characters_with_spaces;
+        }
+    }
+
+    if (stats.characters_with_spaces > 0) {
+        stats.paragraphs = 1;
+        stats.lines = 1 + line_breaks;
+    }
+    return stats;
+}
+
+// ============================================================================
+// Document Statistics
+// ============================================================================
+
+void Document::count_statistics(const CompositeNode& node,
+                                StatisticsCache& counted,
+                                DocumentStatistics& total) {
+    for (const auto& child : node.get_children()) {
+        if (child->node_type() == NodeType::Paragraph) {
+            const auto* para = static_cast<const Paragraph*>(child.get());
+            const std::uint64_t version = para->get_content_version();
+            CountedParagraph& entry = counted[para];
+            auto it = statistics_cache_.find(para);
+            // A paragraph without DOM children reads its text straight from the XML,
+            // which does not bump the version; those are cheap to recount
+            if (it != statistics_cache_.end() && it->second.version == version &&
+                para->has_children()) {
+                entry = it->second;
+            } else {
+                entry = {version, count_text_statistics(para->get_text())};
+            }
+            total += entry.counts;
+        } else if (child->is_composite()) {
+            count_statistics(static_cast<const CompositeNode&>(*child), counted, total);
+        }
+    }
+}
+
+const DocumentStatistics& Document::update_statistics() {
+    // Paragraphs that are gone drop out of the cache because only visited ones are kept
+    StatisticsCache counted;
+    counted.reserve(statistics_cache_.size());
+    DocumentStatistics total;
+    for (const auto& section : get_sections()) {
+        if (auto body = section->get_body()) {
+            count_statistics(*body, counted, total);
+        }
+    }
+    statistics_cache_.swap(counted);
+    statistics_ = total;
+
+    builtin_properties_.total_words = total.words;
+    builtin_properties_.total_chars = total.characters;
+    builtin_properties_.total_chars_with_spaces = total.characters_with_spaces;
+    builtin_properties_.total_paragraphs = total.paragraphs;
+    builtin_properties_.total_lines = total.lines;
+    return statistics_;
+}
+
+}  // namespace cdocx
@@ -0,0 +1,585 @@
+/**
+ * @file document_toc.cpp
+ * @brief Table of contents generation for Document class
+ */
+
+#include <cdocx/body.h>
+#include <cdocx/document.h>
+#include <cdocx/paragraph.h>
+#include <cdocx/section.h>
+#include <cdocx/style.h>
+#include <cdocx/table_of_contents.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "sync_common.h"
+
+namespace cdocx {
+
+namespace {
+
+constexpr int kMaxTocLevel = 9;
+
+// Word names its heading bookmarks _Toc followed by nine digits
+constexpr int kTocBookmarkBase = 100000000;
+
+/// What the switches of a TOC field ask for
+struct TocSwitches {
+    int min_level = 1;
+    int max_level = kMaxTocLevel;
+    bool hyperlinks = false;
+};
+
+TocSwitches parse_toc_switches(const std::string& code) {
+    TocSwitches switches;
+    const size_t levels = code.find("\\o");
+    if (levels != std::string::npos) {
+        int first = 0;
+        int last = 0;
+        if (std::sscanf(code.c_str() + levels + 2, " \"%d-%d\"", &first, &last) == 2 &&
+            first >= 1 && first <= last && last <= kMaxTocLevel) {
+            switches.min_level = first;
+            switches.max_level = last;
+        }
+    }
+    switches.hyperlinks = code.find("\\h") != std::string::npos;
+    return switches;
+}
+
+/// A TOC field of a section body and the paragraph holding its code
+struct TocBlock {
+    std::shared_ptr<Paragraph> paragraph;
+    std::shared_ptr<Field> field;
+    TocSwitches switches;
+};
+
+bool is_field_end(const Node& node) {
+    return node.node_type() == NodeType::SpecialChar &&
+           static_cast<const SpecialChar&>(node).get_char() == 0x0015;
+}
+
+bool has_field_end(const Paragraph& para) {
+    const auto& children = para.get_children();
+    return std::any_of(children.begin(), children.end(), [](const std::shared_ptr<Node>& child) {
+        return is_field_end(*child);
+    });
+}
+
+/// Collects the TOC fields of @p body and the paragraphs of their current results
+void find_toc_blocks(const CompositeNode& body,
+                     std::vector<TocBlock>& blocks,
+                     std::unordered_set<const Node*>& results) {
+    const auto& children = body.get_children();
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (children[i]->node_type() != NodeType::Paragraph) {
+            continue;
+        }
+        auto para = std::static_pointer_cast<Paragraph>(children[i]);
+        for (const auto& child : para->get_children()) {
+            auto field = std::dynamic_pointer_cast<Field>(child);
+            if (!field || child->node_type() != NodeType::FieldStart ||
+                !iequals(field->get_field_code(), "TOC")) {
+                continue;
+            }
+            blocks.push_back({para, field, parse_toc_switches(field->get_full_field_code())});
+            if (!field->spans_paragraphs()) {
+                continue;
+            }
+            for (size_t j = i + 1; j < children.size(); ++j) {
+                if (children[j]->node_type() == NodeType::Paragraph &&
+                    has_field_end(static_cast<const Paragraph&>(*children[j]))) {
+                    break;
+                }
+                results.insert(children[j].get());
+            }
+        }
+    }
+}
+
+/// Outline levels of paragraph styles, resolved through basedOn once per style
+class StyleOutlineLevels {
+  public:
+    explicit StyleOutlineLevels(const StyleCollection& styles) : styles_(styles) {}
+
+    OutlineLevel get(const std::string& style_id) {
+        if (style_id.empty()) {
+            return OutlineLevel::BodyText;
+        }
+        auto it = levels_.find(style_id);
+        if (it != levels_.end()) {
+            return it->second;
+        }
+        // Cache the placeholder first so a basedOn cycle ends here
+        levels_.emplace(style_id, OutlineLevel::BodyText);
+        OutlineLevel level = OutlineLevel::BodyText;
+        if (auto style = styles_.get_by_style_id(style_id)) {
+            level = style->get_paragraph_format().outline_level;
+            if (level == OutlineLevel::BodyText) {
+                level = get(style->get_base_style_name());
+            }
+        }
+        levels_[style_id] = level;
+        return level;
+    }
+
+  private:
+    const StyleCollection& styles_;
+    std::unordered_map<std::string, OutlineLevel> levels_;
+};
+
+std::string to_roman(size_t value, bool upper) {
+    static const struct {
+        size_t value;
+        const char* digits;
+    } kNumerals[] = {{1000, "m"},
+                     {900, "cm"},
+                     {500, "d"},
+                     {400, "cd"},
+                     {100, "c"},
+                     {90, "xc"},
+                     {50, "l"},
+                     {40, "xl"},
+                     {10, "x"},
+                     {9, "ix"},
+                     {5, "v"},
+                     {4, "iv"},
+                     {1, "i"}};
+    std::string result;
+    for (const auto& numeral : kNumerals) {
+        for (; value >= numeral.value; value -= numeral.value) {
+            result += numeral.digits;
+        }
+    }
+    if (upper) {
+        std::transform(result.begin(), result.end(), result.begin(), [](char c) {
+            return static_cast<char>(c - 'a' + 'A');
+        });
+    }
+    return result;
+}
+
+std::string to_chinese_counting(size_t value) {
+    static const char* const kDigits[] = {
+        "", "一", "二", "三", "四", "五", "六", "七", "八", "九"};
+    if (value == 0 || value > 99) {
+        return std::to_string(value);
+    }
+    std::string result;
+    if (value >= 10) {
+        result += value >= 20 ? kDigits[value / 10] : "";
+        result += "十";
+    }
+    return result + kDigits[value % 10];
+}
+
+/// @p value as shown by a list level of @p style; styles without a rule use digits
+std::string format_list_number(size_t value, NumberStyle style) {
+    switch (style) {
+        case NumberStyle::UpperRoman:
+        case NumberStyle::LowerRoman:
+            return value == 0 ? "0" : to_roman(value, style == NumberStyle::UpperRoman);
+        case NumberStyle::UpperLetter:
+        case NumberStyle::LowerLetter: {
+            if (value == 0) {
+                return "0";
+            }
+            // a..z, then aa..zz and so on, as Word counts
+            const char letter = static_cast<char>(
+                (style == NumberStyle::UpperLetter ? 'A' : 'a') + (value - 1) % 26);
+            return std::string((value - 1) / 26 + 1, letter);
+        }
+        case NumberStyle::ChineseCounting:
+            return to_chinese_counting(value);
+        default:
+            return std::to_string(value);
+    }
+}
+
+/// List labels of the paragraphs in document order
+class ListLabeler {
+  public:
+    explicit ListLabeler(const NumberingManager* manager) : manager_(manager) {}
+
+    /// Counts the next item of @p format's list and returns its label, empty for bullets
+    std::string next(const ListFormat& format) {
+        const auto* def = manager_ ? manager_->get_numbering_definition(format.list_id) : nullptr;
+        const auto* abstract_def = def ? manager_->get_abstract_definition(def->abstract_id)
+                                       : nullptr;
+        if (!abstract_def) {
+            return {};
+        }
+
+        auto level_def = [&](size_t level) -> const LevelDefinition& {
+            auto it = def->level_overrides.find(static_cast<NumberingLevel>(level));
+            return it != def->level_overrides.end() ? it->second : abstract_def->levels[level];
+        };
+        auto start = [&](size_t level) {
+            auto it = def->start_overrides.find(static_cast<NumberingLevel>(level));
+            return it != def->start_overrides.end() ? it->second : level_def(level).start_number;
+        };
+
+        const size_t level = std::min<size_t>(static_cast<size_t>(format.level), 8);
+        Counters& counters = lists_[format.list_id];
+        counters.values[level] =
+            counters.started[level] ? counters.values[level] + 1 : start(level);
+        counters.started[level] = true;
+        std::fill(counters.started.begin() + level + 1, counters.started.end(), false);
+
+        const LevelDefinition& current = level_def(level);
+        if (current.number_style == NumberStyle::Bullet) {
+            return {};
+        }
+        const std::string& pattern =
+            current.level_text.empty() ? current.number_format : current.level_text;
+        std::string label;
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (pattern[i] == '%' && i + 1 < pattern.size() && pattern[i + 1] >= '1' &&
+                pattern[i + 1] <= '9') {
+                const auto ref = static_cast<size_t>(pattern[++i] - '1');
+                const size_t value = counters.started[ref] ? counters.values[ref] : start(ref);
+                label += format_list_number(value, level_def(ref).number_style);
+            } else {
+                label += pattern[i];
+            }
+        }
+        return label;
+    }
+
+  private:
+    struct Counters {
+        std::array<size_t, 9> values{};
+        std::array<bool, 9> started{};
+    };
+
+    const NumberingManager* manager_;
+    std::unordered_map<NumberingId, Counters> lists_;
+};
+
+/// Paragraph text on one line: tabs and breaks become spaces, outer spaces are trimmed
+std::string heading_text(const Paragraph& para) {
+    std::string text = para.get_text();
+    std::replace_if(
+        text.begin(), text.end(), [](char c) { return static_cast<unsigned char>(c) < 0x20; }, ' ');
+    const size_t first = text.find_first_not_of(' ');
+    if (first == std::string::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(' ') - first + 1);
+}
+
+struct Heading {
+    Paragraph* paragraph = nullptr;
+    TocEntry entry;
+};
+
+/// State of the single pass over the body paragraphs
+struct HeadingScan {
+    StyleOutlineLevels& outline_levels;
+    ListLabeler& labels;
+    const std::unordered_set<const Node*>& skipped;
+    std::vector<Heading> headings;
+    std::unordered_set<std::string> bookmark_names;
+    int max_bookmark_id = 0;
+};
+
+void scan_paragraph(Paragraph& para, HeadingScan& scan) {
+    std::string toc_bookmark;
+    for (const auto& child : para.get_children()) {
+        if (child->node_type() == NodeType::BookmarkStart) {
+            const auto& bookmark = static_cast<const BookmarkStart&>(*child);
+            const std::string name = bookmark.get_name();
+            if (toc_bookmark.empty() && name.compare(0, 4, "_Toc") == 0) {
+                toc_bookmark = name;
+            }
+            scan.max_bookmark_id = std::max(scan.max_bookmark_id, bookmark.get_id());
+            scan.bookmark_names.insert(name);
+        }
+    }
+
+    // List items advance their list even when they are not headings
+    std::string label;
+    if (para.get_list_format().is_list_item()) {
+        label = scan.labels.next(para.get_list_format());
+    }
+
+    const ParagraphFormat& format = para.get_paragraph_format();
+    OutlineLevel level = format.outline_level;
+    if (level == OutlineLevel::BodyText) {
+        level = scan.outline_levels.get(format.style_name);
+    }
+    if (level == OutlineLevel::BodyText) {
+        return;
+    }
+
+    Heading heading;
+    heading.paragraph = &para;
+    heading.entry.level = static_cast<int>(level) + 1;
+    heading.entry.label = std::move(label);
+    heading.entry.text = heading_text(para);
+    heading.entry.bookmark = std::move(toc_bookmark);
+    if (!heading.entry.text.empty()) {
+        scan.headings.push_back(std::move(heading));
+    }
+}
+
+void scan_headings(const CompositeNode& node, HeadingScan& scan) {
+    for (const auto& child : node.get_children()) {
+        if (scan.skipped.count(child.get()) > 0) {
+            continue;
+        }
+        if (child->node_type() == NodeType::Paragraph) {
+            scan_paragraph(static_cast<Paragraph&>(*child), scan);
+        } else if (child->is_composite()) {
+            scan_headings(static_cast<const CompositeNode&>(*child), scan);
+        }
+    }
+}
+
+/// Style ID of the TOC style for @p level, adding Word's built-in style when missing
+std::string ensure_toc_style(Document& doc, int level) {
+    const std::string style_id = "TOC" + std::to_string(level);
+    const std::string name = "toc " + std::to_string(level);
+    auto& styles = doc.styles();
+    if (auto style = styles.get_by_style_id(style_id)) {
+        return style_id;
+    }
+    if (auto style = styles.get_by_name(name)) {
+        return style->get_style_id();
+    }
+
+    // Page numbers go to a dotted right tab at the right margin
+    int tab_position = 9350;
+    if (auto section = doc.get_first_section()) {
+        const auto& props = section->get_properties();
+        tab_position =
+            props.page_size.width - props.page_margins.left - props.page_margins.right;
+    }
+    pugi::xml_document xml;
+    auto style_xml = xml.append_child("w:style");
+    style_xml.append_attribute("w:type").set_value("paragraph");
+    style_xml.append_attribute("w:styleId").set_value(style_id.c_str());
+    auto tab = style_xml.append_child("w:pPr").append_child("w:tabs").append_child("w:tab");
+    tab.append_attribute("w:val").set_value("right");
+    tab.append_attribute("w:leader").set_value("dot");
+    tab.append_attribute("w:pos").set_value(tab_position);
+
+    auto style = std::make_shared<Style>(&doc, StyleType::Paragraph);
+    style->set_style_id(style_id);
+    style->set_name(name);
+    style->set_style_identifier(static_cast<StyleIdentifier>(
+        static_cast<int>(StyleIdentifier::Toc1) + level - 1));
+    style->set_is_built_in(true);
+    style->set_base_style_name("Normal");
+    style->get_paragraph_format().left_indent = 11.0 * (level - 1);
+    style->get_paragraph_format().space_after = 5;
+    style->preserve_style_xml(style_xml);
+    styles.add(style);
+    return style_id;
+}
+
+std::string toc_bookmark_name(int id) {
+    return "_Toc" + std::to_string(kTocBookmarkBase + id);
+}
+
+std::string entry_text(const TocEntry& entry) {
+    std::string text = entry.label.empty() ? entry.text : entry.label + ' ' + entry.text;
+    if (entry.page > 0) {
+        text += '\t' + std::to_string(entry.page);
+    }
+    return text;
+}
+
+/// Identifies an entry paragraph so unchanged entries can be kept
+std::string entry_key(const Paragraph& para) {
+    std::string anchor;
+    if (auto link = para.get_first_child<Hyperlink>()) {
+        anchor = link->get_bookmark_name();
+    }
+    return para.get_paragraph_format().style_name + '\n' + anchor + '\n' + para.get_text();
+}
+
+/// Replaces the result of @p block with one paragraph per entry in its level range
+void fill_toc_block(Document& doc, const TocBlock& block, const std::vector<TocEntry>& entries) {
+    auto* body = block.paragraph->get_parent();
+    Paragraph& start = *block.paragraph;
+    const int field_index = start.index_of(block.field);
+
+    // A field with its result inline becomes one spanning paragraphs; whatever
+    // follows it moves behind the field end
+    std::vector<std::shared_ptr<Node>> trailing;
+    for (size_t i = static_cast<size_t>(field_index) + 1; i < start.get_child_count(); ++i) {
+        trailing.push_back(start.get_child(i));
+    }
+    for (const auto& node : trailing) {
+        start.remove_child(node);
+    }
+
+    std::shared_ptr<Paragraph> end;
+    std::vector<std::shared_ptr<Node>> old_entries;
+    if (block.field->spans_paragraphs()) {
+        for (int i = body->index_of(block.paragraph) + 1;
+             i < static_cast<int>(body->get_child_count()); ++i) {
+            auto node = body->get_child(i);
+            if (node->node_type() == NodeType::Paragraph &&
+                has_field_end(static_cast<const Paragraph&>(*node))) {
+                end = std::static_pointer_cast<Paragraph>(node);
+                break;
+            }
+            old_entries.push_back(node);
+        }
+        if (end) {
+            // The old result: what followed the code and what precedes the end
+            trailing.clear();
+            while (end->get_child_count() > 0 && !is_field_end(*end->get_first_child())) {
+                end->remove_child(0);
+            }
+        } else {
+            // Without its end the extent of the old result is unknown; leave it alone
+            old_entries.clear();
+        }
+    }
+    if (!end) {
+        end = std::make_shared<Paragraph>(&doc);
+        end->append_child(SpecialChar::field_end());
+        for (const auto& node : trailing) {
+            end->append_child(node);
+        }
+        body->insert_child(body->index_of(block.paragraph) + 1, end);
+    }
+    block.field->set_spans_paragraphs(true);
+    block.field->set_result("");
+
+    // Keep the old entry paragraphs that are still current, in order
+    std::vector<std::pair<const TocEntry*, std::string>> wanted;
+    for (const auto& entry : entries) {
+        if (entry.level >= block.switches.min_level && entry.level <= block.switches.max_level) {
+            wanted.emplace_back(&entry, "");
+        }
+    }
+    std::vector<bool> kept(wanted.size(), false);
+    std::array<std::string, kMaxTocLevel> style_ids;
+    for (size_t i = 0; i < wanted.size(); ++i) {
+        auto& style_id = style_ids[static_cast<size_t>(wanted[i].first->level - 1)];
+        if (style_id.empty()) {
+            style_id = ensure_toc_style(doc, wanted[i].first->level);
+        }
+        wanted[i].second = style_id;
+        if (i < old_entries.size() && old_entries[i]->node_type() == NodeType::Paragraph) {
+            const std::string anchor =
+                block.switches.hyperlinks ? wanted[i].first->bookmark : std::string();
+            kept[i] = entry_key(static_cast<const Paragraph&>(*old_entries[i])) ==
+                      style_id + '\n' + anchor + '\n' + entry_text(*wanted[i].first);
+        }
+    }
+    for (size_t i = 0; i < old_entries.size(); ++i) {
+        if (i >= kept.size() || !kept[i]) {
+            body->remove_child(old_entries[i]);
+        }
+    }
+
+    int position = body->index_of(block.paragraph) + 1;
+    for (size_t i = 0; i < wanted.size(); ++i, ++position) {
+        if (kept[i]) {
+            continue;
+        }
+        const TocEntry& entry = *wanted[i].first;
+        auto para = std::make_shared<Paragraph>(&doc);
+        para->get_paragraph_format().style_name = wanted[i].second;
+        if (block.switches.hyperlinks) {
+            para->append_hyperlink(entry_text(entry), entry.bookmark, true);
+        } else {
+            para->append_run(entry_text(entry));
+        }
+        body->insert_child(position, para);
+    }
+}
+
+}  // namespace
+
+int Document::update_table_of_contents() {
+    // Paragraphs DocumentBuilder wrote to the XML reach the DOM on sync
+    const bool builder_edits = !dirty_xml_paragraphs_.empty();
+    if (builder_edits) {
+        sync_sections_to_physical();
+    }
+
+    std::vector<TocBlock> blocks;
+    std::unordered_set<const Node*> results;
+    for (const auto& section : get_sections()) {
+        if (auto body = section->get_body()) {
+            find_toc_blocks(*body, blocks, results);
+        }
+    }
+
+    StyleOutlineLevels outline_levels(styles());
+    ListLabeler labels(numbering_manager_.get());
+    HeadingScan scan{outline_levels, labels, results, {}, {}, 0};
+    for (const auto& section : get_sections()) {
+        if (auto body = section->get_body()) {
+            scan_headings(*body, scan);
+        }
+    }
+
+    // Bookmark the listed headings that have no _Toc bookmark yet
+    int min_level = kMaxTocLevel + 1;
+    int max_level = 0;
+    for (const auto& block : blocks) {
+        min_level = std::min(min_level, block.switches.min_level);
+        max_level = std::max(max_level, block.switches.max_level);
+    }
+    int bookmark_id = std::max(next_bookmark_id_, scan.max_bookmark_id + 1);
+    toc_entries_.clear();
+    toc_entries_.reserve(scan.headings.size());
+    for (auto& heading : scan.headings) {
+        TocEntry& entry = heading.entry;
+        if (entry.bookmark.empty() && entry.level >= min_level && entry.level <= max_level) {
+            entry.bookmark = toc_bookmark_name(bookmark_id);
+            while (scan.bookmark_names.count(entry.bookmark) > 0) {
+                entry.bookmark = toc_bookmark_name(++bookmark_id);
+            }
+            auto bookmark_start = std::make_shared<BookmarkStart>(entry.bookmark, bookmark_id);
+            heading.paragraph->prepend_child(bookmark_start);
+            heading.paragraph->append_child(std::make_shared<BookmarkEnd>(bookmark_id));
+            next_bookmark_id_ = ++bookmark_id;
+        }
+        toc_entries_.push_back(std::move(entry));
+    }
+
+    // Page numbers come from the pagination estimate once the document has been
+    // paginated; the entries themselves may move the headings, so check again after
+    const bool paginated = pagination_ != nullptr;
+    if (paginated) {
+        for (size_t i = 0; i < toc_entries_.size(); ++i) {
+            toc_entries_[i].page = get_page_number(*scan.headings[i].paragraph);
+        }
+    }
+    for (const auto& block : blocks) {
+        fill_toc_block(*this, block, toc_entries_);
+    }
+    if (paginated && !blocks.empty()) {
+        update_pagination();
+        bool moved = false;
+        for (size_t i = 0; i < toc_entries_.size(); ++i) {
+            const int page = get_page_number(*scan.headings[i].paragraph);
+            moved = moved || page != toc_entries_[i].page;
+            toc_entries_[i].page = page;
+        }
+        if (moved) {
+            for (const auto& block : blocks) {
+                fill_toc_block(*this, block, toc_entries_);
+            }
+        }
+    }
+
+    // Keep the XML in step so DocumentBuilder can go on writing after the entries
+    if (builder_edits) {
+        sync_sections_to_physical();
+    }
+    return static_cast<int>(blocks.size());
+}
+
+}  // namespace cdocx
@@ -9,8 +9,10 @@
 
 #include <cstring>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 
+#include "compound_file.h"
 #include "sync_common.h"
 
 namespace cdocx {
@@ -214,6 +216,20 @@ std::shared_ptr<FileFormatInfo> FileFormatUtil::detect_file_format(std::istream&
         return info;
     }
 
+    // Compound file: Word stores password-protected packages in one
+    // (the content types are encrypted too, so it is reported as Docx)
+    if (is_compound_file({reinterpret_cast<const char*>(buffer.data()), buffer.size()})) {
+        std::string file_data(std::istreambuf_iterator<char>(stream), {});
+        stream.clear();
+        stream.seekg(start_pos);
+        CompoundFileReader reader;
+        if (reader.open(file_data) && reader.has_stream("EncryptedPackage")) {
+            info->set_load_format(LoadFormat::Docx);
+            info->set_is_encrypted(true);
+        }
+        return info;
+    }
+
     // RTF
     if (starts_with_string(buffer, "{\\rtf")) {
         info->set_load_format(LoadFormat::Rtf);
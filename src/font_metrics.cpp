@@ -0,0 +1,560 @@
+/**
+ * @file font_metrics.cpp
+ * @brief TrueType/OpenType metrics tables and the process-wide font cache
+ * @internal Not part of the public API.
+ */
+
+#include "font_metrics.h"
+
+#include <cdocx/pagination.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+
+#include "mapped_file.h"
+
+namespace cdocx {
+
+namespace {
+
+// ============================================================================
+// sfnt reading
+// ============================================================================
+
+/// Bounds-checked big-endian reads; out-of-range reads yield 0
+class FontData {
+  public:
+    explicit FontData(std::string_view data) : data_(data) {}
+
+    size_t size() const { return data_.size(); }
+
+    std::uint16_t u16(size_t offset) const {
+        if (offset + 2 > data_.size()) {
+            return 0;
+        }
+        return static_cast<std::uint16_t>(byte(offset) << 8 | byte(offset + 1));
+    }
+
+    std::int16_t s16(size_t offset) const { return static_cast<std::int16_t>(u16(offset)); }
+
+    std::uint32_t u32(size_t offset) const {
+        return static_cast<std::uint32_t>(u16(offset)) << 16 | u16(offset + 2);
+    }
+
+    std::string_view bytes(size_t offset, size_t length) const {
+        if (offset > data_.size() || length > data_.size() - offset) {
+            return {};
+        }
+        return data_.substr(offset, length);
+    }
+
+  private:
+    unsigned byte(size_t offset) const { return static_cast<unsigned char>(data_[offset]); }
+
+    std::string_view data_;
+};
+
+constexpr std::uint32_t tag(const char (&name)[5]) {
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(name[0])) << 24 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(name[1])) << 16 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(name[2])) << 8 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(name[3]));
+}
+
+/// Offsets of the faces in a file: one for a plain font, several for a collection
+std::vector<size_t> face_offsets(const FontData& font) {
+    if (font.u32(0) != tag("ttcf")) {
+        return {0};
+    }
+    const std::uint32_t count = std::min<std::uint32_t>(font.u32(8), 256);
+    std::vector<size_t> offsets;
+    offsets.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        offsets.push_back(font.u32(12 + 4 * static_cast<size_t>(i)));
+    }
+    return offsets;
+}
+
+struct Table {
+    size_t offset = 0;
+    size_t length = 0;
+    explicit operator bool() const { return length > 0; }
+};
+
+Table find_table(const FontData& font, size_t face, std::uint32_t name) {
+    const std::uint16_t count = font.u16(face + 4);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t record = face + 12 + 16 * i;
+        if (font.u32(record) == name) {
+            Table table{font.u32(record + 8), font.u32(record + 12)};
+            if (table.offset + table.length > font.size()) {
+                return {};
+            }
+            return table;
+        }
+    }
+    return {};
+}
+
+void append_utf8(std::string& out, std::uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+/// Font names are matched case-insensitively on their ASCII letters
+std::string fold_name(std::string_view name) {
+    std::string folded(name);
+    for (char& c : folded) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return folded;
+}
+
+/// Family names (name IDs 1 and 16) of a face in every language it lists them in
+std::vector<std::string> family_names(const FontData& font, size_t face) {
+    std::vector<std::string> names;
+    const Table table = find_table(font, face, tag("name"));
+    if (!table) {
+        return names;
+    }
+    const std::uint16_t count = font.u16(table.offset + 2);
+    const size_t strings = table.offset + font.u16(table.offset + 4);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t record = table.offset + 6 + 12 * i;
+        const std::uint16_t platform = font.u16(record);
+        const std::uint16_t name_id = font.u16(record + 6);
+        if (name_id != 1 && name_id != 16) {
+            continue;
+        }
+        const std::string_view raw =
+            font.bytes(strings + font.u16(record + 10), font.u16(record + 8));
+        std::string name;
+        if (platform == 0 || platform == 3) {
+            // UTF-16BE
+            const FontData utf16(raw);
+            for (size_t pos = 0; pos + 1 < raw.size(); pos += 2) {
+                std::uint32_t cp = utf16.u16(pos);
+                if (cp >= 0xD800 && cp < 0xDC00 && pos + 3 < raw.size()) {
+                    pos += 2;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (utf16.u16(pos) - 0xDC00);
+                }
+                append_utf8(name, cp);
+            }
+        } else if (platform == 1) {
+            for (const char c : raw) {
+                if (static_cast<unsigned char>(c) < 0x80) {
+                    name += c;
+                }
+            }
+        }
+        if (!name.empty()) {
+            names.push_back(fold_name(name));
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+constexpr std::uint32_t kMaxCodePoint = 0x10FFFF;
+
+/**
+ * Reads the best Unicode cmap subtable: calls @p map_group(group) for each group of
+ * a format 12 subtable, clamped to the Unicode range, or @p map(code_point, glyph)
+ * for every mapping of a format 4 one
+ */
+template <typename Map, typename MapGroup>
+bool read_cmap(const FontData& font, size_t face, Map map, MapGroup map_group) {
+    const Table table = find_table(font, face, tag("cmap"));
+    if (!table) {
+        return false;
+    }
+    // Prefer the full-repertoire format 12 subtable, then the BMP format 4 one
+    size_t best = 0;
+    int best_rank = 0;
+    const std::uint16_t count = font.u16(table.offset + 2);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t record = table.offset + 4 + 8 * i;
+        const std::uint16_t platform = font.u16(record);
+        const std::uint16_t encoding = font.u16(record + 2);
+        const size_t subtable = table.offset + font.u32(record + 4);
+        const std::uint16_t format = font.u16(subtable);
+        const bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+        const int rank = !unicode ? 0 : format == 12 ? 2 : format == 4 ? 1 : 0;
+        if (rank > best_rank) {
+            best = subtable;
+            best_rank = rank;
+        }
+    }
+    if (best_rank == 2) {
+        const size_t groups =
+            std::min<size_t>(font.u32(best + 12), (font.size() - std::min(font.size(), best)) / 12);
+        for (size_t i = 0; i < groups; ++i) {
+            const size_t offset = best + 16 + 12 * i;
+            FontMetrics::CmapGroup group;
+            group.first = font.u32(offset);
+            group.last = std::min(font.u32(offset + 4), kMaxCodePoint);
+            group.glyph = font.u32(offset + 8);
+            if (group.first <= group.last) {
+                map_group(group);
+            }
+        }
+        return true;
+    }
+    if (best_rank == 1) {
+        const size_t segments = font.u16(best + 6) / 2;
+        const size_t ends = best + 14;
+        const size_t starts = ends + 2 * segments + 2;
+        const size_t deltas = starts + 2 * segments;
+        const size_t range_offsets = deltas + 2 * segments;
+        for (size_t i = 0; i < segments; ++i) {
+            const std::uint16_t first = font.u16(starts + 2 * i);
+            const std::uint16_t last = font.u16(ends + 2 * i);
+            const std::uint16_t delta = font.u16(deltas + 2 * i);
+            const size_t range_offset_at = range_offsets + 2 * i;
+            const std::uint16_t range_offset = font.u16(range_offset_at);
+            for (std::uint32_t cp = first; cp <= last && cp != 0xFFFF; ++cp) {
+                std::uint32_t glyph = 0;
+                if (range_offset == 0) {
+                    glyph = (cp + delta) & 0xFFFF;
+                } else {
+                    glyph = font.u16(range_offset_at + range_offset + 2 * (cp - first));
+                    if (glyph != 0) {
+                        glyph = (glyph + delta) & 0xFFFF;
+                    }
+                }
+                map(static_cast<std::uint32_t>(cp), glyph);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// Estimates
+// ============================================================================
+
+/// Rough advance in ems for characters without metrics (close to Times New Roman)
+double estimated_advance(std::uint32_t cp) {
+    if (cp == ' ' || cp == 0x00A0) {
+        return 0.25;
+    }
+    if (is_east_asian_wide(cp)) {
+        return 1.0;
+    }
+    if (cp >= 0x0300 && cp <= 0x036F) {
+        return 0;  // Combining marks
+    }
+    if ((cp >= 'A' && cp <= 'Z') || cp == 'm' || cp == 'w') {
+        return 0.7;
+    }
+    if (cp >= '0' && cp <= '9') {
+        return 0.5;
+    }
+    if (cp == 'i' || cp == 'j' || cp == 'l' || cp == '.' || cp == ',' || cp == ':' ||
+        cp == ';' || cp == '\'' || cp == '!' || cp == '|') {
+        return 0.28;
+    }
+    return 0.47;
+}
+
+std::vector<std::string> system_font_directories() {
+    std::vector<std::string> directories;
+    const auto from_env = [&](const char* name, const char* suffix) {
+        if (const char* value = std::getenv(name)) {
+            directories.push_back(std::string(value) + suffix);
+        }
+    };
+#ifdef _WIN32
+    from_env("WINDIR", "\\Fonts");
+    from_env("LOCALAPPDATA", "\\Microsoft\\Windows\\Fonts");
+#elif defined(__APPLE__)
+    directories.push_back("/System/Library/Fonts");
+    directories.push_back("/Library/Fonts");
+    from_env("HOME", "/Library/Fonts");
+#else
+    from_env("HOME", "/.local/share/fonts");
+    from_env("HOME", "/.fonts");
+    directories.push_back("/usr/local/share/fonts");
+    directories.push_back("/usr/share/fonts");
+#endif
+    return directories;
+}
+
+bool is_font_file(const std::filesystem::path& path) {
+    const std::string extension = fold_name(path.extension().string());
+    return extension == ".ttf" || extension == ".otf" || extension == ".ttc" ||
+           extension == ".otc";
+}
+
+}  // namespace
+
+bool is_east_asian_wide(std::uint32_t cp) {
+    return (cp >= 0x1100 && cp <= 0x115F) ||   // Hangul Jamo
+           (cp >= 0x2E80 && cp <= 0x303E) ||   // CJK radicals, punctuation
+           (cp >= 0x3040 && cp <= 0xA4CF) ||   // Kana, CJK ideographs, Yi
+           (cp >= 0xAC00 && cp <= 0xD7A3) ||   // Hangul syllables
+           (cp >= 0xF900 && cp <= 0xFAFF) ||   // CJK compatibility ideographs
+           (cp >= 0xFE30 && cp <= 0xFE4F) ||   // CJK compatibility forms
+           (cp >= 0xFF00 && cp <= 0xFF60) ||   // Fullwidth forms
+           (cp >= 0xFFE0 && cp <= 0xFFE6) ||   // Fullwidth signs
+           (cp >= 0x20000 && cp <= 0x3FFFD);  // CJK extensions B and later
+}
+
+// ============================================================================
+// FontMetrics
+// ============================================================================
+
+bool FontMetrics::load(const std::string& path, int face_index) {
+    MappedFile file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    const FontData font(file.data());
+    const std::vector<size_t> faces = face_offsets(font);
+    if (face_index < 0 || static_cast<size_t>(face_index) >= faces.size()) {
+        return false;
+    }
+    const size_t face = faces[static_cast<size_t>(face_index)];
+
+    const Table head = find_table(font, face, tag("head"));
+    const Table hhea = find_table(font, face, tag("hhea"));
+    const Table hmtx = find_table(font, face, tag("hmtx"));
+    if (!head || !hhea || !hmtx || font.u16(head.offset + 18) == 0) {
+        return false;
+    }
+    units_per_em_ = font.u16(head.offset + 18);
+
+    // Word spaces single lines by the Windows ascent and descent when the font has them
+    const Table os2 = find_table(font, face, tag("OS/2"));
+    double height = 0;
+    if (os2 && os2.length >= 78) {
+        height = font.u16(os2.offset + 74) + font.u16(os2.offset + 76);
+    }
+    if (height <= 0) {
+        height = font.s16(hhea.offset + 4) - font.s16(hhea.offset + 6) +
+                 font.s16(hhea.offset + 8);
+    }
+    line_height_ = height > 0 ? height / units_per_em_ : 1.15;
+
+    const std::uint16_t metric_count = font.u16(hhea.offset + 34);
+    if (metric_count == 0) {
+        return false;
+    }
+    const auto advance_of = [&](std::uint32_t glyph) {
+        const std::uint32_t index = std::min<std::uint32_t>(glyph, metric_count - 1u);
+        return font.u16(hmtx.offset + 4 * static_cast<size_t>(index));
+    };
+
+    bmp_advances_.assign(0x10000, kNoGlyph);
+    other_groups_.clear();
+    glyph_advances_.clear();
+    const auto set_bmp_advance = [&](std::uint32_t cp, std::uint32_t glyph) {
+        if (glyph != 0) {
+            bmp_advances_[cp] = std::min<std::uint16_t>(advance_of(glyph), kNoGlyph - 1);
+        }
+    };
+    std::vector<CmapGroup> groups;
+    const bool mapped = read_cmap(font, face, set_bmp_advance, [&](const CmapGroup& group) {
+        groups.push_back(group);
+    });
+    if (!mapped) {
+        bmp_advances_.clear();
+        return false;
+    }
+
+    // Groups are sorted and disjoint in valid fonts; where they overlap the first one wins,
+    // so each BMP code point is written once however the groups are laid out
+    std::stable_sort(groups.begin(), groups.end(),
+                     [](const CmapGroup& a, const CmapGroup& b) { return a.first < b.first; });
+    std::uint32_t next = 0;
+    for (const CmapGroup& group : groups) {
+        const std::uint32_t first = std::max(group.first, next);
+        const std::uint32_t last = std::min<std::uint32_t>(group.last, 0xFFFF);
+        for (std::uint32_t cp = first; cp <= last && first <= 0xFFFF; ++cp) {
+            set_bmp_advance(cp, group.glyph + (cp - group.first));
+        }
+        next = std::max(next, last + 1);
+        if (group.last >= 0x10000) {
+            CmapGroup other = group;
+            other.first = std::max<std::uint32_t>(group.first, 0x10000);
+            other.glyph = group.glyph + (other.first - group.first);
+            if (other_groups_.empty() || other.first > other_groups_.back().last) {
+                other_groups_.push_back(other);
+            } else if (other.last > other_groups_.back().last) {
+                other.glyph += other_groups_.back().last + 1 - other.first;
+                other.first = other_groups_.back().last + 1;
+                other_groups_.push_back(other);
+            }
+        }
+    }
+
+    // Supplementary characters are looked up through the groups, so only the
+    // advance of each glyph is stored rather than one entry per code point
+    if (!other_groups_.empty()) {
+        glyph_advances_.resize(metric_count);
+        for (std::uint32_t glyph = 0; glyph < metric_count; ++glyph) {
+            glyph_advances_[glyph] = std::min<std::uint16_t>(advance_of(glyph), kNoGlyph - 1);
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const FontMetrics> FontMetrics::fallback() {
+    static const auto metrics = std::make_shared<const FontMetrics>();
+    return metrics;
+}
+
+double FontMetrics::advance(std::uint32_t cp) const {
+    std::uint16_t advance = kNoGlyph;
+    if (cp < 0x10000) {
+        if (!bmp_advances_.empty()) {
+            advance = bmp_advances_[cp];
+        }
+    } else {
+        auto it = std::upper_bound(
+            other_groups_.begin(), other_groups_.end(), cp,
+            [](std::uint32_t code, const CmapGroup& group) { return code < group.first; });
+        if (it != other_groups_.begin() && cp <= (--it)->last) {
+            const std::uint64_t glyph = std::uint64_t{it->glyph} + (cp - it->first);
+            if (glyph != 0) {
+                advance = glyph_advances_[std::min<std::uint64_t>(glyph,
+                                                                  glyph_advances_.size() - 1)];
+            }
+        }
+    }
+    return advance == kNoGlyph ? estimated_advance(cp) : advance / units_per_em_;
+}
+
+// ============================================================================
+// FontCache
+// ============================================================================
+
+FontCache& FontCache::instance() {
+    static FontCache cache;
+    return cache;
+}
+
+void FontCache::add_directory(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directories_.push_back(path);
+    // Index again on the next lookup; faces loaded so far stay valid
+    ++generation_;
+    indexed_ = false;
+    faces_.clear();
+    loaded_.clear();
+}
+
+std::shared_ptr<const FontMetrics> FontCache::get(const std::string& family,
+                                                  bool bold,
+                                                  bool italic) {
+    const std::string name = fold_name(family);
+    auto key = std::make_tuple(name, bold, italic);
+    std::vector<Face> candidates;
+    std::uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = loaded_.find(key);
+        if (it != loaded_.end()) {
+            return it->second;
+        }
+        if (!indexed_) {
+            build_index();
+        }
+        auto faces = faces_.find(name);
+        if (faces != faces_.end()) {
+            candidates = faces->second;
+        }
+        generation = generation_;
+    }
+
+    // Faces are read without the lock so lookups of loaded fonts never wait on the disk;
+    // two threads may load the same face, and the first one to finish is kept
+    std::shared_ptr<const FontMetrics> metrics = FontMetrics::fallback();
+    if (!candidates.empty()) {
+        // Best style match first: both flags, then weight, then slant
+        const auto score = [&](const Face& face) {
+            return (face.bold == bold ? 2 : 0) + (face.italic == italic ? 1 : 0);
+        };
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [&](const Face& a, const Face& b) { return score(a) > score(b); });
+        for (const Face& face : candidates) {
+            auto loaded = std::make_shared<FontMetrics>();
+            if (loaded->load(face.path, face.index)) {
+                metrics = std::move(loaded);
+                break;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_) {
+        return metrics;  // Directories changed meanwhile; the next lookup uses the new index
+    }
+    return loaded_.emplace(std::move(key), std::move(metrics)).first->second;
+}
+
+void FontCache::build_index() {
+    indexed_ = true;
+    std::vector<std::string> directories = directories_;
+    for (auto& directory : system_font_directories()) {
+        directories.push_back(std::move(directory));
+    }
+    for (const auto& directory : directories) {
+        std::error_code error;
+        std::filesystem::recursive_directory_iterator it(
+            directory, std::filesystem::directory_options::skip_permission_denied, error);
+        for (; !error && it != std::filesystem::recursive_directory_iterator();
+             it.increment(error)) {
+            if (it->is_regular_file(error) && is_font_file(it->path())) {
+                index_file(it->path().string());
+            }
+        }
+    }
+}
+
+void FontCache::index_file(const std::string& path) {
+    MappedFile file(path);
+    if (!file.is_open()) {
+        return;
+    }
+    const FontData font(file.data());
+    const std::vector<size_t> faces = face_offsets(font);
+    for (size_t i = 0; i < faces.size(); ++i) {
+        const Table head = find_table(font, faces[i], tag("head"));
+        if (!head) {
+            continue;
+        }
+        const std::uint16_t mac_style = font.u16(head.offset + 44);
+        Face face{path, static_cast<int>(i), (mac_style & 1) != 0, (mac_style & 2) != 0};
+        for (const auto& name : family_names(font, faces[i])) {
+            // Directories added by the caller come first and win for the same style
+            faces_[name].push_back(face);
+        }
+    }
+}
+
+void add_font_directory(const std::string& path) {
+    FontCache::instance().add_directory(path);
+}
+
+}  // namespace cdocx
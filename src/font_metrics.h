@@ -0,0 +1,93 @@
+/**
+ * @file font_metrics.h
+ * @brief Internal glyph advance and line height tables read from TrueType/OpenType files
+ * @internal Not part of the public API.
+ * @details Fonts are looked up by family name in the font directories
+ *          (add_font_directory() ones first, then the system directories).
+ *          The directories are indexed once per process by reading only the
+ *          name and head tables of each file; a face is loaded the first time
+ *          it is asked for and its advance table is kept for the rest of the
+ *          process. Lookups are thread-safe and return shared, immutable
+ *          metrics, so layout threads can share them without locking.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace cdocx {
+
+/// True for the East Asian wide characters (Han, kana, Hangul, fullwidth forms)
+bool is_east_asian_wide(std::uint32_t cp);
+
+/// Advance widths and line height of one font face, in ems
+class FontMetrics {
+  public:
+    /// Loads face @p face_index of the font (or font collection) file at @p path
+    bool load(const std::string& path, int face_index);
+
+    /// Estimates used when no font file matches: Latin at about half an em, CJK at one em
+    static std::shared_ptr<const FontMetrics> fallback();
+
+    /// Advance of @p cp in ems; characters the font has no glyph for are estimated
+    double advance(std::uint32_t cp) const;
+
+    /// Distance between the baselines of single-spaced lines, in ems
+    double line_height() const { return line_height_; }
+
+    /// Code points first..last map to consecutive glyphs starting at glyph (cmap format 12)
+    struct CmapGroup {
+        std::uint32_t first = 0;
+        std::uint32_t last = 0;
+        std::uint32_t glyph = 0;
+    };
+
+  private:
+    static constexpr std::uint16_t kNoGlyph = 0xFFFF;
+
+    // Advance per BMP code point in font units (kNoGlyph when unmapped); empty for fallback
+    std::vector<std::uint16_t> bmp_advances_;
+    // Groups above the BMP, sorted, and the advance of each glyph they can reach
+    std::vector<CmapGroup> other_groups_;
+    std::vector<std::uint16_t> glyph_advances_;
+    double units_per_em_ = 1000;
+    double line_height_ = 1.15;
+};
+
+/// Process-wide index of the installed fonts and cache of the loaded faces
+class FontCache {
+  public:
+    static FontCache& instance();
+
+    void add_directory(const std::string& path);
+
+    /// Metrics of @p family in the given style; FontMetrics::fallback() when not installed
+    std::shared_ptr<const FontMetrics> get(const std::string& family, bool bold, bool italic);
+
+  private:
+    struct Face {
+        std::string path;
+        int index = 0;
+        bool bold = false;
+        bool italic = false;
+    };
+
+    void build_index();
+    void index_file(const std::string& path);
+
+    std::mutex mutex_;
+    std::uint64_t generation_ = 0;  // Bumped when the index is rebuilt; stale loads are not kept
+    std::vector<std::string> directories_;
+    bool indexed_ = false;
+    std::unordered_map<std::string, std::vector<Face>> faces_;  // Lower-case family name
+    std::map<std::tuple<std::string, bool, bool>, std::shared_ptr<const FontMetrics>> loaded_;
+};
+
+}  // namespace cdocx
@@ -24,6 +24,15 @@ Footnote::Footnote(Document* doc, FootnoteType type) : type_(type) {
     set_document(doc);
 }
 
+void Footnote::set_id(int id) {
+    const int old_id = id_;
+    id_ = id;
+    modified_ = true;
+    if (document_ && id != old_id) {
+        document_->rename_note(*this, old_id);
+    }
+}
+
 std::string Footnote::get_text() const {
     std::string result;
     for (const auto& child : get_children()) {
@@ -38,6 +47,7 @@ std::string Footnote::get_text() const {
 }
 
 void Footnote::set_text(const std::string& text) {
+    modified_ = true;
     remove_all_children();
 
     size_t start = 0;
@@ -83,6 +93,7 @@ std::shared_ptr<Node> Footnote::clone(bool deep) const {
 }
 
 std::shared_ptr<Paragraph> Footnote::append_paragraph(const std::string& text) {
+    modified_ = true;
     auto para = std::make_shared<Paragraph>();
     if (!text.empty()) {
         para->append_run(text);
@@ -167,13 +178,12 @@ std::shared_ptr<Footnote> FootnoteCollection::get(size_t index) const {
 }
 
 std::shared_ptr<Footnote> FootnoteCollection::get_by_id(int id) const {
-    collect_footnotes();
-    for (const auto& fn : footnotes_) {
-        if (fn->get_id() == id) {
-            return fn;
-        }
+    if (!doc_) {
+        return nullptr;
     }
-    return nullptr;
+    const auto& by_id = doc_->footnotes_index_.by_id;
+    auto it = by_id.find(id);
+    return it != by_id.end() ? it->second : nullptr;
 }
 
 bool FootnoteCollection::contains(int id) const {
@@ -190,9 +200,8 @@ std::shared_ptr<Footnote> FootnoteCollection::add(const std::string& text,
         return nullptr;
     }
     auto footnote = doc_->add_footnote(text, reference_mark);
-    if (footnote) {
-        collected_ = false;
-        collect_footnotes();
+    if (footnote && collected_) {
+        footnotes_.push_back(footnote);
     }
     return footnote;
 }
@@ -278,13 +287,12 @@ std::shared_ptr<Footnote> EndnoteCollection::get(size_t index) const {
 }
 
 std::shared_ptr<Footnote> EndnoteCollection::get_by_id(int id) const {
-    collect_endnotes();
-    for (const auto& en : endnotes_) {
-        if (en->get_id() == id) {
-            return en;
-        }
+    if (!doc_) {
+        return nullptr;
     }
-    return nullptr;
+    const auto& by_id = doc_->endnotes_index_.by_id;
+    auto it = by_id.find(id);
+    return it != by_id.end() ? it->second : nullptr;
 }
 
 bool EndnoteCollection::contains(int id) const {
@@ -301,9 +309,8 @@ std::shared_ptr<Footnote> EndnoteCollection::add(const std::string& text,
         return nullptr;
     }
     auto endnote = doc_->add_endnote(text, reference_mark);
-    if (endnote) {
-        collected_ = false;
-        collect_endnotes();
+    if (endnote && collected_) {
+        endnotes_.push_back(endnote);
     }
     return endnote;
 }
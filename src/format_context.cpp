@@ -10,11 +10,95 @@
  */
 
 #include <cdocx/format_context.h>
+#include <cdocx/properties.h>
 
 #include "sync_common.h"
 
 namespace cdocx {
 
+namespace {
+
+void append_val(pugi::xml_node r_pr, const char* name, const char* value) {
+    r_pr.append_child(name).append_attribute("w:val").set_value(value);
+}
+
+void append_val(pugi::xml_node r_pr, const char* name, int value) {
+    r_pr.append_child(name).append_attribute("w:val").set_value(value);
+}
+
+/// Appends the children of a w:rPr for @p props in schema (CT_RPr) order
+void append_run_properties(pugi::xml_node r_pr, const TextProperties& props) {
+    using Props = TextProperties;
+
+    if (props.font) {
+        const Props::Font& font = *props.font;
+        pugi::xml_node r_fonts = r_pr.append_child("w:rFonts");
+        if (!font.ascii.empty()) {
+            r_fonts.append_attribute("w:ascii").set_value(font.ascii.c_str());
+        }
+        if (!font.east_asia.empty()) {
+            r_fonts.append_attribute("w:eastAsia").set_value(font.east_asia.c_str());
+        }
+        if (!font.h_ansi.empty()) {
+            r_fonts.append_attribute("w:hAnsi").set_value(font.h_ansi.c_str());
+        }
+        if (!font.cs.empty()) {
+            r_fonts.append_attribute("w:cs").set_value(font.cs.c_str());
+        }
+        if (const char* hint = font_hint_to_string(font.hint)) {
+            r_fonts.append_attribute("w:hint").set_value(hint);
+        }
+    }
+    if (props.font_style.bold) {
+        r_pr.append_child("w:b");
+    }
+    if (props.font_style.italic) {
+        r_pr.append_child("w:i");
+    }
+    if (props.strike == Props::StrikeStyle::Single) {
+        r_pr.append_child("w:strike");
+    } else if (props.strike == Props::StrikeStyle::Double) {
+        append_val(r_pr, "w:dstrike", "true");
+    }
+    if (!props.color.empty()) {
+        append_val(r_pr, "w:color", props.color.c_str());
+    }
+    if (props.spacing.type != Props::SpacingType::Normal) {
+        const int value = props.spacing.type == Props::SpacingType::Expanded
+                              ? props.spacing.value
+                              : -props.spacing.value;
+        append_val(r_pr, "w:spacing", value);
+    }
+    if (props.scale != 100) {
+        append_val(r_pr, "w:w", props.scale);
+    }
+    if (props.position.type != Props::PositionType::Normal) {
+        const int value = props.position.type == Props::PositionType::Raised
+                              ? props.position.value
+                              : -props.position.value;
+        append_val(r_pr, "w:position", value);
+    }
+    if (props.font_size > 0) {
+        append_val(r_pr, "w:sz", props.font_size);
+        append_val(r_pr, "w:szCs", props.font_size);
+    }
+    if (props.highlight != Props::Highlight::None) {
+        append_val(r_pr, "w:highlight", highlight_to_string(props.highlight));
+    }
+    if (props.underline.style != Props::UnderlineStyle::None) {
+        pugi::xml_node u = r_pr.append_child("w:u");
+        u.append_attribute("w:val").set_value(underline_style_to_string(props.underline.style));
+        if (props.underline.color != "auto") {
+            u.append_attribute("w:color").set_value(props.underline.color.c_str());
+        }
+    }
+    if (const char* align = vert_align_to_string(props.vert_align)) {
+        append_val(r_pr, "w:vertAlign", align);
+    }
+}
+
+}  // namespace
+
 // ============================================================================
 // Private Helper Methods
 // ============================================================================
@@ -145,4 +229,26 @@ bool TextFormatContext::apply_underline(pugi::xml_node run, bool underline) {
     return true;
 }
 
+bool TextFormatContext::apply(pugi::xml_node run, const TextProperties& props) {
+    if (!run) {
+        return false;
+    }
+
+    pugi::xml_node old_r_pr = run.child("w:rPr");
+    pugi::xml_node r_pr = run.prepend_child("w:rPr");
+    if (old_r_pr) {
+        // The style reference is not part of TextProperties; it stays first
+        if (pugi::xml_node style = old_r_pr.child("w:rStyle")) {
+            r_pr.append_copy(style);
+        }
+        run.remove_child(old_r_pr);
+    }
+
+    append_run_properties(r_pr, props);
+    if (!r_pr.first_child()) {
+        run.remove_child(r_pr);
+    }
+    return true;
+}
+
 }  // namespace cdocx
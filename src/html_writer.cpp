@@ -0,0 +1,1101 @@
+/**
+ * @file html_writer.cpp
+ * @brief Streaming HTML export implementation for CDocx
+ * @details Walks word/document.xml once. Paragraph and run properties are
+ *          turned into CSS declaration strings directly from w:pPr / w:rPr
+ *          (only what is set, no defaults), and identical declaration strings
+ *          share one class. New class rules are flushed right before the block
+ *          that first uses them.
+ * @since 0.8.0
+ */
+
+#include <cdocx/convert_util.h>
+#include <cdocx/document.h>
+#include <cdocx/html_writer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sync_common.h"
+
+namespace cdocx {
+
+namespace {
+
+constexpr const char* kDocumentRels = "word/_rels/document.xml.rels";
+
+// EMU per CSS pixel (914400 EMU per inch / 96 px per inch)
+constexpr double kEmuPerPixel = 9525.0;
+
+struct CssMapping {
+    const char* xml_value;
+    const char* css_value;
+};
+
+const CssMapping kHighlightColors[] = {
+    {"yellow", "#FFFF00"},    {"green", "#00FF00"},      {"cyan", "#00FFFF"},
+    {"magenta", "#FF00FF"},   {"blue", "#0000FF"},       {"red", "#FF0000"},
+    {"darkBlue", "#000080"},  {"darkCyan", "#008080"},   {"darkGreen", "#008000"},
+    {"darkMagenta", "#800080"}, {"darkRed", "#800000"},  {"darkYellow", "#808000"},
+    {"darkGray", "#808080"},  {"lightGray", "#C0C0C0"},  {"black", "#000000"},
+    {"white", "#FFFFFF"},
+};
+
+const CssMapping kTextAlignments[] = {
+    {"left", "left"},
+    {"start", "left"},
+    {"center", "center"},
+    {"right", "right"},
+    {"end", "right"},
+    {"both", "justify"},
+    {"distribute", "justify"},
+};
+
+const CssMapping kVerticalAlignments[] = {
+    {"top", "top"},
+    {"center", "middle"},
+    {"bottom", "bottom"},
+};
+
+// Ordered list type attribute per w:numFmt style
+struct ListTypeMapping {
+    NumberStyle style;
+    const char* type;
+};
+
+const ListTypeMapping kListTypes[] = {
+    {NumberStyle::Decimal, "1"},
+    {NumberStyle::UpperRoman, "I"},
+    {NumberStyle::LowerRoman, "i"},
+    {NumberStyle::UpperLetter, "A"},
+    {NumberStyle::LowerLetter, "a"},
+};
+
+const char* lookup_css(const CssMapping* begin, const CssMapping* end, const char* xml_value) {
+    for (const auto* mapping = begin; mapping != end; ++mapping) {
+        if (std::strcmp(mapping->xml_value, xml_value) == 0) {
+            return mapping->css_value;
+        }
+    }
+    return nullptr;
+}
+
+template <std::size_t N>
+const char* lookup_css(const CssMapping (&table)[N], const char* xml_value) {
+    return lookup_css(table, table + N, xml_value);
+}
+
+// ============================================================================
+// Escaping / encoding
+// ============================================================================
+
+void write_escaped(std::ostream& out, const char* text) {
+    const char* chunk = text;
+    for (const char* p = text; *p; ++p) {
+        const char* entity = nullptr;
+        switch (*p) {
+            case '&':
+                entity = "&amp;";
+                break;
+            case '<':
+                entity = "&lt;";
+                break;
+            case '>':
+                entity = "&gt;";
+                break;
+            case '"':
+                entity = "&quot;";
+                break;
+            default:
+                continue;
+        }
+        out.write(chunk, p - chunk);
+        out << entity;
+        chunk = p + 1;
+    }
+    out << chunk;
+}
+
+void write_escaped(std::ostream& out, const std::string& text) {
+    write_escaped(out, text.c_str());
+}
+
+// Base64 straight from the package buffer, in fixed-size output chunks
+void write_base64(std::ostream& out, const std::vector<uint8_t>& data) {
+    static const char kAlphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char buffer[4096];
+    std::size_t used = 0;
+
+    std::size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        const std::uint32_t triple = (static_cast<std::uint32_t>(data[i]) << 16) |
+                                     (static_cast<std::uint32_t>(data[i + 1]) << 8) |
+                                     data[i + 2];
+        buffer[used++] = kAlphabet[(triple >> 18) & 0x3F];
+        buffer[used++] = kAlphabet[(triple >> 12) & 0x3F];
+        buffer[used++] = kAlphabet[(triple >> 6) & 0x3F];
+        buffer[used++] = kAlphabet[triple & 0x3F];
+        if (used == sizeof(buffer)) {
+            out.write(buffer, static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+
+    const std::size_t rest = data.size() - i;
+    if (rest > 0) {
+        std::uint32_t triple = static_cast<std::uint32_t>(data[i]) << 16;
+        if (rest == 2) {
+            triple |= static_cast<std::uint32_t>(data[i + 1]) << 8;
+        }
+        buffer[used++] = kAlphabet[(triple >> 18) & 0x3F];
+        buffer[used++] = kAlphabet[(triple >> 12) & 0x3F];
+        buffer[used++] = rest == 2 ? kAlphabet[(triple >> 6) & 0x3F] : '=';
+        buffer[used++] = '=';
+    }
+    out.write(buffer, static_cast<std::streamsize>(used));
+}
+
+// ============================================================================
+// CSS from OOXML properties
+// ============================================================================
+
+// Toggle properties (w:b, w:i, ...) are on unless w:val is 0/false/off
+bool is_on(pugi::xml_node toggle) {
+    if (!toggle) {
+        return false;
+    }
+    const char* val = toggle.attribute("w:val").value();
+    return std::strcmp(val, "0") != 0 && std::strcmp(val, "false") != 0 &&
+           std::strcmp(val, "off") != 0;
+}
+
+void append_declaration(std::string& css, const char* property, const std::string& value) {
+    css += property;
+    css += ':';
+    css += value;
+    css += ';';
+}
+
+std::string format_points(double points) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%gpt", points);
+    return buffer;
+}
+
+std::string twips_to_css(int twips) {
+    return format_points(ConvertUtil::twips_to_point(twips));
+}
+
+bool is_hex_color(const char* value) {
+    if (std::strlen(value) != 6) {
+        return false;
+    }
+    for (const char* p = value; *p; ++p) {
+        if (std::isxdigit(static_cast<unsigned char>(*p)) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void append_shading_css(pugi::xml_node shd, std::string& css) {
+    const char* fill = shd.attribute("w:fill").value();
+    if (is_hex_color(fill)) {
+        append_declaration(css, "background-color", std::string("#") + fill);
+    }
+}
+
+void append_run_css(pugi::xml_node r_pr, std::string& css) {
+    if (!r_pr) {
+        return;
+    }
+
+    if (auto fonts = r_pr.child("w:rFonts")) {
+        const char* name = fonts.attribute("w:ascii").value();
+        if (!*name) {
+            name = fonts.attribute("w:hAnsi").value();
+        }
+        const char* east_asia = fonts.attribute("w:eastAsia").value();
+        std::string family;
+        if (*name) {
+            family = std::string("'") + name + "'";
+        }
+        if (*east_asia && std::strcmp(east_asia, name) != 0) {
+            family += (family.empty() ? "'" : ",'") + std::string(east_asia) + "'";
+        }
+        if (!family.empty()) {
+            append_declaration(css, "font-family", family);
+        }
+    }
+    if (auto b = r_pr.child("w:b")) {
+        append_declaration(css, "font-weight", is_on(b) ? "bold" : "normal");
+    }
+    if (auto i = r_pr.child("w:i")) {
+        append_declaration(css, "font-style", is_on(i) ? "italic" : "normal");
+    }
+    if (auto sz = r_pr.child("w:sz")) {
+        append_declaration(css, "font-size", format_points(sz.attribute("w:val").as_int() / 2.0));
+    }
+    if (auto color = r_pr.child("w:color")) {
+        const char* val = color.attribute("w:val").value();
+        if (is_hex_color(val)) {
+            append_declaration(css, "color", std::string("#") + val);
+        }
+    }
+
+    std::string decoration;
+    if (auto u = r_pr.child("w:u")) {
+        const char* val = u.attribute("w:val").value();
+        if (std::strcmp(val, "none") != 0) {
+            decoration = "underline";
+        }
+    }
+    if (is_on(r_pr.child("w:strike")) || is_on(r_pr.child("w:dstrike"))) {
+        decoration += decoration.empty() ? "line-through" : " line-through";
+    }
+    if (!decoration.empty()) {
+        append_declaration(css, "text-decoration", decoration);
+    }
+
+    if (auto highlight = r_pr.child("w:highlight")) {
+        const char* value = lookup_css(kHighlightColors, highlight.attribute("w:val").value());
+        if (value) {
+            append_declaration(css, "background-color", value);
+        }
+    } else if (auto shd = r_pr.child("w:shd")) {
+        append_shading_css(shd, css);
+    }
+
+    if (auto vert_align = r_pr.child("w:vertAlign")) {
+        const char* val = vert_align.attribute("w:val").value();
+        if (std::strcmp(val, "superscript") == 0 || std::strcmp(val, "subscript") == 0) {
+            append_declaration(
+                css, "vertical-align", std::strcmp(val, "superscript") == 0 ? "super" : "sub");
+            append_declaration(css, "font-size", "smaller");
+        }
+    }
+    if (is_on(r_pr.child("w:caps"))) {
+        append_declaration(css, "text-transform", "uppercase");
+    }
+    if (is_on(r_pr.child("w:smallCaps"))) {
+        append_declaration(css, "font-variant", "small-caps");
+    }
+    if (auto spacing = r_pr.child("w:spacing")) {
+        append_declaration(
+            css, "letter-spacing", twips_to_css(spacing.attribute("w:val").as_int()));
+    }
+    if (is_on(r_pr.child("w:vanish"))) {
+        append_declaration(css, "display", "none");
+    }
+}
+
+void append_paragraph_css(pugi::xml_node p_pr, std::string& css) {
+    if (!p_pr) {
+        return;
+    }
+
+    if (auto jc = p_pr.child("w:jc")) {
+        if (const char* value = lookup_css(kTextAlignments, jc.attribute("w:val").value())) {
+            append_declaration(css, "text-align", value);
+        }
+    }
+    if (auto ind = p_pr.child("w:ind")) {
+        auto left = ind.attribute("w:left");
+        if (!left) {
+            left = ind.attribute("w:start");
+        }
+        auto right = ind.attribute("w:right");
+        if (!right) {
+            right = ind.attribute("w:end");
+        }
+        if (left) {
+            append_declaration(css, "margin-left", twips_to_css(left.as_int()));
+        }
+        if (right) {
+            append_declaration(css, "margin-right", twips_to_css(right.as_int()));
+        }
+        if (auto first_line = ind.attribute("w:firstLine")) {
+            append_declaration(css, "text-indent", twips_to_css(first_line.as_int()));
+        } else if (auto hanging = ind.attribute("w:hanging")) {
+            append_declaration(css, "text-indent", twips_to_css(-hanging.as_int()));
+        }
+    }
+    if (auto spacing = p_pr.child("w:spacing")) {
+        if (auto before = spacing.attribute("w:before")) {
+            append_declaration(css, "margin-top", twips_to_css(before.as_int()));
+        }
+        if (auto after = spacing.attribute("w:after")) {
+            append_declaration(css, "margin-bottom", twips_to_css(after.as_int()));
+        }
+        if (auto line = spacing.attribute("w:line")) {
+            const char* rule = spacing.attribute("w:lineRule").value();
+            if (!*rule || std::strcmp(rule, "auto") == 0) {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "%g", line.as_int() / 240.0);
+                append_declaration(css, "line-height", buffer);
+            } else {
+                append_declaration(css, "line-height", twips_to_css(line.as_int()));
+            }
+        }
+    }
+    if (auto shd = p_pr.child("w:shd")) {
+        append_shading_css(shd, css);
+    }
+    if (is_on(p_pr.child("w:pageBreakBefore"))) {
+        append_declaration(css, "page-break-before", "always");
+    }
+}
+
+void append_cell_css(pugi::xml_node tc_pr, bool borders, std::string& css) {
+    if (borders) {
+        append_declaration(css, "border", "1px solid #000");
+    }
+    if (!tc_pr) {
+        return;
+    }
+    if (auto width = tc_pr.child("w:tcW")) {
+        if (std::strcmp(width.attribute("w:type").value(), "dxa") == 0) {
+            append_declaration(css, "width", twips_to_css(width.attribute("w:w").as_int()));
+        }
+    }
+    if (auto v_align = tc_pr.child("w:vAlign")) {
+        if (const char* value =
+                lookup_css(kVerticalAlignments, v_align.attribute("w:val").value())) {
+            append_declaration(css, "vertical-align", value);
+        }
+    }
+    if (auto shd = tc_pr.child("w:shd")) {
+        append_shading_css(shd, css);
+    }
+}
+
+bool has_table_borders(pugi::xml_node tbl_pr) {
+    auto borders = tbl_pr.child("w:tblBorders");
+    for (auto border = borders.first_child(); border; border = border.next_sibling()) {
+        const char* val = border.attribute("w:val").value();
+        if (*val && std::strcmp(val, "none") != 0 && std::strcmp(val, "nil") != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// "Heading1" / "heading 1" style ids map to h1..h6
+int heading_level(pugi::xml_node p_pr) {
+    const std::string style = to_lower(p_pr.child("w:pStyle").attribute("w:val").value());
+    if (style.size() >= 8 && style.compare(0, 7, "heading") == 0) {
+        const char last = style.back();
+        if (last >= '1' && last <= '6' && (style.size() == 8 || style[7] == ' ')) {
+            return last - '0';
+        }
+    }
+    if (auto outline = p_pr.child("w:outlineLvl")) {
+        const int level = outline.attribute("w:val").as_int(9);
+        if (level >= 0 && level < 6) {
+            return level + 1;
+        }
+    }
+    return 0;
+}
+
+std::string sanitize_class_name(const char* style_id) {
+    std::string name = "s-";
+    for (const char* p = style_id; *p; ++p) {
+        const auto c = static_cast<unsigned char>(*p);
+        name += (std::isalnum(c) != 0 || c == '-' || c == '_') ? static_cast<char>(c) : '_';
+    }
+    return name;
+}
+
+// ============================================================================
+// Exporter
+// ============================================================================
+
+struct ListFrame {
+    NumberingId num_id = 0;
+    bool ordered = false;
+    bool item_open = false;
+};
+
+struct TableCellLayout {
+    pugi::xml_node node;
+    int col_span = 1;
+    int row_span = 1;
+    bool merged = false;  ///< Continuation of a vertical merge: not written
+};
+
+class HtmlExporter {
+  public:
+    HtmlExporter(Document& doc, std::ostream& out, const HtmlSaveOptions& options)
+        : doc_(doc), out_(out), options_(options) {
+        image_alias_ = options.get_image_folder_alias().empty() ? options.get_image_folder()
+                                                                : options.get_image_folder_alias();
+        if (!image_alias_.empty() && image_alias_.back() != '/') {
+            image_alias_ += '/';
+        }
+    }
+
+    bool run() {
+        doc_.sync_to_physical_tree();
+        auto* xml = doc_.get_document_xml();
+        if (!xml) {
+            return false;
+        }
+
+        if (options_.get_css_style_sheet_type() == CssStyleSheetType::External) {
+            css_file_.open(options_.get_css_style_sheet_file_name(),
+                           std::ios::out | std::ios::trunc);
+            if (!css_file_) {
+                return false;
+            }
+        }
+
+        if (options_.get_export_full_document()) {
+            write_head();
+        }
+
+        std::vector<ListFrame> lists;
+        write_blocks(xml->child("w:document").child("w:body"), lists, out_, true);
+        close_lists(lists, out_);
+
+        if (options_.get_export_full_document()) {
+            out_ << "</body>\n</html>\n";
+        }
+        out_.flush();
+        return images_written_ && static_cast<bool>(out_) &&
+               (!css_file_.is_open() || static_cast<bool>(css_file_));
+    }
+
+  private:
+    // ------------------------------------------------------------------------
+    // CSS classes
+    // ------------------------------------------------------------------------
+
+    bool inline_css() const {
+        return options_.get_css_style_sheet_type() == CssStyleSheetType::Inline;
+    }
+
+    // Class for a declaration string; new rules are queued until the next flush
+    std::string class_for(const std::string& declarations, char prefix) {
+        if (declarations.empty()) {
+            return "";
+        }
+        auto it = classes_.find(declarations);
+        if (it != classes_.end()) {
+            return it->second;
+        }
+        std::string name = prefix + std::to_string(classes_.size() + 1);
+        pending_rules_ += '.' + name + '{' + declarations + "}\n";
+        classes_.emplace(declarations, name);
+        return name;
+    }
+
+    void flush_rules(std::ostream& out) {
+        if (pending_rules_.empty()) {
+            return;
+        }
+        if (css_file_.is_open()) {
+            css_file_ << pending_rules_;
+        } else {
+            out << "<style>\n" << pending_rules_ << "</style>\n";
+        }
+        pending_rules_.clear();
+    }
+
+    // Declarations of a style including its basedOn chain (base rules first)
+    std::string style_declarations(pugi::xml_node styles_root, const char* style_id, int depth) {
+        if (!styles_root || depth > 16) {
+            return "";
+        }
+        for (auto style = styles_root.child("w:style"); style;
+             style = style.next_sibling("w:style")) {
+            if (std::strcmp(style.attribute("w:styleId").value(), style_id) != 0) {
+                continue;
+            }
+            std::string css;
+            if (auto based_on = style.child("w:basedOn")) {
+                css = style_declarations(
+                    styles_root, based_on.attribute("w:val").value(), depth + 1);
+            }
+            append_paragraph_css(style.child("w:pPr"), css);
+            append_run_css(style.child("w:rPr"), css);
+            return css;
+        }
+        return "";
+    }
+
+    // "s-<styleId>" class (or inline declarations) for a paragraph/character style
+    const std::string& style_css(const char* style_id) {
+        auto it = style_classes_.find(style_id);
+        if (it != style_classes_.end()) {
+            return it->second;
+        }
+
+        auto* styles = doc_.get_styles();
+        const std::string css =
+            style_declarations(styles ? styles->child("w:styles") : pugi::xml_node(), style_id, 0);
+        std::string value;
+        if (inline_css()) {
+            value = css;
+        } else if (!css.empty()) {
+            value = sanitize_class_name(style_id);
+            pending_rules_ += '.' + value + '{' + css + "}\n";
+        }
+        return style_classes_.emplace(style_id, std::move(value)).first->second;
+    }
+
+    // class="..." / style="..." attribute for a style id plus direct formatting
+    void write_format_attribute(std::ostream& out,
+                                const char* style_id,
+                                const std::string& direct,
+                                char prefix) {
+        std::string style = *style_id ? style_css(style_id) : std::string();
+        if (inline_css()) {
+            style += direct;
+            if (!style.empty()) {
+                out << " style=\"";
+                write_escaped(out, style);
+                out << '"';
+            }
+            return;
+        }
+        const std::string direct_class = class_for(direct, prefix);
+        if (!direct_class.empty()) {
+            style += style.empty() ? direct_class : ' ' + direct_class;
+        }
+        if (!style.empty()) {
+            out << " class=\"" << style << '"';
+        }
+    }
+
+    void write_head() {
+        out_ << "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>";
+        write_escaped(out_, doc_.get_builtin_document_properties().title);
+        out_ << "</title>\n";
+
+        // Document defaults become the body rule
+        std::string body_css;
+        if (auto* styles = doc_.get_styles()) {
+            auto defaults = styles->child("w:styles").child("w:docDefaults");
+            append_paragraph_css(defaults.child("w:pPrDefault").child("w:pPr"), body_css);
+            append_run_css(defaults.child("w:rPrDefault").child("w:rPr"), body_css);
+        }
+        const std::string base_rules = "body{" + body_css + "}\ntable{border-collapse:collapse;}\n";
+
+        if (css_file_.is_open()) {
+            css_file_ << base_rules;
+            out_ << "<link rel=\"stylesheet\" type=\"text/css\" href=\"";
+            write_escaped(out_, options_.get_css_style_sheet_file_name());
+            out_ << "\">\n";
+        } else if (!inline_css()) {
+            out_ << "<style>\n" << base_rules << "</style>\n";
+        }
+        out_ << "</head>\n<body";
+        if (inline_css() && !body_css.empty()) {
+            out_ << " style=\"";
+            write_escaped(out_, body_css);
+            out_ << '"';
+        }
+        out_ << ">\n";
+    }
+
+    // ------------------------------------------------------------------------
+    // Block level
+    // ------------------------------------------------------------------------
+
+    // Top-level blocks are rendered into a scratch buffer so the CSS rules they
+    // introduce can be flushed in front of them
+    void write_blocks(pugi::xml_node container,
+                      std::vector<ListFrame>& lists,
+                      std::ostream& out,
+                      bool top_level) {
+        for (auto child = container.first_child(); child; child = child.next_sibling()) {
+            const char* name = child.name();
+            if (is_para_node(name)) {
+                write_paragraph(child, lists, out, top_level);
+            } else if (is_table_node(name)) {
+                close_lists(lists, out);
+                if (top_level) {
+                    std::ostringstream buffer;
+                    write_table(child, buffer);
+                    flush_rules(out);
+                    out << buffer.str();
+                } else {
+                    write_table(child, out);
+                }
+            } else if (std::strcmp(name, "w:sdt") == 0) {
+                write_blocks(child.child("w:sdtContent"), lists, out, top_level);
+            }
+        }
+    }
+
+    void write_paragraph(pugi::xml_node para,
+                         std::vector<ListFrame>& lists,
+                         std::ostream& out,
+                         bool top_level) {
+        auto p_pr = para.child("w:pPr");
+        auto num_pr = p_pr.child("w:numPr");
+        const auto num_id =
+            static_cast<NumberingId>(num_pr.child("w:numId").attribute("w:val").as_uint());
+        if (num_id != 0) {
+            update_lists(lists, num_id, num_pr.child("w:ilvl").attribute("w:val").as_int(), out);
+        } else {
+            close_lists(lists, out);
+        }
+
+        std::ostringstream buffer;
+        std::ostream& target = top_level ? buffer : out;
+
+        const int heading = heading_level(p_pr);
+        const std::string tag = heading > 0 ? "h" + std::to_string(heading) : "p";
+
+        std::string direct;
+        append_paragraph_css(p_pr, direct);
+        target << '<' << tag;
+        write_format_attribute(
+            target, p_pr.child("w:pStyle").attribute("w:val").value(), direct, 'p');
+        target << '>';
+
+        std::ostringstream content;
+        write_inline(para, content);
+        const std::string html = content.str();
+        target << (html.empty() ? "&#160;" : html);
+        target << "</" << tag << ">\n";
+
+        if (top_level) {
+            flush_rules(out);
+            out << buffer.str();
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Lists
+    // ------------------------------------------------------------------------
+
+    void list_kind(NumberingId num_id, int level, bool& ordered, std::string& attributes) {
+        ordered = false;
+        attributes.clear();
+
+        auto* manager = doc_.get_numbering_manager();
+        const auto* def = manager ? manager->get_numbering_definition(num_id) : nullptr;
+        const auto* abstract_def =
+            def ? manager->get_abstract_definition(def->abstract_id) : nullptr;
+        if (!abstract_def || level < 0 || level >= static_cast<int>(abstract_def->levels.size())) {
+            return;
+        }
+
+        const auto& level_def = abstract_def->levels[static_cast<std::size_t>(level)];
+        if (level_def.number_style == NumberStyle::Bullet) {
+            return;
+        }
+        ordered = true;
+        for (const auto& mapping : kListTypes) {
+            if (mapping.style == level_def.number_style) {
+                attributes = std::string(" type=\"") + mapping.type + '"';
+                break;
+            }
+        }
+        if (level_def.start_number != 1) {
+            attributes += " start=\"" + std::to_string(level_def.start_number) + '"';
+        }
+    }
+
+    void update_lists(std::vector<ListFrame>& lists,
+                      NumberingId num_id,
+                      int level,
+                      std::ostream& out) {
+        const std::size_t depth = static_cast<std::size_t>(std::max(0, std::min(level, 8))) + 1;
+
+        while (!lists.empty() &&
+               (lists.size() > depth || (lists.size() == depth && lists.back().num_id != num_id))) {
+            close_list(lists, out);
+        }
+        if (lists.size() == depth && lists.back().item_open) {
+            out << "</li>\n";
+            lists.back().item_open = false;
+        }
+        while (lists.size() < depth) {
+            // Skipped levels still need an item to nest in
+            if (!lists.empty() && !lists.back().item_open) {
+                out << "<li style=\"list-style-type:none\">";
+                lists.back().item_open = true;
+            }
+            ListFrame frame;
+            frame.num_id = num_id;
+            std::string attributes;
+            list_kind(num_id, static_cast<int>(lists.size()), frame.ordered, attributes);
+            out << (frame.ordered ? "<ol" : "<ul") << attributes << ">\n";
+            lists.push_back(frame);
+        }
+        out << "<li>";
+        lists.back().item_open = true;
+    }
+
+    static void close_list(std::vector<ListFrame>& lists, std::ostream& out) {
+        if (lists.back().item_open) {
+            out << "</li>\n";
+        }
+        out << (lists.back().ordered ? "</ol>\n" : "</ul>\n");
+        lists.pop_back();
+    }
+
+    static void close_lists(std::vector<ListFrame>& lists, std::ostream& out) {
+        while (!lists.empty()) {
+            close_list(lists, out);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Tables
+    // ------------------------------------------------------------------------
+
+    // Grid layout of one table: colspans from w:gridSpan, rowspans by looking
+    // down the same grid column for w:vMerge continuations
+    static std::vector<std::vector<TableCellLayout>> layout_table(
+        pugi::xml_node table,
+        std::vector<std::vector<int>>& columns) {
+        std::vector<std::vector<TableCellLayout>> rows;
+        for (auto tr = table.child("w:tr"); tr; tr = tr.next_sibling("w:tr")) {
+            rows.emplace_back();
+            columns.emplace_back();
+            int grid_col = 0;
+            for (auto tc = tr.child("w:tc"); tc; tc = tc.next_sibling("w:tc")) {
+                auto tc_pr = tc.child("w:tcPr");
+                TableCellLayout cell;
+                cell.node = tc;
+                cell.col_span = std::max(1, tc_pr.child("w:gridSpan").attribute("w:val").as_int(1));
+                auto v_merge = tc_pr.child("w:vMerge");
+                cell.merged =
+                    v_merge && std::strcmp(v_merge.attribute("w:val").value(), "restart") != 0;
+                rows.back().push_back(cell);
+                columns.back().push_back(grid_col);
+                grid_col += cell.col_span;
+            }
+        }
+
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            for (std::size_t c = 0; c < rows[r].size(); ++c) {
+                auto& cell = rows[r][c];
+                auto v_merge = cell.node.child("w:tcPr").child("w:vMerge");
+                if (!v_merge || cell.merged) {
+                    continue;
+                }
+                const int grid_col = columns[r][c];
+                for (std::size_t below = r + 1; below < rows.size(); ++below) {
+                    bool continued = false;
+                    for (std::size_t k = 0; k < rows[below].size(); ++k) {
+                        if (columns[below][k] == grid_col && rows[below][k].merged) {
+                            continued = true;
+                            break;
+                        }
+                    }
+                    if (!continued) {
+                        break;
+                    }
+                    ++cell.row_span;
+                }
+            }
+        }
+        return rows;
+    }
+
+    void write_table(pugi::xml_node table, std::ostream& out) {
+        auto tbl_pr = table.child("w:tblPr");
+        const bool borders = has_table_borders(tbl_pr);
+
+        std::string table_css;
+        if (auto jc = tbl_pr.child("w:jc")) {
+            if (std::strcmp(jc.attribute("w:val").value(), "center") == 0) {
+                append_declaration(table_css, "margin-left", "auto");
+                append_declaration(table_css, "margin-right", "auto");
+            }
+        }
+        if (auto shd = tbl_pr.child("w:shd")) {
+            append_shading_css(shd, table_css);
+        }
+
+        out << "<table";
+        write_format_attribute(out, tbl_pr.child("w:tblStyle").attribute("w:val").value(),
+                               table_css, 't');
+        out << ">\n";
+
+        std::vector<std::vector<int>> columns;
+        const auto rows = layout_table(table, columns);
+        for (const auto& row : rows) {
+            out << "<tr>";
+            for (const auto& cell : row) {
+                if (cell.merged) {
+                    continue;
+                }
+                std::string cell_css;
+                append_cell_css(cell.node.child("w:tcPr"), borders, cell_css);
+                out << "<td";
+                if (cell.col_span > 1) {
+                    out << " colspan=\"" << cell.col_span << '"';
+                }
+                if (cell.row_span > 1) {
+                    out << " rowspan=\"" << cell.row_span << '"';
+                }
+                write_format_attribute(out, "", cell_css, 'c');
+                out << '>';
+                std::vector<ListFrame> lists;
+                write_blocks(cell.node, lists, out, false);
+                close_lists(lists, out);
+                out << "</td>";
+            }
+            out << "</tr>\n";
+        }
+        out << "</table>\n";
+    }
+
+    // ------------------------------------------------------------------------
+    // Inline content
+    // ------------------------------------------------------------------------
+
+    // Adjacent runs with the same formatting share one <span>
+    struct SpanState {
+        std::string attributes;
+        bool open = false;
+    };
+
+    static void close_span(SpanState& span, std::ostream& out) {
+        if (span.open) {
+            out << "</span>";
+            span.open = false;
+        }
+    }
+
+    void write_inline(pugi::xml_node parent, std::ostream& out) {
+        SpanState span;
+        for (auto child = parent.first_child(); child; child = child.next_sibling()) {
+            const char* name = child.name();
+            if (std::strcmp(name, "w:r") == 0) {
+                write_run(child, span, out);
+            } else if (std::strcmp(name, "w:hyperlink") == 0) {
+                close_span(span, out);
+                write_hyperlink(child, out);
+            } else if (std::strcmp(name, "w:bookmarkStart") == 0) {
+                const char* bookmark = child.attribute("w:name").value();
+                if (*bookmark && std::strcmp(bookmark, "_GoBack") != 0) {
+                    close_span(span, out);
+                    out << "<a id=\"";
+                    write_escaped(out, bookmark);
+                    out << "\"></a>";
+                }
+            } else if (std::strcmp(name, "w:ins") == 0 || std::strcmp(name, "w:smartTag") == 0 ||
+                       std::strcmp(name, "w:customXml") == 0 ||
+                       std::strcmp(name, "w:fldSimple") == 0) {
+                close_span(span, out);
+                write_inline(child, out);
+            } else if (std::strcmp(name, "w:sdt") == 0) {
+                close_span(span, out);
+                write_inline(child.child("w:sdtContent"), out);
+            }
+            // w:del (deleted text), w:pPr and range markers produce no output
+        }
+        close_span(span, out);
+    }
+
+    void write_hyperlink(pugi::xml_node hyperlink, std::ostream& out) {
+        std::string href;
+        const char* rel_id = hyperlink.attribute("r:id").value();
+        if (*rel_id) {
+            href = doc_.get_relationship_target(kDocumentRels, rel_id);
+        }
+        const char* anchor = hyperlink.attribute("w:anchor").value();
+        if (*anchor) {
+            href += '#';
+            href += anchor;
+        }
+        out << "<a href=\"";
+        write_escaped(out, href);
+        out << "\">";
+        write_inline(hyperlink, out);
+        out << "</a>";
+    }
+
+    void write_run(pugi::xml_node run, SpanState& span, std::ostream& out) {
+        auto r_pr = run.child("w:rPr");
+        std::string direct;
+        append_run_css(r_pr, direct);
+
+        std::ostringstream attributes;
+        write_format_attribute(attributes, r_pr.child("w:rStyle").attribute("w:val").value(),
+                               direct, 'r');
+        const std::string attr = attributes.str();
+
+        for (auto child = run.first_child(); child; child = child.next_sibling()) {
+            const char* name = child.name();
+            const bool visible = std::strcmp(name, "w:t") == 0 || std::strcmp(name, "w:tab") == 0 ||
+                                 std::strcmp(name, "w:br") == 0 || std::strcmp(name, "w:cr") == 0 ||
+                                 std::strcmp(name, "w:noBreakHyphen") == 0 ||
+                                 std::strcmp(name, "w:softHyphen") == 0 ||
+                                 std::strcmp(name, "w:footnoteReference") == 0 ||
+                                 std::strcmp(name, "w:endnoteReference") == 0;
+            if (!visible) {
+                if (std::strcmp(name, "w:drawing") == 0 || std::strcmp(name, "w:pict") == 0) {
+                    close_span(span, out);
+                    write_image(child, out);
+                }
+                continue;
+            }
+
+            if (!span.open || span.attributes != attr) {
+                close_span(span, out);
+                if (!attr.empty()) {
+                    out << "<span" << attr << '>';
+                    span.open = true;
+                    span.attributes = attr;
+                }
+            }
+
+            if (std::strcmp(name, "w:t") == 0) {
+                write_escaped(out, child.text().get());
+            } else if (std::strcmp(name, "w:tab") == 0) {
+                out << "&emsp;";
+            } else if (std::strcmp(name, "w:br") == 0 || std::strcmp(name, "w:cr") == 0) {
+                if (std::strcmp(child.attribute("w:type").value(), "page") != 0) {
+                    out << "<br>";
+                }
+            } else if (std::strcmp(name, "w:noBreakHyphen") == 0) {
+                out << "&#8209;";
+            } else if (std::strcmp(name, "w:softHyphen") == 0) {
+                out << "&shy;";
+            } else {
+                out << "<sup>" << child.attribute("w:id").as_int() << "</sup>";
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Images
+    // ------------------------------------------------------------------------
+
+    static pugi::xml_node find_descendant(pugi::xml_node node, const char* name) {
+        for (auto child = node.first_child(); child; child = child.next_sibling()) {
+            if (std::strcmp(child.name(), name) == 0) {
+                return child;
+            }
+            if (auto found = find_descendant(child, name)) {
+                return found;
+            }
+        }
+        return pugi::xml_node();
+    }
+
+    void write_image(pugi::xml_node drawing, std::ostream& out) {
+        const char* rel_id = find_descendant(drawing, "a:blip").attribute("r:embed").value();
+        if (!*rel_id) {
+            rel_id = find_descendant(drawing, "v:imagedata").attribute("r:id").value();
+        }
+        if (!*rel_id) {
+            return;
+        }
+
+        const std::string target = doc_.get_relationship_target(kDocumentRels, rel_id);
+        auto node = target.empty() ? nullptr : doc_.get_physical_tree().find_node("word/" + target);
+        if (!node || node->binary_data.empty()) {
+            return;
+        }
+
+        out << "<img src=\"";
+        if (options_.get_export_images_as_base64()) {
+            const std::string mime =
+                node->content_type.empty() ? doc_.get_mime_type(target) : node->content_type;
+            out << "data:" << mime << ";base64,";
+            write_base64(out, node->binary_data);
+        } else {
+            const std::string file_name = std::filesystem::path(target).filename().string();
+            if (written_images_.insert(file_name).second) {
+                write_image_file(file_name, node->binary_data);
+            }
+            write_escaped(out, image_alias_ + file_name);
+        }
+        out << '"';
+
+        auto extent = find_descendant(drawing, "wp:extent");
+        if (extent) {
+            const auto width =
+                static_cast<long long>(extent.attribute("cx").as_llong() / kEmuPerPixel);
+            const auto height =
+                static_cast<long long>(extent.attribute("cy").as_llong() / kEmuPerPixel);
+            if (width > 0 && height > 0) {
+                out << " width=\"" << width << "\" height=\"" << height << '"';
+            }
+        }
+        out << " alt=\"";
+        write_escaped(out, find_descendant(drawing, "wp:docPr").attribute("descr").value());
+        out << "\">";
+    }
+
+    void write_image_file(const std::string& file_name, const std::vector<uint8_t>& data) {
+        const std::filesystem::path folder(options_.get_image_folder());
+        std::error_code ec;
+        std::filesystem::create_directories(folder, ec);
+        std::ofstream file(folder / file_name, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        file.close();
+        if (!file.good()) {
+            images_written_ = false;
+        }
+    }
+
+    Document& doc_;
+    std::ostream& out_;
+    const HtmlSaveOptions& options_;
+    std::ofstream css_file_;
+    std::string image_alias_;
+
+    std::unordered_map<std::string, std::string> classes_;        ///< declarations -> class
+    std::unordered_map<std::string, std::string> style_classes_;  ///< style id -> class/css
+    std::string pending_rules_;
+    std::set<std::string> written_images_;
+    bool images_written_ = true;  ///< False once an image file could not be written
+};
+
+}  // anonymous namespace
+
+// ============================================================================
+// HtmlWriter Implementation
+// ============================================================================
+
+bool HtmlWriter::write(Document& doc, std::ostream& out, const HtmlSaveOptions& options) {
+    if (!doc.is_open()) {
+        return false;
+    }
+    return HtmlExporter(doc, out, options).run();
+}
+
+bool Document::save_html(const std::string& filepath) {
+    return save_html(filepath, HtmlSaveOptions());
+}
+
+bool Document::save_html(const std::string& filepath, const HtmlSaveOptions& options) {
+    std::ofstream out(filepath, std::ios::out | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    return HtmlWriter::write(*this, out, options);
+}
+
+bool Document::save_html(std::ostream& out) {
+    return save_html(out, HtmlSaveOptions());
+}
+
+bool Document::save_html(std::ostream& out, const HtmlSaveOptions& options) {
+    return HtmlWriter::write(*this, out, options);
+}
+
+}  // namespace cdocx
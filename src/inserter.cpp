@@ -108,6 +108,33 @@ pugi::xml_node DocumentInserter::clone_table(const pugi::xml_node& source_table,
     return new_table;
 }
 
+// ============================================================================
+// Numbering
+// ============================================================================
+
+void DocumentInserter::import_numbering(Document* source) {
+    numbering_map_.clear();
+    NumberingManager* target_numbering = target_doc_->get_numbering_manager();
+    NumberingManager* source_numbering = source->get_numbering_manager();
+    if (!target_numbering || !source_numbering || !source_numbering->has_definitions()) {
+        return;
+    }
+    numbering_map_ = target_numbering->import_definitions(*source_numbering);
+}
+
+void DocumentInserter::remap_numbering(pugi::xml_node node) const {
+    if (numbering_map_.empty() || !node) {
+        return;
+    }
+    for (const pugi::xpath_node& xn : node.select_nodes(".//w:numPr/w:numId")) {
+        pugi::xml_attribute val = xn.node().attribute("w:val");
+        auto it = numbering_map_.find(static_cast<NumberingId>(val.as_uint()));
+        if (it != numbering_map_.end()) {
+            val.set_value(static_cast<unsigned int>(it->second));
+        }
+    }
+}
+
 // ============================================================================
 // Insertion Functions
 // ============================================================================
@@ -132,13 +159,15 @@ void DocumentInserter::insert_document(Document* source) {
         return;
     }
 
+    import_numbering(source);
+
     // Clone all paragraphs and tables from source
     for (pugi::xml_node child = source_body.first_child(); child; child = child.next_sibling()) {
         const std::string name = child.name();
         if (name == "w:p") {
-            clone_paragraph(child, target_body);
+            remap_numbering(clone_paragraph(child, target_body));
         } else if (name == "w:tbl") {
-            clone_table(child, target_body);
+            remap_numbering(clone_table(child, target_body));
         }
     }
 }
@@ -165,6 +194,8 @@ void DocumentInserter::insert_document_after(Document* source, Paragraph& after_
         return;
     }
 
+    import_numbering(source);
+
     // Clone and insert after the reference paragraph
     pugi::xml_node last_inserted = insert_after;
 
@@ -187,6 +218,7 @@ void DocumentInserter::insert_document_after(Document* source, Paragraph& after_
         }
 
         if (new_node) {
+            remap_numbering(new_node);
             last_inserted = new_node;
         }
     }
@@ -233,6 +265,8 @@ void DocumentInserter::insert_document_at(Document* source, int position) {
         }
     }
 
+    import_numbering(source);
+
     // Clone source content in reverse order (to insert before same point)
     std::vector<pugi::xml_node> nodes_to_clone;
     for (pugi::xml_node child = source_body.first_child(); child; child = child.next_sibling()) {
@@ -257,6 +291,7 @@ void DocumentInserter::insert_document_at(Document* source, int position) {
         for (pugi::xml_node attr = it->first_child(); attr; attr = attr.next_sibling()) {
             new_node.append_copy(attr);
         }
+        remap_numbering(new_node);
     }
 }
 
@@ -297,6 +332,8 @@ void DocumentInserter::insert_paragraphs(Document* source, int position) {
         }
     }
 
+    import_numbering(source);
+
     // Collect and clone only paragraphs
     std::vector<pugi::xml_node> paras_to_clone;
     for (pugi::xml_node child = source_body.first_child(); child; child = child.next_sibling()) {
@@ -318,6 +355,7 @@ void DocumentInserter::insert_paragraphs(Document* source, int position) {
         for (pugi::xml_node attr = it->first_child(); attr; attr = attr.next_sibling()) {
             new_para.append_copy(attr);
         }
+        remap_numbering(new_para);
     }
 }
 
@@ -358,6 +396,8 @@ void DocumentInserter::insert_tables(Document* source, int position) {
         }
     }
 
+    import_numbering(source);
+
     // Collect and clone only tables
     std::vector<pugi::xml_node> tables_to_clone;
     for (pugi::xml_node child = source_body.first_child(); child; child = child.next_sibling()) {
@@ -379,6 +419,7 @@ void DocumentInserter::insert_tables(Document* source, int position) {
         for (pugi::xml_node attr = it->first_child(); attr; attr = attr.next_sibling()) {
             new_table.append_copy(attr);
         }
+        remap_numbering(new_table);
     }
 }
 
@@ -9,10 +9,19 @@
 #include <cdocx/paragraph.h>
 
 #include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
 #include <sstream>
+#include <string_view>
+#include <unordered_map>
 
 #include "sync_common.h"
 
+extern "C" {
+#include <zip.h>
+}
+
 namespace cdocx {
 
 namespace {
@@ -35,8 +44,14 @@ std::string parse_merge_field_name(const std::string& field_code) {
     std::getline(iss, rest);
     rest = trim_whitespace(rest);
 
-    // Remove switches (anything starting with \\)
-    const size_t switch_pos = rest.find("\\\\");
+    // Quoted names may contain spaces: MERGEFIELD "First Name"
+    if (!rest.empty() && rest[0] == '"') {
+        const size_t close = rest.find('"', 1);
+        return close == std::string::npos ? rest.substr(1) : rest.substr(1, close - 1);
+    }
+
+    // Remove switches (anything starting with \)
+    const size_t switch_pos = rest.find('\\');
     if (switch_pos != std::string::npos) {
         rest = trim_whitespace(rest.substr(0, switch_pos));
     }
@@ -81,6 +96,24 @@ bool is_empty_paragraph(const Paragraph* para) {
     return true;
 }
 
+// Case-insensitive field lookup; nullptr if the data has no such field
+const std::string* find_merge_value(const std::map<std::string, std::string>& data,
+                                    const std::string& field_name) {
+    auto it = std::find_if(data.begin(), data.end(), [&field_name](const auto& kv) {
+        return iequals(kv.first, field_name);
+    });
+    return it != data.end() ? &it->second : nullptr;
+}
+
+// Pairs are searched from the back so the last assignment of a name wins
+const std::string* find_merge_value(const std::vector<std::pair<std::string, std::string>>& data,
+                                    const std::string& field_name) {
+    auto it = std::find_if(data.rbegin(), data.rend(), [&field_name](const auto& kv) {
+        return iequals(kv.first, field_name);
+    });
+    return it != data.rend() ? &it->second : nullptr;
+}
+
 }  // anonymous namespace
 
 // ============================================================================
@@ -95,15 +128,13 @@ void MailMerge::execute(const std::map<std::string, std::string>& data) {
 }
 
 void MailMerge::execute(const std::vector<std::pair<std::string, std::string>>& data) {
-    std::map<std::string, std::string> map_data;
-    for (const auto& p : data) {
-        map_data[p.first] = p.second;
-    }
-    execute_impl(map_data);
+    execute_impl(data);
 }
 
-void MailMerge::execute_impl(const std::map<std::string, std::string>& data) {
-    if (!doc_) {
+template <typename Data>
+void MailMerge::execute_impl(const Data& data) {
+    cancelled_ = cancellation_token_.is_cancelled();
+    if (!doc_ || cancelled_) {
         return;
     }
 
@@ -116,6 +147,9 @@ void MailMerge::execute_impl(const std::map<std::string, std::string>& data) {
 
     auto sections = doc_->get_sections();
     for (auto& section : sections) {
+        if (cancelled_) {
+            break;
+        }
         if (auto body = section->get_body()) {
             for (const auto& child : body->get_children()) {
                 if (child->node_type() != NodeType::Paragraph) {
@@ -125,6 +159,11 @@ void MailMerge::execute_impl(const std::map<std::string, std::string>& data) {
                 if (!para) {
                     continue;
                 }
+                // Each paragraph is merged completely or not at all
+                if (cancellation_token_.is_cancelled()) {
+                    cancelled_ = true;
+                    break;
+                }
 
                 auto children = para->get_children();
                 for (size_t i = 0; i < children.size(); ++i) {
@@ -144,13 +183,9 @@ void MailMerge::execute_impl(const std::map<std::string, std::string>& data) {
 
                     removed_any_field = true;
 
-                    auto it = std::find_if(data.begin(), data.end(), [&field_name](const auto& kv) {
-                        return iequals(kv.first, field_name);
-                    });
-
-                    if (it != data.end()) {
+                    if (const std::string* value = find_merge_value(data, field_name)) {
                         // Replace field with a Run containing the value
-                        auto run = std::make_shared<Run>(doc_, it->second);
+                        auto run = std::make_shared<Run>(doc_, *value);
                         para->insert_child(static_cast<int>(i), run);
                         para->remove_child(node);
                     } else {
@@ -162,6 +197,14 @@ void MailMerge::execute_impl(const std::map<std::string, std::string>& data) {
         }
     }
 
+    if (cancelled_) {
+        // Keep the merged paragraphs; skip the document-wide cleanup
+        if (removed_any_field) {
+            doc_->sync_to_physical_tree();
+        }
+        return;
+    }
+
     if (removed_any_field) {
         apply_cleanup();
         doc_->sync_to_physical_tree();
@@ -289,4 +332,680 @@ void MailMerge::apply_cleanup() {
     }
 }
 
+// ============================================================================
+// Single Document Merge
+// ============================================================================
+
+namespace {
+
+// Placeholders written into the compiled template XML. U+E000/U+E001 are
+// private-use characters that pugixml prints unescaped and that do not occur
+// in real documents.
+constexpr const char* kSlotOpen = "\xEE\x80\x80";
+constexpr const char* kSlotClose = "\xEE\x80\x81";
+constexpr std::size_t kSlotMarkerSize = 3;
+constexpr char kFieldSlot = 'F';
+constexpr char kIdSlot = 'I';
+
+constexpr std::size_t kZipWriteChunk = 64 * 1024;
+
+struct SectionStartMapping {
+    BreakType type;
+    const char* xml_value;
+};
+
+static const SectionStartMapping kSectionStartMappings[] = {
+    {BreakType::SectionBreakNextPage, "nextPage"},
+    {BreakType::SectionBreakContinuous, "continuous"},
+    {BreakType::SectionBreakEvenPage, "evenPage"},
+    {BreakType::SectionBreakOddPage, "oddPage"},
+};
+
+const char* section_start_value(BreakType type) {
+    for (const auto& mapping : kSectionStartMappings) {
+        if (mapping.type == type) {
+            return mapping.xml_value;
+        }
+    }
+    return "nextPage";
+}
+
+std::string make_slot(char kind, long long index) {
+    return std::string(kSlotOpen) + kind + std::to_string(index) + kSlotClose;
+}
+
+// One piece of a compiled block: literal XML followed by an optional slot
+struct MergeSegment {
+    std::string xml;
+    char kind = 0;        ///< kFieldSlot, kIdSlot or 0 for the trailing literal
+    long long value = 0;  ///< Field slot index, or the template id to renumber
+};
+
+// One body-level element of the template, pre-serialized
+struct MergeBlock {
+    std::vector<MergeSegment> segments;
+    bool removable = false;  ///< Paragraph with no content except merge fields
+};
+
+// Collects rendered XML and passes it to the open zip entry in large chunks
+class ZipEntryStream {
+  public:
+    explicit ZipEntryStream(zip_t* zip) : zip_(zip) { buffer_.reserve(kZipWriteChunk * 2); }
+
+    /// Append target; call commit() afterwards
+    std::string& buffer() { return buffer_; }
+
+    void commit() {
+        if (buffer_.size() >= kZipWriteChunk) {
+            flush();
+        }
+    }
+
+    bool flush() {
+        if (!buffer_.empty()) {
+            ok_ = zip_entry_write(zip_, buffer_.data(), buffer_.size()) >= 0 && ok_;
+            buffer_.clear();
+        }
+        return ok_;
+    }
+
+  private:
+    zip_t* zip_;
+    std::string buffer_;
+    bool ok_ = true;
+};
+
+class StringXmlWriter : public pugi::xml_writer {
+  public:
+    explicit StringXmlWriter(std::string& out) : out_(out) {}
+    void write(const void* data, size_t size) override {
+        out_.append(static_cast<const char*>(data), size);
+    }
+
+  private:
+    std::string& out_;
+};
+
+void append_escaped_attribute(std::string& out, const char* value) {
+    for (const char* p = value; *p; ++p) {
+        switch (*p) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '"': out += "&quot;"; break;
+            default: out += *p; break;
+        }
+    }
+}
+
+// Field value as run content: newlines become w:br, tabs w:tab, and control
+// characters that XML cannot carry are dropped.
+void append_field_value(std::string& out, std::string_view value) {
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        const char* replacement = nullptr;
+        switch (value[i]) {
+            case '&': replacement = "&amp;"; break;
+            case '<': replacement = "&lt;"; break;
+            case '>': replacement = "&gt;"; break;
+            case '\n': replacement = "</w:t><w:br/><w:t xml:space=\"preserve\">"; break;
+            case '\t': replacement = "</w:t><w:tab/><w:t xml:space=\"preserve\">"; break;
+            default:
+                if (static_cast<unsigned char>(value[i]) < 0x20) {
+                    replacement = "";
+                }
+                break;
+        }
+        if (replacement) {
+            out.append(value.data() + start, i - start);
+            out += replacement;
+            start = i + 1;
+        }
+    }
+    out.append(value.data() + start, value.size() - start);
+}
+
+bool is_blank(std::string_view value) {
+    return value.find_first_not_of(" \t\r\n") == std::string_view::npos;
+}
+
+// Compiles the template body once; render_block() then only concatenates
+// literals and values for every record.
+class SingleDocumentMerger {
+  public:
+    explicit SingleDocumentMerger(bool remove_empty_paragraphs)
+        : remove_empty_paragraphs_(remove_empty_paragraphs) {}
+
+    void compile(pugi::xml_node document, const char* section_start) {
+        pugi::xml_node body = document.child("w:body");
+
+        // Prologue: declaration, root element with namespaces, pre-body content
+        prologue_ = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\r\n<";
+        prologue_ += document.name();
+        for (auto attr : document.attributes()) {
+            prologue_ += ' ';
+            prologue_ += attr.name();
+            prologue_ += "=\"";
+            append_escaped_attribute(prologue_, attr.value());
+            prologue_ += '"';
+        }
+        prologue_ += '>';
+        for (auto child : document.children()) {
+            if (child == body) {
+                break;
+            }
+            print_node(child, prologue_);
+        }
+        prologue_ += "<w:body>";
+
+        // Section properties closing every record
+        pugi::xml_document sect_doc;
+        pugi::xml_node sect_pr = body.last_child();
+        while (sect_pr && sect_pr.type() != pugi::node_element) {
+            sect_pr = sect_pr.previous_sibling();
+        }
+        if (sect_pr && std::strcmp(sect_pr.name(), "w:sectPr") == 0) {
+            sect_pr = sect_doc.append_copy(sect_pr);
+        } else {
+            sect_pr = {};
+        }
+        if (!sect_pr) {
+            sect_pr = sect_doc.append_child("w:sectPr");
+        }
+        pugi::xml_node type = sect_pr.child("w:type");
+        if (!type) {
+            // Schema order: header/footer references, footnotePr, endnotePr, type
+            pugi::xml_node anchor;
+            for (auto child : sect_pr.children()) {
+                const char* name = child.name();
+                if (std::strcmp(name, "w:headerReference") == 0 ||
+                    std::strcmp(name, "w:footerReference") == 0 ||
+                    std::strcmp(name, "w:footnotePr") == 0 ||
+                    std::strcmp(name, "w:endnotePr") == 0) {
+                    anchor = child;
+                }
+            }
+            type = anchor ? sect_pr.insert_child_after("w:type", anchor)
+                          : sect_pr.prepend_child("w:type");
+        }
+        get_or_set_attribute(type, "w:val", section_start);
+
+        epilogue_.clear();
+        print_node(sect_pr, epilogue_);
+        epilogue_ += "</w:body></";
+        epilogue_ += document.name();
+        epilogue_ += '>';
+
+        // Stand-alone section break paragraph, used when the last block cannot
+        // carry the section properties itself
+        pugi::xml_document break_doc;
+        pugi::xml_node break_para = break_doc.append_child("w:p");
+        break_para.append_child("w:pPr").append_copy(sect_pr);
+        section_break_ = compile_block(break_para);
+
+        pugi::xml_node last_block;
+        for (auto child : body.children()) {
+            if (child.type() != pugi::node_element ||
+                std::strcmp(child.name(), "w:sectPr") == 0) {
+                continue;
+            }
+            blocks_.push_back(compile_block(child));
+            last_block = child;
+        }
+
+        // Variant of the last paragraph that ends the record's section
+        if (last_block && is_para_node(last_block.name()) &&
+            !last_block.child("w:pPr").child("w:sectPr")) {
+            pugi::xml_document scratch;
+            pugi::xml_node para = scratch.append_copy(last_block);
+            pugi::xml_node p_pr = get_or_create_child(para, "w:pPr");
+            if (pugi::xml_node change = p_pr.child("w:pPrChange")) {
+                p_pr.insert_copy_before(sect_pr, change);
+            } else {
+                p_pr.append_copy(sect_pr);
+            }
+            last_with_break_ = compile_block(para);
+            last_with_break_.removable = blocks_.back().removable;
+            has_last_with_break_ = true;
+        }
+    }
+
+    const std::vector<std::string>& field_names() const { return field_names_; }
+
+    /// Resolve the record's values to field slots (case-insensitive names)
+    void bind(const std::map<std::string, std::string>& record,
+              std::vector<std::string_view>& values) const {
+        values.assign(field_names_.size(), std::string_view());
+        for (const auto& entry : record) {
+            auto it = slot_by_name_.find(to_lower(entry.first));
+            if (it != slot_by_name_.end()) {
+                values[it->second] = entry.second;
+            }
+        }
+    }
+
+    /// Map field slots to source columns (-1 = no such column)
+    void bind_columns(const RecordSource& source, std::vector<int>& columns) const {
+        columns.resize(field_names_.size());
+        for (std::size_t slot = 0; slot < field_names_.size(); ++slot) {
+            columns[slot] = source.find_column(field_names_[slot]);
+        }
+    }
+
+    /**
+     * Render one record. Its last block is held back in two variants, because
+     * whether it has to end a section is only known once the next record
+     * arrives (or finish() is called).
+     */
+    void write_record(ZipEntryStream& out,
+                      const std::vector<std::string_view>& values,
+                      long long record_index) {
+        std::string& buffer = out.buffer();
+        if (record_index > 0) {
+            buffer += pending_with_break_;
+        }
+
+        const long long id_offset = record_index * id_stride_;
+        const std::size_t count = blocks_.size();
+        for (std::size_t i = 0; i + 1 < count; ++i) {
+            if (!is_removed(blocks_[i], values)) {
+                render_block(buffer, blocks_[i], values, id_offset);
+            }
+            out.commit();
+        }
+
+        pending_.clear();
+        pending_with_break_.clear();
+        if (count == 0 || is_removed(blocks_.back(), values)) {
+            render_block(pending_with_break_, section_break_, values, id_offset);
+        } else {
+            render_block(pending_, blocks_.back(), values, id_offset);
+            if (has_last_with_break_) {
+                render_block(pending_with_break_, last_with_break_, values, id_offset);
+            } else {
+                pending_with_break_ = pending_;
+                render_block(pending_with_break_, section_break_, values, id_offset);
+            }
+        }
+        out.commit();
+    }
+
+    /// Emit the held-back last block of the final record
+    void finish(ZipEntryStream& out) {
+        out.buffer() += pending_;
+        out.buffer() += epilogue_;
+    }
+
+    const std::string& prologue() const { return prologue_; }
+
+  private:
+    bool remove_empty_paragraphs_;
+    std::string prologue_;
+    std::string epilogue_;
+    std::vector<MergeBlock> blocks_;
+    MergeBlock last_with_break_;
+    bool has_last_with_break_ = false;
+    MergeBlock section_break_;
+    std::string pending_;
+    std::string pending_with_break_;
+    std::vector<std::string> field_names_;
+    std::unordered_map<std::string, int> slot_by_name_;
+    long long id_stride_ = 1;
+
+    static void print_node(pugi::xml_node node, std::string& out) {
+        StringXmlWriter writer(out);
+        node.print(writer, "", pugi::format_raw);
+    }
+
+    static void get_or_set_attribute(pugi::xml_node node, const char* name, const char* value) {
+        pugi::xml_attribute attr = node.attribute(name);
+        if (!attr) {
+            attr = node.append_attribute(name);
+        }
+        attr.set_value(value);
+    }
+
+    bool is_removed(const MergeBlock& block, const std::vector<std::string_view>& values) const {
+        if (!block.removable) {
+            return false;
+        }
+        for (const auto& segment : block.segments) {
+            if (segment.kind == kFieldSlot && !is_blank(values[segment.value])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void render_block(std::string& out,
+                             const MergeBlock& block,
+                             const std::vector<std::string_view>& values,
+                             long long id_offset) {
+        for (const auto& segment : block.segments) {
+            out += segment.xml;
+            if (segment.kind == kFieldSlot) {
+                append_field_value(out, values[segment.value]);
+            } else if (segment.kind == kIdSlot) {
+                char digits[24];
+                const auto result =
+                    std::to_chars(digits, digits + sizeof(digits), segment.value + id_offset);
+                out.append(digits, result.ptr);
+            }
+        }
+    }
+
+    int slot_for(const std::string& name) {
+        auto it = slot_by_name_.emplace(to_lower(name), static_cast<int>(field_names_.size()));
+        if (it.second) {
+            field_names_.push_back(name);
+        }
+        return it.first->second;
+    }
+
+    // Replace a field with one run carrying the placeholder text
+    void insert_field_run(pugi::xml_node before, pugi::xml_node r_pr, const std::string& name) {
+        pugi::xml_node run = before.parent().insert_child_before("w:r", before);
+        if (r_pr) {
+            run.append_copy(r_pr);
+        }
+        pugi::xml_node text = run.append_child("w:t");
+        text.append_attribute("xml:space").set_value("preserve");
+        text.text().set(make_slot(kFieldSlot, slot_for(name)).c_str());
+    }
+
+    int replace_simple_fields(pugi::xml_node root) {
+        std::vector<pugi::xml_node> fields;
+        for (auto node : root.select_nodes(".//w:fldSimple")) {
+            fields.push_back(node.node());
+        }
+        int replaced = 0;
+        for (auto field : fields) {
+            const std::string name = parse_merge_field_name(field.attribute("w:instr").value());
+            if (name.empty()) {
+                continue;
+            }
+            insert_field_run(field, field.child("w:r").child("w:rPr"), name);
+            field.parent().remove_child(field);
+            ++replaced;
+        }
+        return replaced;
+    }
+
+    // begin/instrText/separate/result/end runs within one run container
+    int replace_complex_fields(pugi::xml_node container) {
+        int replaced = 0;
+        int depth = 0;
+        bool separated = false;
+        bool field_ended = false;
+        std::string instr;
+        pugi::xml_node begin;
+        pugi::xml_node result_run;
+
+        for (pugi::xml_node run = container.first_child(); run;) {
+            pugi::xml_node next = run.next_sibling();
+            if (std::strcmp(run.name(), "w:r") != 0) {
+                run = next;
+                continue;
+            }
+            for (auto child : run.children()) {
+                const char* name = child.name();
+                if (std::strcmp(name, "w:fldChar") == 0) {
+                    const char* type = child.attribute("w:fldCharType").value();
+                    if (std::strcmp(type, "begin") == 0) {
+                        if (depth++ == 0) {
+                            begin = run;
+                            result_run = {};
+                            separated = false;
+                            instr.clear();
+                        }
+                    } else if (std::strcmp(type, "separate") == 0) {
+                        separated = separated || depth == 1;
+                    } else if (std::strcmp(type, "end") == 0 && depth > 0 && --depth == 0) {
+                        field_ended = true;
+                    }
+                } else if (depth == 1 && !separated && std::strcmp(name, "w:instrText") == 0) {
+                    instr += child.text().get();
+                } else if (depth == 1 && separated && !result_run &&
+                           std::strcmp(name, "w:t") == 0) {
+                    result_run = run;
+                }
+            }
+
+            if (field_ended) {
+                field_ended = false;
+                const std::string field_name = parse_merge_field_name(instr);
+                if (!field_name.empty()) {
+                    pugi::xml_node r_pr = (result_run ? result_run : begin).child("w:rPr");
+                    insert_field_run(begin, r_pr, field_name);
+                    for (pugi::xml_node node = begin; node != next;) {
+                        pugi::xml_node following = node.next_sibling();
+                        container.remove_child(node);
+                        node = following;
+                    }
+                    ++replaced;
+                }
+                begin = {};
+            }
+            run = next;
+        }
+        return replaced;
+    }
+
+    // Bookmark and drawing ids must stay unique across records
+    void mark_ids(pugi::xml_node root) {
+        static const std::pair<const char*, const char*> kIdAttributes[] = {
+            {"descendant-or-self::w:bookmarkStart", "w:id"},
+            {"descendant-or-self::w:bookmarkEnd", "w:id"},
+            {"descendant-or-self::wp:docPr", "id"},
+        };
+        for (const auto& entry : kIdAttributes) {
+            for (auto hit : root.select_nodes(entry.first)) {
+                pugi::xml_attribute attr = hit.node().attribute(entry.second);
+                if (!attr) {
+                    continue;
+                }
+                const long long id = attr.as_llong(0);
+                id_stride_ = std::max(id_stride_, id + 1);
+                attr.set_value(make_slot(kIdSlot, id).c_str());
+            }
+        }
+    }
+
+    static bool has_static_content(pugi::xml_node para) {
+        for (auto hit : para.select_nodes(".//w:t")) {
+            const std::string text = hit.node().text().get();
+            if (text.find(kSlotOpen) == std::string::npos && !trim_whitespace(text).empty()) {
+                return true;
+            }
+        }
+        return para.select_node(".//w:drawing | .//w:pict | .//w:object | .//w:sectPr |"
+                                " .//w:fldChar | .//w:fldSimple")
+            .node();
+    }
+
+    MergeBlock compile_block(pugi::xml_node source) {
+        pugi::xml_document scratch;
+        pugi::xml_node node = scratch.append_copy(source);
+
+        int fields = replace_simple_fields(node);
+        if (is_para_node(node.name())) {
+            fields += replace_complex_fields(node);
+        }
+        for (auto hit : node.select_nodes(".//w:p | .//w:hyperlink | .//w:smartTag")) {
+            fields += replace_complex_fields(hit.node());
+        }
+        mark_ids(node);
+
+        MergeBlock block;
+        block.removable = remove_empty_paragraphs_ && fields > 0 && is_para_node(node.name()) &&
+                          !has_static_content(node);
+
+        std::string xml;
+        print_node(node, xml);
+        std::size_t pos = 0;
+        for (;;) {
+            const std::size_t open = xml.find(kSlotOpen, pos);
+            const std::size_t close =
+                open == std::string::npos ? open : xml.find(kSlotClose, open);
+            if (close == std::string::npos) {
+                block.segments.push_back({xml.substr(pos), 0, 0});
+                break;
+            }
+            MergeSegment segment;
+            segment.xml = xml.substr(pos, open - pos);
+            segment.kind = xml[open + kSlotMarkerSize];
+            segment.value = std::stoll(xml.substr(open + kSlotMarkerSize + 1,
+                                                  close - open - kSlotMarkerSize - 1));
+            block.segments.push_back(std::move(segment));
+            pos = close + kSlotMarkerSize;
+        }
+        return block;
+    }
+};
+
+// Compiles the template, copies the shared parts and streams document.xml;
+// write_records() renders every record through the given ZipEntryStream.
+// On cancellation or a failed write the partial package is removed and -1
+// is returned.
+template <typename WriteRecords>
+int write_single_document(Document* doc,
+                          const std::string& output_path,
+                          bool remove_empty_paragraphs,
+                          BreakType break_type,
+                          const CancellationToken& token,
+                          WriteRecords write_records) {
+    doc->sync_to_physical_tree();
+    pugi::xml_document* xml = doc->get_document_xml();
+    if (!xml || !xml->child("w:document").child("w:body")) {
+        return -1;
+    }
+
+    SingleDocumentMerger merger(remove_empty_paragraphs);
+    merger.compile(xml->child("w:document"), section_start_value(break_type));
+
+    zip_t* zip = zip_open(output_path.c_str(), ZIP_DEFAULT_COMPRESSION_LEVEL, 'w');
+    if (!zip) {
+        return -1;
+    }
+
+    // Every part except document.xml is shared by all records and copied as is
+    const std::string main_part = "word/document.xml";
+    DocxTree& tree = doc->get_physical_tree();
+    bool ok = true;
+    tree.iterate_all([zip, &ok](const std::shared_ptr<DocxTreeNode>& node) {
+        if (ok && node->is_directory() && !node->name.empty()) {
+            ok = zip_entry_open(zip, (node->full_path + "/").c_str()) >= 0 &&
+                 zip_entry_close(zip) >= 0;
+        }
+    });
+    tree.iterate_files([zip, &main_part, &token, &ok](const std::shared_ptr<DocxTreeNode>& node) {
+        if (!ok || node->is_deleted || node->full_path == main_part || token.is_cancelled()) {
+            return;
+        }
+        if (zip_entry_open(zip, node->full_path.c_str()) < 0) {
+            ok = false;
+            return;
+        }
+        if (node->type == DocxNodeType::XmlFile && node->xml_doc) {
+            const std::vector<uint8_t> data = node->serialize_xml_to_binary();
+            ok = zip_entry_write(zip, data.data(), data.size()) >= 0;
+        } else {
+            ok = zip_entry_write(zip, node->binary_data.data(), node->binary_data.size()) >= 0;
+        }
+        ok = zip_entry_close(zip) >= 0 && ok;
+    });
+
+    int written = -1;
+    if (ok && zip_entry_open(zip, main_part.c_str()) >= 0) {
+        ZipEntryStream out(zip);
+        out.buffer() += merger.prologue();
+        written = write_records(merger, out);
+        merger.finish(out);
+        ok = out.flush();
+        ok = zip_entry_close(zip) >= 0 && ok;
+    } else {
+        ok = false;
+    }
+    zip_close(zip);
+
+    // A cancelled or failed merge leaves no partial package behind
+    if (!ok || token.is_cancelled()) {
+        std::error_code ec;
+        std::filesystem::remove(output_path, ec);
+        return -1;
+    }
+    return written;
+}
+
+}  // namespace
+
+int MailMerge::execute_to_single_document(const std::string& output_path,
+                                          const MailMergeRecordProvider& next_record) {
+    cancelled_ = false;
+    if (!doc_ || !next_record) {
+        return -1;
+    }
+    const int written = write_single_document(
+        doc_, output_path, has_cleanup_option(MailMergeCleanupOptions::RemoveEmptyParagraphs),
+        record_break_type_, cancellation_token_,
+        [this, &next_record](SingleDocumentMerger& merger, ZipEntryStream& out) {
+            std::map<std::string, std::string> record;
+            std::vector<std::string_view> values;
+            int written = 0;
+            while (!cancellation_token_.is_cancelled() && next_record(record)) {
+                merger.bind(record, values);
+                merger.write_record(out, values, written++);
+                record.clear();
+            }
+            return written;
+        });
+    cancelled_ = written < 0 && cancellation_token_.is_cancelled();
+    return written;
+}
+
+int MailMerge::execute_to_single_document(const std::string& output_path, RecordSource& source) {
+    cancelled_ = false;
+    if (!doc_) {
+        return -1;
+    }
+    const int written = write_single_document(
+        doc_, output_path, has_cleanup_option(MailMergeCleanupOptions::RemoveEmptyParagraphs),
+        record_break_type_, cancellation_token_,
+        [this, &source](SingleDocumentMerger& merger, ZipEntryStream& out) {
+            std::vector<int> columns;
+            std::size_t bound_columns = 0;
+            std::vector<std::string_view> values(merger.field_names().size());
+            int written = 0;
+            while (!cancellation_token_.is_cancelled() && source.next()) {
+                // Schema-less sources may add columns while reading
+                if (columns.empty() || source.get_columns().size() != bound_columns) {
+                    merger.bind_columns(source, columns);
+                    bound_columns = source.get_columns().size();
+                }
+                for (std::size_t slot = 0; slot < columns.size(); ++slot) {
+                    values[slot] = columns[slot] < 0
+                                       ? std::string_view()
+                                       : source.get_field(static_cast<std::size_t>(columns[slot]));
+                }
+                merger.write_record(out, values, written++);
+            }
+            return written;
+        });
+    cancelled_ = written < 0 && cancellation_token_.is_cancelled();
+    return written;
+}
+
+int MailMerge::execute_to_single_document(
+    const std::string& output_path,
+    const std::vector<std::map<std::string, std::string>>& records) {
+    std::size_t next = 0;
+    return execute_to_single_document(output_path,
+                                      [&](std::map<std::string, std::string>& record) {
+                                          if (next >= records.size()) {
+                                              return false;
+                                          }
+                                          record = records[next++];
+                                          return true;
+                                      });
+}
+
 }  // namespace cdocx
@@ -0,0 +1,37 @@
+/**
+ * @file mapped_file.h
+ * @brief Internal read-only memory mapping of a whole file
+ * @internal Not part of the public API.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace cdocx {
+
+/// Read-only memory mapping of a whole file
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const { return open_; }
+    std::string_view data() const { return {data_, size_}; }
+
+  private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool open_ = false;
+#ifdef _WIN32
+    void* file_ = nullptr;  ///< HANDLE; nullptr when not opened
+    void* mapping_ = nullptr;
+#endif
+};
+
+}  // namespace cdocx
@@ -20,6 +20,12 @@ void Node::remove() {
     }
 }
 
+void Node::notify_content_changed() {
+    if (parent_) {
+        parent_->on_content_changed();
+    }
+}
+
 int Node::get_index() const {
     if (!parent_) {
         return -1;
@@ -146,6 +152,7 @@ std::shared_ptr<Node> CompositeNode::append_child(std::shared_ptr<Node> child) {
     }
 
     children_.push_back(child);
+    on_content_changed();
     return child;
 }
 
@@ -163,6 +170,7 @@ std::shared_ptr<Node> CompositeNode::prepend_child(std::shared_ptr<Node> child)
     }
 
     children_.insert(children_.begin(), child);
+    on_content_changed();
     return child;
 }
 
@@ -189,6 +197,7 @@ std::shared_ptr<Node> CompositeNode::insert_child(int index, std::shared_ptr<Nod
         children_.insert(it, child);
     }
 
+    on_content_changed();
     return child;
 }
 
@@ -237,6 +246,7 @@ void CompositeNode::remove_child(const std::shared_ptr<Node>& child) {
 
             child->set_parent(nullptr);
             children_.erase(it);
+            on_content_changed();
             return;
         }
     }
@@ -253,6 +263,7 @@ void CompositeNode::remove_all_children() {
         child->set_parent(nullptr);
     }
     children_.clear();
+    on_content_changed();
 }
 
 std::string CompositeNode::get_text() const {
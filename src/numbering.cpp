@@ -7,6 +7,7 @@
 #include <cdocx/numbering.h>
 
 #include <cstring>
+#include <initializer_list>
 #include <sstream>
 
 #include "sync_common.h"
@@ -168,16 +169,299 @@ AbstractNumberingDefinition AbstractNumberingDefinition::make_outline_list() {
     return def;
 }
 
+// ============================================================================
+// Abstract Definition Keys and Serialization
+// ============================================================================
+
+namespace {
+
+using Indentation = ParagraphProperties::Indentation;
+
+constexpr char kKeySeparator = '\x1f';
+
+void append_key_field(std::string& key, const std::string& value) {
+    key += value;
+    key += kKeySeparator;
+}
+
+void append_key_field(std::string& key, long long value) {
+    key += std::to_string(value);
+    key += kKeySeparator;
+}
+
+// Everything numbering.xml stores for an abstract definition, in canonical
+// form. Identifiers (w:abstractNumId, w:nsid, w:tmpl) are not part of it.
+std::string structure_key(const AbstractNumberingDefinition& def) {
+    std::string key;
+    key.reserve(640);
+    append_key_field(key, static_cast<long long>(def.type));
+    for (const auto& level : def.levels) {
+        append_key_field(key, static_cast<long long>(level.start_number));
+        append_key_field(key, static_cast<long long>(level.number_style));
+        append_key_field(key, static_cast<long long>(level.number_alignment));
+        append_key_field(key, level.level_text);
+        append_key_field(key, level.level_font.ascii);
+        append_key_field(key, level.level_font.east_asia);
+        append_key_field(key, level.level_font.h_ansi);
+        append_key_field(key, level.level_font.cs);
+        if (!level.indent) {
+            append_key_field(key, "-");
+            continue;
+        }
+        // Only what write_indentation() emits, so keys survive a round trip
+        const Indentation& ind = *level.indent;
+        append_key_field(key, static_cast<long long>(ind.left.type));
+        append_key_field(key, ind.left.value);
+        if (ind.right.value != 0) {
+            append_key_field(key, static_cast<long long>(ind.right.type));
+            append_key_field(key, ind.right.value);
+        }
+        append_key_field(key, static_cast<long long>(ind.special.kind));
+        if (ind.special.kind != Indentation::Special::Kind::None) {
+            append_key_field(key, static_cast<long long>(ind.special.type));
+            append_key_field(key, ind.special.value);
+        }
+    }
+    return key;
+}
+
+// Raw XML of content the manager does not model, so that definitions that
+// differ only there are never merged
+void append_raw_xml(std::string& key, pugi::xml_node node) {
+    std::ostringstream out;
+    node.print(out, "", pugi::format_raw);
+    append_key_field(key, out.str());
+}
+
+bool is_one_of(const char* name, std::initializer_list<const char*> names) {
+    for (const char* candidate : names) {
+        if (std::strcmp(name, candidate) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* numbering_type_to_string(NumberingType type) {
+    switch (type) {
+        case NumberingType::SingleLevel:
+            return "singleLevel";
+        case NumberingType::MultiLevel:
+            return "multilevel";
+        case NumberingType::HybridMultiLevel:
+            return "hybridMultilevel";
+    }
+    return "hybridMultilevel";
+}
+
+NumberingType string_to_numbering_type(const char* val) {
+    if (std::strcmp(val, "singleLevel") == 0) {
+        return NumberingType::SingleLevel;
+    }
+    if (std::strcmp(val, "multilevel") == 0) {
+        return NumberingType::MultiLevel;
+    }
+    return NumberingType::HybridMultiLevel;
+}
+
+void write_indentation(pugi::xml_node p_pr, const Indentation& indent) {
+    auto ind = p_pr.append_child("w:ind");
+    const bool left_chars = indent.left.type == Indentation::Type::Character;
+    ind.append_attribute(left_chars ? "w:leftChars" : "w:left").set_value(indent.left.value);
+    if (indent.right.value != 0) {
+        const bool right_chars = indent.right.type == Indentation::Type::Character;
+        ind.append_attribute(right_chars ? "w:rightChars" : "w:right")
+            .set_value(indent.right.value);
+    }
+    if (indent.special.kind != Indentation::Special::Kind::None) {
+        const bool hanging = indent.special.kind == Indentation::Special::Kind::Hanging;
+        const bool chars = indent.special.type == Indentation::Type::Character;
+        const char* attr = hanging ? (chars ? "w:hangingChars" : "w:hanging")
+                                   : (chars ? "w:firstLineChars" : "w:firstLine");
+        ind.append_attribute(attr).set_value(indent.special.value);
+    }
+}
+
+// Parse w:ind; unmodelled attributes go to @p extra
+Indentation parse_indentation(pugi::xml_node ind, std::string& extra) {
+    Indentation indent;
+    indent.special.type = Indentation::Type::Absolute;
+    for (auto attr : ind.attributes()) {
+        const char* name = attr.name();
+        if (std::strcmp(name, "w:left") == 0 || std::strcmp(name, "w:start") == 0) {
+            indent.left = {Indentation::Type::Absolute, attr.as_int()};
+        } else if (std::strcmp(name, "w:leftChars") == 0) {
+            indent.left = {Indentation::Type::Character, attr.as_int()};
+        } else if (std::strcmp(name, "w:right") == 0 || std::strcmp(name, "w:end") == 0) {
+            indent.right = {Indentation::Type::Absolute, attr.as_int()};
+        } else if (std::strcmp(name, "w:rightChars") == 0) {
+            indent.right = {Indentation::Type::Character, attr.as_int()};
+        } else if (std::strcmp(name, "w:hanging") == 0 ||
+                   std::strcmp(name, "w:firstLine") == 0) {
+            indent.special.kind = name[2] == 'h' ? Indentation::Special::Kind::Hanging
+                                                 : Indentation::Special::Kind::FirstLine;
+            indent.special.value = attr.as_int();
+        } else if (std::strcmp(name, "w:hangingChars") == 0 ||
+                   std::strcmp(name, "w:firstLineChars") == 0) {
+            indent.special.kind = name[2] == 'h' ? Indentation::Special::Kind::Hanging
+                                                 : Indentation::Special::Kind::FirstLine;
+            indent.special.type = Indentation::Type::Character;
+            indent.special.value = attr.as_int();
+        } else {
+            append_key_field(extra, std::string(name) + '=' + attr.value());
+        }
+    }
+    return indent;
+}
+
+void write_level(pugi::xml_node lvl, int ilvl, const LevelDefinition& level) {
+    lvl.append_attribute("w:ilvl").set_value(ilvl);
+
+    lvl.append_child("w:start").append_attribute("w:val").set_value(
+        static_cast<unsigned int>(level.start_number));
+    lvl.append_child("w:numFmt").append_attribute("w:val").set_value(
+        number_style_to_string(level.number_style));
+    lvl.append_child("w:lvlText").append_attribute("w:val").set_value(level.level_text.c_str());
+    lvl.append_child("w:lvlJc").append_attribute("w:val").set_value(
+        pp_alignment_to_string(level.number_alignment));
+
+    if (level.indent) {
+        write_indentation(lvl.append_child("w:pPr"), *level.indent);
+    }
+
+    auto fonts = lvl.append_child("w:rPr").append_child("w:rFonts");
+    fonts.append_attribute("w:ascii").set_value(level.level_font.ascii.c_str());
+    fonts.append_attribute("w:eastAsia").set_value(level.level_font.east_asia.c_str());
+    fonts.append_attribute("w:hAnsi").set_value(level.level_font.h_ansi.c_str());
+    fonts.append_attribute("w:cs").set_value(level.level_font.cs.c_str());
+}
+
+// Parse a w:lvl; unmodelled content goes to @p extra
+LevelDefinition parse_level(pugi::xml_node lvl, std::string& extra) {
+    LevelDefinition level;
+    bool has_fonts = false;
+    for (auto child : lvl.children()) {
+        const char* name = child.name();
+        if (std::strcmp(name, "w:start") == 0) {
+            level.start_number = child.attribute("w:val").as_uint();
+        } else if (std::strcmp(name, "w:numFmt") == 0) {
+            level.number_style = string_to_number_style(child.attribute("w:val").value());
+        } else if (std::strcmp(name, "w:lvlText") == 0) {
+            level.level_text = child.attribute("w:val").value();
+        } else if (std::strcmp(name, "w:lvlJc") == 0) {
+            level.number_alignment = string_to_pp_alignment(child.attribute("w:val").value());
+        } else if (std::strcmp(name, "w:pPr") == 0) {
+            for (auto prop : child.children()) {
+                if (std::strcmp(prop.name(), "w:ind") == 0) {
+                    level.indent = parse_indentation(prop, extra);
+                } else {
+                    append_raw_xml(extra, prop);
+                }
+            }
+        } else if (std::strcmp(name, "w:rPr") == 0) {
+            for (auto prop : child.children()) {
+                if (std::strcmp(prop.name(), "w:rFonts") != 0) {
+                    append_raw_xml(extra, prop);
+                    continue;
+                }
+                has_fonts = true;
+                level.level_font.ascii = prop.attribute("w:ascii").value();
+                level.level_font.east_asia = prop.attribute("w:eastAsia").value();
+                level.level_font.h_ansi = prop.attribute("w:hAnsi").value();
+                level.level_font.cs = prop.attribute("w:cs").value();
+                for (auto attr : prop.attributes()) {
+                    if (!is_one_of(attr.name(), {"w:ascii", "w:eastAsia", "w:hAnsi", "w:cs"})) {
+                        append_key_field(extra, std::string(attr.name()) + '=' + attr.value());
+                    }
+                }
+            }
+        } else {
+            append_raw_xml(extra, child);
+        }
+    }
+    for (auto attr : lvl.attributes()) {
+        if (!is_one_of(attr.name(), {"w:ilvl", "w:tplc"})) {
+            append_key_field(extra, std::string(attr.name()) + '=' + attr.value());
+        }
+    }
+    if (!has_fonts) {
+        append_key_field(extra, "no-fonts");
+    }
+    return level;
+}
+
+void write_abstract_num(pugi::xml_node abstract_num,
+                        AbstractNumberingId id,
+                        const AbstractNumberingDefinition& def) {
+    abstract_num.append_attribute("w:abstractNumId").set_value(static_cast<unsigned int>(id));
+    abstract_num.append_child("w:multiLevelType")
+        .append_attribute("w:val")
+        .set_value(numbering_type_to_string(def.type));
+    for (int i = 0; i < 9; ++i) {
+        write_level(abstract_num.append_child("w:lvl"), i, def.levels[i]);
+    }
+}
+
+void write_num(pugi::xml_node num, NumberingId id, const NumberingDefinition& def) {
+    num.append_attribute("w:numId").set_value(static_cast<unsigned int>(id));
+    num.append_child("w:abstractNumId")
+        .append_attribute("w:val")
+        .set_value(static_cast<unsigned int>(def.abstract_id));
+
+    std::set<NumberingLevel> levels;
+    for (const auto& entry : def.start_overrides) {
+        levels.insert(entry.first);
+    }
+    for (const auto& entry : def.level_overrides) {
+        levels.insert(entry.first);
+    }
+    for (const NumberingLevel level : levels) {
+        auto lvl_override = num.append_child("w:lvlOverride");
+        lvl_override.append_attribute("w:ilvl").set_value(numbering_level_to_int(level));
+
+        auto start = def.start_overrides.find(level);
+        if (start != def.start_overrides.end()) {
+            lvl_override.append_child("w:startOverride")
+                .append_attribute("w:val")
+                .set_value(static_cast<unsigned int>(start->second));
+        }
+        auto level_def = def.level_overrides.find(level);
+        if (level_def != def.level_overrides.end()) {
+            write_level(lvl_override.append_child("w:lvl"),
+                        numbering_level_to_int(level),
+                        level_def->second);
+        }
+    }
+}
+
+}  // namespace
+
 // ============================================================================
 // NumberingManager Implementation
 // ============================================================================
 
 AbstractNumberingId NumberingManager::add_abstract_definition(
     const AbstractNumberingDefinition& def) {
+    return intern_abstract_definition(def, structure_key(def), nullptr);
+}
+
+AbstractNumberingId NumberingManager::intern_abstract_definition(
+    const AbstractNumberingDefinition& def, const std::string& key, bool* reused) {
+    auto existing = abstract_index_.find(key);
+    if (reused) {
+        *reused = existing != abstract_index_.end();
+    }
+    if (existing != abstract_index_.end()) {
+        return existing->second;
+    }
+
     const AbstractNumberingId id = next_abstract_id_++;
     AbstractNumberingDefinition mutable_def = def;
     mutable_def.id = id;
     abstract_definitions_[id] = mutable_def;
+    abstract_index_.emplace(key, id);
+    abstract_keys_[id] = key;
+    unsaved_abstract_ids_.insert(id);
     modified_ = true;
     return id;
 }
@@ -187,40 +471,39 @@ NumberingId NumberingManager::add_numbering_definition(const NumberingDefinition
     NumberingDefinition mutable_def = def;
     mutable_def.id = id;
     num_definitions_[id] = mutable_def;
+    unsaved_num_ids_.insert(id);
     modified_ = true;
     return id;
 }
 
-NumberingId NumberingManager::add_bulleted_list_definition() {
-    auto abstract_def = AbstractNumberingDefinition::make_bulleted_list();
-    const AbstractNumberingId abstract_id = add_abstract_definition(abstract_def);
+NumberingId NumberingManager::add_list_definition(const AbstractNumberingDefinition& def) {
+    bool reused = false;
+    const AbstractNumberingId abstract_id =
+        intern_abstract_definition(def, structure_key(def), &reused);
 
-    const NumberingDefinition num_def(abstract_id);
+    NumberingDefinition num_def(abstract_id);
+    if (reused) {
+        // Instances of one abstract definition continue each other's
+        // numbering unless restarted
+        num_def.start_overrides[NumberingLevel::Level1] = def.levels[0].start_number;
+    }
     return add_numbering_definition(num_def);
 }
 
-NumberingId NumberingManager::add_numbered_list_definition(NumberStyle style) {
-    auto abstract_def = AbstractNumberingDefinition::make_numbered_list(style);
-    const AbstractNumberingId abstract_id = add_abstract_definition(abstract_def);
+NumberingId NumberingManager::add_bulleted_list_definition() {
+    return add_list_definition(AbstractNumberingDefinition::make_bulleted_list());
+}
 
-    const NumberingDefinition num_def(abstract_id);
-    return add_numbering_definition(num_def);
+NumberingId NumberingManager::add_numbered_list_definition(NumberStyle style) {
+    return add_list_definition(AbstractNumberingDefinition::make_numbered_list(style));
 }
 
 NumberingId NumberingManager::add_chinese_numbered_list_definition() {
-    auto abstract_def = AbstractNumberingDefinition::make_chinese_numbered_list();
-    const AbstractNumberingId abstract_id = add_abstract_definition(abstract_def);
-
-    const NumberingDefinition num_def(abstract_id);
-    return add_numbering_definition(num_def);
+    return add_list_definition(AbstractNumberingDefinition::make_chinese_numbered_list());
 }
 
 NumberingId NumberingManager::add_outline_list_definition() {
-    auto abstract_def = AbstractNumberingDefinition::make_outline_list();
-    const AbstractNumberingId abstract_id = add_abstract_definition(abstract_def);
-
-    const NumberingDefinition num_def(abstract_id);
-    return add_numbering_definition(num_def);
+    return add_list_definition(AbstractNumberingDefinition::make_outline_list());
 }
 
 const AbstractNumberingDefinition* NumberingManager::get_abstract_definition(
@@ -249,16 +532,54 @@ bool NumberingManager::override_level(NumberingId num_id,
     }
 
     it->second.level_overrides[level] = level_def;
+    unsaved_num_ids_.insert(num_id);
     modified_ = true;
     return true;
 }
 
+std::map<NumberingId, NumberingId> NumberingManager::import_definitions(
+    const NumberingManager& source) {
+    std::map<NumberingId, NumberingId> id_map;
+    if (&source == this) {
+        for (const auto& entry : num_definitions_) {
+            id_map[entry.first] = entry.first;
+        }
+        return id_map;
+    }
+
+    std::map<AbstractNumberingId, std::pair<AbstractNumberingId, bool>> abstract_map;
+    for (const auto& [id, def] : source.abstract_definitions_) {
+        auto key = source.abstract_keys_.find(id);
+        bool reused = false;
+        const AbstractNumberingId target_id = intern_abstract_definition(
+            def, key != source.abstract_keys_.end() ? key->second : structure_key(def), &reused);
+        abstract_map[id] = {target_id, reused};
+    }
+
+    for (const auto& [id, def] : source.num_definitions_) {
+        auto abstract = abstract_map.find(def.abstract_id);
+        if (abstract == abstract_map.end()) {
+            continue;
+        }
+        NumberingDefinition num_def = def;
+        num_def.abstract_id = abstract->second.first;
+        if (abstract->second.second && num_def.start_overrides.empty()) {
+            // Do not continue a list of this document
+            const auto& levels = abstract_definitions_[num_def.abstract_id].levels;
+            num_def.start_overrides[NumberingLevel::Level1] = levels[0].start_number;
+        }
+        id_map[id] = add_numbering_definition(num_def);
+    }
+    return id_map;
+}
+
 void NumberingManager::load_from_xml(pugi::xml_node numbering_root) {
     clear();
 
     // Parse abstract numbering definitions
     for (const auto& abstract_num : numbering_root.children("w:abstractNum")) {
         AbstractNumberingDefinition def;
+        std::string extra;
 
         // Parse abstract_numId
         auto id_attr = abstract_num.attribute("w:abstractNumId");
@@ -269,42 +590,28 @@ void NumberingManager::load_from_xml(pugi::xml_node numbering_root) {
             }
         }
 
-        // Parse levels
-        for (const auto& lvl : abstract_num.children("w:lvl")) {
-            auto ilvl = lvl.attribute("w:ilvl");
-            if (!ilvl) {
-                continue;
-            }
-
-            const int level = ilvl.as_int();
-            if (level < 0 || level >= 9) {
-                continue;
-            }
-
-            LevelDefinition level_def;
-
-            // Parse number format
-            auto num_fmt = lvl.child("w:numFmt");
-            if (num_fmt) {
-                const char* val = num_fmt.attribute("w:val").value();
-                level_def.number_style = string_to_number_style(val);
-            }
-
-            // Parse level text
-            auto lvl_text = lvl.child("w:lvlText");
-            if (lvl_text) {
-                level_def.level_text = lvl_text.attribute("w:val").value();
-            }
-
-            // Parse start number
-            auto start = lvl.child("w:start");
-            if (start) {
-                level_def.start_number = start.attribute("w:val").as_uint();
+        for (const auto& child : abstract_num.children()) {
+            const char* name = child.name();
+            if (std::strcmp(name, "w:lvl") == 0) {
+                const int level = child.attribute("w:ilvl").as_int(-1);
+                if (level >= 0 && level < 9) {
+                    std::string level_extra;
+                    def.levels[level] = parse_level(child, level_extra);
+                    if (!level_extra.empty()) {
+                        append_key_field(extra, std::to_string(level) + ':' + level_extra);
+                    }
+                }
+            } else if (std::strcmp(name, "w:multiLevelType") == 0) {
+                def.type = string_to_numbering_type(child.attribute("w:val").value());
+            } else if (!is_one_of(name, {"w:nsid", "w:tmpl"})) {
+                append_raw_xml(extra, child);
             }
-
-            def.levels[level] = level_def;
         }
 
+        // Index the first of several identical definitions
+        std::string key = structure_key(def) + extra;
+        abstract_index_.emplace(key, def.id);
+        abstract_keys_[def.id] = std::move(key);
         abstract_definitions_[def.id] = def;
     }
 
@@ -325,9 +632,19 @@ void NumberingManager::load_from_xml(pugi::xml_node numbering_root) {
             def.abstract_id = abstract_id.attribute("w:val").as_uint();
         }
 
+        for (const auto& lvl_override : num.children("w:lvlOverride")) {
+            const int level = lvl_override.attribute("w:ilvl").as_int(-1);
+            auto start = lvl_override.child("w:startOverride");
+            if (start && level >= 0 && level < 9) {
+                def.start_overrides[static_cast<NumberingLevel>(level)] =
+                    start.attribute("w:val").as_uint();
+            }
+        }
+
         num_definitions_[def.id] = def;
     }
 
+    first_unsaved_num_id_ = next_num_id_;
     modified_ = false;
 }
 
@@ -343,71 +660,78 @@ void NumberingManager::save_to_xml(pugi::xml_node numbering_root) {
 
     // Save abstract numbering definitions
     for (const auto& [id, def] : abstract_definitions_) {
-        auto abstract_num = numbering_root.append_child("w:abstractNum");
-        abstract_num.append_attribute("w:abstractNumId").set_value(static_cast<unsigned int>(id));
-
-        // Add multi-level type if applicable
-        if (def.type == NumberingType::MultiLevel || def.type == NumberingType::HybridMultiLevel) {
-            auto multi_level_type = abstract_num.append_child("w:multi_level_type");
-            multi_level_type.append_attribute("w:val").set_value(
-                def.type == NumberingType::HybridMultiLevel ? "hybridMultilevel" : "multilevel");
-        }
-
-        // Save levels
-        for (int i = 0; i < 9; ++i) {
-            const auto& level = def.levels[i];
-
-            auto lvl = abstract_num.append_child("w:lvl");
-            lvl.append_attribute("w:ilvl").set_value(i);
-
-            // Start number
-            auto start = lvl.append_child("w:start");
-            start.append_attribute("w:val").set_value(
-                static_cast<unsigned int>(level.start_number));
-
-            // Number format
-            auto num_fmt = lvl.append_child("w:numFmt");
-            num_fmt.append_attribute("w:val").set_value(number_style_to_string(level.number_style));
-
-            // Level text
-            auto lvl_text = lvl.append_child("w:lvlText");
-            lvl_text.append_attribute("w:val").set_value(level.level_text.c_str());
-
-            // Level justification
-            auto lvl_jc = lvl.append_child("w:lvlJc");
-            lvl_jc.append_attribute("w:val").set_value(
-                pp_alignment_to_string(level.number_alignment));
-        }
+        write_abstract_num(numbering_root.append_child("w:abstractNum"), id, def);
     }
 
     // Save numbering instances
     for (const auto& [id, def] : num_definitions_) {
-        auto num = numbering_root.append_child("w:num");
-        num.append_attribute("w:numId").set_value(static_cast<unsigned int>(id));
+        write_num(numbering_root.append_child("w:num"), id, def);
+    }
 
-        auto abstract_num_id = num.append_child("w:abstractNumId");
-        abstract_num_id.append_attribute("w:val").set_value(
-            static_cast<unsigned int>(def.abstract_id));
+    unsaved_abstract_ids_.clear();
+    unsaved_num_ids_.clear();
+    first_unsaved_num_id_ = next_num_id_;
+    modified_ = false;
+}
 
-        // Save level overrides
-        for (const auto& [level, level_def] : def.level_overrides) {
-            auto lvl_override = num.append_child("w:lvlOverride");
-            lvl_override.append_attribute("w:ilvl").set_value(numbering_level_to_int(level));
+void NumberingManager::save_changes_to_xml(pugi::xml_node numbering_root) {
+    // w:abstractNum elements precede all w:num elements
+    const pugi::xml_node first_num = numbering_root.child("w:num");
+    for (const AbstractNumberingId id : unsaved_abstract_ids_) {
+        auto it = abstract_definitions_.find(id);
+        if (it == abstract_definitions_.end()) {
+            continue;
+        }
+        auto abstract_num = first_num
+                                ? numbering_root.insert_child_before("w:abstractNum", first_num)
+                                : numbering_root.append_child("w:abstractNum");
+        write_abstract_num(abstract_num, id, it->second);
+    }
 
-            auto lvl = lvl_override.append_child("w:lvl");
-            lvl.append_attribute("w:ilvl").set_value(numbering_level_to_int(level));
+    // Instances that already exist in the XML are replaced in place
+    std::unordered_map<unsigned int, pugi::xml_node> existing;
+    if (!unsaved_num_ids_.empty() && *unsaved_num_ids_.begin() < first_unsaved_num_id_) {
+        for (auto num : numbering_root.children("w:num")) {
+            existing[num.attribute("w:numId").as_uint()] = num;
+        }
+    }
 
-            // Override properties would be saved here
-            (void)level_def;  // Avoid unused warning
+    // w:numIdMacAtCleanup, if present, must stay last
+    const pugi::xml_node cleanup = numbering_root.child("w:numIdMacAtCleanup");
+    for (const NumberingId id : unsaved_num_ids_) {
+        auto it = num_definitions_.find(id);
+        if (it == num_definitions_.end()) {
+            continue;
         }
+        pugi::xml_node num;
+        auto old = existing.find(static_cast<unsigned int>(id));
+        if (old != existing.end()) {
+            num = numbering_root.insert_child_before("w:num", old->second);
+            numbering_root.remove_child(old->second);
+        } else if (cleanup) {
+            num = numbering_root.insert_child_before("w:num", cleanup);
+        } else {
+            num = numbering_root.append_child("w:num");
+        }
+        write_num(num, id, it->second);
     }
+
+    unsaved_abstract_ids_.clear();
+    unsaved_num_ids_.clear();
+    first_unsaved_num_id_ = next_num_id_;
+    modified_ = false;
 }
 
 void NumberingManager::clear() {
     abstract_definitions_.clear();
     num_definitions_.clear();
+    abstract_index_.clear();
+    abstract_keys_.clear();
+    unsaved_abstract_ids_.clear();
+    unsaved_num_ids_.clear();
     next_abstract_id_ = 0;
     next_num_id_ = 1;
+    first_unsaved_num_id_ = 1;
     modified_ = false;
 }
 
@@ -0,0 +1,86 @@
+/**
+ * @file page_layout.h
+ * @brief Internal page layout state kept between Document::update_pagination() calls
+ * @internal Not part of the public API.
+ * @details The body of a section is a list of blocks (top-level paragraphs
+ *          and tables), each measured into lines (table rows count as lines)
+ *          that are then placed onto pages. Measuring is the expensive part
+ *          and is cached per paragraph under a key of its content and
+ *          formatting; placing is resumed from the first block whose lines
+ *          changed, using the page position recorded in front of it.
+ */
+
+#pragma once
+
+#include <cdocx/document.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace cdocx {
+
+class Paragraph;
+class Section;
+
+/// One line of a paragraph or one table row
+struct LayoutLine {
+    enum class Break : std::uint8_t { None, Column, Page };
+
+    double height = 0;  ///< Points, line spacing included
+    Break break_after = Break::None;
+
+    bool operator==(const LayoutLine& other) const {
+        return height == other.height && break_after == other.break_after;
+    }
+};
+
+/// Lines and pagination options of one top-level paragraph or table
+struct BlockLayout {
+    const Node* node = nullptr;
+    double space_before = 0;
+    double space_after = 0;
+    bool keep_with_next = false;
+    bool keep_together = false;
+    bool page_break_before = false;
+    std::vector<LayoutLine> lines;
+
+    bool operator==(const BlockLayout& other) const {
+        return node == other.node && space_before == other.space_before &&
+               space_after == other.space_after && keep_with_next == other.keep_with_next &&
+               keep_together == other.keep_together &&
+               page_break_before == other.page_break_before && lines == other.lines;
+    }
+};
+
+/// A place in the flow of a section: the frame (column) and the height used in it
+struct FlowPosition {
+    int frame = 0;
+    double y = 0;
+};
+
+/// A paragraph's measured layout and the key it was measured under
+struct MeasuredParagraph {
+    std::uint64_t key = 0;
+    BlockLayout layout;
+};
+
+struct SectionLayout {
+    const Section* section = nullptr;
+    double frame_width = 0;  ///< Column width and height the blocks were laid out in
+    double frame_height = 0;
+    int columns = 1;
+    std::unordered_map<const Paragraph*, MeasuredParagraph> measured;
+    std::vector<BlockLayout> blocks;
+    std::vector<FlowPosition> before;  ///< Position in front of each block, then the end
+    std::vector<int> first_page;       ///< Page (0-based, in the section) of each block
+    int page_count = 1;
+};
+
+struct Document::PaginationState {
+    std::vector<SectionLayout> sections;
+    std::unordered_map<const Node*, int> block_pages;  ///< 1-based page of each block
+    int page_count = 0;
+};
+
+}  // namespace cdocx
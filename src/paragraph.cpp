@@ -57,6 +57,11 @@ Paragraph::Paragraph(Document* doc) {
     set_document(doc);
 }
 
+std::uint64_t Paragraph::next_content_version() {
+    static std::atomic<std::uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 Paragraph::Paragraph(const Paragraph& other)
     : CompositeNode(other),
       format_(other.format_),
@@ -78,6 +83,7 @@ Paragraph& Paragraph::operator=(const Paragraph& other) {
         parent_ = other.parent_;
         current_ = other.current_;
         run_ = other.run_;
+        content_version_ = next_content_version();
         preserved_p_pr_.reset();
         if (other.preserved_p_pr_.first_child()) {
             preserved_p_pr_.append_copy(other.preserved_p_pr_.first_child());
@@ -300,12 +306,24 @@ std::shared_ptr<Run> Paragraph::append_run(const std::string& text) {
     return run;
 }
 
+std::shared_ptr<Run> Paragraph::append_run(std::string&& text) {
+    auto run = std::make_shared<Run>(get_document(), std::move(text));
+    append_child(run);
+    return run;
+}
+
 std::shared_ptr<Run> Paragraph::insert_run(int index, const std::string& text) {
     auto run = std::make_shared<Run>(get_document(), text);
     insert_child(index, run);
     return run;
 }
 
+std::shared_ptr<Run> Paragraph::insert_run(int index, std::string&& text) {
+    auto run = std::make_shared<Run>(get_document(), std::move(text));
+    insert_child(index, run);
+    return run;
+}
+
 std::shared_ptr<Run> Paragraph::get_first_run() const {
     return get_first_child<Run>();
 }
@@ -328,19 +346,24 @@ void Paragraph::set_text(const std::string& text) {
     append_run(text);
 }
 
-void Paragraph::append_text(const std::string& text) {
+void Paragraph::set_text(std::string&& text) {
+    remove_all_children();
+    append_run(std::move(text));
+}
+
+void Paragraph::append_text(std::string_view text) {
     if (auto last_run = get_last_run()) {
         last_run->append_text(text);
     } else {
-        append_run(text);
+        append_run(std::string(text));
     }
 }
 
-void Paragraph::prepend_text(const std::string& text) {
+void Paragraph::prepend_text(std::string_view text) {
     if (auto first_run = get_first_run()) {
         first_run->prepend_text(text);
     } else {
-        append_run(text);
+        append_run(std::string(text));
     }
 }
 
@@ -5,23 +5,23 @@
  */
 
 #include <cdocx/base.h>
+#include <cdocx/format_context.h>
 #include <cdocx/paragraph.h>
 #include <cdocx/paragraph_builder.h>
+#include <cdocx/properties.h>
+
+#include "run_text.h"
 
 namespace cdocx {
 
-ParagraphBuilder::ParagraphBuilder() : para_(std::make_shared<Paragraph>()) {
-}
+ParagraphBuilder::ParagraphBuilder() = default;
 
-ParagraphBuilder::ParagraphBuilder(const std::string& text) : para_(std::make_shared<Paragraph>()) {
-    para_->append_text(text);
+ParagraphBuilder::ParagraphBuilder(const std::string& text) {
+    runs_.push_back({text, RunFormat{}});
 }
 
 ParagraphBuilder& ParagraphBuilder::add_run(const std::string& text) {
-    auto run = std::make_shared<Run>();
-    run->set_text(text);
-    apply_current_formatting(*run);
-    para_->append_child(run);
+    runs_.push_back({text, format_});
     return *this;
 }
 
@@ -29,44 +29,41 @@ ParagraphBuilder& ParagraphBuilder::add_run(const std::string& text,
                                             bool bold,
                                             bool italic,
                                             int font_size) {
-    auto run = std::make_shared<Run>();
-    run->set_text(text);
-    run->set_bold(bold);
-    run->set_italic(italic);
-    if (font_size > 0) {
-        run->set_font_size(font_size);
-    }
-    para_->append_child(run);
+    RunFormat format;
+    format.bold = bold;
+    format.italic = italic;
+    format.font_size = font_size;
+    runs_.push_back({text, std::move(format)});
     return *this;
 }
 
 ParagraphBuilder& ParagraphBuilder::set_bold(bool value) {
-    bold_ = value;
+    format_.bold = value;
     return *this;
 }
 
 ParagraphBuilder& ParagraphBuilder::set_italic(bool value) {
-    italic_ = value;
+    format_.italic = value;
     return *this;
 }
 
 ParagraphBuilder& ParagraphBuilder::set_underline(bool value) {
-    underline_ = value;
+    format_.underline = value;
     return *this;
 }
 
 ParagraphBuilder& ParagraphBuilder::set_font_name(const std::string& name) {
-    font_name_ = name;
+    format_.font_name = name;
     return *this;
 }
 
 ParagraphBuilder& ParagraphBuilder::set_font_size(int size) {
-    font_size_ = size;
+    format_.font_size = size;
     return *this;
 }
 
 ParagraphBuilder& ParagraphBuilder::set_color(const std::string& color_hex) {
-    color_ = color_hex;
+    format_.color = color_hex;
     return *this;
 }
 
@@ -76,36 +73,77 @@ ParagraphBuilder& ParagraphBuilder::set_alignment(const std::string& alignment)
 }
 
 ParagraphBuilder& ParagraphBuilder::clear_formatting() {
-    bold_ = false;
-    italic_ = false;
-    underline_ = false;
-    font_name_.clear();
-    font_size_ = 0;
-    color_.clear();
+    format_ = RunFormat{};
     return *this;
 }
 
 std::shared_ptr<Paragraph> ParagraphBuilder::build() {
+    auto para = std::make_shared<Paragraph>();
+    for (const auto& spec : runs_) {
+        auto run = std::make_shared<Run>();
+        run->set_text(spec.text);
+        apply_format(*run, spec.format);
+        para->append_child(run);
+    }
+    if (!alignment_.empty()) {
+        para->set_alignment(alignment_);
+    }
+    return para;
+}
+
+pugi::xml_node ParagraphBuilder::build(pugi::xml_node parent) const {
+    if (!parent) {
+        return {};
+    }
+
+    pugi::xml_node p = parent.append_child("w:p");
     if (!alignment_.empty()) {
-        para_->set_alignment(alignment_);
+        const char* jc = alignment_ == "justify" ? "both" : alignment_.c_str();
+        p.append_child("w:pPr").append_child("w:jc").append_attribute("w:val").set_value(jc);
+    }
+
+    // One TextProperties is reused for every run; only the builder's fields change
+    TextProperties props;
+    for (const auto& spec : runs_) {
+        const RunFormat& format = spec.format;
+        props.font_style.bold = format.bold;
+        props.font_style.italic = format.italic;
+        props.underline.style = format.underline ? TextProperties::UnderlineStyle::Single
+                                                 : TextProperties::UnderlineStyle::None;
+        if (format.font_name.empty()) {
+            props.font.reset();
+        } else {
+            if (!props.font) {
+                props.font.emplace().east_asia.clear();
+            }
+            props.font->ascii = format.font_name;
+            props.font->h_ansi = format.font_name;
+            props.font->cs = format.font_name;
+        }
+        props.font_size = format.font_size > 0 ? format.font_size * 2 : 0;
+        props.color = format.color;
+
+        pugi::xml_node run = p.append_child("w:r");
+        TextFormatContext::apply(run, props);
+        append_run_text(run, spec.text);
     }
-    return para_;
+    return p;
 }
 
-void ParagraphBuilder::apply_current_formatting(Run& run) {
-    run.set_bold(bold_);
-    run.set_italic(italic_);
-    if (underline_) {
+void ParagraphBuilder::apply_format(Run& run, const RunFormat& format) {
+    run.set_bold(format.bold);
+    run.set_italic(format.italic);
+    if (format.underline) {
         run.set_underline(UnderlineType::Single);
     }
-    if (!font_name_.empty()) {
-        run.set_font_name(font_name_);
+    if (!format.font_name.empty()) {
+        run.set_font_name(format.font_name);
     }
-    if (font_size_ > 0) {
-        run.set_font_size(font_size_);
+    if (format.font_size > 0) {
+        run.set_font_size(format.font_size);
     }
-    if (!color_.empty()) {
-        run.set_color(color_);
+    if (!format.color.empty()) {
+        run.set_color(format.color);
     }
 }
 
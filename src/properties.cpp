@@ -12,6 +12,9 @@
 #include <cdocx/table.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 #include "sync_common.h"
@@ -20,34 +23,20 @@ namespace cdocx {
 
 namespace {
 
-// ============================================================================
-// Lookup Tables for TextProperties enum↔string mapping
-// ============================================================================
+/// Appends a new @p name child in place of any existing ones, so re-applying does not duplicate
+pugi::xml_node replace_child(pugi::xml_node parent, const char* name) {
+    remove_managed_children(parent, {name});
+    return parent.append_child(name);
+}
 
-struct UnderlineStyleMapping {
-    TextProperties::UnderlineStyle style;
-    const char* xml_value;
-};
+pugi::xml_attribute ensure_attribute(pugi::xml_node node, const char* name) {
+    pugi::xml_attribute attr = node.attribute(name);
+    return attr ? attr : node.append_attribute(name);
+}
 
-static const UnderlineStyleMapping kUnderlineStyleMappings[] = {
-    {TextProperties::UnderlineStyle::Words, "words"},
-    {TextProperties::UnderlineStyle::Single, "single"},
-    {TextProperties::UnderlineStyle::Double, "double"},
-    {TextProperties::UnderlineStyle::Thick, "thick"},
-    {TextProperties::UnderlineStyle::Dotted, "dotted"},
-    {TextProperties::UnderlineStyle::DottedHeavy, "dottedHeavy"},
-    {TextProperties::UnderlineStyle::Dash, "dash"},
-    {TextProperties::UnderlineStyle::DashedHeavy, "dashedHeavy"},
-    {TextProperties::UnderlineStyle::DashLong, "dashLong"},
-    {TextProperties::UnderlineStyle::DashLongHeavy, "dashLongHeavy"},
-    {TextProperties::UnderlineStyle::DotDash, "dotDash"},
-    {TextProperties::UnderlineStyle::DashDotHeavy, "dashDotHeavy"},
-    {TextProperties::UnderlineStyle::DotDotDash, "dotDotDash"},
-    {TextProperties::UnderlineStyle::DashDotDotHeavy, "dashDotDotHeavy"},
-    {TextProperties::UnderlineStyle::Wave, "wave"},
-    {TextProperties::UnderlineStyle::WavyDouble, "wavyDouble"},
-    {TextProperties::UnderlineStyle::WavyHeavy, "wavyHeavy"},
-};
+// ============================================================================
+// Lookup Tables for ParagraphProperties enum↔string mapping
+// ============================================================================
 
 // ---------------------------------------------------------------------------
 // Border Style
@@ -78,76 +67,6 @@ static const char* border_style_to_string(ParagraphProperties::Border::Style sty
     return "single";
 }
 
-// ---------------------------------------------------------------------------
-// Font Hint
-// ---------------------------------------------------------------------------
-
-struct FontHintMapping {
-    TextProperties::Font::Hint hint;
-    const char* xml_value;
-};
-
-static const FontHintMapping kFontHintMappings[] = {
-    {TextProperties::Font::Hint::EastAsia, "eastAsia"},
-    {TextProperties::Font::Hint::ComplexScript, "cs"},
-};
-
-static const char* font_hint_to_string(TextProperties::Font::Hint hint) {
-    for (const auto& mapping : kFontHintMappings) {
-        if (mapping.hint == hint) {
-            return mapping.xml_value;
-        }
-    }
-    return nullptr;
-}
-
-static TextProperties::Font::Hint string_to_font_hint(const char* val) {
-    if (!val || !*val) {
-        return TextProperties::Font::Hint::Default;
-    }
-    for (const auto& mapping : kFontHintMappings) {
-        if (std::strcmp(mapping.xml_value, val) == 0) {
-            return mapping.hint;
-        }
-    }
-    return TextProperties::Font::Hint::Default;
-}
-
-// ---------------------------------------------------------------------------
-// Vertical Alignment
-// ---------------------------------------------------------------------------
-
-struct VertAlignMapping {
-    TextProperties::VertAlign align;
-    const char* xml_value;
-};
-
-static const VertAlignMapping kVertAlignMappings[] = {
-    {TextProperties::VertAlign::Superscript, "superscript"},
-    {TextProperties::VertAlign::Subscript, "subscript"},
-};
-
-static const char* vert_align_to_string(TextProperties::VertAlign align) {
-    for (const auto& mapping : kVertAlignMappings) {
-        if (mapping.align == align) {
-            return mapping.xml_value;
-        }
-    }
-    return nullptr;
-}
-
-static TextProperties::VertAlign string_to_vert_align(const char* val) {
-    if (!val || !*val) {
-        return TextProperties::VertAlign::None;
-    }
-    for (const auto& mapping : kVertAlignMappings) {
-        if (std::strcmp(mapping.xml_value, val) == 0) {
-            return mapping.align;
-        }
-    }
-    return TextProperties::VertAlign::None;
-}
-
 }  // namespace
 
 // ============================================================================
@@ -179,58 +98,51 @@ void TextProperties::apply_to(pugi::xml_node run_node) const {
             r_fonts = r_pr.append_child("w:rFonts");
         }
         if (!font->ascii.empty()) {
-            r_fonts.append_attribute("w:ascii").set_value(font->ascii.c_str());
+            ensure_attribute(r_fonts, "w:ascii").set_value(font->ascii.c_str());
         }
         if (!font->east_asia.empty()) {
-            r_fonts.append_attribute("w:eastAsia").set_value(font->east_asia.c_str());
+            ensure_attribute(r_fonts, "w:eastAsia").set_value(font->east_asia.c_str());
         }
         if (!font->h_ansi.empty()) {
-            r_fonts.append_attribute("w:hAnsi").set_value(font->h_ansi.c_str());
+            ensure_attribute(r_fonts, "w:hAnsi").set_value(font->h_ansi.c_str());
         }
         if (!font->cs.empty()) {
-            r_fonts.append_attribute("w:cs").set_value(font->cs.c_str());
+            ensure_attribute(r_fonts, "w:cs").set_value(font->cs.c_str());
         }
         // Font hint
         if (font->hint != Font::Hint::Default) {
             if (const char* hint_str = font_hint_to_string(font->hint)) {
-                r_fonts.append_attribute("w:hint").set_value(hint_str);
+                ensure_attribute(r_fonts, "w:hint").set_value(hint_str);
             }
         }
     }
 
     // Font style (bold/italic)
     if (font_style.bold) {
-        r_pr.append_child("w:b");
+        replace_child(r_pr, "w:b");
     }
     if (font_style.italic) {
-        r_pr.append_child("w:i");
+        replace_child(r_pr, "w:i");
     }
 
     // Font size
     if (font_size > 0) {
-        pugi::xml_node sz = r_pr.append_child("w:sz");
+        pugi::xml_node sz = replace_child(r_pr, "w:sz");
         sz.append_attribute("w:val").set_value(font_size);
-        pugi::xml_node sz_cs = r_pr.append_child("w:szCs");
+        pugi::xml_node sz_cs = replace_child(r_pr, "w:szCs");
         sz_cs.append_attribute("w:val").set_value(font_size);
     }
 
     // Color
     if (!color.empty()) {
-        pugi::xml_node color_node = r_pr.append_child("w:color");
+        pugi::xml_node color_node = replace_child(r_pr, "w:color");
         color_node.append_attribute("w:val").set_value(color.c_str());
     }
 
     // Underline
     if (underline.style != UnderlineStyle::None) {
-        pugi::xml_node u = r_pr.append_child("w:u");
-        const char* style_str = "single";
-        for (const auto& m : kUnderlineStyleMappings) {
-            if (m.style == underline.style) {
-                style_str = m.xml_value;
-                break;
-            }
-        }
-        u.append_attribute("w:val").set_value(style_str);
+        pugi::xml_node u = replace_child(r_pr, "w:u");
+        u.append_attribute("w:val").set_value(underline_style_to_string(underline.style));
         if (underline.color != "auto") {
             u.append_attribute("w:color").set_value(underline.color.c_str());
         }
@@ -238,42 +150,42 @@ void TextProperties::apply_to(pugi::xml_node run_node) const {
 
     // Strikethrough
     if (strike == StrikeStyle::Single) {
-        r_pr.append_child("w:strike");
+        replace_child(r_pr, "w:strike");
     } else if (strike == StrikeStyle::Double) {
-        pugi::xml_node strike_node = r_pr.append_child("w:dstrike");
+        pugi::xml_node strike_node = replace_child(r_pr, "w:dstrike");
         strike_node.append_attribute("w:val").set_value("true");
     }
 
     // Vertical align
     if (const char* align_str = vert_align_to_string(vert_align)) {
-        pugi::xml_node v_align = r_pr.append_child("w:vertAlign");
+        pugi::xml_node v_align = replace_child(r_pr, "w:vertAlign");
         v_align.append_attribute("w:val").set_value(align_str);
     }
 
     // Highlight
     if (highlight != Highlight::None) {
         if (const char* hl_str = highlight_to_string(highlight)) {
-            pugi::xml_node highlight_node = r_pr.append_child("w:highlight");
+            pugi::xml_node highlight_node = replace_child(r_pr, "w:highlight");
             highlight_node.append_attribute("w:val").set_value(hl_str);
         }
     }
 
     // Scale
     if (scale != 100) {
-        pugi::xml_node w_node = r_pr.append_child("w:w");
+        pugi::xml_node w_node = replace_child(r_pr, "w:w");
         w_node.append_attribute("w:val").set_value(scale);
     }
 
     // Spacing
     if (spacing.type != SpacingType::Normal) {
-        pugi::xml_node spacing_node = r_pr.append_child("w:spacing");
+        pugi::xml_node spacing_node = replace_child(r_pr, "w:spacing");
         spacing_node.append_attribute("w:val").set_value(
             spacing.type == SpacingType::Expanded ? spacing.value : -spacing.value);
     }
 
     // Position
     if (position.type != PositionType::Normal) {
-        pugi::xml_node pos_node = r_pr.append_child("w:position");
+        pugi::xml_node pos_node = replace_child(r_pr, "w:position");
         const int val = (position.type == PositionType::Raised) ? position.value : -position.value;
         pos_node.append_attribute("w:val").set_value(val);
     }
@@ -326,16 +238,8 @@ TextProperties TextProperties::extract_from(pugi::xml_node run_node) {
     // Extract underline
     const pugi::xml_node u = r_pr.child("w:u");
     if (u) {
-        const char* val = u.attribute("w:val").value();
         props.underline.color = u.attribute("w:color").value();
-
-        props.underline.style = UnderlineStyle::Single;
-        for (const auto& m : kUnderlineStyleMappings) {
-            if (strcmp(val, m.xml_value) == 0) {
-                props.underline.style = m.style;
-                break;
-            }
-        }
+        props.underline.style = string_to_underline_style(u.attribute("w:val").value());
     }
 
     // Extract strikethrough
@@ -355,6 +259,25 @@ TextProperties TextProperties::extract_from(pugi::xml_node run_node) {
         props.highlight = string_to_highlight(highlight.attribute("w:val").value());
     }
 
+    // Extract scale, spacing and position
+    if (const pugi::xml_node w_node = r_pr.child("w:w")) {
+        props.scale = w_node.attribute("w:val").as_int(100);
+    }
+    if (const pugi::xml_node spacing_node = r_pr.child("w:spacing")) {
+        const int val = spacing_node.attribute("w:val").as_int();
+        if (val != 0) {
+            props.spacing.type = val > 0 ? SpacingType::Expanded : SpacingType::Condensed;
+            props.spacing.value = val > 0 ? val : -val;
+        }
+    }
+    if (const pugi::xml_node pos_node = r_pr.child("w:position")) {
+        const int val = pos_node.attribute("w:val").as_int();
+        if (val != 0) {
+            props.position.type = val > 0 ? PositionType::Raised : PositionType::Lowered;
+            props.position.value = val > 0 ? val : -val;
+        }
+    }
+
     return props;
 }
 
@@ -383,25 +306,25 @@ void ParagraphProperties::apply_to(pugi::xml_node para_node) const {
         if (!p_style) {
             p_style = p_pr.append_child("w:pStyle");
         }
-        p_style.append_attribute("w:val").set_value(style_id.c_str());
+        ensure_attribute(p_style, "w:val").set_value(style_id.c_str());
     }
 
     // Alignment
     if (align) {
-        pugi::xml_node jc = p_pr.append_child("w:jc");
+        pugi::xml_node jc = replace_child(p_pr, "w:jc");
         jc.append_attribute("w:val").set_value(pp_alignment_to_string(*align));
     }
 
     // Outline level
     if (outline_level != OutlineLevel::BodyText) {
         const int level = static_cast<int>(outline_level);
-        pugi::xml_node outline = p_pr.append_child("w:outlineLvl");
+        pugi::xml_node outline = replace_child(p_pr, "w:outlineLvl");
         outline.append_attribute("w:val").set_value(level);
     }
 
     // Indentation
     if (indent) {
-        pugi::xml_node ind = p_pr.append_child("w:ind");
+        pugi::xml_node ind = replace_child(p_pr, "w:ind");
         // Left
         if (indent->left.value != 0) {
             const char* attr =
@@ -423,7 +346,7 @@ void ParagraphProperties::apply_to(pugi::xml_node para_node) const {
 
     // Spacing
     if (spacing) {
-        pugi::xml_node sp = p_pr.append_child("w:spacing");
+        pugi::xml_node sp = replace_child(p_pr, "w:spacing");
         // Before
         if (spacing->before.type != Spacing::Type::Auto || spacing->before.value != 0) {
             sp.append_attribute("w:before").set_value(spacing->before.value);
@@ -443,22 +366,22 @@ void ParagraphProperties::apply_to(pugi::xml_node para_node) const {
 
     // Page break control
     if (keep_next) {
-        p_pr.append_child("w:keep_next");
+        replace_child(p_pr, "w:keep_next");
     }
     if (keep_lines) {
-        p_pr.append_child("w:keep_lines");
+        replace_child(p_pr, "w:keep_lines");
     }
     if (page_break_before) {
-        p_pr.append_child("w:page_break_before");
+        replace_child(p_pr, "w:page_break_before");
     }
     if (page_break_after) {
-        pugi::xml_node pb = p_pr.append_child("w:page_break_after");
+        pugi::xml_node pb = replace_child(p_pr, "w:page_break_after");
         pb.append_attribute("w:val").set_value("true");
     }
 
     // Borders
     if (borders) {
-        pugi::xml_node p_bdr = p_pr.append_child("w:pBdr");
+        pugi::xml_node p_bdr = replace_child(p_pr, "w:pBdr");
         auto add_border = [&p_bdr](const char* name, const std::optional<Border>& border) {
             if (border) {
                 pugi::xml_node b = p_bdr.append_child(name);
@@ -855,4 +778,66 @@ void SectionProperties::apply_to(pugi::xml_node sect_pr_node) const {
     }
 }
 
+// ============================================================================
+// Custom Document Properties Implementation
+// ============================================================================
+
+std::string CustomProperty::to_string() const {
+    if (const auto* text = std::get_if<std::string>(&value)) {
+        return *text;
+    }
+    if (const auto* number = std::get_if<int>(&value)) {
+        return std::to_string(*number);
+    }
+    if (const auto* number = std::get_if<std::int64_t>(&value)) {
+        return std::to_string(*number);
+    }
+    if (const auto* number = std::get_if<double>(&value)) {
+        // 15 significant digits when they read back as the same double, else all 17
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.15g", *number);
+        if (std::strtod(buffer, nullptr) != *number) {
+            std::snprintf(buffer, sizeof(buffer), "%.17g", *number);
+        }
+        return buffer;
+    }
+    if (const auto* flag = std::get_if<bool>(&value)) {
+        return *flag ? "true" : "false";
+    }
+    return time_to_w3cdtf(std::get<FileTime>(value).time);
+}
+
+bool DocumentProperties::set_custom_value(const std::string& name, CustomProperty::Value value) {
+    // nan and inf have no vt:r8 text that Office reads back, so they are refused
+    if (const auto* number = std::get_if<double>(&value); number && !std::isfinite(*number)) {
+        return false;
+    }
+    auto [it, inserted] = custom_properties_.try_emplace(name);
+    CustomProperty& prop = it->second;
+    if (inserted) {
+        prop.pid = next_custom_pid_++;
+    } else if (prop.value == value) {
+        return true;
+    }
+    prop.value = std::move(value);
+    if (inserted || !prop.dirty) {
+        dirty_custom_.push_back(name);
+    }
+    prop.dirty = true;
+    return true;
+}
+
+void DocumentProperties::remove_custom(const std::string& name) {
+    if (custom_properties_.erase(name) > 0) {
+        removed_custom_.push_back(name);
+    }
+}
+
+void DocumentProperties::clear_custom() {
+    for (const auto& entry : custom_properties_) {
+        removed_custom_.push_back(entry.first);
+    }
+    custom_properties_.clear();
+}
+
 }  // namespace cdocx
@@ -7,203 +7,478 @@
 #include <cdocx/advanced.h>
 #include <cdocx/document.h>
 #include <cdocx/paragraph.h>
+#include <cdocx/properties.h>
 #include <cdocx/range.h>
 #include <cdocx/table.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#include "sync_common.h"
+#include "text_offset_index.h"
 
 namespace cdocx {
 
-// Range Implementation
-// ============================================================================
+namespace {
 
-Range::Range() = default;
+/// Calls @p fn with each w:t of the runs of the w:p element @p para, in order
+template <typename Fn>
+void for_each_run_text(pugi::xml_node para, Fn&& fn) {
+    for (auto run = para.child("w:r"); run; run = run.next_sibling("w:r")) {
+        for (auto t = run.child("w:t"); t; t = t.next_sibling("w:t")) {
+            fn(t);
+        }
+    }
+}
 
-Range::Range(Document* doc, pugi::xml_node start, pugi::xml_node end)
-    : doc_(doc), start_para_(start), end_para_(end) {
+/// True for the first byte of a UTF-8 sequence, false for a continuation byte
+bool starts_character(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) != 0x80;
 }
 
-std::string Range::get_text() const {
-    std::string result;
+/// Characters (code points) in the run text of the w:p element @p para
+size_t paragraph_char_count(pugi::xml_node para) {
+    size_t count = 0;
+    for_each_run_text(para, [&](pugi::xml_node t) {
+        for (const char* p = t.text().get(); *p; ++p) {
+            count += starts_character(*p) ? 1 : 0;
+        }
+    });
+    return count;
+}
 
-    pugi::xml_node current = start_para_;
-    while (current) {
-        result += collect_text_from_runs(current);
-        if (current == end_para_) {
-            break;
+/// Byte offset of character @p chars in the run text of @p para; its byte size past the end
+size_t paragraph_byte_offset(pugi::xml_node para, size_t chars) {
+    size_t bytes = 0;
+    bool found = false;
+    for_each_run_text(para, [&](pugi::xml_node t) {
+        for (const char* p = t.text().get(); *p && !found; ++p, ++bytes) {
+            if (starts_character(*p) && chars-- == 0) {
+                found = true;
+                return;
+            }
         }
-        current = current.next_sibling();
-    }
+    });
+    return bytes;
+}
 
-    return result;
+/// Buffers reused across the paragraphs of one edit, so only the first allocates
+struct ReplaceScratch {
+    std::string text;                      ///< The run texts of a paragraph back to back
+    std::vector<size_t> starts;            ///< Offset of each run text in it, then its size
+    std::vector<size_t> matches;           ///< Offsets of the matches, left to right
+    std::string patched;                   ///< New text of the run text being patched
+    std::vector<pugi::xml_node> elements;  ///< w:t of each run text (XML paragraphs)
+    std::vector<Run*> runs;                ///< Run of each run text (DOM paragraphs)
+};
+
+void collect_run_texts(pugi::xml_node para, ReplaceScratch& scratch) {
+    scratch.text.clear();
+    scratch.starts.clear();
+    scratch.elements.clear();
+    for_each_run_text(para, [&](pugi::xml_node t) {
+        scratch.starts.push_back(scratch.text.size());
+        scratch.elements.push_back(t);
+        scratch.text.append(t.text().get());
+    });
+    scratch.starts.push_back(scratch.text.size());
 }
 
-bool Range::replace(const std::string& old_text, const std::string& new_text) {
-    if (old_text.empty()) {
-        return false;
+/// Finds up to @p max_hits matches of @p old_text lying inside [from, to) of scratch.text
+void find_matches(ReplaceScratch& scratch, std::string_view old_text, size_t from, size_t to,
+                  size_t max_hits) {
+    const std::string_view text = std::string_view(scratch.text).substr(0, to);
+    scratch.matches.clear();
+    for (size_t pos = text.find(old_text, from); pos != std::string_view::npos;
+         pos = text.find(old_text, pos + old_text.size())) {
+        scratch.matches.push_back(pos);
+        if (scratch.matches.size() == max_hits) {
+            break;
+        }
     }
+}
 
-    // Fallback for DOM paragraphs without XML node binding
-    if (!is_valid() && doc_) {
-        auto paragraphs = doc_->get_paragraphs();
-        for (auto& para : paragraphs) {
-            if (!para) {
-                continue;
+/**
+ * @brief Replaces the @p length bytes at each of scratch.matches with @p new_text
+ * @details Every run text a match touches is rewritten once: the replacement
+ *          goes into the run the match starts in and the rest of the match is
+ *          cut from the runs it spans. Runs are never merged, so each keeps its
+ *          own formatting. @p patch receives the index of a run text and its
+ *          new content.
+ * @return Number of matches replaced
+ */
+template <typename Patch>
+size_t patch_run_texts(ReplaceScratch& scratch, size_t length, std::string_view new_text,
+                       Patch&& patch) {
+    const std::string_view text = scratch.text;
+    const auto& matches = scratch.matches;
+    size_t first = 0;  // First match that does not end before the current run text
+    for (size_t i = 0; i + 1 < scratch.starts.size(); ++i) {
+        const size_t begin = scratch.starts[i];
+        const size_t end = scratch.starts[i + 1];
+        while (first < matches.size() && matches[first] + length <= begin) {
+            ++first;
+        }
+        if (first == matches.size() || matches[first] >= end || begin == end) {
+            continue;
+        }
+
+        auto& patched = scratch.patched;
+        patched.clear();
+        size_t pos = begin;
+        for (size_t m = first; m < matches.size() && matches[m] < end; ++m) {
+            if (matches[m] > pos) {
+                patched.append(text, pos, matches[m] - pos);
             }
-            std::string para_text = para->get_text();
-            const size_t pos = para_text.find(old_text);
-            if (pos != std::string::npos) {
-                para_text.replace(pos, old_text.size(), new_text);
-                para->set_text(para_text);
-                return true;
+            if (matches[m] >= begin) {
+                patched.append(new_text);
             }
+            pos = std::max(pos, std::min(matches[m] + length, end));
         }
-        return false;
+        patched.append(text, pos, end - pos);
+        patch(i, std::string_view(patched));
     }
+    return matches.size();
+}
 
-    pugi::xml_node current = start_para_;
-    while (current) {
-        std::string para_text = collect_text_from_runs(current);
+/// Sets the text of the w:t element @p t, dropping it when @p content is empty
+void set_run_text(pugi::xml_node t, std::string_view content) {
+    pugi::xml_node run = t.parent();
+    if (content.empty()) {
+        // Drop the run too once nothing but its properties is left
+        run.remove_child(t);
+        const pugi::xml_node child = run.first_child();
+        if (!child || (child == run.child("w:rPr") && !child.next_sibling())) {
+            run.parent().remove_child(run);
+        }
+        return;
+    }
+    if ((std::isspace(static_cast<unsigned char>(content.front())) ||
+         std::isspace(static_cast<unsigned char>(content.back()))) &&
+        !t.attribute("xml:space")) {
+        t.append_attribute("xml:space").set_value("preserve");
+    }
+    t.text().set(content.data(), content.size());
+}
 
-        const size_t pos = para_text.find(old_text);
-        if (pos != std::string::npos) {
-            para_text.replace(pos, old_text.size(), new_text);
+/// Replaces in the w:t elements of the runs of the w:p element @p para, within [from, to)
+size_t replace_in_paragraph(pugi::xml_node para, std::string_view old_text,
+                            std::string_view new_text, size_t from, size_t to,
+                            size_t max_hits, ReplaceScratch& scratch) {
+    collect_run_texts(para, scratch);
+    find_matches(scratch, old_text, from, to, max_hits);
+    return patch_run_texts(scratch, old_text.size(), new_text,
+                           [&](size_t i, std::string_view content) {
+                               set_run_text(scratch.elements[i], content);
+                           });
+}
 
-            // Clear all runs and set first run to new text
-            pugi::xml_node first_run;
-            pugi::xml_node run = current.child("w:r");
-            while (run) {
-                const pugi::xml_node next = run.next_sibling("w:r");
-                if (!first_run) {
-                    first_run = run;
-                    // Clear existing text nodes
-                    for (pugi::xml_node t = run.child("w:t"); t; t = t.next_sibling("w:t")) {
-                        run.remove_child(t);
-                    }
-                    pugi::xml_node new_t = run.append_child("w:t");
-                    if (!para_text.empty() &&
-                        (std::isspace(static_cast<unsigned char>(para_text.front())) ||
-                         std::isspace(static_cast<unsigned char>(para_text.back())))) {
-                        new_t.append_attribute("xml:space").set_value("preserve");
-                    }
-                    new_t.text().set(para_text.c_str());
-                } else {
-                    current.remove_child(run);
-                }
-                run = next;
+/// Cuts [from, to) out of the run text of the w:p element @p para
+void cut_paragraph_text(pugi::xml_node para, size_t from, size_t to, ReplaceScratch& scratch) {
+    collect_run_texts(para, scratch);
+    to = std::min(to, scratch.text.size());
+    if (from >= to) {
+        return;
+    }
+    scratch.matches.assign(1, from);
+    patch_run_texts(scratch, to - from, {}, [&](size_t i, std::string_view content) {
+        set_run_text(scratch.elements[i], content);
+    });
+}
+
+/// Replaces in the text of the runs of a DOM paragraph
+size_t replace_in_paragraph(Paragraph& para, std::string_view old_text,
+                            std::string_view new_text, size_t max_hits,
+                            ReplaceScratch& scratch) {
+    scratch.text.clear();
+    scratch.starts.clear();
+    scratch.runs.clear();
+    for (const auto& child : para.get_children()) {
+        if (child && child->node_type() == NodeType::Run) {
+            auto* run = static_cast<Run*>(child.get());
+            scratch.starts.push_back(scratch.text.size());
+            scratch.runs.push_back(run);
+            scratch.text.append(run->get_text());
+        }
+    }
+    scratch.starts.push_back(scratch.text.size());
+
+    find_matches(scratch, old_text, 0, std::string::npos, max_hits);
+    std::vector<Run*> emptied;
+    const size_t hits = patch_run_texts(
+        scratch, old_text.size(), new_text, [&](size_t i, std::string_view content) {
+            scratch.runs[i]->set_text(content);
+            if (content.empty() && !scratch.runs[i]->get_preserved_children().first_child()) {
+                emptied.push_back(scratch.runs[i]);
             }
+        });
+    for (Run* run : emptied) {
+        for (const auto& child : para.get_children()) {
+            if (child.get() == run) {
+                para.remove_child(child);
+                break;
+            }
+        }
+    }
+    return hits;
+}
 
-            // If no run existed, create one
-            if (!first_run) {
-                pugi::xml_node new_run = current.append_child("w:r");
-                pugi::xml_node new_t = new_run.append_child("w:t");
-                if (!para_text.empty() &&
-                    (std::isspace(static_cast<unsigned char>(para_text.front())) ||
-                     std::isspace(static_cast<unsigned char>(para_text.back())))) {
-                    new_t.append_attribute("xml:space").set_value("preserve");
-                }
-                new_t.text().set(para_text.c_str());
+/**
+ * @brief Calls @p fn with each w:r of the paragraph content under @p parent
+ * @details Descends into hyperlinks, revisions, fields and content controls,
+ *          but not into runs, so text box paragraphs are left alone.
+ * @return Number of runs visited
+ */
+template <typename Fn>
+size_t visit_runs(pugi::xml_node parent, Fn&& fn) {
+    size_t count = 0;
+    for (pugi::xml_node child = parent.first_child(); child; child = child.next_sibling()) {
+        if (child.type() != pugi::node_element) {
+            continue;
+        }
+        if (std::strcmp(child.name(), "w:r") == 0) {
+            fn(child);
+            ++count;
+        } else if (std::strcmp(child.name(), "w:pPr") != 0) {
+            count += visit_runs(child, fn);
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Calls @p edit with each w:p from @p start to @p end
+ * @details @p edit returns how many runs or paragraphs it changed; paragraphs
+ *          with changes are marked for the DOM to pick up on the next save.
+ * @return Total number changed
+ */
+template <typename Edit>
+int edit_paragraphs(Document* doc, pugi::xml_node start, pugi::xml_node end, Edit&& edit) {
+    size_t total = 0;
+    for (pugi::xml_node para = start; para; para = para.next_sibling()) {
+        if (std::strcmp(para.name(), "w:p") == 0) {
+            const size_t changed = edit(para);
+            if (changed > 0 && doc) {
+                doc->mark_xml_paragraph_dirty(para);
             }
+            total += changed;
+        }
+        if (para == end) {
+            break;
+        }
+    }
+    if (total > 0 && doc) {
+        doc->mark_modified("word/document.xml");
+    }
+    return static_cast<int>(total);
+}
 
-            return true;
+/// Removes the children of the w:rPr or w:pPr element @p props not named in @p keep,
+/// then @p props itself if it is left empty; returns true if anything was removed
+bool strip_properties(pugi::xml_node props, std::initializer_list<const char*> keep) {
+    bool changed = false;
+    for (pugi::xml_node child = props.first_child(); child;) {
+        const pugi::xml_node next = child.next_sibling();
+        const bool kept = std::any_of(keep.begin(), keep.end(), [&](const char* name) {
+            return std::strcmp(child.name(), name) == 0;
+        });
+        if (!kept && child.type() == pugi::node_element) {
+            props.remove_child(child);
+            changed = true;
         }
+        child = next;
+    }
+    if (props && !props.first_child()) {
+        props.parent().remove_child(props);
+        changed = true;
+    }
+    return changed;
+}
 
+bool strip_run_properties(pugi::xml_node r_pr) {
+    return strip_properties(r_pr, {"w:rStyle", "w:rPrChange"});
+}
+
+}  // namespace
+
+// ============================================================================
+// Range Implementation
+// ============================================================================
+
+Range::Range() = default;
+
+Range::Range(Document* doc, pugi::xml_node start, pugi::xml_node end)
+    : doc_(doc), start_para_(start), end_para_(end) {
+}
+
+Range Range::from_offsets(Document& doc, size_t begin, size_t end) {
+    if (begin > end) {
+        return {};
+    }
+
+    auto& index = doc.text_index_;
+    if (!index) {
+        pugi::xml_document* doc_xml = doc.get_document_xml();
+        if (!doc_xml) {
+            return {};
+        }
+        index = std::make_unique<Document::TextOffsetIndex>();
+        const pugi::xml_node body = doc_xml->child("w:document").child("w:body");
+        size_t offset = 0;
+        for (pugi::xml_node para = body.child("w:p"); para; para = para.next_sibling("w:p")) {
+            index->paragraphs.push_back(para);
+            index->starts.push_back(offset);
+            offset += paragraph_char_count(para);
+        }
+        index->starts.push_back(offset);
+    }
+
+    const auto& starts = index->starts;
+    if (index->paragraphs.empty()) {
+        return {};
+    }
+    end = std::min(end, starts.back());
+    begin = std::min(begin, end);
+
+    // An offset between two paragraphs starts the later one and ends the earlier one
+    const auto first = static_cast<size_t>(
+        std::upper_bound(starts.begin(), starts.end() - 1, begin) - starts.begin() - 1);
+    const auto last = std::max(
+        first, static_cast<size_t>(std::lower_bound(starts.begin() + 1, starts.end(), end) -
+                                   starts.begin() - 1));
+
+    // The range keeps byte offsets, which therefore always fall between two characters
+    Range range(&doc, index->paragraphs[first], index->paragraphs[last]);
+    range.start_offset_ = paragraph_byte_offset(range.start_para_, begin - starts[first]);
+    range.end_offset_ = paragraph_byte_offset(range.end_para_, end - starts[last]);
+    return range;
+}
+
+std::string Range::get_text() const {
+    std::string result;
+
+    for (pugi::xml_node current = start_para_; current; current = current.next_sibling()) {
+        const size_t begin = result.size();
+        for_each_run_text(current, [&](pugi::xml_node t) { result.append(t.text().get()); });
+        const size_t length = result.size() - begin;
+        const size_t to = std::min(current == end_para_ ? end_offset_ : length, length);
+        const size_t from = std::min(current == start_para_ ? start_offset_ : 0, to);
+        result.resize(begin + to);
+        result.erase(begin, from);
         if (current == end_para_) {
             break;
         }
-        current = current.next_sibling();
     }
-    return false;
+
+    return result;
+}
+
+bool Range::replace(const std::string& old_text, const std::string& new_text) {
+    return replace_matches(old_text, new_text, 1) > 0;
 }
 
 int Range::replace_all(const std::string& old_text, const std::string& new_text) {
+    return replace_matches(old_text, new_text, std::numeric_limits<size_t>::max());
+}
+
+int Range::replace_matches(std::string_view old_text, std::string_view new_text,
+                           size_t max_hits) {
     if (old_text.empty()) {
         return 0;
     }
 
+    ReplaceScratch scratch;
+    size_t total = 0;
+
     // Fallback for DOM paragraphs without XML node binding
     if (!is_valid() && doc_) {
-        int total = 0;
         auto paragraphs = doc_->get_paragraphs();
         for (auto& para : paragraphs) {
-            if (!para) {
-                continue;
-            }
-            std::string para_text = para->get_text();
-            int count = 0;
-            size_t pos = 0;
-            while ((pos = para_text.find(old_text, pos)) != std::string::npos) {
-                para_text.replace(pos, old_text.size(), new_text);
-                pos += new_text.size();
-                ++count;
-            }
-            if (count > 0) {
-                para->set_text(para_text);
-                total += count;
+            if (para && total < max_hits) {
+                total += replace_in_paragraph(*para, old_text, new_text, max_hits - total,
+                                              scratch);
             }
         }
-        return total;
+        return static_cast<int>(total);
     }
 
-    int total = 0;
     pugi::xml_node current = start_para_;
-    while (current) {
-        std::string para_text = collect_text_from_runs(current);
-
-        int count = 0;
-        size_t pos = 0;
-        while ((pos = para_text.find(old_text, pos)) != std::string::npos) {
-            para_text.replace(pos, old_text.size(), new_text);
-            pos += new_text.size();
-            ++count;
+    while (current && total < max_hits) {
+        const size_t from = current == start_para_ ? start_offset_ : 0;
+        const size_t to = current == end_para_ ? end_offset_ : std::string::npos;
+        const size_t hits = replace_in_paragraph(current, old_text, new_text, from, to,
+                                                 max_hits - total, scratch);
+        if (hits > 0 && doc_) {
+            // The DOM is rebuilt from the paragraph before the next save
+            doc_->mark_xml_paragraph_dirty(current);
         }
-
-        if (count > 0) {
-            ++total;
-            // Clear all runs and set first run to new text
-            pugi::xml_node first_run;
-            pugi::xml_node run = current.child("w:r");
-            while (run) {
-                const pugi::xml_node next = run.next_sibling("w:r");
-                if (!first_run) {
-                    first_run = run;
-                    for (pugi::xml_node t = run.child("w:t"); t; t = t.next_sibling("w:t")) {
-                        run.remove_child(t);
-                    }
-                    pugi::xml_node new_t = run.append_child("w:t");
-                    if (!para_text.empty() &&
-                        (std::isspace(static_cast<unsigned char>(para_text.front())) ||
-                         std::isspace(static_cast<unsigned char>(para_text.back())))) {
-                        new_t.append_attribute("xml:space").set_value("preserve");
-                    }
-                    new_t.text().set(para_text.c_str());
-                } else {
-                    current.remove_child(run);
-                }
-                run = next;
-            }
-
-            if (!first_run) {
-                pugi::xml_node new_run = current.append_child("w:r");
-                pugi::xml_node new_t = new_run.append_child("w:t");
-                if (!para_text.empty() &&
-                    (std::isspace(static_cast<unsigned char>(para_text.front())) ||
-                     std::isspace(static_cast<unsigned char>(para_text.back())))) {
-                    new_t.append_attribute("xml:space").set_value("preserve");
-                }
-                new_t.text().set(para_text.c_str());
-            }
+        if (hits > 0 && current == end_para_ && end_offset_ != std::string::npos) {
+            // Keep the end behind the replaced text
+            end_offset_ = end_offset_ - hits * old_text.size() + hits * new_text.size();
         }
+        total += hits;
 
         if (current == end_para_) {
             break;
         }
         current = current.next_sibling();
     }
-    return total;
+    if (total > 0 && doc_) {
+        doc_->mark_modified("word/document.xml");
+    }
+    return static_cast<int>(total);
+}
+
+int Range::apply_text_properties(const TextProperties& props) {
+    if (!is_valid()) {
+        return 0;
+    }
+    return edit_paragraphs(doc_, start_para_, end_para_, [&](pugi::xml_node para) {
+        return visit_runs(para, [&](pugi::xml_node run) { props.apply_to(run); });
+    });
+}
+
+int Range::apply_paragraph_properties(const ParagraphProperties& props) {
+    if (!is_valid()) {
+        return 0;
+    }
+    return edit_paragraphs(doc_, start_para_, end_para_, [&](pugi::xml_node para) {
+        props.apply_to(para);
+        return size_t{1};
+    });
+}
+
+int Range::clear_direct_formatting() {
+    if (!is_valid()) {
+        return 0;
+    }
+    return edit_paragraphs(doc_, start_para_, end_para_, [](pugi::xml_node para) {
+        bool changed = false;
+        if (const pugi::xml_node p_pr = para.child("w:pPr")) {
+            // The paragraph mark's run properties are cleared like any run's
+            changed = strip_run_properties(p_pr.child("w:rPr"));
+            changed |= strip_properties(
+                p_pr, {"w:pStyle", "w:numPr", "w:sectPr", "w:rPr", "w:pPrChange"});
+        }
+        visit_runs(para, [&](pugi::xml_node run) {
+            changed |= strip_run_properties(run.child("w:rPr"));
+        });
+        return changed ? size_t{1} : size_t{0};
+    });
+}
+
+int Range::for_each_run(const std::function<void(pugi::xml_node run)>& fn) {
+    if (!is_valid() || !fn) {
+        return 0;
+    }
+    return edit_paragraphs(doc_, start_para_, end_para_,
+                           [&](pugi::xml_node para) { return visit_runs(para, fn); });
 }
 
 bool Range::delete_content() {
@@ -211,14 +486,24 @@ bool Range::delete_content() {
         return false;
     }
 
+    ReplaceScratch scratch;
     pugi::xml_node current = start_para_;
     while (current) {
-        // Remove all run elements
-        pugi::xml_node run = current.child("w:r");
-        while (run) {
-            const pugi::xml_node next = run.next_sibling("w:r");
-            current.remove_child(run);
-            run = next;
+        const size_t from = current == start_para_ ? start_offset_ : 0;
+        const size_t to = current == end_para_ ? end_offset_ : std::string::npos;
+        if (from == 0 && to == std::string::npos) {
+            // Remove all run elements
+            pugi::xml_node run = current.child("w:r");
+            while (run) {
+                const pugi::xml_node next = run.next_sibling("w:r");
+                current.remove_child(run);
+                run = next;
+            }
+        } else {
+            cut_paragraph_text(current, from, to, scratch);
+        }
+        if (doc_) {
+            doc_->mark_xml_paragraph_dirty(current);
         }
 
         if (current == end_para_) {
@@ -226,6 +511,13 @@ bool Range::delete_content() {
         }
         current = current.next_sibling();
     }
+
+    if (end_offset_ != std::string::npos) {
+        end_offset_ = start_para_ == end_para_ ? start_offset_ : 0;
+    }
+    if (doc_) {
+        doc_->mark_modified("word/document.xml");
+    }
     return true;
 }
 
@@ -236,8 +528,12 @@ bool Range::is_valid() const {
 void Range::collapse(bool to_start) {
     if (to_start) {
         end_para_ = start_para_;
+        end_offset_ = start_offset_;
     } else {
         start_para_ = end_para_;
+        start_offset_ = end_offset_ == std::string::npos
+                            ? paragraph_byte_offset(end_para_, std::string::npos)
+                            : end_offset_;
     }
 }
 
@@ -0,0 +1,470 @@
+/**
+ * @file record_source.cpp
+ * @brief Memory-mapped CSV and JSON Lines record sources
+ * @since 0.8.0
+ */
+
+#include <cdocx/record_source.h>
+
+#include <cctype>
+#include <cstdint>
+
+#include "mapped_file.h"
+
+namespace cdocx {
+
+// ============================================================================
+// RecordSource
+// ============================================================================
+
+int RecordSource::find_column(std::string_view name) const {
+    const auto& columns = get_columns();
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        const std::string& column = columns[i];
+        if (column.size() != name.size()) {
+            continue;
+        }
+        bool equal = true;
+        for (std::size_t j = 0; j < name.size() && equal; ++j) {
+            equal = std::tolower(static_cast<unsigned char>(column[j])) ==
+                    std::tolower(static_cast<unsigned char>(name[j]));
+        }
+        if (equal) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+namespace {
+
+bool is_json_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void skip_json_space(std::string_view text, std::size_t& i) {
+    while (i < text.size() && is_json_space(text[i])) {
+        ++i;
+    }
+}
+
+// Scans a JSON string starting at the opening quote; @p raw receives the
+// undecoded content between the quotes.
+bool scan_json_string(std::string_view text,
+                      std::size_t& i,
+                      std::string_view& raw,
+                      bool& has_escapes) {
+    if (i >= text.size() || text[i] != '"') {
+        return false;
+    }
+    const std::size_t start = ++i;
+    has_escapes = false;
+    while (i < text.size()) {
+        const char c = text[i];
+        if (c == '"') {
+            raw = text.substr(start, i - start);
+            ++i;
+            return true;
+        }
+        if (c == '\\') {
+            has_escapes = true;
+            ++i;
+        }
+        ++i;
+    }
+    return false;
+}
+
+void append_utf8(std::string& out, std::uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+bool parse_hex4(std::string_view raw, std::size_t pos, std::uint32_t& value) {
+    if (pos + 4 > raw.size()) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t k = pos; k < pos + 4; ++k) {
+        const char c = raw[k];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= static_cast<std::uint32_t>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value |= static_cast<std::uint32_t>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            value |= static_cast<std::uint32_t>(c - 'A' + 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool decode_json_string(std::string_view raw, std::string& out) {
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        const char c = raw[i];
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (++i >= raw.size()) {
+            return false;
+        }
+        switch (raw[i]) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                std::uint32_t cp = 0;
+                if (!parse_hex4(raw, i + 1, cp)) {
+                    return false;
+                }
+                i += 4;
+                // Surrogate pair
+                std::uint32_t low = 0;
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 2 < raw.size() && raw[i + 1] == '\\' &&
+                    raw[i + 2] == 'u' && parse_hex4(raw, i + 3, low) &&
+                    low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+                append_utf8(out, cp);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+// Skips a nested object or array, respecting strings
+bool skip_json_container(std::string_view text, std::size_t& i) {
+    int depth = 0;
+    while (i < text.size()) {
+        const char c = text[i];
+        if (c == '"') {
+            std::string_view raw;
+            bool has_escapes = false;
+            if (!scan_json_string(text, i, raw, has_escapes)) {
+                return false;
+            }
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                ++i;
+                return true;
+            }
+        }
+        ++i;
+    }
+    return false;
+}
+
+}  // namespace
+
+// ============================================================================
+// CsvRecordSource
+// ============================================================================
+
+CsvRecordSource::CsvRecordSource(const std::string& path, char delimiter)
+    : file_(std::make_unique<MappedFile>(path)), delimiter_(delimiter) {
+    if (!file_->is_open()) {
+        return;
+    }
+    data_ = file_->data();
+    if (data_.substr(0, 3) == "\xEF\xBB\xBF") {
+        pos_ = 3;
+    }
+    if (parse_row()) {
+        columns_.assign(fields_.begin(), fields_.end());
+        fields_.clear();
+        open_ = true;
+    }
+}
+
+CsvRecordSource::~CsvRecordSource() = default;
+
+bool CsvRecordSource::next() {
+    return open_ && parse_row();
+}
+
+std::string_view CsvRecordSource::get_field(std::size_t column) const {
+    return column < fields_.size() ? fields_[column] : std::string_view();
+}
+
+bool CsvRecordSource::parse_row() {
+    const std::size_t size = data_.size();
+    while (pos_ < size && (data_[pos_] == '\n' || data_[pos_] == '\r')) {
+        ++pos_;
+    }
+    if (pos_ >= size) {
+        return false;
+    }
+
+    fields_.clear();
+    decoded_.clear();
+    decoded_fields_.clear();
+
+    auto at_field_end = [this](char c) { return c == delimiter_ || c == '\n' || c == '\r'; };
+
+    for (;;) {
+        if (pos_ < size && data_[pos_] == '"') {
+            const std::size_t start = ++pos_;
+            std::size_t decoded_start = std::string::npos;
+            for (;;) {
+                std::size_t quote = data_.find('"', pos_);
+                if (quote == std::string_view::npos) {
+                    quote = size;  // Unterminated: the field runs to the end of input
+                }
+                if (quote + 1 < size && data_[quote + 1] == '"') {
+                    // Doubled quote: keep one, continue in the decode buffer
+                    if (decoded_start == std::string::npos) {
+                        decoded_start = decoded_.size();
+                    }
+                    decoded_.append(data_.substr(pos_, quote + 1 - pos_));
+                    pos_ = quote + 2;
+                    continue;
+                }
+                if (decoded_start == std::string::npos) {
+                    fields_.push_back(data_.substr(start, quote - start));
+                } else {
+                    decoded_.append(data_.substr(pos_, quote - pos_));
+                    decoded_fields_.push_back(
+                        {fields_.size(), decoded_start, decoded_.size() - decoded_start});
+                    fields_.emplace_back();
+                }
+                pos_ = quote < size ? quote + 1 : size;
+                break;
+            }
+            // Tolerate stray characters between the closing quote and the delimiter
+            while (pos_ < size && !at_field_end(data_[pos_])) {
+                ++pos_;
+            }
+        } else {
+            const std::size_t start = pos_;
+            while (pos_ < size && !at_field_end(data_[pos_])) {
+                ++pos_;
+            }
+            fields_.push_back(data_.substr(start, pos_ - start));
+        }
+
+        if (pos_ < size && data_[pos_] == delimiter_) {
+            ++pos_;
+            continue;
+        }
+        if (pos_ < size && data_[pos_] == '\r') {
+            ++pos_;
+        }
+        if (pos_ < size && data_[pos_] == '\n') {
+            ++pos_;
+        }
+        break;
+    }
+
+    const std::string_view decoded(decoded_);
+    for (const auto& field : decoded_fields_) {
+        fields_[field.column] = decoded.substr(field.offset, field.length);
+    }
+    return true;
+}
+
+// ============================================================================
+// JsonLinesRecordSource
+// ============================================================================
+
+JsonLinesRecordSource::JsonLinesRecordSource(const std::string& path)
+    : file_(std::make_unique<MappedFile>(path)) {
+    if (!file_->is_open()) {
+        return;
+    }
+    data_ = file_->data();
+    if (data_.substr(0, 3) == "\xEF\xBB\xBF") {
+        pos_ = 3;
+    }
+    open_ = true;
+}
+
+JsonLinesRecordSource::~JsonLinesRecordSource() = default;
+
+bool JsonLinesRecordSource::next() {
+    while (pos_ < data_.size()) {
+        std::size_t end = data_.find('\n', pos_);
+        if (end == std::string_view::npos) {
+            end = data_.size();
+        }
+        std::string_view line = data_.substr(pos_, end - pos_);
+        pos_ = end < data_.size() ? end + 1 : end;
+
+        while (!line.empty() && is_json_space(line.back())) {
+            line.remove_suffix(1);
+        }
+        while (!line.empty() && is_json_space(line.front())) {
+            line.remove_prefix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (parse_line(line)) {
+            return true;
+        }
+        ++skipped_;
+    }
+    fields_.clear();
+    return false;
+}
+
+std::string_view JsonLinesRecordSource::get_field(std::size_t column) const {
+    return column < fields_.size() ? fields_[column] : std::string_view();
+}
+
+std::size_t JsonLinesRecordSource::column_for_key(std::string_view key, std::size_t hint) {
+    // Lines usually repeat the same key order, so the hint almost always hits
+    if (hint < columns_.size() && columns_[hint] == key) {
+        return hint;
+    }
+    for (std::size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i] == key) {
+            return i;
+        }
+    }
+    columns_.emplace_back(key);
+    return columns_.size() - 1;
+}
+
+bool JsonLinesRecordSource::parse_line(std::string_view line) {
+    fields_.assign(columns_.size(), std::string_view());
+    decoded_.clear();
+    decoded_fields_.clear();
+
+    std::size_t i = 0;
+    if (line[i] != '{') {
+        return false;
+    }
+    ++i;
+    skip_json_space(line, i);
+    if (i < line.size() && line[i] == '}') {
+        return i + 1 == line.size();
+    }
+
+    std::string key_buffer;
+    std::size_t hint = 0;
+    for (;;) {
+        skip_json_space(line, i);
+        std::string_view key;
+        bool key_escapes = false;
+        if (!scan_json_string(line, i, key, key_escapes)) {
+            return false;
+        }
+        if (key_escapes) {
+            key_buffer.clear();
+            if (!decode_json_string(key, key_buffer)) {
+                return false;
+            }
+            key = key_buffer;
+        }
+
+        skip_json_space(line, i);
+        if (i >= line.size() || line[i] != ':') {
+            return false;
+        }
+        ++i;
+        skip_json_space(line, i);
+        if (i >= line.size()) {
+            return false;
+        }
+
+        std::string_view value;
+        bool present = true;
+        bool decoded = false;
+        std::size_t decoded_start = 0;
+        const char c = line[i];
+        if (c == '"') {
+            bool escapes = false;
+            if (!scan_json_string(line, i, value, escapes)) {
+                return false;
+            }
+            if (escapes) {
+                decoded_start = decoded_.size();
+                if (!decode_json_string(value, decoded_)) {
+                    return false;
+                }
+                decoded = true;
+            }
+        } else if (c == '{' || c == '[') {
+            const std::size_t start = i;
+            if (!skip_json_container(line, i)) {
+                return false;
+            }
+            value = line.substr(start, i - start);
+        } else {
+            const std::size_t start = i;
+            while (i < line.size() && line[i] != ',' && line[i] != '}' &&
+                   !is_json_space(line[i])) {
+                ++i;
+            }
+            value = line.substr(start, i - start);
+            if (value.empty()) {
+                return false;
+            }
+            present = value != "null";
+        }
+
+        const std::size_t column = column_for_key(key, hint);
+        hint = column + 1;
+        if (column >= fields_.size()) {
+            fields_.resize(columns_.size());
+        }
+        if (decoded) {
+            decoded_fields_.push_back({column, decoded_start, decoded_.size() - decoded_start});
+        } else if (present) {
+            fields_[column] = value;
+        }
+
+        skip_json_space(line, i);
+        if (i < line.size() && line[i] == ',') {
+            ++i;
+            continue;
+        }
+        if (i < line.size() && line[i] == '}') {
+            ++i;
+            break;
+        }
+        return false;
+    }
+
+    skip_json_space(line, i);
+    if (i != line.size()) {
+        return false;
+    }
+
+    const std::string_view decoded_view(decoded_);
+    for (const auto& field : decoded_fields_) {
+        fields_[field.column] = decoded_view.substr(field.offset, field.length);
+    }
+    return true;
+}
+
+}  // namespace cdocx
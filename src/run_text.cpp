@@ -0,0 +1,323 @@
+/**
+ * @file run_text.cpp
+ * @brief Control-character-aware run text serialization with UTF-8 validation
+ * @internal Not part of the public API.
+ */
+
+#include "run_text.h"
+
+#include <cdocx/control_char.h>
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CDOCX_SCAN_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CDOCX_SCAN_NEON 1
+#endif
+
+namespace cdocx {
+
+namespace {
+
+constexpr unsigned char kFirstPrintable = 0x20;
+constexpr unsigned char kFirstNonAscii = 0x80;
+constexpr char kReplacementChar[] = "\xEF\xBF\xBD";  // U+FFFD
+
+bool is_control(char c) {
+    return static_cast<unsigned char>(c) < kFirstPrintable;
+}
+
+bool is_control_or_non_ascii(char c) {
+    const auto byte = static_cast<unsigned char>(c);
+    return byte < kFirstPrintable || byte >= kFirstNonAscii;
+}
+
+bool in_range(unsigned char byte, unsigned char low, unsigned char high) {
+    return byte >= low && byte <= high;
+}
+
+/**
+ * Length of the well-formed UTF-8 sequence at @p data (Unicode table 3-7:
+ * no overlong forms, surrogates or code points above U+10FFFF), or 0.
+ */
+std::size_t utf8_sequence_length(const char* data, std::size_t size) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char lead = bytes[0];
+    std::size_t length = 0;
+    unsigned char second_low = 0x80;
+    unsigned char second_high = 0xBF;
+    if (in_range(lead, 0xC2, 0xDF)) {
+        length = 2;
+    } else if (in_range(lead, 0xE0, 0xEF)) {
+        length = 3;
+        second_low = lead == 0xE0 ? 0xA0 : 0x80;
+        second_high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (in_range(lead, 0xF0, 0xF4)) {
+        length = 4;
+        second_low = lead == 0xF0 ? 0x90 : 0x80;
+        second_high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return 0;
+    }
+
+    if (size < length || !in_range(bytes[1], second_low, second_high)) {
+        return 0;
+    }
+    for (std::size_t i = 2; i < length; ++i) {
+        if (!in_range(bytes[i], 0x80, 0xBF)) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+/// True for EF BF BE and EF BF BF, the well-formed encodings of U+FFFE and U+FFFF
+bool is_excluded_char(const char* data, std::size_t length) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    return length == 3 && bytes[0] == 0xEF && bytes[1] == 0xBF && bytes[2] >= 0xBE;
+}
+
+/// Scalar scan of [from, end) for a control or non-ASCII byte
+std::size_t find_special_scalar(const char* data, std::size_t from, std::size_t end) {
+    for (std::size_t i = from; i < end; ++i) {
+        if (is_control_or_non_ascii(data[i])) {
+            return i;
+        }
+    }
+    return end;
+}
+
+/// Offset of the first byte below 0x20 or at least 0x80 at or after @p from, or size
+std::size_t find_special_byte(const char* data, std::size_t from, std::size_t size) {
+    std::size_t i = from;
+
+#if defined(CDOCX_SCAN_SSE2)
+    // As signed bytes, those at least 0x80 are negative and so also below 0x20
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(kFirstPrintable));
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if (_mm_movemask_epi8(_mm_cmplt_epi8(chunk, limit)) != 0) {
+            return find_special_scalar(data, i, i + 16);
+        }
+    }
+#elif defined(CDOCX_SCAN_NEON)
+    const int8x16_t limit = vdupq_n_s8(static_cast<std::int8_t>(kFirstPrintable));
+    for (; i + 16 <= size; i += 16) {
+        const int8x16_t chunk = vld1q_s8(reinterpret_cast<const std::int8_t*>(data + i));
+        if (vmaxvq_u8(vcltq_s8(chunk, limit)) != 0) {
+            return find_special_scalar(data, i, i + 16);
+        }
+    }
+#else
+    // A byte's high bit is set in the result if it was set or the byte was below 0x20
+    constexpr std::uint64_t kOnes = 0x0101010101010101ULL;
+    constexpr std::uint64_t kHighBits = 0x8080808080808080ULL;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if ((((word - kOnes * kFirstPrintable) | word) & kHighBits) != 0) {
+            return find_special_scalar(data, i, i + 8);
+        }
+    }
+#endif
+
+    return find_special_scalar(data, i, size);
+}
+
+/// Scalar scan of [from, end); used for tails and to locate the byte inside a flagged chunk
+std::size_t find_control_scalar(const char* data, std::size_t from, std::size_t end) {
+    for (std::size_t i = from; i < end; ++i) {
+        if (is_control(data[i])) {
+            return i;
+        }
+    }
+    return end;
+}
+
+void append_text_element(pugi::xml_node run, std::string_view text, const char* text_name) {
+    auto node = run.append_child(text_name);
+    if (std::isspace(static_cast<unsigned char>(text.front())) ||
+        std::isspace(static_cast<unsigned char>(text.back()))) {
+        node.append_attribute("xml:space").set_value("preserve");
+    }
+    node.text().set(text.data(), text.size());
+}
+
+void append_break(pugi::xml_node run, const char* type) {
+    auto br = run.append_child("w:br");
+    if (type) {
+        br.append_attribute("w:type").set_value(type);
+    }
+}
+
+}  // namespace
+
+std::size_t find_control_byte(std::string_view text, std::size_t from) {
+    const char* data = text.data();
+    const std::size_t size = text.size();
+    std::size_t i = from;
+
+#if defined(CDOCX_SCAN_SSE2)
+    // Bytes below 0x20 are exactly those equal to their unsigned min with 0x1F
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(kFirstPrintable - 1));
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, limit), chunk);
+        if (_mm_movemask_epi8(control) != 0) {
+            return find_control_scalar(data, i, i + 16);
+        }
+    }
+#elif defined(CDOCX_SCAN_NEON)
+    const uint8x16_t limit = vdupq_n_u8(kFirstPrintable);
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const std::uint8_t*>(data + i));
+        if (vmaxvq_u8(vcltq_u8(chunk, limit)) != 0) {
+            return find_control_scalar(data, i, i + 16);
+        }
+    }
+#else
+    // Eight bytes at a time: the high bit of a byte survives only if it was below 0x20
+    constexpr std::uint64_t kOnes = 0x0101010101010101ULL;
+    constexpr std::uint64_t kHighBits = 0x8080808080808080ULL;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if (((word - kOnes * kFirstPrintable) & ~word & kHighBits) != 0) {
+            return find_control_scalar(data, i, i + 8);
+        }
+    }
+#endif
+
+    return find_control_scalar(data, i, size);
+}
+
+std::size_t find_unsafe_byte(std::string_view text, std::size_t from) {
+    const char* data = text.data();
+    const std::size_t size = text.size();
+    std::size_t i = from;
+    while (true) {
+        i = find_special_byte(data, i, size);
+        if (i == size || is_control(data[i])) {
+            return i;
+        }
+        // Non-ASCII text tends to come in runs: validate them without rescanning
+        while (i < size && static_cast<unsigned char>(data[i]) >= kFirstNonAscii) {
+            const std::size_t length = utf8_sequence_length(data + i, size - i);
+            if (length == 0 || is_excluded_char(data + i, length)) {
+                return i;
+            }
+            i += length;
+        }
+    }
+}
+
+void append_run_text(pugi::xml_node run, std::string_view text, const char* text_name) {
+    std::size_t pos = find_unsafe_byte(text);
+    if (pos == text.size()) {
+        if (!text.empty()) {
+            append_text_element(run, text, text_name);
+        }
+        return;
+    }
+
+    // Plain text between breaks; dropped bytes must not split it into several elements
+    std::string pending;
+    auto flush = [&]() {
+        if (!pending.empty()) {
+            append_text_element(run, pending, text_name);
+            pending.clear();
+        }
+    };
+
+    std::size_t start = 0;
+    while (pos < text.size()) {
+        pending.append(text, start, pos - start);
+        const char c = text[pos];
+        start = pos + 1;
+        if (!is_control(c)) {
+            // A disallowed character is replaced whole, a malformed byte one at a time
+            const std::size_t length = utf8_sequence_length(text.data() + pos, text.size() - pos);
+            start = pos + (length == 0 ? 1 : length);
+            pending += kReplacementChar;
+            pos = find_unsafe_byte(text, start);
+            continue;
+        }
+        switch (c) {
+            case ControlChar::kTabChar:
+                flush();
+                run.append_child("w:tab");
+                break;
+            case ControlChar::kParagraphBreakChar:
+                if (start < text.size() && text[start] == ControlChar::kLineFeedChar) {
+                    ++start;
+                }
+                flush();
+                append_break(run, nullptr);
+                break;
+            case ControlChar::kLineFeedChar:
+            case ControlChar::kLineBreakChar:
+                flush();
+                append_break(run, nullptr);
+                break;
+            case ControlChar::kPageBreakChar:
+                flush();
+                append_break(run, "page");
+                break;
+            case ControlChar::kColumnBreakChar:
+                flush();
+                append_break(run, "column");
+                break;
+            default:
+                break;  // Not allowed in XML 1.0
+        }
+        pos = find_unsafe_byte(text, start);
+    }
+    pending.append(text, start, std::string_view::npos);
+    flush();
+}
+
+bool is_run_text_element(pugi::xml_node node) {
+    const char* name = node.name();
+    if (std::strcmp(name, "w:t") == 0 || std::strcmp(name, "w:delText") == 0 ||
+        std::strcmp(name, "w:tab") == 0) {
+        return true;
+    }
+    if (std::strcmp(name, "w:br") != 0 || node.attribute("w:clear")) {
+        return false;
+    }
+    const char* type = node.attribute("w:type").value();
+    return *type == '\0' || std::strcmp(type, "textWrapping") == 0 ||
+           std::strcmp(type, "page") == 0 || std::strcmp(type, "column") == 0;
+}
+
+std::string read_run_text(pugi::xml_node run) {
+    std::string text;
+    for (auto child = run.first_child(); child; child = child.next_sibling()) {
+        if (child.type() != pugi::node_element || !is_run_text_element(child)) {
+            continue;
+        }
+        const char* name = child.name();
+        if (std::strcmp(name, "w:tab") == 0) {
+            text += ControlChar::kTabChar;
+        } else if (std::strcmp(name, "w:br") == 0) {
+            const char* type = child.attribute("w:type").value();
+            if (std::strcmp(type, "page") == 0) {
+                text += ControlChar::kPageBreakChar;
+            } else if (std::strcmp(type, "column") == 0) {
+                text += ControlChar::kColumnBreakChar;
+            } else {
+                text += ControlChar::kLineBreakChar;
+            }
+        } else {
+            text += child.text().get();
+        }
+    }
+    return text;
+}
+
+}  // namespace cdocx
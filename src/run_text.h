@@ -0,0 +1,40 @@
+/**
+ * @file run_text.h
+ * @brief Internal conversion between run text and w:t/w:tab/w:br run content
+ * @internal Not part of the public API.
+ * @details Run text may carry the ControlChar characters: '\t' is written as
+ *          w:tab, '\n', '\v' and '\r' ("\r\n" counts once) as w:br, '\f' as a
+ *          page break and ControlChar::kColumnBreakChar as a column break.
+ *          Every other byte below 0x20 is not allowed in XML 1.0 and is
+ *          dropped. Text without any byte below 0x20, the common case, is
+ *          detected with one vectorized scan and written as a single w:t.
+ */
+
+#pragma once
+
+#include <pugixml.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace cdocx {
+
+/// Offset of the first byte below 0x20 in @p text at or after @p from, or text.size()
+std::size_t find_control_byte(std::string_view text, std::size_t from = 0);
+
+/// Offset of the first byte at or after @p from that cannot be written to w:t as
+/// is (a byte below 0x20 or the start of an invalid or disallowed UTF-8
+/// sequence), or text.size()
+std::size_t find_unsafe_byte(std::string_view text, std::size_t from = 0);
+
+/// Appends @p text to the w:r element @p run; plain text goes into @p text_name elements
+void append_run_text(pugi::xml_node run, std::string_view text, const char* text_name = "w:t");
+
+/// True for the children append_run_text() produces (text, tab and plain/page/column breaks)
+bool is_run_text_element(pugi::xml_node node);
+
+/// Text of the run content of @p run in document order; the inverse of append_run_text()
+std::string read_run_text(pugi::xml_node run);
+
+}  // namespace cdocx
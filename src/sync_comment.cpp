@@ -17,8 +17,24 @@ namespace cdocx {
 // Comment Sync
 // ============================================================================
 
+static void serialize_comment_to_xml(pugi::xml_node cxml, Comment& comment) {
+    cxml.append_attribute("w:id").set_value(comment.get_id());
+    cxml.append_attribute("w:author").set_value(comment.get_author().c_str());
+    cxml.append_attribute("w:initials").set_value(comment.get_initial().c_str());
+
+    auto time_val = std::chrono::system_clock::to_time_t(comment.get_date_time());
+    cxml.append_attribute("w:date").set_value(time_to_w3cdtf(time_val).c_str());
+
+    // Serialize comment paragraphs
+    for (const auto& child : comment.get_children()) {
+        if (child->node_type() == NodeType::Paragraph) {
+            serialize_paragraph_to_xml(cxml, dynamic_cast<Paragraph*>(child.get()));
+        }
+    }
+}
+
 void Document::sync_comments_to_physical() {
-    if (comments_cache_.empty()) {
+    if (comments_cache_.empty() && comments_index_.synced.empty()) {
         return;
     }
 
@@ -38,42 +54,43 @@ void Document::sync_comments_to_physical() {
             .set_value("http://schemas.microsoft.com/office/word/2012/wordml");
     }
 
-    // Remove existing comment nodes
-    for (auto child = root.first_child(); child;) {
-        auto next = child.next_sibling();
-        if (std::strcmp(child.name(), "w:comment") == 0) {
-            root.remove_child(child);
-        }
-        child = next;
-    }
-
-    for (const auto& comment : comments_cache_) {
-        auto cxml = root.append_child("w:comment");
-        cxml.append_attribute("w:id").set_value(comment->get_id());
-        cxml.append_attribute("w:author").set_value(comment->get_author().c_str());
-        cxml.append_attribute("w:initials").set_value(comment->get_initial().c_str());
-
-        auto time_val = std::chrono::system_clock::to_time_t(comment->get_date_time());
-        cxml.append_attribute("w:date").set_value(time_to_w3cdtf(time_val).c_str());
-
-        // Serialize comment paragraphs
-        for (const auto& child : comment->get_children()) {
-            if (child->node_type() == NodeType::Paragraph) {
-                serialize_paragraph_to_xml(cxml, dynamic_cast<Paragraph*>(child.get()));
+    bool changed = false;
+    if (comments_index_.part != comments_xml) {
+        // First sync into this part: remove existing comment nodes
+        for (auto child = root.first_child(); child;) {
+            auto next = child.next_sibling();
+            if (std::strcmp(child.name(), "w:comment") == 0) {
+                root.remove_child(child);
             }
+            child = next;
         }
+        comments_index_.synced.clear();
+        comments_index_.part = comments_xml;
+        changed = true;
     }
 
-    mark_modified("word/comments.xml");
+    changed |= sync_items_incremental(root,
+                                      "w:comment",
+                                      pugi::xml_node(),
+                                      comments_cache_,
+                                      comments_index_.synced,
+                                      serialize_comment_to_xml);
+    if (changed) {
+        mark_modified("word/comments.xml");
+    }
 }
 
 void Document::sync_comments_from_physical() {
     auto* comments_xml = get_xml_part("word/comments.xml");
     if (!comments_xml) {
+        comment_anchors_.clear();
         return;
     }
 
     comments_cache_.clear();
+    comments_index_.by_id.clear();
+    comments_index_.synced.clear();
+    comments_index_.part = comments_xml;
 
     auto root = comments_xml->child("w:comments");
     if (!root) {
@@ -100,6 +117,9 @@ void Document::sync_comments_from_physical() {
             }
         }
 
+        comment->set_modified(false);
+        comments_index_.by_id[comment->get_id()] = comment;
+        comments_index_.synced[comment.get()] = {cxml, formatted_content_signature(*comment)};
         comments_cache_.push_back(comment);
     }
 
@@ -108,7 +128,9 @@ void Document::sync_comments_from_physical() {
             next_comment_id_ = comment->get_id() + 1;
         }
     }
-}
 
+    // The body has been read by now, so removing a comment can drop its anchors directly
+    index_comment_anchors();
+}
 
 }  // namespace cdocx
@@ -457,6 +457,150 @@ void strip_whitespace_text_nodes(pugi::xml_node node) {
     }
 }
 
+std::uint64_t content_signature(const CompositeNode& node) {
+    // FNV-1a over the text, mixed with the child count so that empty
+    // paragraphs and paragraph splits are detected as well
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char c : node.get_text()) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return (hash ^ node.get_children().size()) * 1099511628211ULL;
+}
+
+namespace {
+
+void add_border(SignatureHash& hash, const Border& border) {
+    hash.add(border.type);
+    hash.add(border.color);
+    hash.add(border.width);
+    hash.add(border.space);
+    hash.add(border.shadow);
+}
+
+void add_shading(SignatureHash& hash, const Shading& shading) {
+    hash.add(shading.foreground);
+    hash.add(shading.background);
+    hash.add(shading.texture);
+}
+
+void add_font(SignatureHash& hash, const Font& font) {
+    hash.add(font.name);
+    hash.add(font.name_ascii);
+    hash.add(font.name_far_east);
+    hash.add(font.name_other);
+    hash.add(font.size);
+    hash.add(font.color);
+    hash.add(font.bold);
+    hash.add(font.italic);
+    hash.add(font.hidden);
+    hash.add(font.underline);
+    hash.add(font.underline_color);
+    hash.add(font.strike);
+    hash.add(font.double_strike);
+    hash.add(font.strikethrough);
+    hash.add(font.script_type);
+    hash.add(font.highlight);
+    hash.add(font.spacing);
+    hash.add(font.scale);
+    hash.add(font.kerning);
+    hash.add(font.small_caps);
+    hash.add(font.all_caps);
+    add_shading(hash, font.shading);
+}
+
+void add_paragraph_format(SignatureHash& hash, const ParagraphFormat& format) {
+    hash.add(format.alignment);
+    hash.add(format.left_indent);
+    hash.add(format.right_indent);
+    hash.add(format.first_line_indent);
+    hash.add(format.space_before);
+    hash.add(format.space_after);
+    hash.add(format.line_spacing_rule);
+    hash.add(format.line_spacing);
+    hash.add(format.keep_together);
+    hash.add(format.keep_with_next);
+    hash.add(format.page_break_before);
+    hash.add(format.widow_control);
+    hash.add(format.outline_level);
+    hash.add(format.drop_cap_position);
+    hash.add(format.lines_to_drop);
+    hash.add(format.style_name);
+    const Borders& borders = format.borders;
+    for (const Border* border : {&borders.top, &borders.left, &borders.bottom, &borders.right,
+                                 &borders.inside_horizontal, &borders.inside_vertical}) {
+        add_border(hash, *border);
+    }
+    for (const bool defined : {borders.explicitly_defined, borders.top_defined,
+                               borders.left_defined, borders.bottom_defined,
+                               borders.right_defined, borders.inside_h_defined,
+                               borders.inside_v_defined}) {
+        hash.add(defined);
+    }
+    add_shading(hash, format.shading);
+}
+
+void add_formatted_content(SignatureHash& hash, const CompositeNode& node) {
+    hash.add(node.get_children().size());
+    for (const auto& child : node.get_children()) {
+        hash.add(child->node_type());
+        if (const auto* item = dynamic_cast<const Inline*>(child.get())) {
+            add_font(hash, item->get_font());
+            if (const auto* run = dynamic_cast<const Run*>(item)) {
+                hash.add(run->get_revision_type());
+                hash.add(run->get_revision_id());
+                hash.add(run->get_revision_author());
+                hash.add(run->get_revision_date());
+            }
+        } else if (const auto* para = dynamic_cast<const Paragraph*>(child.get())) {
+            add_paragraph_format(hash, para->get_paragraph_format());
+            hash.add(para->get_list_format().list_id);
+            hash.add(para->get_list_format().level);
+        }
+
+        if (child->is_composite()) {
+            add_formatted_content(hash, static_cast<const CompositeNode&>(*child));
+        } else {
+            hash.add(child->get_text());
+        }
+    }
+}
+
+}  // namespace
+
+std::uint64_t formatted_content_signature(const CompositeNode& node) {
+    SignatureHash hash;
+    add_formatted_content(hash, node);
+    return hash.value();
+}
+
+std::uint32_t next_code_point(std::string_view text, size_t& pos) {
+    const auto lead = static_cast<unsigned char>(text[pos++]);
+    size_t length = 0;
+    std::uint32_t cp = lead;
+    if (lead >= 0xC0 && lead < 0xE0) {
+        length = 1;
+        cp = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead < 0xF0) {
+        length = 2;
+        cp = lead & 0x0F;
+    } else if (lead >= 0xF0 && lead < 0xF8) {
+        length = 3;
+        cp = lead & 0x07;
+    }
+    if (length == 0 || pos + length > text.size()) {
+        return lead;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        const auto next = static_cast<unsigned char>(text[pos + i]);
+        if ((next & 0xC0) != 0x80) {
+            return lead;
+        }
+        cp = (cp << 6) | (next & 0x3F);
+    }
+    pos += length;
+    return cp;
+}
+
 // ============================================================================
 // Shading Helpers
 // ============================================================================
@@ -741,6 +885,114 @@ TextProperties::Highlight string_to_highlight(const char* str) {
     return TextProperties::Highlight::None;
 }
 
+// TextProperties::UnderlineStyle lookup table
+struct UnderlineStyleMapping {
+    TextProperties::UnderlineStyle style{};
+    const char* xml_value{};
+};
+
+static const UnderlineStyleMapping kUnderlineStyleMappings[] = {
+    {TextProperties::UnderlineStyle::Words, "words"},
+    {TextProperties::UnderlineStyle::Single, "single"},
+    {TextProperties::UnderlineStyle::Double, "double"},
+    {TextProperties::UnderlineStyle::Thick, "thick"},
+    {TextProperties::UnderlineStyle::Dotted, "dotted"},
+    {TextProperties::UnderlineStyle::DottedHeavy, "dottedHeavy"},
+    {TextProperties::UnderlineStyle::Dash, "dash"},
+    {TextProperties::UnderlineStyle::DashedHeavy, "dashedHeavy"},
+    {TextProperties::UnderlineStyle::DashLong, "dashLong"},
+    {TextProperties::UnderlineStyle::DashLongHeavy, "dashLongHeavy"},
+    {TextProperties::UnderlineStyle::DotDash, "dotDash"},
+    {TextProperties::UnderlineStyle::DashDotHeavy, "dashDotHeavy"},
+    {TextProperties::UnderlineStyle::DotDotDash, "dotDotDash"},
+    {TextProperties::UnderlineStyle::DashDotDotHeavy, "dashDotDotHeavy"},
+    {TextProperties::UnderlineStyle::Wave, "wave"},
+    {TextProperties::UnderlineStyle::WavyDouble, "wavyDouble"},
+    {TextProperties::UnderlineStyle::WavyHeavy, "wavyHeavy"},
+};
+
+const char* underline_style_to_string(TextProperties::UnderlineStyle style) {
+    for (const auto& m : kUnderlineStyleMappings) {
+        if (m.style == style) {
+            return m.xml_value;
+        }
+    }
+    return "single";
+}
+
+TextProperties::UnderlineStyle string_to_underline_style(const char* str) {
+    for (const auto& m : kUnderlineStyleMappings) {
+        if (std::strcmp(m.xml_value, str) == 0) {
+            return m.style;
+        }
+    }
+    return TextProperties::UnderlineStyle::Single;
+}
+
+// TextProperties::Font::Hint lookup table
+struct FontHintMapping {
+    TextProperties::Font::Hint hint{};
+    const char* xml_value{};
+};
+
+static const FontHintMapping kFontHintMappings[] = {
+    {TextProperties::Font::Hint::EastAsia, "eastAsia"},
+    {TextProperties::Font::Hint::ComplexScript, "cs"},
+};
+
+const char* font_hint_to_string(TextProperties::Font::Hint hint) {
+    for (const auto& m : kFontHintMappings) {
+        if (m.hint == hint) {
+            return m.xml_value;
+        }
+    }
+    return nullptr;
+}
+
+TextProperties::Font::Hint string_to_font_hint(const char* str) {
+    if (!str || !*str) {
+        return TextProperties::Font::Hint::Default;
+    }
+    for (const auto& m : kFontHintMappings) {
+        if (std::strcmp(m.xml_value, str) == 0) {
+            return m.hint;
+        }
+    }
+    return TextProperties::Font::Hint::Default;
+}
+
+// TextProperties::VertAlign lookup table
+struct VertAlignMapping {
+    TextProperties::VertAlign align{};
+    const char* xml_value{};
+};
+
+static const VertAlignMapping kVertAlignMappings[] = {
+    {TextProperties::VertAlign::Superscript, "superscript"},
+    {TextProperties::VertAlign::Subscript, "subscript"},
+};
+
+const char* vert_align_to_string(TextProperties::VertAlign align) {
+    for (const auto& m : kVertAlignMappings) {
+        if (m.align == align) {
+            return m.xml_value;
+        }
+    }
+    return nullptr;
+}
+
+TextProperties::VertAlign string_to_vert_align(const char* str) {
+    if (!str || !*str) {
+        return TextProperties::VertAlign::None;
+    }
+    for (const auto& m : kVertAlignMappings) {
+        if (std::strcmp(m.xml_value, str) == 0) {
+            return m.align;
+        }
+    }
+    return TextProperties::VertAlign::None;
+}
+
 // TextFormFieldType lookup table
 struct TextFormFieldTypeMapping {
     TextFormFieldType type{};
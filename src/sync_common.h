@@ -11,7 +11,13 @@
 #include <cdocx/paragraph.h>
 #include <cdocx/style.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace cdocx {
 
@@ -43,6 +49,113 @@ void parse_field_code_and_switches(const std::string& code, Field* field);
 
 void strip_whitespace_text_nodes(pugi::xml_node node);
 
+// ---------------------------------------------------------------------------
+// Incremental item sync (comments, footnotes, endnotes)
+// ---------------------------------------------------------------------------
+
+/// FNV-1a over a sequence of plain values and strings
+class SignatureHash {
+  public:
+    template <typename T>
+    void add(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "hash the bytes of plain values only");
+        const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            mix(bytes[i]);
+        }
+    }
+
+    void add(const std::string& value) {
+        for (const unsigned char c : value) {
+            mix(c);
+        }
+        mix(0);
+    }
+
+    std::uint64_t value() const { return hash_; }
+
+  private:
+    void mix(unsigned char c) { hash_ = (hash_ ^ c) * 1099511628211ULL; }
+
+    std::uint64_t hash_ = 14695981039346656037ULL;
+};
+
+/// Cheap change detector for a container's content (text and child count)
+std::uint64_t content_signature(const CompositeNode& node);
+
+/// Like content_signature(), but also covers the node types and the run and
+/// paragraph formatting of every descendant, so formatting-only edits count
+std::uint64_t formatted_content_signature(const CompositeNode& node);
+
+/// Decodes the UTF-8 sequence at @p pos and advances it; invalid bytes decode as themselves
+std::uint32_t next_code_point(std::string_view text, size_t& pos);
+
+/**
+ * Bring the @p child_name elements of @p root in line with @p items, touching
+ * only items that are new, flagged is_modified() or whose
+ * formatted_content_signature() changed. @p synced maps each item to its element and signature (see
+ * Document::SyncedXmlItem) and is updated in place; elements of items that are
+ * no longer in @p items are removed. New elements go after the preceding
+ * item's element, or after @p anchor for the first item.
+ *
+ * @return true if the XML was changed
+ */
+template <typename T, typename SyncedMap, typename Serialize>
+bool sync_items_incremental(pugi::xml_node root,
+                            const char* child_name,
+                            pugi::xml_node anchor,
+                            const std::vector<std::shared_ptr<T>>& items,
+                            SyncedMap& synced,
+                            Serialize serialize) {
+    bool changed = false;
+    pugi::xml_node prev = anchor;
+    for (const auto& item : items) {
+        const std::uint64_t signature = formatted_content_signature(*item);
+        auto it = synced.find(item.get());
+        if (it != synced.end() && !item->is_modified() && it->second.signature == signature) {
+            prev = it->second.node;
+            continue;
+        }
+
+        pugi::xml_node element;
+        if (it != synced.end()) {
+            element = root.insert_child_before(child_name, it->second.node);
+            root.remove_child(it->second.node);
+        } else if (prev) {
+            element = root.insert_child_after(child_name, prev);
+        } else {
+            element = root.prepend_child(child_name);
+        }
+        serialize(element, *item);
+
+        auto& entry = synced[item.get()];
+        entry.node = element;
+        entry.signature = signature;
+        item->set_modified(false);
+        prev = element;
+        changed = true;
+    }
+
+    if (synced.size() > items.size()) {
+        std::vector<const T*> live;
+        live.reserve(items.size());
+        for (const auto& item : items) {
+            live.push_back(item.get());
+        }
+        std::sort(live.begin(), live.end());
+        for (auto it = synced.begin(); it != synced.end();) {
+            if (!std::binary_search(live.begin(), live.end(), it->first)) {
+                root.remove_child(it->second.node);
+                it = synced.erase(it);
+                changed = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return changed;
+}
+
 // ---------------------------------------------------------------------------
 // Node name helpers (shared between serialize and deserialize)
 // ---------------------------------------------------------------------------
@@ -107,6 +220,15 @@ LineSpacingRule string_to_line_spacing_rule(const char* str);
 const char* highlight_to_string(TextProperties::Highlight highlight);
 TextProperties::Highlight string_to_highlight(const char* str);
 
+const char* underline_style_to_string(TextProperties::UnderlineStyle style);
+TextProperties::UnderlineStyle string_to_underline_style(const char* str);
+
+const char* font_hint_to_string(TextProperties::Font::Hint hint);  ///< nullptr for Default
+TextProperties::Font::Hint string_to_font_hint(const char* str);
+
+const char* vert_align_to_string(TextProperties::VertAlign align);  ///< nullptr for None
+TextProperties::VertAlign string_to_vert_align(const char* str);
+
 const char* text_form_field_type_to_string(TextFormFieldType type);
 TextFormFieldType string_to_text_form_field_type(const char* str);
 
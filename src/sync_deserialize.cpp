@@ -14,6 +14,7 @@
 
 #include <cstring>
 
+#include "run_text.h"
 #include "sync_common.h"
 
 namespace cdocx {
@@ -244,10 +245,11 @@ std::shared_ptr<Run> Document::parse_run_from_xml(pugi::xml_node run_node) {
 
     auto run = std::make_shared<Run>(this);
 
-    // Get text content
-    auto text_node = run_node.child("w:t");
-    if (text_node) {
-        run->set_text(text_node.text().get());
+    // Text content (w:delText inside a deleted run carries the text); tabs and
+    // breaks between text elements are folded into it as control characters
+    const bool has_text = run_node.child("w:t") || run_node.child("w:delText");
+    if (has_text) {
+        run->set_text(read_run_text(run_node));
     }
 
     // Parse formatting
@@ -259,8 +261,7 @@ std::shared_ptr<Run> Document::parse_run_from_xml(pugi::xml_node run_node) {
         if (child.type() == pugi::node_pcdata || child.type() == pugi::node_cdata) {
             continue;
         }
-        const char* name = child.name();
-        if (std::strcmp(name, "w:t") != 0 && std::strcmp(name, "w:rPr") != 0) {
+        if (std::strcmp(child.name(), "w:rPr") != 0 && !(has_text && is_run_text_element(child))) {
             run->preserve_child(child);
         }
     }
@@ -376,6 +377,25 @@ pugi::xml_node walk_field_sequence(pugi::xml_node start_run,
     return pugi::xml_node{};
 }
 
+// Separator run of the field that starts at @p begin_run, or the last node of
+// the paragraph when the field code itself continues in the next one
+static pugi::xml_node skip_to_field_separator(pugi::xml_node begin_run) {
+    pugi::xml_node last = begin_run;
+    int depth = 0;
+    for (auto node = begin_run.next_sibling(); node; node = node.next_sibling()) {
+        last = node;
+        const char* type = node.child("w:fldChar").attribute("w:fldCharType").value();
+        if (std::strcmp(type, "begin") == 0) {
+            ++depth;
+        } else if (std::strcmp(type, "end") == 0) {
+            --depth;
+        } else if (depth == 0 && std::strcmp(type, "separate") == 0) {
+            return node;
+        }
+    }
+    return last;
+}
+
 void parse_field_code_and_switches(const std::string& code, Field* field) {
     std::string trimmed = trim_whitespace(code);
     size_t switch_pos = std::string::npos;
@@ -441,10 +461,8 @@ static void parse_hyperlink_from_xml(Document* doc,
     bool formatting_parsed = false;
     for (auto run_node = hyperlink_node.child("w:r"); run_node;
          run_node = run_node.next_sibling("w:r")) {
-        auto text_node = run_node.child("w:t");
-        if (text_node) {
-            link_text += text_node.text().get();
-        }
+        // Keeps tabs and breaks, e.g. the tab before a table of contents page number
+        link_text += read_run_text(run_node);
         if (!formatting_parsed) {
             parse_run_format_from_xml(hyperlink.get(), run_node);
             formatting_parsed = true;
@@ -548,15 +566,40 @@ std::shared_ptr<Paragraph> Document::parse_paragraph_from_xml(pugi::xml_node par
                     auto end_node = walk_field_sequence(child, &field_code, &field_result);
                     if (end_node) {
                         child = end_node;
+                    } else {
+                        // The result continues in later paragraphs (e.g. a table of
+                        // contents); what follows the separator is parsed as content
+                        field->set_spans_paragraphs(true);
+                        field_result.clear();
+                        child = skip_to_field_separator(child);
                     }
 
                     parse_field_code_and_switches(field_code, field.get());
                     field->set_result(field_result);
                     para->append_child(field);
                 }
+            } else if (fld_char &&
+                       std::strcmp(fld_char.attribute("w:fldCharType").value(), "end") == 0) {
+                // End of a field that began in an earlier paragraph
+                para->append_child(SpecialChar::field_end());
             } else if (auto run = parse_run_from_xml(child)) {
                 para->append_child(run);
             }
+        } else if (std::strcmp(name, "w:ins") == 0 || std::strcmp(name, "w:del") == 0) {
+            // Tracked change: keep the wrapped runs and tag them with the revision
+            const RevisionType type = std::strcmp(name, "w:ins") == 0
+                                          ? RevisionType::Insertion
+                                          : RevisionType::Deletion;
+            for (auto run_node = child.child("w:r"); run_node;
+                 run_node = run_node.next_sibling("w:r")) {
+                if (auto run = parse_run_from_xml(run_node)) {
+                    run->set_revision(type,
+                                      child.attribute("w:id").as_int(),
+                                      child.attribute("w:author").value(),
+                                      child.attribute("w:date").value());
+                    para->append_child(run);
+                }
+            }
         } else if (std::strcmp(name, "w:hyperlink") == 0) {
             parse_hyperlink_from_xml(this, child, para);
         } else if (std::strcmp(name, "w:br") == 0) {
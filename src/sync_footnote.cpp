@@ -17,11 +17,37 @@ namespace cdocx {
 // Footnote / Endnote Helpers
 // ============================================================================
 
+static void serialize_note_to_xml(pugi::xml_node node, Footnote& note) {
+    node.append_attribute("w:id").set_value(note.get_id());
+    if (!note.is_auto() && !note.get_reference_mark().empty()) {
+        node.append_attribute("w:type").set_value("normal");
+    }
+    bool first_para = true;
+    for (const auto& child : note.get_children()) {
+        if (child->node_type() == NodeType::Paragraph) {
+            auto para = dynamic_cast<Paragraph*>(child.get());
+            std::shared_ptr<Run> temp_ref_run;
+            if (first_para && !note.is_auto() && !note.get_reference_mark().empty()) {
+                temp_ref_run = std::make_shared<Run>();
+                temp_ref_run->set_text(note.get_reference_mark());
+                para->insert_child(0, temp_ref_run);
+            }
+            serialize_paragraph_to_xml(node, para);
+            first_para = false;
+            if (temp_ref_run) {
+                para->remove_child(temp_ref_run);
+            }
+        }
+    }
+}
+
+template <typename Index>
 static void sync_notes_to_physical_impl(Document* doc,
                                         const char* xml_part,
                                         const char* root_name,
                                         const char* child_name,
-                                        const std::vector<std::shared_ptr<Footnote>>& cache) {
+                                        const std::vector<std::shared_ptr<Footnote>>& cache,
+                                        Index& index) {
     auto* notes_xml = doc->get_xml_part(xml_part);
     if (!notes_xml) {
         if (cache.empty()) {
@@ -39,72 +65,68 @@ static void sync_notes_to_physical_impl(Document* doc,
             "http://schemas.openxmlformats.org/officeDocument/2006/relationships");
     }
 
-    // Collect separator nodes to preserve them
-    std::vector<pugi::xml_node> separators;
-    for (auto child = root.first_child(); child;) {
-        auto next = child.next_sibling();
-        const int note_id = child.attribute("w:id").as_int();
-        if (note_id < 0 || note_id == 0) {
-            separators.push_back(child);
+    bool changed = false;
+    if (index.part != notes_xml) {
+        // First sync into this part: rebuild it, keeping only the separators
+        std::vector<pugi::xml_node> separators;
+        for (auto child = root.first_child(); child;) {
+            auto next = child.next_sibling();
+            const int note_id = child.attribute("w:id").as_int();
+            if (note_id < 0 || note_id == 0) {
+                separators.push_back(child);
+            }
+            root.remove_child(child);
+            child = next;
         }
-        root.remove_child(child);
-        child = next;
-    }
 
-    // Re-add separators first, or create them if missing
-    if (separators.empty()) {
-        auto sep = root.prepend_child(child_name);
-        sep.append_attribute("w:id").set_value(-1);
-        sep.append_attribute("w:type").set_value("separator");
-        auto sep_para = sep.append_child("w:p");
-        auto sep_run = sep_para.append_child("w:r");
-        sep_run.append_child("w:separator");
-
-        auto cont_sep = root.prepend_child(child_name);
-        cont_sep.append_attribute("w:id").set_value(0);
-        cont_sep.append_attribute("w:type").set_value("continuationSeparator");
-        auto cont_para = cont_sep.append_child("w:p");
-        auto cont_run = cont_para.append_child("w:r");
-        cont_run.append_child("w:continuationSeparator");
-    } else {
-        for (auto& sep : separators) {
-            root.append_copy(sep);
+        // Re-add separators first, or create them if missing
+        if (separators.empty()) {
+            auto sep = root.prepend_child(child_name);
+            sep.append_attribute("w:id").set_value(-1);
+            sep.append_attribute("w:type").set_value("separator");
+            auto sep_para = sep.append_child("w:p");
+            auto sep_run = sep_para.append_child("w:r");
+            sep_run.append_child("w:separator");
+
+            auto cont_sep = root.prepend_child(child_name);
+            cont_sep.append_attribute("w:id").set_value(0);
+            cont_sep.append_attribute("w:type").set_value("continuationSeparator");
+            auto cont_para = cont_sep.append_child("w:p");
+            auto cont_run = cont_para.append_child("w:r");
+            cont_run.append_child("w:continuationSeparator");
+        } else {
+            for (auto& sep : separators) {
+                root.append_copy(sep);
+            }
         }
+
+        index.synced.clear();
+        index.part = notes_xml;
+        changed = true;
     }
 
-    for (const auto& note : cache) {
-        auto node = root.append_child(child_name);
-        node.append_attribute("w:id").set_value(note->get_id());
-        if (!note->is_auto() && !note->get_reference_mark().empty()) {
-            node.append_attribute("w:type").set_value("normal");
-        }
-        bool first_para = true;
-        for (const auto& child : note->get_children()) {
-            if (child->node_type() == NodeType::Paragraph) {
-                auto para = dynamic_cast<Paragraph*>(child.get());
-                std::shared_ptr<Run> temp_ref_run;
-                if (first_para && !note->is_auto() && !note->get_reference_mark().empty()) {
-                    temp_ref_run = std::make_shared<Run>();
-                    temp_ref_run->set_text(note->get_reference_mark());
-                    para->insert_child(0, temp_ref_run);
-                }
-                serialize_paragraph_to_xml(node, para);
-                first_para = false;
-                if (temp_ref_run) {
-                    para->remove_child(temp_ref_run);
-                }
-            }
-        }
+    // Notes follow the leading separator elements
+    pugi::xml_node anchor;
+    for (auto child = root.child(child_name);
+         child && child.attribute("w:id").as_int() <= 0;
+         child = child.next_sibling(child_name)) {
+        anchor = child;
     }
 
-    doc->mark_modified(xml_part);
+    changed |= sync_items_incremental(
+        root, child_name, anchor, cache, index.synced, serialize_note_to_xml);
+    if (changed) {
+        doc->mark_modified(xml_part);
+    }
 }
 
+template <typename Index>
 static void sync_notes_from_physical_impl(Document* doc,
                                           const char* xml_part,
                                           const char* root_name,
                                           const char* child_name,
                                           std::vector<std::shared_ptr<Footnote>>& cache,
+                                          Index& index,
                                           int& next_id,
                                           FootnoteType type) {
     auto* notes_xml = doc->get_xml_part(xml_part);
@@ -113,6 +135,9 @@ static void sync_notes_from_physical_impl(Document* doc,
     }
 
     cache.clear();
+    index.by_id.clear();
+    index.synced.clear();
+    index.part = notes_xml;
 
     auto root = notes_xml->child(root_name);
     if (!root) {
@@ -167,6 +192,9 @@ static void sync_notes_from_physical_impl(Document* doc,
             }
         }
 
+        note->set_modified(false);
+        index.by_id[note->get_id()] = note;
+        index.synced[note.get()] = {node, formatted_content_signature(*note)};
         cache.push_back(note);
     }
 
@@ -182,8 +210,12 @@ static void sync_notes_from_physical_impl(Document* doc,
 // ============================================================================
 
 void Document::sync_footnotes_to_physical() {
-    sync_notes_to_physical_impl(
-        this, "word/footnotes.xml", "w:footnotes", "w:footnote", footnotes_cache_);
+    sync_notes_to_physical_impl(this,
+                                "word/footnotes.xml",
+                                "w:footnotes",
+                                "w:footnote",
+                                footnotes_cache_,
+                                footnotes_index_);
 }
 
 void Document::sync_footnotes_from_physical() {
@@ -192,6 +224,7 @@ void Document::sync_footnotes_from_physical() {
                                   "w:footnotes",
                                   "w:footnote",
                                   footnotes_cache_,
+                                  footnotes_index_,
                                   next_footnote_id_,
                                   FootnoteType::Footnote);
 }
@@ -202,7 +235,7 @@ void Document::sync_footnotes_from_physical() {
 
 void Document::sync_endnotes_to_physical() {
     sync_notes_to_physical_impl(
-        this, "word/endnotes.xml", "w:endnotes", "w:endnote", endnotes_cache_);
+        this, "word/endnotes.xml", "w:endnotes", "w:endnote", endnotes_cache_, endnotes_index_);
 }
 
 void Document::sync_endnotes_from_physical() {
@@ -211,6 +244,7 @@ void Document::sync_endnotes_from_physical() {
                                   "w:endnotes",
                                   "w:endnote",
                                   endnotes_cache_,
+                                  endnotes_index_,
                                   next_endnote_id_,
                                   FootnoteType::Endnote);
 }
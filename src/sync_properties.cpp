@@ -5,7 +5,12 @@
 
 #include <cdocx/document.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <string>
+#include <vector>
 
 #include "sync_common.h"
 
@@ -56,6 +61,9 @@ void Document::sync_builtin_properties_to_physical() {
 
     // Sync app.xml
     pugi::xml_document* app_doc = get_app_properties();
+    if (app_doc && update_statistics_on_sync_) {
+        update_statistics();
+    }
     if (app_doc) {
         auto root = app_doc->child("Properties");
         if (root) {
@@ -80,6 +88,11 @@ void Document::sync_builtin_properties_to_physical() {
                 set_text_child(
                     root, "Paragraphs", std::to_string(builtin_properties_.total_paragraphs));
             }
+            if (builtin_properties_.total_chars_with_spaces >= 0) {
+                set_text_child(root,
+                               "CharactersWithSpaces",
+                               std::to_string(builtin_properties_.total_chars_with_spaces));
+            }
         }
         mark_modified("docProps/app.xml");
     }
@@ -163,6 +176,9 @@ void Document::sync_builtin_properties_from_physical() {
             if (auto n = root.child("Paragraphs").first_child()) {
                 builtin_properties_.total_paragraphs = safe_atoi(n.value());
             }
+            if (auto n = root.child("CharactersWithSpaces").first_child()) {
+                builtin_properties_.total_chars_with_spaces = safe_atoi(n.value());
+            }
         }
     }
 }
@@ -171,60 +187,156 @@ void Document::sync_builtin_properties_from_physical() {
 // Custom Properties Sync
 // ============================================================================
 
+namespace {
+
+const char* const kCustomPropertiesPart = "docProps/custom.xml";
+const char* const kCustomPropertyFmtid = "{D5CDD505-2E9C-101B-9397-08002B2CF9AE}";
+
+const char* custom_value_element(const CustomProperty::Value& value) {
+    static const char* const kElements[] = {
+        "vt:lpwstr", "vt:i4", "vt:r8", "vt:bool", "vt:filetime", "vt:i8"};
+    return kElements[value.index()];
+}
+
+/// Reads the vt: value element of a property; other types and non-finite numbers stay text
+CustomProperty::Value parse_custom_value(pugi::xml_node value_node) {
+    const std::string type = value_node.name();
+    const pugi::xml_text text = value_node.text();
+    if (type == "vt:i1" || type == "vt:i2" || type == "vt:i4" || type == "vt:int" ||
+        type == "vt:ui1" || type == "vt:ui2") {
+        return text.as_int();
+    }
+    if (type == "vt:i8" || type == "vt:ui4") {
+        return static_cast<std::int64_t>(text.as_llong());
+    }
+    // vt:ui8 above INT64_MAX has no signed value and stays text
+    constexpr auto kInt64Max = static_cast<unsigned long long>(INT64_MAX);
+    if (type == "vt:ui8" && text.as_ullong() <= kInt64Max) {
+        return static_cast<std::int64_t>(text.as_ullong());
+    }
+    if (type == "vt:r4" || type == "vt:r8") {
+        const double number = text.as_double();
+        if (std::isfinite(number)) {
+            return number;
+        }
+    }
+    if (type == "vt:bool") {
+        return text.as_bool();
+    }
+    if (type == "vt:filetime" || type == "vt:date") {
+        return CustomProperty::FileTime{w3cdtf_to_time(text.get())};
+    }
+    return std::string(text.get());
+}
+
+}  // namespace
+
+void Document::write_custom_property(pugi::xml_node root,
+                                     const std::string& name,
+                                     CustomProperty& prop) {
+    pugi::xml_node& node = custom_property_nodes_[name];
+    if (node) {
+        node.attribute("pid").set_value(prop.pid);
+        node.remove_children();
+    } else {
+        node = root.append_child("property");
+        node.append_attribute("fmtid").set_value(kCustomPropertyFmtid);
+        node.append_attribute("pid").set_value(prop.pid);
+        node.append_attribute("name").set_value(name.c_str());
+    }
+    node.append_child(custom_value_element(prop.value)).text().set(prop.to_string().c_str());
+    prop.dirty = false;
+}
+
 void Document::sync_custom_properties_to_physical() {
-    if (custom_properties_.custom_properties.empty()) {
-        // Remove custom.xml if no custom properties
-        if (has_xml_part("docProps/custom.xml")) {
-            remove_xml_part("docProps/custom.xml");
-            // Remove relationship
-            const std::string rel_id = find_relationship_id("_rels/.rels", "docProps/custom.xml");
+    DocumentProperties& props = custom_properties_;
+    pugi::xml_document* custom_doc = get_xml_part(kCustomPropertiesPart);
+    pugi::xml_node root = custom_doc ? custom_doc->child("Properties") : pugi::xml_node();
+
+    if (props.custom_properties_.empty()) {
+        // Remove custom.xml, its relationship and its content type if no custom properties
+        if (root) {
+            custom_doc->reset();
+            remove_xml_part(kCustomPropertiesPart);
+            const std::string rel_id = find_relationship_id("_rels/.rels", kCustomPropertiesPart);
             if (!rel_id.empty()) {
                 remove_relationship("_rels/.rels", rel_id);
             }
+            content_types_.erase(std::remove_if(content_types_.begin(),
+                                                content_types_.end(),
+                                                [](const ContentType& ct) {
+                                                    return !ct.is_default &&
+                                                           ct.part_name == "/docProps/custom.xml";
+                                                }),
+                                 content_types_.end());
+            mark_modified("[Content_Types].xml");
         }
+        custom_property_nodes_.clear();
+        props.dirty_custom_.clear();
+        props.removed_custom_.clear();
         return;
     }
 
-    pugi::xml_document* custom_doc = get_xml_part("docProps/custom.xml");
-    if (!custom_doc) {
-        custom_doc = &create_xml_part("docProps/custom.xml");
+    if (!root) {
+        // First write: create the part and register it once
+        custom_doc = &create_xml_part(kCustomPropertiesPart);
         add_content_type_override(
             "/docProps/custom.xml",
             "application/vnd.openxmlformats-officedocument.custom-properties+xml");
-
-        const std::string rel_id = find_relationship_id("_rels/.rels", "docProps/custom.xml");
-        if (rel_id.empty()) {
+        if (find_relationship_id("_rels/.rels", kCustomPropertiesPart).empty()) {
             add_relationship("_rels/.rels",
                              "http://schemas.openxmlformats.org/officeDocument/2006/relationships/"
                              "custom-properties",
-                             "docProps/custom.xml");
+                             kCustomPropertiesPart);
         }
-    }
 
-    custom_doc->reset();
-    auto root = custom_doc->append_child("Properties");
-    root.append_attribute("xmlns").set_value(
-        "http://schemas.openxmlformats.org/officeDocument/2006/custom-properties");
-    root.append_attribute("xmlns:vt")
-        .set_value("http://schemas.openxmlformats.org/officeDocument/2006/docPropsVTypes");
-
-    int pid = 2;
-    for (const auto& kv : custom_properties_.custom_properties) {
-        auto prop = root.append_child("property");
-        prop.append_attribute("fmtid").set_value("{D5CDD505-2E9C-101B-9397-08002B2CF9AE}");
-        prop.append_attribute("pid").set_value(pid++);
-        prop.append_attribute("name").set_value(kv.first.c_str());
-        auto val = prop.append_child("vt:lpwstr");
-        val.append_child(pugi::node_pcdata).set_value(kv.second.c_str());
+        custom_doc->reset();
+        root = custom_doc->append_child("Properties");
+        root.append_attribute("xmlns").set_value(
+            "http://schemas.openxmlformats.org/officeDocument/2006/custom-properties");
+        root.append_attribute("xmlns:vt")
+            .set_value("http://schemas.openxmlformats.org/officeDocument/2006/docPropsVTypes");
+        custom_property_nodes_.clear();
+        props.dirty_custom_.clear();
+        props.removed_custom_.clear();
+        for (auto& [name, prop] : props.custom_properties_) {
+            write_custom_property(root, name, prop);
+        }
+        mark_modified(kCustomPropertiesPart);
+        return;
     }
 
-    mark_modified("docProps/custom.xml");
+    // Only the properties set or removed since the last write are touched
+    if (props.dirty_custom_.empty() && props.removed_custom_.empty()) {
+        return;
+    }
+    for (const auto& name : props.removed_custom_) {
+        auto it = custom_property_nodes_.find(name);
+        if (it != custom_property_nodes_.end()) {
+            root.remove_child(it->second);
+            custom_property_nodes_.erase(it);
+        }
+    }
+    for (const auto& name : props.dirty_custom_) {
+        auto it = props.custom_properties_.find(name);
+        if (it != props.custom_properties_.end() && it->second.dirty) {
+            write_custom_property(root, name, it->second);
+        }
+    }
+    props.dirty_custom_.clear();
+    props.removed_custom_.clear();
+    mark_modified(kCustomPropertiesPart);
 }
 
 void Document::sync_custom_properties_from_physical() {
-    custom_properties_.custom_properties.clear();
+    DocumentProperties& props = custom_properties_;
+    props.custom_properties_.clear();
+    props.dirty_custom_.clear();
+    props.removed_custom_.clear();
+    props.next_custom_pid_ = 2;
+    custom_property_nodes_.clear();
 
-    pugi::xml_document* custom_doc = get_xml_part("docProps/custom.xml");
+    pugi::xml_document* custom_doc = get_xml_part(kCustomPropertiesPart);
     if (!custom_doc) {
         return;
     }
@@ -234,22 +346,32 @@ void Document::sync_custom_properties_from_physical() {
         return;
     }
 
+    std::vector<std::string> renumbered;
     for (auto prop = root.child("property"); prop; prop = prop.next_sibling("property")) {
         const pugi::xml_attribute name_attr = prop.attribute("name");
         if (!name_attr) {
             continue;
         }
 
-        std::string value;
-        if (auto lpwstr = prop.child("vt:lpwstr").first_child()) {
-            value = lpwstr.value();
-        } else if (auto text = prop.first_child().first_child()) {
-            value = text.value();
+        CustomProperty& entry = props.custom_properties_[name_attr.value()];
+        entry.value = parse_custom_value(prop.first_child());
+        entry.pid = prop.attribute("pid").as_int();
+        entry.dirty = false;
+        custom_property_nodes_[name_attr.value()] = prop;
+        if (entry.pid < 2) {
+            renumbered.emplace_back(name_attr.value());
+        } else {
+            props.next_custom_pid_ = std::max(props.next_custom_pid_, entry.pid + 1);
         }
+    }
 
-        custom_properties_.custom_properties[name_attr.value()] = value;
+    // Properties without a valid pid get one on the next write
+    for (const auto& name : renumbered) {
+        CustomProperty& entry = props.custom_properties_[name];
+        entry.pid = props.next_custom_pid_++;
+        entry.dirty = true;
+        props.dirty_custom_.push_back(name);
     }
 }
 
-
 }  // namespace cdocx
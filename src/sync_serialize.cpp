@@ -12,14 +12,18 @@
 #include <cdocx/section.h>
 #include <cdocx/table.h>
 
-#include <cctype>
 #include <cstring>
+#include <string>
+#include <unordered_set>
 
+#include "run_text.h"
 #include "sync_common.h"
 
 namespace cdocx {
 
-static void serialize_section_to_xml(pugi::xml_node body_xml, const Section* section);
+static void serialize_section_to_xml(pugi::xml_node body_xml,
+                                     const Section* section,
+                                     std::unordered_set<std::string>& written_parts);
 static void serialize_table_to_xml(pugi::xml_node parent, const Table* table);
 
 // ============================================================================
@@ -160,28 +164,26 @@ void Document::sync_sections_to_physical() {
         }
     }
 
-    // Update DOM paragraphs whose XML was explicitly modified by DocumentBuilder
-    // or legacy API, so their content is not lost during DOM serialization.
+    // Update DOM paragraphs whose XML was explicitly modified by DocumentBuilder,
+    // Range or legacy API, so their content is not lost during DOM serialization.
     for (auto& section : sections) {
         if (auto sect_body = section->get_body()) {
             for (const auto& child : sect_body->get_children()) {
                 if (child->node_type() == NodeType::Paragraph) {
                     auto* para = dynamic_cast<Paragraph*>(child.get());
-                    if (para && para->get_current() &&
-                        dirty_xml_paragraphs_.count(para->get_current()) > 0) {
-                        for (auto xml_para = body.child("w:p"); xml_para;
-                             xml_para = xml_para.next_sibling("w:p")) {
-                            if (xml_para == para->get_current()) {
-                                if (auto updated = parse_paragraph_from_xml(xml_para)) {
-                                    para->remove_all_children();
-                                    for (const auto& new_child : updated->get_children()) {
-                                        para->append_child(new_child);
-                                    }
-                                }
-                                para->set_current(pugi::xml_node());
-                                break;
+                    const pugi::xml_node xml_para = para ? para->get_current() : pugi::xml_node();
+                    if (xml_para && xml_para.parent() == body &&
+                        dirty_xml_paragraphs_.count(xml_para) > 0) {
+                        if (auto updated = parse_paragraph_from_xml(xml_para)) {
+                            para->get_paragraph_format() = updated->get_paragraph_format();
+                            para->get_list_format() = updated->get_list_format();
+                            para->preserve_p_pr(updated->get_preserved_p_pr());
+                            para->remove_all_children();
+                            for (const auto& new_child : updated->get_children()) {
+                                para->append_child(new_child);
                             }
                         }
+                        para->set_current(pugi::xml_node());
                     }
                 }
             }
@@ -218,9 +220,10 @@ void Document::sync_sections_to_physical() {
         body.remove_child(body.first_child());
     }
 
-    // Serialize each section
+    // Serialize each section; a header part shared by linked sections is written once
+    std::unordered_set<std::string> written_parts;
     for (auto& section : sections) {
-        serialize_section_to_xml(body, section.get());
+        serialize_section_to_xml(body, section.get(), written_parts);
     }
 
     // Re-append preserved unknown nodes at the end
@@ -355,21 +358,25 @@ static void serialize_run_to_xml(pugi::xml_node parent, const Run* run) {
         return;
     }
 
+    // Tracked changes wrap the run in w:ins / w:del; deleted text uses w:delText
+    const bool deleted = run->get_revision_type() == RevisionType::Deletion;
+    if (run->is_revision()) {
+        parent = parent.append_child(deleted ? "w:del" : "w:ins");
+        parent.append_attribute("w:id").set_value(run->get_revision_id());
+        parent.append_attribute("w:author").set_value(run->get_revision_author().c_str());
+        if (!run->get_revision_date().empty()) {
+            parent.append_attribute("w:date").set_value(run->get_revision_date().c_str());
+        }
+    }
+
     auto run_xml = parent.append_child("w:r");
     serialize_run_formatting_to_xml(
         run_xml,
         run->get_font(),
         run->has_preserved_r_pr() ? run->get_preserved_r_pr() : pugi::xml_node());
 
-    const std::string& text = run->get_text();
-    if (!text.empty()) {
-        auto text_node = run_xml.append_child("w:t");
-        if (std::isspace(static_cast<unsigned char>(text.front())) ||
-            std::isspace(static_cast<unsigned char>(text.back()))) {
-            text_node.append_attribute("xml:space").set_value("preserve");
-        }
-        text_node.text().set(text.c_str());
-    }
+    // Tabs and breaks in the text become w:tab / w:br; other control bytes are dropped
+    append_run_text(run_xml, run->get_text(), deleted ? "w:delText" : "w:t");
 
     // Serialize preserved children (e.g., w:drawing) for round-trip fidelity
     if (run->has_preserved_children()) {
@@ -396,6 +403,11 @@ static void serialize_field_to_xml(pugi::xml_node parent, Field* field) {
     auto sep_run = parent.append_child("w:r");
     sep_run.append_child("w:fldChar").append_attribute("w:fldCharType").set_value("separate");
 
+    // The result and the end follow in later paragraphs
+    if (field->spans_paragraphs()) {
+        return;
+    }
+
     const std::string result = field->get_result();
     if (!result.empty()) {
         auto resultrun = parent.append_child("w:r");
@@ -446,11 +458,7 @@ static void serialize_hyperlink_to_xml(pugi::xml_node parent, Hyperlink* link) {
         link->get_font(),
         link->has_preserved_r_pr() ? link->get_preserved_r_pr() : pugi::xml_node());
 
-    const std::string result = link->get_result();
-    if (!result.empty()) {
-        auto text_node = run_xml.append_child("w:t");
-        text_node.text().set(result.c_str());
-    }
+    append_run_text(run_xml, link->get_result());
 }
 
 struct SpecialCharMapping {
@@ -471,6 +479,11 @@ static void serialize_special_char_to_xml(pugi::xml_node parent, SpecialChar* sc
         return;
     }
     const char16_t code = sc->get_char();
+    if (code == 0x0015) {
+        auto end_run = parent.append_child("w:r");
+        end_run.append_child("w:fldChar").append_attribute("w:fldCharType").set_value("end");
+        return;
+    }
     for (const auto& mapping : kSpecialCharMappings) {
         if (mapping.code == code) {
             auto node = parent.append_child(mapping.element_name);
@@ -683,6 +696,10 @@ void serialize_paragraph_to_xml(pugi::xml_node parent, const Paragraph* para) {
         }
     }
 
+    // Anchors of comments that no longer exist would make Word repair the file
+    const Document* doc = para->get_document();
+    auto is_orphan_comment = [doc](int id) { return doc && !doc->get_comment(id); };
+
     std::vector<int> comment_ids_for_reference;
     for (const auto& child : para->get_children()) {
         switch (child->node_type()) {
@@ -699,17 +716,21 @@ void serialize_paragraph_to_xml(pugi::xml_node parent, const Paragraph* para) {
             case NodeType::BookmarkEnd:
                 serialize_bookmark_end_to_xml(para_xml, dynamic_cast<BookmarkEnd*>(child.get()));
                 break;
-            case NodeType::CommentRangeStart:
-                serialize_comment_range_start_to_xml(para_xml,
-                                                     dynamic_cast<CommentRangeStart*>(child.get()));
+            case NodeType::CommentRangeStart: {
+                auto* crs = dynamic_cast<CommentRangeStart*>(child.get());
+                if (!is_orphan_comment(crs->get_id())) {
+                    serialize_comment_range_start_to_xml(para_xml, crs);
+                }
                 break;
-            case NodeType::CommentRangeEnd:
-                serialize_comment_range_end_to_xml(para_xml,
-                                                   dynamic_cast<CommentRangeEnd*>(child.get()));
-                if (auto* cre = dynamic_cast<CommentRangeEnd*>(child.get())) {
+            }
+            case NodeType::CommentRangeEnd: {
+                auto* cre = dynamic_cast<CommentRangeEnd*>(child.get());
+                if (!is_orphan_comment(cre->get_id())) {
+                    serialize_comment_range_end_to_xml(para_xml, cre);
                     comment_ids_for_reference.push_back(cre->get_id());
                 }
                 break;
+            }
             case NodeType::FieldStart:
                 serialize_field_to_xml(para_xml, dynamic_cast<Field*>(child.get()));
                 break;
@@ -957,7 +978,9 @@ static void serialize_header_footer_to_xml(HeaderFooter* hf, Document* doc) {
     doc->mark_modified(hf->get_part_path());
 }
 
-static void serialize_section_to_xml(pugi::xml_node body_xml, const Section* section) {
+static void serialize_section_to_xml(pugi::xml_node body_xml,
+                                     const Section* section,
+                                     std::unordered_set<std::string>& written_parts) {
     if (!section) {
         return;
     }
@@ -983,12 +1006,17 @@ static void serialize_section_to_xml(pugi::xml_node body_xml, const Section* sec
         footer_ref.append_attribute("w:type").set_value(header_footer_type_to_string(ref.type));
     }
 
-    // Serialize header/footer content
+    // Serialize header/footer content. A section linked to the previous one holds its own
+    // object for the shared part; the part is written from the first section's object.
     for (auto& header : section->get_all_headers()) {
-        serialize_header_footer_to_xml(header.get(), section->get_document());
+        if (written_parts.insert(header->get_part_path()).second) {
+            serialize_header_footer_to_xml(header.get(), section->get_document());
+        }
     }
     for (auto& footer : section->get_all_footers()) {
-        serialize_header_footer_to_xml(footer.get(), section->get_document());
+        if (written_parts.insert(footer->get_part_path()).second) {
+            serialize_header_footer_to_xml(footer.get(), section->get_document());
+        }
     }
 }
 
@@ -44,7 +44,15 @@ void Template::set(const std::string& key, const std::string& value) {
 }
 
 void Template::set(const std::string& key, const char* value) {
-    placeholders_[key] = std::string(value);
+    placeholders_[key].assign(value);
+}
+
+void Template::set(const std::string& key, std::string&& value) {
+    placeholders_[key] = std::move(value);
+}
+
+void Template::set(const std::string& key, std::string_view value) {
+    placeholders_[key].assign(value);
 }
 
 void Template::set_image(const std::string& key, const std::string& image_path) {
@@ -16,6 +16,7 @@
 #include <memory>
 #include <unordered_set>
 
+#include "run_text.h"
 #include "sync_common.h"
 
 namespace {
@@ -79,26 +80,53 @@ TemplateFormat& TemplateFormat::font(const std::string& name) {
     return *this;
 }
 
+TemplateFormat& TemplateFormat::font(std::string&& name) {
+    font_ascii_ = name;
+    font_far_east_ = name;
+    font_ = std::move(name);
+    return *this;
+}
+
 TemplateFormat& TemplateFormat::font_ascii(const std::string& name) {
     font_ascii_ = name;
     return *this;
 }
 
+TemplateFormat& TemplateFormat::font_ascii(std::string&& name) {
+    font_ascii_ = std::move(name);
+    return *this;
+}
+
 TemplateFormat& TemplateFormat::font_far_east(const std::string& name) {
     font_far_east_ = name;
     return *this;
 }
 
+TemplateFormat& TemplateFormat::font_far_east(std::string&& name) {
+    font_far_east_ = std::move(name);
+    return *this;
+}
+
 TemplateFormat& TemplateFormat::color(const std::string& hex) {
     color_ = hex;
     return *this;
 }
 
+TemplateFormat& TemplateFormat::color(std::string&& hex) {
+    color_ = std::move(hex);
+    return *this;
+}
+
 TemplateFormat& TemplateFormat::alignment(const std::string& align) {
     alignment_ = align;
     return *this;
 }
 
+TemplateFormat& TemplateFormat::alignment(std::string&& align) {
+    alignment_ = std::move(align);
+    return *this;
+}
+
 TemplateFormat& TemplateFormat::line_spacing(int twips) {
     line_spacing_ = twips;
     return *this;
@@ -176,10 +204,18 @@ TemplateValue TemplateValue::text(const std::string& content) {
     return TemplateValue(TextData{content, TemplateFormat()});
 }
 
+TemplateValue TemplateValue::text(std::string&& content) {
+    return TemplateValue(TextData{std::move(content), TemplateFormat()});
+}
+
 TemplateValue TemplateValue::text(const std::string& content, const TemplateFormat& format) {
     return TemplateValue(TextData{content, format});
 }
 
+TemplateValue TemplateValue::text(std::string&& content, const TemplateFormat& format) {
+    return TemplateValue(TextData{std::move(content), format});
+}
+
 TemplateValue TemplateValue::image(const std::string& path) {
     return TemplateValue(ImageData{path, ImageSize(), "", ImageAlignment::Center});
 }
@@ -244,6 +280,16 @@ TemplateValue& TemplateValue::with_alignment(ImageAlignment align) {
     return *this;
 }
 
+void TemplateValue::assign_text(std::string_view content) {
+    if (auto* text = std::get_if<TextData>(&data_)) {
+        text->content.assign(content.data(), content.size());
+        text->format = TemplateFormat();
+    } else {
+        data_ = TextData{std::string(content), TemplateFormat()};
+        type_ = TemplateValueType::Text;
+    }
+}
+
 const std::string& TemplateValue::text_content() const {
     return std::get<TextData>(data_).content;
 }
@@ -291,6 +337,11 @@ TemplateEngine::Setter& TemplateEngine::Setter::operator=(const std::string& tex
     return *this;
 }
 
+TemplateEngine::Setter& TemplateEngine::Setter::operator=(std::string&& text) {
+    engine_->set(key_, std::move(text));
+    return *this;
+}
+
 TemplateEngine::Setter& TemplateEngine::Setter::operator=(const char* text) {
     engine_->set(key_, text);
     return *this;
@@ -322,6 +373,16 @@ TemplateEngine& TemplateEngine::set(const std::string& key, const std::string& t
     return *this;
 }
 
+TemplateEngine& TemplateEngine::set(const std::string& key, std::string&& text) {
+    queue_[key] = TemplateValue::text(std::move(text));
+    return *this;
+}
+
+TemplateEngine& TemplateEngine::set(const std::string& key, std::string_view text) {
+    queue_[key] = TemplateValue::text(std::string(text));
+    return *this;
+}
+
 TemplateEngine& TemplateEngine::set(const std::string& key, const char* text) {
     queue_[key] = TemplateValue::text(text ? std::string(text) : std::string());
     return *this;
@@ -341,6 +402,23 @@ TemplateEngine& TemplateEngine::set_batch(const std::map<std::string, std::strin
     return *this;
 }
 
+TemplateEngine& TemplateEngine::set_batch(const RecordSource& source) {
+    // Schema-less sources may add columns while reading, so rebind on any change
+    const auto& columns = source.get_columns();
+    if (bound_columns_ != columns) {
+        bound_columns_ = columns;
+        bound_values_.clear();
+        bound_values_.reserve(columns.size());
+        for (const auto& column : columns) {
+            bound_values_.push_back(&queue_[column]);
+        }
+    }
+    for (std::size_t column = 0; column < bound_values_.size(); ++column) {
+        bound_values_[column]->assign_text(source.get_field(column));
+    }
+    return *this;
+}
+
 TemplateEngine& TemplateEngine::with_action(TemplateAction action) {
     default_action_ = action;
     return *this;
@@ -373,17 +451,27 @@ TemplateEngine& TemplateEngine::with_delimiters(const std::string& prefix,
     return *this;
 }
 
+TemplateEngine& TemplateEngine::with_cancellation(const CancellationToken& token) {
+    cancellation_token_ = token;
+    return *this;
+}
+
 bool TemplateEngine::has(const std::string& key) const {
     return queue_.find(key) != queue_.end();
 }
 
 TemplateEngine& TemplateEngine::remove(const std::string& key) {
-    queue_.erase(key);
+    if (queue_.erase(key) > 0) {
+        bound_columns_.clear();
+        bound_values_.clear();
+    }
     return *this;
 }
 
 TemplateEngine& TemplateEngine::clear() {
     queue_.clear();
+    bound_columns_.clear();
+    bound_values_.clear();
     return *this;
 }
 
@@ -500,7 +588,7 @@ static bool insert_formatted_run_after(pugi::xml_node para,
         }
     }
 
-    run.append_child("w:t").text().set(text.c_str());
+    append_run_text(run, text);
     return true;
 }
 
@@ -543,6 +631,11 @@ TemplateEngine::Result TemplateEngine::apply(const std::string& key) {
         last_result_.skipped++;
         return last_result_;
     }
+    if (cancellation_token_.is_cancelled()) {
+        last_result_.skipped++;
+        last_result_.cancelled = true;
+        return last_result_;
+    }
 
     auto actual = resolve_target(doc_, key, default_target_, delimiter_prefix_, delimiter_suffix_);
     if (actual == TemplateTarget::Placeholder) {
@@ -567,8 +660,9 @@ TemplateEngine::Result TemplateEngine::apply_if(
         bm_cache = std::make_unique<BookmarkNameCache>(doc_);
     }
 
-    std::vector<std::pair<std::string, TemplateValue>> placeholders;
-    std::vector<std::pair<std::string, TemplateValue>> bookmarks;
+    // Entries point into queue_, which apply_if() does not modify
+    std::vector<std::pair<const std::string*, const TemplateValue*>> placeholders;
+    std::vector<std::pair<const std::string*, const TemplateValue*>> bookmarks;
 
     for (const auto& [key, value] : queue_) {
         if (!predicate(key)) {
@@ -581,22 +675,36 @@ TemplateEngine::Result TemplateEngine::apply_if(
         }
         auto actual = resolve_target(bm_cache.get(), key, default_target_);
         if (actual == TemplateTarget::Placeholder) {
-            placeholders.emplace_back(key, value);
+            placeholders.emplace_back(&key, &value);
         } else {
-            bookmarks.emplace_back(key, value);
+            bookmarks.emplace_back(&key, &value);
         }
     }
 
+    // Polled before every key; the keys not applied yet count as skipped
+    size_t pending = placeholders.size() + bookmarks.size();
+    auto cancelled = [this, &pending]() {
+        if (!last_result_.cancelled && cancellation_token_.is_cancelled()) {
+            last_result_.cancelled = true;
+            last_result_.skipped += static_cast<int>(pending);
+        }
+        return last_result_.cancelled;
+    };
+
     if (!placeholders.empty()) {
         for (const auto& [key, value] : placeholders) {
-            auto r = apply_placeholder(key, value);
+            if (cancelled()) {
+                break;
+            }
+            --pending;
+            auto r = apply_placeholder(*key, *value);
             last_result_.success += r.success;
             last_result_.failed += r.failed;
         }
         doc_->sync_to_physical_tree();
     }
 
-    if (!bookmarks.empty()) {
+    if (!bookmarks.empty() && !cancelled()) {
         if (placeholders.empty()) {
             doc_->sync_to_physical_tree();
         }
@@ -604,28 +712,32 @@ TemplateEngine::Result TemplateEngine::apply_if(
         std::unordered_set<std::string> failed_bookmark_keys;
 
         for (const auto& [key, value] : bookmarks) {
-            auto bm_opt = collection.get(key);
+            if (cancelled()) {
+                break;
+            }
+            --pending;
+            auto bm_opt = collection.get(*key);
             if (!bm_opt) {
                 last_result_.failed++;
-                failed_bookmark_keys.insert(key);
+                failed_bookmark_keys.insert(*key);
                 continue;
             }
-            if (value.is_text()) {
+            if (value->is_text()) {
                 const bool ok = apply_text_to_bookmark(
-                    *bm_opt, value.text_content(), value.text_format(), default_format_policy_);
+                    *bm_opt, value->text_content(), value->text_format(), default_format_policy_);
                 if (ok) {
                     last_result_.success++;
                 } else {
                     last_result_.failed++;
-                    failed_bookmark_keys.insert(key);
+                    failed_bookmark_keys.insert(*key);
                 }
-            } else if (value.is_image()) {
-                const bool ok = apply_image_to_bookmark(*bm_opt, value);
+            } else if (value->is_image()) {
+                const bool ok = apply_image_to_bookmark(*bm_opt, *value);
                 if (ok) {
                     last_result_.success++;
                 } else {
                     last_result_.failed++;
-                    failed_bookmark_keys.insert(key);
+                    failed_bookmark_keys.insert(*key);
                 }
             }
         }
@@ -636,8 +748,8 @@ TemplateEngine::Result TemplateEngine::apply_if(
         // keys whose bookmark was not found or whose bookmark replacement failed.
         if (default_target_ == TemplateTarget::Auto && !failed_bookmark_keys.empty()) {
             for (const auto& [key, value] : bookmarks) {
-                if (failed_bookmark_keys.count(key)) {
-                    auto r = apply_placeholder(key, value);
+                if (failed_bookmark_keys.count(*key) && !cancellation_token_.is_cancelled()) {
+                    auto r = apply_placeholder(*key, *value);
                     last_result_.success += r.success;
                     last_result_.failed += r.failed;
                 }
@@ -0,0 +1,28 @@
+/**
+ * @file text_offset_index.h
+ * @brief Internal index from body text offsets to paragraphs
+ * @internal Not part of the public API.
+ * @details The body text is the run text of the top-level paragraphs back to
+ *          back, as returned by Document::get_range().get_text(). The index
+ *          keeps the character offset each paragraph starts at, so an offset
+ *          resolves to a paragraph with a binary search. It is built on the
+ *          first Range::from_offsets() call and dropped whenever
+ *          word/document.xml is marked as modified or one of its paragraphs
+ *          is edited.
+ */
+
+#pragma once
+
+#include <cdocx/document.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace cdocx {
+
+struct Document::TextOffsetIndex {
+    std::vector<pugi::xml_node> paragraphs;  ///< w:p children of w:body in order
+    std::vector<size_t> starts;              ///< Character offset of each paragraph, then the total
+};
+
+}  // namespace cdocx
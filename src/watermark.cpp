@@ -12,199 +12,93 @@
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <unordered_set>
 #include <vector>
 
 namespace cdocx {
 
 // ============================================================================
 // Helper Functions
+// ============================================================================
 
 static bool is_word_watermark_shape(const pugi::xml_node shape) {
     const pugi::xml_attribute id_attr = shape.attribute("id");
     return id_attr && std::strcmp(id_attr.value(), "PowerPlusWaterMarkObject") == 0;
 }
-// ============================================================================
 
-struct XmlEscapeMapping {
-    char c;
-    const char* replacement;
-};
-
-static const XmlEscapeMapping kXmlEscapeMappings[] = {
-    {'&', "&amp;"},
-    {'<', "&lt;"},
-    {'>', "&gt;"},
-    {'"', "&quot;"},
-    {'\'', "&apos;"},
-};
-
-static std::string escape_xml(const std::string& text) {
-    std::string result;
-    result.reserve(text.size());
-    for (const char c : text) {
-        bool found = false;
-        for (const auto& mapping : kXmlEscapeMappings) {
-            if (mapping.c == c) {
-                result += mapping.replacement;
-                found = true;
-                break;
+/// True for a w:pict or w:drawing run element that holds a watermark
+static bool is_watermark_element(const pugi::xml_node node) {
+    if (std::strcmp(node.name(), "w:pict") == 0) {
+        for (const pugi::xml_node shape : node.children("v:shape")) {
+            if (is_word_watermark_shape(shape)) {
+                return true;
             }
         }
-        if (!found) {
-            result += c;
-        }
-    }
-    return result;
-}
-
-static pugi::xml_node get_first_header_xml(Document* doc) {
-    auto names = doc->get_header_names();
-    if (names.empty()) {
-        return pugi::xml_node{};
+        return false;
     }
-    pugi::xml_document* header_doc = doc->get_header(0);
-    if (!header_doc) {
-        return pugi::xml_node{};
+    if (std::strcmp(node.name(), "w:drawing") == 0) {
+        const pugi::xml_node graphic_data =
+            node.child("wp:anchor").child("a:graphic").child("a:graphicData");
+        return std::strstr(graphic_data.attribute("uri").value(), "watermark") != nullptr;
     }
-    return header_doc->child("w:hdr");
+    return false;
 }
 
-static void remove_watermark_nodes(pugi::xml_node header) {
-    if (!header) {
-        return;
-    }
-    for (pugi::xml_node para = header.child("w:p"); para;) {
-        bool is_watermark = false;
-        for (pugi::xml_node run = para.child("w:r"); run; run = run.next_sibling("w:r")) {
-            for (pugi::xml_node pict = run.child("w:pict"); pict;
-                 pict = pict.next_sibling("w:pict")) {
-                const pugi::xml_node shape = pict.child("v:shape");
-                if (shape) {
-                    if (is_word_watermark_shape(shape)) {
-                        is_watermark = true;
-                        break;
-                    }
-                }
-            }
-            if (is_watermark) {
-                break;
-            }
-            for (pugi::xml_node drawing = run.child("w:drawing"); drawing;
-                 drawing = drawing.next_sibling("w:drawing")) {
-                const pugi::xml_node doc_pr =
-                    drawing.child("wp:anchor").child("a:graphic").child("a:graphicData");
-                if (doc_pr) {
-                    const pugi::xml_attribute name_attr = doc_pr.attribute("uri");
-                    if (name_attr && std::strstr(name_attr.value(), "watermark") != nullptr) {
-                        is_watermark = true;
-                        break;
-                    }
-                }
+static bool is_watermark_paragraph(const Paragraph& para) {
+    for (const auto& run : para.get_runs()) {
+        for (const pugi::xml_node child : run->get_preserved_children().children()) {
+            if (is_watermark_element(child)) {
+                return true;
             }
-            if (is_watermark) {
-                break;
-            }
-        }
-        const pugi::xml_node next_para = para.next_sibling("w:p");
-        if (is_watermark) {
-            header.remove_child(para);
         }
-        para = next_para;
     }
+    return false;
 }
 
-// ============================================================================
-// Watermark Implementation
-// ============================================================================
-
-Watermark::Watermark(Document* doc) : document_(doc) {
-}
-
-void Watermark::set_text(const std::string& text) {
-    const TextWatermarkOptions options;
-    set_text(text, options);
-}
-
-void Watermark::set_text(const std::string& text, const TextWatermarkOptions& options) {
-    if (!document_) {
-        return;
+static void remove_watermark_paragraphs(HeaderFooter& header) {
+    for (const auto& para : header.get_paragraphs()) {
+        if (is_watermark_paragraph(*para)) {
+            para->remove();
+        }
     }
-    remove();
-    ensure_header_for_watermark();
-    insert_text_watermark_into_header(text, options);
 }
 
-void Watermark::set_image(const std::string& image_path) {
-    const ImageWatermarkOptions options;
-    set_image(image_path, options);
-}
-
-void Watermark::set_image(const std::string& image_path, const ImageWatermarkOptions& options) {
-    if (!document_) {
+/// Declares the VML namespaces the watermark shapes use on the header part's root
+static void ensure_vml_namespaces(Document* doc, const std::string& part_path) {
+    pugi::xml_document* part = doc->get_xml_part(part_path);
+    if (!part) {
         return;
     }
-    remove();
-    ensure_header_for_watermark();
-    insert_image_watermark_into_header(image_path, options);
-}
-
-void Watermark::remove() {
-    if (!document_) {
+    pugi::xml_node root = part->child("w:hdr");
+    if (!root) {
         return;
     }
-    const pugi::xml_node header = get_first_header_xml(document_);
-    if (header) {
-        remove_watermark_nodes(header);
-    }
-}
-
-bool Watermark::has_watermark() const {
-    if (!document_) {
-        return false;
-    }
-    const pugi::xml_node header = get_first_header_xml(document_);
-    if (!header) {
-        return false;
-    }
-    for (pugi::xml_node para = header.child("w:p"); para; para = para.next_sibling("w:p")) {
-        for (pugi::xml_node run = para.child("w:r"); run; run = run.next_sibling("w:r")) {
-            for (pugi::xml_node pict = run.child("w:pict"); pict;
-                 pict = pict.next_sibling("w:pict")) {
-                const pugi::xml_node shape = pict.child("v:shape");
-                if (shape) {
-                    if (is_word_watermark_shape(shape)) {
-                        return true;
-                    }
-                }
-            }
+    static const std::pair<const char*, const char*> kNamespaces[] = {
+        {"xmlns:v", "urn:schemas-microsoft-com:vml"},
+        {"xmlns:o", "urn:schemas-microsoft-com:office:office"},
+        {"xmlns:w10", "urn:schemas-microsoft-com:office:word"},
+    };
+    for (const auto& ns : kNamespaces) {
+        if (!root.attribute(ns.first)) {
+            root.append_attribute(ns.first).set_value(ns.second);
         }
     }
-    return false;
 }
 
-void Watermark::ensure_header_for_watermark() {
-    auto sect = document_->get_first_section();
-    if (!sect) {
-        return;
-    }
-    if (!sect->has_header(HeaderFooterType::Default)) {
-        sect->add_header(HeaderFooterType::Default);
-    }
+/// Appends a header paragraph whose run holds a copy of the watermark @p pict
+static std::shared_ptr<Paragraph> append_watermark_paragraph(HeaderFooter& header,
+                                                             const pugi::xml_node pict) {
+    ensure_vml_namespaces(header.get_document(), header.get_part_path());
+    auto para = header.append_paragraph();
+    para->append_run()->preserve_child(pict);
+    return para;
 }
 
-void Watermark::insert_text_watermark_into_header(const std::string& text,
-                                                  const TextWatermarkOptions& options) {
-    pugi::xml_node header = get_first_header_xml(document_);
-    if (!header) {
-        return;
-    }
-
-    auto para = header.append_child("w:p");
-    auto p_pr = para.append_child("w:pPr");
-    p_pr.append_child("w:pStyle").append_attribute("w:val").set_value("Header");
-
-    auto run = para.append_child("w:r");
-    auto pict = run.append_child("w:pict");
+/// Appends the VML shape of a text watermark to @p parent
+static pugi::xml_node append_text_watermark_pict(pugi::xml_node parent,
+                                                 const std::string& text,
+                                                 const TextWatermarkOptions& options) {
+    auto pict = parent.append_child("w:pict");
 
     // VML namespace
     auto shapetype = pict.append_child("v:shapetype");
@@ -276,16 +170,169 @@ void Watermark::insert_text_watermark_into_header(const std::string& text,
 
     auto tp = shape.append_child("v:textpath");
     tp.append_attribute("style").set_value(font_style.c_str());
-    tp.append_attribute("string").set_value(escape_xml(text).c_str());
+    tp.append_attribute("string").set_value(text.c_str());
 
     auto wrap = shape.append_child("w10:wrap");
     wrap.append_attribute("anchorx").set_value("margin");
     wrap.append_attribute("anchory").set_value("margin");
+    return pict;
+}
+
+/// Appends the VML shape of an image watermark showing relationship @p rel_id to @p parent
+static pugi::xml_node append_image_watermark_pict(pugi::xml_node parent,
+                                                  const std::string& rel_id,
+                                                  const ImageWatermarkOptions& options) {
+    auto pict = parent.append_child("w:pict");
+    auto shape = pict.append_child("v:shape");
+    shape.append_attribute("id").set_value("PowerPlusWaterMarkObject");
+    shape.append_attribute("style").set_value(
+        "position:absolute;margin-left:0;margin-top:0;width:400pt;height:300pt;z-index:-251658752;"
+        "mso-position-horizontal:center;mso-position-horizontal-relative:margin;mso-position-"
+        "vertical:center;mso-position-vertical-relative:margin");
+    shape.append_attribute("o:allowincell").set_value("f");
+    shape.append_attribute("stroked").set_value("f");
+
+    // Apply scale if explicitly set (> 0)
+    if (options.scale > 0) {
+        const int width_pt = static_cast<int>(400.0 * options.scale / 100.0);
+        const int height_pt = static_cast<int>(300.0 * options.scale / 100.0);
+        const std::string style =
+            "position:absolute;margin-left:0;margin-top:0;width:" + std::to_string(width_pt) +
+            "pt;height:" + std::to_string(height_pt) +
+            "pt;z-index:-251658752;"
+            "mso-position-horizontal:center;mso-position-horizontal-relative:margin;"
+            "mso-position-vertical:center;mso-position-vertical-relative:margin";
+        shape.attribute("style").set_value(style.c_str());
+    }
+
+    // Apply washout effect (grayscale + reduced contrast)
+    if (options.washout) {
+        auto fill = shape.append_child("v:fill");
+        fill.append_attribute("type").set_value("frame");
+        fill.append_attribute("opacity").set_value("0.5");
+        auto image = shape.append_child("v:image");
+        image.append_attribute("o:title").set_value("Watermark");
+        image.append_attribute("cropleft").set_value("f");
+    }
+
+    auto imagedata = shape.append_child("v:imagedata");
+    imagedata.append_attribute("r:id").set_value(rel_id.c_str());
+    imagedata.append_attribute("o:title").set_value("Watermark");
+    return pict;
+}
+
+// ============================================================================
+// Watermark Implementation
+// ============================================================================
+
+Watermark::Watermark(Document* doc) : document_(doc) {
+}
+
+void Watermark::set_text(const std::string& text) {
+    const TextWatermarkOptions options;
+    set_text(text, options);
+}
+
+void Watermark::set_text(const std::string& text, const TextWatermarkOptions& options) {
+    if (!document_) {
+        return;
+    }
+    remove();
+    insert_text_watermark_into_header(text, options);
+}
+
+void Watermark::set_image(const std::string& image_path) {
+    const ImageWatermarkOptions options;
+    set_image(image_path, options);
+}
+
+void Watermark::set_image(const std::string& image_path, const ImageWatermarkOptions& options) {
+    if (!document_) {
+        return;
+    }
+    remove();
+    insert_image_watermark_into_header(image_path, options);
+}
+
+int Watermark::apply_to_all_sections(const std::string& text,
+                                     const TextWatermarkOptions& options) {
+    if (!document_) {
+        return 0;
+    }
+    remove();
+    if (!ensure_header_for_watermark()) {
+        return 0;
+    }
+
+    pugi::xml_document fragment;
+    const pugi::xml_node pict = append_text_watermark_pict(fragment, text, options);
+
+    // A linked section holds its own object for the previous section's part; skip it
+    std::unordered_set<std::string> stamped;
+    for (const auto& section : document_->get_sections()) {
+        for (const auto& header : section->get_all_headers()) {
+            if (!stamped.insert(header->get_part_path()).second) {
+                continue;
+            }
+            append_watermark_paragraph(*header, pict)->get_paragraph_format().style_name =
+                "Header";
+        }
+    }
+    return static_cast<int>(stamped.size());
+}
+
+void Watermark::remove() {
+    if (!document_) {
+        return;
+    }
+    for (const auto& section : document_->get_sections()) {
+        for (const auto& header : section->get_all_headers()) {
+            remove_watermark_paragraphs(*header);
+        }
+    }
+}
+
+bool Watermark::has_watermark() const {
+    if (!document_) {
+        return false;
+    }
+    for (const auto& section : document_->get_sections()) {
+        for (const auto& header : section->get_all_headers()) {
+            for (const auto& para : header->get_paragraphs()) {
+                if (is_watermark_paragraph(*para)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<HeaderFooter> Watermark::ensure_header_for_watermark() {
+    auto sect = document_->get_first_section();
+    if (!sect) {
+        return nullptr;
+    }
+    return sect->ensure_header(HeaderFooterType::Default);
+}
+
+void Watermark::insert_text_watermark_into_header(const std::string& text,
+                                                  const TextWatermarkOptions& options) {
+    auto header = ensure_header_for_watermark();
+    if (!header) {
+        return;
+    }
+
+    pugi::xml_document fragment;
+    append_watermark_paragraph(*header, append_text_watermark_pict(fragment, text, options))
+        ->get_paragraph_format()
+        .style_name = "Header";
 }
 
 void Watermark::insert_image_watermark_into_header(const std::string& image_path,
                                                    const ImageWatermarkOptions& options) {
-    if (!document_) {
+    auto header = ensure_header_for_watermark();
+    if (!header) {
         return;
     }
 
@@ -312,22 +359,11 @@ void Watermark::insert_image_watermark_into_header(const std::string& image_path
         return;
     }
 
-    // Find the first header and its rels path
-    auto header_names = document_->get_header_names();
-    if (header_names.empty()) {
-        return;
-    }
-
-    const std::string& header_path = header_names[0];
-    std::string rels_path;
-    if (header_path.find('/') != std::string::npos) {
-        rels_path = header_path.substr(0, header_path.rfind('/') + 1) + "_rels/" +
-                    header_path.substr(header_path.rfind('/') + 1) + ".rels";
-    } else {
-        rels_path = "word/_rels/" + header_path + ".rels";
-    }
-
-    // Create relationship in header rels
+    // Create relationship in the header's rels
+    const std::string& header_path = header->get_part_path();
+    const size_t name = header_path.rfind('/') + 1;
+    const std::string rels_path =
+        header_path.substr(0, name) + "_rels/" + header_path.substr(name) + ".rels";
     const std::string rel_id = document_->add_relationship(
         rels_path,
         "http://schemas.openxmlformats.org/officeDocument/2006/relationships/image",
@@ -336,53 +372,10 @@ void Watermark::insert_image_watermark_into_header(const std::string& image_path
         return;
     }
 
-    pugi::xml_node header = get_first_header_xml(document_);
-    if (!header) {
-        return;
-    }
-
-    auto para = header.append_child("w:p");
-    auto p_pr = para.append_child("w:pPr");
-    auto jc = p_pr.append_child("w:jc");
-    jc.append_attribute("w:val").set_value("center");
-
-    auto run = para.append_child("w:r");
-    auto pict = run.append_child("w:pict");
-    auto shape = pict.append_child("v:shape");
-    shape.append_attribute("id").set_value("PowerPlusWaterMarkObject");
-    shape.append_attribute("style").set_value(
-        "position:absolute;margin-left:0;margin-top:0;width:400pt;height:300pt;z-index:-251658752;"
-        "mso-position-horizontal:center;mso-position-horizontal-relative:margin;mso-position-"
-        "vertical:center;mso-position-vertical-relative:margin");
-    shape.append_attribute("o:allowincell").set_value("f");
-    shape.append_attribute("stroked").set_value("f");
-
-    // Apply scale if explicitly set (> 0)
-    if (options.scale > 0) {
-        const int width_pt = static_cast<int>(400.0 * options.scale / 100.0);
-        const int height_pt = static_cast<int>(300.0 * options.scale / 100.0);
-        const std::string style =
-            "position:absolute;margin-left:0;margin-top:0;width:" + std::to_string(width_pt) +
-            "pt;height:" + std::to_string(height_pt) +
-            "pt;z-index:-251658752;"
-            "mso-position-horizontal:center;mso-position-horizontal-relative:margin;"
-            "mso-position-vertical:center;mso-position-vertical-relative:margin";
-        shape.attribute("style").set_value(style.c_str());
-    }
-
-    // Apply washout effect (grayscale + reduced contrast)
-    if (options.washout) {
-        auto fill = shape.append_child("v:fill");
-        fill.append_attribute("type").set_value("frame");
-        fill.append_attribute("opacity").set_value("0.5");
-        auto image = shape.append_child("v:image");
-        image.append_attribute("o:title").set_value("Watermark");
-        image.append_attribute("cropleft").set_value("f");
-    }
-
-    auto imagedata = shape.append_child("v:imagedata");
-    imagedata.append_attribute("r:id").set_value(rel_id.c_str());
-    imagedata.append_attribute("o:title").set_value("Watermark");
+    pugi::xml_document fragment;
+    append_watermark_paragraph(*header, append_image_watermark_pict(fragment, rel_id, options))
+        ->get_paragraph_format()
+        .alignment = ParagraphAlignment::Center;
 }
 
 void Watermark::clear_watermark_from_header() {
@@ -0,0 +1,859 @@
+/**
+ * @file zip_archive.cpp
+ * @brief Deflate codec backends and direct ZIP archive reader/writer
+ * @internal Not part of the public API.
+ */
+
+#include "zip_archive.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <thread>
+
+#include "mapped_file.h"
+
+#ifdef CDOCX_HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+#ifdef CDOCX_HAVE_ZLIB_NG
+#include <zlib-ng.h>
+#endif
+
+namespace cdocx {
+
+namespace {
+
+// ============================================================================
+// ZIP Format Constants
+// ============================================================================
+
+constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+constexpr uint32_t kCentralHeaderSignature = 0x02014b50;
+constexpr uint32_t kEndRecordSignature = 0x06054b50;
+constexpr uint32_t kZip64EndRecordSignature = 0x06064b50;
+constexpr uint32_t kZip64LocatorSignature = 0x07064b50;
+
+constexpr size_t kLocalHeaderSize = 30;
+constexpr size_t kCentralHeaderSize = 46;
+constexpr size_t kEndRecordSize = 22;
+constexpr size_t kZip64EndRecordSize = 56;
+constexpr size_t kZip64LocatorSize = 20;
+constexpr size_t kMaxCommentSize = 0xFFFF;
+
+constexpr uint16_t kZip64ExtraTag = 0x0001;
+constexpr uint16_t kVersionNeeded = 20;
+constexpr uint16_t kMethodStored = 0;
+constexpr uint16_t kMethodDeflated = 8;
+constexpr uint16_t kFlagEncrypted = 0x0001;
+constexpr uint16_t kFlagUtf8Names = 0x0800;
+constexpr uint32_t kDirectoryAttribute = 0x10;
+
+constexpr uint32_t kZip32Max = 0xFFFFFFFF;
+constexpr uint16_t kZip32MaxEntries = 0xFFFF;
+
+// Deflate window; a block's dictionary is the input preceding it up to this size
+constexpr size_t kDeflateWindowSize = 32 * 1024;
+
+// Reflected CRC-32 polynomial used by ZIP
+constexpr uint32_t kCrc32Polynomial = 0xedb88320;
+
+uint16_t read_u16(const char* p) {
+    const auto* b = reinterpret_cast<const uint8_t*>(p);
+    return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+uint32_t read_u32(const char* p) {
+    return static_cast<uint32_t>(read_u16(p)) | (static_cast<uint32_t>(read_u16(p + 2)) << 16);
+}
+
+uint64_t read_u64(const char* p) {
+    return static_cast<uint64_t>(read_u32(p)) | (static_cast<uint64_t>(read_u32(p + 4)) << 32);
+}
+
+void write_u16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void write_u32(std::vector<uint8_t>& out, uint32_t value) {
+    write_u16(out, static_cast<uint16_t>(value));
+    write_u16(out, static_cast<uint16_t>(value >> 16));
+}
+
+// Sizes and offsets that do not fit 32 bits are moved to the ZIP64 extra field
+void read_zip64_extra(std::string_view extra, ZipEntryInfo& info) {
+    size_t pos = 0;
+    while (extra.size() - pos >= 4) {
+        const uint16_t tag = read_u16(extra.data() + pos);
+        const uint16_t size = read_u16(extra.data() + pos + 2);
+        pos += 4;
+        if (size > extra.size() - pos) {
+            return;
+        }
+        if (tag == kZip64ExtraTag) {
+            const char* field = extra.data() + pos;
+            const char* field_end = field + size;
+            auto take = [&field, field_end](uint64_t& value) {
+                if (value == kZip32Max && field_end - field >= 8) {
+                    value = read_u64(field);
+                    field += 8;
+                }
+            };
+            take(info.uncompressed_size);
+            take(info.compressed_size);
+            take(info.local_header_offset);
+            return;
+        }
+        pos += size;
+    }
+}
+
+// ============================================================================
+// CRC-32 Combination
+// ============================================================================
+
+// Product of two polynomials modulo the CRC polynomial (bit-reflected, x^0 = bit 31)
+uint32_t crc_multiply(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+    while (true) {
+        if ((a & m) != 0) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = (b & 1) != 0 ? (b >> 1) ^ kCrc32Polynomial : b >> 1;
+    }
+    return p;
+}
+
+// x^(2^k) modulo the CRC polynomial for k = 0..31
+const std::array<uint32_t, 32>& crc_power_table() {
+    static const std::array<uint32_t, 32> table = [] {
+        std::array<uint32_t, 32> powers{};
+        uint32_t p = 1u << 30;  // x^1
+        for (uint32_t& power : powers) {
+            power = p;
+            p = crc_multiply(p, p);
+        }
+        return powers;
+    }();
+    return table;
+}
+
+// ============================================================================
+// Codec Backends
+// ============================================================================
+
+#ifdef CDOCX_HAVE_LIBDEFLATE
+
+class LibdeflateCodec : public DeflateCodec {
+  public:
+    ~LibdeflateCodec() override {
+        if (decompressor_) {
+            libdeflate_free_decompressor(decompressor_);
+        }
+        if (compressor_) {
+            libdeflate_free_compressor(compressor_);
+        }
+    }
+
+    CompressionBackend backend() const override { return CompressionBackend::Libdeflate; }
+
+    bool inflate(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) override {
+        if (!decompressor_) {
+            decompressor_ = libdeflate_alloc_decompressor();
+            if (!decompressor_) {
+                return false;
+            }
+        }
+        size_t actual = 0;
+        return libdeflate_deflate_decompress(
+                   decompressor_, in, in_size, out, out_size, &actual) == LIBDEFLATE_SUCCESS &&
+               actual == out_size;
+    }
+
+    bool deflate(const uint8_t* in, size_t in_size, int level, std::vector<uint8_t>& out) override {
+        if (!compressor_ || compressor_level_ != level) {
+            if (compressor_) {
+                libdeflate_free_compressor(compressor_);
+            }
+            compressor_ = libdeflate_alloc_compressor(level);
+            compressor_level_ = level;
+            if (!compressor_) {
+                return false;
+            }
+        }
+        out.resize(libdeflate_deflate_compress_bound(compressor_, in_size));
+        const size_t written =
+            libdeflate_deflate_compress(compressor_, in, in_size, out.data(), out.size());
+        out.resize(written);
+        return written > 0;
+    }
+
+    uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) const override {
+        return libdeflate_crc32(crc, data, size);
+    }
+
+  private:
+    libdeflate_decompressor* decompressor_ = nullptr;
+    libdeflate_compressor* compressor_ = nullptr;
+    int compressor_level_ = 0;
+};
+
+#endif  // CDOCX_HAVE_LIBDEFLATE
+
+#ifdef CDOCX_HAVE_ZLIB_NG
+
+// Raw deflate window; negative windowBits selects headerless streams
+constexpr int kRawWindowBits = -15;
+constexpr int kMemoryLevel = 8;
+
+class ZlibNgCodec : public DeflateCodec {
+  public:
+    ~ZlibNgCodec() override {
+        if (inflate_ready_) {
+            zng_inflateEnd(&inflate_stream_);
+        }
+        if (deflate_ready_) {
+            zng_deflateEnd(&deflate_stream_);
+        }
+    }
+
+    CompressionBackend backend() const override { return CompressionBackend::ZlibNg; }
+
+    bool inflate(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) override {
+        if (inflate_ready_) {
+            zng_inflateReset(&inflate_stream_);
+        } else if (zng_inflateInit2(&inflate_stream_, kRawWindowBits) == Z_OK) {
+            inflate_ready_ = true;
+        } else {
+            return false;
+        }
+
+        zng_stream& stream = inflate_stream_;
+        stream.next_in = in;
+        stream.avail_in = 0;
+        stream.next_out = out;
+        stream.avail_out = 0;
+        size_t in_left = in_size;
+        size_t out_left = out_size;
+        while (true) {
+            feed(stream.avail_in, in_left);
+            feed(stream.avail_out, out_left);
+            const int rc = zng_inflate(&stream, Z_NO_FLUSH);
+            if (rc == Z_STREAM_END) {
+                return stream.avail_out == 0 && out_left == 0;
+            }
+            // Z_BUF_ERROR: truncated input, or more output than declared
+            if (rc != Z_OK) {
+                return false;
+            }
+        }
+    }
+
+    bool deflate(const uint8_t* in, size_t in_size, int level, std::vector<uint8_t>& out) override {
+        return reset_deflate(level) && run_deflate(in, in_size, Z_FINISH, out);
+    }
+
+    bool supports_block_deflate() const override { return true; }
+
+    bool deflate_block(const uint8_t* in,
+                       size_t in_size,
+                       const uint8_t* dictionary,
+                       size_t dictionary_size,
+                       bool last,
+                       int level,
+                       std::vector<uint8_t>& out) override {
+        if (!reset_deflate(level)) {
+            return false;
+        }
+        if (dictionary_size > 0 &&
+            zng_deflateSetDictionary(&deflate_stream_,
+                                     dictionary,
+                                     static_cast<uint32_t>(dictionary_size)) != Z_OK) {
+            return false;
+        }
+        // A sync flush ends the block with an empty stored block: byte-aligned, not final
+        return run_deflate(in, in_size, last ? Z_FINISH : Z_SYNC_FLUSH, out);
+    }
+
+    uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) const override {
+        return zng_crc32_z(crc, data, size);
+    }
+
+  private:
+    zng_stream inflate_stream_{};
+    zng_stream deflate_stream_{};
+    bool inflate_ready_ = false;
+    bool deflate_ready_ = false;
+    int deflate_level_ = 0;
+
+    // Bytes a sync flush may add beyond deflateBound (empty stored block and bit padding)
+    static constexpr size_t kFlushMargin = 16;
+
+    bool reset_deflate(int level) {
+        if (deflate_ready_ && deflate_level_ == level) {
+            return zng_deflateReset(&deflate_stream_) == Z_OK;
+        }
+        if (deflate_ready_) {
+            zng_deflateEnd(&deflate_stream_);
+            deflate_ready_ = false;
+        }
+        deflate_stream_ = zng_stream{};
+        if (zng_deflateInit2(&deflate_stream_,
+                             level,
+                             Z_DEFLATED,
+                             kRawWindowBits,
+                             kMemoryLevel,
+                             Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        deflate_ready_ = true;
+        deflate_level_ = level;
+        return true;
+    }
+
+    // Compresses all of @p in, ending with @p flush (Z_FINISH or Z_SYNC_FLUSH)
+    bool run_deflate(const uint8_t* in, size_t in_size, int flush, std::vector<uint8_t>& out) {
+        zng_stream& stream = deflate_stream_;
+        out.resize(zng_deflateBound(&stream, in_size) + kFlushMargin);
+        stream.next_in = in;
+        stream.avail_in = 0;
+        stream.next_out = out.data();
+        stream.avail_out = 0;
+        size_t in_left = in_size;
+        size_t out_left = out.size();
+        bool done = false;
+        while (!done) {
+            feed(stream.avail_in, in_left);
+            feed(stream.avail_out, out_left);
+            const int mode = in_left == 0 ? flush : Z_NO_FLUSH;
+            const int rc = zng_deflate(&stream, mode);
+            if (rc == Z_STREAM_END) {
+                done = true;
+            } else if (rc != Z_OK) {
+                return false;
+            } else if (mode == Z_SYNC_FLUSH && stream.avail_in == 0 && stream.avail_out > 0) {
+                done = true;  // Flush complete: output space was left over
+            }
+        }
+        out.resize(static_cast<size_t>(stream.next_out - out.data()));
+        return true;
+    }
+
+    // zng_stream counts are 32-bit; hands out the next slice of a larger buffer
+    static void feed(uint32_t& avail, size_t& left) {
+        if (avail == 0 && left > 0) {
+            avail = static_cast<uint32_t>(std::min<size_t>(left, kZip32Max));
+            left -= avail;
+        }
+    }
+};
+
+#endif  // CDOCX_HAVE_ZLIB_NG
+
+// DOS date and time of @p when in local time, as stored in ZIP headers
+void to_dos_time(std::time_t when, uint16_t& dos_time, uint16_t& dos_date) {
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &when);
+#else
+    localtime_r(&when, &local);
+#endif
+    dos_time = static_cast<uint16_t>((local.tm_hour << 11) | (local.tm_min << 5) |
+                                     (local.tm_sec / 2));
+    dos_date = static_cast<uint16_t>((std::max(local.tm_year - 80, 0) << 9) |
+                                     ((local.tm_mon + 1) << 5) | local.tm_mday);
+}
+
+}  // namespace
+
+// ============================================================================
+// Backend Selection
+// ============================================================================
+
+bool is_compression_backend_available(CompressionBackend backend) {
+    switch (backend) {
+        case CompressionBackend::Bundled:
+            return true;
+        case CompressionBackend::Libdeflate:
+#ifdef CDOCX_HAVE_LIBDEFLATE
+            return true;
+#else
+            return false;
+#endif
+        case CompressionBackend::ZlibNg:
+#ifdef CDOCX_HAVE_ZLIB_NG
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+const char* get_compression_backend_name(CompressionBackend backend) {
+    switch (backend) {
+        case CompressionBackend::Bundled:
+            return "bundled";
+        case CompressionBackend::Libdeflate:
+            return "libdeflate";
+        case CompressionBackend::ZlibNg:
+            return "zlib-ng";
+    }
+    return "unknown";
+}
+
+CompressionBackend get_default_compression_backend() {
+    // zlib-ng first: it is the only backend that deflates large parts on several threads
+    if (is_compression_backend_available(CompressionBackend::ZlibNg)) {
+        return CompressionBackend::ZlibNg;
+    }
+    if (is_compression_backend_available(CompressionBackend::Libdeflate)) {
+        return CompressionBackend::Libdeflate;
+    }
+    return CompressionBackend::Bundled;
+}
+
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t length2) {
+    // crc(A + B) = crc(A) * x^(8 * |B|) + crc(B); the shift is built from x^(2^k) powers
+    const auto& powers = crc_power_table();
+    uint32_t shift = 1u << 31;  // x^0
+    for (size_t k = 3; length2 != 0; length2 >>= 1, ++k) {
+        if ((length2 & 1) != 0) {
+            shift = crc_multiply(powers[k & 31], shift);
+        }
+    }
+    return crc_multiply(shift, crc1) ^ crc2;
+}
+
+std::unique_ptr<DeflateCodec> make_deflate_codec(CompressionBackend backend) {
+    switch (backend) {
+        case CompressionBackend::Libdeflate:
+#ifdef CDOCX_HAVE_LIBDEFLATE
+            return std::make_unique<LibdeflateCodec>();
+#else
+            return nullptr;
+#endif
+        case CompressionBackend::ZlibNg:
+#ifdef CDOCX_HAVE_ZLIB_NG
+            return std::make_unique<ZlibNgCodec>();
+#else
+            return nullptr;
+#endif
+        case CompressionBackend::Bundled:
+            break;
+    }
+    return nullptr;
+}
+
+std::unique_ptr<DeflateCodec> DeflateCodec::make_worker() const {
+    return make_deflate_codec(backend());
+}
+
+// ============================================================================
+// ZipArchiveReader
+// ============================================================================
+
+ZipArchiveReader::ZipArchiveReader() = default;
+
+ZipArchiveReader::~ZipArchiveReader() = default;
+
+bool ZipArchiveReader::open(const std::string& path) {
+    close();
+    auto file = std::make_unique<MappedFile>(path);
+    if (!file->is_open() || !read_central_directory(file->data())) {
+        close();
+        return false;
+    }
+    file_ = std::move(file);
+    return true;
+}
+
+void ZipArchiveReader::close() {
+    file_.reset();
+    entries_.clear();
+    index_.clear();
+}
+
+int ZipArchiveReader::find(const std::string& name) const {
+    const auto it = index_.find(name);
+    return it == index_.end() ? -1 : static_cast<int>(it->second);
+}
+
+bool ZipArchiveReader::read_central_directory(std::string_view data) {
+    if (data.size() < kEndRecordSize) {
+        return false;
+    }
+
+    // The end record is the last thing in the file, followed only by a comment
+    const size_t lowest = data.size() > kEndRecordSize + kMaxCommentSize
+                              ? data.size() - kEndRecordSize - kMaxCommentSize
+                              : 0;
+    size_t end_pos = std::string_view::npos;
+    for (size_t pos = data.size() - kEndRecordSize + 1; pos-- > lowest;) {
+        if (read_u32(data.data() + pos) == kEndRecordSignature) {
+            end_pos = pos;
+            break;
+        }
+    }
+    if (end_pos == std::string_view::npos) {
+        return false;
+    }
+
+    const char* end = data.data() + end_pos;
+    if (read_u16(end + 4) != 0 || read_u16(end + 6) != 0) {
+        return false;  // Multi-disk archive
+    }
+    uint64_t count = read_u16(end + 10);
+    uint64_t directory_size = read_u32(end + 12);
+    uint64_t directory_offset = read_u32(end + 16);
+
+    if (count == kZip32MaxEntries || directory_size == kZip32Max ||
+        directory_offset == kZip32Max) {
+        if (end_pos < kZip64LocatorSize) {
+            return false;
+        }
+        const char* locator = end - kZip64LocatorSize;
+        if (read_u32(locator) != kZip64LocatorSignature) {
+            return false;
+        }
+        const uint64_t record_pos = read_u64(locator + 8);
+        if (data.size() < kZip64EndRecordSize || record_pos > data.size() - kZip64EndRecordSize) {
+            return false;
+        }
+        const char* record = data.data() + record_pos;
+        if (read_u32(record) != kZip64EndRecordSignature) {
+            return false;
+        }
+        count = read_u64(record + 32);
+        directory_size = read_u64(record + 40);
+        directory_offset = read_u64(record + 48);
+    }
+
+    if (directory_offset > data.size() || directory_size > data.size() - directory_offset ||
+        count > directory_size / kCentralHeaderSize) {
+        return false;
+    }
+
+    entries_.reserve(static_cast<size_t>(count));
+    index_.reserve(static_cast<size_t>(count));
+    size_t pos = static_cast<size_t>(directory_offset);
+    const size_t directory_end = pos + static_cast<size_t>(directory_size);
+    for (uint64_t i = 0; i < count; ++i) {
+        if (directory_end - pos < kCentralHeaderSize) {
+            return false;
+        }
+        const char* header = data.data() + pos;
+        if (read_u32(header) != kCentralHeaderSignature) {
+            return false;
+        }
+        const size_t name_length = read_u16(header + 28);
+        const size_t extra_length = read_u16(header + 30);
+        const size_t comment_length = read_u16(header + 32);
+        const size_t record_size = kCentralHeaderSize + name_length + extra_length + comment_length;
+        if (directory_end - pos < record_size) {
+            return false;
+        }
+
+        ZipEntryInfo info;
+        info.flags = read_u16(header + 8);
+        info.method = read_u16(header + 10);
+        info.crc32 = read_u32(header + 16);
+        info.compressed_size = read_u32(header + 20);
+        info.uncompressed_size = read_u32(header + 24);
+        info.local_header_offset = read_u32(header + 42);
+        info.name.assign(header + kCentralHeaderSize, name_length);
+        info.is_directory = !info.name.empty() && info.name.back() == '/';
+        read_zip64_extra(std::string_view(header + kCentralHeaderSize + name_length, extra_length),
+                         info);
+
+        index_.emplace(info.name, entries_.size());
+        entries_.push_back(std::move(info));
+        pos += record_size;
+    }
+    return true;
+}
+
+ZipEntryStatus ZipArchiveReader::read(size_t index,
+                                      DeflateCodec& codec,
+                                      std::vector<uint8_t>& out) const {
+    const ZipEntryInfo& info = entries_[index];
+    if ((info.flags & kFlagEncrypted) != 0 ||
+        (info.method != kMethodStored && info.method != kMethodDeflated)) {
+        return ZipEntryStatus::Unsupported;
+    }
+    if (info.uncompressed_size > std::numeric_limits<size_t>::max()) {
+        return ZipEntryStatus::Corrupt;
+    }
+
+    // The local header repeats the name but may carry a different extra field
+    const std::string_view data = file_->data();
+    if (info.local_header_offset > data.size() ||
+        data.size() - info.local_header_offset < kLocalHeaderSize) {
+        return ZipEntryStatus::Corrupt;
+    }
+    const char* local = data.data() + info.local_header_offset;
+    if (read_u32(local) != kLocalHeaderSignature) {
+        return ZipEntryStatus::Corrupt;
+    }
+    const uint64_t data_offset =
+        info.local_header_offset + kLocalHeaderSize + read_u16(local + 26) + read_u16(local + 28);
+    if (data_offset > data.size() || info.compressed_size > data.size() - data_offset) {
+        return ZipEntryStatus::Corrupt;
+    }
+    const auto* compressed = reinterpret_cast<const uint8_t*>(data.data() + data_offset);
+
+    out.resize(static_cast<size_t>(info.uncompressed_size));
+    if (info.method == kMethodStored) {
+        if (info.compressed_size != info.uncompressed_size) {
+            return ZipEntryStatus::Corrupt;
+        }
+        if (!out.empty()) {
+            std::memcpy(out.data(), compressed, out.size());
+        }
+    } else if (!out.empty() && !codec.inflate(compressed,
+                                              static_cast<size_t>(info.compressed_size),
+                                              out.data(),
+                                              out.size())) {
+        return ZipEntryStatus::Corrupt;
+    }
+
+    return codec.crc32(0, out.data(), out.size()) == info.crc32 ? ZipEntryStatus::Ok
+                                                                : ZipEntryStatus::Corrupt;
+}
+
+// ============================================================================
+// ZipArchiveWriter
+// ============================================================================
+
+bool ZipArchiveWriter::open(const std::string& path) {
+    memory_ = nullptr;
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    offset_ = 0;
+    records_.clear();
+    to_dos_time(std::time(nullptr), dos_time_, dos_date_);
+    return out_.is_open();
+}
+
+bool ZipArchiveWriter::open(std::vector<uint8_t>& buffer) {
+    memory_ = &buffer;
+    memory_->clear();
+    offset_ = 0;
+    records_.clear();
+    to_dos_time(std::time(nullptr), dos_time_, dos_date_);
+    return true;
+}
+
+bool ZipArchiveWriter::add_directory(const std::string& name) {
+    CentralRecord record;
+    record.name = name;
+    return write_entry(std::move(record), nullptr, 0);
+}
+
+bool ZipArchiveWriter::add_entry(const std::string& name,
+                                 const uint8_t* data,
+                                 size_t size,
+                                 const CancellationToken* token) {
+    if (size >= kZip32Max) {
+        return false;
+    }
+
+    CentralRecord record;
+    record.name = name;
+    record.uncompressed_size = static_cast<uint32_t>(size);
+
+    bool deflated = false;
+    if (threads_ > 1 && size >= 2 * kParallelBlockSize && codec_.supports_block_deflate()) {
+        deflated = deflate_parallel(data, size, token, record.crc32);
+        if (deflated) {
+            ++parallel_entries_;
+        } else if (token && token->is_cancelled()) {
+            return false;
+        }
+    }
+    if (!deflated) {
+        record.crc32 = codec_.crc32(0, data, size);
+        deflated = size > 0 && codec_.deflate(data, size, level_, buffer_);
+    }
+
+    const uint8_t* payload = data;
+    size_t payload_size = size;
+    if (deflated && buffer_.size() < size) {
+        record.method = kMethodDeflated;
+        payload = buffer_.data();
+        payload_size = buffer_.size();
+    }
+    record.compressed_size = static_cast<uint32_t>(payload_size);
+    return write_entry(std::move(record), payload, payload_size);
+}
+
+bool ZipArchiveWriter::deflate_parallel(const uint8_t* data,
+                                        size_t size,
+                                        const CancellationToken* token,
+                                        uint32_t& crc) {
+    const size_t block_count = (size + kParallelBlockSize - 1) / kParallelBlockSize;
+    const size_t thread_count = std::min(threads_, block_count);
+    while (worker_codecs_.size() < thread_count) {
+        auto codec = codec_.make_worker();
+        if (!codec) {
+            return false;
+        }
+        worker_codecs_.push_back(std::move(codec));
+    }
+    if (blocks_.size() < block_count) {
+        blocks_.resize(block_count);
+    }
+
+    // Workers claim blocks in order, so the blocks needed first finish first
+    std::atomic<size_t> next_block{0};
+    std::atomic<bool> failed{false};
+    auto compress_blocks = [&](DeflateCodec& codec) {
+        for (size_t i = next_block++; i < block_count && !failed; i = next_block++) {
+            if (token && token->is_cancelled()) {
+                failed = true;
+                return;
+            }
+            const size_t offset = i * kParallelBlockSize;
+            const size_t length = std::min(kParallelBlockSize, size - offset);
+            const size_t dictionary_size = std::min(offset, kDeflateWindowSize);
+            Block& block = blocks_[i];
+            block.crc32 = codec.crc32(0, data + offset, length);
+            if (!codec.deflate_block(data + offset,
+                                     length,
+                                     data + offset - dictionary_size,
+                                     dictionary_size,
+                                     i + 1 == block_count,
+                                     level_,
+                                     block.output)) {
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t t = 1; t < thread_count; ++t) {
+        threads.emplace_back(compress_blocks, std::ref(*worker_codecs_[t]));
+    }
+    compress_blocks(*worker_codecs_[0]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failed) {
+        return false;
+    }
+
+    size_t compressed_size = 0;
+    for (size_t i = 0; i < block_count; ++i) {
+        compressed_size += blocks_[i].output.size();
+    }
+    buffer_.clear();
+    buffer_.reserve(compressed_size);
+    crc = 0;
+    for (size_t i = 0; i < block_count; ++i) {
+        const Block& block = blocks_[i];
+        const size_t length = std::min(kParallelBlockSize, size - i * kParallelBlockSize);
+        buffer_.insert(buffer_.end(), block.output.begin(), block.output.end());
+        crc = crc32_combine(crc, block.crc32, length);
+    }
+    return true;
+}
+
+bool ZipArchiveWriter::write_entry(CentralRecord record, const uint8_t* data, size_t size) {
+    if ((!memory_ && !out_) || records_.size() >= kZip32MaxEntries ||
+        offset_ + kLocalHeaderSize + record.name.size() + size >= kZip32Max) {
+        return false;
+    }
+    record.local_header_offset = static_cast<uint32_t>(offset_);
+
+    std::vector<uint8_t> header;
+    header.reserve(kLocalHeaderSize + record.name.size());
+    write_u32(header, kLocalHeaderSignature);
+    write_u16(header, kVersionNeeded);
+    write_u16(header, kFlagUtf8Names);
+    write_u16(header, record.method);
+    write_u16(header, dos_time_);
+    write_u16(header, dos_date_);
+    write_u32(header, record.crc32);
+    write_u32(header, record.compressed_size);
+    write_u32(header, record.uncompressed_size);
+    write_u16(header, static_cast<uint16_t>(record.name.size()));
+    write_u16(header, 0);
+    header.insert(header.end(), record.name.begin(), record.name.end());
+
+    const bool written = write_bytes(header.data(), header.size()) && write_bytes(data, size);
+    offset_ += header.size() + size;
+    records_.push_back(std::move(record));
+    return written;
+}
+
+bool ZipArchiveWriter::write_bytes(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    if (memory_) {
+        memory_->insert(memory_->end(), data, data + size);
+        return true;
+    }
+    out_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    return static_cast<bool>(out_);
+}
+
+bool ZipArchiveWriter::close() {
+    if (!memory_ && !out_.is_open()) {
+        return false;
+    }
+
+    std::vector<uint8_t> directory;
+    for (const CentralRecord& record : records_) {
+        const bool is_directory = !record.name.empty() && record.name.back() == '/';
+        write_u32(directory, kCentralHeaderSignature);
+        write_u16(directory, kVersionNeeded);
+        write_u16(directory, kVersionNeeded);
+        write_u16(directory, kFlagUtf8Names);
+        write_u16(directory, record.method);
+        write_u16(directory, dos_time_);
+        write_u16(directory, dos_date_);
+        write_u32(directory, record.crc32);
+        write_u32(directory, record.compressed_size);
+        write_u32(directory, record.uncompressed_size);
+        write_u16(directory, static_cast<uint16_t>(record.name.size()));
+        write_u16(directory, 0);  // Extra field
+        write_u16(directory, 0);  // Comment
+        write_u16(directory, 0);  // Disk number
+        write_u16(directory, 0);  // Internal attributes
+        write_u32(directory, is_directory ? kDirectoryAttribute : 0);
+        write_u32(directory, record.local_header_offset);
+        directory.insert(directory.end(), record.name.begin(), record.name.end());
+    }
+
+    const size_t directory_size = directory.size();
+    const bool fits = offset_ + directory_size < kZip32Max;
+    const auto count = static_cast<uint16_t>(records_.size());
+    write_u32(directory, kEndRecordSignature);
+    write_u16(directory, 0);
+    write_u16(directory, 0);
+    write_u16(directory, count);
+    write_u16(directory, count);
+    write_u32(directory, static_cast<uint32_t>(directory_size));
+    write_u32(directory, static_cast<uint32_t>(offset_));
+    write_u16(directory, 0);
+
+    const bool ok = write_bytes(directory.data(), directory.size()) && fits;
+    if (memory_) {
+        memory_ = nullptr;
+        return ok;
+    }
+    out_.close();
+    return ok && !out_.fail();
+}
+
+}  // namespace cdocx
@@ -0,0 +1,217 @@
+/**
+ * @file zip_archive.h
+ * @brief Internal deflate codecs and direct ZIP archive reader/writer
+ * @internal Not part of the public API.
+ * @details Used instead of the bundled ZIP library when a non-bundled
+ *          CompressionBackend is selected. The reader parses the central
+ *          directory of a memory-mapped package and inflates entries straight
+ *          into caller-owned buffers; it is immutable after open() and may be
+ *          shared by several threads, each with its own DeflateCodec.
+ */
+
+#pragma once
+
+#include <cdocx/cancellation.h>
+#include <cdocx/compression.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace cdocx {
+
+class MappedFile;
+
+// ============================================================================
+// DeflateCodec
+// ============================================================================
+
+/// Raw (headerless) deflate codec; instances are not thread-safe
+class DeflateCodec {
+  public:
+    virtual ~DeflateCodec() = default;
+
+    virtual CompressionBackend backend() const = 0;
+
+    /// Inflates @p in into exactly @p out_size bytes; false on corrupt or longer data
+    virtual bool inflate(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) = 0;
+
+    /// Replaces @p out with the raw deflate stream of @p in
+    virtual bool deflate(const uint8_t* in,
+                         size_t in_size,
+                         int level,
+                         std::vector<uint8_t>& out) = 0;
+
+    /// CRC-32 (ZIP polynomial) of @p data continuing from @p crc (0 to start)
+    virtual uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) const = 0;
+
+    /// New codec of the same kind for a worker thread; nullptr if none can be created
+    virtual std::unique_ptr<DeflateCodec> make_worker() const;
+
+    /// True if deflate_block() is implemented (streaming codecs with preset dictionaries)
+    virtual bool supports_block_deflate() const { return false; }
+
+    /**
+     * @brief Replaces @p out with one block of a larger raw deflate stream
+     * @details The compressor is primed with @p dictionary, the input that
+     *          precedes the block (up to 32 KB), so matches may reach back into
+     *          it. Blocks other than the @p last end on a byte boundary without
+     *          the final-block bit, so compressed blocks concatenate into one
+     *          valid stream.
+     */
+    virtual bool deflate_block(const uint8_t* /*in*/,
+                               size_t /*in_size*/,
+                               const uint8_t* /*dictionary*/,
+                               size_t /*dictionary_size*/,
+                               bool /*last*/,
+                               int /*level*/,
+                               std::vector<uint8_t>& /*out*/) {
+        return false;
+    }
+};
+
+/// Codec for @p backend; nullptr for Bundled or a backend that was not compiled in
+std::unique_ptr<DeflateCodec> make_deflate_codec(CompressionBackend backend);
+
+/// CRC-32 of two concatenated buffers from their CRCs and the length of the second
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t length2);
+
+// ============================================================================
+// ZipArchiveReader
+// ============================================================================
+
+struct ZipEntryInfo {
+    std::string name;
+    uint64_t compressed_size = 0;
+    uint64_t uncompressed_size = 0;
+    uint64_t local_header_offset = 0;
+    uint32_t crc32 = 0;
+    uint16_t method = 0;  ///< 0 = stored, 8 = deflated
+    uint16_t flags = 0;
+    bool is_directory = false;
+};
+
+enum class ZipEntryStatus : std::uint8_t {
+    Ok,
+    Corrupt,     ///< Damaged header, data or CRC
+    Unsupported  ///< Encrypted or compressed with a method other than deflate
+};
+
+class ZipArchiveReader {
+  public:
+    ZipArchiveReader();
+    ~ZipArchiveReader();
+
+    ZipArchiveReader(const ZipArchiveReader&) = delete;
+    ZipArchiveReader& operator=(const ZipArchiveReader&) = delete;
+
+    /// Maps @p path and reads its central directory; false if not a readable archive
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return file_ != nullptr; }
+
+    size_t size() const { return entries_.size(); }
+    const ZipEntryInfo& entry(size_t index) const { return entries_[index]; }
+
+    /// Index of the entry named @p name, or -1
+    int find(const std::string& name) const;
+
+    /// Reads entry @p index into @p out (resized to the declared size) and checks its CRC
+    ZipEntryStatus read(size_t index, DeflateCodec& codec, std::vector<uint8_t>& out) const;
+
+  private:
+    std::unique_ptr<MappedFile> file_;
+    std::vector<ZipEntryInfo> entries_;
+    std::unordered_map<std::string, size_t> index_;
+
+    bool read_central_directory(std::string_view data);
+};
+
+// ============================================================================
+// ZipArchiveWriter
+// ============================================================================
+
+/**
+ * @brief Writes a ZIP archive (no ZIP64) whose entries are compressed by a DeflateCodec
+ * @details With set_threads() and a codec that supports deflate_block(),
+ *          entries of at least two blocks are split into fixed-size blocks
+ *          that are compressed and checksummed concurrently (as pigz does) and
+ *          joined into a single deflate stream and CRC.
+ */
+class ZipArchiveWriter {
+  public:
+    /// Input bytes per parallel block; each block adds a 5-byte flush marker
+    static constexpr size_t kParallelBlockSize = 1024 * 1024;
+
+    ZipArchiveWriter(DeflateCodec& codec, int level) : codec_(codec), level_(level) {}
+
+    bool open(const std::string& path);
+
+    /// Writes the archive into @p buffer instead of a file (replacing its contents)
+    bool open(std::vector<uint8_t>& buffer);
+
+    /// Threads used to deflate one large entry (0 or 1 = single-threaded)
+    void set_threads(size_t threads) { threads_ = threads; }
+
+    /// Adds an empty directory entry; @p name must end with '/'
+    bool add_directory(const std::string& name);
+
+    /**
+     * @brief Compresses and writes one entry; stored instead if deflate does not shrink it
+     * @return false on I/O errors or if @p token was cancelled during a parallel deflate
+     */
+    bool add_entry(const std::string& name,
+                   const uint8_t* data,
+                   size_t size,
+                   const CancellationToken* token = nullptr);
+
+    /// Writes the central directory and closes the file (or finishes the buffer)
+    bool close();
+
+    /// Entries written so far that were deflated as parallel blocks
+    size_t get_parallel_entry_count() const { return parallel_entries_; }
+
+  private:
+    struct Block {
+        std::vector<uint8_t> output;
+        uint32_t crc32 = 0;
+    };
+
+    struct CentralRecord {
+        std::string name;
+        uint32_t crc32 = 0;
+        uint32_t compressed_size = 0;
+        uint32_t uncompressed_size = 0;
+        uint32_t local_header_offset = 0;
+        uint16_t method = 0;
+    };
+
+    DeflateCodec& codec_;
+    int level_;
+    std::ofstream out_;
+    std::vector<uint8_t>* memory_ = nullptr;  ///< Target of open(buffer), else null
+    uint64_t offset_ = 0;
+    uint16_t dos_time_ = 0;
+    uint16_t dos_date_ = 0;
+    std::vector<CentralRecord> records_;
+    std::vector<uint8_t> buffer_;  ///< Compressed data of the current entry
+
+    size_t threads_ = 1;
+    size_t parallel_entries_ = 0;
+    std::vector<std::unique_ptr<DeflateCodec>> worker_codecs_;
+    std::vector<Block> blocks_;  ///< Reused across entries to keep their capacity
+
+    bool deflate_parallel(const uint8_t* data,
+                          size_t size,
+                          const CancellationToken* token,
+                          uint32_t& crc);
+    bool write_entry(CentralRecord record, const uint8_t* data, size_t size);
+    bool write_bytes(const uint8_t* data, size_t size);
+};
+
+}  // namespace cdocx
@@ -14,6 +14,9 @@
 #include <cstring>
 #include <filesystem>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace fs = std::filesystem;
 using cdocx::test::TempDoc;
@@ -533,4 +536,99 @@ TEST(TextFormattingTest, RunPropertiesXmlRoundTrip) {
 
 }
 
+TEST(TextFormattingTest, ControlCharactersBecomeTabsAndBreaks) {
+    TempDoc temp_doc("test_run_control_chars.docx");
+    const std::string& test_file = temp_doc.path();
+
+    {
+        cdocx::Document doc;
+        ASSERT_TRUE(doc.create_empty(test_file));
+        auto sect = doc.get_first_section();
+        ASSERT_NE(sect, nullptr);
+
+        // '\x01' is not allowed in XML and must be dropped without splitting "DE"
+        sect->append_paragraph("A\tB\nC\fD\x01E");
+        doc.sync_to_physical_tree();
+
+        auto body = doc.get_document_xml()->child("w:document").child("w:body");
+        pugi::xml_node run;
+        for (auto p = body.child("w:p"); p && !run; p = p.next_sibling("w:p")) {
+            auto t = p.child("w:r").child("w:t");
+            if (t && std::strcmp(t.text().get(), "A") == 0) {
+                run = p.child("w:r");
+            }
+        }
+        ASSERT_TRUE(run);
+
+        std::string sequence;
+        for (auto child = run.first_child(); child; child = child.next_sibling()) {
+            sequence += child.name();
+            if (auto type = child.attribute("w:type")) {
+                sequence += std::string("=") + type.value();
+            }
+            if (std::strcmp(child.name(), "w:t") == 0) {
+                sequence += std::string(":") + child.text().get();
+            }
+            sequence += ' ';
+        }
+        EXPECT_EQ(sequence, "w:t:A w:tab w:t:B w:br w:t:C w:br=page w:t:DE ");
+        doc.save();
+    }
+
+    cdocx::Document reopened(test_file);
+    reopened.open();
+    ASSERT_TRUE(reopened.is_open());
+    bool found = false;
+    for (const auto& para : reopened.get_paragraphs()) {
+        if (para && para->get_text() == "A\tB\vC\fDE") {
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST(TextFormattingTest, InvalidUtf8BecomesReplacementCharacter) {
+    const std::string kReplacement = "\xEF\xBF\xBD";
+    const std::vector<std::pair<std::string, std::string>> cases = {
+        // Valid text outside ASCII is kept
+        {"caf\xC3\xA9 \xE4\xB8\xAD\xE6\x96\x87 \xF0\x9F\x98\x80",
+         "caf\xC3\xA9 \xE4\xB8\xAD\xE6\x96\x87 \xF0\x9F\x98\x80"},
+        // U+FFFE and U+FFFF are well-formed but not XML characters
+        {"A\xEF\xBF\xBE" "B", "A" + kReplacement + "B"},
+        {"A\xEF\xBF\xBF" "B", "A" + kReplacement + "B"},
+        // An encoded surrogate, an overlong '/' and a code point above U+10FFFF
+        {"A\xED\xA0\x80" "B", "A" + kReplacement + kReplacement + kReplacement + "B"},
+        {"A\xC0\xAF" "B", "A" + kReplacement + kReplacement + "B"},
+        {"A\xF4\x90\x80\x80" "B",
+         "A" + kReplacement + kReplacement + kReplacement + kReplacement + "B"},
+        // A truncated sequence and a stray continuation byte before a dropped control byte
+        {"A\xC3", "A" + kReplacement},
+        {"A\x80\x01" "B", "A" + kReplacement + "B"},
+    };
+    cdocx::Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    auto sect = doc.get_first_section();
+    ASSERT_NE(sect, nullptr);
+    for (const auto& test_case : cases) {
+        sect->append_paragraph(test_case.first);
+    }
+    doc.sync_to_physical_tree();
+
+    std::vector<std::string> written;
+    auto body = doc.get_document_xml()->child("w:document").child("w:body");
+    for (auto p = body.child("w:p"); p; p = p.next_sibling("w:p")) {
+        std::string text;
+        for (auto t = p.child("w:r").child("w:t"); t; t = t.next_sibling("w:t")) {
+            text += t.text().get();
+        }
+        if (!text.empty()) {
+            written.push_back(text);
+        }
+    }
+    ASSERT_EQ(written.size(), cases.size());
+    for (size_t i = 0; i < cases.size(); ++i) {
+        EXPECT_EQ(written[i], cases[i].second) << i;
+    }
+}
+
 /** @} */
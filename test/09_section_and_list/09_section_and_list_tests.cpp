@@ -9,10 +9,13 @@
 #include "../test_helpers.h"
 #include <filesystem>
 #include <fstream>
+#include <string>
 
 using namespace cdocx;
 namespace fs = std::filesystem;
+using cdocx::test::BenchmarkClock;
 using cdocx::test::TempDoc;
+using cdocx::test::elapsed_micros;
 
 // ============================================================================
 // NumberStyle String Round-Trip Tests
@@ -454,3 +457,219 @@ TEST(SectionAndListTest, HeaderFooterLinkToPreviousByType) {
 
     doc2.close();
 }
+
+// ============================================================================
+// Watermark Tests
+// ============================================================================
+
+static int count_watermark_shapes(pugi::xml_node node) {
+    int count = 0;
+    for (pugi::xml_node child : node.children()) {
+        if (std::string(child.name()) == "v:shape" &&
+            std::string(child.attribute("id").value()) == "PowerPlusWaterMarkObject") {
+            ++count;
+        }
+        count += count_watermark_shapes(child);
+    }
+    return count;
+}
+
+static int count_watermark_shapes(Document& doc, const std::string& part_path) {
+    const pugi::xml_document* part = doc.get_xml_part(part_path);
+    return part ? count_watermark_shapes(*part) : -1;
+}
+
+TEST(SectionAndListTest, WatermarkEveryHeaderOfEverySection) {
+    TempDoc temp_doc("test_watermark_sections.docx");
+    std::string first_default;
+    std::string first_page;
+    std::string second_default;
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto sect1 = doc.get_first_section();
+        first_default = sect1->add_header()->get_part_path();
+        first_page = sect1->add_header(HeaderFooterType::First)->get_part_path();
+
+        auto sect2 = doc.add_section();
+        auto header2 = sect2->add_header();
+        header2->append_paragraph("Second section");
+        second_default = header2->get_part_path();
+
+        // The third section shares the second one's header, the fourth shows it too
+        doc.add_section()->link_to_previous(HeaderFooterType::Default, true);
+        doc.add_section();
+
+        EXPECT_EQ(doc.watermark().apply_to_all_sections("DRAFT"), 3);
+        // Applying again replaces the watermark instead of adding a second one
+        EXPECT_EQ(doc.watermark().apply_to_all_sections("CONFIDENTIAL"), 3);
+        EXPECT_TRUE(doc.watermark().has_watermark());
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    EXPECT_TRUE(doc.watermark().has_watermark());
+    for (const auto& part : {first_default, first_page, second_default}) {
+        EXPECT_EQ(count_watermark_shapes(doc, part), 1) << part;
+        EXPECT_TRUE(doc.get_xml_part(part)->child("w:hdr").attribute("xmlns:v")) << part;
+    }
+    EXPECT_NE(doc.get_section(1)->get_header()->get_text().find("Second section"),
+              std::string::npos);
+
+    doc.watermark().remove();
+    EXPECT_FALSE(doc.watermark().has_watermark());
+    doc.save();
+
+    Document reopened(temp_doc.path());
+    reopened.open();
+    ASSERT_TRUE(reopened.is_open());
+    EXPECT_FALSE(reopened.watermark().has_watermark());
+    EXPECT_EQ(count_watermark_shapes(reopened, second_default), 0);
+}
+
+TEST(SectionAndListTest, DISABLED_WatermarkFiveHundredSectionsBenchmark) {
+    constexpr int kSections = 500;
+    TempDoc temp_doc("test_watermark_bench.docx");
+    Document doc(temp_doc.path());
+    ASSERT_TRUE(doc.create_empty());
+    doc.get_first_section()->add_header();
+    for (int i = 1; i < kSections; ++i) {
+        auto section = doc.add_section();
+        section->append_paragraph("Section " + std::to_string(i));
+        section->add_header();
+    }
+
+    auto start = BenchmarkClock::now();
+    EXPECT_EQ(doc.watermark().apply_to_all_sections("DRAFT"), kSections);
+    RecordProperty("apply_to_all_sections_us", elapsed_micros(start));
+
+    start = BenchmarkClock::now();
+    doc.save();
+    RecordProperty("save_us", elapsed_micros(start));
+
+    start = BenchmarkClock::now();
+    doc.watermark().remove();
+    RecordProperty("remove_us", elapsed_micros(start));
+    EXPECT_FALSE(doc.watermark().has_watermark());
+}
+
+// ============================================================================
+// Abstract Numbering Interning Tests
+// ============================================================================
+
+namespace {
+
+size_t count_children(Document& doc, const char* name) {
+    auto* numbering = doc.get_numbering_xml();
+    if (!numbering) {
+        return 0;
+    }
+    size_t count = 0;
+    for (auto child : numbering->child("w:numbering").children(name)) {
+        (void)child;
+        ++count;
+    }
+    return count;
+}
+
+}  // namespace
+
+TEST(SectionAndListTest, IdenticalListDefinitionsShareAbstract) {
+    TempDoc temp_doc("test_numbering_intern.docx");
+    Document doc("test_numbering_intern.docx");
+    ASSERT_TRUE(doc.create_empty());
+
+    std::vector<NumberingId> ids;
+    for (int i = 0; i < 100; ++i) {
+        ids.push_back(doc.add_bulleted_list_definition());
+    }
+    const auto roman = doc.add_numbered_list_definition(NumberStyle::UpperRoman);
+
+    const auto* first = doc.get_numbering_definition(ids.front());
+    const auto* last = doc.get_numbering_definition(ids.back());
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(last, nullptr);
+    EXPECT_NE(ids.front(), ids.back());
+    EXPECT_EQ(first->abstract_id, last->abstract_id);
+    EXPECT_NE(doc.get_numbering_definition(roman)->abstract_id, first->abstract_id);
+
+    // Every list after the first restarts instead of continuing the first one
+    EXPECT_TRUE(first->start_overrides.empty());
+    ASSERT_EQ(last->start_overrides.count(NumberingLevel::Level1), 1u);
+    EXPECT_EQ(last->start_overrides.at(NumberingLevel::Level1), 1u);
+
+    doc.save();
+    EXPECT_EQ(count_children(doc, "w:abstractNum"), 2u);
+    EXPECT_EQ(count_children(doc, "w:num"), 101u);
+}
+
+TEST(SectionAndListTest, LoadedAbstractDefinitionsAreReused) {
+    TempDoc temp_doc("test_numbering_intern_reload.docx");
+    {
+        Document doc("test_numbering_intern_reload.docx");
+        ASSERT_TRUE(doc.create_empty());
+        doc.add_bulleted_list_definition();
+        doc.add_outline_list_definition();
+        doc.save();
+    }
+
+    Document doc("test_numbering_intern_reload.docx");
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    auto first_abstract = doc.get_numbering_xml()->child("w:numbering").child("w:abstractNum");
+
+    const auto id = doc.add_bulleted_list_definition();
+    EXPECT_EQ(doc.get_numbering_definition(id)->abstract_id, 0u);
+    doc.save();
+
+    // Only the new w:num was written; existing definitions kept their XML
+    EXPECT_EQ(count_children(doc, "w:abstractNum"), 2u);
+    EXPECT_EQ(count_children(doc, "w:num"), 3u);
+    EXPECT_EQ(doc.get_numbering_xml()->child("w:numbering").child("w:abstractNum"),
+              first_abstract);
+}
+
+TEST(SectionAndListTest, InsertDocumentMergesListDefinitions) {
+    TempDoc source_file("test_numbering_merge_source.docx");
+    {
+        Document source("test_numbering_merge_source.docx");
+        ASSERT_TRUE(source.create_empty());
+        const auto list = source.add_bulleted_list_definition();
+        source.get_first_section()->add_paragraph("Source item")->set_numbering(
+            list, NumberingLevel::Level1);
+        source.save();
+    }
+
+    Document source("test_numbering_merge_source.docx");
+    source.open();
+    ASSERT_TRUE(source.is_open());
+
+    TempDoc target_file("test_numbering_merge_target.docx");
+    Document target("test_numbering_merge_target.docx");
+    ASSERT_TRUE(target.create_empty());
+    const auto target_list = target.add_bulleted_list_definition();
+    target.add_numbered_list_definition();
+    target.sync_to_physical_tree();
+
+    DocumentInserter inserter(&target);
+    inserter.insert_document(&source);
+
+    // The copied paragraph points at a new list on the shared abstract definition
+    auto body = target.get_document_xml()->child("w:document").child("w:body");
+    NumberingId copied = 0;
+    for (auto para : body.children("w:p")) {
+        if (auto num_id = para.child("w:pPr").child("w:numPr").child("w:numId")) {
+            copied = num_id.attribute("w:val").as_uint();
+        }
+    }
+    ASSERT_NE(copied, 0u);
+    EXPECT_NE(copied, target_list);
+    const auto* def = target.get_numbering_definition(copied);
+    ASSERT_NE(def, nullptr);
+    EXPECT_EQ(def->abstract_id, target.get_numbering_definition(target_list)->abstract_id);
+
+    target.save();
+    EXPECT_EQ(count_children(target, "w:abstractNum"), 2u);
+}
@@ -7,13 +7,22 @@
 #include <gtest/gtest.h>
 #include <cdocx.h>
 #include "../test_helpers.h"
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
 
 using namespace cdocx;
 namespace fs = std::filesystem;
+using cdocx::test::BenchmarkClock;
 using cdocx::test::TempDoc;
+using cdocx::test::elapsed_micros;
 
 // ============================================================================
 // Node Tree Traversal Tests
@@ -666,3 +675,343 @@ TEST(ParagraphParentTest, IsEndOfSection) {
     EXPECT_FALSE(para1->is_end_of_section());
     EXPECT_TRUE(para2->is_end_of_section());
 }
+
+// ============================================================================
+// Document Statistics Tests
+// ============================================================================
+
+TEST(DocumentStatisticsTest, CountsEastAsianCharactersAsWords) {
+    auto latin = count_text_statistics("Hello,  world!");
+    EXPECT_EQ(latin.words, 2);
+    EXPECT_EQ(latin.characters, 12);
+    EXPECT_EQ(latin.characters_with_spaces, 14);
+    EXPECT_EQ(latin.paragraphs, 1);
+    EXPECT_EQ(latin.lines, 1);
+
+    // Each ideograph is a word; the Latin word after it is one more
+    auto mixed = count_text_statistics("\xE4\xB8\xAD\xE6\x96\x87 text");
+    EXPECT_EQ(mixed.words, 3);
+    EXPECT_EQ(mixed.characters, 6);
+    EXPECT_EQ(mixed.characters_with_spaces, 7);
+
+    auto breaks = count_text_statistics("one\vtwo\tthree");
+    EXPECT_EQ(breaks.words, 3);
+    EXPECT_EQ(breaks.lines, 2);
+
+    auto empty = count_text_statistics("");
+    EXPECT_EQ(empty.paragraphs, 0);
+    EXPECT_EQ(empty.lines, 0);
+}
+
+TEST(DocumentStatisticsTest, SyncWritesStatisticsToAppXml) {
+    TempDoc temp_doc("test_statistics.docx");
+    Document doc("test_statistics.docx");
+    ASSERT_TRUE(doc.create_empty());
+
+    auto body = doc.get_first_section()->get_body();
+    ASSERT_NE(body, nullptr);
+    body->append_paragraph("The quick brown fox");
+    auto second = body->append_paragraph("jumps");
+    auto table = body->append_table(1, 1);
+    table->get_rows()[0]->get_cells()[0]->append_paragraph("over the dog");
+
+    doc.sync_to_physical_tree();
+    EXPECT_EQ(doc.get_statistics().words, 8);
+    EXPECT_EQ(doc.get_statistics().paragraphs, 3);
+
+    auto root = doc.get_app_properties()->child("Properties");
+    EXPECT_STREQ(root.child_value("Words"), "8");
+    EXPECT_STREQ(root.child_value("Characters"), "31");
+    EXPECT_STREQ(root.child_value("CharactersWithSpaces"), "36");
+    EXPECT_STREQ(root.child_value("Paragraphs"), "3");
+
+    // Only the edited paragraph changes; removed paragraphs no longer count
+    second->set_text("jumps high");
+    doc.sync_to_physical_tree();
+    EXPECT_EQ(doc.get_statistics().words, 9);
+    body->remove_child(second);
+    EXPECT_EQ(doc.update_statistics().words, 7);
+    EXPECT_EQ(doc.get_builtin_document_properties().total_words, 7);
+}
+
+TEST(DocumentStatisticsTest, ContentVersionFollowsRunEdits) {
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    auto body = doc.get_first_section()->get_body();
+    auto para = body->append_paragraph("");
+    auto run = para->append_run("one two");
+    auto other = body->append_paragraph("three");
+    EXPECT_EQ(doc.update_statistics().words, 3);
+
+    // Reading and recounting leave every version alone
+    const auto version = para->get_content_version();
+    const auto other_version = other->get_content_version();
+    EXPECT_EQ(doc.update_statistics().words, 3);
+    EXPECT_EQ(para->get_content_version(), version);
+    EXPECT_EQ(other->get_content_version(), other_version);
+
+    // Edits through a run reach the paragraph that holds it, and only that one
+    run->append_text(" four");
+    EXPECT_NE(para->get_content_version(), version);
+    EXPECT_EQ(other->get_content_version(), other_version);
+    EXPECT_EQ(doc.update_statistics().words, 4);
+
+    run->set_text("five");
+    EXPECT_EQ(doc.update_statistics().words, 2);
+
+    para->append_run(" six seven");
+    EXPECT_EQ(doc.update_statistics().words, 4);
+
+    para->remove_child(run);
+    EXPECT_EQ(doc.update_statistics().words, 3);
+
+    // A copy never shares the version of the paragraph it came from
+    Paragraph copy(*para);
+    EXPECT_NE(copy.get_content_version(), para->get_content_version());
+}
+
+TEST(DocumentStatisticsTest, SyncKeepsStatisticsWhenDisabled) {
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    doc.get_first_section()->get_body()->append_paragraph("Some words here");
+    doc.get_builtin_document_properties().total_words = 42;
+
+    doc.set_update_statistics_on_sync(false);
+    doc.sync_to_physical_tree();
+    EXPECT_EQ(doc.get_builtin_document_properties().total_words, 42);
+}
+
+// ============================================================================
+// Custom Document Properties Tests
+// ============================================================================
+
+static int count_custom_overrides(Document& doc) {
+    int count = 0;
+    for (auto node : doc.get_content_types()->child("Types").children("Override")) {
+        if (std::strcmp(node.attribute("PartName").value(), "/docProps/custom.xml") == 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+TEST(CustomPropertiesTest, ValuesKeepTheirTypes) {
+    TempDoc temp_doc("test_custom_types.docx");
+    const std::time_t stamp = 1767225600;  // 2026-01-01T00:00:00Z
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto& props = doc.get_custom_document_properties();
+        props.set_custom("Client", "ACME & Sons");
+        props.set_custom("Revision", 42);
+        props.set_custom("Ratio", 0.1);
+        props.set_custom("Approved", true);
+        props.set_custom("Due", CustomProperty::FileTime{stamp});
+        doc.save();
+    }
+
+    std::map<std::string, int> pids;
+    {
+        Document doc(temp_doc.path());
+        doc.open();
+        ASSERT_TRUE(doc.is_open());
+        const auto& props = doc.get_custom_document_properties();
+        ASSERT_EQ(props.get_custom_properties().size(), 5u);
+        EXPECT_EQ(std::get<std::string>(props.get_custom_property("Client")->value), "ACME & Sons");
+        EXPECT_EQ(std::get<int>(props.get_custom_property("Revision")->value), 42);
+        EXPECT_EQ(std::get<double>(props.get_custom_property("Ratio")->value), 0.1);
+        EXPECT_TRUE(std::get<bool>(props.get_custom_property("Approved")->value));
+        EXPECT_EQ(std::get<CustomProperty::FileTime>(props.get_custom_property("Due")->value).time,
+                  stamp);
+        EXPECT_EQ(props.get_custom("Revision"), "42");
+        EXPECT_EQ(props.get_custom("Due"), "2026-01-01T00:00:00Z");
+
+        auto root = doc.get_xml_part("docProps/custom.xml")->child("Properties");
+        for (auto prop : root.children("property")) {
+            pids[prop.attribute("name").value()] = prop.attribute("pid").as_int();
+        }
+        EXPECT_STREQ(root.find_child_by_attribute("name", "Revision").first_child().name(),
+                     "vt:i4");
+
+        // A property added after loading takes the next pid; the others keep theirs
+        doc.get_custom_document_properties().set_custom("Pages", 7);
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    const auto& props = doc.get_custom_document_properties();
+    for (const auto& [name, pid] : pids) {
+        EXPECT_EQ(props.get_custom_property(name)->pid, pid) << name;
+    }
+    EXPECT_EQ(props.get_custom_property("Pages")->pid, 7);
+    EXPECT_EQ(count_custom_overrides(doc), 1);
+}
+
+TEST(CustomPropertiesTest, DoublesAreFiniteDecimalText) {
+    TempDoc temp_doc("test_custom_doubles.docx");
+    const double third = 1.0 / 3.0;
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto& props = doc.get_custom_document_properties();
+        EXPECT_TRUE(props.set_custom("Ratio", 0.1));
+        EXPECT_TRUE(props.set_custom("Third", third));
+        EXPECT_TRUE(props.set_custom("Large", -1.5e300));
+        EXPECT_EQ(props.get_custom("Ratio"), "0.1");
+        EXPECT_EQ(props.get_custom("Large"), "-1.5e+300");
+        EXPECT_EQ(std::strtod(props.get_custom("Third").c_str(), nullptr), third);
+
+        // nan and inf have no vt:r8 text, so the previous value stays
+        EXPECT_FALSE(props.set_custom("Ratio", std::numeric_limits<double>::infinity()));
+        EXPECT_FALSE(props.set_custom("Missing", std::numeric_limits<double>::quiet_NaN()));
+        EXPECT_EQ(props.get_custom("Ratio"), "0.1");
+        EXPECT_FALSE(props.has_custom("Missing"));
+        doc.save();
+    }
+
+    {
+        Document doc(temp_doc.path());
+        doc.open();
+        ASSERT_TRUE(doc.is_open());
+        const auto& props = doc.get_custom_document_properties();
+        EXPECT_EQ(std::get<double>(props.get_custom_property("Third")->value), third);
+        EXPECT_EQ(std::get<double>(props.get_custom_property("Large")->value), -1.5e300);
+
+        // A non-finite vt:r8 written by another producer is kept as text
+        auto root = doc.get_xml_part("docProps/custom.xml")->child("Properties");
+        root.find_child_by_attribute("name", "Ratio").child("vt:r8").text().set("INF");
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    const CustomProperty* ratio = doc.get_custom_document_properties().get_custom_property("Ratio");
+    ASSERT_NE(ratio, nullptr);
+    EXPECT_EQ(std::get<std::string>(ratio->value), "INF");
+}
+
+TEST(CustomPropertiesTest, IntegersOfEveryWidthAreStored) {
+    TempDoc temp_doc("test_custom_integers.docx");
+    const std::int64_t large = 5000000000;  // Above INT32_MAX
+    const std::vector<int> items(3);
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto& props = doc.get_custom_document_properties();
+        EXPECT_TRUE(props.set_custom("Bytes", large));
+        EXPECT_TRUE(props.set_custom("Offset", -large));
+        EXPECT_TRUE(props.set_custom("Count", items.size()));
+        EXPECT_TRUE(props.set_custom("Flags", 7u));
+        EXPECT_TRUE(props.set_custom("Ticks", 12L));
+        EXPECT_EQ(props.get_custom("Bytes"), "5000000000");
+
+        // Unsigned values above INT64_MAX have no vt:i8 and are refused
+        EXPECT_FALSE(props.set_custom("Huge", std::numeric_limits<std::uint64_t>::max()));
+        EXPECT_FALSE(props.has_custom("Huge"));
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    const auto& props = doc.get_custom_document_properties();
+    EXPECT_EQ(std::get<std::int64_t>(props.get_custom_property("Bytes")->value), large);
+    EXPECT_EQ(std::get<std::int64_t>(props.get_custom_property("Offset")->value), -large);
+    EXPECT_EQ(std::get<int>(props.get_custom_property("Count")->value), 3);
+    EXPECT_EQ(std::get<int>(props.get_custom_property("Flags")->value), 7);
+    EXPECT_EQ(std::get<int>(props.get_custom_property("Ticks")->value), 12);
+
+    // Only values outside the int range need vt:i8
+    auto root = doc.get_xml_part("docProps/custom.xml")->child("Properties");
+    EXPECT_STREQ(root.find_child_by_attribute("name", "Bytes").first_child().name(), "vt:i8");
+    EXPECT_STREQ(root.find_child_by_attribute("name", "Count").first_child().name(), "vt:i4");
+}
+
+TEST(CustomPropertiesTest, SyncRewritesOnlyChangedProperties) {
+    TempDoc temp_doc("test_custom_incremental.docx");
+    Document doc(temp_doc.path());
+    ASSERT_TRUE(doc.create_empty());
+    auto& props = doc.get_custom_document_properties();
+    props.set_custom("A", "first");
+    props.set_custom("B", 1);
+    props.set_custom("C", false);
+    doc.sync_to_physical_tree();
+
+    auto root = doc.get_xml_part("docProps/custom.xml")->child("Properties");
+    const pugi::xml_node b = root.find_child_by_attribute("name", "B");
+    const pugi::xml_node b_value = b.first_child();
+    ASSERT_TRUE(b_value);
+
+    // Setting an equal value is not a change
+    props.set_custom("B", 1);
+    props.set_custom("A", "second");
+    props.remove_custom("C");
+    doc.sync_to_physical_tree();
+    EXPECT_EQ(root.find_child_by_attribute("name", "B").first_child(), b_value);
+    EXPECT_STREQ(root.find_child_by_attribute("name", "A").child_value("vt:lpwstr"), "second");
+    EXPECT_FALSE(root.find_child_by_attribute("name", "C"));
+
+    doc.save();
+    doc.save();
+    Document reopened(temp_doc.path());
+    reopened.open();
+    ASSERT_TRUE(reopened.is_open());
+    EXPECT_EQ(count_custom_overrides(reopened), 1);
+    EXPECT_EQ(reopened.get_custom_document_properties().get_custom("A"), "second");
+
+    // Without custom properties the part and its registration go away
+    reopened.get_custom_document_properties().clear_custom();
+    reopened.save();
+    Document cleared(temp_doc.path());
+    cleared.open();
+    ASSERT_TRUE(cleared.is_open());
+    EXPECT_TRUE(cleared.get_custom_document_properties().get_custom_properties().empty());
+    EXPECT_EQ(count_custom_overrides(cleared), 0);
+    EXPECT_TRUE(cleared.find_relationship_id("_rels/.rels", "docProps/custom.xml").empty());
+}
+
+TEST(CustomPropertiesTest, DISABLED_StampingBenchmark) {
+    constexpr int kProperties = 1000;
+    constexpr int kDocuments = 100;
+    constexpr int kStamps = 10000;
+    auto stamp = [](DocumentProperties& props, int document) {
+        for (int i = 0; i < kProperties; ++i) {
+            const std::string name = "Field" + std::to_string(i);
+            switch (i % 4) {
+                case 0: props.set_custom(name, "value " + std::to_string(document)); break;
+                case 1: props.set_custom(name, document * i); break;
+                case 2: props.set_custom(name, document / 3.0); break;
+                default: props.set_custom(name, (document & 1) != 0); break;
+            }
+        }
+    };
+
+    // Each document gets all properties, written once
+    TempDoc temp_doc("test_custom_bench.docx");
+    auto start = BenchmarkClock::now();
+    for (int d = 0; d < kDocuments; ++d) {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        stamp(doc.get_custom_document_properties(), d);
+        doc.save();
+    }
+    RecordProperty("stamp_documents_us", elapsed_micros(start));
+
+    // Re-stamping a loaded document only rewrites the properties whose value changed
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    ASSERT_EQ(doc.get_custom_document_properties().get_custom_properties().size(),
+              static_cast<size_t>(kProperties));
+    start = BenchmarkClock::now();
+    for (int s = 0; s < kStamps; ++s) {
+        doc.get_custom_document_properties().set_custom("Field1", s);
+        doc.sync_to_physical_tree();
+    }
+    RecordProperty("incremental_sync_us", elapsed_micros(start));
+    EXPECT_EQ(doc.get_custom_document_properties().get_custom("Field1"),
+              std::to_string(kStamps - 1));
+}
@@ -8,11 +8,17 @@
 #include <cdocx.h>
 #include "../test_helpers.h"
 #include <cdocx/advanced.h>
+#include <cdocx/format_context.h>
+#include <algorithm>
 #include <filesystem>
+#include <iterator>
+#include <random>
 
 using namespace cdocx;
 namespace fs = std::filesystem;
+using cdocx::test::BenchmarkClock;
 using cdocx::test::TempDoc;
+using cdocx::test::elapsed_micros;
 
 static std::string find_text_in_paragraphs(const ParagraphCollection& paras) {
     std::string all_text;
@@ -252,6 +258,33 @@ TEST(DocumentBuilderTest, WriteAndFormat) {
     doc2.close();
 }
 
+TEST(DocumentBuilderTest, WriteHandlesControlCharacters) {
+    TempDoc temp_doc("test_builder_control_chars.docx");
+    Document doc("test_builder_control_chars.docx");
+    ASSERT_TRUE(doc.create_empty());
+
+    DocumentBuilder builder(&doc);
+    builder.write("Name:\tValue\r\nLine 1\vLine 2" + ControlChar::page_break() + "End");
+
+    doc.sync_from_physical_tree();
+    doc.save();
+
+    Document doc2("test_builder_control_chars.docx");
+    doc2.open();
+
+    std::vector<std::string> texts;
+    for (const auto& para : doc2.get_paragraphs()) {
+        if (para && !para->get_text().empty()) {
+            texts.push_back(para->get_text());
+        }
+    }
+    ASSERT_EQ(texts.size(), 2u);
+    EXPECT_EQ(texts[0], "Name:\tValue");
+    EXPECT_EQ(texts[1], "Line 1\vLine 2\fEnd");
+
+    doc2.close();
+}
+
 TEST(DocumentBuilderTest, TableBuilding) {
     TempDoc temp_doc("test_builder_table.docx");
     Document doc("test_builder_table.docx");
@@ -417,6 +450,162 @@ TEST(ParagraphBuilderTest, InitialTextConstructor) {
     EXPECT_EQ(para->get_text(), "Initial text");
 }
 
+TEST(ParagraphBuilderTest, BuildXmlWritesRunPropertiesInSchemaOrder) {
+    pugi::xml_document xml;
+    pugi::xml_node body = xml.append_child("w:body");
+    pugi::xml_node p = cdocx::ParagraphBuilder()
+        .add_run("plain ")
+        .set_bold(true)
+        .set_italic(true)
+        .set_underline(true)
+        .set_font_name("Arial")
+        .set_font_size(14)
+        .set_color("FF0000")
+        .add_run("formatted")
+        .set_alignment("justify")
+        .build(body);
+
+    ASSERT_TRUE(p);
+    EXPECT_STREQ(p.child("w:pPr").child("w:jc").attribute("w:val").value(), "both");
+    auto runs = p.children("w:r");
+    ASSERT_EQ(std::distance(runs.begin(), runs.end()), 2);
+    EXPECT_FALSE(runs.begin()->child("w:rPr"));
+    pugi::xml_node run = p.last_child();
+    EXPECT_STREQ(run.child_value("w:t"), "formatted");
+    EXPECT_EQ(run.first_child(), run.child("w:rPr"));
+
+    std::vector<std::string> order;
+    for (pugi::xml_node child : run.child("w:rPr").children()) {
+        order.emplace_back(child.name());
+    }
+    EXPECT_EQ(order, (std::vector<std::string>{"w:rFonts", "w:b", "w:i", "w:color", "w:sz",
+                                               "w:szCs", "w:u"}));
+    EXPECT_STREQ(run.child("w:rPr").child("w:sz").attribute("w:val").value(), "28");
+}
+
+TEST(ParagraphBuilderTest, ApplyRoundTripsEveryPropertyInSchemaOrder) {
+    // Order of the CT_RPr children in the WordprocessingML schema
+    const std::vector<std::string> schema_order = {
+        "w:rStyle", "w:rFonts", "w:b", "w:bCs", "w:i", "w:iCs", "w:caps", "w:smallCaps",
+        "w:strike", "w:dstrike", "w:outline", "w:shadow", "w:emboss", "w:imprint",
+        "w:noProof", "w:snapToGrid", "w:vanish", "w:webHidden", "w:color", "w:spacing",
+        "w:w", "w:kern", "w:position", "w:sz", "w:szCs", "w:highlight", "w:u", "w:effect",
+        "w:bdr", "w:shd", "w:fitText", "w:vertAlign", "w:rtl", "w:cs", "w:em", "w:lang"};
+
+    TextProperties props;
+    props.font = TextProperties::Font{"Arial", "SimHei"};
+    props.font_style.bold = true;
+    props.font_style.italic = true;
+    props.font_size = 28;
+    props.color = "00FF00";
+    props.underline.style = TextProperties::UnderlineStyle::Wave;
+    props.underline.color = "0000FF";
+    props.strike = TextProperties::StrikeStyle::Double;
+    props.vert_align = TextProperties::VertAlign::Superscript;
+    props.highlight = TextProperties::Highlight::Yellow;
+    props.scale = 150;
+    props.spacing = {TextProperties::SpacingType::Condensed, 20};
+    props.position = {TextProperties::PositionType::Raised, 6};
+
+    // Existing properties are replaced, a style reference is kept in front
+    pugi::xml_document xml;
+    pugi::xml_node run = xml.append_child("w:r");
+    run.append_child("w:t").text().set("text");
+    TextFormatContext::apply_color(run, "123456");
+    TextFormatContext::apply_font_size(run, 20);
+    run.child("w:rPr").prepend_child("w:rStyle").append_attribute("w:val").set_value("Emphasis");
+    ASSERT_TRUE(TextFormatContext::apply(run, props));
+
+    ASSERT_EQ(run.first_child(), run.child("w:rPr"));
+    size_t last = 0;
+    std::vector<std::string> names;
+    for (pugi::xml_node child : run.child("w:rPr").children()) {
+        names.emplace_back(child.name());
+        auto pos = std::find(schema_order.begin(), schema_order.end(), child.name());
+        ASSERT_NE(pos, schema_order.end()) << child.name();
+        const size_t index = static_cast<size_t>(pos - schema_order.begin());
+        EXPECT_GE(index, last) << child.name() << " is out of schema order";
+        last = index;
+    }
+    EXPECT_EQ(names.size(), 14u);
+    EXPECT_EQ(names.front(), "w:rStyle");
+
+    const TextProperties read = TextProperties::extract_from(run);
+    ASSERT_TRUE(read.font.has_value());
+    EXPECT_EQ(read.font->ascii, "Arial");
+    EXPECT_EQ(read.font->east_asia, "SimHei");
+    EXPECT_TRUE(read.font_style.bold);
+    EXPECT_TRUE(read.font_style.italic);
+    EXPECT_EQ(read.font_size, 28);
+    EXPECT_EQ(read.color, "00FF00");
+    EXPECT_EQ(read.underline.style, TextProperties::UnderlineStyle::Wave);
+    EXPECT_EQ(read.underline.color, "0000FF");
+    EXPECT_EQ(read.strike, TextProperties::StrikeStyle::Double);
+    EXPECT_EQ(read.vert_align, TextProperties::VertAlign::Superscript);
+    EXPECT_EQ(read.highlight, TextProperties::Highlight::Yellow);
+    EXPECT_EQ(read.scale, 150);
+    EXPECT_EQ(read.spacing.type, TextProperties::SpacingType::Condensed);
+    EXPECT_EQ(read.spacing.value, 20);
+    EXPECT_EQ(read.position.type, TextProperties::PositionType::Raised);
+    EXPECT_EQ(read.position.value, 6);
+
+    // Applying nothing leaves no empty w:rPr behind
+    ASSERT_TRUE(TextFormatContext::apply(xml.append_child("w:r"), TextProperties{}));
+    EXPECT_FALSE(xml.last_child().child("w:rPr"));
+    EXPECT_FALSE(TextFormatContext::apply(pugi::xml_node(), props));
+}
+
+TEST(ParagraphBuilderTest, DISABLED_MillionFormattedRunsBenchmark) {
+    constexpr int kRuns = 1000000;
+    constexpr int kRunsPerParagraph = 1000;
+    constexpr int kParagraphsPerDocument = 10;
+
+    // One property at a time, each call looking its element up again
+    auto start = BenchmarkClock::now();
+    int written = 0;
+    for (int i = 0; i < kRuns / (kRunsPerParagraph * kParagraphsPerDocument); ++i) {
+        pugi::xml_document xml;
+        pugi::xml_node body = xml.append_child("w:body");
+        for (int j = 0; j < kParagraphsPerDocument; ++j) {
+            pugi::xml_node p = body.append_child("w:p");
+            for (int k = 0; k < kRunsPerParagraph; ++k) {
+                pugi::xml_node run = p.append_child("w:r");
+                TextFormatContext::apply_font_name(run, "Arial");
+                TextFormatContext::apply_bold(run, true);
+                TextFormatContext::apply_italic(run, (k & 1) != 0);
+                TextFormatContext::apply_color(run, "FF0000");
+                TextFormatContext::apply_font_size(run, 24);
+                TextFormatContext::apply_underline(run, true);
+                run.append_child("w:t").text().set("text");
+                ++written;
+            }
+        }
+    }
+    RecordProperty("per_property_us", elapsed_micros(start));
+    EXPECT_EQ(written, kRuns);
+
+    // The builder writing each w:rPr in one pass
+    start = BenchmarkClock::now();
+    written = 0;
+    for (int i = 0; i < kRuns / (kRunsPerParagraph * kParagraphsPerDocument); ++i) {
+        pugi::xml_document xml;
+        pugi::xml_node body = xml.append_child("w:body");
+        for (int j = 0; j < kParagraphsPerDocument; ++j) {
+            cdocx::ParagraphBuilder builder;
+            builder.set_font_name("Arial").set_bold(true).set_color("FF0000");
+            builder.set_font_size(12).set_underline(true);
+            for (int k = 0; k < kRunsPerParagraph; ++k) {
+                builder.set_italic((k & 1) != 0).add_run("text");
+            }
+            pugi::xml_node p = builder.build(body);
+            written += static_cast<int>(std::distance(p.children("w:r").begin(),
+                                                      p.children("w:r").end()));
+        }
+    }
+    RecordProperty("builder_xml_us", elapsed_micros(start));
+    EXPECT_EQ(written, kRuns);
+}
+
 // ============================================================================
 // Document::ensure_minimum Tests
 // ============================================================================
@@ -482,6 +671,349 @@ TEST(DocumentRangeTest, RangeReplaceAll) {
     doc2.close();
 }
 
+TEST(DocumentRangeTest, RangeReplaceKeepsRunFormatting) {
+    TempDoc temp_doc("test_range_replace_formatting.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto para = doc.get_first_section()->get_body()->append_paragraph("Dear ");
+        para->append_run("NAME")->set_bold(true);
+        para->append_run(", welcome ")->set_italic(true);
+        para->append_run("back");
+        doc.save();
+    }
+    {
+        Document doc(temp_doc.path());
+        doc.open();
+        auto range = doc.get_range();
+        EXPECT_EQ(range.replace_all("NAME", "Alice"), 1);
+        // A match across runs is cut from each; the replacement takes the first run's format
+        EXPECT_TRUE(range.replace("welcome back", "hello"));
+        EXPECT_EQ(range.get_text(), "Dear Alice, hello");
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    auto runs = doc.get_first_section()->get_body()->get_last_paragraph()->get_runs();
+    ASSERT_EQ(runs.get_count(), 3u);
+    EXPECT_EQ(runs[0]->get_text(), "Dear ");
+    EXPECT_FALSE(runs[0]->get_font().bold);
+    EXPECT_EQ(runs[1]->get_text(), "Alice");
+    EXPECT_TRUE(runs[1]->get_font().bold);
+    EXPECT_FALSE(runs[1]->get_font().italic);
+    EXPECT_EQ(runs[2]->get_text(), ", hello");
+    EXPECT_TRUE(runs[2]->get_font().italic);
+}
+
+TEST(DocumentRangeTest, DISABLED_RangeReplaceAllTenThousandHits) {
+    TempDoc temp_doc("test_range_replace_bench.docx");
+    constexpr int kHits = 10000;
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto para = doc.get_first_section()->get_body()->append_paragraph();
+        for (int i = 0; i < kHits / 100; ++i) {
+            std::string text;
+            for (int j = 0; j < 100; ++j) {
+                text += "item; ";
+            }
+            para->append_run(std::move(text))->set_bold(i % 2 == 0);
+        }
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    auto range = doc.get_range();
+    const auto start = BenchmarkClock::now();
+    EXPECT_EQ(range.replace_all("item", "entry"), kHits);
+    RecordProperty("replace_all_us", elapsed_micros(start));
+
+    const std::string text = range.get_text();
+    EXPECT_EQ(text.find("item"), std::string::npos);
+    EXPECT_EQ(text.size(), static_cast<size_t>(kHits) * std::string("entry; ").size());
+}
+
+TEST(DocumentRangeTest, RangeAppliesFormattingInOnePass) {
+    TempDoc temp_doc("test_range_bulk_format.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        body->append_paragraph("First ")->append_run("emphasis")->set_italic(true);
+        body->append_paragraph("Second");
+        doc.save();
+    }
+    {
+        Document doc(temp_doc.path());
+        doc.open();
+        auto range = doc.get_range();
+        TextProperties text;
+        text.font_style.bold = true;
+        text.color = "FF0000";
+        EXPECT_GE(range.apply_text_properties(text), 3);
+        // Applying again replaces the elements instead of repeating them
+        EXPECT_GE(range.apply_text_properties(text), 3);
+        ParagraphProperties para;
+        para.align = ParagraphProperties::Alignment::Centered;
+        EXPECT_GE(range.apply_paragraph_properties(para), 2);
+
+        int runs = 0;
+        const int visited = range.for_each_run([&](pugi::xml_node run) {
+            EXPECT_TRUE(run.child("w:rPr").child("w:b"));
+            EXPECT_FALSE(run.child("w:rPr").child("w:b").next_sibling("w:b"));
+            ++runs;
+        });
+        EXPECT_EQ(visited, runs);
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    std::shared_ptr<Paragraph> first;
+    for (const auto& para : doc.get_first_section()->get_body()->get_paragraphs()) {
+        if (para->get_text() == "First emphasis") {
+            first = para;
+        }
+    }
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->get_paragraph_format().alignment, ParagraphAlignment::Center);
+    auto runs = first->get_runs();
+    ASSERT_EQ(runs.get_count(), 2u);
+    EXPECT_TRUE(runs[0]->get_font().bold);
+    EXPECT_TRUE(runs[1]->get_font().bold);
+    EXPECT_TRUE(runs[1]->get_font().italic);
+    EXPECT_EQ(runs[1]->get_font().color, Color::from_hex("FF0000"));
+}
+
+TEST(DocumentRangeTest, RangeClearsDirectFormatting) {
+    TempDoc temp_doc("test_range_clear_format.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto para = doc.get_first_section()->get_body()->append_paragraph("Plain ");
+        para->get_paragraph_format().style_name = "Heading1";
+        para->get_paragraph_format().alignment = ParagraphAlignment::Right;
+        auto run = para->append_run("loud");
+        run->set_bold(true);
+        run->set_italic(true);
+        doc.save();
+    }
+    {
+        Document doc(temp_doc.path());
+        doc.open();
+        EXPECT_GE(doc.get_range().clear_direct_formatting(), 1);
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    auto para = doc.get_first_section()->get_body()->get_last_paragraph();
+    EXPECT_EQ(para->get_paragraph_format().style_name, "Heading1");
+    EXPECT_EQ(para->get_paragraph_format().alignment, ParagraphAlignment::Left);
+    auto runs = para->get_runs();
+    ASSERT_EQ(runs.get_count(), 2u);
+    EXPECT_FALSE(runs[1]->get_font().bold);
+    EXPECT_FALSE(runs[1]->get_font().italic);
+}
+
+TEST(DocumentRangeTest, DISABLED_RangeBulkFormattingBenchmark) {
+    TempDoc temp_doc("test_range_bulk_bench.docx");
+    constexpr int kParagraphs = 50000;
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        for (int i = 0; i < kParagraphs; ++i) {
+            body->append_paragraph("Paragraph ")->append_run(std::to_string(i));
+        }
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+
+    auto start = BenchmarkClock::now();
+    TextProperties text;
+    text.font_style.bold = true;
+    EXPECT_GE(doc.get_range().apply_text_properties(text), 2 * kParagraphs);
+    RecordProperty("range_apply_us", elapsed_micros(start));
+
+    start = BenchmarkClock::now();
+    int runs = 0;
+    for (const auto& para : doc.get_paragraphs()) {
+        for (const auto& run : para->get_runs()) {
+            run->set_italic(true);
+            ++runs;
+        }
+    }
+    EXPECT_GE(runs, 2 * kParagraphs);
+    RecordProperty("paragraph_loop_us", elapsed_micros(start));
+}
+
+TEST(DocumentRangeTest, OffsetRangeEndsInsideRuns) {
+    TempDoc temp_doc("test_range_offsets.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        auto para = body->append_paragraph("Hello ");
+        para->append_run("bold")->set_bold(true);
+        para->append_run(" world");
+        body->append_paragraph("Second line");
+        doc.save();
+    }
+    {
+        Document doc(temp_doc.path());
+        doc.open();
+        ASSERT_EQ(doc.get_range().get_text(), "Hello bold worldSecond line");
+        EXPECT_EQ(Range::from_offsets(doc, 8, 13).get_text(), "ld wo");
+        EXPECT_EQ(Range::from_offsets(doc, 13, 19).get_text(), "rldSec");
+        EXPECT_EQ(Range::from_offsets(doc, 16, 16).get_text(), "");
+        EXPECT_EQ(Range::from_offsets(doc, 20, 1000).get_text(), "nd line");
+        EXPECT_FALSE(Range::from_offsets(doc, 5, 4).is_valid());
+
+        // Only matches inside the range are replaced, and its end moves with them
+        auto head = Range::from_offsets(doc, 0, 10);
+        EXPECT_EQ(head.replace_all("o", "00"), 2);
+        EXPECT_EQ(head.get_text(), "Hell00 b00ld");
+        EXPECT_EQ(doc.get_range().get_text(), "Hell00 b00ld worldSecond line");
+
+        // The index is rebuilt after the edit
+        auto span = Range::from_offsets(doc, 15, 21);
+        EXPECT_EQ(span.get_text(), "rldSec");
+        EXPECT_TRUE(span.delete_content());
+        EXPECT_EQ(span.get_text(), "");
+        EXPECT_EQ(doc.get_range().get_text(), "Hell00 b00ld woond line");
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    auto paras = doc.get_first_section()->get_body()->get_paragraphs();
+    ASSERT_GE(paras.size(), 2u);
+    EXPECT_EQ(paras.back()->get_text(), "ond line");
+    auto runs = paras[paras.size() - 2]->get_runs();
+    ASSERT_EQ(runs.get_count(), 3u);
+    EXPECT_EQ(runs[1]->get_text(), "b00ld");
+    EXPECT_TRUE(runs[1]->get_font().bold);
+    EXPECT_EQ(runs[2]->get_text(), " wo");
+    EXPECT_FALSE(runs[2]->get_font().bold);
+}
+
+TEST(DocumentRangeTest, RandomOffsetRangesMatchText) {
+    TempDoc temp_doc("test_range_offsets_random.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        for (int i = 0; i < 200; ++i) {
+            auto para = body->append_paragraph("Paragraph " + std::to_string(i) + ". ");
+            para->append_run("Run " + std::to_string(i))->set_bold(i % 2 == 0);
+        }
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    const std::string text = doc.get_range().get_text();
+    std::mt19937 random(7);
+    std::uniform_int_distribution<size_t> offset(0, text.size());
+    for (int i = 0; i < 200; ++i) {
+        size_t begin = offset(random);
+        size_t end = offset(random);
+        if (begin > end) {
+            std::swap(begin, end);
+        }
+        EXPECT_EQ(Range::from_offsets(doc, begin, end).get_text(),
+                  text.substr(begin, end - begin));
+    }
+}
+
+TEST(DocumentRangeTest, OffsetsCountCharacters) {
+    TempDoc temp_doc("test_range_offsets_utf8.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        auto para = body->append_paragraph("你好 world");
+        para->append_run("世界")->set_bold(true);
+        body->append_paragraph("第二行");
+        doc.save();
+    }
+    {
+        Document doc(temp_doc.path());
+        doc.open();
+        ASSERT_EQ(doc.get_range().get_text(), "你好 world世界第二行");
+
+        // As byte offsets, 1 and 10 would both fall inside a three-byte character
+        EXPECT_EQ(Range::from_offsets(doc, 1, 10).get_text(), "好 world世界");
+        EXPECT_EQ(Range::from_offsets(doc, 9, 11).get_text(), "界第");
+        EXPECT_EQ(Range::from_offsets(doc, 12, 1000).get_text(), "行");
+
+        auto bold = Range::from_offsets(doc, 8, 10);
+        EXPECT_TRUE(bold.replace("世", "大"));
+        EXPECT_EQ(bold.get_text(), "大界");
+
+        auto cut = Range::from_offsets(doc, 1, 2);
+        EXPECT_TRUE(cut.delete_content());
+        EXPECT_TRUE(Range::from_offsets(doc, 9, 11).delete_content());
+        EXPECT_EQ(doc.get_range().get_text(), "你 world大界行");
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    auto paras = doc.get_first_section()->get_body()->get_paragraphs();
+    ASSERT_GE(paras.size(), 2u);
+    EXPECT_EQ(paras.back()->get_text(), "行");
+    auto runs = paras[paras.size() - 2]->get_runs();
+    ASSERT_EQ(runs.get_count(), 2u);
+    EXPECT_EQ(runs[0]->get_text(), "你 world");
+    EXPECT_EQ(runs[1]->get_text(), "大界");
+    EXPECT_TRUE(runs[1]->get_font().bold);
+}
+
+TEST(DocumentRangeTest, DISABLED_OffsetResolutionBenchmark) {
+    TempDoc temp_doc("test_range_offsets_bench.docx");
+    constexpr int kParagraphs = 10000;
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        for (int i = 0; i < kParagraphs; ++i) {
+            body->append_paragraph("Paragraph " + std::to_string(i) + ". ");
+        }
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    const std::string text = doc.get_range().get_text();
+    std::mt19937 random(42);
+    std::uniform_int_distribution<size_t> offset(0, text.size());
+
+    const auto start = BenchmarkClock::now();
+    size_t resolved = 0;
+    for (int i = 0; i < 100000; ++i) {
+        const size_t begin = offset(random);
+        resolved += Range::from_offsets(doc, begin, begin).is_valid() ? 1 : 0;
+    }
+    RecordProperty("resolve_100k_us", elapsed_micros(start));
+    EXPECT_EQ(resolved, 100000u);
+
+    for (int i = 0; i < 20; ++i) {
+        size_t begin = offset(random);
+        size_t end = offset(random);
+        if (begin > end) {
+            std::swap(begin, end);
+        }
+        EXPECT_EQ(Range::from_offsets(doc, begin, end).get_text(),
+                  text.substr(begin, end - begin));
+    }
+}
+
 // ============================================================================
 // ConvertUtil Tests
 // ============================================================================
@@ -321,3 +321,101 @@ TEST(MailMergeTest, MultipleParagraphsMerge) {
     EXPECT_NE(text.find("Score: 88"), std::string::npos);
 
 }
+
+TEST(MailMergeTest, SingleDocumentOneSectionPerRecord) {
+    TempDoc temp_doc("test_mail_single_tpl.docx");
+    TempDoc out_doc("test_mail_single_out.docx");
+    Document doc("test_mail_single_tpl.docx");
+    ASSERT_TRUE(doc.create_empty());
+
+    auto body = doc.get_first_section()->get_body();
+    body->remove_all_children();
+    auto para = body->append_paragraph("Dear ");
+    auto field = std::make_shared<Field>(&doc, FieldType::MergeField);
+    field->set_field_code("MERGEFIELD Name \\* MERGEFORMAT");
+    para->append_child(field);
+    body->append_paragraph("Regards");
+
+    std::vector<std::map<std::string, std::string>> records = {
+        {{"Name", "Alice"}}, {{"name", "Bob & Co"}}, {{"NAME", "Carol"}}};
+
+    MailMerge mail_merge(&doc);
+    EXPECT_EQ(mail_merge.execute_to_single_document("test_mail_single_out.docx", records), 3);
+
+    Document merged("test_mail_single_out.docx");
+    merged.open();
+    ASSERT_TRUE(merged.is_open());
+    // Records 1..n-1 end with a paragraph-level section break
+    auto* xml = merged.get_document_xml();
+    ASSERT_NE(xml, nullptr);
+    EXPECT_EQ(xml->select_nodes("//w:body/w:p/w:pPr/w:sectPr").size(), 2u);
+    EXPECT_EQ(xml->select_nodes("//w:body/w:sectPr").size(), 1u);
+
+    const auto text = merged.get_text();
+    EXPECT_NE(text.find("Dear Alice"), std::string::npos);
+    EXPECT_NE(text.find("Dear Bob & Co"), std::string::npos);
+    EXPECT_NE(text.find("Dear Carol"), std::string::npos);
+
+    // The template itself is left untouched
+    MailMerge template_merge(&doc);
+    EXPECT_EQ(template_merge.get_field_names().size(), 1u);
+}
+
+TEST(MailMergeTest, SingleDocumentStreamsFromProvider) {
+    TempDoc temp_doc("test_mail_stream_tpl.docx");
+    TempDoc out_doc("test_mail_stream_out.docx");
+    Document doc("test_mail_stream_tpl.docx");
+    ASSERT_TRUE(doc.create_empty());
+
+    auto body = doc.get_first_section()->get_body();
+    body->remove_all_children();
+    auto para = body->append_paragraph("Item ");
+    auto field = std::make_shared<Field>(&doc, FieldType::MergeField);
+    field->set_field_code("MERGEFIELD Index");
+    para->append_child(field);
+
+    // Optional line, dropped when the record has no value for it
+    auto optional = body->append_paragraph();
+    auto note = std::make_shared<Field>(&doc, FieldType::MergeField);
+    note->set_field_code("MERGEFIELD Note");
+    optional->append_child(note);
+
+    const int kRecords = 200;
+    int produced = 0;
+    MailMerge mail_merge(&doc);
+    mail_merge.set_cleanup_options(MailMergeCleanupOptions::RemoveEmptyParagraphs);
+    mail_merge.set_record_break_type(BreakType::SectionBreakContinuous);
+    const int written = mail_merge.execute_to_single_document(
+        "test_mail_stream_out.docx", [&](std::map<std::string, std::string>& record) {
+            if (produced == kRecords) {
+                return false;
+            }
+            record["Index"] = std::to_string(produced);
+            if (produced == 7) {
+                record["Note"] = "special";
+            }
+            ++produced;
+            return true;
+        });
+    EXPECT_EQ(written, kRecords);
+
+    Document merged("test_mail_stream_out.docx");
+    merged.open();
+    ASSERT_TRUE(merged.is_open());
+    auto* xml = merged.get_document_xml();
+    ASSERT_NE(xml, nullptr);
+    const auto breaks = xml->select_nodes("//w:pPr/w:sectPr/w:type");
+    ASSERT_EQ(breaks.size(), static_cast<size_t>(kRecords - 1));
+    EXPECT_STREQ(breaks.first().node().attribute("w:val").value(), "continuous");
+
+    // Only record 7 keeps the optional paragraph; the others end with an
+    // empty section break paragraph
+    EXPECT_EQ(xml->select_nodes("//w:body/w:p[not(w:pPr/w:sectPr)]").size(),
+              static_cast<size_t>(kRecords));
+    EXPECT_EQ(xml->select_nodes("//w:body/w:p[w:pPr/w:sectPr][w:r]").size(), 1u);
+
+    const auto text = merged.get_text();
+    EXPECT_NE(text.find("Item 0"), std::string::npos);
+    EXPECT_NE(text.find("Item 199"), std::string::npos);
+    EXPECT_NE(text.find("special"), std::string::npos);
+}
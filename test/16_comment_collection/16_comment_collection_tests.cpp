@@ -7,10 +7,18 @@
 #include <gtest/gtest.h>
 #include <cdocx.h>
 #include "../test_helpers.h"
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
 
 namespace fs = std::filesystem;
+using cdocx::test::BenchmarkClock;
 using cdocx::test::TempDoc;
+using cdocx::test::elapsed_micros;
 using namespace cdocx;
 
 TEST(CommentCollectionTest, EmptyDocument) {
@@ -252,3 +260,272 @@ TEST(CommentCollectionTest, MultipleCommentsSameAuthor) {
         EXPECT_EQ(bob_count, 1);
     }
 }
+
+TEST(CommentCollectionTest, EditAfterSaveIsPersisted) {
+    TempDoc temp("test_comments_edit_after_save.docx");
+
+    {
+        Document doc(temp.path());
+        ASSERT_TRUE(doc.create_empty());
+        for (int i = 0; i < 100; ++i) {
+            doc.add_comment("Reviewer", "Comment " + std::to_string(i));
+        }
+        doc.save();
+
+        // Attribute-only change on an already synced comment
+        auto c = doc.get_comment(42);
+        ASSERT_NE(c, nullptr);
+        c->set_author("Editor");
+        doc.save();
+
+        size_t comment_rels = 0;
+        auto* rels = doc.get_xml_part("word/_rels/document.xml.rels");
+        ASSERT_NE(rels, nullptr);
+        for (auto rel : rels->child("Relationships").children("Relationship")) {
+            if (std::string(rel.attribute("Target").value()) == "comments.xml") {
+                ++comment_rels;
+            }
+        }
+        EXPECT_EQ(comment_rels, 1u);
+    }
+
+    {
+        Document doc(temp.path());
+        doc.open();
+        ASSERT_TRUE(doc.is_open());
+        EXPECT_EQ(doc.get_comments().count(), 100u);
+
+        auto c = doc.get_comment(42);
+        ASSERT_NE(c, nullptr);
+        EXPECT_EQ(c->get_author(), "Editor");
+        EXPECT_EQ(c->get_text(), "Comment 42");
+        EXPECT_EQ(doc.get_comment(41)->get_author(), "Reviewer");
+    }
+}
+
+// ============================================================================
+// Comment Lookup
+// ============================================================================
+
+TEST(CommentCollectionTest, CollectionSeesDocumentChanges) {
+    Document doc("test_comments_view.docx");
+    ASSERT_TRUE(doc.create_empty());
+
+    auto comments = doc.get_comments();
+    auto first = doc.add_comment("Alice", "First");
+    auto second = doc.add_comment("Bob", "Second");
+    ASSERT_EQ(comments.count(), 2u);
+    EXPECT_EQ(comments.get(0), first);
+    EXPECT_EQ(*(comments.begin() + 1), second);
+
+    doc.remove_comment(first->get_id());
+    ASSERT_EQ(comments.count(), 1u);
+    EXPECT_EQ(comments.get(0), second);
+    EXPECT_FALSE(comments.contains(first->get_id()));
+}
+
+TEST(CommentCollectionTest, DISABLED_LookupBenchmark) {
+    for (int count : {10000, 100000}) {
+        Document doc("test_comments_lookup.docx");
+        ASSERT_TRUE(doc.create_empty());
+        std::vector<int> ids;
+        ids.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            ids.push_back(doc.add_comment("Reviewer", "Comment " + std::to_string(i))->get_id());
+        }
+        std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+
+        const auto comments = doc.get_comments();
+        const auto start = BenchmarkClock::now();
+        int found = 0;
+        for (int id : ids) {
+            found += comments.get_by_id(id) && comments.contains(id) ? 1 : 0;
+        }
+        RecordProperty("lookup_" + std::to_string(count) + "_us", elapsed_micros(start));
+        EXPECT_EQ(found, count);
+    }
+}
+
+TEST(CommentCollectionTest, FormattingOnlyEditIsPersisted) {
+    TempDoc temp("test_comments_format_edit.docx");
+
+    {
+        Document doc(temp.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto c = doc.add_comment("Reviewer", "Plain text");
+        doc.save();
+
+        // Neither the text nor the structure changes, only a run's formatting
+        auto* para = dynamic_cast<Paragraph*>(c->get_children()[0].get());
+        ASSERT_NE(para, nullptr);
+        para->get_first_run()->set_bold(true);
+        doc.save();
+    }
+
+    Document doc(temp.path());
+    doc.open();
+    ASSERT_EQ(doc.get_comments().count(), 1u);
+    auto* para = dynamic_cast<Paragraph*>(doc.get_comments().get(0)->get_children()[0].get());
+    ASSERT_NE(para, nullptr);
+    EXPECT_TRUE(para->get_first_run()->get_font().bold);
+}
+
+TEST(CommentCollectionTest, SetIdRekeysComment) {
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    auto first = doc.add_comment("Alice", "First");
+    auto second = doc.add_comment("Bob", "Second");
+    const int old_id = first->get_id();
+
+    first->set_id(42);
+    EXPECT_EQ(doc.get_comment(42), first);
+    EXPECT_EQ(doc.get_comments().get_by_id(42), first);
+    EXPECT_EQ(doc.get_comment(old_id), nullptr);
+    EXPECT_EQ(doc.get_comment(second->get_id()), second);
+
+    EXPECT_TRUE(doc.remove_comment(42));
+    EXPECT_EQ(doc.get_comments().count(), 1u);
+    EXPECT_FALSE(doc.get_comments().contains(42));
+}
+
+// ============================================================================
+// Comment Anchors
+// ============================================================================
+
+namespace {
+
+/// Anchors of comment @p id (range start/end and reference) in word/document.xml
+int count_comment_anchors(Document& doc, int id) {
+    int count = 0;
+    std::function<void(pugi::xml_node)> visit = [&](pugi::xml_node node) {
+        for (auto child : node.children()) {
+            const std::string name = child.name();
+            if ((name == "w:commentRangeStart" || name == "w:commentRangeEnd" ||
+                 name == "w:commentReference") &&
+                child.attribute("w:id").as_int() == id) {
+                ++count;
+            }
+            visit(child);
+        }
+    };
+    visit(doc.get_document_xml()->document_element());
+    return count;
+}
+
+/// Saves a document with one anchored paragraph per comment author
+void save_anchored_comments(const std::string& path, const std::vector<std::string>& authors) {
+    Document doc(path);
+    ASSERT_TRUE(doc.create_empty());
+    auto body = doc.get_first_section()->get_body();
+    for (const auto& author : authors) {
+        auto comment = doc.add_comment(author, "Note by " + author);
+        auto para = body->append_paragraph();
+        para->append_child(std::make_shared<CommentRangeStart>(&doc, comment->get_id()));
+        para->append_run("Text commented by " + author);
+        para->append_child(std::make_shared<CommentRangeEnd>(&doc, comment->get_id()));
+    }
+    doc.save();
+}
+
+}  // namespace
+
+TEST(CommentCollectionTest, RemoveCommentStripsAnchors) {
+    TempDoc temp("test_comments_anchors.docx");
+    save_anchored_comments(temp.path(), {"Alice", "Bob", "Carol"});
+
+    {
+        Document doc(temp.path());
+        doc.open();
+        ASSERT_EQ(doc.get_comments().count(), 3u);
+        const int alice = doc.get_comments().get(0)->get_id();
+        const int bob = doc.get_comments().get(1)->get_id();
+        EXPECT_EQ(count_comment_anchors(doc, alice), 3);
+
+        EXPECT_TRUE(doc.remove_comment(alice));
+        auto comments = doc.get_comments();
+        EXPECT_TRUE(comments.remove_at(0));  // Bob
+        EXPECT_FALSE(comments.contains(bob));
+        doc.save();
+    }
+
+    Document doc(temp.path());
+    doc.open();
+    ASSERT_EQ(doc.get_comments().count(), 1u);
+    const int carol = doc.get_comments().get(0)->get_id();
+    for (int id = 0; id < carol; ++id) {
+        EXPECT_EQ(count_comment_anchors(doc, id), 0) << id;
+    }
+    EXPECT_EQ(count_comment_anchors(doc, carol), 3);
+    EXPECT_NE(doc.get_range().get_text().find("commented by Alice"), std::string::npos);
+}
+
+TEST(CommentCollectionTest, RemoveCommentsIfByAuthor) {
+    TempDoc temp("test_comments_remove_if.docx");
+    save_anchored_comments(temp.path(), {"Alice", "Bob", "Alice", "Carol", "Alice"});
+
+    {
+        Document doc(temp.path());
+        doc.open();
+        const int removed = doc.remove_comments_if(
+            [](const Comment& comment) { return comment.get_author() == "Alice"; });
+        EXPECT_EQ(removed, 3);
+        EXPECT_EQ(doc.get_comments().count(), 2u);
+        doc.save();
+    }
+
+    Document doc(temp.path());
+    doc.open();
+    auto comments = doc.get_comments();
+    ASSERT_EQ(comments.count(), 2u);
+    EXPECT_EQ(comments.get(0)->get_author(), "Bob");
+    EXPECT_EQ(comments.get(1)->get_author(), "Carol");
+    int anchors = 0;
+    for (int id = 0; id < 5; ++id) {
+        anchors += count_comment_anchors(doc, id);
+    }
+    EXPECT_EQ(anchors, 6);
+}
+
+TEST(CommentCollectionTest, ClearCommentsStripsAnchors) {
+    TempDoc temp("test_comments_clear_anchors.docx");
+    save_anchored_comments(temp.path(), {"Alice", "Bob"});
+
+    {
+        Document doc(temp.path());
+        doc.open();
+        doc.clear_comments();
+        doc.save();
+    }
+
+    Document doc(temp.path());
+    doc.open();
+    EXPECT_EQ(doc.get_comments().count(), 0u);
+    for (int id = 0; id < 2; ++id) {
+        EXPECT_EQ(count_comment_anchors(doc, id), 0) << id;
+    }
+}
+
+TEST(CommentCollectionTest, SetIdKeepsAnchorsOnSave) {
+    TempDoc temp("test_comments_set_id_anchors.docx");
+    save_anchored_comments(temp.path(), {"Alice", "Bob"});
+
+    int old_id = 0;
+    {
+        Document doc(temp.path());
+        doc.open();
+        ASSERT_EQ(doc.get_comments().count(), 2u);
+        auto alice = doc.get_comments().get(0);
+        old_id = alice->get_id();
+        alice->set_id(42);
+        doc.save();
+    }
+
+    Document doc(temp.path());
+    doc.open();
+    auto alice = doc.get_comment(42);
+    ASSERT_NE(alice, nullptr);
+    EXPECT_EQ(alice->get_author(), "Alice");
+    EXPECT_EQ(count_comment_anchors(doc, 42), 3);
+    EXPECT_EQ(count_comment_anchors(doc, old_id), 0);
+    EXPECT_EQ(count_comment_anchors(doc, doc.get_comments().get(1)->get_id()), 3);
+}
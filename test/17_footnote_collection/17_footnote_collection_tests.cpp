@@ -284,3 +284,175 @@ TEST(EndnoteCollectionTest, DocumentBuilderInsertsEndnote) {
         EXPECT_EQ(e->get_footnote_type(), FootnoteType::Endnote);
     }
 }
+
+// ============================================================================
+// Part Registration and Incremental Sync Tests
+// ============================================================================
+
+namespace {
+
+size_t count_relationships_to(Document& doc, const char* target) {
+    auto* rels = doc.get_xml_part("word/_rels/document.xml.rels");
+    if (!rels) {
+        return 0;
+    }
+    size_t count = 0;
+    for (auto rel : rels->child("Relationships").children("Relationship")) {
+        if (std::string(rel.attribute("Target").value()) == target) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+pugi::xml_node find_note_node(Document& doc, int id) {
+    auto* notes = doc.get_footnotes();
+    if (!notes) {
+        return pugi::xml_node();
+    }
+    return notes->child("w:footnotes").find_child_by_attribute("w:footnote", "w:id",
+                                                               std::to_string(id).c_str());
+}
+
+}  // namespace
+
+TEST(FootnoteCollectionTest, ManyFootnotesRegisterPartOnce) {
+    TempDoc temp("test_footnotes_register_once.docx");
+
+    {
+        Document doc(temp.path());
+        ASSERT_TRUE(doc.create_empty());
+        for (int i = 0; i < 200; ++i) {
+            doc.add_footnote("Note " + std::to_string(i));
+            doc.add_endnote("End " + std::to_string(i));
+        }
+        doc.save();
+
+        EXPECT_EQ(count_relationships_to(doc, "footnotes.xml"), 1u);
+        EXPECT_EQ(count_relationships_to(doc, "endnotes.xml"), 1u);
+    }
+
+    {
+        Document doc(temp.path());
+        doc.open();
+        ASSERT_TRUE(doc.is_open());
+        EXPECT_EQ(doc.footnotes().count(), 200u);
+        EXPECT_EQ(doc.endnotes().count(), 200u);
+
+        // Adding to a loaded document reuses the existing registration
+        doc.add_footnote("One more");
+        doc.save();
+        EXPECT_EQ(count_relationships_to(doc, "footnotes.xml"), 1u);
+    }
+}
+
+TEST(FootnoteCollectionTest, IncrementalSyncKeepsUnchangedNotes) {
+    TempDoc temp("test_footnotes_incremental.docx");
+
+    Document doc(temp.path());
+    ASSERT_TRUE(doc.create_empty());
+    auto f1 = doc.add_footnote("First");
+    auto f2 = doc.add_footnote("Second");
+    auto f3 = doc.add_footnote("Third");
+    doc.save();
+
+    auto n1 = find_note_node(doc, f1->get_id());
+    auto n2 = find_note_node(doc, f2->get_id());
+    ASSERT_TRUE(n1);
+    ASSERT_TRUE(n2);
+    EXPECT_FALSE(f1->is_modified());
+
+    // Edit through a child node: detected without set_modified()
+    auto* para = dynamic_cast<Paragraph*>(f2->get_children()[0].get());
+    ASSERT_NE(para, nullptr);
+    para->append_run(" edited");
+    auto f4 = doc.add_footnote("Fourth");
+    doc.save();
+
+    EXPECT_EQ(find_note_node(doc, f1->get_id()), n1);
+    EXPECT_NE(find_note_node(doc, f2->get_id()), n2);
+
+    // Document order follows the collection order
+    std::vector<int> ids;
+    for (auto note : doc.get_footnotes()->child("w:footnotes").children("w:footnote")) {
+        if (note.attribute("w:id").as_int() > 0) {
+            ids.push_back(note.attribute("w:id").as_int());
+        }
+    }
+    EXPECT_EQ(ids, (std::vector<int>{f1->get_id(), f2->get_id(), f3->get_id(), f4->get_id()}));
+
+    Document reopened(temp.path());
+    reopened.open();
+    ASSERT_TRUE(reopened.is_open());
+    auto reloaded = reopened.footnotes().get_by_id(f2->get_id());
+    ASSERT_NE(reloaded, nullptr);
+    EXPECT_EQ(reloaded->get_text(), "Second edited");
+}
+
+TEST(FootnoteCollectionTest, RemoveFootnoteDropsSyncedElement) {
+    Document doc("test_footnotes_remove_synced.docx");
+    ASSERT_TRUE(doc.create_empty());
+    auto f1 = doc.add_footnote("Keep");
+    auto f2 = doc.add_footnote("Drop");
+    doc.sync_to_physical_tree();
+    ASSERT_TRUE(find_note_node(doc, f2->get_id()));
+
+    EXPECT_TRUE(doc.remove_footnote(f2->get_id()));
+    EXPECT_FALSE(find_note_node(doc, f2->get_id()));
+    EXPECT_TRUE(find_note_node(doc, f1->get_id()));
+    EXPECT_EQ(doc.footnotes().get_by_id(f2->get_id()), nullptr);
+    EXPECT_FALSE(doc.remove_footnote(f2->get_id()));
+
+    doc.clear_footnotes();
+    EXPECT_FALSE(find_note_node(doc, f1->get_id()));
+    EXPECT_EQ(doc.footnotes().count(), 0u);
+}
+
+TEST(FootnoteCollectionTest, FormattingOnlyEditIsPersisted) {
+    TempDoc temp("test_footnotes_format_edit.docx");
+    int id = 0;
+
+    {
+        Document doc(temp.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto note = doc.add_footnote("Plain text");
+        id = note->get_id();
+        doc.save();
+
+        // Neither the text nor the structure changes, only a run's formatting
+        auto* para = dynamic_cast<Paragraph*>(note->get_children()[0].get());
+        ASSERT_NE(para, nullptr);
+        para->get_first_run()->get_font().italic = true;
+        doc.save();
+
+        note->set_footnote_type(FootnoteType::Footnote);
+        EXPECT_TRUE(note->is_modified());
+    }
+
+    Document doc(temp.path());
+    doc.open();
+    auto note = doc.footnotes().get_by_id(id);
+    ASSERT_NE(note, nullptr);
+    auto* para = dynamic_cast<Paragraph*>(note->get_children()[0].get());
+    ASSERT_NE(para, nullptr);
+    EXPECT_TRUE(para->get_first_run()->get_font().italic);
+}
+
+TEST(FootnoteCollectionTest, SetIdRekeysNote) {
+    Document doc("test_footnotes_set_id.docx");
+    ASSERT_TRUE(doc.create_empty());
+    auto footnote = doc.add_footnote("Footnote");
+    auto endnote = doc.add_endnote("Endnote");
+    const int old_id = footnote->get_id();
+
+    footnote->set_id(50);
+    endnote->set_id(60);
+    EXPECT_EQ(doc.footnotes().get_by_id(50), footnote);
+    EXPECT_EQ(doc.footnotes().get_by_id(old_id), nullptr);
+    EXPECT_EQ(doc.endnotes().get_by_id(60), endnote);
+
+    doc.sync_to_physical_tree();
+    EXPECT_TRUE(find_note_node(doc, 50));
+    EXPECT_TRUE(doc.remove_footnote(50));
+    EXPECT_FALSE(find_note_node(doc, 50));
+}
@@ -252,3 +252,135 @@ TEST(FieldSwitchesTest, EmptyFieldCodeEdgeCase) {
     // get_full_field_code() does not prepend a space when field_code is empty
     EXPECT_EQ(field->get_full_field_code(), "\\* MERGEFORMAT");
 }
+
+// ============================================================================
+// Table of Contents Tests
+// ============================================================================
+
+TEST(TableOfContentsTest, UpdateListsHeadingsWithBookmarks) {
+    Document doc("test_toc_update.docx");
+    ASSERT_TRUE(doc.create_empty());
+    auto body = doc.get_first_section()->get_body();
+    ASSERT_NE(body, nullptr);
+
+    auto toc = body->append_paragraph()->append_field(FieldType::Unknown);
+    toc->set_field_code("TOC");
+    toc->add_switch("\\o \"1-2\" \\h");
+
+    auto chapter = body->append_paragraph("Introduction");
+    chapter->get_paragraph_format().style_name = "Heading1";
+    chapter->get_list_format().list_id = doc.add_numbered_list_definition();
+    auto scope = body->append_paragraph("Scope\tand goals");
+    scope->get_paragraph_format().style_name = "Heading2";
+    body->append_paragraph("Details")->get_paragraph_format().style_name = "Heading3";
+    body->append_paragraph("Body text");
+
+    EXPECT_EQ(doc.update_table_of_contents(), 1);
+    const auto& entries = doc.get_toc_entries();
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].level, 1);
+    EXPECT_EQ(entries[0].label, "1.");
+    EXPECT_EQ(entries[1].text, "Scope and goals");
+    EXPECT_TRUE(entries[2].bookmark.empty());  // Below the \o range
+    EXPECT_TRUE(toc->spans_paragraphs());
+
+    // Field paragraph, two entries, then the paragraph with the field end
+    auto first = std::dynamic_pointer_cast<Paragraph>(body->get_child(1));
+    auto second = std::dynamic_pointer_cast<Paragraph>(body->get_child(2));
+    auto end = std::dynamic_pointer_cast<Paragraph>(body->get_child(3));
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    ASSERT_NE(end, nullptr);
+    EXPECT_EQ(first->get_paragraph_format().style_name, "TOC1");
+    EXPECT_EQ(second->get_paragraph_format().style_name, "TOC2");
+    auto link = first->get_first_child<Hyperlink>();
+    ASSERT_NE(link, nullptr);
+    EXPECT_EQ(link->get_result(), "1. Introduction");
+    EXPECT_EQ(link->get_bookmark_name(), entries[0].bookmark);
+    ASSERT_NE(chapter->get_first_child<BookmarkStart>(), nullptr);
+    EXPECT_EQ(chapter->get_first_child<BookmarkStart>()->get_name(), entries[0].bookmark);
+    EXPECT_NE(doc.styles().get_by_style_id("TOC2"), nullptr);
+
+    // Only the entry of the edited heading is rebuilt and no bookmark is added
+    scope->append_run(" (draft)");
+    EXPECT_EQ(doc.update_table_of_contents(), 1);
+    EXPECT_EQ(body->get_child(1), first);
+    EXPECT_NE(body->get_child(2), second);
+    EXPECT_EQ(body->get_child(3), end);
+    EXPECT_EQ(chapter->get_children_of_type<BookmarkStart>().size(), 1u);
+    EXPECT_EQ(doc.get_toc_entries()[1].text, "Scope and goals (draft)");
+}
+
+TEST(TableOfContentsTest, EntriesRoundTrip) {
+    TempDoc temp_doc("test_toc_round_trip.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        auto toc = body->append_paragraph()->append_field(FieldType::Unknown);
+        toc->set_field_code("TOC");
+        toc->add_switch("\\o \"1-3\" \\h");
+        body->append_paragraph("Overview")->get_paragraph_format().style_name = "Heading1";
+        body->append_paragraph("Text");
+        doc.update_table_of_contents();
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    auto body = doc.get_first_section()->get_body();
+    ASSERT_NE(body, nullptr);
+    ASSERT_EQ(body->get_child_count(), 5u);
+
+    auto field_para = std::dynamic_pointer_cast<Paragraph>(body->get_child(0));
+    ASSERT_NE(field_para, nullptr);
+    auto fields = field_para->get_fields();
+    ASSERT_EQ(fields.size(), 1u);
+    EXPECT_EQ(fields[0]->get_field_code(), "TOC");
+    EXPECT_TRUE(fields[0]->spans_paragraphs());
+
+    auto entry = std::dynamic_pointer_cast<Paragraph>(body->get_child(1));
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->get_text(), "Overview");
+    EXPECT_EQ(entry->get_paragraph_format().style_name, "TOC1");
+    auto end = std::dynamic_pointer_cast<Paragraph>(body->get_child(2));
+    ASSERT_NE(end, nullptr);
+    ASSERT_EQ(end->get_child_count(), 1u);
+    EXPECT_EQ(end->get_first_child()->node_type(), NodeType::SpecialChar);
+
+    // The saved entry is still current, so updating keeps it
+    EXPECT_EQ(doc.update_table_of_contents(), 1);
+    EXPECT_EQ(body->get_child(1), entry);
+    EXPECT_EQ(body->get_child_count(), 5u);
+}
+
+TEST(TableOfContentsTest, BuilderFillsEntries) {
+    TempDoc temp_doc("test_toc_builder.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        body->append_paragraph("Contents");
+        body->append_paragraph("Methods")->get_paragraph_format().style_name = "Heading1";
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    DocumentBuilder builder(&doc);
+    builder.move_to_document_start();
+    auto field = builder.insert_table_of_contents("\\o \"1-3\"");
+    ASSERT_NE(field, nullptr);
+    EXPECT_TRUE(field->spans_paragraphs());
+    ASSERT_EQ(doc.get_toc_entries().size(), 1u);
+    EXPECT_EQ(doc.get_toc_entries()[0].text, "Methods");
+    EXPECT_FALSE(doc.get_toc_entries()[0].bookmark.empty());
+
+    auto paras = doc.get_paragraphs();
+    ASSERT_GE(paras.get_count(), 4u);
+    EXPECT_EQ(paras.get_item(1)->get_text(), "Methods");
+    EXPECT_EQ(paras.get_item(1)->get_paragraph_format().style_name, "TOC1");
+    EXPECT_EQ(paras.get_item(3)->get_text(), "Methods");
+}
@@ -0,0 +1,177 @@
+/**
+ * @file 20_document_compare_tests.cpp
+ * @brief Tests for fingerprint-based document comparison
+ * @version 0.8.0
+ *
+ * @defgroup tests_document_compare DocumentComparer Tests
+ * @brief Change list and redline (w:ins / w:del) output
+ * @{
+ */
+
+#include <gtest/gtest.h>
+#include <cdocx.h>
+#include <cdocx/document_compare.h>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+
+using namespace cdocx;
+using cdocx::test::TempDoc;
+using cdocx::test::create_empty_doc;
+
+namespace {
+
+void fill(Document& doc, const std::vector<std::string>& paragraphs) {
+    auto body = create_empty_doc(doc);
+    ASSERT_NE(body, nullptr);
+    for (const auto& text : paragraphs) {
+        body->append_paragraph(text);
+    }
+}
+
+int count_elements(pugi::xml_node node, const char* name) {
+    int count = 0;
+    for (auto child = node.first_child(); child; child = child.next_sibling()) {
+        if (std::string(child.name()) == name) {
+            ++count;
+        }
+        count += count_elements(child, name);
+    }
+    return count;
+}
+
+}  // namespace
+
+// ============================================================================
+// Change List Tests
+// ============================================================================
+
+TEST(DocumentCompareTest, IdenticalDocumentsHaveNoChanges) {
+    Document original;
+    Document revised;
+    fill(original, {"Alpha", "Beta", "Gamma"});
+    fill(revised, {"Alpha", "Beta", "Gamma"});
+
+    EXPECT_TRUE(DocumentComparer::compare(original, revised).empty());
+}
+
+TEST(DocumentCompareTest, DetectsInsertedAndDeletedParagraphs) {
+    Document original;
+    Document revised;
+    fill(original, {"Clause 1", "Clause 2", "Clause 3"});
+    fill(revised, {"Clause 1", "Clause 3", "Clause 4"});
+
+    const auto changes = DocumentComparer::compare(original, revised);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].type, ChangeType::Deleted);
+    EXPECT_EQ(changes[0].original_text, "Clause 2");
+    EXPECT_EQ(changes[1].type, ChangeType::Inserted);
+    EXPECT_EQ(changes[1].revised_text, "Clause 4");
+    EXPECT_EQ(changes[1].original_index, -1);
+}
+
+TEST(DocumentCompareTest, ModifiedParagraphReportsWordChanges) {
+    Document original;
+    Document revised;
+    fill(original, {"Header", "The buyer shall pay within 30 days."});
+    fill(revised, {"Header", "The buyer shall pay within 60 days."});
+
+    const auto changes = DocumentComparer::compare(original, revised);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].type, ChangeType::Modified);
+    EXPECT_FALSE(changes[0].formatting_changed);
+    ASSERT_EQ(changes[0].inline_changes.size(), 2u);
+    EXPECT_EQ(changes[0].inline_changes[0].type, ChangeType::Deleted);
+    EXPECT_EQ(changes[0].inline_changes[0].text, "30");
+    EXPECT_EQ(changes[0].inline_changes[1].type, ChangeType::Inserted);
+    EXPECT_EQ(changes[0].inline_changes[1].text, "60");
+}
+
+TEST(DocumentCompareTest, FormattingChangeCanBeIgnored) {
+    Document original;
+    Document revised;
+    fill(original, {"Plain"});
+    fill(revised, {});
+    auto para = cdocx::test::get_body(revised)->append_paragraph();
+    para->append_run("Plain")->set_bold(true);
+
+    const auto changes = DocumentComparer::compare(original, revised);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_TRUE(changes[0].formatting_changed);
+
+    CompareOptions options;
+    options.set_ignore_formatting(true);
+    EXPECT_TRUE(DocumentComparer::compare(original, revised, options).empty());
+}
+
+TEST(DocumentCompareTest, TableCellChangeIsModifiedTable) {
+    Document original;
+    Document revised;
+    auto body_a = create_empty_doc(original);
+    auto body_b = create_empty_doc(revised);
+    auto table_a = body_a->append_table(2, 2);
+    auto table_b = body_b->append_table(2, 2);
+    table_a->get_cell(1, 1)->set_text("100");
+    table_b->get_cell(1, 1)->set_text("120");
+
+    const auto changes = DocumentComparer::compare(original, revised);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].type, ChangeType::Modified);
+    EXPECT_EQ(changes[0].block_type, NodeType::Table);
+}
+
+// ============================================================================
+// Redline Tests
+// ============================================================================
+
+TEST(DocumentCompareTest, RedlineWritesTrackedChanges) {
+    TempDoc temp("test_compare_redline.docx");
+    Document original(temp.path());
+    Document revised;
+    fill(original, {"Keep", "Remove me", "Price is 30 EUR"});
+    fill(revised, {"Keep", "Price is 45 EUR", "Added"});
+
+    CompareOptions options;
+    options.set_author("Reviewer").set_date(1700000000);
+    EXPECT_EQ(original.compare(revised, options), 3);
+    original.save();
+
+    Document reopened(temp.path());
+    reopened.open();
+    ASSERT_TRUE(reopened.is_open());
+    auto body = reopened.get_document_xml()->child("w:document").child("w:body");
+    EXPECT_GE(count_elements(body, "w:ins"), 2);
+    EXPECT_GE(count_elements(body, "w:del"), 2);
+    EXPECT_GE(count_elements(body, "w:delText"), 2);
+
+    int deleted_runs = 0;
+    int inserted_runs = 0;
+    for (const auto& para : cdocx::test::get_body(reopened)->get_paragraphs()) {
+        for (const auto& child : para->get_children()) {
+            if (auto run = std::dynamic_pointer_cast<cdocx::Run>(child)) {
+                if (run->get_revision_type() == RevisionType::Deletion) {
+                    ++deleted_runs;
+                    EXPECT_EQ(run->get_revision_author(), "Reviewer");
+                } else if (run->get_revision_type() == RevisionType::Insertion) {
+                    ++inserted_runs;
+                }
+            }
+        }
+    }
+    EXPECT_GE(deleted_runs, 2);
+    EXPECT_GE(inserted_runs, 2);
+}
+
+TEST(DocumentCompareTest, RedlineWithoutChangesLeavesDocumentUntouched) {
+    Document original;
+    Document revised;
+    fill(original, {"Same"});
+    fill(revised, {"Same"});
+
+    EXPECT_EQ(original.compare(revised), 0);
+    auto body = original.get_document_xml()->child("w:document").child("w:body");
+    EXPECT_EQ(count_elements(body, "w:ins"), 0);
+    EXPECT_EQ(count_elements(body, "w:del"), 0);
+}
+
+/** @} */
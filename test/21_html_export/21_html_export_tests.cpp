@@ -0,0 +1,222 @@
+/**
+ * @file 21_html_export_tests.cpp
+ * @brief Tests for streaming HTML export
+ * @version 0.8.0
+ *
+ * @defgroup tests_html_export HtmlWriter Tests
+ * @brief CSS class deduplication, lists, tables and images
+ * @{
+ */
+
+#include <gtest/gtest.h>
+#include <cdocx.h>
+#include <cdocx/html_writer.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../test_helpers.h"
+
+namespace fs = std::filesystem;
+using namespace cdocx;
+using cdocx::test::TempDoc;
+using cdocx::test::create_empty_doc;
+
+namespace {
+
+// 1x1 transparent PNG
+const unsigned char kTinyPng[] = {
+    0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48,
+    0x44, 0x52, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00,
+    0x00, 0x1F, 0x15, 0xC4, 0x89, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x44, 0x41, 0x54, 0x78,
+    0x9C, 0x63, 0x00, 0x01, 0x00, 0x00, 0x05, 0x00, 0x01, 0x0D, 0x0A, 0x2D, 0xB4, 0x00,
+    0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82,
+};
+
+std::string to_html(Document& doc, const HtmlSaveOptions& options = HtmlSaveOptions()) {
+    std::ostringstream out;
+    EXPECT_TRUE(doc.save_html(out, options));
+    return out.str();
+}
+
+size_t count_occurrences(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos;
+         pos = text.find(needle, pos + needle.size())) {
+        ++count;
+    }
+    return count;
+}
+
+std::string write_tiny_png(const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(kTinyPng), sizeof(kTinyPng));
+    return path;
+}
+
+}  // namespace
+
+// ============================================================================
+// Document Structure Tests
+// ============================================================================
+
+TEST(HtmlExportTest, WritesFullDocumentAndEscapesText) {
+    Document doc;
+    auto body = create_empty_doc(doc);
+    body->append_paragraph("Fish & <Chips>");
+
+    const std::string html = to_html(doc);
+    EXPECT_EQ(html.rfind("<!DOCTYPE html>", 0), 0u);
+    EXPECT_NE(html.find("Fish &amp; &lt;Chips&gt;"), std::string::npos);
+    EXPECT_NE(html.find("</body>\n</html>"), std::string::npos);
+}
+
+TEST(HtmlExportTest, BodyOnlyOutput) {
+    Document doc;
+    auto body = create_empty_doc(doc);
+    body->append_paragraph("Fragment");
+
+    HtmlSaveOptions options;
+    options.set_export_full_document(false);
+    const std::string html = to_html(doc, options);
+    EXPECT_EQ(html.find("<html>"), std::string::npos);
+    EXPECT_NE(html.find("Fragment"), std::string::npos);
+}
+
+TEST(HtmlExportTest, IdenticalFormattingSharesOneClass) {
+    Document doc;
+    auto body = create_empty_doc(doc);
+    for (int i = 0; i < 10; ++i) {
+        auto para = body->append_paragraph();
+        para->append_run("bold " + std::to_string(i))->set_bold(true);
+        para->append_run(" plain");
+    }
+
+    const std::string html = to_html(doc);
+    // One rule for the bold run formatting, referenced by every paragraph
+    EXPECT_EQ(count_occurrences(html, "font-weight:bold"), 1u);
+    EXPECT_EQ(count_occurrences(html, "<span class="), 10u);
+}
+
+TEST(HtmlExportTest, InlineCssUsesStyleAttributes) {
+    Document doc;
+    auto body = create_empty_doc(doc);
+    body->append_paragraph()->append_run("red")->set_color("FF0000");
+
+    HtmlSaveOptions options;
+    options.set_css_style_sheet_type(CssStyleSheetType::Inline);
+    const std::string html = to_html(doc, options);
+    EXPECT_EQ(html.find("<style>"), std::string::npos);
+    EXPECT_NE(html.find("color:#FF0000"), std::string::npos);
+}
+
+TEST(HtmlExportTest, ExternalStyleSheet) {
+    TempDoc css("test_html_export.css");
+    Document doc;
+    auto body = create_empty_doc(doc);
+    body->append_paragraph()->append_run("italic")->set_italic(true);
+
+    HtmlSaveOptions options;
+    options.set_css_style_sheet_type(CssStyleSheetType::External)
+        .set_css_style_sheet_file_name(css.path());
+    const std::string html = to_html(doc, options);
+    EXPECT_NE(html.find("<link rel=\"stylesheet\""), std::string::npos);
+    EXPECT_EQ(html.find("font-style:italic"), std::string::npos);
+
+    std::ifstream file(css.path());
+    const std::string rules((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+    EXPECT_NE(rules.find("font-style:italic"), std::string::npos);
+}
+
+// ============================================================================
+// Lists and Tables
+// ============================================================================
+
+TEST(HtmlExportTest, ListsMapToSemanticElements) {
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    auto bullets = doc.add_bulleted_list_definition();
+    auto numbers = doc.add_numbered_list_definition();
+    auto sect = doc.get_first_section();
+    sect->add_paragraph("one")->set_numbering(bullets, NumberingLevel::Level1);
+    sect->add_paragraph("two")->set_numbering(bullets, NumberingLevel::Level1);
+    sect->add_paragraph("first")->set_numbering(numbers, NumberingLevel::Level1);
+
+    const std::string html = to_html(doc);
+    EXPECT_EQ(count_occurrences(html, "<ul>"), 1u);
+    EXPECT_EQ(count_occurrences(html, "<ol"), 1u);
+    EXPECT_EQ(count_occurrences(html, "<li>"), 3u);
+    EXPECT_EQ(count_occurrences(html, "</ul>"), 1u);
+    EXPECT_EQ(count_occurrences(html, "</ol>"), 1u);
+}
+
+TEST(HtmlExportTest, TableWithMergedCells) {
+    Document doc;
+    auto body = create_empty_doc(doc);
+    auto table = body->append_table(2, 3);
+    table->get_cell(0, 0)->set_text("A");
+    table->get_cell(1, 2)->set_text("F");
+    table->merge_cells(0, 0, 0, 1);
+
+    const std::string html = to_html(doc);
+    EXPECT_EQ(count_occurrences(html, "<table"), 1u);
+    EXPECT_EQ(count_occurrences(html, "<tr>"), 2u);
+    EXPECT_NE(html.find("colspan=\"2\""), std::string::npos);
+    EXPECT_NE(html.find(">F<"), std::string::npos);
+}
+
+// ============================================================================
+// Images
+// ============================================================================
+
+TEST(HtmlExportTest, ImagesAsDataUriOrFiles) {
+    TempDoc png("test_html_export.png");
+    write_tiny_png(png.path());
+
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    DocumentBuilder builder(&doc);
+    ASSERT_TRUE(builder.insert_image(png.path(), 10, 10));
+    doc.sync_from_physical_tree();
+
+    const std::string inline_html = to_html(doc);
+    EXPECT_NE(inline_html.find("src=\"data:image/png;base64,iVBORw0KGgo"), std::string::npos);
+
+    const std::string folder = "test_html_export_images";
+    fs::remove_all(folder);
+    HtmlSaveOptions options;
+    options.set_export_images_as_base64(false).set_image_folder(folder);
+    const std::string file_html = to_html(doc, options);
+    EXPECT_NE(file_html.find("src=\"" + folder + "/"), std::string::npos);
+    EXPECT_FALSE(fs::is_empty(folder));
+    fs::remove_all(folder);
+
+    // An image folder that cannot be created fails the export
+    TempDoc blocker("test_html_export_blocker");
+    std::ofstream(blocker.path()) << "not a folder";
+    options.set_image_folder(blocker.path());
+    std::ostringstream out;
+    EXPECT_FALSE(doc.save_html(out, options));
+}
+
+TEST(HtmlExportTest, SaveWithHtmlFormat) {
+    TempDoc html_file("test_html_export.html");
+    Document doc;
+    auto body = create_empty_doc(doc);
+    body->append_paragraph("Saved as HTML");
+
+    EXPECT_TRUE(doc.save(html_file.path(), SaveFormat::Auto));
+    std::ifstream file(html_file.path());
+    const std::string html((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+    EXPECT_NE(html.find("Saved as HTML"), std::string::npos);
+
+    // Formats without a writer fail instead of silently writing nothing
+    TempDoc rtf_file("test_html_export.rtf");
+    EXPECT_FALSE(doc.save(rtf_file.path(), SaveFormat::Auto));
+    EXPECT_FALSE(doc.save(rtf_file.path(), SaveFormat::Markdown));
+    EXPECT_FALSE(fs::exists(rtf_file.path()));
+}
+
+/** @} */
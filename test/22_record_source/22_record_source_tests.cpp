@@ -0,0 +1,187 @@
+/**
+ * @file 22_record_source_tests.cpp
+ * @brief Tests for memory-mapped CSV / JSON Lines record sources
+ * @since 0.8.0
+ */
+
+#include <gtest/gtest.h>
+#include <cdocx.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include "../test_helpers.h"
+
+namespace fs = std::filesystem;
+using namespace cdocx;
+using cdocx::test::TempDoc;
+
+namespace {
+
+void write_file(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+}
+
+}  // namespace
+
+// ============================================================================
+// CsvRecordSource
+// ============================================================================
+
+TEST(RecordSourceTest, CsvHeaderAndPlainFields) {
+    TempDoc csv("test_records_plain.csv");
+    write_file(csv.path(), "\xEF\xBB\xBFName,City\r\nAlice,Paris\r\n\r\nBob,\r\n");
+
+    CsvRecordSource source(csv.path());
+    ASSERT_TRUE(source.is_open());
+    ASSERT_EQ(source.get_columns().size(), 2u);
+    EXPECT_EQ(source.get_columns()[0], "Name");
+    EXPECT_EQ(source.find_column("city"), 1);
+    EXPECT_EQ(source.find_column("Zip"), -1);
+
+    ASSERT_TRUE(source.next());
+    EXPECT_EQ(source.get_field(0), "Alice");
+    EXPECT_EQ(source.get_field(1), "Paris");
+
+    ASSERT_TRUE(source.next());
+    EXPECT_EQ(source.get_field(0), "Bob");
+    EXPECT_EQ(source.get_field(1), "");
+    EXPECT_EQ(source.get_field(5), "");
+
+    EXPECT_FALSE(source.next());
+}
+
+TEST(RecordSourceTest, CsvQuotedFields) {
+    TempDoc csv("test_records_quoted.csv");
+    write_file(csv.path(),
+               "id;note\n"
+               "1;\"semi;colon\"\n"
+               "2;\"say \"\"hi\"\"\"\n"
+               "3;\"two\nlines\"\n");
+
+    CsvRecordSource source(csv.path(), ';');
+    ASSERT_TRUE(source.is_open());
+
+    ASSERT_TRUE(source.next());
+    EXPECT_EQ(source.get_field(1), "semi;colon");
+    ASSERT_TRUE(source.next());
+    EXPECT_EQ(source.get_field(1), "say \"hi\"");
+    ASSERT_TRUE(source.next());
+    EXPECT_EQ(source.get_field(0), "3");
+    EXPECT_EQ(source.get_field(1), "two\nlines");
+    EXPECT_FALSE(source.next());
+}
+
+TEST(RecordSourceTest, CsvMissingFile) {
+    CsvRecordSource source("does_not_exist.csv");
+    EXPECT_FALSE(source.is_open());
+    EXPECT_FALSE(source.next());
+}
+
+// ============================================================================
+// JsonLinesRecordSource
+// ============================================================================
+
+TEST(RecordSourceTest, JsonLinesValues) {
+    TempDoc jsonl("test_records.jsonl");
+    write_file(jsonl.path(),
+               "{\"name\": \"Alice\", \"age\": 30, \"vip\": true}\n"
+               "\n"
+               "{\"age\": null, \"name\": \"B\\u00f6b \\\"Jr\\\"\\n\", "
+               "\"tags\": [1, {\"a\": \"}\"}]}\n"
+               "not json\n"
+               "{\"name\": \"\\ud83d\\ude00\"}");
+
+    JsonLinesRecordSource source(jsonl.path());
+    ASSERT_TRUE(source.is_open());
+
+    ASSERT_TRUE(source.next());
+    ASSERT_EQ(source.get_columns().size(), 3u);
+    EXPECT_EQ(source.get_field(source.find_column("name")), "Alice");
+    EXPECT_EQ(source.get_field(source.find_column("age")), "30");
+    EXPECT_EQ(source.get_field(source.find_column("vip")), "true");
+
+    ASSERT_TRUE(source.next());
+    EXPECT_EQ(source.get_field(source.find_column("name")), "B\xC3\xB6" "b \"Jr\"\n");
+    EXPECT_EQ(source.get_field(source.find_column("age")), "");
+    EXPECT_EQ(source.get_field(source.find_column("vip")), "");
+    // New keys extend the column list
+    ASSERT_EQ(source.get_columns().size(), 4u);
+    EXPECT_EQ(source.get_field(3), "[1, {\"a\": \"}\"}]");
+
+    ASSERT_TRUE(source.next());
+    EXPECT_EQ(source.get_field(source.find_column("name")), "\xF0\x9F\x98\x80");
+    EXPECT_FALSE(source.next());
+    EXPECT_EQ(source.get_skipped_count(), 1u);
+}
+
+// ============================================================================
+// Consumers
+// ============================================================================
+
+TEST(RecordSourceTest, MailMergeFromCsv) {
+    TempDoc csv("test_records_merge.csv");
+    TempDoc out_doc("test_records_merge_out.docx");
+    write_file(csv.path(), "NAME,Unused\n\"Smith, John\",x\nR&D,y\n");
+
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    auto para = doc.get_first_section()->get_body()->get_first_paragraph();
+    para->append_run("Hello ");
+    auto field = std::make_shared<Field>(&doc, FieldType::MergeField);
+    field->set_field_code("MERGEFIELD Name");
+    para->append_child(field);
+
+    CsvRecordSource source(csv.path());
+    MailMerge mail_merge(&doc);
+    EXPECT_EQ(mail_merge.execute_to_single_document(out_doc.path(), source), 2);
+
+    Document merged(out_doc.path());
+    merged.open();
+    ASSERT_TRUE(merged.is_open());
+    const auto text = merged.get_text();
+    EXPECT_NE(text.find("Hello Smith, John"), std::string::npos);
+    EXPECT_NE(text.find("Hello R&D"), std::string::npos);
+}
+
+TEST(RecordSourceTest, TemplateEngineBatchFromRecord) {
+    TempDoc jsonl("test_records_engine.jsonl");
+    write_file(jsonl.path(), "{\"company\": \"Acme\", \"city\": \"Oslo\"}\n");
+
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    JsonLinesRecordSource source(jsonl.path());
+    ASSERT_TRUE(source.next());
+
+    TemplateEngine engine(&doc);
+    engine.set_batch(source);
+    EXPECT_EQ(engine.size(), 2u);
+    EXPECT_TRUE(engine.has("company"));
+    EXPECT_TRUE(engine.has("city"));
+}
+
+TEST(RecordSourceTest, TemplateEngineBatchFollowsNewColumns) {
+    TempDoc jsonl("test_records_engine_columns.jsonl");
+    write_file(jsonl.path(), "{\"first\": \"One\"}\n{\"first\": \"Two\", \"second\": \"Three\"}\n");
+
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    doc.get_first_section()->get_body()->append_paragraph("{{first}}-{{second}}");
+    JsonLinesRecordSource source(jsonl.path());
+    TemplateEngine engine(&doc);
+
+    ASSERT_TRUE(source.next());
+    engine.set_batch(source);
+    EXPECT_EQ(engine.size(), 1u);
+
+    // A key that appears in a later record is bound then; a removed one comes back
+    engine.remove("first");
+    ASSERT_TRUE(source.next());
+    engine.set_batch(source);
+    EXPECT_EQ(engine.size(), 2u);
+    EXPECT_TRUE(engine.has("first"));
+
+    EXPECT_EQ(engine.apply().success, 2);
+    EXPECT_NE(doc.get_text().find("Two-Three"), std::string::npos);
+}
@@ -0,0 +1,172 @@
+/**
+ * @file 23_api_allocations_tests.cpp
+ * @brief Allocation counts of the string_view / rvalue setter overloads
+ * @details Replaces the global allocator so each test can count the heap
+ *          allocations made by a single API call. Lives in its own test
+ *          executable for that reason.
+ * @since 0.8.0
+ */
+
+#include <gtest/gtest.h>
+#include <cdocx.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include "../test_helpers.h"
+
+using namespace cdocx;
+
+namespace {
+
+std::atomic<long> g_allocations{0};
+
+// Texts longer than any small-string buffer, so copies must allocate
+const std::string kLongText = "The quick brown fox jumps over the lazy dog, twice over.";
+const std::string kOtherText = "Pack my box with five dozen liquor jugs, said the sphinx.";
+
+template <typename Fn>
+long count_allocations(Fn&& fn) {
+    const long before = g_allocations.load();
+    fn();
+    return g_allocations.load() - before;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+// ============================================================================
+// Run
+// ============================================================================
+
+TEST(ApiAllocationTest, RunSetTextMovesRvalue) {
+    cdocx::Run run;
+    std::string text = kLongText;
+    EXPECT_EQ(count_allocations([&] { run.set_text(std::move(text)); }), 0);
+    EXPECT_EQ(run.get_text(), kLongText);
+}
+
+TEST(ApiAllocationTest, RunSetTextReusesBuffer) {
+    cdocx::Run run;
+    run.set_text(kLongText);
+    const std::string_view view = kOtherText;
+    EXPECT_EQ(count_allocations([&] { run.set_text(view); }), 0);
+    EXPECT_EQ(run.get_text(), kOtherText);
+}
+
+TEST(ApiAllocationTest, RunPrependTextInPlace) {
+    cdocx::Run run;
+    std::string text = kLongText;
+    text.reserve(kLongText.size() * 2);
+    run.set_text(std::move(text));
+    EXPECT_EQ(count_allocations([&] { run.prepend_text(">> "); }), 0);
+    EXPECT_EQ(run.get_text(), ">> " + kLongText);
+}
+
+// ============================================================================
+// Paragraph / Template / TemplateEngine
+// ============================================================================
+
+TEST(ApiAllocationTest, ParagraphSetTextSavesCopy) {
+    Document doc;
+    auto body = cdocx::test::create_empty_doc(doc);
+    auto copied = body->append_paragraph();
+    auto moved = body->append_paragraph();
+
+    const long copy_count = count_allocations([&] { copied->set_text(kLongText); });
+    std::string text = kLongText;
+    const long move_count = count_allocations([&] { moved->set_text(std::move(text)); });
+    EXPECT_EQ(copy_count - move_count, 1);
+    EXPECT_EQ(moved->get_text(), kLongText);
+}
+
+TEST(ApiAllocationTest, TemplateSetMovesValue) {
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    Template tmpl(&doc);
+    tmpl.set("name", "placeholder");
+
+    const std::string key = "name";
+    std::string value = kLongText;
+    EXPECT_EQ(count_allocations([&] { tmpl.set(key, std::move(value)); }), 0);
+}
+
+TEST(ApiAllocationTest, TemplateValueAndFormatMoveStrings) {
+    std::string content = kLongText;
+    EXPECT_EQ(count_allocations([&] { auto value = TemplateValue::text(std::move(content)); }), 0);
+
+    TemplateFormat format;
+    std::string color = kOtherText;
+    EXPECT_EQ(count_allocations([&] { format.color(std::move(color)); }), 0);
+    EXPECT_EQ(format.color_opt().value(), kOtherText);
+}
+
+TEST(ApiAllocationTest, TemplateEngineSetMovesText) {
+    Document doc;
+    ASSERT_TRUE(doc.create_empty());
+    TemplateEngine engine(&doc);
+    const std::string key = "company";
+    engine.set(key, "placeholder");
+
+    std::string text = kLongText;
+    EXPECT_EQ(count_allocations([&] { engine.set(key, std::move(text)); }), 0);
+    EXPECT_TRUE(engine.has(key));
+}
+
+TEST(ApiAllocationTest, TemplateEngineBatchReusesBoundValues) {
+    cdocx::test::TempDoc csv("test_alloc_records.csv");
+    {
+        std::ofstream file(csv.path(), std::ios::binary);
+        file << "company,motto\n"
+             << kOtherText.substr(0, 30) << ",\"" << kOtherText << "\"\n"
+             << kLongText.substr(0, 30) << ",\"" << kLongText << "\"\n";
+    }
+
+    Document doc;
+    auto body = cdocx::test::create_empty_doc(doc);
+    body->append_paragraph("{{company}}: {{motto}}");
+    CsvRecordSource source(csv.path());
+    TemplateEngine engine(&doc);
+
+    // The first record binds the columns; the next (shorter) one reuses their text buffers
+    ASSERT_TRUE(source.next());
+    engine.set_batch(source);
+    ASSERT_TRUE(source.next());
+    EXPECT_EQ(count_allocations([&] { engine.set_batch(source); }), 0);
+    EXPECT_EQ(engine.size(), 2u);
+
+    EXPECT_EQ(engine.apply().success, 2);
+    EXPECT_NE(doc.get_text().find(kLongText.substr(0, 30) + ": " + kLongText),
+              std::string::npos);
+}
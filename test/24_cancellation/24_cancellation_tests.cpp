@@ -0,0 +1,247 @@
+/**
+ * @file 24_cancellation_tests.cpp
+ * @brief Tests for cancellation tokens, deadlines and inflate limits
+ * @since 0.8.0
+ */
+
+#include <gtest/gtest.h>
+#include <cdocx.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+
+extern "C" {
+#include <zip.h>
+}
+
+namespace fs = std::filesystem;
+using namespace cdocx;
+using cdocx::test::TempDoc;
+
+namespace {
+
+void create_package(const std::string& path, const std::string& text = "Hello") {
+    Document doc;
+    ASSERT_TRUE(doc.create_empty(path));
+    doc.get_first_section()->get_body()->append_paragraph(text);
+    doc.save();
+}
+
+// Appends a highly compressible entry (zeros) to an existing package
+void append_zero_entry(const std::string& path, const std::string& name, size_t size) {
+    zip_t* zip = zip_open(path.c_str(), 9, 'a');
+    ASSERT_NE(zip, nullptr);
+    const std::vector<char> zeros(size, 0);
+    zip_entry_open(zip, name.c_str());
+    zip_entry_write(zip, zeros.data(), zeros.size());
+    zip_entry_close(zip);
+    zip_close(zip);
+}
+
+bool has_error(const LoadResult& result, LoadErrorType type) {
+    return std::any_of(result.errors.begin(), result.errors.end(), [type](const LoadError& e) {
+        return e.type == type;
+    });
+}
+
+}  // namespace
+
+// ============================================================================
+// CancellationToken
+// ============================================================================
+
+TEST(CancellationTest, CopiesShareState) {
+    CancellationToken token;
+    const CancellationToken copy = token;
+    EXPECT_FALSE(copy.is_cancelled());
+    EXPECT_FALSE(copy.has_deadline());
+
+    token.cancel();
+    EXPECT_TRUE(copy.is_cancelled());
+    EXPECT_EQ(copy.get_reason(), CancellationReason::Cancelled);
+}
+
+TEST(CancellationTest, DeadlineExpires) {
+    CancellationToken token;
+    token.set_timeout(std::chrono::hours(1));
+    EXPECT_TRUE(token.has_deadline());
+    EXPECT_FALSE(token.is_cancelled());
+
+    token.set_deadline(CancellationToken::Clock::now() - std::chrono::seconds(1));
+    EXPECT_EQ(token.get_reason(), CancellationReason::DeadlineExceeded);
+}
+
+// ============================================================================
+// Loading
+// ============================================================================
+
+TEST(CancellationTest, OpenWithCancelledTokenAborts) {
+    TempDoc temp_doc("test_cancel_open.docx");
+    create_package(temp_doc.path());
+
+    LoadConfig config;
+    config.cancellation_token.cancel();
+
+    Document doc;
+    const LoadResult result = doc.open_with_config(temp_doc.path(), config);
+    EXPECT_FALSE(result.is_usable());
+    EXPECT_TRUE(has_error(result, LoadErrorType::Cancelled));
+    EXPECT_FALSE(doc.is_open());
+}
+
+TEST(CancellationTest, OpenPastDeadlineReportsTimeout) {
+    TempDoc temp_doc("test_cancel_deadline.docx");
+    create_package(temp_doc.path());
+
+    LoadConfig config;
+    config.parallel_threshold = 1;
+    config.cancellation_token.set_deadline(CancellationToken::Clock::now());
+
+    Document doc;
+    const LoadResult result = doc.open_with_config(temp_doc.path(), config);
+    EXPECT_FALSE(result.is_usable());
+    EXPECT_TRUE(has_error(result, LoadErrorType::Timeout));
+    EXPECT_FALSE(doc.is_open());
+}
+
+TEST(CancellationTest, CancelFromProgressCallbackStopsLoading) {
+    TempDoc temp_doc("test_cancel_progress.docx");
+    create_package(temp_doc.path());
+
+    LoadConfig config;
+    config.enable_parallel_loading = false;
+    CancellationToken token = config.cancellation_token;
+    config.progress_callback = [token](int, const std::string&) mutable { token.cancel(); };
+
+    Document doc;
+    const LoadResult result = doc.open_with_config(temp_doc.path(), config);
+    EXPECT_FALSE(result.is_usable());
+    EXPECT_EQ(result.loaded_files, 1u);
+    EXPECT_LT(result.loaded_files, result.total_files);
+}
+
+TEST(CancellationTest, CompressionRatioLimitIsOptIn) {
+    TempDoc temp_doc("test_cancel_bomb.docx");
+    create_package(temp_doc.path(), "Bomb");
+    append_zero_entry(temp_doc.path(), "customXml/payload.bin", 8 * 1024 * 1024);
+
+    // A highly compressible part is a normal part unless a limit is configured
+    size_t total_files = 0;
+    {
+        Document doc;
+        const LoadResult result = doc.open_with_config(temp_doc.path(), LoadConfig());
+        EXPECT_TRUE(result.is_complete());
+        EXPECT_TRUE(result.skipped_files.empty());
+        total_files = result.total_files;
+        doc.save();
+    }
+    {
+        Document doc;
+        const LoadResult result = doc.open_with_config(temp_doc.path(), LoadConfig());
+        EXPECT_TRUE(result.is_complete());
+        EXPECT_EQ(result.loaded_files, total_files);
+    }
+
+    // Exceeding a configured limit fails the load instead of dropping the part
+    LoadConfig config;
+    config.max_compression_ratio = 100;
+    ASSERT_TRUE(config.skip_corrupted_files);
+    Document doc;
+    const LoadResult result = doc.open_with_config(temp_doc.path(), config);
+    EXPECT_FALSE(result.is_usable());
+    EXPECT_TRUE(has_error(result, LoadErrorType::LimitExceeded));
+    EXPECT_TRUE(result.skipped_files.empty());
+}
+
+TEST(CancellationTest, TotalSizeLimitAborts) {
+    TempDoc temp_doc("test_cancel_total.docx");
+    create_package(temp_doc.path());
+
+    LoadConfig config;
+    config.max_total_size = 1024;
+
+    Document doc;
+    const LoadResult result = doc.open_with_config(temp_doc.path(), config);
+    EXPECT_FALSE(result.is_usable());
+    EXPECT_TRUE(has_error(result, LoadErrorType::LimitExceeded));
+}
+
+// ============================================================================
+// Saving, TemplateEngine and MailMerge
+// ============================================================================
+
+TEST(CancellationTest, CancelledSaveLeavesNoFile) {
+    TempDoc temp_doc("test_cancel_save.docx");
+    Document doc;
+    auto body = cdocx::test::create_empty_doc(doc);
+    body->append_paragraph("Saved");
+
+    CancellationToken token;
+    token.cancel();
+    EXPECT_FALSE(doc.save(temp_doc.path(), token));
+    EXPECT_FALSE(fs::exists(temp_doc.path()));
+    EXPECT_FALSE(fs::exists(temp_doc.path() + ".part"));
+
+    EXPECT_TRUE(doc.save(temp_doc.path(), CancellationToken()));
+    EXPECT_FALSE(fs::exists(temp_doc.path() + ".part"));
+
+    Document reopened(temp_doc.path());
+    reopened.open();
+    ASSERT_TRUE(reopened.is_open());
+    EXPECT_NE(reopened.get_text().find("Saved"), std::string::npos);
+}
+
+TEST(CancellationTest, TemplateEngineStopsWhenCancelled) {
+    Document doc;
+    auto body = cdocx::test::create_empty_doc(doc);
+    body->append_paragraph("{{a}} and {{b}}");
+
+    CancellationToken token;
+    token.cancel();
+
+    TemplateEngine engine(&doc);
+    engine.set("a", "Apple").set("b", "Banana").with_cancellation(token);
+    const auto result = engine.apply();
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_EQ(result.success, 0);
+    EXPECT_EQ(result.skipped, 2);
+    EXPECT_FALSE(result.all_succeeded());
+    EXPECT_EQ(body->get_paragraphs()[0]->get_text(), "{{a}} and {{b}}");
+}
+
+TEST(CancellationTest, MailMergeCancelledMidwayRemovesOutput) {
+    TempDoc temp_doc("test_cancel_merge_tpl.docx");
+    TempDoc out_doc("test_cancel_merge_out.docx");
+    Document doc(temp_doc.path());
+    ASSERT_TRUE(doc.create_empty());
+
+    auto body = doc.get_first_section()->get_body();
+    body->remove_all_children();
+    auto para = body->append_paragraph("Item ");
+    auto field = std::make_shared<Field>(&doc, FieldType::MergeField);
+    field->set_field_code("MERGEFIELD Index");
+    para->append_child(field);
+
+    CancellationToken token;
+    MailMerge mail_merge(&doc);
+    mail_merge.set_cancellation_token(token);
+
+    int produced = 0;
+    const int written = mail_merge.execute_to_single_document(
+        out_doc.path(), [&](std::map<std::string, std::string>& record) {
+            if (++produced == 5) {
+                token.cancel();
+            }
+            record["Index"] = std::to_string(produced);
+            return true;  // endless source; only the token stops it
+        });
+
+    EXPECT_EQ(written, -1);
+    EXPECT_EQ(produced, 5);
+    EXPECT_TRUE(mail_merge.was_cancelled());
+    EXPECT_FALSE(fs::exists(out_doc.path()));
+}
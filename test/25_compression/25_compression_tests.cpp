@@ -0,0 +1,404 @@
+/**
+ * @file 25_compression_tests.cpp
+ * @brief Tests for selectable compression backends and codec statistics
+ * @since 0.8.0
+ */
+
+#include <gtest/gtest.h>
+#include <cdocx.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../test_helpers.h"
+#include "../../src/zip_archive.h"
+
+namespace fs = std::filesystem;
+using namespace cdocx;
+using cdocx::test::TempDoc;
+
+namespace {
+
+const CompressionBackend kAllBackends[] = {
+    CompressionBackend::Bundled, CompressionBackend::Libdeflate, CompressionBackend::ZlibNg};
+
+std::vector<CompressionBackend> available_backends() {
+    std::vector<CompressionBackend> backends;
+    for (CompressionBackend backend : kAllBackends) {
+        if (is_compression_backend_available(backend)) {
+            backends.push_back(backend);
+        }
+    }
+    return backends;
+}
+
+void create_package(const std::string& path, CompressionBackend backend, int paragraphs) {
+    Document doc;
+    ASSERT_TRUE(doc.create_empty(path));
+    doc.set_compression_backend(backend);
+    auto body = doc.get_first_section()->get_body();
+    for (int i = 0; i < paragraphs; ++i) {
+        body->append_paragraph("Paragraph " + std::to_string(i));
+    }
+    doc.save();
+}
+
+LoadConfig config_for(CompressionBackend backend) {
+    LoadConfig config;
+    config.compression_backend = backend;
+    return config;
+}
+
+/// Bitwise reference CRC-32 (reflected, polynomial 0xEDB88320)
+uint32_t reference_crc32(const std::vector<uint8_t>& data, size_t begin, size_t end) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = begin; i < end; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+}  // namespace
+
+// ============================================================================
+// Backend Selection
+// ============================================================================
+
+TEST(CompressionTest, BundledBackendIsAlwaysAvailable) {
+    EXPECT_TRUE(is_compression_backend_available(CompressionBackend::Bundled));
+    EXPECT_STREQ(get_compression_backend_name(CompressionBackend::Bundled), "bundled");
+    EXPECT_STREQ(get_compression_backend_name(CompressionBackend::Libdeflate), "libdeflate");
+    EXPECT_STREQ(get_compression_backend_name(CompressionBackend::ZlibNg), "zlib-ng");
+
+    Document doc;
+    EXPECT_EQ(doc.get_compression_backend(), get_default_compression_backend());
+}
+
+TEST(CompressionTest, DefaultBackendIsFastestAvailable) {
+    // kAllBackends is ordered from slowest to fastest
+    const CompressionBackend fastest = available_backends().back();
+    EXPECT_EQ(get_default_compression_backend(), fastest);
+    EXPECT_EQ(LoadConfig().compression_backend, fastest);
+}
+
+TEST(CompressionTest, UnavailableBackendFallsBackToBundled) {
+    for (CompressionBackend backend : kAllBackends) {
+        if (is_compression_backend_available(backend)) {
+            continue;
+        }
+        TempDoc temp_doc("test_compression_fallback.docx");
+        create_package(temp_doc.path(), backend, 3);
+
+        Document doc;
+        EXPECT_TRUE(doc.open_with_config(temp_doc.path(), config_for(backend)).is_complete());
+        EXPECT_EQ(doc.get_last_load_statistics().compression_backend, CompressionBackend::Bundled);
+        EXPECT_NE(doc.get_text().find("Paragraph 2"), std::string::npos);
+    }
+}
+
+// ============================================================================
+// Round Trips
+// ============================================================================
+
+TEST(CompressionTest, PackagesAreReadableAcrossBackends) {
+    const std::vector<CompressionBackend> backends = available_backends();
+    for (CompressionBackend writer : backends) {
+        TempDoc temp_doc("test_compression_roundtrip.docx");
+        create_package(temp_doc.path(), writer, 200);
+
+        for (CompressionBackend reader : backends) {
+            LoadConfig config = config_for(reader);
+            config.parallel_threshold = 1;
+
+            Document doc;
+            const LoadResult result = doc.open_with_config(temp_doc.path(), config);
+            EXPECT_TRUE(result.is_complete()) << get_compression_backend_name(writer) << " -> "
+                                              << get_compression_backend_name(reader);
+            EXPECT_EQ(doc.get_last_load_statistics().compression_backend, reader);
+            EXPECT_NE(doc.get_text().find("Paragraph 199"), std::string::npos);
+
+            // Saving again uses the backend the package was loaded with
+            doc.get_first_section()->get_body()->append_paragraph("Appended");
+            doc.save();
+            EXPECT_EQ(doc.get_last_save_statistics().compression_backend, reader);
+        }
+
+        Document reopened(temp_doc.path());
+        reopened.open();
+        ASSERT_TRUE(reopened.is_open());
+        EXPECT_NE(reopened.get_text().find("Appended"), std::string::npos);
+    }
+}
+
+TEST(CompressionTest, LimitsApplyToEveryBackend) {
+    for (CompressionBackend backend : available_backends()) {
+        TempDoc temp_doc("test_compression_limits.docx");
+        create_package(temp_doc.path(), backend, 3);
+
+        LoadConfig config = config_for(backend);
+        config.max_total_size = 1024;
+
+        Document doc;
+        const LoadResult result = doc.open_with_config(temp_doc.path(), config);
+        EXPECT_FALSE(result.is_usable()) << get_compression_backend_name(backend);
+    }
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+TEST(CompressionTest, LoadStatisticsReportInflateThroughput) {
+    TempDoc temp_doc("test_compression_load_stats.docx");
+    create_package(temp_doc.path(), CompressionBackend::Bundled, 500);
+
+    for (CompressionBackend backend : available_backends()) {
+        Document doc;
+        ASSERT_TRUE(doc.open_with_config(temp_doc.path(), config_for(backend)).is_complete());
+
+        const LoadStatistics stats = doc.get_last_load_statistics();
+        EXPECT_GT(stats.compressed_bytes, 0u);
+        EXPECT_GT(stats.uncompressed_bytes, stats.compressed_bytes);
+        EXPECT_GE(stats.inflate_ms, 0.0);
+        EXPECT_EQ(stats.processed_entries,
+                  stats.xml_files + stats.media_files + stats.binary_files);
+    }
+}
+
+TEST(CompressionTest, SaveStatisticsReportDeflateThroughput) {
+    for (CompressionBackend backend : available_backends()) {
+        TempDoc temp_doc("test_compression_save_stats.docx");
+        Document doc;
+        auto body = cdocx::test::create_empty_doc(doc);
+        for (int i = 0; i < 500; ++i) {
+            body->append_paragraph("Line " + std::to_string(i));
+        }
+        doc.set_compression_backend(backend);
+        ASSERT_TRUE(doc.save(temp_doc.path(), CancellationToken()));
+
+        const SaveStatistics stats = doc.get_last_save_statistics();
+        EXPECT_EQ(stats.compression_backend, backend);
+        EXPECT_GT(stats.entries, 0u);
+        EXPECT_GT(stats.uncompressed_bytes, stats.package_bytes);
+        EXPECT_EQ(stats.package_bytes, fs::file_size(temp_doc.path()));
+        EXPECT_GE(stats.get_elapsed_ms(), stats.deflate_ms);
+    }
+}
+
+TEST(CompressionTest, LargePartIsDeflatedInParallelBlocks) {
+    if (!is_compression_backend_available(CompressionBackend::ZlibNg)) {
+        GTEST_SKIP() << "zlib-ng backend not built";
+    }
+    TempDoc temp_doc("test_compression_parallel.docx");
+    create_package(temp_doc.path(), CompressionBackend::Bundled, 40000);
+
+    {
+        // The default backend is zlib-ng whenever it is built
+        LoadConfig config;
+        config.max_threads = 4;
+        Document doc;
+        ASSERT_TRUE(doc.open_with_config(temp_doc.path(), config).is_complete());
+        doc.get_first_section()->get_body()->append_paragraph("Last");
+        doc.save();
+        EXPECT_EQ(doc.get_last_save_statistics().compression_backend, CompressionBackend::ZlibNg);
+        EXPECT_EQ(doc.get_last_save_statistics().parallel_entries, 1u);
+    }
+
+    Document reopened;
+    ASSERT_TRUE(reopened.open_with_config(temp_doc.path(), LoadConfig()).is_complete());
+    const std::string text = reopened.get_text();
+    EXPECT_NE(text.find("Paragraph 39999"), std::string::npos);
+    EXPECT_NE(text.find("Last"), std::string::npos);
+}
+
+// Internal symbols are only reachable from the static library
+#ifndef CDOCX_SHARED
+TEST(CompressionTest, Crc32CombineMatchesConcatenation) {
+    const std::vector<uint8_t> check = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    ASSERT_EQ(reference_crc32(check, 0, check.size()), 0xCBF43926u);
+    EXPECT_EQ(crc32_combine(reference_crc32(check, 0, 4), reference_crc32(check, 4, 9), 5),
+              0xCBF43926u);
+
+    std::vector<uint8_t> data(300000);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>((i * 7919) >> 3);
+    }
+    const uint32_t whole = reference_crc32(data, 0, data.size());
+    for (const size_t split : {size_t{0}, size_t{1}, size_t{4095}, size_t{65536}, data.size()}) {
+        const uint32_t a = reference_crc32(data, 0, split);
+        const uint32_t b = reference_crc32(data, split, data.size());
+        EXPECT_EQ(crc32_combine(a, b, data.size() - split), whole) << split;
+    }
+}
+
+namespace {
+
+struct BlockCall {
+    const uint8_t* in = nullptr;
+    size_t size = 0;
+    size_t dictionary_size = 0;
+    bool dictionary_precedes_block = false;
+    bool last = false;
+};
+
+struct BlockLog {
+    std::mutex mutex;
+    std::vector<BlockCall> calls;
+};
+
+/**
+ * Run-length codec standing in for a block-capable backend in every build.
+ * Each block is a final flag, a run count and (byte, length) runs; this is not
+ * deflate, so archives written with it are read back with the same codec.
+ */
+class RunLengthCodec : public DeflateCodec {
+  public:
+    explicit RunLengthCodec(BlockLog* log) : log_(log) {}
+
+    CompressionBackend backend() const override { return CompressionBackend::Bundled; }
+
+    std::unique_ptr<DeflateCodec> make_worker() const override {
+        return std::make_unique<RunLengthCodec>(log_);
+    }
+
+    bool inflate(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) override {
+        size_t pos = 0;
+        size_t written = 0;
+        bool last = false;
+        while (!last) {
+            if (in_size - pos < 5) {
+                return false;
+            }
+            last = in[pos] != 0;
+            const uint32_t runs = read_u32(in + pos + 1);
+            pos += 5;
+            if ((in_size - pos) / 5 < runs) {
+                return false;
+            }
+            for (uint32_t r = 0; r < runs; ++r, pos += 5) {
+                const uint32_t length = read_u32(in + pos + 1);
+                if (out_size - written < length) {
+                    return false;
+                }
+                std::fill_n(out + written, length, in[pos]);
+                written += length;
+            }
+        }
+        return pos == in_size && written == out_size;
+    }
+
+    bool deflate(const uint8_t* in, size_t in_size, int level, std::vector<uint8_t>& out) override {
+        return deflate_block(in, in_size, nullptr, 0, true, level, out);
+    }
+
+    uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) const override {
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+            }
+        }
+        return ~crc;
+    }
+
+    bool supports_block_deflate() const override { return true; }
+
+    bool deflate_block(const uint8_t* in,
+                       size_t in_size,
+                       const uint8_t* dictionary,
+                       size_t dictionary_size,
+                       bool last,
+                       int /*level*/,
+                       std::vector<uint8_t>& out) override {
+        {
+            std::lock_guard<std::mutex> lock(log_->mutex);
+            log_->calls.push_back(
+                {in, in_size, dictionary_size, dictionary + dictionary_size == in, last});
+        }
+        out.assign(5, 0);
+        out[0] = last ? 1 : 0;
+        uint32_t runs = 0;
+        for (size_t i = 0; i < in_size; ++runs) {
+            size_t length = 1;
+            while (i + length < in_size && in[i + length] == in[i]) {
+                ++length;
+            }
+            out.push_back(in[i]);
+            write_u32(out, static_cast<uint32_t>(length));
+            i += length;
+        }
+        std::memcpy(out.data() + 1, &runs, 4);
+        return true;
+    }
+
+  private:
+    BlockLog* log_;
+
+    static uint32_t read_u32(const uint8_t* p) {
+        uint32_t value = 0;
+        std::memcpy(&value, p, 4);
+        return value;
+    }
+
+    static void write_u32(std::vector<uint8_t>& out, uint32_t value) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+};
+
+}  // namespace
+
+TEST(CompressionTest, ParallelBlocksJoinIntoOneStream) {
+    constexpr size_t kBlock = ZipArchiveWriter::kParallelBlockSize;
+    std::vector<uint8_t> data(3 * kBlock + 12345);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i / 1000);
+    }
+
+    TempDoc temp_doc("test_compression_blocks.zip");
+    BlockLog log;
+    RunLengthCodec codec(&log);
+    {
+        ZipArchiveWriter writer(codec, 6);
+        writer.set_threads(3);
+        ASSERT_TRUE(writer.open(temp_doc.path()));
+        ASSERT_TRUE(writer.add_entry("word/document.xml", data.data(), data.size()));
+        ASSERT_TRUE(writer.close());
+        EXPECT_EQ(writer.get_parallel_entry_count(), 1u);
+    }
+
+    // One call per block, each primed with the 32 KB before it; only the last is final
+    ASSERT_EQ(log.calls.size(), 4u);
+    std::sort(log.calls.begin(), log.calls.end(), [](const BlockCall& a, const BlockCall& b) {
+        return a.in < b.in;
+    });
+    for (size_t i = 0; i < log.calls.size(); ++i) {
+        const BlockCall& call = log.calls[i];
+        EXPECT_EQ(call.in, data.data() + i * kBlock) << i;
+        EXPECT_EQ(call.size, std::min(kBlock, data.size() - i * kBlock)) << i;
+        EXPECT_EQ(call.dictionary_size, i == 0 ? 0u : 32u * 1024) << i;
+        EXPECT_TRUE(call.dictionary_precedes_block) << i;
+        EXPECT_EQ(call.last, i + 1 == log.calls.size()) << i;
+    }
+
+    // The joined stream and combined CRC read back as the original part
+    ZipArchiveReader reader;
+    ASSERT_TRUE(reader.open(temp_doc.path()));
+    const int index = reader.find("word/document.xml");
+    ASSERT_GE(index, 0);
+    EXPECT_EQ(reader.entry(index).method, 8);
+    EXPECT_LT(reader.entry(index).compressed_size, data.size());
+    EXPECT_EQ(reader.entry(index).crc32, reference_crc32(data, 0, data.size()));
+    std::vector<uint8_t> out;
+    ASSERT_EQ(reader.read(index, codec, out), ZipEntryStatus::Ok);
+    EXPECT_TRUE(out == data);
+}
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file 26_encryption_tests.cpp
+ * @brief Tests for opening and saving password-protected packages
+ * @since 0.8.0
+ */
+
+#include <gtest/gtest.h>
+#include <cdocx.h>
+#include <filesystem>
+#include <string>
+#include "../test_helpers.h"
+
+namespace fs = std::filesystem;
+using namespace cdocx;
+using cdocx::test::TempDoc;
+
+namespace {
+
+void create_encrypted_package(const std::string& path, const std::string& password) {
+    Document doc;
+    ASSERT_TRUE(doc.create_empty(path));
+    doc.set_encryption_password(password);
+    auto body = doc.get_first_section()->get_body();
+    for (int i = 0; i < 200; ++i) {
+        body->append_paragraph("Confidential paragraph " + std::to_string(i));
+    }
+    doc.save();
+}
+
+LoadConfig config_with_password(const std::string& password) {
+    LoadConfig config;
+    config.password = password;
+    return config;
+}
+
+LoadErrorType first_error(const LoadResult& result) {
+    return result.errors.empty() ? LoadErrorType::None : result.errors.front().type;
+}
+
+}  // namespace
+
+// ============================================================================
+// Open and Save
+// ============================================================================
+
+TEST(EncryptionTest, EncryptedSaveRoundTrips) {
+    if (!is_encryption_available()) {
+        GTEST_SKIP() << "Built without OpenSSL";
+    }
+    TempDoc temp_doc("test_encryption_roundtrip.docx");
+    create_encrypted_package(temp_doc.path(), "s\xC3\xA9same");
+
+    auto info = FileFormatUtil::detect_file_format(temp_doc.path());
+    EXPECT_EQ(info->load_format(), LoadFormat::Docx);
+    EXPECT_TRUE(info->is_encrypted());
+
+    Document doc;
+    const LoadResult result =
+        doc.open_with_config(temp_doc.path(), config_with_password("s\xC3\xA9same"));
+    ASSERT_TRUE(result.is_complete());
+    EXPECT_TRUE(doc.is_encrypted());
+    EXPECT_NE(doc.get_text().find("Confidential paragraph 199"), std::string::npos);
+
+    // Saves keep the password until it is cleared
+    TempDoc copy("test_encryption_copy.docx");
+    doc.save(copy.path());
+    EXPECT_TRUE(FileFormatUtil::detect_file_format(copy.path())->is_encrypted());
+
+    TempDoc plain("test_encryption_plain.docx");
+    doc.set_encryption_password("");
+    doc.save(plain.path());
+    EXPECT_FALSE(FileFormatUtil::detect_file_format(plain.path())->is_encrypted());
+
+    Document reopened;
+    EXPECT_TRUE(reopened.open_with_config(plain.path(), LoadConfig()).is_complete());
+    EXPECT_FALSE(reopened.is_encrypted());
+    EXPECT_NE(reopened.get_text().find("Confidential paragraph 0"), std::string::npos);
+}
+
+// Encrypted outside cdocx with fixed salts and keys, following MS-OFFCRYPTO 2.3.4.10-2.3.4.15:
+// SHA-512 with 100000 spins, AES-256-CBC, data integrity HMAC, three 4096-byte segments and
+// EncryptionInfo in the mini stream of a version 3 compound file
+TEST(EncryptionTest, KnownAnswerPackageDecrypts) {
+    if (!is_encryption_available()) {
+        GTEST_SKIP() << "Built without OpenSSL";
+    }
+    const std::string path = "data/known_answer.docx";
+    ASSERT_TRUE(fs::exists(path));
+    EXPECT_TRUE(FileFormatUtil::detect_file_format(path)->is_encrypted());
+
+    Document doc;
+    LoadResult result = doc.open_with_config(path, config_with_password("Wrong answer"));
+    EXPECT_EQ(first_error(result), LoadErrorType::InvalidPassword);
+
+    result = doc.open_with_config(path, config_with_password("Known answer"));
+    ASSERT_TRUE(result.is_complete());
+    EXPECT_TRUE(doc.is_encrypted());
+    const std::string text = doc.get_text();
+    EXPECT_NE(text.find("Known answer paragraph 0"), std::string::npos);
+    EXPECT_NE(text.find("Known answer paragraph 119"), std::string::npos);
+}
+
+TEST(EncryptionTest, FailedSaveLeavesNoPlainPackage) {
+    if (!is_encryption_available()) {
+        GTEST_SKIP() << "Built without OpenSSL";
+    }
+    TempDoc temp_doc("test_encryption_failed.docx");
+    create_encrypted_package(temp_doc.path(), "secret");
+
+    Document doc;
+    ASSERT_TRUE(
+        doc.open_with_config(temp_doc.path(), config_with_password("secret")).is_complete());
+
+    // The target is a directory, so the encrypted file cannot be written
+    const std::string target = "test_encryption_failed_dir";
+    fs::create_directory(target);
+    CancellationToken token;
+    EXPECT_FALSE(doc.save(target, token));
+    EXPECT_FALSE(fs::exists(target + ".package"));
+    EXPECT_FALSE(fs::exists(target + ".part"));
+    fs::remove_all(target);
+}
+
+TEST(EncryptionTest, CancellableSaveLeavesNoTemporaryFiles) {
+    if (!is_encryption_available()) {
+        GTEST_SKIP() << "Built without OpenSSL";
+    }
+    TempDoc temp_doc("test_encryption_token.docx");
+    create_encrypted_package(temp_doc.path(), "token");
+
+    Document doc;
+    ASSERT_TRUE(doc.open_with_config(temp_doc.path(), config_with_password("token")).is_complete());
+    CancellationToken token;
+    EXPECT_TRUE(doc.save(temp_doc.path(), token));
+    EXPECT_FALSE(fs::exists(temp_doc.path() + ".part"));
+    EXPECT_FALSE(fs::exists(temp_doc.path() + ".package"));
+
+    Document reopened;
+    EXPECT_TRUE(
+        reopened.open_with_config(temp_doc.path(), config_with_password("token")).is_complete());
+}
+
+// ============================================================================
+// Errors
+// ============================================================================
+
+TEST(EncryptionTest, WrongOrMissingPasswordIsReported) {
+    if (!is_encryption_available()) {
+        GTEST_SKIP() << "Built without OpenSSL";
+    }
+    TempDoc temp_doc("test_encryption_password.docx");
+    create_encrypted_package(temp_doc.path(), "right");
+
+    Document doc;
+    LoadResult result = doc.open_with_config(temp_doc.path(), LoadConfig());
+    EXPECT_FALSE(result.is_usable());
+    EXPECT_EQ(first_error(result), LoadErrorType::PasswordRequired);
+    EXPECT_FALSE(doc.is_open());
+
+    result = doc.open_with_config(temp_doc.path(), config_with_password("wrong"));
+    EXPECT_FALSE(result.is_usable());
+    EXPECT_EQ(first_error(result), LoadErrorType::InvalidPassword);
+
+    result = doc.open_with_config(temp_doc.path(), config_with_password("right"));
+    EXPECT_TRUE(result.is_complete());
+}
+
+TEST(EncryptionTest, PasswordIsIgnoredForPlainPackages) {
+    TempDoc temp_doc("test_encryption_unencrypted.docx");
+    {
+        Document doc;
+        ASSERT_TRUE(doc.create_empty(temp_doc.path()));
+        doc.get_first_section()->get_body()->append_paragraph("Plain text");
+        doc.save();
+    }
+
+    Document doc;
+    EXPECT_TRUE(
+        doc.open_with_config(temp_doc.path(), config_with_password("unused")).is_complete());
+    EXPECT_FALSE(doc.is_encrypted());
+    EXPECT_FALSE(FileFormatUtil::detect_file_format(temp_doc.path())->is_encrypted());
+}
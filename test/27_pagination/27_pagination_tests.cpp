@@ -0,0 +1,280 @@
+/**
+ * @file 27_pagination_tests.cpp
+ * @brief Tests for the approximate page layout and the page number fields
+ * @since 0.8.0
+ */
+
+#include <gtest/gtest.h>
+#include <cdocx.h>
+#include <cdocx/pagination.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../test_helpers.h"
+
+namespace fs = std::filesystem;
+using namespace cdocx;
+using cdocx::test::TempDoc;
+
+namespace {
+
+std::shared_ptr<Body> body_with_paragraphs(Document& doc, int count) {
+    auto body = doc.get_first_section()->get_body();
+    for (int i = 0; i < count; ++i) {
+        body->append_paragraph("Paragraph " + std::to_string(i) +
+                               " with enough words in it to fill most of one line of text.");
+    }
+    return body;
+}
+
+void put_u16(std::string& out, std::uint32_t value) {
+    out += static_cast<char>(value >> 8 & 0xFF);
+    out += static_cast<char>(value & 0xFF);
+}
+
+void put_u32(std::string& out, std::uint32_t value) {
+    put_u16(out, value >> 16);
+    put_u16(out, value & 0xFFFF);
+}
+
+/**
+ * A TrueType file with a format 12 cmap: glyph 1 (four ems) for the emoticons block and
+ * a thousand groups that each claim every code point above it, up to 0xFFFFFFFF
+ */
+std::string format12_font(const std::string& family) {
+    std::string head(54, '\0');
+    head[18] = 0x03;  // 1000 units per em
+    head[19] = static_cast<char>(0xE8);
+
+    std::string hhea(36, '\0');
+    hhea[4] = 0x03;  // Ascent 1000
+    hhea[5] = static_cast<char>(0xE8);
+    hhea[35] = 2;  // Two horizontal metrics
+
+    std::string hmtx;
+    put_u32(hmtx, 500u << 16);   // Glyph 0: half an em
+    put_u32(hmtx, 4000u << 16);  // Glyph 1: four ems
+
+    struct Group {
+        std::uint32_t first;
+        std::uint32_t last;
+        std::uint32_t glyph;
+    };
+    std::vector<Group> groups = {{0x1F600, 0x1F64F, 1}};
+    groups.resize(1001, {0x1F650, 0xFFFFFFFF, 0});
+    std::string cmap;
+    put_u16(cmap, 0);
+    put_u16(cmap, 1);
+    put_u16(cmap, 3);   // Windows
+    put_u16(cmap, 10);  // Full Unicode repertoire
+    put_u32(cmap, 12);
+    put_u16(cmap, 12);
+    put_u16(cmap, 0);
+    put_u32(cmap, static_cast<std::uint32_t>(16 + 12 * groups.size()));
+    put_u32(cmap, 0);
+    put_u32(cmap, static_cast<std::uint32_t>(groups.size()));
+    for (const Group& group : groups) {
+        put_u32(cmap, group.first);
+        put_u32(cmap, group.last);
+        put_u32(cmap, group.glyph);
+    }
+
+    std::string name;
+    put_u16(name, 0);
+    put_u16(name, 1);
+    put_u16(name, 18);
+    put_u16(name, 3);
+    put_u16(name, 1);
+    put_u16(name, 0x409);
+    put_u16(name, 1);  // Family
+    put_u16(name, static_cast<std::uint32_t>(family.size() * 2));
+    put_u16(name, 0);
+    for (const char c : family) {
+        put_u16(name, static_cast<unsigned char>(c));
+    }
+
+    const std::vector<std::pair<const char*, std::string*>> tables = {
+        {"cmap", &cmap}, {"head", &head}, {"hhea", &hhea}, {"hmtx", &hmtx}, {"name", &name}};
+    std::string font;
+    put_u32(font, 0x00010000);
+    put_u16(font, static_cast<std::uint32_t>(tables.size()));
+    font.append(6, '\0');
+    std::string data;
+    for (const auto& table : tables) {
+        font.append(table.first, 4);
+        put_u32(font, 0);
+        put_u32(font, static_cast<std::uint32_t>(12 + 16 * tables.size() + data.size()));
+        put_u32(font, static_cast<std::uint32_t>(table.second->size()));
+        data += *table.second;
+        data.append((4 - data.size() % 4) % 4, '\0');
+    }
+    return font + data;
+}
+
+}  // namespace
+
+// ============================================================================
+// Page Layout
+// ============================================================================
+
+TEST(PaginationTest, PageCountGrowsWithContent) {
+    Document doc("test_pagination_count.docx");
+    ASSERT_TRUE(doc.create_empty());
+    EXPECT_EQ(doc.get_page_count(), 0);
+
+    auto body = body_with_paragraphs(doc, 3);
+    EXPECT_EQ(doc.update_pagination(), 1);
+    EXPECT_EQ(doc.get_page_number(*body->get_paragraphs().front()), 1);
+
+    body_with_paragraphs(doc, 300);
+    const int pages = doc.update_pagination();
+    EXPECT_GT(pages, 3);
+    EXPECT_EQ(doc.get_page_count(), pages);
+    EXPECT_EQ(doc.get_builtin_document_properties().total_pages, pages);
+    EXPECT_EQ(doc.get_page_number(*body->get_paragraphs().back()), pages);
+}
+
+TEST(PaginationTest, PageBreaksStartNewPages) {
+    Document doc("test_pagination_breaks.docx");
+    ASSERT_TRUE(doc.create_empty());
+    auto body = doc.get_first_section()->get_body();
+    auto title = body->append_paragraph("Title");
+    auto chapter = body->append_paragraph("Chapter one");
+    chapter->get_paragraph_format().page_break_before = true;
+    auto text = body->append_paragraph("Before the break");
+    text->append_run("\fAfter the break");
+    auto last = body->append_paragraph("Closing words");
+
+    EXPECT_EQ(doc.update_pagination(), 3);
+    EXPECT_EQ(doc.get_page_number(*title), 1);
+    EXPECT_EQ(doc.get_page_number(*chapter), 2);
+    EXPECT_EQ(doc.get_page_number(*text), 2);
+    EXPECT_EQ(doc.get_page_number(*last), 3);
+}
+
+TEST(PaginationTest, SectionsStartOnNewPages) {
+    Document doc("test_pagination_sections.docx");
+    ASSERT_TRUE(doc.create_empty());
+    body_with_paragraphs(doc, 2);
+    auto appendix = doc.append_section()->get_body()->append_paragraph("Appendix");
+
+    EXPECT_EQ(doc.update_pagination(), 2);
+    EXPECT_EQ(doc.get_page_number(*appendix), 2);
+}
+
+TEST(PaginationTest, SupplementaryCharactersUseFormat12Widths) {
+    const std::string directory = "test_pagination_fonts";
+    fs::create_directories(directory);
+    {
+        std::ofstream out(directory + "/format12.ttf", std::ios::binary);
+        out << format12_font("Cdocx Format Twelve");
+    }
+    add_font_directory(directory);
+
+    // Estimated at about half an em, a thousand emoji fit on one page; at four ems they do not
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += "\xF0\x9F\x98\x80 ";
+    }
+    const auto paginate = [&](const std::string& font_name) {
+        Document doc;
+        EXPECT_TRUE(doc.create_empty());
+        auto para = doc.get_first_section()->get_body()->append_paragraph(text);
+        para->get_first_run()->set_font_name(font_name);
+        return doc.update_pagination();
+    };
+    EXPECT_EQ(paginate("Cdocx Font Not Installed"), 1);
+    EXPECT_GT(paginate("Cdocx Format Twelve"), 1);
+    fs::remove_all(directory);
+}
+
+TEST(PaginationTest, UpdateAfterEditMatchesFullLayout) {
+    Document doc("test_pagination_incremental.docx");
+    ASSERT_TRUE(doc.create_empty());
+    auto body = body_with_paragraphs(doc, 400);
+    doc.update_pagination();
+    auto paras = body->get_paragraphs();
+    const int early = doc.get_page_number(*paras[20]);
+
+    paras[300]->get_paragraph_format().page_break_before = true;
+    paras[320]->append_run(" More words at the end of this paragraph.");
+    const int pages = doc.update_pagination();
+    EXPECT_EQ(doc.get_page_number(*paras[20]), early);
+
+    // Laying out the edited document from scratch gives the same pages
+    Document fresh("test_pagination_fresh.docx");
+    ASSERT_TRUE(fresh.create_empty());
+    auto fresh_body = body_with_paragraphs(fresh, 400);
+    auto fresh_paras = fresh_body->get_paragraphs();
+    fresh_paras[300]->get_paragraph_format().page_break_before = true;
+    fresh_paras[320]->append_run(" More words at the end of this paragraph.");
+    EXPECT_EQ(fresh.update_pagination(), pages);
+    for (size_t i = 0; i < paras.size(); i += 10) {
+        EXPECT_EQ(doc.get_page_number(*paras[i]), fresh.get_page_number(*fresh_paras[i])) << i;
+    }
+
+    // Nodes inside a paragraph are on the page where it starts
+    EXPECT_EQ(doc.get_page_number(*paras[350]->get_first_child()),
+              doc.get_page_number(*paras[350]));
+}
+
+// ============================================================================
+// Page Numbers in Fields
+// ============================================================================
+
+TEST(PaginationTest, PageFieldsShowEstimates) {
+    TempDoc temp_doc("test_pagination_fields.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        auto numbers = body->append_paragraph("Page ");
+        auto page = numbers->append_field(FieldType::Page);
+        page->set_field_code("PAGE");
+        numbers->append_run(" of ");
+        auto total = numbers->append_field(FieldType::NumPages);
+        body->append_paragraph("Next page")->get_paragraph_format().page_break_before = true;
+
+        EXPECT_EQ(doc.update_pagination(), 2);
+        EXPECT_EQ(page->get_result(), "1");
+        EXPECT_EQ(total->get_result(), "2");
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    EXPECT_EQ(doc.get_builtin_document_properties().total_pages, 2);
+    auto fields = doc.get_paragraphs().get_item(0)->get_fields();
+    ASSERT_EQ(fields.size(), 2u);
+    EXPECT_EQ(fields[1]->get_result(), "2");
+}
+
+TEST(PaginationTest, TableOfContentsShowsPages) {
+    Document doc("test_pagination_toc.docx");
+    ASSERT_TRUE(doc.create_empty());
+    auto body = doc.get_first_section()->get_body();
+    auto toc = body->append_paragraph()->append_field(FieldType::Unknown);
+    toc->set_field_code("TOC");
+    toc->add_switch("\\o \"1-3\"");
+    for (const char* title : {"Introduction", "Results"}) {
+        auto heading = body->append_paragraph(title);
+        heading->get_paragraph_format().style_name = "Heading1";
+        heading->get_paragraph_format().page_break_before = true;
+        body->append_paragraph("Text");
+    }
+
+    doc.update_pagination();
+    EXPECT_EQ(doc.update_table_of_contents(), 1);
+    const auto& entries = doc.get_toc_entries();
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].page, 2);
+    EXPECT_EQ(entries[1].page, 3);
+
+    auto entry = std::dynamic_pointer_cast<Paragraph>(body->get_child(1));
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->get_text(), "Introduction\t2");
+}
@@ -0,0 +1,249 @@
+/**
+ * @file 28_media_tests.cpp
+ * @brief Tests for media references and unused media collection
+ * @since 0.8.0
+ */
+
+#include <gtest/gtest.h>
+#include <cdocx.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../test_helpers.h"
+
+using namespace cdocx;
+using cdocx::test::BenchmarkClock;
+using cdocx::test::TempDoc;
+using cdocx::test::elapsed_micros;
+
+namespace {
+
+const std::string kImageType =
+    "http://schemas.openxmlformats.org/officeDocument/2006/relationships/image";
+const std::string kDocumentRels = "word/_rels/document.xml.rels";
+
+std::vector<uint8_t> image_bytes(size_t size, int seed) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<uint8_t>((i * 31 + seed) & 0xFF);
+    }
+    return data;
+}
+
+/// Appends a paragraph whose run draws the image of relationship @p rel_id,
+/// inside a bookmark when @p bookmark is given
+template <typename Container>
+std::shared_ptr<Paragraph> append_picture(Container& container,
+                                          const std::string& rel_id,
+                                          const std::string& bookmark = "") {
+    auto para = container.append_paragraph();
+    std::shared_ptr<BookmarkStart> start;
+    if (!bookmark.empty()) {
+        start = para->append_bookmark_start(bookmark);
+    }
+    pugi::xml_document drawing;
+    drawing.append_child("w:drawing")
+        .append_child("a:blip")
+        .append_attribute("r:embed")
+        .set_value(rel_id.c_str());
+    para->append_run()->preserve_child(drawing.first_child());
+    if (start) {
+        para->append_bookmark_end(start->get_id());
+    }
+    return para;
+}
+
+std::string rels_of(const std::string& part_path) {
+    const size_t name = part_path.rfind('/') + 1;
+    return part_path.substr(0, name) + "_rels/" + part_path.substr(name) + ".rels";
+}
+
+}  // namespace
+
+// ============================================================================
+// Media Index
+// ============================================================================
+
+TEST(MediaTest, IndexFollowsAddAndDelete) {
+    TempDoc temp_doc("test_media_index.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        ASSERT_TRUE(doc.add_media_from_memory("b.png", image_bytes(32, 1)));
+        ASSERT_TRUE(doc.add_media_from_memory("a.png", image_bytes(32, 2)));
+        EXPECT_EQ(doc.get_media_names(), (std::vector<std::string_view>{"a.png", "b.png"}));
+        EXPECT_EQ(doc.find_media_by_content(image_bytes(32, 1)), "b.png");
+        EXPECT_EQ(doc.find_media_by_content(image_bytes(32, 3)), "");
+
+        EXPECT_TRUE(doc.delete_media("a.png"));
+        EXPECT_FALSE(doc.has_media("a.png"));
+        EXPECT_FALSE(doc.delete_media("a.png"));
+        EXPECT_EQ(doc.list_media(), std::vector<std::string>{"b.png"});
+
+        // A name freed by delete_media() can be used again
+        ASSERT_TRUE(doc.add_media_from_memory("a.png", image_bytes(48, 4)));
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    EXPECT_EQ(doc.list_media(), (std::vector<std::string>{"a.png", "b.png"}));
+    EXPECT_EQ(doc.get_media_data("a.png"), image_bytes(48, 4));
+    EXPECT_EQ(doc.find_media_by_content(image_bytes(32, 1)), "b.png");
+}
+
+TEST(MediaTest, DISABLED_LookupBenchmark) {
+    constexpr int kMedia = 5000;
+    TempDoc temp_doc("test_media_lookup.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        for (int i = 0; i < kMedia; ++i) {
+            doc.add_media_from_memory("image" + std::to_string(i) + ".png", image_bytes(64, i));
+        }
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+
+    auto start = BenchmarkClock::now();
+    size_t listed = 0;
+    for (int i = 0; i < 100; ++i) {
+        listed += doc.get_media_names().size();
+    }
+    RecordProperty("media_names_100x_us", elapsed_micros(start));
+    EXPECT_EQ(listed, static_cast<size_t>(kMedia) * 100);
+
+    start = BenchmarkClock::now();
+    const std::vector<std::string> names = doc.list_media();
+    RecordProperty("list_media_us", elapsed_micros(start));
+    ASSERT_EQ(names.size(), static_cast<size_t>(kMedia));
+
+    start = BenchmarkClock::now();
+    int found = 0;
+    for (const auto& name : names) {
+        found += doc.has_media(name) ? 1 : 0;
+    }
+    found += doc.has_media("missing.png") ? 1 : 0;
+    RecordProperty("has_media_us", elapsed_micros(start));
+    EXPECT_EQ(found, kMedia);
+}
+
+// ============================================================================
+// Unused Media Collection
+// ============================================================================
+
+TEST(MediaTest, SaveDropsUnreferencedMedia) {
+    TempDoc temp_doc("test_media_unreferenced.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        append_picture(*body, doc.add_media_from_memory_with_rel("used.png", image_bytes(64, 1)));
+        doc.add_media_from_memory_with_rel("unused.png", image_bytes(128, 2));
+        doc.add_media_from_memory("orphan.png", image_bytes(256, 3));
+
+        SaveConfig config;
+        config.remove_unused_media = true;
+        doc.set_save_config(config);
+        doc.save();
+        EXPECT_EQ(doc.get_last_save_statistics().removed_media, 2u);
+        EXPECT_EQ(doc.get_last_save_statistics().removed_media_bytes, 384u);
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    EXPECT_EQ(doc.list_media(), std::vector<std::string>{"used.png"});
+    EXPECT_FALSE(doc.find_relationship_id(kDocumentRels, "media/used.png").empty());
+    EXPECT_TRUE(doc.find_relationship_id(kDocumentRels, "media/unused.png").empty());
+}
+
+TEST(MediaTest, MediaSharedByHeaderAndBody) {
+    TempDoc temp_doc("test_media_shared.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto section = doc.get_first_section();
+        auto header = section->add_header();
+        ASSERT_NE(header, nullptr);
+
+        ASSERT_TRUE(doc.add_media_from_memory("logo.png", image_bytes(100, 4)));
+        append_picture(*section->get_body(),
+                       doc.add_relationship(kDocumentRels, kImageType, "media/logo.png"));
+        append_picture(*header,
+                       doc.add_relationship(
+                           rels_of(header->get_part_path()), kImageType, "media/logo.png"));
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+    auto section = doc.get_first_section();
+    for (const auto& para : section->get_body()->get_paragraphs()) {
+        para->remove();
+    }
+
+    // The header still shows the logo, so only the body's relationship goes
+    MediaCleanupResult cleanup = doc.collect_unused_media();
+    EXPECT_EQ(cleanup.removed_relationships, 1u);
+    EXPECT_EQ(cleanup.removed_files, 0u);
+    EXPECT_TRUE(doc.has_media("logo.png"));
+    EXPECT_TRUE(doc.find_relationship_id(kDocumentRels, "media/logo.png").empty());
+
+    // A header no section refers to any more does not keep it either
+    section->remove_header();
+    cleanup = doc.collect_unused_media();
+    EXPECT_EQ(cleanup.removed_files, 1u);
+    EXPECT_EQ(cleanup.removed_bytes, 100u);
+    EXPECT_FALSE(doc.has_media("logo.png"));
+}
+
+TEST(MediaTest, SavedBytesAfterRemovingHalfTheImages) {
+    constexpr int kImages = 200;
+    constexpr size_t kImageSize = 16 * 1024;
+    TempDoc temp_doc("test_media_half_removed.docx");
+    {
+        Document doc(temp_doc.path());
+        ASSERT_TRUE(doc.create_empty());
+        auto body = doc.get_first_section()->get_body();
+        for (int i = 0; i < kImages; ++i) {
+            const std::string name = "image" + std::to_string(i) + ".png";
+            // The odd pictures are optional: each sits in a bookmark the template fills
+            append_picture(*body,
+                           doc.add_media_from_memory_with_rel(name, image_bytes(kImageSize, i)),
+                           i % 2 == 0 ? "" : "photo" + std::to_string(i));
+        }
+        doc.save();
+    }
+
+    Document doc(temp_doc.path());
+    doc.open();
+    ASSERT_TRUE(doc.is_open());
+
+    // Filling a bookmark with text replaces the picture run it held
+    TemplateEngine engine(&doc);
+    for (int i = 1; i < kImages; i += 2) {
+        engine["photo" + std::to_string(i)] = "No photo";
+    }
+    const TemplateEngine::Result result = engine.apply();
+    ASSERT_EQ(result.success, kImages / 2);
+
+    SaveConfig config;
+    config.remove_unused_media = true;
+    doc.set_save_config(config);
+    doc.save();
+    const SaveStatistics stats = doc.get_last_save_statistics();
+    RecordProperty("media_bytes_saved", static_cast<int>(stats.removed_media_bytes));
+    EXPECT_EQ(stats.removed_media, static_cast<size_t>(kImages / 2));
+    EXPECT_EQ(stats.removed_media_bytes, kImageSize * kImages / 2);
+
+    Document reopened(temp_doc.path());
+    reopened.open();
+    ASSERT_TRUE(reopened.is_open());
+    EXPECT_EQ(reopened.list_media().size(), static_cast<size_t>(kImages / 2));
+}
@@ -2,6 +2,7 @@
 
 #include <cdocx.h>
 #include <gtest/gtest.h>
+#include <chrono>
 #include <filesystem>
 #include <string>
 
@@ -95,5 +96,19 @@ inline std::shared_ptr<Body> create_empty_doc(Document& doc) {
     return get_body(doc);
 }
 
+// ============================================================================
+// Timing Helpers
+// ============================================================================
+
+// Benchmarks are DISABLED_ so the default ctest run stays fast; run them with
+// --gtest_also_run_disabled_tests and read the timings from RecordProperty().
+using BenchmarkClock = std::chrono::steady_clock;
+
+inline int elapsed_micros(BenchmarkClock::time_point start) {
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                BenchmarkClock::now() - start)
+                                .count());
+}
+
 }  // namespace test
 }  // namespace cdocx